@@ -148,6 +148,14 @@ if(CMAKE_COMPILER_IS_GNUCXX)
         endif()
       endif()
     endif()
+
+    # AVX2 code is compiled only into the dedicated translation units and is selected at runtime
+    if(ENABLE_AVX2_DISPATCH)
+      ocv_check_flag_support(CXX "-mavx2 -mfma -mf16c" _varname "${OPENCV_EXTRA_CXX_FLAGS}")
+      if(${_varname})
+        set(OPENCV_AVX2_FLAGS "-mavx2 -mfma -mf16c")
+      endif()
+    endif()
   endif(NOT MINGW)
 
   if(X86 OR X86_64)
@@ -222,6 +230,11 @@ if(MSVC)
     set(OPENCV_EXTRA_FLAGS "${OPENCV_EXTRA_FLAGS} /Oi")
   endif()
 
+  # AVX2 code is compiled only into the dedicated translation units and is selected at runtime
+  if(ENABLE_AVX2_DISPATCH AND NOT MSVC_VERSION LESS 1800)
+    set(OPENCV_AVX2_FLAGS "/arch:AVX2")
+  endif()
+
   if(X86 OR X86_64)
     if(CMAKE_SIZEOF_VOID_P EQUAL 4 AND ENABLE_SSE2)
       set(OPENCV_EXTRA_FLAGS "${OPENCV_EXTRA_FLAGS} /fp:fast")# !! important - be on the same wave with x64 compilers
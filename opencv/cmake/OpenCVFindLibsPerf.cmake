@@ -38,6 +38,26 @@ if(WITH_EIGEN)
   endif()
 endif(WITH_EIGEN)
 
+# --- BLAS ---
+# Ubuntu: sudo apt-get install libopenblas-dev
+ocv_clear_vars(HAVE_CBLAS)
+if(WITH_BLAS)
+  find_path(CBLAS_INCLUDE_PATH "cblas.h"
+            PATHS /usr/local /opt /usr
+            PATH_SUFFIXES include include/openblas
+            DOC "The path to cblas.h")
+  find_library(CBLAS_LIBRARY NAMES openblas cblas blas
+               PATHS /usr/local /opt /usr
+               PATH_SUFFIXES lib lib64
+               DOC "The BLAS library providing the CBLAS interface")
+
+  if(CBLAS_INCLUDE_PATH AND CBLAS_LIBRARY)
+    ocv_include_directories(${CBLAS_INCLUDE_PATH})
+    set(OPENCV_LINKER_LIBS ${OPENCV_LINKER_LIBS} ${CBLAS_LIBRARY})
+    set(HAVE_CBLAS 1)
+  endif()
+endif(WITH_BLAS)
+
 # --- Clp ---
 # Ubuntu: sudo apt-get install coinor-libclp-dev coinor-libcoinutils-dev
 ocv_clear_vars(HAVE_CLP)
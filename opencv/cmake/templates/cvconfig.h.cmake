@@ -169,6 +169,9 @@
 /* Eigen Matrix & Linear Algebra Library */
 #cmakedefine  HAVE_EIGEN
 
+/* BLAS library with the CBLAS interface */
+#cmakedefine  HAVE_CBLAS
+
 /* NVidia Cuda Runtime API*/
 #cmakedefine HAVE_CUDA
 
@@ -204,3 +207,6 @@
 
 /* Clp support */
 #cmakedefine HAVE_CLP
+
+/* Trace regions in the library functions */
+#cmakedefine ENABLE_TRACE
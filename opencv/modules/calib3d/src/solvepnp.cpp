@@ -115,31 +115,6 @@ namespace cv
             transform(points, modif_points, transformation);
         }
 
-        class Mutex
-        {
-        public:
-            Mutex() {
-            }
-            void lock()
-            {
-#ifdef HAVE_TBB
-                resultsMutex.lock();
-#endif
-            }
-
-            void unlock()
-            {
-#ifdef HAVE_TBB
-                resultsMutex.unlock();
-#endif
-            }
-
-        private:
-#ifdef HAVE_TBB
-            tbb::mutex resultsMutex;
-#endif
-        };
-
         struct CameraParameters
         {
             void init(Mat _intrinsics, Mat _distCoeffs)
@@ -277,6 +252,7 @@ namespace cv
             void generateVar(vector<char>& mask) const
             {
                 int size = (int)mask.size();
+                AutoLock lock(syncMutex); // the generator is shared by the parallel tasks
                 for (int i = 0; i < size; i++)
                 {
                     int i1 = generator.uniform(0, size);
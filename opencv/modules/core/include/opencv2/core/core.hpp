@@ -217,10 +217,50 @@ CV_EXPORTS ErrorCallback redirectError( ErrorCallback errCallback,
 #define CV_DbgAssert(expr)
 #endif
 
+/*!
+  Sets the number of threads used by cv::parallel_for and the other parallel loops.
+
+  nthreads=1 makes all the loops serial, nthreads<=0 restores the default number of threads
+  (the number of CPUs). The new value is applied to the thread pool at the next parallel loop.
+*/
 CV_EXPORTS void setNumThreads(int nthreads);
+
+//! returns the number of threads the parallel loops started from the current thread will use
 CV_EXPORTS int getNumThreads();
+
+//! returns the value set by setNumThreads() (0 for the default number of threads), so that it can be restored
+CV_EXPORTS int getNumThreadsSetting();
+
+//! returns index of the current thread within the parallel loop (0 for the thread that started the loop)
 CV_EXPORTS int getThreadNum();
 
+/*!
+  Limits the number of threads used by the parallel loops started from the current thread
+
+  The limit is in effect while the object is alive and affects only the calling thread, so
+  a server can cap OpenCV per request without changing the process-wide setNumThreads() setting.
+  The default nthreads=1 makes the region serial. The guards can be nested; the inner one can
+  only lower the limit.
+
+  \code
+  {
+      NumThreadsGuard serial;
+      GaussianBlur(src, dst, Size(5, 5), 1.5); // runs in the calling thread only
+  }
+  \endcode
+*/
+class CV_EXPORTS NumThreadsGuard
+{
+public:
+    explicit NumThreadsGuard(int nthreads=1);
+    ~NumThreadsGuard();
+protected:
+    int prevLimit;
+private:
+    NumThreadsGuard(const NumThreadsGuard&);
+    NumThreadsGuard& operator = (const NumThreadsGuard&);
+};
+
 CV_EXPORTS_W const std::string& getBuildInformation();
 
 //! Returns the number of ticks.
@@ -281,6 +321,92 @@ CV_EXPORTS_W bool checkHardwareSupport(int feature);
 //! returns the number of CPUs (including hyper-threading)
 CV_EXPORTS_W int getNumberOfCPUs();
 
+/*!
+  Light-weight portable mutex
+
+  The class wraps the native OS mutex (CRITICAL_SECTION on Windows, pthread_mutex_t elsewhere).
+  Copies of a Mutex share the same underlying OS object, so the class can be safely stored
+  in the parallel loop bodies that are copied by cv::parallel_for.
+*/
+class CV_EXPORTS Mutex
+{
+public:
+    Mutex();
+    ~Mutex();
+    Mutex(const Mutex& m);
+    Mutex& operator = (const Mutex& m);
+
+    void lock();
+    bool trylock();
+    void unlock();
+
+    struct Impl;
+protected:
+    Impl* impl;
+};
+
+//! locks the mutex in the constructor and unlocks it in the destructor
+class CV_EXPORTS AutoLock
+{
+public:
+    AutoLock(Mutex& m) : mutex(&m) { mutex->lock(); }
+    ~AutoLock() { mutex->unlock(); }
+protected:
+    Mutex* mutex;
+private:
+    AutoLock(const AutoLock&);
+    AutoLock& operator = (const AutoLock&);
+};
+
+/*!
+  Trace region
+
+  Measures the time spent between the constructor and the destructor. When the tracing is on
+  (see cv::setTraceEnabled()), the region is stored into the lock-free ring buffer of the current
+  thread. The name must be a string literal, only the pointer is stored.
+  The library functions are instrumented with the regions when OpenCV is built with ENABLE_TRACE=ON.
+
+  \code
+  {
+      cv::TraceRegion region("myapp::processFrame");
+      // ...
+  }
+  \endcode
+*/
+class CV_EXPORTS TraceRegion
+{
+public:
+    explicit TraceRegion(const char* name);
+    ~TraceRegion();
+protected:
+    const char* name;
+    int64 start;
+private:
+    TraceRegion(const TraceRegion&);
+    TraceRegion& operator = (const TraceRegion&);
+};
+
+//! the aggregated statistics of the trace regions with the same name; the times are in milliseconds
+struct CV_EXPORTS TraceStat
+{
+    TraceStat();
+
+    string name;
+    int64 count;
+    double totalTime, minTime, maxTime;
+};
+
+//! turns the tracing on or off. By default it is on when the OPENCV_TRACE environment variable is set to 1
+CV_EXPORTS void setTraceEnabled(bool enabled);
+//! returns true if the tracing is on
+CV_EXPORTS bool isTraceEnabled();
+//! clears the collected regions
+CV_EXPORTS void resetTrace();
+//! computes the per-name statistics of the regions kept in the ring buffers, sorted by the total time in the descending order
+CV_EXPORTS void getTraceSummary(vector<TraceStat>& stats);
+//! writes the regions kept in the ring buffers in the Chrome trace event format (chrome://tracing)
+CV_EXPORTS void writeTrace(const string& filename);
+
 /*!
   Allocates memory buffer
 
@@ -301,6 +427,69 @@ CV_EXPORTS void* fastMalloc(size_t bufSize);
 */
 CV_EXPORTS void fastFree(void* ptr);
 
+/*!
+  Turns the pooled mode of cv::fastMalloc() on or off
+
+  In the pooled mode the buffers released by cv::fastFree() are not returned to the system.
+  They are kept in the size-class free lists (small buffers - per thread, big buffers - in
+  the global pool shared by all the threads) and reused by the subsequent cv::fastMalloc() calls.
+  This greatly reduces the allocation overhead when the same-size images are allocated and
+  released over and over again, e.g. in a video processing loop.
+
+  \param flag true to use the pool, false to use the system malloc()/free()
+  \param maxCachedBytes the upper limit on the total size of the cached (free) buffers
+  \return the previous mode
+*/
+CV_EXPORTS bool setUseFastMallocPool(bool flag, size_t maxCachedBytes=(size_t)256 << 20);
+
+//! returns true if cv::fastMalloc() uses the pool
+CV_EXPORTS bool useFastMallocPool();
+
+//! returns all the free buffers cached by the current thread and the global pool to the system
+CV_EXPORTS void releaseFastMallocPool();
+
+//! cv::fastMalloc() statistics
+struct CV_EXPORTS FastMallocStats
+{
+    size_t bytesInUse;     //!< the total size of buffers allocated and not yet released
+    size_t peakBytesInUse; //!< the maximum of bytesInUse since the start or resetFastMallocPeak()
+    size_t bytesCached;    //!< the total size of free buffers kept in the pool
+    size_t allocCalls;     //!< the number of cv::fastMalloc() calls
+    size_t freeCalls;      //!< the number of cv::fastFree() calls (with non-NULL pointer)
+    size_t poolHits;       //!< the number of cv::fastMalloc() calls served from the pool
+};
+
+//! returns the current cv::fastMalloc() statistics
+CV_EXPORTS FastMallocStats getFastMallocStats();
+
+//! resets FastMallocStats::peakBytesInUse to the current FastMallocStats::bytesInUse
+CV_EXPORTS void resetFastMallocPeak();
+
+/*!
+  Allocates a temporary buffer in the scratch arena of the calling thread
+
+  The arena is a stack of 64-byte aligned buffers allocated from a few big chunks.
+  The memory of a released buffer is reused once all the buffers allocated after it are released too,
+  so the function is best suited for the buffers with the scoped lifetime. Use cv::ScratchBuffer
+  to release the buffer automatically. The buffer must be released by the same thread.
+*/
+CV_EXPORTS void* scratchAlloc(size_t bufSize);
+
+//! releases the buffer allocated with cv::scratchAlloc
+CV_EXPORTS void scratchFree(void* ptr);
+
+/*!
+  Marks the frame boundary for the scratch arenas of all the threads
+
+  Each arena is trimmed to the peak usage of the last frame (or completely released if
+  releaseMemory=true) when it becomes empty next time. Calling the function once per processed
+  frame keeps the arenas memory proportional to the actual needs without allocation churn.
+*/
+CV_EXPORTS void resetScratchArenas(bool releaseMemory=false);
+
+//! returns the total size of the memory held by the scratch arena of the calling thread
+CV_EXPORTS size_t getScratchArenaSize();
+
 template<typename _Tp> static inline _Tp* allocate(size_t n)
 {
     return new _Tp[n];
@@ -1424,6 +1613,55 @@ public:
     virtual void deallocate(int* refcount, uchar* datastart, uchar* data) = 0;
 };
 
+/*!
+   Frame Pool Allocator
+
+   The allocator keeps the released matrix buffers and gives them out again when a matrix
+   of the same size and type is created. It is intended for video processing pipelines,
+   where the same set of frame-size matrices is created and released on every iteration.
+   Being installed with Mat::setDefaultAllocator(), it serves the matrices created inside the
+   library functions as well, so the pipeline quickly reaches the state without any malloc() calls.
+
+   The total size of the retained buffers is limited; when the limit is exceeded,
+   the least recently released buffers are freed. The class is thread-safe.
+
+   The pool must outlive all the matrices it has allocated: a released matrix still refers
+   to its allocator and uses it again in the next create().
+*/
+class CV_EXPORTS FramePoolAllocator : public MatAllocator
+{
+public:
+    //! the constructor; maxRetainedBytes is the upper limit on the total size of the retained buffers
+    explicit FramePoolAllocator(size_t maxRetainedBytes=(size_t)256 << 20);
+    //! the destructor. All the matrices allocated by the pool must be destroyed or re-created with another allocator by this moment
+    virtual ~FramePoolAllocator();
+
+    virtual void allocate(int dims, const int* sizes, int type, int*& refcount,
+                          uchar*& datastart, uchar*& data, size_t* step);
+    virtual void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! frees all the retained buffers
+    void release();
+    //! sets the upper limit on the total size of the retained buffers
+    void setMaxRetainedBytes(size_t maxRetainedBytes);
+    //! returns the upper limit on the total size of the retained buffers
+    size_t getMaxRetainedBytes() const;
+    //! returns the total size of the currently retained buffers
+    size_t getRetainedBytes() const;
+    //! returns the number of allocations served from the pool
+    size_t getHits() const;
+    //! returns the number of allocations that required a new buffer
+    size_t getMisses() const;
+
+    struct Impl;
+protected:
+    Impl* impl;
+
+private:
+    FramePoolAllocator(const FramePoolAllocator&);
+    FramePoolAllocator& operator = (const FramePoolAllocator&);
+};
+
 /*!
    The n-dimensional matrix class.
 
@@ -1898,6 +2136,13 @@ public:
     template<typename _Tp> MatConstIterator_<_Tp> begin() const;
     template<typename _Tp> MatConstIterator_<_Tp> end() const;
 
+    /*! sets the allocator used by create() for the matrices without their own allocator.
+        The allocator is remembered in each matrix it allocates, so it must outlive all of them.
+        NULL means the default cv::fastMalloc()-based allocation. */
+    static void setDefaultAllocator(MatAllocator* allocator);
+    //! returns the allocator set by setDefaultAllocator()
+    static MatAllocator* getDefaultAllocator();
+
     enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG };
 
     /*! includes several bit-fields:
@@ -2079,6 +2324,8 @@ CV_EXPORTS_W void addWeighted(InputArray src1, double alpha, InputArray src2,
 //! scales array elements, computes absolute values and converts the results to 8-bit unsigned integers: dst(i)=saturate_cast<uchar>abs(src(i)*alpha+beta)
 CV_EXPORTS_W void convertScaleAbs(InputArray src, OutputArray dst,
                                   double alpha=1, double beta=0);
+//! converts CV_32F array to half-precision floats stored as CV_16S and vice versa
+CV_EXPORTS_W void convertFp16(InputArray src, OutputArray dst);
 //! transforms array of numbers using a lookup table: dst(i)=lut(src(i))
 CV_EXPORTS_W void LUT(InputArray src, InputArray lut, OutputArray dst,
                       int interpolation=0);
@@ -2375,6 +2622,28 @@ public:
     Mat mean; //!< mean value subtracted before the projection and added after the back projection
 };
 
+/*!
+    Incremental (streaming) Principal Component Analysis
+
+    The class keeps the number of samples the components are computed from, in addition to
+    the PCA data, and updates the components, the eigenvalues and the mean with new batches
+    of samples, so that PCA of a dataset that does not fit in memory can be computed.
+*/
+class CV_EXPORTS IncrementalPCA : public PCA
+{
+public:
+    //! default constructor
+    IncrementalPCA();
+    //! continues from PCA computed from the specified number of samples
+    IncrementalPCA(const PCA& pca, int64 nsamples);
+    //! operator that performs PCA of the first batch. The previously stored data, if any, is released
+    IncrementalPCA& operator()(InputArray data, InputArray mean, int flags, int maxComponents=0);
+    //! updates the principal components with a new batch of samples
+    IncrementalPCA& update(InputArray data, int flags, int maxComponents=0);
+
+    int64 nsamples; //!< the number of samples the components are computed from
+};
+
 CV_EXPORTS_W void PCACompute(InputArray data, CV_OUT InputOutputArray mean,
                              OutputArray eigenvectors, int maxComponents=0);
 
@@ -2468,7 +2737,9 @@ enum
 {
     KMEANS_RANDOM_CENTERS=0, // Chooses random centers for k-Means initialization
     KMEANS_PP_CENTERS=2,     // Uses k-Means++ algorithm for initialization
-    KMEANS_USE_INITIAL_LABELS=1 // Uses the user-provided labels for K-Means initialization
+    KMEANS_USE_INITIAL_LABELS=1, // Uses the user-provided labels for K-Means initialization
+    KMEANS_HAMERLY=4,        // Skips the distance computations using the Hamerly triangle-inequality bounds
+    KMEANS_MINI_BATCH=8      // Refines the centers on random sample batches instead of the full data set
 };
 //! clusters the input data using k-Means algorithm
 CV_EXPORTS_W double kmeans( InputArray data, int K, CV_OUT InputOutputArray bestLabels,
@@ -3096,6 +3367,54 @@ protected:
     _Tp buf[fixed_size+buffer_padding];
 };
 
+/*!
+ Scratch Buffer Class
+
+ The temporary buffer allocated in the scratch arena of the calling thread (see cv::scratchAlloc()).
+ Unlike cv::AutoBuffer, it does not occupy the stack and does not call malloc() in the steady state,
+ no matter how big the buffer is. The buffer elements are not initialized, so the class should only
+ be used with the plain data types. The buffer must not outlive the function that created it.
+
+ \code
+ void my_func(const cv::Mat& m)
+ {
+    cv::ScratchBuffer<float> buf(m.cols*3); // taken from the arena of the current thread
+    ...
+ } // the buffer is returned to the arena
+ \endcode
+*/
+template<typename _Tp> class CV_EXPORTS ScratchBuffer
+{
+public:
+    typedef _Tp value_type;
+
+    //! the default contructor
+    ScratchBuffer();
+    //! constructor taking the real buffer size
+    ScratchBuffer(size_t _size);
+    //! destructor. calls deallocate()
+    ~ScratchBuffer();
+
+    //! allocates the new buffer of size _size. the previous content is lost
+    void allocate(size_t _size);
+    //! returns the buffer to the arena
+    void deallocate();
+    //! returns pointer to the buffer
+    operator _Tp* ();
+    //! returns read-only pointer to the buffer
+    operator const _Tp* () const;
+
+protected:
+    //! pointer to the buffer
+    _Tp* ptr;
+    //! size of the buffer
+    size_t size;
+
+private:
+    ScratchBuffer(const ScratchBuffer&);
+    ScratchBuffer& operator = (const ScratchBuffer&);
+};
+
 /////////////////////////// multi-dimensional dense matrix //////////////////////////
 
 /*!
@@ -3303,6 +3622,8 @@ public:
         size_t nodeCount;
         size_t freeList;
         vector<uchar> pool;
+        //! the open-addressing hash table with linear probing: the node offsets in the pool,
+        //! 0 for the empty entries, 1 for the erased ones
         vector<size_t> hashtab;
         int size[CV_MAX_DIM];
     };
@@ -3312,7 +3633,7 @@ public:
     {
         //! hash value
         size_t hashval;
-        //! index of the next node in the same hash table entry
+        //! index of the next node in the free list
         size_t next;
         //! index of the matrix element
         int idx[CV_MAX_DIM];
@@ -3495,6 +3816,18 @@ public:
     //! erases the specified element (nD case)
     void erase(const int* idx, size_t* hashval=0);
 
+    //! preallocates the hash table and the node storage for the specified number of non-zero elements
+    void reserve(size_t nzcount);
+    //! inserts many elements at once.
+    /*!
+     \param idx the element indices, nelems x dims() matrix of type CV_32S
+     \param values the element values, a vector of nelems elements of type type()
+     \param accumulate if true, the values are added to the existing elements, otherwise they replace them
+    */
+    void insert(InputArray idx, InputArray values, bool accumulate=false);
+    //! retrieves all the stored elements: nzcount() x dims() CV_32S matrix of indices and nzcount() x 1 matrix of values
+    void getElems(OutputArray idx, OutputArray values) const;
+
     //@{
     /*!
        return the sparse matrix iterator pointing to the first sparse matrix element
@@ -3962,7 +4295,12 @@ public:
         FORMAT_MASK=(7<<3),
         FORMAT_AUTO=0,
         FORMAT_XML=(1<<3),
-        FORMAT_YAML=(2<<3)
+        FORMAT_YAML=(2<<3),
+        FORMAT_BINARY=(3<<3), //!< compact binary format, see the FileStorage description
+        BASE64=64, //!< write the large numerical arrays of XML/YAML storages as base64 strings
+        LAZY=128, //!< parse the top-level nodes of YAML/binary storages when they are accessed; XML is parsed at once
+        FLOAT16=256, //!< store the single-precision floating-point arrays with half precision
+        MAP_DATA=512 //!< the matrices read from a binary storage refer to the mapped file instead of copies
     };
     enum
     {
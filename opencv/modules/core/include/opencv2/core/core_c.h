@@ -799,6 +799,7 @@ CVAPI(void)  cvCalcCovarMatrix( const CvArr** vects, int count,
 #define CV_PCA_DATA_AS_ROW 0
 #define CV_PCA_DATA_AS_COL 1
 #define CV_PCA_USE_AVG 2
+#define CV_PCA_RANDOMIZED 4
 CVAPI(void)  cvCalcPCA( const CvArr* data, CvArr* mean,
                         CvArr* eigenvals, CvArr* eigenvects, int flags );
 
@@ -1706,6 +1707,9 @@ CVAPI(double) cvGetTickFrequency( void );
 #define CV_CPU_SSE4_2  7
 #define CV_CPU_POPCNT  8
 #define CV_CPU_AVX    10
+#define CV_CPU_AVX2   11
+#define CV_CPU_FMA3   12
+#define CV_CPU_F16C   13
 #define CV_HARDWARE_MAX_FEATURE 255
 
 CVAPI(int) cvCheckHardwareSupport(int feature);
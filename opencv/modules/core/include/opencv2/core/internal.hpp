@@ -155,6 +155,20 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 #  endif
 #endif
 
+/* without TBB the loops are executed by the built-in pthreads-based thread pool (see core/src/parallel.cpp) */
+#if defined HAVE_TBB || !(defined WIN32 || defined _WIN32 || defined WINCE)
+#  define HAVE_PARALLEL_FRAMEWORK
+#endif
+
+/* the trace regions of the library functions, see cv::TraceRegion; they are compiled in with ENABLE_TRACE=ON */
+#ifdef ENABLE_TRACE
+#  define CV_TRACE_REGION_NAME_(line) cv_trace_region_##line
+#  define CV_TRACE_REGION_NAME(line) CV_TRACE_REGION_NAME_(line)
+#  define CV_TRACE_REGION(name) cv::TraceRegion CV_TRACE_REGION_NAME(__LINE__)(name)
+#else
+#  define CV_TRACE_REGION(name)
+#endif
+
 #ifdef HAVE_EIGEN
 #  if defined __GNUC__ && defined __APPLE__
 #    pragma GCC diagnostic ignored "-Wshadow"
@@ -174,13 +188,21 @@ namespace cv
     template<typename Body> static inline
     void parallel_for( const BlockedRange& range, const Body& body )
     {
-        tbb::parallel_for(range, body);
+        CV_TRACE_REGION("cv::parallel_for");
+        if( getNumThreads() > 1 )
+            tbb::parallel_for(range, body);
+        else
+            body(range);
     }
 
     template<typename Iterator, typename Body> static inline
     void parallel_do( Iterator first, Iterator last, const Body& body )
     {
-        tbb::parallel_do(first, last, body);
+        if( getNumThreads() > 1 )
+            tbb::parallel_do(first, last, body);
+        else
+            for( ; first != last; ++first )
+                body(*first);
     }
 
     typedef tbb::split Split;
@@ -188,7 +210,10 @@ namespace cv
     template<typename Body> static inline
     void parallel_reduce( const BlockedRange& range, Body& body )
     {
-        tbb::parallel_reduce(range, body);
+        if( getNumThreads() > 1 )
+            tbb::parallel_reduce(range, body);
+        else
+            body(range);
     }
 
     typedef tbb::concurrent_vector<Rect> ConcurrentRectVector;
@@ -207,27 +232,137 @@ namespace cv
         int _begin, _end, _grainsize;
     };
 
+    /*
+       The type-erased loop body, executed by the built-in thread pool.
+       See parallel.cpp for the implementation of the scheduler.
+    */
+    class CV_EXPORTS ParallelLoopBody
+    {
+    public:
+        virtual ~ParallelLoopBody();
+        virtual void operator() (const BlockedRange& range) const = 0;
+    };
+
+    /*
+       Runs body over the range, splitting it into the stripes of at least range.grainsize()
+       elements, which are distributed among the pool threads (work stealing is used to balance the load).
+       At most getNumThreads() threads are used (see also setNumThreads() and NumThreadsGuard).
+       Nested calls and the calls made while the pool is busy with another loop are executed serially.
+    */
+    CV_EXPORTS void parallel_for_( const BlockedRange& range, const ParallelLoopBody& body );
+
+    /* Returns the number of stripes parallel_for_ would split the range into */
+    CV_EXPORTS int getParallelStripes( const BlockedRange& range );
+
+    template<typename Body> class ParallelLoopBodyWrapper : public ParallelLoopBody
+    {
+    public:
+        ParallelLoopBodyWrapper(const Body& _body) : body(&_body) {}
+        void operator() (const BlockedRange& range) const { (*body)(range); }
+    protected:
+        const Body* body;
+    };
+
     template<typename Body> static inline
     void parallel_for( const BlockedRange& range, const Body& body )
     {
-        body(range);
+        parallel_for_(range, ParallelLoopBodyWrapper<Body>(body));
     }
-    typedef std::vector<Rect> ConcurrentRectVector;
-    typedef std::vector<double> ConcurrentDoubleVector;
+
+    /* push_back() can be called concurrently; the rest of the interface must not be used inside parallel loops */
+    template<typename _Tp> class ConcurrentVector : public std::vector<_Tp>
+    {
+    public:
+        void push_back(const _Tp& elem)
+        {
+            AutoLock lock(mutex);
+            std::vector<_Tp>::push_back(elem);
+        }
+    protected:
+        Mutex mutex;
+    };
+
+    typedef ConcurrentVector<Rect> ConcurrentRectVector;
+    typedef ConcurrentVector<double> ConcurrentDoubleVector;
+
+    template<typename Iterator, typename Body> class ParallelDoBody : public ParallelLoopBody
+    {
+    public:
+        ParallelDoBody(const std::vector<Iterator>& _items, const Body& _body) : items(&_items), body(&_body) {}
+        void operator() (const BlockedRange& range) const
+        {
+            for( int i = range.begin(); i < range.end(); i++ )
+                (*body)(*(*items)[i]);
+        }
+    protected:
+        const std::vector<Iterator>* items;
+        const Body* body;
+    };
 
     template<typename Iterator, typename Body> static inline
     void parallel_do( Iterator first, Iterator last, const Body& body )
     {
+        std::vector<Iterator> items;
         for( ; first != last; ++first )
-            body(*first);
+            items.push_back(first);
+        parallel_for_(BlockedRange(0, (int)items.size()), ParallelDoBody<Iterator, Body>(items, body));
     }
 
     class Split {};
 
+    /*
+       Each stripe but the first one is processed by a copy of the body made with the splitting constructor.
+       The copies are joined back in the stripe order, so the result does not depend on the scheduling.
+    */
+    template<typename Body> class ParallelReduceBody : public ParallelLoopBody
+    {
+    public:
+        ParallelReduceBody(const BlockedRange& _range, int _nstripes, Body** _bodies)
+            : range(_range), nstripes(_nstripes), bodies(_bodies) {}
+        void operator() (const BlockedRange& stripes) const
+        {
+            int len = range.end() - range.begin();
+            for( int i = stripes.begin(); i < stripes.end(); i++ )
+            {
+                int b = range.begin() + (int)((int64)len*i/nstripes);
+                int e = range.begin() + (int)((int64)len*(i+1)/nstripes);
+                (*bodies[i])(BlockedRange(b, e, range.grainsize()));
+            }
+        }
+    protected:
+        BlockedRange range;
+        int nstripes;
+        Body** bodies;
+    };
+
     template<typename Body> static inline
     void parallel_reduce( const BlockedRange& range, Body& body )
     {
-        body(range);
+        int i, nstripes = getParallelStripes(range);
+        if( nstripes <= 1 )
+        {
+            body(range);
+            return;
+        }
+
+        std::vector<Body*> bodies(nstripes, (Body*)0);
+        bodies[0] = &body;
+        try
+        {
+            for( i = 1; i < nstripes; i++ )
+                bodies[i] = new Body(body, Split());
+            parallel_for_(BlockedRange(0, nstripes), ParallelReduceBody<Body>(range, nstripes, &bodies[0]));
+            for( i = 1; i < nstripes; i++ )
+                body.join(*bodies[i]);
+        }
+        catch(...)
+        {
+            for( i = 1; i < nstripes; i++ )
+                delete bodies[i];
+            throw;
+        }
+        for( i = 1; i < nstripes; i++ )
+            delete bodies[i];
     }
 #endif
 } //namespace cv
@@ -2580,6 +2580,41 @@ template<typename _Tp, size_t fixed_size> inline AutoBuffer<_Tp, fixed_size>::op
 template<typename _Tp, size_t fixed_size> inline AutoBuffer<_Tp, fixed_size>::operator const _Tp* () const
 { return ptr; }
 
+/////////////////////////////// ScratchBuffer ////////////////////////////////////////
+
+template<typename _Tp> inline ScratchBuffer<_Tp>::ScratchBuffer() : ptr(0), size(0) {}
+
+template<typename _Tp> inline ScratchBuffer<_Tp>::ScratchBuffer(size_t _size) : ptr(0), size(0)
+{ allocate(_size); }
+
+template<typename _Tp> inline ScratchBuffer<_Tp>::~ScratchBuffer()
+{ deallocate(); }
+
+template<typename _Tp> inline void ScratchBuffer<_Tp>::allocate(size_t _size)
+{
+    if(_size <= size && ptr)
+        return;
+    deallocate();
+    ptr = (_Tp*)scratchAlloc(_size*sizeof(_Tp));
+    size = _size;
+}
+
+template<typename _Tp> inline void ScratchBuffer<_Tp>::deallocate()
+{
+    if( ptr )
+    {
+        scratchFree(ptr);
+        ptr = 0;
+        size = 0;
+    }
+}
+
+template<typename _Tp> inline ScratchBuffer<_Tp>::operator _Tp* ()
+{ return ptr; }
+
+template<typename _Tp> inline ScratchBuffer<_Tp>::operator const _Tp* () const
+{ return ptr; }
+
 
 /////////////////////////////////// Ptr ////////////////////////////////////////
 
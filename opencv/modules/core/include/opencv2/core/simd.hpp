@@ -0,0 +1,1420 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/* The header is for internal use and it is likely to change.
+
+   It provides width-agnostic vector types and operations, so that a kernel written
+   once compiles to SSE2/SSE4.1, AVX2, NEON or to plain scalar code, depending on the
+   instruction set the translation unit is compiled for:
+
+     v_uint8, v_int8, v_uint16, v_int16, v_uint32, v_int32, v_float32, v_float64
+
+   Every type has the lane_type typedef and the nlanes constant; v_load(), v_store(),
+   v_setall_*(), the arithmetic, bitwise and comparison operators, v_min(), v_max(),
+   v_select(), v_pack*(), v_expand(), v_load_expand*() and, for the floating-point
+   types, v_load_deinterleave()/v_store_interleave() work on all the backends.
+   The 8- and 16-bit + and - saturate, like saturate_cast; v_add_wrap() and
+   v_sub_wrap() give the modular result. Comparisons return lanes with all bits set
+   where the condition holds.
+
+   A typical loop is
+
+     #if CV_SIMD
+       if( checkSIMDSupport() )
+           for( ; x <= width - v_float32::nlanes; x += v_float32::nlanes )
+               v_store(dst + x, v_max(v_load(src + x), v_setzero_f32()));
+     #endif
+       for( ; x < width; x++ )
+           dst[x] = std::max(src[x], 0.f);
+
+   Each backend lives in its own namespace (cv::CV_SIMD_NAMESPACE), so translation
+   units compiled with different instruction sets can be linked together safely.
+*/
+
+#ifndef __OPENCV_CORE_SIMD_HPP__
+#define __OPENCV_CORE_SIMD_HPP__
+
+#ifndef __cplusplus
+#  error simd.hpp header must be compiled as C++
+#endif
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/core/core_c.h"
+#include "opencv2/core/internal.hpp"
+
+#if defined __AVX2__
+#  include <immintrin.h>
+#  define CV_SIMD_AVX2 1
+#  define CV_SIMD_NAMESPACE simd_avx2
+#  define CV_SIMD_WIDTH 32
+#elif CV_SSE2
+#  if defined __SSE4_1__ || defined __AVX__
+#    include <smmintrin.h>
+#    define CV_SIMD_SSE4_1 1
+#    define CV_SIMD_NAMESPACE simd_sse41
+#  else
+#    define CV_SIMD_NAMESPACE simd_sse2
+#  endif
+#  define CV_SIMD_SSE 1
+#  define CV_SIMD_WIDTH 16
+#elif CV_NEON
+#  define CV_SIMD_NEON 1
+#  define CV_SIMD_NAMESPACE simd_neon
+#  define CV_SIMD_WIDTH 16
+#else
+#  define CV_SIMD_NAMESPACE simd_scalar
+#  define CV_SIMD_WIDTH 16
+#endif
+
+#ifndef CV_SIMD_AVX2
+#  define CV_SIMD_AVX2 0
+#endif
+#ifndef CV_SIMD_SSE
+#  define CV_SIMD_SSE 0
+#endif
+#ifndef CV_SIMD_SSE4_1
+#  define CV_SIMD_SSE4_1 0
+#endif
+#ifndef CV_SIMD_NEON
+#  define CV_SIMD_NEON 0
+#endif
+
+//! 1 when the types map to vector registers, 0 for the scalar fallback
+#define CV_SIMD (CV_SIMD_AVX2 || CV_SIMD_SSE || CV_SIMD_NEON)
+//! 1 when v_float64 is available (not on 32-bit NEON)
+#define CV_SIMD_64F (!CV_SIMD_NEON)
+
+namespace cv
+{
+
+namespace CV_SIMD_NAMESPACE
+{
+
+#define CV_SIMD_DEF_TYPE(name, lane, n, native) \
+struct name \
+{ \
+    typedef lane lane_type; \
+    typedef native vector_type; \
+    enum { nlanes = n }; \
+    name() {} \
+    explicit name(const native& v) : val(v) {} \
+    native val; \
+}
+
+#define CV_SIMD_DEF_BIN_OP(op, vt, intrin) \
+inline vt operator op (const vt& a, const vt& b) { return vt(intrin(a.val, b.val)); } \
+inline vt& operator op##= (vt& a, const vt& b) { a.val = intrin(a.val, b.val); return a; }
+
+#define CV_SIMD_DEF_CMP_OP(op, vt, intrin) \
+inline vt operator op (const vt& a, const vt& b) { return vt(intrin(a.val, b.val)); }
+
+#define CV_SIMD_DEF_BIN_FUNC(func, vt, intrin) \
+inline vt func(const vt& a, const vt& b) { return vt(intrin(a.val, b.val)); }
+
+// comparisons for the types that only have == and >
+#define CV_SIMD_DEF_CMP_FROM_GT(vt) \
+inline vt operator != (const vt& a, const vt& b) { return ~(a == b); } \
+inline vt operator < (const vt& a, const vt& b) { return b > a; } \
+inline vt operator >= (const vt& a, const vt& b) { return ~(b > a); } \
+inline vt operator <= (const vt& a, const vt& b) { return ~(a > b); }
+
+#if CV_SIMD_SSE
+
+/////////////////////////////////////// SSE2 / SSE4.1 ///////////////////////////////////////
+
+CV_SIMD_DEF_TYPE(v_uint8, uchar, 16, __m128i);
+CV_SIMD_DEF_TYPE(v_int8, schar, 16, __m128i);
+CV_SIMD_DEF_TYPE(v_uint16, ushort, 8, __m128i);
+CV_SIMD_DEF_TYPE(v_int16, short, 8, __m128i);
+CV_SIMD_DEF_TYPE(v_uint32, unsigned, 4, __m128i);
+CV_SIMD_DEF_TYPE(v_int32, int, 4, __m128i);
+CV_SIMD_DEF_TYPE(v_float32, float, 4, __m128);
+CV_SIMD_DEF_TYPE(v_float64, double, 2, __m128d);
+
+inline __m128i v_sse_cast_si(const __m128i& a) { return a; }
+inline __m128i v_sse_cast_si(const __m128& a) { return _mm_castps_si128(a); }
+inline __m128i v_sse_cast_si(const __m128d& a) { return _mm_castpd_si128(a); }
+inline __m128 v_sse_cast_ps(const __m128i& a) { return _mm_castsi128_ps(a); }
+inline __m128 v_sse_cast_ps(const __m128& a) { return a; }
+inline __m128 v_sse_cast_ps(const __m128d& a) { return _mm_castpd_ps(a); }
+inline __m128d v_sse_cast_pd(const __m128i& a) { return _mm_castsi128_pd(a); }
+inline __m128d v_sse_cast_pd(const __m128& a) { return _mm_castps_pd(a); }
+inline __m128d v_sse_cast_pd(const __m128d& a) { return a; }
+
+#define CV_SIMD_SSE_INIT_INT(vt, lane, suffix, intrin, cast) \
+inline vt v_setzero_##suffix() { return vt(_mm_setzero_si128()); } \
+inline vt v_setall_##suffix(lane v) { return vt(intrin((cast)v)); } \
+inline vt v_load(const lane* p) { return vt(_mm_loadu_si128((const __m128i*)p)); } \
+inline vt v_load_aligned(const lane* p) { return vt(_mm_load_si128((const __m128i*)p)); } \
+inline void v_store(lane* p, const vt& a) { _mm_storeu_si128((__m128i*)p, a.val); } \
+inline void v_store_aligned(lane* p, const vt& a) { _mm_store_si128((__m128i*)p, a.val); } \
+template<typename _Tpvec> inline vt v_reinterpret_as_##suffix(const _Tpvec& a) \
+{ return vt(v_sse_cast_si(a.val)); } \
+CV_SIMD_DEF_BIN_OP(&, vt, _mm_and_si128) \
+CV_SIMD_DEF_BIN_OP(|, vt, _mm_or_si128) \
+CV_SIMD_DEF_BIN_OP(^, vt, _mm_xor_si128) \
+inline vt operator ~ (const vt& a) { return vt(_mm_xor_si128(a.val, _mm_set1_epi32(-1))); } \
+inline vt v_select(const vt& mask, const vt& a, const vt& b) \
+{ return vt(_mm_xor_si128(b.val, _mm_and_si128(_mm_xor_si128(a.val, b.val), mask.val))); }
+
+CV_SIMD_SSE_INIT_INT(v_uint8, uchar, u8, _mm_set1_epi8, char)
+CV_SIMD_SSE_INIT_INT(v_int8, schar, s8, _mm_set1_epi8, char)
+CV_SIMD_SSE_INIT_INT(v_uint16, ushort, u16, _mm_set1_epi16, short)
+CV_SIMD_SSE_INIT_INT(v_int16, short, s16, _mm_set1_epi16, short)
+CV_SIMD_SSE_INIT_INT(v_uint32, unsigned, u32, _mm_set1_epi32, int)
+CV_SIMD_SSE_INIT_INT(v_int32, int, s32, _mm_set1_epi32, int)
+
+#define CV_SIMD_SSE_INIT_FLT(vt, lane, suffix, sfx, cast) \
+inline vt v_setzero_##suffix() { return vt(_mm_setzero_##sfx()); } \
+inline vt v_setall_##suffix(lane v) { return vt(_mm_set1_##sfx(v)); } \
+inline vt v_load(const lane* p) { return vt(_mm_loadu_##sfx(p)); } \
+inline vt v_load_aligned(const lane* p) { return vt(_mm_load_##sfx(p)); } \
+inline void v_store(lane* p, const vt& a) { _mm_storeu_##sfx(p, a.val); } \
+inline void v_store_aligned(lane* p, const vt& a) { _mm_store_##sfx(p, a.val); } \
+template<typename _Tpvec> inline vt v_reinterpret_as_##suffix(const _Tpvec& a) \
+{ return vt(cast(a.val)); } \
+CV_SIMD_DEF_BIN_OP(+, vt, _mm_add_##sfx) \
+CV_SIMD_DEF_BIN_OP(-, vt, _mm_sub_##sfx) \
+CV_SIMD_DEF_BIN_OP(*, vt, _mm_mul_##sfx) \
+CV_SIMD_DEF_BIN_OP(/, vt, _mm_div_##sfx) \
+CV_SIMD_DEF_BIN_OP(&, vt, _mm_and_##sfx) \
+CV_SIMD_DEF_BIN_OP(|, vt, _mm_or_##sfx) \
+CV_SIMD_DEF_BIN_OP(^, vt, _mm_xor_##sfx) \
+inline vt operator ~ (const vt& a) { return vt(_mm_xor_##sfx(a.val, cast(_mm_set1_epi32(-1)))); } \
+CV_SIMD_DEF_CMP_OP(==, vt, _mm_cmpeq_##sfx) \
+CV_SIMD_DEF_CMP_OP(!=, vt, _mm_cmpneq_##sfx) \
+CV_SIMD_DEF_CMP_OP(<, vt, _mm_cmplt_##sfx) \
+CV_SIMD_DEF_CMP_OP(>, vt, _mm_cmpgt_##sfx) \
+CV_SIMD_DEF_CMP_OP(<=, vt, _mm_cmple_##sfx) \
+CV_SIMD_DEF_CMP_OP(>=, vt, _mm_cmpge_##sfx) \
+CV_SIMD_DEF_BIN_FUNC(v_min, vt, _mm_min_##sfx) \
+CV_SIMD_DEF_BIN_FUNC(v_max, vt, _mm_max_##sfx) \
+inline vt v_sqrt(const vt& a) { return vt(_mm_sqrt_##sfx(a.val)); } \
+inline vt v_muladd(const vt& a, const vt& b, const vt& c) { return a*b + c; } \
+inline vt v_select(const vt& mask, const vt& a, const vt& b) \
+{ return vt(_mm_xor_##sfx(b.val, _mm_and_##sfx(_mm_xor_##sfx(a.val, b.val), mask.val))); }
+
+CV_SIMD_SSE_INIT_FLT(v_float32, float, f32, ps, v_sse_cast_ps)
+CV_SIMD_SSE_INIT_FLT(v_float64, double, f64, pd, v_sse_cast_pd)
+
+#undef CV_SIMD_SSE_INIT_INT
+#undef CV_SIMD_SSE_INIT_FLT
+
+CV_SIMD_DEF_BIN_OP(+, v_uint8, _mm_adds_epu8)
+CV_SIMD_DEF_BIN_OP(-, v_uint8, _mm_subs_epu8)
+CV_SIMD_DEF_BIN_OP(+, v_int8, _mm_adds_epi8)
+CV_SIMD_DEF_BIN_OP(-, v_int8, _mm_subs_epi8)
+CV_SIMD_DEF_BIN_OP(+, v_uint16, _mm_adds_epu16)
+CV_SIMD_DEF_BIN_OP(-, v_uint16, _mm_subs_epu16)
+CV_SIMD_DEF_BIN_OP(+, v_int16, _mm_adds_epi16)
+CV_SIMD_DEF_BIN_OP(-, v_int16, _mm_subs_epi16)
+CV_SIMD_DEF_BIN_OP(+, v_uint32, _mm_add_epi32)
+CV_SIMD_DEF_BIN_OP(-, v_uint32, _mm_sub_epi32)
+CV_SIMD_DEF_BIN_OP(+, v_int32, _mm_add_epi32)
+CV_SIMD_DEF_BIN_OP(-, v_int32, _mm_sub_epi32)
+
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_uint8, _mm_add_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_int8, _mm_add_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_uint16, _mm_add_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_int16, _mm_add_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_uint8, _mm_sub_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_int8, _mm_sub_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_uint16, _mm_sub_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_int16, _mm_sub_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_mul_wrap, v_uint16, _mm_mullo_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_mul_wrap, v_int16, _mm_mullo_epi16)
+
+CV_SIMD_DEF_CMP_OP(==, v_uint8, _mm_cmpeq_epi8)
+CV_SIMD_DEF_CMP_OP(==, v_int8, _mm_cmpeq_epi8)
+CV_SIMD_DEF_CMP_OP(==, v_uint16, _mm_cmpeq_epi16)
+CV_SIMD_DEF_CMP_OP(==, v_int16, _mm_cmpeq_epi16)
+CV_SIMD_DEF_CMP_OP(==, v_uint32, _mm_cmpeq_epi32)
+CV_SIMD_DEF_CMP_OP(==, v_int32, _mm_cmpeq_epi32)
+CV_SIMD_DEF_CMP_OP(>, v_int8, _mm_cmpgt_epi8)
+CV_SIMD_DEF_CMP_OP(>, v_int16, _mm_cmpgt_epi16)
+CV_SIMD_DEF_CMP_OP(>, v_int32, _mm_cmpgt_epi32)
+
+inline v_uint8 operator > (const v_uint8& a, const v_uint8& b)
+{
+    __m128i d = _mm_set1_epi8((char)0x80);
+    return v_uint8(_mm_cmpgt_epi8(_mm_xor_si128(a.val, d), _mm_xor_si128(b.val, d)));
+}
+inline v_uint16 operator > (const v_uint16& a, const v_uint16& b)
+{
+    __m128i d = _mm_set1_epi16((short)0x8000);
+    return v_uint16(_mm_cmpgt_epi16(_mm_xor_si128(a.val, d), _mm_xor_si128(b.val, d)));
+}
+inline v_uint32 operator > (const v_uint32& a, const v_uint32& b)
+{
+    __m128i d = _mm_set1_epi32((int)0x80000000);
+    return v_uint32(_mm_cmpgt_epi32(_mm_xor_si128(a.val, d), _mm_xor_si128(b.val, d)));
+}
+
+CV_SIMD_DEF_CMP_FROM_GT(v_uint8)
+CV_SIMD_DEF_CMP_FROM_GT(v_int8)
+CV_SIMD_DEF_CMP_FROM_GT(v_uint16)
+CV_SIMD_DEF_CMP_FROM_GT(v_int16)
+CV_SIMD_DEF_CMP_FROM_GT(v_uint32)
+CV_SIMD_DEF_CMP_FROM_GT(v_int32)
+
+CV_SIMD_DEF_BIN_FUNC(v_min, v_uint8, _mm_min_epu8)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_uint8, _mm_max_epu8)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_int16, _mm_min_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_int16, _mm_max_epi16)
+
+#if CV_SIMD_SSE4_1
+CV_SIMD_DEF_BIN_FUNC(v_min, v_int8, _mm_min_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_int8, _mm_max_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_uint16, _mm_min_epu16)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_uint16, _mm_max_epu16)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_uint32, _mm_min_epu32)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_uint32, _mm_max_epu32)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_int32, _mm_min_epi32)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_int32, _mm_max_epi32)
+#else
+inline v_uint16 v_min(const v_uint16& a, const v_uint16& b)
+{ return v_uint16(_mm_subs_epu16(a.val, _mm_subs_epu16(a.val, b.val))); }
+inline v_uint16 v_max(const v_uint16& a, const v_uint16& b)
+{ return v_uint16(_mm_adds_epu16(_mm_subs_epu16(a.val, b.val), b.val)); }
+#define CV_SIMD_SSE_MINMAX_FROM_GT(vt) \
+inline vt v_min(const vt& a, const vt& b) { return v_select(a > b, b, a); } \
+inline vt v_max(const vt& a, const vt& b) { return v_select(a > b, a, b); }
+CV_SIMD_SSE_MINMAX_FROM_GT(v_int8)
+CV_SIMD_SSE_MINMAX_FROM_GT(v_uint32)
+CV_SIMD_SSE_MINMAX_FROM_GT(v_int32)
+#undef CV_SIMD_SSE_MINMAX_FROM_GT
+#endif
+
+inline v_uint8 v_absdiff(const v_uint8& a, const v_uint8& b)
+{ return v_uint8(_mm_or_si128(_mm_subs_epu8(a.val, b.val), _mm_subs_epu8(b.val, a.val))); }
+inline v_uint16 v_absdiff(const v_uint16& a, const v_uint16& b)
+{ return v_uint16(_mm_or_si128(_mm_subs_epu16(a.val, b.val), _mm_subs_epu16(b.val, a.val))); }
+inline v_float32 v_abs(const v_float32& a)
+{ return v_float32(_mm_and_ps(a.val, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)))); }
+inline v_float64 v_abs(const v_float64& a)
+{ return v_float64(_mm_and_pd(a.val, _mm_castsi128_pd(_mm_srli_epi64(_mm_set1_epi32(-1), 1)))); }
+inline v_float32 v_absdiff(const v_float32& a, const v_float32& b) { return v_abs(a - b); }
+inline v_float64 v_absdiff(const v_float64& a, const v_float64& b) { return v_abs(a - b); }
+
+template<int n> inline v_uint16 v_shl(const v_uint16& a) { return v_uint16(_mm_slli_epi16(a.val, n)); }
+template<int n> inline v_int16 v_shl(const v_int16& a) { return v_int16(_mm_slli_epi16(a.val, n)); }
+template<int n> inline v_uint32 v_shl(const v_uint32& a) { return v_uint32(_mm_slli_epi32(a.val, n)); }
+template<int n> inline v_int32 v_shl(const v_int32& a) { return v_int32(_mm_slli_epi32(a.val, n)); }
+template<int n> inline v_uint16 v_shr(const v_uint16& a) { return v_uint16(_mm_srli_epi16(a.val, n)); }
+template<int n> inline v_int16 v_shr(const v_int16& a) { return v_int16(_mm_srai_epi16(a.val, n)); }
+template<int n> inline v_uint32 v_shr(const v_uint32& a) { return v_uint32(_mm_srli_epi32(a.val, n)); }
+template<int n> inline v_int32 v_shr(const v_int32& a) { return v_int32(_mm_srai_epi32(a.val, n)); }
+
+inline v_int32 v_round(const v_float32& a) { return v_int32(_mm_cvtps_epi32(a.val)); }
+inline v_int32 v_trunc(const v_float32& a) { return v_int32(_mm_cvttps_epi32(a.val)); }
+inline v_float32 v_cvt_f32(const v_int32& a) { return v_float32(_mm_cvtepi32_ps(a.val)); }
+
+inline v_uint8 v_pack(const v_uint16& a, const v_uint16& b)
+{
+    __m128i m = _mm_set1_epi16(255);
+    return v_uint8(_mm_packus_epi16(_mm_subs_epu16(a.val, _mm_subs_epu16(a.val, m)),
+                                    _mm_subs_epu16(b.val, _mm_subs_epu16(b.val, m))));
+}
+inline v_int8 v_pack(const v_int16& a, const v_int16& b) { return v_int8(_mm_packs_epi16(a.val, b.val)); }
+inline v_uint8 v_pack_u(const v_int16& a, const v_int16& b) { return v_uint8(_mm_packus_epi16(a.val, b.val)); }
+inline v_int16 v_pack(const v_int32& a, const v_int32& b) { return v_int16(_mm_packs_epi32(a.val, b.val)); }
+inline v_uint16 v_pack_u(const v_int32& a, const v_int32& b)
+{
+#if CV_SIMD_SSE4_1
+    return v_uint16(_mm_packus_epi32(a.val, b.val));
+#else
+    // clip to [0, +inf), shift down to the signed range, pack and shift back
+    __m128i z = _mm_setzero_si128(), delta = _mm_set1_epi32(32768);
+    __m128i a1 = _mm_sub_epi32(_mm_and_si128(a.val, _mm_cmpgt_epi32(a.val, z)), delta);
+    __m128i b1 = _mm_sub_epi32(_mm_and_si128(b.val, _mm_cmpgt_epi32(b.val, z)), delta);
+    return v_uint16(_mm_xor_si128(_mm_packs_epi32(a1, b1), _mm_set1_epi16((short)0x8000)));
+#endif
+}
+
+inline void v_expand(const v_uint8& a, v_uint16& b0, v_uint16& b1)
+{
+    __m128i z = _mm_setzero_si128();
+    b0.val = _mm_unpacklo_epi8(a.val, z);
+    b1.val = _mm_unpackhi_epi8(a.val, z);
+}
+inline void v_expand(const v_int8& a, v_int16& b0, v_int16& b1)
+{
+    b0.val = _mm_srai_epi16(_mm_unpacklo_epi8(a.val, a.val), 8);
+    b1.val = _mm_srai_epi16(_mm_unpackhi_epi8(a.val, a.val), 8);
+}
+inline void v_expand(const v_uint16& a, v_uint32& b0, v_uint32& b1)
+{
+    __m128i z = _mm_setzero_si128();
+    b0.val = _mm_unpacklo_epi16(a.val, z);
+    b1.val = _mm_unpackhi_epi16(a.val, z);
+}
+inline void v_expand(const v_int16& a, v_int32& b0, v_int32& b1)
+{
+    b0.val = _mm_srai_epi32(_mm_unpacklo_epi16(a.val, a.val), 16);
+    b1.val = _mm_srai_epi32(_mm_unpackhi_epi16(a.val, a.val), 16);
+}
+
+inline v_uint16 v_load_expand(const uchar* p)
+{ return v_uint16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128())); }
+inline v_int16 v_load_expand(const schar* p)
+{
+    __m128i a = _mm_loadl_epi64((const __m128i*)p);
+    return v_int16(_mm_srai_epi16(_mm_unpacklo_epi8(a, a), 8));
+}
+inline v_uint32 v_load_expand(const ushort* p)
+{ return v_uint32(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128())); }
+inline v_int32 v_load_expand(const short* p)
+{
+    __m128i a = _mm_loadl_epi64((const __m128i*)p);
+    return v_int32(_mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16));
+}
+inline v_uint32 v_load_expand_q(const uchar* p)
+{
+    __m128i z = _mm_setzero_si128();
+    __m128i a = _mm_cvtsi32_si128(*(const int*)p);
+    return v_uint32(_mm_unpacklo_epi16(_mm_unpacklo_epi8(a, z), z));
+}
+inline v_int32 v_load_expand_q(const schar* p)
+{
+    __m128i a = _mm_cvtsi32_si128(*(const int*)p);
+    a = _mm_unpacklo_epi8(a, a);
+    return v_int32(_mm_srai_epi32(_mm_unpacklo_epi16(a, a), 24));
+}
+
+inline float v_reduce_sum(const v_float32& a)
+{
+    __m128 s = _mm_add_ps(a.val, _mm_movehl_ps(a.val, a.val));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+inline int v_reduce_sum(const v_int32& a)
+{
+    __m128i s = _mm_add_epi32(a.val, _mm_srli_si128(a.val, 8));
+    return _mm_cvtsi128_si32(_mm_add_epi32(s, _mm_srli_si128(s, 4)));
+}
+inline float v_reduce_max(const v_float32& a)
+{
+    __m128 s = _mm_max_ps(a.val, _mm_movehl_ps(a.val, a.val));
+    return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+inline float v_reduce_min(const v_float32& a)
+{
+    __m128 s = _mm_min_ps(a.val, _mm_movehl_ps(a.val, a.val));
+    return _mm_cvtss_f32(_mm_min_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+//! bit i of the result is the most significant bit of lane i
+inline int v_signmask(const v_uint8& a) { return _mm_movemask_epi8(a.val); }
+inline int v_signmask(const v_int8& a) { return _mm_movemask_epi8(a.val); }
+inline int v_signmask(const v_float32& a) { return _mm_movemask_ps(a.val); }
+inline bool v_check_all(const v_uint8& a) { return _mm_movemask_epi8(a.val) == 0xffff; }
+inline bool v_check_any(const v_uint8& a) { return _mm_movemask_epi8(a.val) != 0; }
+
+//! loads 2*nlanes interleaved values (e.g. complex numbers) into the separate vectors
+inline void v_load_deinterleave(const float* p, v_float32& a, v_float32& b)
+{
+    __m128 t0 = _mm_loadu_ps(p), t1 = _mm_loadu_ps(p + 4);
+    a.val = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+    b.val = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1));
+}
+inline void v_load_deinterleave(const double* p, v_float64& a, v_float64& b)
+{
+    __m128d t0 = _mm_loadu_pd(p), t1 = _mm_loadu_pd(p + 2);
+    a.val = _mm_unpacklo_pd(t0, t1);
+    b.val = _mm_unpackhi_pd(t0, t1);
+}
+//! the inverse of v_load_deinterleave()
+inline void v_store_interleave(float* p, const v_float32& a, const v_float32& b)
+{
+    _mm_storeu_ps(p, _mm_unpacklo_ps(a.val, b.val));
+    _mm_storeu_ps(p + 4, _mm_unpackhi_ps(a.val, b.val));
+}
+inline void v_store_interleave(double* p, const v_float64& a, const v_float64& b)
+{
+    _mm_storeu_pd(p, _mm_unpacklo_pd(a.val, b.val));
+    _mm_storeu_pd(p + 2, _mm_unpackhi_pd(a.val, b.val));
+}
+
+#elif CV_SIMD_AVX2
+
+//////////////////////////////////////////// AVX2 ////////////////////////////////////////////
+
+CV_SIMD_DEF_TYPE(v_uint8, uchar, 32, __m256i);
+CV_SIMD_DEF_TYPE(v_int8, schar, 32, __m256i);
+CV_SIMD_DEF_TYPE(v_uint16, ushort, 16, __m256i);
+CV_SIMD_DEF_TYPE(v_int16, short, 16, __m256i);
+CV_SIMD_DEF_TYPE(v_uint32, unsigned, 8, __m256i);
+CV_SIMD_DEF_TYPE(v_int32, int, 8, __m256i);
+CV_SIMD_DEF_TYPE(v_float32, float, 8, __m256);
+CV_SIMD_DEF_TYPE(v_float64, double, 4, __m256d);
+
+inline __m256i v_avx_cast_si(const __m256i& a) { return a; }
+inline __m256i v_avx_cast_si(const __m256& a) { return _mm256_castps_si256(a); }
+inline __m256i v_avx_cast_si(const __m256d& a) { return _mm256_castpd_si256(a); }
+inline __m256 v_avx_cast_ps(const __m256i& a) { return _mm256_castsi256_ps(a); }
+inline __m256 v_avx_cast_ps(const __m256& a) { return a; }
+inline __m256 v_avx_cast_ps(const __m256d& a) { return _mm256_castpd_ps(a); }
+inline __m256d v_avx_cast_pd(const __m256i& a) { return _mm256_castsi256_pd(a); }
+inline __m256d v_avx_cast_pd(const __m256& a) { return _mm256_castps_pd(a); }
+inline __m256d v_avx_cast_pd(const __m256d& a) { return a; }
+
+#define CV_SIMD_AVX_INIT_INT(vt, lane, suffix, intrin, cast) \
+inline vt v_setzero_##suffix() { return vt(_mm256_setzero_si256()); } \
+inline vt v_setall_##suffix(lane v) { return vt(intrin((cast)v)); } \
+inline vt v_load(const lane* p) { return vt(_mm256_loadu_si256((const __m256i*)p)); } \
+inline vt v_load_aligned(const lane* p) { return vt(_mm256_load_si256((const __m256i*)p)); } \
+inline void v_store(lane* p, const vt& a) { _mm256_storeu_si256((__m256i*)p, a.val); } \
+inline void v_store_aligned(lane* p, const vt& a) { _mm256_store_si256((__m256i*)p, a.val); } \
+template<typename _Tpvec> inline vt v_reinterpret_as_##suffix(const _Tpvec& a) \
+{ return vt(v_avx_cast_si(a.val)); } \
+CV_SIMD_DEF_BIN_OP(&, vt, _mm256_and_si256) \
+CV_SIMD_DEF_BIN_OP(|, vt, _mm256_or_si256) \
+CV_SIMD_DEF_BIN_OP(^, vt, _mm256_xor_si256) \
+inline vt operator ~ (const vt& a) { return vt(_mm256_xor_si256(a.val, _mm256_set1_epi32(-1))); } \
+inline vt v_select(const vt& mask, const vt& a, const vt& b) \
+{ return vt(_mm256_blendv_epi8(b.val, a.val, mask.val)); }
+
+CV_SIMD_AVX_INIT_INT(v_uint8, uchar, u8, _mm256_set1_epi8, char)
+CV_SIMD_AVX_INIT_INT(v_int8, schar, s8, _mm256_set1_epi8, char)
+CV_SIMD_AVX_INIT_INT(v_uint16, ushort, u16, _mm256_set1_epi16, short)
+CV_SIMD_AVX_INIT_INT(v_int16, short, s16, _mm256_set1_epi16, short)
+CV_SIMD_AVX_INIT_INT(v_uint32, unsigned, u32, _mm256_set1_epi32, int)
+CV_SIMD_AVX_INIT_INT(v_int32, int, s32, _mm256_set1_epi32, int)
+
+#define CV_SIMD_AVX_INIT_FLT(vt, lane, suffix, sfx, cast) \
+inline vt v_setzero_##suffix() { return vt(_mm256_setzero_##sfx()); } \
+inline vt v_setall_##suffix(lane v) { return vt(_mm256_set1_##sfx(v)); } \
+inline vt v_load(const lane* p) { return vt(_mm256_loadu_##sfx(p)); } \
+inline vt v_load_aligned(const lane* p) { return vt(_mm256_load_##sfx(p)); } \
+inline void v_store(lane* p, const vt& a) { _mm256_storeu_##sfx(p, a.val); } \
+inline void v_store_aligned(lane* p, const vt& a) { _mm256_store_##sfx(p, a.val); } \
+template<typename _Tpvec> inline vt v_reinterpret_as_##suffix(const _Tpvec& a) \
+{ return vt(cast(a.val)); } \
+CV_SIMD_DEF_BIN_OP(+, vt, _mm256_add_##sfx) \
+CV_SIMD_DEF_BIN_OP(-, vt, _mm256_sub_##sfx) \
+CV_SIMD_DEF_BIN_OP(*, vt, _mm256_mul_##sfx) \
+CV_SIMD_DEF_BIN_OP(/, vt, _mm256_div_##sfx) \
+CV_SIMD_DEF_BIN_OP(&, vt, _mm256_and_##sfx) \
+CV_SIMD_DEF_BIN_OP(|, vt, _mm256_or_##sfx) \
+CV_SIMD_DEF_BIN_OP(^, vt, _mm256_xor_##sfx) \
+inline vt operator ~ (const vt& a) { return vt(_mm256_xor_##sfx(a.val, cast(_mm256_set1_epi32(-1)))); } \
+inline vt operator == (const vt& a, const vt& b) { return vt(_mm256_cmp_##sfx(a.val, b.val, _CMP_EQ_OQ)); } \
+inline vt operator != (const vt& a, const vt& b) { return vt(_mm256_cmp_##sfx(a.val, b.val, _CMP_NEQ_UQ)); } \
+inline vt operator < (const vt& a, const vt& b) { return vt(_mm256_cmp_##sfx(a.val, b.val, _CMP_LT_OQ)); } \
+inline vt operator > (const vt& a, const vt& b) { return vt(_mm256_cmp_##sfx(a.val, b.val, _CMP_GT_OQ)); } \
+inline vt operator <= (const vt& a, const vt& b) { return vt(_mm256_cmp_##sfx(a.val, b.val, _CMP_LE_OQ)); } \
+inline vt operator >= (const vt& a, const vt& b) { return vt(_mm256_cmp_##sfx(a.val, b.val, _CMP_GE_OQ)); } \
+CV_SIMD_DEF_BIN_FUNC(v_min, vt, _mm256_min_##sfx) \
+CV_SIMD_DEF_BIN_FUNC(v_max, vt, _mm256_max_##sfx) \
+inline vt v_sqrt(const vt& a) { return vt(_mm256_sqrt_##sfx(a.val)); } \
+inline vt v_select(const vt& mask, const vt& a, const vt& b) \
+{ return vt(_mm256_blendv_##sfx(b.val, a.val, mask.val)); }
+
+CV_SIMD_AVX_INIT_FLT(v_float32, float, f32, ps, v_avx_cast_ps)
+CV_SIMD_AVX_INIT_FLT(v_float64, double, f64, pd, v_avx_cast_pd)
+
+#undef CV_SIMD_AVX_INIT_INT
+#undef CV_SIMD_AVX_INIT_FLT
+
+#if defined __FMA__
+inline v_float32 v_muladd(const v_float32& a, const v_float32& b, const v_float32& c)
+{ return v_float32(_mm256_fmadd_ps(a.val, b.val, c.val)); }
+inline v_float64 v_muladd(const v_float64& a, const v_float64& b, const v_float64& c)
+{ return v_float64(_mm256_fmadd_pd(a.val, b.val, c.val)); }
+#else
+inline v_float32 v_muladd(const v_float32& a, const v_float32& b, const v_float32& c) { return a*b + c; }
+inline v_float64 v_muladd(const v_float64& a, const v_float64& b, const v_float64& c) { return a*b + c; }
+#endif
+
+CV_SIMD_DEF_BIN_OP(+, v_uint8, _mm256_adds_epu8)
+CV_SIMD_DEF_BIN_OP(-, v_uint8, _mm256_subs_epu8)
+CV_SIMD_DEF_BIN_OP(+, v_int8, _mm256_adds_epi8)
+CV_SIMD_DEF_BIN_OP(-, v_int8, _mm256_subs_epi8)
+CV_SIMD_DEF_BIN_OP(+, v_uint16, _mm256_adds_epu16)
+CV_SIMD_DEF_BIN_OP(-, v_uint16, _mm256_subs_epu16)
+CV_SIMD_DEF_BIN_OP(+, v_int16, _mm256_adds_epi16)
+CV_SIMD_DEF_BIN_OP(-, v_int16, _mm256_subs_epi16)
+CV_SIMD_DEF_BIN_OP(+, v_uint32, _mm256_add_epi32)
+CV_SIMD_DEF_BIN_OP(-, v_uint32, _mm256_sub_epi32)
+CV_SIMD_DEF_BIN_OP(+, v_int32, _mm256_add_epi32)
+CV_SIMD_DEF_BIN_OP(-, v_int32, _mm256_sub_epi32)
+
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_uint8, _mm256_add_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_int8, _mm256_add_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_uint16, _mm256_add_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_int16, _mm256_add_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_uint8, _mm256_sub_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_int8, _mm256_sub_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_uint16, _mm256_sub_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_int16, _mm256_sub_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_mul_wrap, v_uint16, _mm256_mullo_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_mul_wrap, v_int16, _mm256_mullo_epi16)
+
+CV_SIMD_DEF_CMP_OP(==, v_uint8, _mm256_cmpeq_epi8)
+CV_SIMD_DEF_CMP_OP(==, v_int8, _mm256_cmpeq_epi8)
+CV_SIMD_DEF_CMP_OP(==, v_uint16, _mm256_cmpeq_epi16)
+CV_SIMD_DEF_CMP_OP(==, v_int16, _mm256_cmpeq_epi16)
+CV_SIMD_DEF_CMP_OP(==, v_uint32, _mm256_cmpeq_epi32)
+CV_SIMD_DEF_CMP_OP(==, v_int32, _mm256_cmpeq_epi32)
+CV_SIMD_DEF_CMP_OP(>, v_int8, _mm256_cmpgt_epi8)
+CV_SIMD_DEF_CMP_OP(>, v_int16, _mm256_cmpgt_epi16)
+CV_SIMD_DEF_CMP_OP(>, v_int32, _mm256_cmpgt_epi32)
+
+inline v_uint8 operator > (const v_uint8& a, const v_uint8& b)
+{
+    __m256i d = _mm256_set1_epi8((char)0x80);
+    return v_uint8(_mm256_cmpgt_epi8(_mm256_xor_si256(a.val, d), _mm256_xor_si256(b.val, d)));
+}
+inline v_uint16 operator > (const v_uint16& a, const v_uint16& b)
+{
+    __m256i d = _mm256_set1_epi16((short)0x8000);
+    return v_uint16(_mm256_cmpgt_epi16(_mm256_xor_si256(a.val, d), _mm256_xor_si256(b.val, d)));
+}
+inline v_uint32 operator > (const v_uint32& a, const v_uint32& b)
+{
+    __m256i d = _mm256_set1_epi32((int)0x80000000);
+    return v_uint32(_mm256_cmpgt_epi32(_mm256_xor_si256(a.val, d), _mm256_xor_si256(b.val, d)));
+}
+
+CV_SIMD_DEF_CMP_FROM_GT(v_uint8)
+CV_SIMD_DEF_CMP_FROM_GT(v_int8)
+CV_SIMD_DEF_CMP_FROM_GT(v_uint16)
+CV_SIMD_DEF_CMP_FROM_GT(v_int16)
+CV_SIMD_DEF_CMP_FROM_GT(v_uint32)
+CV_SIMD_DEF_CMP_FROM_GT(v_int32)
+
+CV_SIMD_DEF_BIN_FUNC(v_min, v_uint8, _mm256_min_epu8)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_uint8, _mm256_max_epu8)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_int8, _mm256_min_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_int8, _mm256_max_epi8)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_uint16, _mm256_min_epu16)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_uint16, _mm256_max_epu16)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_int16, _mm256_min_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_int16, _mm256_max_epi16)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_uint32, _mm256_min_epu32)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_uint32, _mm256_max_epu32)
+CV_SIMD_DEF_BIN_FUNC(v_min, v_int32, _mm256_min_epi32)
+CV_SIMD_DEF_BIN_FUNC(v_max, v_int32, _mm256_max_epi32)
+
+inline v_uint8 v_absdiff(const v_uint8& a, const v_uint8& b)
+{ return v_uint8(_mm256_or_si256(_mm256_subs_epu8(a.val, b.val), _mm256_subs_epu8(b.val, a.val))); }
+inline v_uint16 v_absdiff(const v_uint16& a, const v_uint16& b)
+{ return v_uint16(_mm256_or_si256(_mm256_subs_epu16(a.val, b.val), _mm256_subs_epu16(b.val, a.val))); }
+inline v_float32 v_abs(const v_float32& a)
+{ return v_float32(_mm256_and_ps(a.val, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)))); }
+inline v_float64 v_abs(const v_float64& a)
+{ return v_float64(_mm256_and_pd(a.val, _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_set1_epi32(-1), 1)))); }
+inline v_float32 v_absdiff(const v_float32& a, const v_float32& b) { return v_abs(a - b); }
+inline v_float64 v_absdiff(const v_float64& a, const v_float64& b) { return v_abs(a - b); }
+
+template<int n> inline v_uint16 v_shl(const v_uint16& a) { return v_uint16(_mm256_slli_epi16(a.val, n)); }
+template<int n> inline v_int16 v_shl(const v_int16& a) { return v_int16(_mm256_slli_epi16(a.val, n)); }
+template<int n> inline v_uint32 v_shl(const v_uint32& a) { return v_uint32(_mm256_slli_epi32(a.val, n)); }
+template<int n> inline v_int32 v_shl(const v_int32& a) { return v_int32(_mm256_slli_epi32(a.val, n)); }
+template<int n> inline v_uint16 v_shr(const v_uint16& a) { return v_uint16(_mm256_srli_epi16(a.val, n)); }
+template<int n> inline v_int16 v_shr(const v_int16& a) { return v_int16(_mm256_srai_epi16(a.val, n)); }
+template<int n> inline v_uint32 v_shr(const v_uint32& a) { return v_uint32(_mm256_srli_epi32(a.val, n)); }
+template<int n> inline v_int32 v_shr(const v_int32& a) { return v_int32(_mm256_srai_epi32(a.val, n)); }
+
+inline v_int32 v_round(const v_float32& a) { return v_int32(_mm256_cvtps_epi32(a.val)); }
+inline v_int32 v_trunc(const v_float32& a) { return v_int32(_mm256_cvttps_epi32(a.val)); }
+inline v_float32 v_cvt_f32(const v_int32& a) { return v_float32(_mm256_cvtepi32_ps(a.val)); }
+
+// the AVX2 packs work within 128-bit lanes, so the halves are reordered afterwards
+inline v_uint8 v_pack(const v_uint16& a, const v_uint16& b)
+{
+    __m256i m = _mm256_set1_epi16(255);
+    return v_uint8(_mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_min_epu16(a.val, m),
+                                                                 _mm256_min_epu16(b.val, m)), 0xD8));
+}
+inline v_int8 v_pack(const v_int16& a, const v_int16& b)
+{ return v_int8(_mm256_permute4x64_epi64(_mm256_packs_epi16(a.val, b.val), 0xD8)); }
+inline v_uint8 v_pack_u(const v_int16& a, const v_int16& b)
+{ return v_uint8(_mm256_permute4x64_epi64(_mm256_packus_epi16(a.val, b.val), 0xD8)); }
+inline v_int16 v_pack(const v_int32& a, const v_int32& b)
+{ return v_int16(_mm256_permute4x64_epi64(_mm256_packs_epi32(a.val, b.val), 0xD8)); }
+inline v_uint16 v_pack_u(const v_int32& a, const v_int32& b)
+{ return v_uint16(_mm256_permute4x64_epi64(_mm256_packus_epi32(a.val, b.val), 0xD8)); }
+
+inline void v_expand(const v_uint8& a, v_uint16& b0, v_uint16& b1)
+{
+    b0.val = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a.val));
+    b1.val = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a.val, 1));
+}
+inline void v_expand(const v_int8& a, v_int16& b0, v_int16& b1)
+{
+    b0.val = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(a.val));
+    b1.val = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(a.val, 1));
+}
+inline void v_expand(const v_uint16& a, v_uint32& b0, v_uint32& b1)
+{
+    b0.val = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(a.val));
+    b1.val = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(a.val, 1));
+}
+inline void v_expand(const v_int16& a, v_int32& b0, v_int32& b1)
+{
+    b0.val = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(a.val));
+    b1.val = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(a.val, 1));
+}
+
+inline v_uint16 v_load_expand(const uchar* p)
+{ return v_uint16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p))); }
+inline v_int16 v_load_expand(const schar* p)
+{ return v_int16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)p))); }
+inline v_uint32 v_load_expand(const ushort* p)
+{ return v_uint32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+inline v_int32 v_load_expand(const short* p)
+{ return v_int32(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+inline v_uint32 v_load_expand_q(const uchar* p)
+{ return v_uint32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+inline v_int32 v_load_expand_q(const schar* p)
+{ return v_int32(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+
+inline float v_reduce_sum(const v_float32& a)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a.val), _mm256_extractf128_ps(a.val, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+inline int v_reduce_sum(const v_int32& a)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(a.val), _mm256_extracti128_si256(a.val, 1));
+    s = _mm_add_epi32(s, _mm_srli_si128(s, 8));
+    return _mm_cvtsi128_si32(_mm_add_epi32(s, _mm_srli_si128(s, 4)));
+}
+inline float v_reduce_max(const v_float32& a)
+{
+    __m128 s = _mm_max_ps(_mm256_castps256_ps128(a.val), _mm256_extractf128_ps(a.val, 1));
+    s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+inline float v_reduce_min(const v_float32& a)
+{
+    __m128 s = _mm_min_ps(_mm256_castps256_ps128(a.val), _mm256_extractf128_ps(a.val, 1));
+    s = _mm_min_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_min_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+inline int v_signmask(const v_uint8& a) { return _mm256_movemask_epi8(a.val); }
+inline int v_signmask(const v_int8& a) { return _mm256_movemask_epi8(a.val); }
+inline int v_signmask(const v_float32& a) { return _mm256_movemask_ps(a.val); }
+inline bool v_check_all(const v_uint8& a) { return _mm256_movemask_epi8(a.val) == -1; }
+inline bool v_check_any(const v_uint8& a) { return _mm256_movemask_epi8(a.val) != 0; }
+
+inline void v_load_deinterleave(const float* p, v_float32& a, v_float32& b)
+{
+    __m256 t0 = _mm256_loadu_ps(p), t1 = _mm256_loadu_ps(p + 8);
+    a.val = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+        _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+    b.val = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+        _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+inline void v_load_deinterleave(const double* p, v_float64& a, v_float64& b)
+{
+    __m256d t0 = _mm256_loadu_pd(p), t1 = _mm256_loadu_pd(p + 4);
+    a.val = _mm256_permute4x64_pd(_mm256_unpacklo_pd(t0, t1), _MM_SHUFFLE(3, 1, 2, 0));
+    b.val = _mm256_permute4x64_pd(_mm256_unpackhi_pd(t0, t1), _MM_SHUFFLE(3, 1, 2, 0));
+}
+inline void v_store_interleave(float* p, const v_float32& a, const v_float32& b)
+{
+    __m256 t0 = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(a.val), _MM_SHUFFLE(3, 1, 2, 0)));
+    __m256 t1 = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(b.val), _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm256_storeu_ps(p, _mm256_unpacklo_ps(t0, t1));
+    _mm256_storeu_ps(p + 8, _mm256_unpackhi_ps(t0, t1));
+}
+inline void v_store_interleave(double* p, const v_float64& a, const v_float64& b)
+{
+    __m256d t0 = _mm256_permute4x64_pd(a.val, _MM_SHUFFLE(3, 1, 2, 0));
+    __m256d t1 = _mm256_permute4x64_pd(b.val, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_pd(p, _mm256_unpacklo_pd(t0, t1));
+    _mm256_storeu_pd(p + 4, _mm256_unpackhi_pd(t0, t1));
+}
+
+#elif CV_SIMD_NEON
+
+//////////////////////////////////////////// NEON ////////////////////////////////////////////
+
+CV_SIMD_DEF_TYPE(v_uint8, uchar, 16, uint8x16_t);
+CV_SIMD_DEF_TYPE(v_int8, schar, 16, int8x16_t);
+CV_SIMD_DEF_TYPE(v_uint16, ushort, 8, uint16x8_t);
+CV_SIMD_DEF_TYPE(v_int16, short, 8, int16x8_t);
+CV_SIMD_DEF_TYPE(v_uint32, unsigned, 4, uint32x4_t);
+CV_SIMD_DEF_TYPE(v_int32, int, 4, int32x4_t);
+CV_SIMD_DEF_TYPE(v_float32, float, 4, float32x4_t);
+
+// the compare instructions return unsigned masks, vbslq takes them back
+inline uint8x16_t v_neon_umask(const uint8x16_t& m) { return m; }
+inline uint8x16_t v_neon_umask(const int8x16_t& m) { return vreinterpretq_u8_s8(m); }
+inline uint16x8_t v_neon_umask(const uint16x8_t& m) { return m; }
+inline uint16x8_t v_neon_umask(const int16x8_t& m) { return vreinterpretq_u16_s16(m); }
+inline uint32x4_t v_neon_umask(const uint32x4_t& m) { return m; }
+inline uint32x4_t v_neon_umask(const int32x4_t& m) { return vreinterpretq_u32_s32(m); }
+inline uint32x4_t v_neon_umask(const float32x4_t& m) { return vreinterpretq_u32_f32(m); }
+inline uint8x16_t v_neon_mask(const uint8x16_t& m, const uint8x16_t&) { return m; }
+inline int8x16_t v_neon_mask(const uint8x16_t& m, const int8x16_t&) { return vreinterpretq_s8_u8(m); }
+inline uint16x8_t v_neon_mask(const uint16x8_t& m, const uint16x8_t&) { return m; }
+inline int16x8_t v_neon_mask(const uint16x8_t& m, const int16x8_t&) { return vreinterpretq_s16_u16(m); }
+inline uint32x4_t v_neon_mask(const uint32x4_t& m, const uint32x4_t&) { return m; }
+inline int32x4_t v_neon_mask(const uint32x4_t& m, const int32x4_t&) { return vreinterpretq_s32_u32(m); }
+inline float32x4_t v_neon_mask(const uint32x4_t& m, const float32x4_t&) { return vreinterpretq_f32_u32(m); }
+
+#define CV_SIMD_NEON_INIT(vt, lane, suffix, sfx) \
+inline vt v_setzero_##suffix() { return vt(vdupq_n_##sfx((lane)0)); } \
+inline vt v_setall_##suffix(lane v) { return vt(vdupq_n_##sfx(v)); } \
+inline vt v_load(const lane* p) { return vt(vld1q_##sfx(p)); } \
+inline vt v_load_aligned(const lane* p) { return vt(vld1q_##sfx(p)); } \
+inline void v_store(lane* p, const vt& a) { vst1q_##sfx(p, a.val); } \
+inline void v_store_aligned(lane* p, const vt& a) { vst1q_##sfx(p, a.val); } \
+inline vt v_select(const vt& mask, const vt& a, const vt& b) \
+{ return vt(vbslq_##sfx(v_neon_umask(mask.val), a.val, b.val)); } \
+inline vt operator == (const vt& a, const vt& b) { return vt(v_neon_mask(vceqq_##sfx(a.val, b.val), a.val)); } \
+inline vt operator < (const vt& a, const vt& b) { return vt(v_neon_mask(vcltq_##sfx(a.val, b.val), a.val)); } \
+inline vt operator > (const vt& a, const vt& b) { return vt(v_neon_mask(vcgtq_##sfx(a.val, b.val), a.val)); } \
+inline vt operator <= (const vt& a, const vt& b) { return vt(v_neon_mask(vcleq_##sfx(a.val, b.val), a.val)); } \
+inline vt operator >= (const vt& a, const vt& b) { return vt(v_neon_mask(vcgeq_##sfx(a.val, b.val), a.val)); } \
+CV_SIMD_DEF_BIN_FUNC(v_min, vt, vminq_##sfx) \
+CV_SIMD_DEF_BIN_FUNC(v_max, vt, vmaxq_##sfx)
+
+#define CV_SIMD_NEON_INIT_INT(vt, lane, suffix, sfx) \
+CV_SIMD_NEON_INIT(vt, lane, suffix, sfx) \
+CV_SIMD_DEF_BIN_OP(&, vt, vandq_##sfx) \
+CV_SIMD_DEF_BIN_OP(|, vt, vorrq_##sfx) \
+CV_SIMD_DEF_BIN_OP(^, vt, veorq_##sfx) \
+inline vt operator ~ (const vt& a) { return vt(vmvnq_##sfx(a.val)); } \
+inline vt operator != (const vt& a, const vt& b) { return ~(a == b); }
+
+CV_SIMD_NEON_INIT_INT(v_uint8, uchar, u8, u8)
+CV_SIMD_NEON_INIT_INT(v_int8, schar, s8, s8)
+CV_SIMD_NEON_INIT_INT(v_uint16, ushort, u16, u16)
+CV_SIMD_NEON_INIT_INT(v_int16, short, s16, s16)
+CV_SIMD_NEON_INIT_INT(v_uint32, unsigned, u32, u32)
+CV_SIMD_NEON_INIT_INT(v_int32, int, s32, s32)
+CV_SIMD_NEON_INIT(v_float32, float, f32, f32)
+
+#undef CV_SIMD_NEON_INIT_INT
+#undef CV_SIMD_NEON_INIT
+
+#define CV_SIMD_NEON_FLT_BITWISE(op, intrin) \
+inline v_float32 operator op (const v_float32& a, const v_float32& b) \
+{ return v_float32(vreinterpretq_f32_s32(intrin(vreinterpretq_s32_f32(a.val), vreinterpretq_s32_f32(b.val)))); } \
+inline v_float32& operator op##= (v_float32& a, const v_float32& b) { a = a op b; return a; }
+
+CV_SIMD_NEON_FLT_BITWISE(&, vandq_s32)
+CV_SIMD_NEON_FLT_BITWISE(|, vorrq_s32)
+CV_SIMD_NEON_FLT_BITWISE(^, veorq_s32)
+#undef CV_SIMD_NEON_FLT_BITWISE
+
+inline v_float32 operator ~ (const v_float32& a)
+{ return v_float32(vreinterpretq_f32_s32(vmvnq_s32(vreinterpretq_s32_f32(a.val)))); }
+inline v_float32 operator != (const v_float32& a, const v_float32& b) { return ~(a == b); }
+
+template<typename _Tpvec> inline v_uint8 v_reinterpret_as_u8(const _Tpvec& a)
+{ v_uint8 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+template<typename _Tpvec> inline v_int8 v_reinterpret_as_s8(const _Tpvec& a)
+{ v_int8 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+template<typename _Tpvec> inline v_uint16 v_reinterpret_as_u16(const _Tpvec& a)
+{ v_uint16 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+template<typename _Tpvec> inline v_int16 v_reinterpret_as_s16(const _Tpvec& a)
+{ v_int16 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+template<typename _Tpvec> inline v_uint32 v_reinterpret_as_u32(const _Tpvec& a)
+{ v_uint32 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+template<typename _Tpvec> inline v_int32 v_reinterpret_as_s32(const _Tpvec& a)
+{ v_int32 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+template<typename _Tpvec> inline v_float32 v_reinterpret_as_f32(const _Tpvec& a)
+{ v_float32 r; memcpy(&r.val, &a.val, sizeof(r.val)); return r; }
+
+CV_SIMD_DEF_BIN_OP(+, v_uint8, vqaddq_u8)
+CV_SIMD_DEF_BIN_OP(-, v_uint8, vqsubq_u8)
+CV_SIMD_DEF_BIN_OP(+, v_int8, vqaddq_s8)
+CV_SIMD_DEF_BIN_OP(-, v_int8, vqsubq_s8)
+CV_SIMD_DEF_BIN_OP(+, v_uint16, vqaddq_u16)
+CV_SIMD_DEF_BIN_OP(-, v_uint16, vqsubq_u16)
+CV_SIMD_DEF_BIN_OP(+, v_int16, vqaddq_s16)
+CV_SIMD_DEF_BIN_OP(-, v_int16, vqsubq_s16)
+CV_SIMD_DEF_BIN_OP(+, v_uint32, vaddq_u32)
+CV_SIMD_DEF_BIN_OP(-, v_uint32, vsubq_u32)
+CV_SIMD_DEF_BIN_OP(+, v_int32, vaddq_s32)
+CV_SIMD_DEF_BIN_OP(-, v_int32, vsubq_s32)
+CV_SIMD_DEF_BIN_OP(+, v_float32, vaddq_f32)
+CV_SIMD_DEF_BIN_OP(-, v_float32, vsubq_f32)
+CV_SIMD_DEF_BIN_OP(*, v_float32, vmulq_f32)
+
+inline v_float32 operator / (const v_float32& a, const v_float32& b)
+{
+    // two Newton-Raphson steps over the reciprocal estimate
+    float32x4_t r = vrecpeq_f32(b.val);
+    r = vmulq_f32(vrecpsq_f32(b.val, r), r);
+    r = vmulq_f32(vrecpsq_f32(b.val, r), r);
+    return v_float32(vmulq_f32(a.val, r));
+}
+inline v_float32& operator /= (v_float32& a, const v_float32& b) { a = a / b; return a; }
+
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_uint8, vaddq_u8)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_int8, vaddq_s8)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_uint16, vaddq_u16)
+CV_SIMD_DEF_BIN_FUNC(v_add_wrap, v_int16, vaddq_s16)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_uint8, vsubq_u8)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_int8, vsubq_s8)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_uint16, vsubq_u16)
+CV_SIMD_DEF_BIN_FUNC(v_sub_wrap, v_int16, vsubq_s16)
+CV_SIMD_DEF_BIN_FUNC(v_mul_wrap, v_uint16, vmulq_u16)
+CV_SIMD_DEF_BIN_FUNC(v_mul_wrap, v_int16, vmulq_s16)
+
+CV_SIMD_DEF_BIN_FUNC(v_absdiff, v_uint8, vabdq_u8)
+CV_SIMD_DEF_BIN_FUNC(v_absdiff, v_uint16, vabdq_u16)
+CV_SIMD_DEF_BIN_FUNC(v_absdiff, v_float32, vabdq_f32)
+inline v_float32 v_abs(const v_float32& a) { return v_float32(vabsq_f32(a.val)); }
+
+inline v_float32 v_sqrt(const v_float32& a)
+{
+    // rsqrt estimate refined twice; zero lanes are masked out to avoid 0*inf
+    float32x4_t e = vrsqrteq_f32(a.val);
+    e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.val, e), e), e);
+    e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.val, e), e), e);
+    float32x4_t r = vmulq_f32(a.val, e);
+    return v_float32(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(r),
+                     vmvnq_u32(vceqq_f32(a.val, vdupq_n_f32(0.f))))));
+}
+inline v_float32 v_muladd(const v_float32& a, const v_float32& b, const v_float32& c)
+{ return v_float32(vmlaq_f32(c.val, a.val, b.val)); }
+
+template<int n> inline v_uint16 v_shl(const v_uint16& a) { return v_uint16(vshlq_n_u16(a.val, n)); }
+template<int n> inline v_int16 v_shl(const v_int16& a) { return v_int16(vshlq_n_s16(a.val, n)); }
+template<int n> inline v_uint32 v_shl(const v_uint32& a) { return v_uint32(vshlq_n_u32(a.val, n)); }
+template<int n> inline v_int32 v_shl(const v_int32& a) { return v_int32(vshlq_n_s32(a.val, n)); }
+template<int n> inline v_uint16 v_shr(const v_uint16& a) { return v_uint16(vshrq_n_u16(a.val, n)); }
+template<int n> inline v_int16 v_shr(const v_int16& a) { return v_int16(vshrq_n_s16(a.val, n)); }
+template<int n> inline v_uint32 v_shr(const v_uint32& a) { return v_uint32(vshrq_n_u32(a.val, n)); }
+template<int n> inline v_int32 v_shr(const v_int32& a) { return v_int32(vshrq_n_s32(a.val, n)); }
+
+inline v_int32 v_round(const v_float32& a)
+{
+    // round half away from zero, same as cvRound with the default NEON rounding mode
+    static const int32x4_t v_sign = vdupq_n_s32(1 << 31), v_05 = vreinterpretq_s32_f32(vdupq_n_f32(0.5f));
+    int32x4_t v_addition = vorrq_s32(v_05, vandq_s32(v_sign, vreinterpretq_s32_f32(a.val)));
+    return v_int32(vcvtq_s32_f32(vaddq_f32(a.val, vreinterpretq_f32_s32(v_addition))));
+}
+inline v_int32 v_trunc(const v_float32& a) { return v_int32(vcvtq_s32_f32(a.val)); }
+inline v_float32 v_cvt_f32(const v_int32& a) { return v_float32(vcvtq_f32_s32(a.val)); }
+
+inline v_uint8 v_pack(const v_uint16& a, const v_uint16& b)
+{ return v_uint8(vcombine_u8(vqmovn_u16(a.val), vqmovn_u16(b.val))); }
+inline v_int8 v_pack(const v_int16& a, const v_int16& b)
+{ return v_int8(vcombine_s8(vqmovn_s16(a.val), vqmovn_s16(b.val))); }
+inline v_uint8 v_pack_u(const v_int16& a, const v_int16& b)
+{ return v_uint8(vcombine_u8(vqmovun_s16(a.val), vqmovun_s16(b.val))); }
+inline v_int16 v_pack(const v_int32& a, const v_int32& b)
+{ return v_int16(vcombine_s16(vqmovn_s32(a.val), vqmovn_s32(b.val))); }
+inline v_uint16 v_pack_u(const v_int32& a, const v_int32& b)
+{ return v_uint16(vcombine_u16(vqmovun_s32(a.val), vqmovun_s32(b.val))); }
+
+inline void v_expand(const v_uint8& a, v_uint16& b0, v_uint16& b1)
+{ b0.val = vmovl_u8(vget_low_u8(a.val)); b1.val = vmovl_u8(vget_high_u8(a.val)); }
+inline void v_expand(const v_int8& a, v_int16& b0, v_int16& b1)
+{ b0.val = vmovl_s8(vget_low_s8(a.val)); b1.val = vmovl_s8(vget_high_s8(a.val)); }
+inline void v_expand(const v_uint16& a, v_uint32& b0, v_uint32& b1)
+{ b0.val = vmovl_u16(vget_low_u16(a.val)); b1.val = vmovl_u16(vget_high_u16(a.val)); }
+inline void v_expand(const v_int16& a, v_int32& b0, v_int32& b1)
+{ b0.val = vmovl_s16(vget_low_s16(a.val)); b1.val = vmovl_s16(vget_high_s16(a.val)); }
+
+inline v_uint16 v_load_expand(const uchar* p) { return v_uint16(vmovl_u8(vld1_u8(p))); }
+inline v_int16 v_load_expand(const schar* p) { return v_int16(vmovl_s8(vld1_s8(p))); }
+inline v_uint32 v_load_expand(const ushort* p) { return v_uint32(vmovl_u16(vld1_u16(p))); }
+inline v_int32 v_load_expand(const short* p) { return v_int32(vmovl_s16(vld1_s16(p))); }
+inline v_uint32 v_load_expand_q(const uchar* p)
+{
+    uint8x8_t a = vreinterpret_u8_u32(vld1_dup_u32((const unsigned*)p));
+    return v_uint32(vmovl_u16(vget_low_u16(vmovl_u8(a))));
+}
+inline v_int32 v_load_expand_q(const schar* p)
+{
+    int8x8_t a = vreinterpret_s8_s32(vld1_dup_s32((const int*)p));
+    return v_int32(vmovl_s16(vget_low_s16(vmovl_s8(a))));
+}
+
+inline float v_reduce_sum(const v_float32& a)
+{
+    float32x2_t s = vadd_f32(vget_low_f32(a.val), vget_high_f32(a.val));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+inline int v_reduce_sum(const v_int32& a)
+{
+    int32x2_t s = vadd_s32(vget_low_s32(a.val), vget_high_s32(a.val));
+    return vget_lane_s32(vpadd_s32(s, s), 0);
+}
+inline float v_reduce_max(const v_float32& a)
+{
+    float32x2_t s = vmax_f32(vget_low_f32(a.val), vget_high_f32(a.val));
+    return vget_lane_f32(vpmax_f32(s, s), 0);
+}
+inline float v_reduce_min(const v_float32& a)
+{
+    float32x2_t s = vmin_f32(vget_low_f32(a.val), vget_high_f32(a.val));
+    return vget_lane_f32(vpmin_f32(s, s), 0);
+}
+
+inline int v_signmask(const v_uint8& a)
+{
+    uchar buf[16];
+    vst1q_u8(buf, vshrq_n_u8(a.val, 7));
+    int m = 0;
+    for( int i = 0; i < 16; i++ )
+        m |= buf[i] << i;
+    return m;
+}
+inline int v_signmask(const v_int8& a) { return v_signmask(v_reinterpret_as_u8(a)); }
+inline int v_signmask(const v_float32& a)
+{
+    unsigned buf[4];
+    vst1q_u32(buf, vshrq_n_u32(vreinterpretq_u32_f32(a.val), 31));
+    return (int)(buf[0] | (buf[1] << 1) | (buf[2] << 2) | (buf[3] << 3));
+}
+inline bool v_check_all(const v_uint8& a)
+{
+    uint8x8_t m = vand_u8(vget_low_u8(a.val), vget_high_u8(a.val));
+    return vget_lane_u64(vreinterpret_u64_u8(m), 0) == (uint64)-1;
+}
+inline bool v_check_any(const v_uint8& a)
+{
+    uint8x8_t m = vorr_u8(vget_low_u8(a.val), vget_high_u8(a.val));
+    return vget_lane_u64(vreinterpret_u64_u8(m), 0) != 0;
+}
+
+inline void v_load_deinterleave(const float* p, v_float32& a, v_float32& b)
+{
+    float32x4x2_t t = vld2q_f32(p);
+    a.val = t.val[0];
+    b.val = t.val[1];
+}
+inline void v_store_interleave(float* p, const v_float32& a, const v_float32& b)
+{
+    float32x4x2_t t;
+    t.val[0] = a.val;
+    t.val[1] = b.val;
+    vst2q_f32(p, t);
+}
+
+#else
+
+/////////////////////////////////////////// scalar ///////////////////////////////////////////
+
+// Plain C++ implementation with the same semantics; used when no SIMD instruction set
+// is available, and as the reference for the other backends.
+
+template<typename _Tp, int n> struct v_reg
+{
+    typedef _Tp lane_type;
+    enum { nlanes = n };
+    _Tp val[n];
+};
+
+typedef v_reg<uchar, 16> v_uint8;
+typedef v_reg<schar, 16> v_int8;
+typedef v_reg<ushort, 8> v_uint16;
+typedef v_reg<short, 8> v_int16;
+typedef v_reg<unsigned, 4> v_uint32;
+typedef v_reg<int, 4> v_int32;
+typedef v_reg<float, 4> v_float32;
+typedef v_reg<double, 2> v_float64;
+
+// integer type of the same width, used for the bitwise operations and the masks
+template<typename _Tp> struct v_reg_int { typedef _Tp type; };
+template<> struct v_reg_int<float> { typedef int type; };
+template<> struct v_reg_int<double> { typedef int64 type; };
+
+template<typename _Tp, int n> inline v_reg<_Tp, n> v_reg_all(_Tp v)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = v;
+    return r;
+}
+
+inline v_uint8 v_setzero_u8() { return v_reg_all<uchar, 16>(0); }
+inline v_int8 v_setzero_s8() { return v_reg_all<schar, 16>(0); }
+inline v_uint16 v_setzero_u16() { return v_reg_all<ushort, 8>(0); }
+inline v_int16 v_setzero_s16() { return v_reg_all<short, 8>(0); }
+inline v_uint32 v_setzero_u32() { return v_reg_all<unsigned, 4>(0); }
+inline v_int32 v_setzero_s32() { return v_reg_all<int, 4>(0); }
+inline v_float32 v_setzero_f32() { return v_reg_all<float, 4>(0); }
+inline v_float64 v_setzero_f64() { return v_reg_all<double, 2>(0); }
+inline v_uint8 v_setall_u8(uchar v) { return v_reg_all<uchar, 16>(v); }
+inline v_int8 v_setall_s8(schar v) { return v_reg_all<schar, 16>(v); }
+inline v_uint16 v_setall_u16(ushort v) { return v_reg_all<ushort, 8>(v); }
+inline v_int16 v_setall_s16(short v) { return v_reg_all<short, 8>(v); }
+inline v_uint32 v_setall_u32(unsigned v) { return v_reg_all<unsigned, 4>(v); }
+inline v_int32 v_setall_s32(int v) { return v_reg_all<int, 4>(v); }
+inline v_float32 v_setall_f32(float v) { return v_reg_all<float, 4>(v); }
+inline v_float64 v_setall_f64(double v) { return v_reg_all<double, 2>(v); }
+
+#define CV_SIMD_SCALAR_LOAD(lane, n) \
+inline v_reg<lane, n> v_load(const lane* p) \
+{ v_reg<lane, n> r; for( int i = 0; i < n; i++ ) r.val[i] = p[i]; return r; } \
+inline v_reg<lane, n> v_load_aligned(const lane* p) { return v_load(p); }
+
+CV_SIMD_SCALAR_LOAD(uchar, 16)
+CV_SIMD_SCALAR_LOAD(schar, 16)
+CV_SIMD_SCALAR_LOAD(ushort, 8)
+CV_SIMD_SCALAR_LOAD(short, 8)
+CV_SIMD_SCALAR_LOAD(unsigned, 4)
+CV_SIMD_SCALAR_LOAD(int, 4)
+CV_SIMD_SCALAR_LOAD(float, 4)
+CV_SIMD_SCALAR_LOAD(double, 2)
+#undef CV_SIMD_SCALAR_LOAD
+
+template<typename _Tp, int n> inline void v_store(_Tp* p, const v_reg<_Tp, n>& a)
+{
+    for( int i = 0; i < n; i++ )
+        p[i] = a.val[i];
+}
+template<typename _Tp, int n> inline void v_store_aligned(_Tp* p, const v_reg<_Tp, n>& a)
+{ v_store(p, a); }
+
+template<typename _Tp2, typename _Tp, int n>
+inline v_reg<_Tp2, (int)(n*sizeof(_Tp)/sizeof(_Tp2))> v_reg_reinterpret(const v_reg<_Tp, n>& a)
+{
+    v_reg<_Tp2, (int)(n*sizeof(_Tp)/sizeof(_Tp2))> r;
+    memcpy(r.val, a.val, sizeof(a.val));
+    return r;
+}
+
+template<typename _Tp, int n> inline v_uint8 v_reinterpret_as_u8(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<uchar>(a); }
+template<typename _Tp, int n> inline v_int8 v_reinterpret_as_s8(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<schar>(a); }
+template<typename _Tp, int n> inline v_uint16 v_reinterpret_as_u16(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<ushort>(a); }
+template<typename _Tp, int n> inline v_int16 v_reinterpret_as_s16(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<short>(a); }
+template<typename _Tp, int n> inline v_uint32 v_reinterpret_as_u32(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<unsigned>(a); }
+template<typename _Tp, int n> inline v_int32 v_reinterpret_as_s32(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<int>(a); }
+template<typename _Tp, int n> inline v_float32 v_reinterpret_as_f32(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<float>(a); }
+template<typename _Tp, int n> inline v_float64 v_reinterpret_as_f64(const v_reg<_Tp, n>& a) { return v_reg_reinterpret<double>(a); }
+
+// + and - saturate for the 8- and 16-bit types (and are plain for the others,
+// as saturate_cast to the same 32/64-bit type is a no-op)
+#define CV_SIMD_SCALAR_ARITHM_OP(op) \
+template<typename _Tp, int n> inline v_reg<_Tp, n> operator op (const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+{ \
+    v_reg<_Tp, n> r; \
+    for( int i = 0; i < n; i++ ) \
+        r.val[i] = saturate_cast<_Tp>(a.val[i] op b.val[i]); \
+    return r; \
+} \
+template<typename _Tp, int n> inline v_reg<_Tp, n>& operator op##= (v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+{ a = a op b; return a; }
+
+CV_SIMD_SCALAR_ARITHM_OP(+)
+CV_SIMD_SCALAR_ARITHM_OP(-)
+CV_SIMD_SCALAR_ARITHM_OP(*)
+CV_SIMD_SCALAR_ARITHM_OP(/)
+#undef CV_SIMD_SCALAR_ARITHM_OP
+
+#define CV_SIMD_SCALAR_WRAP_OP(func, op) \
+template<typename _Tp, int n> inline v_reg<_Tp, n> func(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+{ \
+    v_reg<_Tp, n> r; \
+    for( int i = 0; i < n; i++ ) \
+        r.val[i] = (_Tp)(a.val[i] op b.val[i]); \
+    return r; \
+}
+
+CV_SIMD_SCALAR_WRAP_OP(v_add_wrap, +)
+CV_SIMD_SCALAR_WRAP_OP(v_sub_wrap, -)
+CV_SIMD_SCALAR_WRAP_OP(v_mul_wrap, *)
+#undef CV_SIMD_SCALAR_WRAP_OP
+
+#define CV_SIMD_SCALAR_BIT_OP(op) \
+template<typename _Tp, int n> inline v_reg<_Tp, n> operator op (const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+{ \
+    typedef typename v_reg_int<_Tp>::type itype; \
+    v_reg<_Tp, n> r; \
+    for( int i = 0; i < n; i++ ) \
+    { \
+        itype ia, ib; \
+        memcpy(&ia, &a.val[i], sizeof(_Tp)); \
+        memcpy(&ib, &b.val[i], sizeof(_Tp)); \
+        ia = (itype)(ia op ib); \
+        memcpy(&r.val[i], &ia, sizeof(_Tp)); \
+    } \
+    return r; \
+} \
+template<typename _Tp, int n> inline v_reg<_Tp, n>& operator op##= (v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+{ a = a op b; return a; }
+
+CV_SIMD_SCALAR_BIT_OP(&)
+CV_SIMD_SCALAR_BIT_OP(|)
+CV_SIMD_SCALAR_BIT_OP(^)
+#undef CV_SIMD_SCALAR_BIT_OP
+
+template<typename _Tp, int n> inline v_reg<_Tp, n> operator ~ (const v_reg<_Tp, n>& a)
+{
+    typedef typename v_reg_int<_Tp>::type itype;
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+    {
+        itype v;
+        memcpy(&v, &a.val[i], sizeof(_Tp));
+        v = (itype)~v;
+        memcpy(&r.val[i], &v, sizeof(_Tp));
+    }
+    return r;
+}
+
+// comparisons produce all-ones lanes, like the hardware compare instructions
+#define CV_SIMD_SCALAR_CMP_OP(op) \
+template<typename _Tp, int n> inline v_reg<_Tp, n> operator op (const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b) \
+{ \
+    typedef typename v_reg_int<_Tp>::type itype; \
+    v_reg<_Tp, n> r; \
+    for( int i = 0; i < n; i++ ) \
+    { \
+        itype v = a.val[i] op b.val[i] ? (itype)-1 : (itype)0; \
+        memcpy(&r.val[i], &v, sizeof(_Tp)); \
+    } \
+    return r; \
+}
+
+CV_SIMD_SCALAR_CMP_OP(==)
+CV_SIMD_SCALAR_CMP_OP(!=)
+CV_SIMD_SCALAR_CMP_OP(<)
+CV_SIMD_SCALAR_CMP_OP(>)
+CV_SIMD_SCALAR_CMP_OP(<=)
+CV_SIMD_SCALAR_CMP_OP(>=)
+#undef CV_SIMD_SCALAR_CMP_OP
+
+template<typename _Tp, int n> inline v_reg<_Tp, n> v_min(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = std::min(a.val[i], b.val[i]);
+    return r;
+}
+template<typename _Tp, int n> inline v_reg<_Tp, n> v_max(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = std::max(a.val[i], b.val[i]);
+    return r;
+}
+template<typename _Tp, int n> inline v_reg<_Tp, n> v_absdiff(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = a.val[i] > b.val[i] ? (_Tp)(a.val[i] - b.val[i]) : (_Tp)(b.val[i] - a.val[i]);
+    return r;
+}
+template<typename _Tp, int n> inline v_reg<_Tp, n> v_abs(const v_reg<_Tp, n>& a)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = std::abs(a.val[i]);
+    return r;
+}
+template<typename _Tp, int n> inline v_reg<_Tp, n> v_sqrt(const v_reg<_Tp, n>& a)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = std::sqrt(a.val[i]);
+    return r;
+}
+template<typename _Tp, int n>
+inline v_reg<_Tp, n> v_muladd(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b, const v_reg<_Tp, n>& c)
+{ return a*b + c; }
+
+template<typename _Tp, int n>
+inline v_reg<_Tp, n> v_select(const v_reg<_Tp, n>& mask, const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{ return b ^ ((a ^ b) & mask); }
+
+template<int s, typename _Tp, int n> inline v_reg<_Tp, n> v_shl(const v_reg<_Tp, n>& a)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = (_Tp)(a.val[i] << s);
+    return r;
+}
+template<int s, typename _Tp, int n> inline v_reg<_Tp, n> v_shr(const v_reg<_Tp, n>& a)
+{
+    v_reg<_Tp, n> r;
+    for( int i = 0; i < n; i++ )
+        r.val[i] = (_Tp)(a.val[i] >> s);
+    return r;
+}
+
+inline v_int32 v_round(const v_float32& a)
+{ v_int32 r; for( int i = 0; i < 4; i++ ) r.val[i] = cvRound(a.val[i]); return r; }
+inline v_int32 v_trunc(const v_float32& a)
+{ v_int32 r; for( int i = 0; i < 4; i++ ) r.val[i] = (int)a.val[i]; return r; }
+inline v_float32 v_cvt_f32(const v_int32& a)
+{ v_float32 r; for( int i = 0; i < 4; i++ ) r.val[i] = (float)a.val[i]; return r; }
+
+template<typename _Tp2, typename _Tp, int n>
+inline v_reg<_Tp2, n*2> v_reg_pack(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    v_reg<_Tp2, n*2> r;
+    for( int i = 0; i < n; i++ )
+    {
+        r.val[i] = saturate_cast<_Tp2>(a.val[i]);
+        r.val[i+n] = saturate_cast<_Tp2>(b.val[i]);
+    }
+    return r;
+}
+
+inline v_uint8 v_pack(const v_uint16& a, const v_uint16& b) { return v_reg_pack<uchar>(a, b); }
+inline v_int8 v_pack(const v_int16& a, const v_int16& b) { return v_reg_pack<schar>(a, b); }
+inline v_uint8 v_pack_u(const v_int16& a, const v_int16& b) { return v_reg_pack<uchar>(a, b); }
+inline v_int16 v_pack(const v_int32& a, const v_int32& b) { return v_reg_pack<short>(a, b); }
+inline v_uint16 v_pack_u(const v_int32& a, const v_int32& b) { return v_reg_pack<ushort>(a, b); }
+
+template<typename _Tp, int n, typename _Tp2>
+inline void v_expand(const v_reg<_Tp, n>& a, v_reg<_Tp2, n/2>& b0, v_reg<_Tp2, n/2>& b1)
+{
+    for( int i = 0; i < n/2; i++ )
+    {
+        b0.val[i] = a.val[i];
+        b1.val[i] = a.val[i+n/2];
+    }
+}
+
+template<typename _Tp2, typename _Tp> inline v_reg<_Tp2, 16/sizeof(_Tp2)> v_reg_load_expand(const _Tp* p)
+{
+    v_reg<_Tp2, 16/sizeof(_Tp2)> r;
+    for( int i = 0; i < (int)(16/sizeof(_Tp2)); i++ )
+        r.val[i] = p[i];
+    return r;
+}
+
+inline v_uint16 v_load_expand(const uchar* p) { return v_reg_load_expand<ushort>(p); }
+inline v_int16 v_load_expand(const schar* p) { return v_reg_load_expand<short>(p); }
+inline v_uint32 v_load_expand(const ushort* p) { return v_reg_load_expand<unsigned>(p); }
+inline v_int32 v_load_expand(const short* p) { return v_reg_load_expand<int>(p); }
+inline v_uint32 v_load_expand_q(const uchar* p) { return v_reg_load_expand<unsigned>(p); }
+inline v_int32 v_load_expand_q(const schar* p) { return v_reg_load_expand<int>(p); }
+
+template<typename _Tp, int n> inline _Tp v_reduce_sum(const v_reg<_Tp, n>& a)
+{
+    _Tp s = a.val[0];
+    for( int i = 1; i < n; i++ )
+        s += a.val[i];
+    return s;
+}
+template<typename _Tp, int n> inline _Tp v_reduce_min(const v_reg<_Tp, n>& a)
+{
+    _Tp s = a.val[0];
+    for( int i = 1; i < n; i++ )
+        s = std::min(s, a.val[i]);
+    return s;
+}
+template<typename _Tp, int n> inline _Tp v_reduce_max(const v_reg<_Tp, n>& a)
+{
+    _Tp s = a.val[0];
+    for( int i = 1; i < n; i++ )
+        s = std::max(s, a.val[i]);
+    return s;
+}
+
+template<typename _Tp, int n> inline int v_signmask(const v_reg<_Tp, n>& a)
+{
+    typedef typename v_reg_int<_Tp>::type itype;
+    int m = 0;
+    for( int i = 0; i < n; i++ )
+    {
+        itype v;
+        memcpy(&v, &a.val[i], sizeof(_Tp));
+        m |= (int)((v >> (sizeof(_Tp)*8 - 1)) & 1) << i;
+    }
+    return m;
+}
+inline bool v_check_all(const v_uint8& a) { return v_signmask(a) == 0xffff; }
+inline bool v_check_any(const v_uint8& a) { return v_signmask(a) != 0; }
+
+template<typename _Tp, int n> inline void v_load_deinterleave(const _Tp* p, v_reg<_Tp, n>& a, v_reg<_Tp, n>& b)
+{
+    for( int i = 0; i < n; i++ )
+    {
+        a.val[i] = p[i*2];
+        b.val[i] = p[i*2+1];
+    }
+}
+template<typename _Tp, int n> inline void v_store_interleave(_Tp* p, const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b)
+{
+    for( int i = 0; i < n; i++ )
+    {
+        p[i*2] = a.val[i];
+        p[i*2+1] = b.val[i];
+    }
+}
+
+#endif
+
+#undef CV_SIMD_DEF_TYPE
+#undef CV_SIMD_DEF_BIN_OP
+#undef CV_SIMD_DEF_CMP_OP
+#undef CV_SIMD_DEF_BIN_FUNC
+#undef CV_SIMD_DEF_CMP_FROM_GT
+
+/*!
+  Tells whether the vector code path may be taken on this machine.
+
+  The answer depends on the instruction set the calling translation unit is compiled
+  for, and it follows setUseOptimized(), so the kernels can be switched back to
+  their plain C++ loops at runtime.
+*/
+inline bool checkSIMDSupport()
+{
+#if CV_SIMD_AVX2
+    return checkHardwareSupport(CV_CPU_AVX2);
+#elif CV_SIMD_SSE4_1
+    return checkHardwareSupport(CV_CPU_SSE4_1);
+#elif CV_SIMD_SSE
+    return checkHardwareSupport(CV_CPU_SSE2);
+#elif CV_SIMD_NEON
+    return useOptimized();
+#else
+    return false;
+#endif
+}
+
+} // CV_SIMD_NAMESPACE
+
+using namespace CV_SIMD_NAMESPACE;
+
+}
+
+#endif
+
+/* End of file. */
@@ -1755,6 +1755,11 @@ typedef struct CvFileStorage CvFileStorage;
 #define CV_STORAGE_FORMAT_AUTO   0
 #define CV_STORAGE_FORMAT_XML    8
 #define CV_STORAGE_FORMAT_YAML  16
+#define CV_STORAGE_FORMAT_BINARY 24
+#define CV_STORAGE_BASE64       64
+#define CV_STORAGE_LAZY        128
+#define CV_STORAGE_FLOAT16     256
+#define CV_STORAGE_MAP_DATA    512
 
 /* List of attributes: */
 typedef struct CvAttrList
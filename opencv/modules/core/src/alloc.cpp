@@ -42,644 +42,623 @@
 
 #include "precomp.hpp"
 
-#define CV_USE_SYSTEM_MALLOC 1
+#if defined _MSC_VER && _MSC_VER >= 1400
+#include <intrin.h>
+#endif
+
+/*
+   fastMalloc/fastFree can work in two modes:
+
+   - the system mode (the default), where every call goes to malloc/free;
+   - the pool mode (see setUseFastMallocPool()), where the freed buffers are kept in
+     the size-class free lists and reused by the subsequent fastMalloc calls.
+     The small buffers are cached per thread without any locking, the big ones
+     (e.g. the frame buffers) go to the global pool, shared by all the threads.
+
+   In both modes the buffers are aligned by FAST_MALLOC_ALIGN bytes and preceded by
+   BlockHeader, which tells fastFree where the buffer came from, so the mode can be
+   switched at any time.
+*/
 
 namespace cv
 {
 
-static void* OutOfMemoryError(size_t size)
+enum
 {
-    CV_Error_(CV_StsNoMem, ("Failed to allocate %lu bytes", (unsigned long)size));
-    return 0;
-}
+    FAST_MALLOC_ALIGN = 64,       // enough for any SIMD load/store; also the cache line size
+    BIN_SUBDIV_SHIFT = 3,         // 8 size classes per power of two, i.e. <=12.5% overhead
+    MIN_BIN_SHIFT = 6,            // bin #0 holds the blocks of up to 64 bytes
+    MAX_BIN_SHIFT = 28,           // the blocks bigger than 256Mb are never cached
+    MAX_BIN = (MAX_BIN_SHIFT - MIN_BIN_SHIFT)*(1 << BIN_SUBDIV_SHIFT)
+};
 
-#if CV_USE_SYSTEM_MALLOC
+// the blocks of this size and bigger bypass the thread caches
+static const size_t BIG_BLOCK_SIZE = 1 << 20;
+// the per-thread cache limits
+static const size_t THREAD_CACHE_SIZE = 4 << 20;
+static const int THREAD_CACHE_BIN_BLOCKS = 256;
 
-#if defined WIN32 || defined _WIN32
-void deleteThreadAllocData() {}
-#endif
+static const int BLOCK_SIGNATURE = 0x5AFEB10C;
 
-void* fastMalloc( size_t size )
+struct BlockHeader
 {
-    uchar* udata = (uchar*)malloc(size + sizeof(void*) + CV_MALLOC_ALIGN);
-    if(!udata)
-        return OutOfMemoryError(size);
-    uchar** adata = alignPtr((uchar**)udata + 1, CV_MALLOC_ALIGN);
-    adata[-1] = udata;
-    return adata;
+    uchar* udata;       // the pointer returned by malloc
+    BlockHeader* next;  // the next block in the free list
+    size_t size;        // the requested size
+    int bin;            // the size class or -1 if the block is not cached
+    int signature;
+};
+
+static inline int sizeToBin(size_t size)
+{
+    if( size <= ((size_t)1 << MIN_BIN_SHIFT) )
+        return 0;
+    size_t sz = size - 1;
+    int e = MIN_BIN_SHIFT;
+    while( (sz >> (e + 1)) != 0 )
+        e++;
+    int sub = (int)(sz >> (e - BIN_SUBDIV_SHIFT)) - (1 << BIN_SUBDIV_SHIFT);
+    return ((e - MIN_BIN_SHIFT) << BIN_SUBDIV_SHIFT) + sub + 1;
 }
 
-void fastFree(void* ptr)
+static inline size_t binToSize(int bin)
 {
-    if(ptr)
-    {
-        uchar* udata = ((uchar**)ptr)[-1];
-        CV_DbgAssert(udata < (uchar*)ptr &&
-               ((uchar*)ptr - udata) <= (ptrdiff_t)(sizeof(void*)+CV_MALLOC_ALIGN));
-        free(udata);
-    }
+    if( bin == 0 )
+        return (size_t)1 << MIN_BIN_SHIFT;
+    int e = ((bin - 1) >> BIN_SUBDIV_SHIFT) + MIN_BIN_SHIFT;
+    int sub = (bin - 1) & ((1 << BIN_SUBDIV_SHIFT) - 1);
+    return (size_t)((1 << BIN_SUBDIV_SHIFT) + sub + 1) << (e - BIN_SUBDIV_SHIFT);
 }
 
-#else //CV_USE_SYSTEM_MALLOC
+static void* OutOfMemoryError(size_t size)
+{
+    CV_Error_(CV_StsNoMem, ("Failed to allocate %lu bytes", (unsigned long)size));
+    return 0;
+}
 
-#if 0
-#define SANITY_CHECK(block) \
-    CV_Assert(((size_t)(block) & (MEM_BLOCK_SIZE-1)) == 0 && \
-        (unsigned)(block)->binIdx <= (unsigned)MAX_BIN && \
-        (block)->signature == MEM_BLOCK_SIGNATURE)
+/////////////////////////////////// statistics /////////////////////////////////////
+
+#if defined _MSC_VER && defined _WIN64
+static inline size_t atomicAdd(volatile size_t* addr, ptrdiff_t delta)
+{ return (size_t)_InterlockedExchangeAdd64((__int64 volatile*)addr, (__int64)delta); }
+static inline bool atomicCompareAndSwap(volatile size_t* addr, size_t oldval, size_t newval)
+{ return (size_t)_InterlockedCompareExchange64((__int64 volatile*)addr, (__int64)newval, (__int64)oldval) == oldval; }
+#elif defined _MSC_VER
+static inline size_t atomicAdd(volatile size_t* addr, ptrdiff_t delta)
+{ return (size_t)_InterlockedExchangeAdd((long volatile*)addr, (long)delta); }
+static inline bool atomicCompareAndSwap(volatile size_t* addr, size_t oldval, size_t newval)
+{ return (size_t)_InterlockedCompareExchange((long volatile*)addr, (long)newval, (long)oldval) == oldval; }
+#elif defined __GNUC__
+static inline size_t atomicAdd(volatile size_t* addr, ptrdiff_t delta)
+{ return __sync_fetch_and_add(addr, (size_t)delta); }
+static inline bool atomicCompareAndSwap(volatile size_t* addr, size_t oldval, size_t newval)
+{ return __sync_bool_compare_and_swap(addr, oldval, newval); }
 #else
-#define SANITY_CHECK(block)
-#endif
-
-#define STAT(stmt)
-
-#ifdef WIN32
-struct CriticalSection
+static Mutex& statMutex()
 {
-    CriticalSection() { InitializeCriticalSection(&cs); }
-    ~CriticalSection() { DeleteCriticalSection(&cs); }
-    void lock() { EnterCriticalSection(&cs); }
-    void unlock() { LeaveCriticalSection(&cs); }
-    bool trylock() { return TryEnterCriticalSection(&cs) != 0; }
+    static Mutex* m = new Mutex;
+    return *m;
+}
+static inline size_t atomicAdd(volatile size_t* addr, ptrdiff_t delta)
+{ AutoLock lock(statMutex()); size_t val = *addr; *addr += delta; return val; }
+static inline bool atomicCompareAndSwap(volatile size_t* addr, size_t oldval, size_t newval)
+{ AutoLock lock(statMutex()); bool ok = *addr == oldval; if( ok ) *addr = newval; return ok; }
+#endif
 
-    CRITICAL_SECTION cs;
-};
+static volatile size_t bytesInUse = 0, peakBytesInUse = 0, bytesCached = 0;
+static volatile size_t allocCalls = 0, freeCalls = 0, poolHits = 0;
 
-void* SystemAlloc(size_t size)
+static inline void updateAllocStat(size_t size)
 {
-    void* ptr = malloc(size);
-    return ptr ? ptr : OutOfMemoryError(size);
+    atomicAdd(&allocCalls, 1);
+    size_t inUse = atomicAdd(&bytesInUse, (ptrdiff_t)size) + size;
+    for( size_t peak = peakBytesInUse; inUse > peak; peak = peakBytesInUse )
+        if( atomicCompareAndSwap(&peakBytesInUse, peak, inUse) )
+            break;
 }
 
-void SystemFree(void* ptr, size_t)
+static inline void updateFreeStat(size_t size)
 {
-    free(ptr);
+    atomicAdd(&freeCalls, 1);
+    atomicAdd(&bytesInUse, -(ptrdiff_t)size);
 }
-#else //WIN32
 
-#include <sys/mman.h>
+//////////////////////////////////// the pool //////////////////////////////////////
 
-struct CriticalSection
-{
-    CriticalSection() { pthread_mutex_init(&mutex, 0); }
-    ~CriticalSection() { pthread_mutex_destroy(&mutex); }
-    void lock() { pthread_mutex_lock(&mutex); }
-    void unlock() { pthread_mutex_unlock(&mutex); }
-    bool trylock() { return pthread_mutex_trylock(&mutex) == 0; }
-
-    pthread_mutex_t mutex;
-};
+static volatile bool usePool = false;
+static volatile size_t poolLimit = 0;
 
-void* SystemAlloc(size_t size)
+static BlockHeader* allocBlock(size_t capacity, int bin)
 {
-    #ifndef MAP_ANONYMOUS
-    #define MAP_ANONYMOUS MAP_ANON
-    #endif
-    void* ptr = 0;
-    ptr = mmap(ptr, size, (PROT_READ | PROT_WRITE), MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
-    return ptr != MAP_FAILED ? ptr : OutOfMemoryError(size);
+    uchar* udata = (uchar*)malloc(capacity + sizeof(BlockHeader) + FAST_MALLOC_ALIGN);
+    if( !udata )
+    {
+        // give the cached memory back to the system and try again
+        releaseFastMallocPool();
+        udata = (uchar*)malloc(capacity + sizeof(BlockHeader) + FAST_MALLOC_ALIGN);
+        if( !udata )
+            return 0;
+    }
+    BlockHeader* hdr = (BlockHeader*)alignPtr(udata + sizeof(BlockHeader), FAST_MALLOC_ALIGN) - 1;
+    hdr->udata = udata;
+    hdr->next = 0;
+    hdr->bin = bin;
+    hdr->signature = BLOCK_SIGNATURE;
+    return hdr;
 }
 
-void SystemFree(void* ptr, size_t size)
+static inline void freeBlock(BlockHeader* hdr)
 {
-    munmap(ptr, size);
+    hdr->signature = 0;
+    free(hdr->udata);
 }
-#endif //WIN32
 
-struct AutoLock
+struct GlobalPool
 {
-    AutoLock(CriticalSection& _cs) : cs(&_cs) { cs->lock(); }
-    ~AutoLock() { cs->unlock(); }
-    CriticalSection* cs;
-};
-
-const size_t MEM_BLOCK_SIGNATURE = 0x01234567;
-const int MEM_BLOCK_SHIFT = 14;
-const size_t MEM_BLOCK_SIZE = 1 << MEM_BLOCK_SHIFT;
-const size_t HDR_SIZE = 128;
-const size_t MAX_BLOCK_SIZE = MEM_BLOCK_SIZE - HDR_SIZE;
-const int MAX_BIN = 28;
-
-static const int binSizeTab[MAX_BIN+1] =
-{ 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 128, 160, 192, 256, 320, 384, 480, 544, 672, 768,
-896, 1056, 1328, 1600, 2688, 4048, 5408, 8128, 16256 };
+    GlobalPool()
+    {
+        for( int i = 0; i <= MAX_BIN; i++ )
+            bins[i] = 0;
+    }
 
-struct MallocTables
-{
-    void initBinTab()
+    BlockHeader* pop(int bin)
     {
-        int i, j = 0, n;
-        for( i = 0; i <= MAX_BIN; i++ )
+        if( !bins[bin] )
+            return 0;
+        AutoLock lock(mutex);
+        BlockHeader* hdr = bins[bin];
+        if( hdr )
         {
-            n = binSizeTab[i]>>3;
-            for( ; j <= n; j++ )
-                binIdx[j] = (uchar)i;
+            bins[bin] = hdr->next;
+            atomicAdd(&bytesCached, -(ptrdiff_t)binToSize(bin));
         }
+        return hdr;
     }
-    int bin(size_t size)
+
+    void push(BlockHeader* hdr)
     {
-        assert( size <= MAX_BLOCK_SIZE );
-        return binIdx[(size + 7)>>3];
+        size_t sz = binToSize(hdr->bin);
+        if( usePool && bytesCached + sz <= poolLimit )
+        {
+            AutoLock lock(mutex);
+            hdr->next = bins[hdr->bin];
+            bins[hdr->bin] = hdr;
+            atomicAdd(&bytesCached, (ptrdiff_t)sz);
+        }
+        else
+            freeBlock(hdr);
     }
 
-    MallocTables()
+    void release()
     {
-        initBinTab();
+        BlockHeader* lists[MAX_BIN+1];
+        {
+        AutoLock lock(mutex);
+        for( int i = 0; i <= MAX_BIN; i++ )
+        {
+            lists[i] = bins[i];
+            bins[i] = 0;
+        }
+        }
+        for( int i = 0; i <= MAX_BIN; i++ )
+        {
+            size_t sz = binToSize(i);
+            for( BlockHeader* hdr = lists[i]; hdr != 0; )
+            {
+                BlockHeader* next = hdr->next;
+                freeBlock(hdr);
+                atomicAdd(&bytesCached, -(ptrdiff_t)sz);
+                hdr = next;
+            }
+        }
     }
 
-    uchar binIdx[MAX_BLOCK_SIZE/8+1];
+    Mutex mutex;
+    BlockHeader* volatile bins[MAX_BIN+1];
 };
 
-MallocTables mallocTables;
-
-struct Node
+// the pool is never destroyed, since the thread caches can be flushed into it
+// after the static objects are destructed
+static GlobalPool& globalPool()
 {
-    Node* next;
-};
-
-struct ThreadData;
+    static GlobalPool* pool = new GlobalPool;
+    return *pool;
+}
 
-struct Block
+struct ThreadCache
 {
-    Block(Block* _next)
+    ThreadCache()
     {
-        signature = MEM_BLOCK_SIGNATURE;
-        prev = 0;
-        next = _next;
-        privateFreeList = publicFreeList = 0;
-        bumpPtr = endPtr = 0;
-        objSize = 0;
-        threadData = 0;
-        data = (uchar*)this + HDR_SIZE;
+        for( int i = 0; i <= MAX_BIN; i++ )
+        {
+            bins[i] = 0;
+            counts[i] = 0;
+        }
+        cachedSize = 0;
     }
 
-    ~Block() {}
+    ~ThreadCache() { flush(); }
 
-    void init(Block* _prev, Block* _next, int _objSize, ThreadData* _threadData)
+    BlockHeader* pop(int bin)
     {
-        prev = _prev;
-        if(prev)
-            prev->next = this;
-        next = _next;
-        if(next)
-            next->prev = this;
-        objSize = _objSize;
-        binIdx = mallocTables.bin(objSize);
-        threadData = _threadData;
-        privateFreeList = publicFreeList = 0;
-        bumpPtr = data;
-        int nobjects = MAX_BLOCK_SIZE/objSize;
-        endPtr = bumpPtr + nobjects*objSize;
-        almostEmptyThreshold = (nobjects + 1)/2;
-        allocated = 0;
+        BlockHeader* hdr = bins[bin];
+        if( hdr )
+        {
+            size_t sz = binToSize(bin);
+            bins[bin] = hdr->next;
+            counts[bin]--;
+            cachedSize -= sz;
+            atomicAdd(&bytesCached, -(ptrdiff_t)sz);
+        }
+        return hdr;
     }
 
-    bool isFilled() const { return allocated > almostEmptyThreshold; }
-
-    size_t signature;
-    Block* prev;
-    Block* next;
-    Node* privateFreeList;
-    Node* publicFreeList;
-    uchar* bumpPtr;
-    uchar* endPtr;
-    uchar* data;
-    ThreadData* threadData;
-    int objSize;
-    int binIdx;
-    int allocated;
-    int almostEmptyThreshold;
-    CriticalSection cs;
-};
-
-struct BigBlock
-{
-    BigBlock(int bigBlockSize, BigBlock* _next)
+    void push(BlockHeader* hdr)
     {
-        first = alignPtr((Block*)(this+1), MEM_BLOCK_SIZE);
-        next = _next;
-        nblocks = (int)(((char*)this + bigBlockSize - (char*)first)/MEM_BLOCK_SIZE);
-        Block* p = 0;
-        for( int i = nblocks-1; i >= 0; i-- )
-            p = ::new((uchar*)first + i*MEM_BLOCK_SIZE) Block(p);
+        int bin = hdr->bin;
+        size_t sz = binToSize(bin);
+        if( counts[bin] >= THREAD_CACHE_BIN_BLOCKS || cachedSize + sz > THREAD_CACHE_SIZE ||
+            bytesCached + sz > poolLimit )
+        {
+            globalPool().push(hdr);
+            return;
+        }
+        hdr->next = bins[bin];
+        bins[bin] = hdr;
+        counts[bin]++;
+        cachedSize += sz;
+        atomicAdd(&bytesCached, (ptrdiff_t)sz);
     }
 
-    ~BigBlock()
+    void flush()
     {
-        for( int i = nblocks-1; i >= 0; i-- )
-            ((Block*)((uchar*)first+i*MEM_BLOCK_SIZE))->~Block();
+        GlobalPool& pool = globalPool();
+        for( int i = 0; i <= MAX_BIN; i++ )
+        {
+            BlockHeader* hdr;
+            while( (hdr = pop(i)) != 0 )
+                pool.push(hdr);
+        }
     }
 
-    BigBlock* next;
-    Block* first;
-    int nblocks;
+    BlockHeader* bins[MAX_BIN+1];
+    int counts[MAX_BIN+1];
+    size_t cachedSize;
 };
 
-struct BlockPool
+///////////////////////////////// scratch arenas ///////////////////////////////////
+
+/*
+   The scratch arena is a stack of the temporary buffers, allocated from a few big chunks.
+   Each buffer is preceded by ScratchBlock header, which links it to the previous buffer.
+   The buffers can be released in any order, but the memory is reused only when all the
+   buffers allocated after it are released too. Once the arena becomes empty, the chunks
+   are merged into a single one, so in the steady state every allocation is just a pointer
+   increment within a single chunk. resetScratchArenas() marks the frame boundary, at which
+   the arena is trimmed to the peak usage of the last frame or released completely.
+   An empty arena never keeps more than MAX_IDLE_SCRATCH_SIZE bytes, so the threads that
+   once needed a big buffer do not hold it until they exit.
+*/
+
+static const size_t MIN_SCRATCH_CHUNK_SIZE = 1 << 16;
+static const size_t MAX_IDLE_SCRATCH_SIZE = 1 << 22;
+
+static volatile int scratchFrame = 0;
+static volatile int scratchReleaseFrame = 0;
+
+struct ScratchBlock
+{
+    ScratchBlock* prev;
+    size_t mark;
+    int chunk;
+    bool freed;
+};
+
+struct ScratchArena
 {
-    BlockPool(int _bigBlockSize=1<<20) : pool(0), bigBlockSize(_bigBlockSize)
+    struct Chunk
     {
-    }
+        uchar* data;
+        size_t size;
+        size_t base;
+    };
+
+    ScratchArena() : cur(-1), top(0), last(0), peak(0), reserve(0), frame(scratchFrame) {}
+    ~ScratchArena() { releaseChunks(); }
 
-    ~BlockPool()
+    void* allocate(size_t size)
     {
-        AutoLock lock(cs);
-        while( pool )
+        if( !last )
+            idle();
+        size_t sz = alignSize(size, FAST_MALLOC_ALIGN) + FAST_MALLOC_ALIGN;
+        if( cur < 0 || top - chunks[cur].base + sz > chunks[cur].size )
         {
-            BigBlock* nextBlock = pool->next;
-            pool->~BigBlock();
-            SystemFree(pool, bigBlockSize);
-            pool = nextBlock;
+            if( cur + 1 < (int)chunks.size() && chunks[cur+1].size >= sz )
+                cur++;
+            else
+            {
+                size_t capacity = 0;
+                for( size_t i = cur + 1; i < chunks.size(); i++ )
+                    fastFree(chunks[i].data);
+                chunks.resize(cur + 1);
+                for( size_t i = 0; i < chunks.size(); i++ )
+                    capacity += chunks[i].size;
+                Chunk chunk;
+                chunk.size = std::max(std::max(sz, reserve), std::max(capacity, MIN_SCRATCH_CHUNK_SIZE));
+                chunk.data = (uchar*)fastMalloc(chunk.size);
+                chunks.push_back(chunk);
+                cur = (int)chunks.size() - 1;
+            }
+            chunks[cur].base = top;
         }
+        ScratchBlock* block = (ScratchBlock*)(chunks[cur].data + (top - chunks[cur].base));
+        block->prev = last;
+        block->mark = top;
+        block->chunk = cur;
+        block->freed = false;
+        last = block;
+        top += sz;
+        peak = std::max(peak, top);
+        return (uchar*)block + FAST_MALLOC_ALIGN;
     }
 
-    Block* alloc()
+    void deallocate(void* ptr)
     {
-        AutoLock lock(cs);
-        Block* block;
-        if( !freeBlocks )
+        ScratchBlock* block = (ScratchBlock*)((uchar*)ptr - FAST_MALLOC_ALIGN);
+        block->freed = true;
+        while( last && last->freed )
         {
-            BigBlock* bblock = ::new(SystemAlloc(bigBlockSize)) BigBlock(bigBlockSize, pool);
-            assert( bblock != 0 );
-            freeBlocks = bblock->first;
-            pool = bblock;
+            top = last->mark;
+            cur = last->chunk;
+            last = last->prev;
         }
-        block = freeBlocks;
-        freeBlocks = freeBlocks->next;
-        if( freeBlocks )
-            freeBlocks->prev = 0;
-        STAT(stat.bruttoBytes += MEM_BLOCK_SIZE);
-        return block;
+        if( !last )
+            idle();
     }
 
-    void free(Block* block)
+    size_t capacity() const
     {
-        AutoLock lock(cs);
-        block->prev = 0;
-        block->next = freeBlocks;
-        freeBlocks = block;
-        STAT(stat.bruttoBytes -= MEM_BLOCK_SIZE);
+        size_t capacity = 0;
+        for( size_t i = 0; i < chunks.size(); i++ )
+            capacity += chunks[i].size;
+        return capacity;
     }
 
-    CriticalSection cs;
-    Block* freeBlocks;
-    BigBlock* pool;
-    int bigBlockSize;
-    int blocksPerBigBlock;
-};
-
-BlockPool mallocPool;
-
-enum { START=0, FREE=1, GC=2 };
-
-struct ThreadData
-{
-    ThreadData() { for(int i = 0; i <= MAX_BIN; i++) bins[i][START] = bins[i][FREE] = bins[i][GC] = 0; }
-    ~ThreadData()
+    void releaseChunks()
     {
-        // mark all the thread blocks as abandoned or even release them
-        for( int i = 0; i <= MAX_BIN; i++ )
-        {
-            Block *bin = bins[i][START], *block = bin;
-            bins[i][START] = bins[i][FREE] = bins[i][GC] = 0;
-            if( block )
-            {
-                do
-                {
-                    Block* next = block->next;
-                    int allocated = block->allocated;
-                    {
-                    AutoLock lock(block->cs);
-                    block->next = block->prev = 0;
-                    block->threadData = 0;
-                    Node *node = block->publicFreeList;
-                    for( ; node != 0; node = node->next )
-                        allocated--;
-                    }
-                    if( allocated == 0 )
-                        mallocPool.free(block);
-                    block = next;
-                }
-                while( block != bin );
-            }
-        }
+        for( size_t i = 0; i < chunks.size(); i++ )
+            fastFree(chunks[i].data);
+        chunks.clear();
+        cur = -1;
     }
 
-    void moveBlockToFreeList( Block* block )
+    // called when all the buffers are released
+    void idle()
     {
-        int i = block->binIdx;
-        Block*& freePtr = bins[i][FREE];
-        CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-        if( block != freePtr )
+        top = 0;
+        cur = chunks.empty() ? -1 : 0;
+        int currFrame = scratchFrame;
+        if( frame != currFrame )
         {
-            Block*& gcPtr = bins[i][GC];
-            if( gcPtr == block )
-                gcPtr = block->next;
-            if( block->next != block )
+            size_t framePeak = peak;
+            bool releaseAll = scratchReleaseFrame - frame > 0;
+            frame = currFrame;
+            peak = 0;
+            reserve = 0;
+            if( releaseAll || capacity() > framePeak*2 )
             {
-                block->prev->next = block->next;
-                block->next->prev = block->prev;
+                // the chunk will be re-allocated on demand
+                releaseChunks();
+                if( !releaseAll )
+                    reserve = framePeak;
             }
-            block->next = freePtr->next;
-            block->prev = freePtr;
-            freePtr = block->next->prev = block->prev->next = block;
         }
+        if( chunks.size() > 1 )
+        {
+            reserve = capacity();
+            releaseChunks();
+        }
+        if( reserve > MAX_IDLE_SCRATCH_SIZE )
+            reserve = 0;
+        if( capacity() > MAX_IDLE_SCRATCH_SIZE )
+            releaseChunks();
     }
 
-    Block* bins[MAX_BIN+1][3];
+    vector<Chunk> chunks;
+    int cur;
+    size_t top;
+    ScratchBlock* last;
+    size_t peak;
+    size_t reserve;
+    int frame;
+};
+
+// the per-thread allocator data; the arena goes after the cache,
+// so it is destroyed first and its chunks go to the global pool
+struct ThreadAllocData
+{
+    ThreadCache cache;
+    ScratchArena arena;
+
+    static ThreadAllocData* get(bool create=true);
+};
 
-#ifdef WIN32
+#if defined WIN32 || defined _WIN32 || defined WINCE
 #ifdef WINCE
 #   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
-#endif //WINCE
+#endif
+
+static DWORD tlsAllocKey = TLS_OUT_OF_INDEXES;
 
-    static DWORD tlsKey;
-    static ThreadData* get()
+void deleteThreadAllocData()
+{
+    if( tlsAllocKey != TLS_OUT_OF_INDEXES )
     {
-        ThreadData* data;
-        if( tlsKey == TLS_OUT_OF_INDEXES )
-            tlsKey = TlsAlloc();
-        data = (ThreadData*)TlsGetValue(tlsKey);
-        if( !data )
-        {
-            data = new ThreadData;
-            TlsSetValue(tlsKey, data);
-        }
-        return data;
+        ThreadAllocData* data = (ThreadAllocData*)TlsGetValue( tlsAllocKey );
+        TlsSetValue( tlsAllocKey, 0 );
+        delete data;
     }
-#else //WIN32
-    static void deleteData(void* data)
+}
+
+ThreadAllocData* ThreadAllocData::get(bool create)
+{
+    if( tlsAllocKey == TLS_OUT_OF_INDEXES )
     {
-        delete (ThreadData*)data;
+        tlsAllocKey = TlsAlloc();
+        CV_Assert(tlsAllocKey != TLS_OUT_OF_INDEXES);
     }
-
-    static pthread_key_t tlsKey;
-    static ThreadData* get()
+    ThreadAllocData* data = (ThreadAllocData*)TlsGetValue( tlsAllocKey );
+    if( !data && create )
     {
-        ThreadData* data;
-        if( !tlsKey )
-            pthread_key_create(&tlsKey, deleteData);
-        data = (ThreadData*)pthread_getspecific(tlsKey);
-        if( !data )
-        {
-            data = new ThreadData;
-            pthread_setspecific(tlsKey, data);
-        }
-        return data;
+        data = new ThreadAllocData;
+        TlsSetValue( tlsAllocKey, data );
     }
-#endif //WIN32
-};
+    return data;
+}
 
-#ifdef WIN32
-DWORD ThreadData::tlsKey = TLS_OUT_OF_INDEXES;
+#else
 
-void deleteThreadAllocData()
+static pthread_key_t tlsAllocKey = 0;
+static pthread_once_t tlsAllocKeyOnce = PTHREAD_ONCE_INIT;
+
+static void destroyThreadAllocData(void* data)
 {
-    if( ThreadData::tlsKey != TLS_OUT_OF_INDEXES )
-        delete (ThreadData*)TlsGetValue( ThreadData::tlsKey );
+    delete (ThreadAllocData*)data;
 }
 
-#else //WIN32
-pthread_key_t ThreadData::tlsKey = 0;
-#endif //WIN32
+static void makeThreadAllocKey()
+{
+    int errcode = pthread_key_create(&tlsAllocKey, destroyThreadAllocData);
+    CV_Assert(errcode == 0);
+}
 
-#if 0
-static void checkList(ThreadData* tls, int idx)
+ThreadAllocData* ThreadAllocData::get(bool create)
 {
-    Block* block = tls->bins[idx][START];
-    if( !block )
-    {
-        CV_DbgAssert( tls->bins[idx][FREE] == 0 && tls->bins[idx][GC] == 0 );
-    }
-    else
+    pthread_once(&tlsAllocKeyOnce, makeThreadAllocKey);
+    ThreadAllocData* data = (ThreadAllocData*)pthread_getspecific(tlsAllocKey);
+    if( !data && create )
     {
-        bool gcInside = false;
-        bool freeInside = false;
-        do
-        {
-            if( tls->bins[idx][FREE] == block )
-                freeInside = true;
-            if( tls->bins[idx][GC] == block )
-                gcInside = true;
-            block = block->next;
-        }
-        while( block != tls->bins[idx][START] );
-        CV_DbgAssert( gcInside && freeInside );
+        data = new ThreadAllocData;
+        pthread_setspecific(tlsAllocKey, data);
     }
+    return data;
 }
-#else
-#define checkList(tls, idx)
+
 #endif
 
 void* fastMalloc( size_t size )
 {
-    if( size > MAX_BLOCK_SIZE )
+    BlockHeader* hdr = 0;
+    if( usePool && size <= binToSize(MAX_BIN) )
     {
-        size_t size1 = size + sizeof(uchar*)*2 + MEM_BLOCK_SIZE;
-        uchar* udata = (uchar*)SystemAlloc(size1);
-        uchar** adata = alignPtr((uchar**)udata + 2, MEM_BLOCK_SIZE);
-        adata[-1] = udata;
-        adata[-2] = (uchar*)size1;
-        return adata;
+        int bin = sizeToBin(size);
+        if( binToSize(bin) < BIG_BLOCK_SIZE )
+            hdr = ThreadAllocData::get()->cache.pop(bin);
+        if( !hdr )
+            hdr = globalPool().pop(bin);
+        if( hdr )
+            atomicAdd(&poolHits, 1);
+        else
+            hdr = allocBlock(binToSize(bin), bin);
     }
+    else
+        hdr = allocBlock(size, -1);
 
-    {
-    ThreadData* tls = ThreadData::get();
-    int idx = mallocTables.bin(size);
-    Block*& startPtr = tls->bins[idx][START];
-    Block*& gcPtr = tls->bins[idx][GC];
-    Block*& freePtr = tls->bins[idx][FREE], *block = freePtr;
-    checkList(tls, idx);
-    size = binSizeTab[idx];
-    STAT(
-        stat.nettoBytes += size;
-        stat.mallocCalls++;
-        );
-    uchar* data = 0;
-
-    for(;;)
-    {
-        if( block )
-        {
-            // try to find non-full block
-            for(;;)
-            {
-                CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-                if( block->bumpPtr )
-                {
-                    data = block->bumpPtr;
-                    if( (block->bumpPtr += size) >= block->endPtr )
-                        block->bumpPtr = 0;
-                    break;
-                }
-
-                if( block->privateFreeList )
-                {
-                    data = (uchar*)block->privateFreeList;
-                    block->privateFreeList = block->privateFreeList->next;
-                    break;
-                }
-
-                if( block == startPtr )
-                    break;
-                block = block->next;
-            }
-#if 0
-            avg_k += _k;
-            avg_nk++;
-            if( avg_nk == 1000 )
-            {
-                printf("avg search iters per 1e3 allocs = %g\n", (double)avg_k/avg_nk );
-                avg_k = avg_nk = 0;
-            }
-#endif
+    if( !hdr )
+        return OutOfMemoryError(size);
+    hdr->size = size;
+    updateAllocStat(size);
+    return hdr + 1;
+}
 
-            freePtr = block;
-            if( !data )
-            {
-                block = gcPtr;
-                for( int k = 0; k < 2; k++ )
-                {
-                    SANITY_CHECK(block);
-                    CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-                    if( block->publicFreeList )
-                    {
-                        {
-                        AutoLock lock(block->cs);
-                        block->privateFreeList = block->publicFreeList;
-                        block->publicFreeList = 0;
-                        }
-                        Node* node = block->privateFreeList;
-                        for(;node != 0; node = node->next)
-                            --block->allocated;
-                        data = (uchar*)block->privateFreeList;
-                        block->privateFreeList = block->privateFreeList->next;
-                        gcPtr = block->next;
-                        if( block->allocated+1 <= block->almostEmptyThreshold )
-                            tls->moveBlockToFreeList(block);
-                        break;
-                    }
-                    block = block->next;
-                }
-                if( !data )
-                    gcPtr = block;
-            }
-        }
+void fastFree(void* ptr)
+{
+    if( !ptr )
+        return;
+    BlockHeader* hdr = (BlockHeader*)ptr - 1;
+    CV_DbgAssert( hdr->signature == BLOCK_SIGNATURE && (uchar*)ptr - hdr->udata <=
+                  (ptrdiff_t)(sizeof(BlockHeader) + FAST_MALLOC_ALIGN) );
+    updateFreeStat(hdr->size);
 
+    if( hdr->bin >= 0 && usePool )
+    {
+        ThreadAllocData* data = binToSize(hdr->bin) < BIG_BLOCK_SIZE ? ThreadAllocData::get(false) : 0;
         if( data )
-            break;
-        block = mallocPool.alloc();
-        block->init(startPtr ? startPtr->prev : block, startPtr ? startPtr : block, (int)size, tls);
-        if( !startPtr )
-            startPtr = gcPtr = freePtr = block;
-        checkList(tls, block->binIdx);
-        SANITY_CHECK(block);
+            data->cache.push(hdr);
+        else
+            globalPool().push(hdr);
     }
+    else
+        freeBlock(hdr);
+}
 
-    ++block->allocated;
-    return data;
-    }
+bool setUseFastMallocPool( bool flag, size_t maxCachedBytes )
+{
+    bool prev = usePool;
+    // construct the pool before any thread can use it
+    globalPool();
+    poolLimit = maxCachedBytes;
+    usePool = flag;
+    if( !flag )
+        releaseFastMallocPool();
+    return prev;
 }
 
-void fastFree( void* ptr )
+bool useFastMallocPool()
 {
-    if( ((size_t)ptr & (MEM_BLOCK_SIZE-1)) == 0 )
-    {
-        if( ptr != 0 )
-        {
-            void* origPtr = ((void**)ptr)[-1];
-            size_t sz = (size_t)((void**)ptr)[-2];
-            SystemFree( origPtr, sz );
-        }
-        return;
-    }
+    return usePool;
+}
 
-    {
-    ThreadData* tls = ThreadData::get();
-    Node* node = (Node*)ptr;
-    Block* block = (Block*)((size_t)ptr & -(int)MEM_BLOCK_SIZE);
-    assert( block->signature == MEM_BLOCK_SIGNATURE );
+void releaseFastMallocPool()
+{
+    // the blocks cached by the other threads are released when the threads exit
+    ThreadAllocData::get()->cache.flush();
+    globalPool().release();
+}
 
-    if( block->threadData == tls )
-    {
-        STAT(
-        stat.nettoBytes -= block->objSize;
-        stat.freeCalls++;
-        float ratio = (float)stat.nettoBytes/stat.bruttoBytes;
-        if( stat.minUsageRatio > ratio )
-            stat.minUsageRatio = ratio;
-        );
-
-        SANITY_CHECK(block);
-
-        bool prevFilled = block->isFilled();
-        --block->allocated;
-        if( !block->isFilled() && (block->allocated == 0 || prevFilled) )
-        {
-            if( block->allocated == 0 )
-            {
-                int idx = block->binIdx;
-                Block*& startPtr = tls->bins[idx][START];
-                Block*& freePtr = tls->bins[idx][FREE];
-                Block*& gcPtr = tls->bins[idx][GC];
-
-                if( block == block->next )
-                {
-                    CV_DbgAssert( startPtr == block && freePtr == block && gcPtr == block );
-                    startPtr = freePtr = gcPtr = 0;
-                }
-                else
-                {
-                    if( freePtr == block )
-                        freePtr = block->next;
-                    if( gcPtr == block )
-                        gcPtr = block->next;
-                    if( startPtr == block )
-                        startPtr = block->next;
-                    block->prev->next = block->next;
-                    block->next->prev = block->prev;
-                }
-                mallocPool.free(block);
-                checkList(tls, idx);
-                return;
-            }
+FastMallocStats getFastMallocStats()
+{
+    FastMallocStats stats;
+    stats.bytesInUse = bytesInUse;
+    stats.peakBytesInUse = peakBytesInUse;
+    stats.bytesCached = bytesCached;
+    stats.allocCalls = allocCalls;
+    stats.freeCalls = freeCalls;
+    stats.poolHits = poolHits;
+    return stats;
+}
 
-            tls->moveBlockToFreeList(block);
-        }
-        node->next = block->privateFreeList;
-        block->privateFreeList = node;
-    }
-    else
-    {
-        AutoLock lock(block->cs);
-        SANITY_CHECK(block);
+void resetFastMallocPeak()
+{
+    peakBytesInUse = bytesInUse;
+}
 
-        node->next = block->publicFreeList;
-        block->publicFreeList = node;
-        if( block->threadData == 0 )
-        {
-            // take ownership of the abandoned block.
-            // note that it can happen at the same time as
-            // ThreadData::deleteData() marks the blocks as abandoned,
-            // so this part of the algorithm needs to be checked for data races
-            int idx = block->binIdx;
-            block->threadData = tls;
-            Block*& startPtr = tls->bins[idx][START];
-
-            if( startPtr )
-            {
-                block->next = startPtr;
-                block->prev = startPtr->prev;
-                block->next->prev = block->prev->next = block;
-            }
-            else
-                startPtr = tls->bins[idx][FREE] = tls->bins[idx][GC] = block;
-        }
-    }
-    }
+void* scratchAlloc( size_t size )
+{
+    return ThreadAllocData::get()->arena.allocate(size);
+}
+
+void scratchFree( void* ptr )
+{
+    if( ptr )
+        ThreadAllocData::get()->arena.deallocate(ptr);
 }
 
-#endif //CV_USE_SYSTEM_MALLOC
+void resetScratchArenas( bool releaseMemory )
+{
+    int frame = CV_XADD(&scratchFrame, 1) + 1;
+    if( releaseMemory )
+        scratchReleaseFrame = frame;
+    ThreadAllocData* data = ThreadAllocData::get(false);
+    if( data && !data->arena.last )
+        data->arena.idle();
+}
+
+size_t getScratchArenaSize()
+{
+    ThreadAllocData* data = ThreadAllocData::get(false);
+    return data ? data->arena.capacity() : 0;
+}
 
 }
 
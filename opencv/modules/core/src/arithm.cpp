@@ -47,6 +47,7 @@
 // */
 
 #include "precomp.hpp"
+#include "arithm_simd.hpp"
 
 namespace cv
 {
@@ -65,93 +66,26 @@ IPPArithmInitializer ippArithmInitializer;
 
 struct NOP {};
 
-template<typename T, class Op, class Op8>
-void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, size_t step, Size sz)
+template<typename T>
+inline int vBinOpSIMD(const T*, const T*, T*, int, NOP)
 {
-#if CV_SSE2
-    Op8 op8;
-#endif
-    Op op;
-
-    for( ; sz.height--; src1 += step1/sizeof(src1[0]),
-                        src2 += step2/sizeof(src2[0]),
-                        dst += step/sizeof(dst[0]) )
-    {
-        int x = 0;
-
-    #if CV_SSE2
-        if( USE_SSE2 )
-        {
-            for( ; x <= sz.width - 32; x += 32 )
-            {
-                __m128i r0 = _mm_loadu_si128((const __m128i*)(src1 + x));
-                __m128i r1 = _mm_loadu_si128((const __m128i*)(src1 + x + 16));
-                r0 = op8(r0,_mm_loadu_si128((const __m128i*)(src2 + x)));
-                r1 = op8(r1,_mm_loadu_si128((const __m128i*)(src2 + x + 16)));
-                _mm_storeu_si128((__m128i*)(dst + x), r0);
-                _mm_storeu_si128((__m128i*)(dst + x + 16), r1);
-            }
-            for( ; x <= sz.width - 8; x += 8 )
-            {
-                __m128i r0 = _mm_loadl_epi64((const __m128i*)(src1 + x));
-                r0 = op8(r0,_mm_loadl_epi64((const __m128i*)(src2 + x)));
-                _mm_storel_epi64((__m128i*)(dst + x), r0);
-            }
-        }
-    #endif
-#if CV_ENABLE_UNROLLED
-        for( ; x <= sz.width - 4; x += 4 )
-        {
-            T v0 = op(src1[x], src2[x]);
-            T v1 = op(src1[x+1], src2[x+1]);
-            dst[x] = v0; dst[x+1] = v1;
-            v0 = op(src1[x+2], src2[x+2]);
-            v1 = op(src1[x+3], src2[x+3]);
-            dst[x+2] = v0; dst[x+3] = v1;
-        }
-#endif
-        for( ; x < sz.width; x++ )
-            dst[x] = op(src1[x], src2[x]);
-    }
+    return 0;
 }
 
-template<typename T, class Op, class Op16>
-void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
-              T* dst, size_t step, Size sz)
+template<typename T, class Op, class VOp>
+void vBinOp(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, size_t step, Size sz)
 {
-#if CV_SSE2
-    Op16 op16;
-#endif
+    bool useSIMD = checkSIMDSupport();
+    VOp vop;
     Op op;
 
     for( ; sz.height--; src1 += step1/sizeof(src1[0]),
-        src2 += step2/sizeof(src2[0]),
-        dst += step/sizeof(dst[0]) )
+                        src2 += step2/sizeof(src2[0]),
+                        dst += step/sizeof(dst[0]) )
     {
-        int x = 0;
-
-    #if CV_SSE2
-        if( USE_SSE2 )
-        {
-            for( ; x <= sz.width - 16; x += 16 )
-            {
-                __m128i r0 = _mm_loadu_si128((const __m128i*)(src1 + x));
-                __m128i r1 = _mm_loadu_si128((const __m128i*)(src1 + x + 8));
-                r0 = op16(r0,_mm_loadu_si128((const __m128i*)(src2 + x)));
-                r1 = op16(r1,_mm_loadu_si128((const __m128i*)(src2 + x + 8)));
-                _mm_storeu_si128((__m128i*)(dst + x), r0);
-                _mm_storeu_si128((__m128i*)(dst + x + 8), r1);
-            }
-            for( ; x <= sz.width - 4; x += 4 )
-            {
-                __m128i r0 = _mm_loadl_epi64((const __m128i*)(src1 + x));
-                r0 = op16(r0,_mm_loadl_epi64((const __m128i*)(src2 + x)));
-                _mm_storel_epi64((__m128i*)(dst + x), r0);
-            }
-        }
-        else
-    #endif
+        int x = useSIMD ? vBinOpSIMD(src1, src2, dst, sz.width, vop) : 0;
 
+#if CV_ENABLE_UNROLLED
         for( ; x <= sz.width - 4; x += 4 )
         {
             T v0 = op(src1[x], src2[x]);
@@ -161,308 +95,24 @@ void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
             v1 = op(src1[x+3], src2[x+3]);
             dst[x+2] = v0; dst[x+3] = v1;
         }
-
-        for( ; x < sz.width; x++ )
-            dst[x] = op(src1[x], src2[x]);
-    }
-}
-
-
-template<class Op, class Op32>
-void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
-               int* dst, size_t step, Size sz)
-{
-#if CV_SSE2
-    Op32 op32;
-#endif
-    Op op;
-
-    for( ; sz.height--; src1 += step1/sizeof(src1[0]),
-        src2 += step2/sizeof(src2[0]),
-        dst += step/sizeof(dst[0]) )
-    {
-        int x = 0;
-
-#if CV_SSE2
-        if( USE_SSE2 )
-        {
-            if( (((size_t)src1|(size_t)src2|(size_t)dst)&15) == 0 )
-                for( ; x <= sz.width - 8; x += 8 )
-                {
-                    __m128i r0 = _mm_load_si128((const __m128i*)(src1 + x));
-                    __m128i r1 = _mm_load_si128((const __m128i*)(src1 + x + 4));
-                    r0 = op32(r0,_mm_load_si128((const __m128i*)(src2 + x)));
-                    r1 = op32(r1,_mm_load_si128((const __m128i*)(src2 + x + 4)));
-                    _mm_store_si128((__m128i*)(dst + x), r0);
-                    _mm_store_si128((__m128i*)(dst + x + 4), r1);
-                }
-            else
-                for( ; x <= sz.width - 8; x += 8 )
-                {
-                    __m128i r0 = _mm_loadu_si128((const __m128i*)(src1 + x));
-                    __m128i r1 = _mm_loadu_si128((const __m128i*)(src1 + x + 4));
-                    r0 = op32(r0,_mm_loadu_si128((const __m128i*)(src2 + x)));
-                    r1 = op32(r1,_mm_loadu_si128((const __m128i*)(src2 + x + 4)));
-                    _mm_storeu_si128((__m128i*)(dst + x), r0);
-                    _mm_storeu_si128((__m128i*)(dst + x + 4), r1);
-                }
-        }
-#endif
-#if CV_ENABLE_UNROLLED
-        for( ; x <= sz.width - 4; x += 4 )
-        {
-            int v0 = op(src1[x], src2[x]);
-            int v1 = op(src1[x+1], src2[x+1]);
-            dst[x] = v0; dst[x+1] = v1;
-            v0 = op(src1[x+2], src2[x+2]);
-            v1 = op(src1[x+3], src2[x+3]);
-            dst[x+2] = v0; dst[x+3] = v1;
-        }
-#endif
-        for( ; x < sz.width; x++ )
-            dst[x] = op(src1[x], src2[x]);
-    }
-}
-
-
-template<class Op, class Op32>
-void vBinOp32f(const float* src1, size_t step1, const float* src2, size_t step2,
-               float* dst, size_t step, Size sz)
-{
-#if CV_SSE2
-    Op32 op32;
-#endif
-    Op op;
-
-    for( ; sz.height--; src1 += step1/sizeof(src1[0]),
-        src2 += step2/sizeof(src2[0]),
-        dst += step/sizeof(dst[0]) )
-    {
-        int x = 0;
-
-    #if CV_SSE2
-        if( USE_SSE2 )
-        {
-            if( (((size_t)src1|(size_t)src2|(size_t)dst)&15) == 0 )
-                for( ; x <= sz.width - 8; x += 8 )
-                {
-                    __m128 r0 = _mm_load_ps(src1 + x);
-                    __m128 r1 = _mm_load_ps(src1 + x + 4);
-                    r0 = op32(r0,_mm_load_ps(src2 + x));
-                    r1 = op32(r1,_mm_load_ps(src2 + x + 4));
-                    _mm_store_ps(dst + x, r0);
-                    _mm_store_ps(dst + x + 4, r1);
-                }
-            else
-                for( ; x <= sz.width - 8; x += 8 )
-                {
-                    __m128 r0 = _mm_loadu_ps(src1 + x);
-                    __m128 r1 = _mm_loadu_ps(src1 + x + 4);
-                    r0 = op32(r0,_mm_loadu_ps(src2 + x));
-                    r1 = op32(r1,_mm_loadu_ps(src2 + x + 4));
-                    _mm_storeu_ps(dst + x, r0);
-                    _mm_storeu_ps(dst + x + 4, r1);
-                }
-        }
-    #endif
-#if CV_ENABLE_UNROLLED
-        for( ; x <= sz.width - 4; x += 4 )
-        {
-            float v0 = op(src1[x], src2[x]);
-            float v1 = op(src1[x+1], src2[x+1]);
-            dst[x] = v0; dst[x+1] = v1;
-            v0 = op(src1[x+2], src2[x+2]);
-            v1 = op(src1[x+3], src2[x+3]);
-            dst[x+2] = v0; dst[x+3] = v1;
-        }
 #endif
         for( ; x < sz.width; x++ )
             dst[x] = op(src1[x], src2[x]);
     }
 }
 
-template<class Op, class Op64>
-void vBinOp64f(const double* src1, size_t step1, const double* src2, size_t step2,
-               double* dst, size_t step, Size sz)
-{
-#if CV_SSE2
-    Op64 op64;
-#endif
-    Op op;
-
-    for( ; sz.height--; src1 += step1/sizeof(src1[0]),
-        src2 += step2/sizeof(src2[0]),
-        dst += step/sizeof(dst[0]) )
-    {
-        int x = 0;
-
-    #if CV_SSE2
-        if( USE_SSE2 && (((size_t)src1|(size_t)src2|(size_t)dst)&15) == 0 )
-            for( ; x <= sz.width - 4; x += 4 )
-            {
-                __m128d r0 = _mm_load_pd(src1 + x);
-                __m128d r1 = _mm_load_pd(src1 + x + 2);
-                r0 = op64(r0,_mm_load_pd(src2 + x));
-                r1 = op64(r1,_mm_load_pd(src2 + x + 2));
-                _mm_store_pd(dst + x, r0);
-                _mm_store_pd(dst + x + 2, r1);
-            }
-        else
-    #endif
-        for( ; x <= sz.width - 4; x += 4 )
-        {
-            double v0 = op(src1[x], src2[x]);
-            double v1 = op(src1[x+1], src2[x+1]);
-            dst[x] = v0; dst[x+1] = v1;
-            v0 = op(src1[x+2], src2[x+2]);
-            v1 = op(src1[x+3], src2[x+3]);
-            dst[x+2] = v0; dst[x+3] = v1;
-        }
-
-        for( ; x < sz.width; x++ )
-            dst[x] = op(src1[x], src2[x]);
-    }
-}
-
-#if CV_SSE2
-
-struct _VAdd8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_adds_epu8(a,b); }};
-struct _VSub8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_subs_epu8(a,b); }};
-struct _VMin8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_min_epu8(a,b); }};
-struct _VMax8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_max_epu8(a,b); }};
-struct _VAbsDiff8u
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    { return _mm_add_epi8(_mm_subs_epu8(a,b),_mm_subs_epu8(b,a)); }
-};
-
-struct _VAdd8s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_adds_epi8(a,b); }};
-struct _VSub8s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_subs_epi8(a,b); }};
-struct _VMin8s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i m = _mm_cmpgt_epi8(a, b);
-        return _mm_xor_si128(a, _mm_and_si128(_mm_xor_si128(a, b), m));
-    }
-};
-struct _VMax8s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i m = _mm_cmpgt_epi8(b, a);
-        return _mm_xor_si128(a, _mm_and_si128(_mm_xor_si128(a, b), m));
-    }
-};
-struct _VAbsDiff8s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i d = _mm_subs_epi8(a, b);
-        __m128i m = _mm_cmpgt_epi8(b, a);
-        return _mm_subs_epi8(_mm_xor_si128(d, m), m);
-    }
-};
-
-struct _VAdd16u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_adds_epu16(a,b); }};
-struct _VSub16u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_subs_epu16(a,b); }};
-struct _VMin16u
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    { return _mm_subs_epu16(a,_mm_subs_epu16(a,b)); }
-};
-struct _VMax16u
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    { return _mm_adds_epu16(_mm_subs_epu16(a,b),b); }
-};
-struct _VAbsDiff16u
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    { return _mm_add_epi16(_mm_subs_epu16(a,b),_mm_subs_epu16(b,a)); }
-};
-
-struct _VAdd16s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_adds_epi16(a,b); }};
-struct _VSub16s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_subs_epi16(a,b); }};
-struct _VMin16s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_min_epi16(a,b); }};
-struct _VMax16s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_max_epi16(a,b); }};
-struct _VAbsDiff16s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i M = _mm_max_epi16(a,b), m = _mm_min_epi16(a,b);
-        return _mm_subs_epi16(M, m);
-    }
-};
-
-struct _VAdd32s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_add_epi32(a,b); }};
-struct _VSub32s { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_sub_epi32(a,b); }};
-struct _VMin32s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i m = _mm_cmpgt_epi32(a, b);
-        return _mm_xor_si128(a, _mm_and_si128(_mm_xor_si128(a, b), m));
-    }
-};
-struct _VMax32s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i m = _mm_cmpgt_epi32(b, a);
-        return _mm_xor_si128(a, _mm_and_si128(_mm_xor_si128(a, b), m));
-    }
-};
-struct _VAbsDiff32s
-{
-    __m128i operator()(const __m128i& a, const __m128i& b) const
-    {
-        __m128i d = _mm_sub_epi32(a, b);
-        __m128i m = _mm_cmpgt_epi32(b, a);
-        return _mm_sub_epi32(_mm_xor_si128(d, m), m);
-    }
-};
-
-struct _VAdd32f { __m128 operator()(const __m128& a, const __m128& b) const { return _mm_add_ps(a,b); }};
-struct _VSub32f { __m128 operator()(const __m128& a, const __m128& b) const { return _mm_sub_ps(a,b); }};
-struct _VMin32f { __m128 operator()(const __m128& a, const __m128& b) const { return _mm_min_ps(a,b); }};
-struct _VMax32f { __m128 operator()(const __m128& a, const __m128& b) const { return _mm_max_ps(a,b); }};
-static int CV_DECL_ALIGNED(16) v32f_absmask[] = { 0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff };
-struct _VAbsDiff32f
-{
-    __m128 operator()(const __m128& a, const __m128& b) const
-    {
-        return _mm_and_ps(_mm_sub_ps(a,b), *(const __m128*)v32f_absmask);
-    }
-};
-
-struct _VAdd64f { __m128d operator()(const __m128d& a, const __m128d& b) const { return _mm_add_pd(a,b); }};
-struct _VSub64f { __m128d operator()(const __m128d& a, const __m128d& b) const { return _mm_sub_pd(a,b); }};
-struct _VMin64f { __m128d operator()(const __m128d& a, const __m128d& b) const { return _mm_min_pd(a,b); }};
-struct _VMax64f { __m128d operator()(const __m128d& a, const __m128d& b) const { return _mm_max_pd(a,b); }};
-
-static int CV_DECL_ALIGNED(16) v64f_absmask[] = { 0xffffffff, 0x7fffffff, 0xffffffff, 0x7fffffff };
-struct _VAbsDiff64f
-{
-    __m128d operator()(const __m128d& a, const __m128d& b) const
-    {
-        return _mm_and_pd(_mm_sub_pd(a,b), *(const __m128d*)v64f_absmask);
-    }
-};
-
-struct _VAnd8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_and_si128(a,b); }};
-struct _VOr8u  { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_or_si128(a,b); }};
-struct _VXor8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_xor_si128(a,b); }};
-struct _VNot8u { __m128i operator()(const __m128i& a, const __m128i&) const { return _mm_xor_si128(_mm_set1_epi32(-1),a); }};
-
-#endif
-
-#if CV_SSE2
+#if CV_SIMD
 #define IF_SIMD(op) op
 #else
 #define IF_SIMD(op) NOP
 #endif
 
+#if CV_SIMD && CV_SIMD_64F
+#define IF_SIMD64F(op) op
+#else
+#define IF_SIMD64F(op) NOP
+#endif
+
 template<> inline uchar OpAdd<uchar>::operator ()(uchar a, uchar b) const
 { return CV_FAST_CAST_8U(a + b); }
 template<> inline uchar OpSub<uchar>::operator ()(uchar a, uchar b) const
@@ -532,114 +182,128 @@ static void add8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(add8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_8u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp8<uchar, OpAdd<uchar>, IF_SIMD(_VAdd8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpAdd<uchar>, IF_SIMD(VAdd)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpAdd<schar>, IF_SIMD(_VAdd8s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(add8s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<schar, OpAdd<schar>, IF_SIMD(VAdd)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void add16u( const ushort* src1, size_t step1,
                     const ushort* src2, size_t step2,
                     ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(add16u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_16u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
-            (vBinOp16<ushort, OpAdd<ushort>, IF_SIMD(_VAdd16u)>(src1, step1, src2, step2, dst, step, sz)));
+            (vBinOp<ushort, OpAdd<ushort>, IF_SIMD(VAdd)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(add16s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_16s_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp16<short, OpAdd<short>, IF_SIMD(_VAdd16s)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<short, OpAdd<short>, IF_SIMD(VAdd)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpAdd<int>, IF_SIMD(_VAdd32s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(add32s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<int, OpAdd<int>, IF_SIMD(VAdd)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void add32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(add32f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp32f<OpAdd<float>, IF_SIMD(_VAdd32f)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<float, OpAdd<float>, IF_SIMD(VAdd)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpAdd<double>, IF_SIMD(_VAdd64f)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(add64f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<double, OpAdd<double>, IF_SIMD64F(VAdd)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void sub8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(sub8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_8u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp8<uchar, OpSub<uchar>, IF_SIMD(_VSub8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpSub<uchar>, IF_SIMD(VSub)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpSub<schar>, IF_SIMD(_VSub8s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(sub8s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<schar, OpSub<schar>, IF_SIMD(VSub)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void sub16u( const ushort* src1, size_t step1,
                     const ushort* src2, size_t step2,
                     ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(sub16u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_16u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp16<ushort, OpSub<ushort>, IF_SIMD(_VSub16u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<ushort, OpSub<ushort>, IF_SIMD(VSub)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(sub16s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_16s_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp16<short, OpSub<short>, IF_SIMD(_VSub16s)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<short, OpSub<short>, IF_SIMD(VSub)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpSub<int>, IF_SIMD(_VSub32s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(sub32s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<int, OpSub<int>, IF_SIMD(VSub)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void sub32f( const float* src1, size_t step1,
                    const float* src2, size_t step2,
                    float* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(sub32f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_32f_C1R(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz),
-           (vBinOp32f<OpSub<float>, IF_SIMD(_VSub32f)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<float, OpSub<float>, IF_SIMD(VSub)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpSub<double>, IF_SIMD(_VSub64f)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(sub64f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<double, OpSub<double>, IF_SIMD64F(VSub)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 template<> inline uchar OpMin<uchar>::operator ()(uchar a, uchar b) const { return CV_MIN_8U(a, b); }
@@ -649,6 +313,7 @@ static void max8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(max8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
 #if (ARITHM_USE_IPP == 1)
   {
     uchar* s1 = (uchar*)src1;
@@ -664,25 +329,27 @@ static void max8u( const uchar* src1, size_t step1,
     }
   }
 #else
-  vBinOp8<uchar, OpMax<uchar>, IF_SIMD(_VMax8u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp<uchar, OpMax<uchar>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMaxEvery_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
-//           (vBinOp8<uchar, OpMax<uchar>, IF_SIMD(_VMax8u)>(src1, step1, src2, step2, dst, step, sz)));
+//           (vBinOp<uchar, OpMax<uchar>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void max8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpMax<schar>, IF_SIMD(_VMax8s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(max8s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<schar, OpMax<schar>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void max16u( const ushort* src1, size_t step1,
                     const ushort* src2, size_t step2,
                     ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(max16u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
 #if (ARITHM_USE_IPP == 1)
   {
     ushort* s1 = (ushort*)src1;
@@ -698,32 +365,35 @@ static void max16u( const ushort* src1, size_t step1,
     }
   }
 #else
-  vBinOp16<ushort, OpMax<ushort>, IF_SIMD(_VMax16u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp<ushort, OpMax<ushort>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMaxEvery_16u_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
-//           (vBinOp16<ushort, OpMax<ushort>, IF_SIMD(_VMax16u)>(src1, step1, src2, step2, dst, step, sz)));
+//           (vBinOp<ushort, OpMax<ushort>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void max16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
-    vBinOp16<short, OpMax<short>, IF_SIMD(_VMax16s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(max16s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<short, OpMax<short>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void max32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpMax<int>, IF_SIMD(_VMax32s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(max32s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<int, OpMax<int>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void max32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(max32f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
 #if (ARITHM_USE_IPP == 1)
   {
     float* s1 = (float*)src1;
@@ -739,24 +409,26 @@ static void max32f( const float* src1, size_t step1,
     }
   }
 #else
-  vBinOp32f<OpMax<float>, IF_SIMD(_VMax32f)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp<float, OpMax<float>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMaxEvery_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
-//           (vBinOp32f<OpMax<float>, IF_SIMD(_VMax32f)>(src1, step1, src2, step2, dst, step, sz)));
+//           (vBinOp<float, OpMax<float>, IF_SIMD(VMax)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void max64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpMax<double>, IF_SIMD(_VMax64f)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(max64f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<double, OpMax<double>, IF_SIMD64F(VMax)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(min8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
 #if (ARITHM_USE_IPP == 1)
   {
     uchar* s1 = (uchar*)src1;
@@ -772,25 +444,27 @@ static void min8u( const uchar* src1, size_t step1,
     }
   }
 #else
-  vBinOp8<uchar, OpMin<uchar>, IF_SIMD(_VMin8u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp<uchar, OpMin<uchar>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMinEvery_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
-//           (vBinOp8<uchar, OpMin<uchar>, IF_SIMD(_VMin8u)>(src1, step1, src2, step2, dst, step, sz)));
+//           (vBinOp<uchar, OpMin<uchar>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void min8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpMin<schar>, IF_SIMD(_VMin8s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(min8s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<schar, OpMin<schar>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min16u( const ushort* src1, size_t step1,
                     const ushort* src2, size_t step2,
                     ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(min16u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
 #if (ARITHM_USE_IPP == 1)
   {
     ushort* s1 = (ushort*)src1;
@@ -806,32 +480,35 @@ static void min16u( const ushort* src1, size_t step1,
     }
   }
 #else
-  vBinOp16<ushort, OpMin<ushort>, IF_SIMD(_VMin16u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp<ushort, OpMin<ushort>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMinEvery_16u_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
-//           (vBinOp16<ushort, OpMin<ushort>, IF_SIMD(_VMin16u)>(src1, step1, src2, step2, dst, step, sz)));
+//           (vBinOp<ushort, OpMin<ushort>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void min16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
-    vBinOp16<short, OpMin<short>, IF_SIMD(_VMin16s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(min16s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<short, OpMin<short>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpMin<int>, IF_SIMD(_VMin32s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(min32s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<int, OpMin<int>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(min32f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
 #if (ARITHM_USE_IPP == 1)
   {
     float* s1 = (float*)src1;
@@ -847,73 +524,81 @@ static void min32f( const float* src1, size_t step1,
     }
   }
 #else
-  vBinOp32f<OpMin<float>, IF_SIMD(_VMin32f)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp<float, OpMin<float>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMinEvery_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
-//           (vBinOp32f<OpMin<float>, IF_SIMD(_VMin32f)>(src1, step1, src2, step2, dst, step, sz)));
+//           (vBinOp<float, OpMin<float>, IF_SIMD(VMin)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void min64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpMin<double>, IF_SIMD(_VMin64f)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(min64f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<double, OpMin<double>, IF_SIMD64F(VMin)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff8u( const uchar* src1, size_t step1,
                        const uchar* src2, size_t step2,
                        uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(absdiff8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpAbsDiff<uchar>, IF_SIMD(_VAbsDiff8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpAbsDiff<uchar>, IF_SIMD(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void absdiff8s( const schar* src1, size_t step1,
                        const schar* src2, size_t step2,
                        schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpAbsDiff<schar>, IF_SIMD(_VAbsDiff8s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(absdiff8s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<schar, OpAbsDiff<schar>, IF_SIMD(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff16u( const ushort* src1, size_t step1,
                         const ushort* src2, size_t step2,
                         ushort* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(absdiff16u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_16u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp16<ushort, OpAbsDiff<ushort>, IF_SIMD(_VAbsDiff16u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<ushort, OpAbsDiff<ushort>, IF_SIMD(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void absdiff16s( const short* src1, size_t step1,
                         const short* src2, size_t step2,
                         short* dst, size_t step, Size sz, void* )
 {
-    vBinOp16<short, OpAbsDiff<short>, IF_SIMD(_VAbsDiff16s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(absdiff16s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<short, OpAbsDiff<short>, IF_SIMD(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff32s( const int* src1, size_t step1,
                         const int* src2, size_t step2,
                         int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpAbsDiff<int>, IF_SIMD(_VAbsDiff32s)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(absdiff32s, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<int, OpAbsDiff<int>, IF_SIMD(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff32f( const float* src1, size_t step1,
                         const float* src2, size_t step2,
                         float* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(absdiff32f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp32f<OpAbsDiff<float>, IF_SIMD(_VAbsDiff32f)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<float, OpAbsDiff<float>, IF_SIMD(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void absdiff64f( const double* src1, size_t step1,
                         const double* src2, size_t step2,
                         double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpAbsDiff<double>, IF_SIMD(_VAbsDiff64f)>(src1, step1, src2, step2, dst, step, sz);
+    CALL_AVX2(absdiff64f, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
+    vBinOp<double, OpAbsDiff<double>, IF_SIMD64F(VAbsDiff)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 
@@ -921,36 +606,40 @@ static void and8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(and8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAnd_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpAnd<uchar>, IF_SIMD(_VAnd8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpAnd<uchar>, IF_SIMD(VAnd)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void or8u( const uchar* src1, size_t step1,
                   const uchar* src2, size_t step2,
                   uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(or8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiOr_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpOr<uchar>, IF_SIMD(_VOr8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpOr<uchar>, IF_SIMD(VOr)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void xor8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(xor8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiXor_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpXor<uchar>, IF_SIMD(_VXor8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpXor<uchar>, IF_SIMD(VXor)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void not8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    CALL_AVX2(not8u, (src1, step1, src2, step2, dst, step, sz.width, sz.height));
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiNot_8u_C1R(src1, (int)step1, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpNot<uchar>, IF_SIMD(_VNot8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp<uchar, OpNot<uchar>, IF_SIMD(VNot)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 /****************************************************************************************\
@@ -2069,6 +1758,7 @@ cmp_(const T* src1, size_t step1, const T* src2, size_t step2,
 static void cmp8u(const uchar* src1, size_t step1, const uchar* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp8u, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
   //vz optimized  cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 	int code = *(int*)_cmpop;
     step1 /= sizeof(src1[0]);
@@ -2137,18 +1827,21 @@ static void cmp8u(const uchar* src1, size_t step1, const uchar* src2, size_t ste
 static void cmp8s(const schar* src1, size_t step1, const schar* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp8s, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
 static void cmp16u(const ushort* src1, size_t step1, const ushort* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp16u, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
 static void cmp16s(const short* src1, size_t step1, const short* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp16s, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
    //vz optimized cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 
 	int code = *(int*)_cmpop;
@@ -2240,18 +1933,21 @@ static void cmp16s(const short* src1, size_t step1, const short* src2, size_t st
 static void cmp32s(const int* src1, size_t step1, const int* src2, size_t step2,
                    uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp32s, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
 static void cmp32f(const float* src1, size_t step1, const float* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp32f, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
 static void cmp64f(const double* src1, size_t step1, const double* src2, size_t step2,
                   uchar* dst, size_t step, Size size, void* _cmpop)
 {
+    CALL_AVX2(cmp64f, (src1, step1, src2, step2, dst, step, size.width, size.height, *(int*)_cmpop));
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
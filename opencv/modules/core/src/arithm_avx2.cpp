@@ -0,0 +1,144 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/*
+   AVX2 versions of the min() and max() row kernels, see simd_avx2.hpp. Like simd_avx2.cpp,
+   this file is compiled with the AVX2 flags and must not include any OpenCV header except
+   simd_avx2.hpp; arithm.cpp calls the functions only when USE_AVX2 is set.
+*/
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+#include "simd_avx2.hpp"
+
+namespace cv { namespace avx2
+{
+
+typedef unsigned char uchar;
+typedef signed char schar;
+typedef unsigned short ushort;
+
+template<typename T, class Op, class VOp> static void
+binOp(const T* src1, size_t step1, const T* src2, size_t step2,
+      T* dst, size_t step, int width, int height)
+{
+    const int VEC = 32/sizeof(T);
+    Op op;
+    VOp vop;
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2),
+                     dst = (T*)((uchar*)dst + step) )
+    {
+        int x = 0;
+        for( ; x <= width - VEC*2; x += VEC*2 )
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(src1 + x));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(src1 + x + VEC));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(src2 + x));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(src2 + x + VEC));
+            _mm256_storeu_si256((__m256i*)(dst + x), vop(a0, b0));
+            _mm256_storeu_si256((__m256i*)(dst + x + VEC), vop(a1, b1));
+        }
+        for( ; x <= width - VEC; x += VEC )
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(src1 + x));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(src2 + x));
+            _mm256_storeu_si256((__m256i*)(dst + x), vop(a, b));
+        }
+        for( ; x < width; x++ )
+            dst[x] = op(src1[x], src2[x]);
+    }
+}
+
+// the scalar tail uses the same comparisons as OpMin/OpMax of arithm.cpp
+struct OpMinT { template<typename T> T operator()(T a, T b) const { return b < a ? b : a; } };
+struct OpMaxT { template<typename T> T operator()(T a, T b) const { return a < b ? b : a; } };
+
+#define CV_AVX2_DEF_VEC_OP(name, expr) \
+struct name \
+{ \
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return expr; } \
+}
+
+#define CV_AVX2_PS(v) _mm256_castsi256_ps(v)
+#define CV_AVX2_PD(v) _mm256_castsi256_pd(v)
+
+CV_AVX2_DEF_VEC_OP(VMin8u, _mm256_min_epu8(a, b));
+CV_AVX2_DEF_VEC_OP(VMin8s, _mm256_min_epi8(a, b));
+CV_AVX2_DEF_VEC_OP(VMin16u, _mm256_min_epu16(a, b));
+CV_AVX2_DEF_VEC_OP(VMin16s, _mm256_min_epi16(a, b));
+CV_AVX2_DEF_VEC_OP(VMin32s, _mm256_min_epi32(a, b));
+CV_AVX2_DEF_VEC_OP(VMin32f, _mm256_castps_si256(_mm256_min_ps(CV_AVX2_PS(a), CV_AVX2_PS(b))));
+CV_AVX2_DEF_VEC_OP(VMin64f, _mm256_castpd_si256(_mm256_min_pd(CV_AVX2_PD(a), CV_AVX2_PD(b))));
+
+CV_AVX2_DEF_VEC_OP(VMax8u, _mm256_max_epu8(a, b));
+CV_AVX2_DEF_VEC_OP(VMax8s, _mm256_max_epi8(a, b));
+CV_AVX2_DEF_VEC_OP(VMax16u, _mm256_max_epu16(a, b));
+CV_AVX2_DEF_VEC_OP(VMax16s, _mm256_max_epi16(a, b));
+CV_AVX2_DEF_VEC_OP(VMax32s, _mm256_max_epi32(a, b));
+CV_AVX2_DEF_VEC_OP(VMax32f, _mm256_castps_si256(_mm256_max_ps(CV_AVX2_PS(a), CV_AVX2_PS(b))));
+CV_AVX2_DEF_VEC_OP(VMax64f, _mm256_castpd_si256(_mm256_max_pd(CV_AVX2_PD(a), CV_AVX2_PD(b))));
+
+#define CV_AVX2_DEF_BINARY_OP(name, type, op, vop) \
+void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+          type* dst, size_t step, int width, int height) \
+{ \
+    binOp<type, op, vop>(src1, step1, src2, step2, dst, step, width, height); \
+}
+
+#define CV_AVX2_DEF_BINARY_OPS(name, op, vop) \
+CV_AVX2_DEF_BINARY_OP(name##8u, uchar, op, vop##8u) \
+CV_AVX2_DEF_BINARY_OP(name##8s, schar, op, vop##8s) \
+CV_AVX2_DEF_BINARY_OP(name##16u, ushort, op, vop##16u) \
+CV_AVX2_DEF_BINARY_OP(name##16s, short, op, vop##16s) \
+CV_AVX2_DEF_BINARY_OP(name##32s, int, op, vop##32s) \
+CV_AVX2_DEF_BINARY_OP(name##32f, float, op, vop##32f) \
+CV_AVX2_DEF_BINARY_OP(name##64f, double, op, vop##64f)
+
+CV_AVX2_DEF_BINARY_OPS(min, OpMinT, VMin)
+CV_AVX2_DEF_BINARY_OPS(max, OpMaxT, VMax)
+
+}}
+
+#endif
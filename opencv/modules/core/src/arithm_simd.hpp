@@ -0,0 +1,116 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef __OPENCV_CORE_ARITHM_SIMD_HPP__
+#define __OPENCV_CORE_ARITHM_SIMD_HPP__
+
+/*
+   The vectorized row kernels of arithm.cpp, written with the opencv2/core/simd.hpp types.
+
+   The header is included by arithm.cpp and so gets the backend of the instruction set
+   the library is built for (SSE2, NEON). The run-time AVX2 path uses the header-free
+   kernels of simd_avx2.cpp and arithm_avx2.cpp instead. Everything here is declared in
+   the backend namespace, so the templates cannot collide with another build at link time.
+*/
+
+namespace cv { namespace CV_SIMD_NAMESPACE
+{
+
+template<typename T> struct VBinOpType {};
+template<> struct VBinOpType<uchar> { typedef v_uint8 vtype; };
+template<> struct VBinOpType<schar> { typedef v_int8 vtype; };
+template<> struct VBinOpType<ushort> { typedef v_uint16 vtype; };
+template<> struct VBinOpType<short> { typedef v_int16 vtype; };
+template<> struct VBinOpType<int> { typedef v_int32 vtype; };
+template<> struct VBinOpType<float> { typedef v_float32 vtype; };
+#if CV_SIMD_64F
+template<> struct VBinOpType<double> { typedef v_float64 vtype; };
+#endif
+
+// processes the vectorizable part of the row, returns the number of processed elements
+template<typename T, class VOp>
+inline int vBinOpSIMD(const T* src1, const T* src2, T* dst, int width, VOp vop)
+{
+    typedef typename VBinOpType<T>::vtype vtype;
+    const int n = vtype::nlanes;
+    int x = 0;
+
+    for( ; x <= width - n*2; x += n*2 )
+    {
+        vtype r0 = vop(v_load(src1 + x), v_load(src2 + x));
+        vtype r1 = vop(v_load(src1 + x + n), v_load(src2 + x + n));
+        v_store(dst + x, r0);
+        v_store(dst + x + n, r1);
+    }
+    for( ; x <= width - n; x += n )
+        v_store(dst + x, vop(v_load(src1 + x), v_load(src2 + x)));
+    return x;
+}
+
+#if CV_SIMD
+
+// + and - saturate for the 8- and 16-bit types, as OpAdd/OpSub do
+struct VAdd { template<typename V> V operator()(const V& a, const V& b) const { return a + b; }};
+struct VSub { template<typename V> V operator()(const V& a, const V& b) const { return a - b; }};
+struct VMin { template<typename V> V operator()(const V& a, const V& b) const { return v_min(a, b); }};
+struct VMax { template<typename V> V operator()(const V& a, const V& b) const { return v_max(a, b); }};
+struct VAbsDiff
+{
+    // for the signed types the saturating max - min matches saturate_cast<T>(std::abs(a - b))
+    template<typename V> V operator()(const V& a, const V& b) const { return v_max(a, b) - v_min(a, b); }
+    v_uint8 operator()(const v_uint8& a, const v_uint8& b) const { return v_absdiff(a, b); }
+    v_uint16 operator()(const v_uint16& a, const v_uint16& b) const { return v_absdiff(a, b); }
+    v_float32 operator()(const v_float32& a, const v_float32& b) const { return v_absdiff(a, b); }
+#if CV_SIMD_64F
+    v_float64 operator()(const v_float64& a, const v_float64& b) const { return v_absdiff(a, b); }
+#endif
+};
+struct VAnd { template<typename V> V operator()(const V& a, const V& b) const { return a & b; }};
+struct VOr  { template<typename V> V operator()(const V& a, const V& b) const { return a | b; }};
+struct VXor { template<typename V> V operator()(const V& a, const V& b) const { return a ^ b; }};
+struct VNot { template<typename V> V operator()(const V& a, const V&) const { return ~a; }};
+
+#endif
+
+}}
+
+#endif
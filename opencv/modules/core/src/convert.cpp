@@ -210,6 +210,7 @@ static MergeFunc mergeTab[] =
 
 void cv::split(const Mat& src, Mat* mv)
 {
+    CV_TRACE_REGION("cv::split");
     int k, depth = src.depth(), cn = src.channels();
     if( cn == 1 )
     {
@@ -269,6 +270,7 @@ void cv::split(InputArray _m, OutputArrayOfArrays _mv)
 
 void cv::merge(const Mat* mv, size_t n, OutputArray _dst)
 {
+    CV_TRACE_REGION("cv::merge");
     CV_Assert( mv && n > 0 );
 
     int depth = mv[0].depth();
@@ -728,10 +730,37 @@ cpy_( const T* src, size_t sstep, T* dst, size_t dstep, Size size )
         memcpy(dst, src, size.width*sizeof(src[0]));
 }
 
+// tries the AVX2 kernel; it declines the depth combinations computed in double precision
+template<typename ST, typename DT> static inline bool
+cvtScaleAVX2(const ST* src, size_t sstep, DT* dst, size_t dstep, Size size, double alpha, double beta)
+{
+#if CV_TRY_AVX2
+    return USE_AVX2 && avx2::cvtScale(src, sstep, DataDepth<ST>::value, dst, dstep, DataDepth<DT>::value,
+                                      size.width, size.height, alpha, beta);
+#else
+    (void)src; (void)sstep; (void)dst; (void)dstep; (void)size; (void)alpha; (void)beta;
+    return false;
+#endif
+}
+
+template<typename ST> static inline bool
+cvtScaleAbsAVX2(const ST* src, size_t sstep, uchar* dst, size_t dstep, Size size, double alpha, double beta)
+{
+#if CV_TRY_AVX2
+    return USE_AVX2 && avx2::cvtScaleAbs(src, sstep, DataDepth<ST>::value, dst, dstep,
+                                         size.width, size.height, alpha, beta);
+#else
+    (void)src; (void)sstep; (void)dst; (void)dstep; (void)size; (void)alpha; (void)beta;
+    return false;
+#endif
+}
+
 #define DEF_CVT_SCALE_ABS_FUNC(suffix, tfunc, stype, dtype, wtype) \
 static void cvtScaleAbs##suffix( const stype* src, size_t sstep, const uchar*, size_t, \
                          dtype* dst, size_t dstep, Size size, double* scale) \
 { \
+    if( cvtScaleAbsAVX2(src, sstep, dst, dstep, size, scale[0], scale[1]) ) \
+        return; \
     tfunc(src, sstep, dst, dstep, size, (wtype)scale[0], (wtype)scale[1]); \
 }
 
@@ -739,6 +768,8 @@ static void cvtScaleAbs##suffix( const stype* src, size_t sstep, const uchar*, s
 static void cvtScale##suffix( const stype* src, size_t sstep, const uchar*, size_t, \
 dtype* dst, size_t dstep, Size size, double* scale) \
 { \
+    if( cvtScaleAVX2(src, sstep, dst, dstep, size, scale[0], scale[1]) ) \
+        return; \
     cvtScale_(src, sstep, dst, dstep, size, (wtype)scale[0], (wtype)scale[1]); \
 }
 
@@ -747,6 +778,8 @@ dtype* dst, size_t dstep, Size size, double* scale) \
 static void cvt##suffix( const stype* src, size_t sstep, const uchar*, size_t, \
                          dtype* dst, size_t dstep, Size size, double*) \
 { \
+    if( cvtScaleAVX2(src, sstep, dst, dstep, size, 1, 0) ) \
+        return; \
     cvt_(src, sstep, dst, dstep, size); \
 }
 
@@ -980,6 +1013,7 @@ BinaryFunc getConvertScaleFunc(int sdepth, int ddepth)
 
 void cv::convertScaleAbs( InputArray _src, OutputArray _dst, double alpha, double beta )
 {
+    CV_TRACE_REGION("cv::convertScaleAbs");
     Mat src = _src.getMat();
     int cn = src.channels();
     double scale[] = {alpha, beta};
@@ -1005,8 +1039,64 @@ void cv::convertScaleAbs( InputArray _src, OutputArray _dst, double alpha, doubl
     }
 }
 
+namespace cv
+{
+
+static void cvtFp32ToFp16( const float* src, ushort* dst, int len )
+{
+#if CV_TRY_AVX2
+    if( USE_AVX2 && checkHardwareSupport(CV_CPU_F16C) )
+    {
+        avx2::cvtFp32ToFp16(src, dst, len);
+        return;
+    }
+#endif
+    for( int i = 0; i < len; i++ )
+        dst[i] = cvtFloatToHalf(src[i]);
+}
+
+static void cvtFp16ToFp32( const ushort* src, float* dst, int len )
+{
+#if CV_TRY_AVX2
+    if( USE_AVX2 && checkHardwareSupport(CV_CPU_F16C) )
+    {
+        avx2::cvtFp16ToFp32(src, dst, len);
+        return;
+    }
+#endif
+    for( int i = 0; i < len; i++ )
+        dst[i] = cvtHalfToFloat(src[i]);
+}
+
+}
+
+void cv::convertFp16( InputArray _src, OutputArray _dst )
+{
+    CV_TRACE_REGION("cv::convertFp16");
+    Mat src = _src.getMat();
+    int sdepth = src.depth(), cn = src.channels();
+    if( sdepth != CV_32F && sdepth != CV_16S )
+        CV_Error( CV_StsUnsupportedFormat, "The source array must be CV_32F or CV_16S (half-precision floats)" );
+    _dst.create( src.dims, src.size, CV_MAKETYPE(sdepth == CV_32F ? CV_16S : CV_32F, cn) );
+    Mat dst = _dst.getMat();
+
+    const Mat* arrays[] = {&src, &dst, 0};
+    uchar* ptrs[2];
+    NAryMatIterator it(arrays, ptrs);
+    int len = (int)it.size*cn;
+
+    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    {
+        if( sdepth == CV_32F )
+            cvtFp32ToFp16( (const float*)ptrs[0], (ushort*)ptrs[1], len );
+        else
+            cvtFp16ToFp32( (const ushort*)ptrs[0], (float*)ptrs[1], len );
+    }
+}
+
 void cv::Mat::convertTo(OutputArray _dst, int _type, double alpha, double beta) const
 {
+    CV_TRACE_REGION("cv::Mat::convertTo");
     bool noScale = fabs(alpha-1) < DBL_EPSILON && fabs(beta) < DBL_EPSILON;
 
     if( _type < 0 )
@@ -1119,6 +1209,7 @@ static LUTFunc lutTab[] =
 
 void cv::LUT( InputArray _src, InputArray _lut, OutputArray _dst, int interpolation )
 {
+    CV_TRACE_REGION("cv::LUT");
     Mat src = _src.getMat(), lut = _lut.getMat();
     CV_Assert( interpolation == 0 );
     int cn = src.channels();
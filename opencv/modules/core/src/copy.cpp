@@ -402,6 +402,7 @@ flipVert( const uchar* src0, size_t sstep, uchar* dst0, size_t dstep, Size size,
 
 void flip( InputArray _src, OutputArray _dst, int flip_mode )
 {
+    CV_TRACE_REGION("cv::flip");
     Mat src = _src.getMat();
 
     CV_Assert( src.dims <= 2 );
@@ -362,97 +362,178 @@ DFTInit( int n0, int nf, int* factors, int* itab, int elem_size, void* _wave, in
     }
 }
 
-template<typename T> struct DFT_VecR4
+/*
+ The plans (the factorization of the length, the permutation table and the twiddle factors)
+ are computed once per length and kept in a small cache, so that the repeated transforms
+ of the same size, e.g. in matchTemplate or phaseCorrelate, do not recompute them.
+ A plan is never modified after it is built and can be used by several threads at once.
+*/
+enum { DFT_PLAN_INV_ITAB = 1, DFT_PLAN_DCT = 2, DFT_PLAN_CACHE_SIZE = 16 };
+
+struct DFTPlan
 {
-    int operator()(Complex<T>*, int, int, int&, const Complex<T>*) const { return 1; }
+    int len, elem_size, kind; // elem_size is the size of the complex element
+    int nf;
+    int factors[34];
+    vector<int> itab;
+    vector<uchar> wave;       // len twiddle factors, followed by the radix-4 ones (see DFTInitRadix4)
+    vector<uchar> dct_wave;   // DCT plans only
 };
 
-#if CV_SSE3
+static void DCTInit( int n, int elem_size, void* _wave, int inv );
 
-// optimized radix-4 transform
-template<> struct DFT_VecR4<float>
+// the number of values DFTInitRadix4 stores after the len entries of the wave table
+static int DFTRadix4TabSize( int len )
 {
-    int operator()(Complex<float>* dst, int N, int n0, int& _dw0, const Complex<float>* wave) const
+    int nx, size = 0;
+    for( nx = 1; len % (nx*4) == 0; nx *= 4 )
+        size += nx*6;
+    return size;
+}
+
+/*
+ The vectorized radix-4 stages (DFTRadix4Stage) read the twiddle factors w^j, w^2j, w^3j,
+ j = 0..nx-1, from separate re/im arrays. They are gathered from the wave table once per plan
+ and stored after it: the stage with nx-element groups uses nx*6 values at offset 2*(nx-1).
+ DFT() is always called with tab_size equal to the plan length, so the offsets do not depend
+ on the transform length.
+*/
+template<typename T> static void
+DFTInitRadix4( int len, Complex<T>* wave )
+{
+    T* tw = (T*)(wave + len);
+    for( int nx = 1; len % (nx*4) == 0; tw += nx*6, nx *= 4 )
     {
-        int n = 1, i, j, nx, dw, dw0 = _dw0;
-        __m128 z = _mm_setzero_ps(), x02=z, x13=z, w01=z, w23=z, y01, y23, t0, t1;
-        Cv32suf t; t.i = 0x80000000;
-        __m128 neg0_mask = _mm_load_ss(&t.f);
-        __m128 neg3_mask = _mm_shuffle_ps(neg0_mask, neg0_mask, _MM_SHUFFLE(0,1,2,3));
-        
-        for( ; n*4 <= N; )
+        int dw0 = len/(nx*4);
+        for( int j = 0, dw = 0; j < nx; j++, dw += dw0 )
         {
-            nx = n;
-            n *= 4;
-            dw0 /= 4;
-            
-            for( i = 0; i < n0; i += n )
-            {
-                Complexf *v0, *v1;
-                
-                v0 = dst + i;
-                v1 = v0 + nx*2;
-                
-                x02 = _mm_loadl_pi(x02, (const __m64*)&v0[0]);
-                x13 = _mm_loadl_pi(x13, (const __m64*)&v0[nx]);
-                x02 = _mm_loadh_pi(x02, (const __m64*)&v1[0]);
-                x13 = _mm_loadh_pi(x13, (const __m64*)&v1[nx]);
-                
-                y01 = _mm_add_ps(x02, x13);
-                y23 = _mm_sub_ps(x02, x13);
-                t1 = _mm_xor_ps(_mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2,3,3,2)), neg3_mask);
-                t0 = _mm_movelh_ps(y01, y23);
-                y01 = _mm_add_ps(t0, t1);
-                y23 = _mm_sub_ps(t0, t1);
-
-                _mm_storel_pi((__m64*)&v0[0], y01);
-                _mm_storeh_pi((__m64*)&v0[nx], y01);
-                _mm_storel_pi((__m64*)&v1[0], y23);
-                _mm_storeh_pi((__m64*)&v1[nx], y23);
-                
-                for( j = 1, dw = dw0; j < nx; j++, dw += dw0 )
-                {
-                    v0 = dst + i + j;
-                    v1 = v0 + nx*2;
+            tw[j] = wave[dw].re; tw[j + nx] = wave[dw].im;
+            tw[j + nx*2] = wave[dw*2].re; tw[j + nx*3] = wave[dw*2].im;
+            tw[j + nx*4] = wave[dw*3].re; tw[j + nx*5] = wave[dw*3].im;
+        }
+    }
+}
 
-                    x13 = _mm_loadl_pi(x13, (const __m64*)&v0[nx]);
-                    w23 = _mm_loadl_pi(w23, (const __m64*)&wave[dw*2]);
-                    x13 = _mm_loadh_pi(x13, (const __m64*)&v1[nx]); // x1, x3 = r1 i1 r3 i3
-                    w23 = _mm_loadh_pi(w23, (const __m64*)&wave[dw*3]); // w2, w3 = wr2 wi2 wr3 wi3
-                    
-                    t0 = _mm_mul_ps(_mm_moveldup_ps(x13), w23);
-                    t1 = _mm_mul_ps(_mm_movehdup_ps(x13), _mm_shuffle_ps(w23, w23, _MM_SHUFFLE(2,3,0,1)));
-                    x13 = _mm_addsub_ps(t0, t1);
-                    // re(x1*w2), im(x1*w2), re(x3*w3), im(x3*w3)
-                    x02 = _mm_loadl_pi(x02, (const __m64*)&v1[0]); // x2 = r2 i2
-                    w01 = _mm_loadl_pi(w01, (const __m64*)&wave[dw]); // w1 = wr1 wi1
-                    x02 = _mm_shuffle_ps(x02, x02, _MM_SHUFFLE(0,0,1,1));
-                    w01 = _mm_shuffle_ps(w01, w01, _MM_SHUFFLE(1,0,0,1));
-                    x02 = _mm_mul_ps(x02, w01);
-                    x02 = _mm_addsub_ps(x02, _mm_movelh_ps(x02, x02));
-                    // re(x0) im(x0) re(x2*w1), im(x2*w1)
-                    x02 = _mm_loadl_pi(x02, (const __m64*)&v0[0]);
-                    
-                    y01 = _mm_add_ps(x02, x13);
-                    y23 = _mm_sub_ps(x02, x13);
-                    t1 = _mm_xor_ps(_mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2,3,3,2)), neg3_mask);
-                    t0 = _mm_movelh_ps(y01, y23);
-                    y01 = _mm_add_ps(t0, t1);
-                    y23 = _mm_sub_ps(t0, t1);
-
-                    _mm_storel_pi((__m64*)&v0[0], y01);
-                    _mm_storeh_pi((__m64*)&v0[nx], y01);
-                    _mm_storel_pi((__m64*)&v1[0], y23);
-                    _mm_storeh_pi((__m64*)&v1[nx], y23);
-                }
+static Mutex dftPlanMutex;
+
+static Ptr<DFTPlan> getDFTPlan( int len, int elem_size, int kind )
+{
+    static Ptr<DFTPlan> cache[DFT_PLAN_CACHE_SIZE];
+    int i;
+    {
+        AutoLock lock(dftPlanMutex);
+        for( i = 0; i < DFT_PLAN_CACHE_SIZE && !cache[i].empty(); i++ )
+        {
+            const DFTPlan& p = *cache[i];
+            if( p.len == len && p.elem_size == elem_size && p.kind == kind )
+            {
+                // move the plan to the front, so that the least recently used one is evicted
+                Ptr<DFTPlan> plan = cache[i];
+                for( ; i > 0; i-- )
+                    cache[i] = cache[i-1];
+                cache[0] = plan;
+                return plan;
             }
         }
-        
-        _dw0 = dw0;
-        return n;
     }
+
+    Ptr<DFTPlan> plan = new DFTPlan;
+    plan->len = len;
+    plan->elem_size = elem_size;
+    plan->kind = kind;
+    plan->nf = DFTFactorize( len, plan->factors );
+    plan->itab.resize(len);
+    plan->wave.resize(len*elem_size + DFTRadix4TabSize(len)*(elem_size/2));
+    DFTInit( len, plan->nf, plan->factors, &plan->itab[0], elem_size,
+             &plan->wave[0], (kind & DFT_PLAN_INV_ITAB) != 0 );
+    if( elem_size == sizeof(Complexd) )
+        DFTInitRadix4( len, (Complexd*)&plan->wave[0] );
+    else
+        DFTInitRadix4( len, (Complexf*)&plan->wave[0] );
+    if( kind & DFT_PLAN_DCT )
+    {
+        plan->dct_wave.resize((len/2 + 1)*elem_size);
+        DCTInit( len, elem_size, &plan->dct_wave[0], (kind & DFT_PLAN_INV_ITAB) != 0 );
+    }
+
+    AutoLock lock(dftPlanMutex);
+    for( i = DFT_PLAN_CACHE_SIZE - 1; i > 0; i-- )
+        cache[i] = cache[i-1];
+    cache[0] = plan;
+    return plan;
+}
+
+#if CV_SIMD
+
+/*
+ One radix-4 stage over the whole array, vectorized across the butterflies of a group
+ (j = 0..nx-1), which need nx >= vec_type::nlanes. tw points to the twiddle factors
+ of the stage gathered by DFTInitRadix4.
+*/
+template<typename T, typename VT> static void
+DFTRadix4Stage( Complex<T>* dst, int n0, int nx, const T* tw )
+{
+    const int vl = VT::nlanes;
+    int i, j, n = nx*4;
+
+    for( i = 0; i < n0; i += n )
+    {
+        T* v0 = (T*)(dst + i);
+        T* v1 = v0 + nx*4;
+
+        for( j = 0; j < nx; j += vl )
+        {
+            VT x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+            v_load_deinterleave(v0 + j*2, x0r, x0i);
+            v_load_deinterleave(v0 + (j + nx)*2, x1r, x1i);
+            v_load_deinterleave(v1 + j*2, x2r, x2i);
+            v_load_deinterleave(v1 + (j + nx)*2, x3r, x3i);
+
+            VT w1r = v_load(tw + j), w1i = v_load(tw + j + nx);
+            VT w2r = v_load(tw + j + nx*2), w2i = v_load(tw + j + nx*3);
+            VT w3r = v_load(tw + j + nx*4), w3i = v_load(tw + j + nx*5);
+
+            VT r2 = x1r*w2r - x1i*w2i, i2 = x1r*w2i + x1i*w2r;
+            VT ar = x2r*w1r - x2i*w1i, ai = x2r*w1i + x2i*w1r;
+            VT br = x3r*w3r - x3i*w3i, bi = x3r*w3i + x3i*w3r;
+            VT r1 = ar + br, i1 = ai + bi;
+            VT r3 = ai - bi, i3 = br - ar;
+            VT r0 = x0r + r2, i0 = x0i + i2;
+            r2 = x0r - r2; i2 = x0i - i2;
+
+            v_store_interleave(v0 + j*2, r0 + r1, i0 + i1);
+            v_store_interleave(v1 + j*2, r0 - r1, i0 - i1);
+            v_store_interleave(v0 + (j + nx)*2, r2 + r3, i2 + i3);
+            v_store_interleave(v1 + (j + nx)*2, r2 - r3, i2 - i3);
+        }
+    }
+}
+
+#endif
+
+// nlanes == 0 means that there is no vectorized stage for the type
+template<typename T> struct DFTVecR4
+{
+    enum { nlanes = 0 };
+    void operator()( Complex<T>*, int, int, const T* ) const {}
 };
 
+#if CV_SIMD
+template<> struct DFTVecR4<float>
+{
+    enum { nlanes = v_float32::nlanes };
+    void operator()( Complexf* dst, int n0, int nx, const float* tw ) const
+    { DFTRadix4Stage<float, v_float32>(dst, n0, nx, tw); }
+};
+
+#if CV_SIMD_64F
+template<> struct DFTVecR4<double>
+{
+    enum { nlanes = v_float64::nlanes };
+    void operator()( Complexd* dst, int n0, int nx, const double* tw ) const
+    { DFTRadix4Stage<double, v_float64>(dst, n0, nx, tw); }
+};
+#endif
 #endif
 
 #ifdef HAVE_IPP
@@ -642,12 +723,11 @@ DFT( const Complex<T>* src, Complex<T>* dst, int n,
     // 1. power-2 transforms
     if( (factors[0] & 1) == 0 )
     {
-        if( factors[0] >= 4 && checkHardwareSupport(CV_CPU_SSE3))
-        {
-            DFT_VecR4<T> vr4;
-            n = vr4(dst, factors[0], n0, dw0, wave);
-        }
-    
+        DFTVecR4<T> vr4;
+        const T* r4tab = (const T*)(wave + tab_size);
+        bool useSIMD = DFTVecR4<T>::nlanes > 0 && factors[0]/4 >= DFTVecR4<T>::nlanes &&
+                       checkSIMDSupport();
+
         // radix-4 transform
         for( ; n*4 <= factors[0]; )
         {
@@ -655,6 +735,12 @@ DFT( const Complex<T>* src, Complex<T>* dst, int n,
             n *= 4;
             dw0 /= 4;
 
+            if( useSIMD && nx >= DFTVecR4<T>::nlanes )
+            {
+                vr4(dst, n0, nx, r4tab + (nx - 1)*2);
+                continue;
+            }
+
             for( i = 0; i < n0; i += n )
             {
                 Complex<T> *v0, *v1;
@@ -1449,12 +1535,153 @@ static void CCSIDFT_64f( const double* src, double* dst, int n, int nf, int* fac
 {
     CCSIDFT( src, dst, n, nf, factors, itab, wave, tab_size, spec, buf, flags, scale);
 }
-    
+
+/*
+ The rows (stage 0) and the column pairs (stage 1) of a 2D or batched transform are
+ independent, so they are distributed between the threads. Each thread takes its own
+ work buffers from the scratch arena and its own copy of the factors
+ (RealDFT and CCSIDFT temporarily modify them).
+*/
+struct DFTRowsInvoker : ParallelLoopBody
+{
+    DFTRowsInvoker( const Mat& _src, Mat& _dst, DFTFunc _func, int _len,
+                    const DFTPlan* _plan, void* _spec, int _work_size,
+                    bool _use_buf, int _complex_elem_size, int _dptr_offset,
+                    int _dst_full_len, int _flags, double _scale )
+        : src(&_src), dst(&_dst), func(_func), len(_len), plan(_plan), spec(_spec),
+          work_size(_work_size), use_buf(_use_buf), complex_elem_size(_complex_elem_size),
+          dptr_offset(_dptr_offset), dst_full_len(_dst_full_len), flags(_flags), scale(_scale)
+    {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int factors[34], nf = 0;
+        const int* itab = 0;
+        const void* wave = 0;
+        if( plan )
+        {
+            nf = plan->nf;
+            memcpy( factors, plan->factors, nf*sizeof(factors[0]) );
+            itab = &plan->itab[0];
+            wave = &plan->wave[0];
+        }
+
+        int tmp_size = use_buf ? len*complex_elem_size : 0;
+        ScratchBuffer<uchar> buf( tmp_size + work_size + 32 );
+        uchar* tmp_buf = use_buf ? (uchar*)buf : 0;
+        uchar* work = (uchar*)alignPtr( (uchar*)buf + tmp_size, 16 );
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            const uchar* sptr = src->data + i*src->step;
+            uchar* dptr0 = dst->data + i*dst->step;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+
+            func( sptr, dptr, len, nf, factors, itab, wave, len, spec, work, flags, scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+        }
+    }
+
+    const Mat* src;
+    Mat* dst;
+    DFTFunc func;
+    int len;
+    const DFTPlan* plan;
+    void* spec;
+    int work_size;
+    bool use_buf;
+    int complex_elem_size, dptr_offset, dst_full_len, flags;
+    double scale;
+};
+
+struct DFTColumnsInvoker : ParallelLoopBody
+{
+    DFTColumnsInvoker( const uchar* _sptr0, size_t _src_step, uchar* _dptr0, size_t _dst_step,
+                       int _ncols, DFTFunc _func, int _len, const DFTPlan* _plan, void* _spec,
+                       int _work_size, bool _use_buf, int _complex_elem_size, int _inv, double _scale )
+        : sptr0(_sptr0), src_step(_src_step), dptr0(_dptr0), dst_step(_dst_step), ncols(_ncols),
+          func(_func), len(_len), plan(_plan), spec(_spec), work_size(_work_size),
+          use_buf(_use_buf), complex_elem_size(_complex_elem_size), inv(_inv), scale(_scale)
+    {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int factors[34], nf = 0;
+        const int* itab = 0;
+        const void* wave = 0;
+        if( plan )
+        {
+            nf = plan->nf;
+            memcpy( factors, plan->factors, nf*sizeof(factors[0]) );
+            itab = &plan->itab[0];
+            wave = &plan->wave[0];
+        }
+
+        int vec_size = len*complex_elem_size;
+        ScratchBuffer<uchar> buf( vec_size*(use_buf ? 3 : 2) + work_size + 32 );
+        uchar *buf0 = buf, *buf1 = buf0 + vec_size;
+        uchar *dbuf0 = buf0, *dbuf1 = buf1;
+        uchar* work = buf1 + vec_size;
+        if( use_buf )
+        {
+            dbuf1 = work;
+            dbuf0 = buf1;
+            work += vec_size;
+        }
+        work = alignPtr( work, 16 );
+
+        // each iteration processes the pair of columns 2*p, 2*p+1 (or the last single column)
+        for( int p = range.begin(); p < range.end(); p++ )
+        {
+            int i = p*2;
+            const uchar* sptr = sptr0 + i*complex_elem_size;
+            uchar* dptr = dptr0 + i*complex_elem_size;
+
+            if( i+1 < ncols )
+            {
+                CopyFrom2Columns( sptr, src_step, buf0, buf1, len, complex_elem_size );
+                func( buf1, dbuf1, len, nf, factors, itab, wave, len, spec, work, inv, scale );
+            }
+            else
+                CopyColumn( sptr, src_step, buf0, complex_elem_size, len, complex_elem_size );
+
+            func( buf0, dbuf0, len, nf, factors, itab, wave, len, spec, work, inv, scale );
+
+            if( i+1 < ncols )
+                CopyTo2Columns( dbuf0, dbuf1, dptr, dst_step, len, complex_elem_size );
+            else
+                CopyColumn( dbuf0, complex_elem_size, dptr, dst_step, len, complex_elem_size );
+        }
+    }
+
+    const uchar* sptr0;
+    size_t src_step;
+    uchar* dptr0;
+    size_t dst_step;
+    int ncols;
+    DFTFunc func;
+    int len;
+    const DFTPlan* plan;
+    void* spec;
+    int work_size;
+    bool use_buf;
+    int complex_elem_size, inv;
+    double scale;
+};
+
+// the number of rows (columns) processed by a thread at once, so that each stripe has enough work
+static inline int dftGrainSize( int len )
+{
+    return std::max( (1 << 14)/std::max(len, 1), 1 );
+}
+
 }
     
 
 void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
 {
+    CV_TRACE_REGION("cv::dft");
     static DFTFunc dft_tbl[6] =
     {
         (DFTFunc)DFT_32f,
@@ -1465,17 +1692,19 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         (DFTFunc)CCSIDFT_64f
     };
 
-    AutoBuffer<uchar> buf;
+    ScratchBuffer<uchar> buf;
+    size_t buf_size = 0;
     void *spec = 0;
     
     Mat src0 = _src0.getMat(), src = src0;
-    int prev_len = 0, stage = 0;
+    int stage = 0;
     bool inv = (flags & DFT_INVERSE) != 0;
     int nf = 0, real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
     int type = src.type(), depth = src.depth();
     int elem_size = (int)src.elemSize1(), complex_elem_size = elem_size*2;
     int factors[34];
     bool inplace_transform = false;
+    Ptr<DFTPlan> plan;
 #ifdef HAVE_IPP
     void *spec_r = 0, *spec_c = 0;
     int ipp_norm_flag = !(flags & DFT_SCALE) ? 8 : inv ? 2 : 1;
@@ -1510,10 +1739,10 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     for(;;)
     {
         double scale = 1;
-        uchar* wave = 0;
-        int* itab = 0;
+        const uchar* wave = 0;
+        const int* itab = 0;
         uchar* ptr;
-        int i, len, count, sz = 0;
+        int i, len, count, sz = 0, work_size = 0;
         int use_buf = 0, odd_real = 0;
         DFTFunc dft_func;
 
@@ -1587,14 +1816,21 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         else
 #endif
         {
-            if( len != prev_len )
-                nf = DFTFactorize( len, factors );
+            // the tables are taken from the plan cache; the row stage of the inverse
+            // real transform needs the inverse permutation table (see DFTInit)
+            int kind = stage == 0 && inv && real_transform ? DFT_PLAN_INV_ITAB : 0;
+            if( plan.empty() || plan->len != len || plan->kind != kind )
+                plan = getDFTPlan( len, complex_elem_size, kind );
+            nf = plan->nf;
+            memcpy( factors, plan->factors, nf*sizeof(factors[0]) );
+            wave = &plan->wave[0];
+            itab = &plan->itab[0];
 
             inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
             i = nf > 1 && (factors[0] & 1) == 0;
             if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                sz += (factors[i]+1)*complex_elem_size;
+                work_size = (factors[i]+1)*complex_elem_size;
+            sz += work_size;
 
             if( (stage == 0 && ((src.data == dst.data && !inplace_transform) || odd_real)) ||
                 (stage == 1 && !inplace_transform) )
@@ -1604,37 +1840,21 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             }
         }
 
-        ptr = (uchar*)buf;
-        buf.allocate( sz + 32 );
-        if( ptr != (uchar*)buf )
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
-        ptr = (uchar*)buf;
-        if( !spec )
+        if( (size_t)(sz + 32) > buf_size )
         {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                DFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
+            buf.allocate( sz + 32 );
+            buf_size = sz + 32;
         }
+        ptr = (uchar*)buf;
 
         if( stage == 0 )
         {
-            uchar* tmp_buf = 0;
             int dptr_offset = 0;
             int dst_full_len = len*elem_size;
             int _flags = (int)inv + (src.channels() != dst.channels() ?
                          DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
             if( use_buf )
             {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
                 if( odd_real && !inv && len > 1 &&
                     !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
                     dptr_offset = elem_size;
@@ -1653,21 +1873,15 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src.data + i*src.step;
-                uchar* dptr0 = dst.data + i*dst.step;
-                uchar* dptr = dptr0;
+            if( spec )
+                work_size = sz - (use_buf ? len*complex_elem_size : 0);
 
-                if( tmp_buf )
-                    dptr = tmp_buf;
-                
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
+            parallel_for_( BlockedRange(0, nonzero_rows, dftGrainSize(len)),
+                           DFTRowsInvoker(src, dst, dft_func, len, spec ? 0 : (const DFTPlan*)plan,
+                                          spec, work_size, use_buf != 0, complex_elem_size,
+                                          dptr_offset, dst_full_len, _flags, scale) );
 
-            for( ; i < count; i++ )
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst.data + i*dst.step;
                 memset( dptr0, 0, dst_full_len );
@@ -1791,27 +2005,15 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
-            {
-                if( i+1 < b )
-                {
-                    CopyFrom2Columns( sptr0, src.step, buf0, buf1, len, complex_elem_size );
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                }
-                else
-                    CopyColumn( sptr0, src.step, buf0, complex_elem_size, len, complex_elem_size );
-
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
+            if( spec )
+                work_size = sz - len*complex_elem_size*(use_buf ? 3 : 2);
 
-                if( i+1 < b )
-                    CopyTo2Columns( dbuf0, dbuf1, dptr0, dst.step, len, complex_elem_size );
-                else
-                    CopyColumn( dbuf0, complex_elem_size, dptr0, dst.step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
-            }
+            if( b > a )
+                parallel_for_( BlockedRange(0, (b - a + 1)/2, std::max(dftGrainSize(len)/2, 1)),
+                               DFTColumnsInvoker(sptr0, src.step, dptr0, dst.step, b - a, dft_func,
+                                                 len, spec ? 0 : (const DFTPlan*)plan, spec,
+                                                 work_size, use_buf != 0, complex_elem_size,
+                                                 inv, scale) );
 
             if( stage != 0 )
                 break;
@@ -1847,6 +2049,7 @@ void cv::idft( InputArray src, OutputArray dst, int flags, int nonzero_rows )
 void cv::mulSpectrums( InputArray _srcA, InputArray _srcB,
                        OutputArray _dst, int flags, bool conjB )
 {
+    CV_TRACE_REGION("cv::mulSpectrums");
     Mat srcA = _srcA.getMat(), srcB = _srcB.getMat();
     int depth = srcA.depth(), cn = srcA.channels(), type = srcA.type();
     int rows = srcA.rows, cols = srcA.cols;
@@ -2215,10 +2418,52 @@ static void IDCT_64f(const double* src, int src_step, double* dft_src, double* d
          n, nf, factors, itab, dft_wave, dct_wave, spec, buf);
 }    
 
+struct DCTInvoker : ParallelLoopBody
+{
+    DCTInvoker( const uchar* _sptr, size_t _sstep0, int _sstep1, uchar* _dptr, size_t _dstep0,
+                int _dstep1, DCTFunc _func, const DFTPlan* _plan, int _elem_size, int _work_size )
+        : sptr(_sptr), sstep0(_sstep0), sstep1(_sstep1), dptr(_dptr), dstep0(_dstep0),
+          dstep1(_dstep1), func(_func), plan(_plan), elem_size(_elem_size), work_size(_work_size)
+    {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int len = plan->len, nf = plan->nf, factors[34];
+        bool inplace_transform = plan->factors[0] == plan->factors[nf-1];
+        memcpy( factors, plan->factors, nf*sizeof(factors[0]) );
+
+        int vec_size = len*elem_size;
+        ScratchBuffer<uchar> buf( vec_size*(inplace_transform ? 1 : 2) + work_size + 32 );
+        uchar *src_dft_buf = buf, *dst_dft_buf = src_dft_buf;
+        uchar* work = src_dft_buf + vec_size;
+        if( !inplace_transform )
+        {
+            dst_dft_buf = work;
+            work += vec_size;
+        }
+        work = alignPtr( work, 16 );
+
+        for( int i = range.begin(); i < range.end(); i++ )
+            func( sptr + i*sstep0, sstep1, src_dft_buf, dst_dft_buf, dptr + i*dstep0, dstep1,
+                  len, nf, factors, &plan->itab[0], &plan->wave[0], &plan->dct_wave[0], 0, work );
+    }
+
+    const uchar* sptr;
+    size_t sstep0;
+    int sstep1;
+    uchar* dptr;
+    size_t dstep0;
+    int dstep1;
+    DCTFunc func;
+    const DFTPlan* plan;
+    int elem_size, work_size;
+};
+
 }
     
 void cv::dct( InputArray _src0, OutputArray _dst, int flags )
 {
+    CV_TRACE_REGION("cv::dct");
     static DCTFunc dct_tbl[4] =
     {
         (DCTFunc)DCT_32f,
@@ -2230,18 +2475,9 @@ void cv::dct( InputArray _src0, OutputArray _dst, int flags )
     bool inv = (flags & DCT_INVERSE) != 0;
     Mat src0 = _src0.getMat(), src = src0;
     int type = src.type(), depth = src.depth();
-    void /* *spec_dft = 0, */ *spec = 0;
-
-    double scale = 1.;
-    int prev_len = 0, nf = 0, stage, end_stage;
-    uchar *src_dft_buf = 0, *dst_dft_buf = 0;
-    uchar *dft_wave = 0, *dct_wave = 0;
-    int* itab = 0;
-    uchar* ptr = 0;
     int elem_size = (int)src.elemSize(), complex_elem_size = elem_size*2;
-    int factors[34], inplace_transform;
-    int i, len, count;
-    AutoBuffer<uchar> buf;
+    int stage, end_stage, len, count;
+    Ptr<DFTPlan> plan;
 
     CV_Assert( type == CV_32FC1 || type == CV_64FC1 );
     _dst.create( src.rows, src.cols, type );
@@ -2287,86 +2523,21 @@ void cv::dct( InputArray _src0, OutputArray _dst, int flags )
             sstep0 = dstep0 = elem_size;
         }
 
-        if( len != prev_len )
+        if( plan.empty() || plan->len != len )
         {
-            int sz;
-
             if( len > 1 && (len & 1) )
                 CV_Error( CV_StsNotImplemented, "Odd-size DCT\'s are not implemented" );
+            plan = getDFTPlan( len, complex_elem_size, DFT_PLAN_DCT + (inv ? DFT_PLAN_INV_ITAB : 0) );
+        }
+        // otherwise reuse the tables of the previous stage
 
-            sz = len*elem_size;
-            sz += (len/2 + 1)*complex_elem_size;
-
-            spec = 0;
-            inplace_transform = 1;
-            /*if( len*count >= 64 && DFTInitAlloc_R_32f_p )
-            {
-                int ipp_sz = 0;
-                if( depth == CV_32F )
-                {
-                    if( spec_dft )
-                        IPPI_CALL( DFTFree_R_32f_p( spec_dft ));
-                    IPPI_CALL( DFTInitAlloc_R_32f_p( &spec_dft, len, 8, cvAlgHintNone ));
-                    IPPI_CALL( DFTGetBufSize_R_32f_p( spec_dft, &ipp_sz ));
-                }
-                else
-                {
-                    if( spec_dft )
-                        IPPI_CALL( DFTFree_R_64f_p( spec_dft ));
-                    IPPI_CALL( DFTInitAlloc_R_64f_p( &spec_dft, len, 8, cvAlgHintNone ));
-                    IPPI_CALL( DFTGetBufSize_R_64f_p( spec_dft, &ipp_sz ));
-                }
-                spec = spec_dft;
-                sz += ipp_sz;
-            }
-            else*/
-            {
-                sz += len*(complex_elem_size + sizeof(int)) + complex_elem_size;
-
-                nf = DFTFactorize( len, factors );
-                inplace_transform = factors[0] == factors[nf-1];
-
-                i = nf > 1 && (factors[0] & 1) == 0;
-                if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                    sz += (factors[i]+1)*complex_elem_size;
+        int i = plan->nf > 1 && (plan->factors[0] & 1) == 0, work_size = complex_elem_size;
+        if( (plan->factors[i] & 1) != 0 && plan->factors[i] > 5 )
+            work_size += (plan->factors[i]+1)*complex_elem_size;
 
-                if( !inplace_transform )
-                    sz += len*elem_size;
-            }
-
-            buf.allocate( sz + 32 );
-            ptr = (uchar*)buf;
-
-            if( !spec )
-            {
-                dft_wave = ptr;
-                ptr += len*complex_elem_size;
-                itab = (int*)ptr;
-                ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-                DFTInit( len, nf, factors, itab, complex_elem_size, dft_wave, inv );
-            }
-                
-            dct_wave = ptr;
-            ptr += (len/2 + 1)*complex_elem_size;
-            src_dft_buf = dst_dft_buf = ptr;
-            ptr += len*elem_size;
-            if( !inplace_transform )
-            {
-                dst_dft_buf = ptr;
-                ptr += len*elem_size;
-            }
-            DCTInit( len, complex_elem_size, dct_wave, inv );
-            if( !inv )
-                scale += scale;
-            prev_len = len;
-        }
-        // otherwise reuse the tables calculated on the previous stage
-        for( i = 0; i < count; i++ )
-        {
-            dct_func( sptr + i*sstep0, (int)sstep1, src_dft_buf, dst_dft_buf,
-                      dptr + i*dstep0, (int)dstep1, len, nf, factors,
-                      itab, dft_wave, dct_wave, spec, ptr );
-        }
+        parallel_for_( BlockedRange(0, count, dftGrainSize(len)),
+                       DCTInvoker(sptr, sstep0, (int)sstep1, dptr, dstep0, (int)dstep1,
+                                  dct_func, plan, elem_size, work_size) );
         src = dst;
     }
 }
@@ -945,6 +945,7 @@ double cv::determinant( InputArray _mat )
 
 double cv::invert( InputArray _src, OutputArray _dst, int method )
 {
+    CV_TRACE_REGION("cv::invert");
     bool result = false;
     Mat src = _src.getMat();
     int type = src.type();
@@ -1154,6 +1155,7 @@ double cv::invert( InputArray _src, OutputArray _dst, int method )
 
 bool cv::solve( InputArray _src, InputArray _src2arg, OutputArray _dst, int method )
 {
+    CV_TRACE_REGION("cv::solve");
     bool result = true;
     Mat src = _src.getMat(), _src2 = _src2arg.getMat();
     int type = src.type();
@@ -1430,6 +1432,7 @@ bool cv::solve( InputArray _src, InputArray _src2arg, OutputArray _dst, int meth
 
 bool cv::eigen( InputArray _src, bool computeEvects, OutputArray _evals, OutputArray _evects )
 {
+    CV_TRACE_REGION("cv::eigen");
     Mat src = _src.getMat();
     int type = src.type();
     int n = src.rows;
@@ -1544,6 +1547,7 @@ static void _SVDcompute( InputArray _aarr, OutputArray _w,
     
 void SVD::compute( InputArray a, OutputArray w, OutputArray u, OutputArray vt, int flags )
 {
+    CV_TRACE_REGION("cv::SVD::compute");
     _SVDcompute(a, w, u, vt, flags);
 }
 
@@ -82,6 +82,8 @@ static void FastAtan2_32f(const float *Y, const float *X, float *angle, int len,
     int i = 0;
     float scale = angleInDegrees ? 1 : (float)(CV_PI/180);
 
+    CALL_AVX2(fastAtan2_32f, (Y, X, angle, len, scale));
+
 #ifdef HAVE_TEGRA_OPTIMIZATION
     if (tegra::FastAtan2_32f(Y, X, angle, len, scale))
         return;
@@ -196,6 +198,8 @@ float  cubeRoot( float value )
 
 static void Magnitude_32f(const float* x, const float* y, float* mag, int len)
 {
+    CALL_AVX2(magnitude32f, (x, y, mag, len));
+
     int i = 0;
 
 #if CV_SSE
@@ -222,6 +226,8 @@ static void Magnitude_32f(const float* x, const float* y, float* mag, int len)
 
 static void Magnitude_64f(const double* x, const double* y, double* mag, int len)
 {
+    CALL_AVX2(magnitude64f, (x, y, mag, len));
+
     int i = 0;
 
 #if CV_SSE2
@@ -777,6 +783,8 @@ static void Exp_32f( const float *_x, float *y, int n )
 #define EXPPOLY(x)  \
     (((((x) + A1)*(x) + A2)*(x) + A3)*(x) + A4)
 
+    CALL_AVX2(exp32f, (_x, y, n, expTab));
+
     int i = 0;
     const Cv32suf* x = (const Cv32suf*)_x;
     Cv32suf buf[4];
@@ -1460,6 +1468,8 @@ static void Log_32f( const float *_x, float *y, int n )
     #undef LOGPOLY
     #define LOGPOLY(x) (((A0*(x) + A1)*(x) + A2)*(x))
 
+    CALL_AVX2(log32f, (_x, y, n, icvLogTab));
+
     int i = 0;
     Cv32suf buf[4];
     const int* x = (const int*)_x;
@@ -46,6 +46,10 @@
 #include "ippversion.h"
 #endif
 
+#ifdef HAVE_CBLAS
+#include <cblas.h>
+#endif
+
 namespace cv
 {
 
@@ -693,11 +697,226 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+/*
+ The packed-panel GEMM for the real matrices (the scheme used by GotoBLAS and BLIS).
+
+ D is split into the horizontal stripes processed in parallel. For every KC-slice of op(A) the thread
+ packs its MC x KC block into the panels of MR rows, and then, one at a time, the KC x NR panels of
+ op(B), running the register-blocked MR x NR micro-kernel over the packed A block for each of them.
+ The packed A block stays in L2, the current B panel stays in L1 and the MR x NR tile of D stays
+ in the vector registers for the whole KC-slice. Like the non-blocked code, the single-precision
+ product is accumulated in double precision (WT), in a per-thread buffer for the MC rows of D.
+*/
+enum { GEMM_MR = 4, GEMM_KC = 256, GEMM_MC = 64 };
+
+template<typename T> struct GEMMVec {};
+
+#if CV_SIMD_64F
+template<> struct GEMMVec<double>
+{
+    typedef v_float64 vec_type;
+    static inline v_float64 setall(double v) { return v_setall_f64(v); }
+};
+#endif
+
+// packs mc x kc block of op(A), where op(A)(i,k) = a[i*step0 + k*step1], into the panels of GEMM_MR rows
+template<typename T, typename WT> static void
+GEMMPackA( const T* a, size_t step0, size_t step1, int mc, int kc, WT* dst )
+{
+    for( int i = 0; i < mc; i += GEMM_MR, a += step0*GEMM_MR )
+    {
+        int r, mr = std::min(mc - i, (int)GEMM_MR);
+        const T* src = a;
+        for( int k = 0; k < kc; k++, src += step1, dst += GEMM_MR )
+        {
+            for( r = 0; r < mr; r++ )
+                dst[r] = src[r*step0];
+            for( ; r < GEMM_MR; r++ )
+                dst[r] = 0;
+        }
+    }
+}
+
+// packs kc x n (n <= nr) panel of op(B), where op(B)(k,j) = b[k*step0 + j*step1], into nr columns
+template<typename T, typename WT> static void
+GEMMPackB( const T* b, size_t step0, size_t step1, int kc, int n, int nr, WT* dst )
+{
+    for( int k = 0; k < kc; k++, b += step0, dst += nr )
+    {
+        int c;
+        if( step1 == 1 )
+            for( c = 0; c < n; c++ )
+                dst[c] = b[c];
+        else
+            for( c = 0; c < n; c++ )
+                dst[c] = b[c*step1];
+        for( ; c < nr; c++ )
+            dst[c] = 0;
+    }
+}
+
+// computes (or adds, if accumulate=true) the product of GEMM_MR x kc and kc x nr panels to mr x n tile of D
+template<typename T> static void
+GEMMMicroKernel( int kc, const T* a, const T* b, T* d, size_t d_step, int mr, int n, bool accumulate )
+{
+    typedef typename GEMMVec<T>::vec_type VT;
+    enum { NL = VT::nlanes, NR = VT::nlanes*2 };
+
+    VT s00 = GEMMVec<T>::setall(0), s01 = s00, s10 = s00, s11 = s00;
+    VT s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+
+    for( int k = 0; k < kc; k++, a += GEMM_MR, b += NR )
+    {
+        VT b0 = v_load(b), b1 = v_load(b + NL), t;
+        t = GEMMVec<T>::setall(a[0]); s00 = v_muladd(t, b0, s00); s01 = v_muladd(t, b1, s01);
+        t = GEMMVec<T>::setall(a[1]); s10 = v_muladd(t, b0, s10); s11 = v_muladd(t, b1, s11);
+        t = GEMMVec<T>::setall(a[2]); s20 = v_muladd(t, b0, s20); s21 = v_muladd(t, b1, s21);
+        t = GEMMVec<T>::setall(a[3]); s30 = v_muladd(t, b0, s30); s31 = v_muladd(t, b1, s31);
+    }
+
+    if( mr == GEMM_MR && n == NR )
+    {
+        T *d0 = d, *d1 = d0 + d_step, *d2 = d1 + d_step, *d3 = d2 + d_step;
+        if( accumulate )
+        {
+            s00 += v_load(d0); s01 += v_load(d0 + NL);
+            s10 += v_load(d1); s11 += v_load(d1 + NL);
+            s20 += v_load(d2); s21 += v_load(d2 + NL);
+            s30 += v_load(d3); s31 += v_load(d3 + NL);
+        }
+        v_store(d0, s00); v_store(d0 + NL, s01);
+        v_store(d1, s10); v_store(d1 + NL, s11);
+        v_store(d2, s20); v_store(d2 + NL, s21);
+        v_store(d3, s30); v_store(d3 + NL, s31);
+    }
+    else
+    {
+        // the border tile: store the full tile into the buffer and copy its valid part
+        T buf[GEMM_MR*NR];
+        v_store(buf, s00); v_store(buf + NL, s01);
+        v_store(buf + NR, s10); v_store(buf + NR + NL, s11);
+        v_store(buf + NR*2, s20); v_store(buf + NR*2 + NL, s21);
+        v_store(buf + NR*3, s30); v_store(buf + NR*3 + NL, s31);
+        for( int i = 0; i < mr; i++, d += d_step )
+            for( int j = 0; j < n; j++ )
+                d[j] = accumulate ? d[j] + buf[i*NR + j] : buf[i*NR + j];
+    }
+}
+
+template<typename T, typename WT> class GEMMPackedInvoker : public ParallelLoopBody
+{
+public:
+    GEMMPackedInvoker( const Mat& _A, bool _is_a_t, const Mat& _B, bool _is_b_t, int _len,
+                       const Mat& _C, bool _is_c_t, Mat& _D, int _stripeRows, double _alpha, double _beta )
+        : A(&_A), is_a_t(_is_a_t), B(&_B), is_b_t(_is_b_t), len(_len), C(&_C), is_c_t(_is_c_t),
+          D(&_D), stripeRows(_stripeRows), alpha(_alpha), beta(_beta) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        const int nr = GEMMVec<WT>::vec_type::nlanes*2;
+        int rows = D->rows, cols = D->cols;
+        size_t a_step0 = A->step/sizeof(T), a_step1 = 1;
+        size_t b_step0 = B->step/sizeof(T), b_step1 = 1;
+        int i0 = range.begin()*stripeRows, i1 = std::min(range.end()*stripeRows, rows);
+        // the range may contain several stripes
+        int mc0 = std::min(i1 - i0, (int)GEMM_MC);
+
+        if( is_a_t )
+            std::swap(a_step0, a_step1);
+        if( is_b_t )
+            std::swap(b_step0, b_step1);
+
+        ScratchBuffer<WT> abuf(alignSize(mc0, GEMM_MR)*GEMM_KC), bbuf(GEMM_KC*nr);
+        // the sums are accumulated directly in D if it has the accumulator type
+        bool inplace = (int)DataType<T>::depth == (int)DataType<WT>::depth;
+        size_t dbuf_step = inplace ? D->step/sizeof(WT) : (size_t)cols;
+        ScratchBuffer<WT> dbuf;
+        if( !inplace )
+            dbuf.allocate(mc0*dbuf_step);
+
+        for( int y = i0; y < i1; y += GEMM_MC )
+        {
+            int mc = std::min(i1 - y, (int)GEMM_MC);
+            WT* dsum = inplace ? (WT*)D->ptr(y) : (WT*)dbuf;
+
+            for( int k0 = 0; k0 < len; k0 += GEMM_KC )
+            {
+                int kc = std::min(len - k0, (int)GEMM_KC);
+
+                GEMMPackA((const T*)A->data + y*a_step0 + k0*a_step1, a_step0, a_step1, mc, kc, (WT*)abuf);
+                for( int j = 0; j < cols; j += nr )
+                {
+                    int n = std::min(cols - j, nr);
+                    GEMMPackB((const T*)B->data + k0*b_step0 + j*b_step1, b_step0, b_step1, kc, n, nr, (WT*)bbuf);
+                    for( int i = 0; i < mc; i += GEMM_MR )
+                        GEMMMicroKernel(kc, (const WT*)abuf + i*kc, (const WT*)bbuf, dsum + i*dbuf_step + j,
+                                        dbuf_step, std::min(mc - i, (int)GEMM_MR), n, k0 > 0);
+                }
+            }
+
+            // D = alpha*D + beta*op(C)
+            for( int i = 0; i < mc; i++, dsum += dbuf_step )
+            {
+                T* d = (T*)D->ptr(y + i);
+                if( C->data )
+                {
+                    if( !is_c_t )
+                    {
+                        const T* c = (const T*)C->ptr(y + i);
+                        for( int j = 0; j < cols; j++ )
+                            d[j] = (T)(dsum[j]*alpha + c[j]*beta);
+                    }
+                    else
+                    {
+                        const T* c = (const T*)C->data + y + i;
+                        size_t c_step = C->step/sizeof(T);
+                        for( int j = 0; j < cols; j++ )
+                            d[j] = (T)(dsum[j]*alpha + c[j*c_step]*beta);
+                    }
+                }
+                else if( alpha != 1 || !inplace )
+                    for( int j = 0; j < cols; j++ )
+                        d[j] = (T)(dsum[j]*alpha);
+            }
+        }
+    }
+
+protected:
+    const Mat* A;
+    bool is_a_t;
+    const Mat* B;
+    bool is_b_t;
+    int len;
+    const Mat* C;
+    bool is_c_t;
+    Mat* D;
+    int stripeRows;
+    double alpha, beta;
+};
+
+// D = alpha*op(A)*op(B) + beta*op(C); D must not share the data with A, B or C
+template<typename T, typename WT> static void
+GEMMPacked( const Mat& A, const Mat& B, const Mat& C, Mat& D, int len,
+            double alpha, double beta, int flags )
+{
+    int rows = D.rows;
+
+    // make enough stripes to balance the load, but keep them tall enough to reuse the packed B panels
+    int stripeRows = (rows + getNumThreads()*4 - 1)/(getNumThreads()*4);
+    stripeRows = alignSize(std::max(std::min(stripeRows, (int)GEMM_MC), (int)GEMM_MR*4), GEMM_MR);
+    int nstripes = (rows + stripeRows - 1)/stripeRows;
+
+    parallel_for_(BlockedRange(0, nstripes),
+                  GEMMPackedInvoker<T, WT>(A, (flags & GEMM_1_T) != 0, B, (flags & GEMM_2_T) != 0, len, C,
+                                           (flags & GEMM_3_T) != 0, D, stripeRows, alpha, C.data ? beta : 0));
+}
+
 }
 
 void cv::gemm( InputArray matA, InputArray matB, double alpha,
            InputArray matC, double beta, OutputArray _matD, int flags )
 {
+    CV_TRACE_REGION("cv::gemm");
     const int block_lin_size = 128;
     const int block_size = block_lin_size * block_lin_size;
 
@@ -1050,75 +1269,87 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
         matD = &tmat;
     }
 
-    if( (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
-    {
-        b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
-        flags |= GEMM_2_T;
-    }
-
-    /*if( (d_size.width | d_size.height | len) >= 16 && icvBLAS_GEMM_32f_p != 0 )
+#ifdef HAVE_CBLAS
+    if( (d_size.width | d_size.height | len) >= 16 )
     {
-        blas_func = type == CV_32FC1 ? (icvBLAS_GEMM_32f_t)icvBLAS_GEMM_32f_p :
-                    type == CV_64FC1 ? (icvBLAS_GEMM_32f_t)icvBLAS_GEMM_64f_p :
-                    type == CV_32FC2 ? (icvBLAS_GEMM_32f_t)icvBLAS_GEMM_32fc_p :
-                    type == CV_64FC2 ? (icvBLAS_GEMM_32f_t)icvBLAS_GEMM_64fc_p : 0;
-    }
+        CBLAS_TRANSPOSE transa = flags & GEMM_1_T ? CblasTrans : CblasNoTrans;
+        CBLAS_TRANSPOSE transb = flags & GEMM_2_T ? CblasTrans : CblasNoTrans;
+        size_t esz = CV_ELEM_SIZE(type);
+        int lda = (int)(A.step/esz), ldb = (int)(B.step/esz), ldd = (int)(matD->step/esz);
 
-    if( blas_func )
-    {
-        const char* transa = flags & GEMM_1_T ? "t" : "n";
-        const char* transb = flags & GEMM_2_T ? "t" : "n";
-        int lda, ldb, ldd;
-
-        if( C->data.ptr )
+        if( C.data )
         {
-            if( C->data.ptr != D->data.ptr )
+            if( C.data != matD->data )
             {
                 if( !(flags & GEMM_3_T) )
-                    cvCopy( C, D );
+                    C.copyTo(*matD);
                 else
-                    cvTranspose( C, D );
+                    transpose(C, *matD);
             }
         }
-
-        if( CV_MAT_DEPTH(type) == CV_32F )
+        else
+            beta = 0;
+
+        if( type == CV_32FC1 )
+            cblas_sgemm( CblasRowMajor, transa, transb, d_size.height, d_size.width, len,
+                         (float)alpha, (const float*)A.data, lda, (const float*)B.data, ldb,
+                         (float)beta, (float*)matD->data, ldd );
+        else if( type == CV_64FC1 )
+            cblas_dgemm( CblasRowMajor, transa, transb, d_size.height, d_size.width, len,
+                         alpha, (const double*)A.data, lda, (const double*)B.data, ldb,
+                         beta, (double*)matD->data, ldd );
+        else if( type == CV_32FC2 )
+        {
+            Complexf _alpha((float)alpha, 0.f), _beta((float)beta, 0.f);
+            cblas_cgemm( CblasRowMajor, transa, transb, d_size.height, d_size.width, len,
+                         (const float*)&_alpha, (const float*)A.data, lda, (const float*)B.data, ldb,
+                         (const float*)&_beta, (float*)matD->data, ldd );
+        }
+        else
         {
-            Complex32f _alpha, _beta;
+            Complexd _alpha(alpha, 0.), _beta(beta, 0.);
+            cblas_zgemm( CblasRowMajor, transa, transb, d_size.height, d_size.width, len,
+                         (const double*)&_alpha, (const double*)A.data, lda, (const double*)B.data, ldb,
+                         (const double*)&_beta, (double*)matD->data, ldd );
+        }
 
-            lda = A->step/sizeof(float);
-            ldb = b_step/sizeof(float);
-            ldd = D->step/sizeof(float);
-            _alpha.re = (float)alpha;
-            _alpha.im = 0;
-            _beta.re = C->data.ptr ? (float)beta : 0;
-            _beta.im = 0;
-            if( CV_MAT_CN(type) == 2 )
-                lda /= 2, ldb /= 2, ldd /= 2;
+        if( matD != &D )
+            matD->copyTo(D);
+        return;
+    }
+#endif
 
-            blas_func( transb, transa, &d_size.width, &d_size.height, &len,
-                   &_alpha, B->data.ptr, &ldb, A->data.ptr, &lda,
-                   &_beta, D->data.ptr, &ldd );
+    if( (type == CV_32FC1 || type == CV_64FC1) && CV_SIMD_64F &&
+        std::min(d_size.width, d_size.height) >= 8 && len >= 8 &&
+        (double)d_size.width*d_size.height*len >= 32768. )
+    {
+        if( C.data == matD->data )
+        {
+            // op(C) is read after the product is stored to D
+            buf.allocate(d_size.width*d_size.height*CV_ELEM_SIZE(type));
+            tmat = Mat(d_size.height, d_size.width, type, (uchar*)buf);
+            matD = &tmat;
         }
+
+#if CV_SIMD_64F
+        if( type == CV_32FC1 )
+            GEMMPacked<float, double>(A, B, C, *matD, len, alpha, beta, flags);
         else
-        {
-            CvComplex64f _alpha, _beta;
+            GEMMPacked<double, double>(A, B, C, *matD, len, alpha, beta, flags);
+#endif
 
-            lda = A->step/sizeof(double);
-            ldb = b_step/sizeof(double);
-            ldd = D->step/sizeof(double);
-            _alpha.re = alpha;
-            _alpha.im = 0;
-            _beta.re = C->data.ptr ? beta : 0;
-            _beta.im = 0;
-            if( CV_MAT_CN(type) == 2 )
-                lda /= 2, ldb /= 2, ldd /= 2;
+        if( matD != &D )
+            matD->copyTo(D);
+        return;
+    }
 
-            blas_func( transb, transa, &d_size.width, &d_size.height, &len,
-                   &_alpha, B->data.ptr, &ldb, A->data.ptr, &lda,
-                   &_beta, D->data.ptr, &ldd );
-        }
+    if( (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
+    {
+        b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
+        flags |= GEMM_2_T;
     }
-    else*/ if( ((d_size.height <= block_lin_size/2 || d_size.width <= block_lin_size/2) &&
+
+    if( ((d_size.height <= block_lin_size/2 || d_size.width <= block_lin_size/2) &&
         len <= 10000) || len <= 10 ||
         (d_size.width <= block_lin_size &&
         d_size.height <= block_lin_size && len <= block_lin_size) )
@@ -2811,8 +3042,95 @@ PCA::PCA(InputArray data, InputArray _mean, int flags, int maxComponents)
     operator()(data, _mean, flags, maxComponents);
 }
 
+// orthonormalizes the matrix rows in-place with the modified Gram-Schmidt process,
+// applied twice to keep the rows orthogonal in single precision
+static void orthonormalizeRows( Mat& q )
+{
+    for( int pass = 0; pass < 2; pass++ )
+        for( int i = 0; i < q.rows; i++ )
+        {
+            Mat qi = q.row(i);
+            for( int j = 0; j < i; j++ )
+            {
+                Mat qj = q.row(j);
+                scaleAdd(qj, -qi.dot(qj), qi, qi);
+            }
+            double nrm = norm(qi);
+            qi *= nrm > 0 ? 1./nrm : 0.;
+        }
+}
+
+// finds the principal components of the data rows from the eigen decomposition of the matrix
+// g = b*b' (rows <= cols) or g = b'*b. The eigenvalues of g are divided by count
+static void componentsFromGram( const Mat& b, int ncomponents, double count, int ctype,
+                                Mat& eigenvalues, Mat& eigenvectors )
+{
+    Mat g, w, v;
+    bool byRows = b.rows <= b.cols;
+    mulTransposed(b, g, !byRows, noArray(), 1, CV_64F);
+    eigen(g, w, v);
+    v = v.rowRange(0, ncomponents);
+    if( byRows )
+    {
+        Mat b64, v1;
+        b.convertTo(b64, CV_64F);
+        gemm(v, b64, 1, Mat(), 0, v1);
+        for( int i = 0; i < ncomponents; i++ )
+        {
+            Mat vec = v1.row(i);
+            normalize(vec, vec);
+        }
+        v = v1;
+    }
+    w = max(w.rowRange(0, ncomponents), 0.);
+    w.convertTo(eigenvalues, ctype, 1./count);
+    v.convertTo(eigenvectors, ctype);
+}
+
+// randomized PCA (N. Halko, P.-G. Martinsson, J. A. Tropp, "Finding structure with randomness", 2011).
+// The data rows are centered on the fly, the centered copy of the data is never built.
+static void randomizedPCA( const Mat& data, const Mat& mean, int ncomponents,
+                           Mat& eigenvalues, Mat& eigenvectors )
+{
+    const int OVERSAMPLING = 10, POWER_ITERS = 4;
+    int n = data.rows, d = data.cols, ctype = mean.type();
+    int l = std::min(ncomponents + OVERSAMPLING, std::min(n, d));
+
+    // a fixed seed makes the result reproducible
+    RNG rng(0x12345678);
+    Mat b(l, d, ctype), q, proj;
+    rng.fill(b, RNG::NORMAL, Scalar::all(0), Scalar::all(1));
+
+    for( int iter = 0; ; iter++ )
+    {
+        // q' = b*(data - 1*mean)'; the rows of q' span the range of the centered data
+        gemm(b, data, 1, Mat(), 0, q, GEMM_2_T);
+        gemm(b, mean, 1, Mat(), 0, proj, GEMM_2_T);
+        proj.convertTo(proj, CV_64F);
+        for( int i = 0; i < l; i++ )
+            q.row(i) -= Scalar::all(proj.at<double>(i));
+        orthonormalizeRows(q);
+
+        // b = q'*(data - 1*mean)
+        gemm(q, data, 1, Mat(), 0, b);
+        reduce(q, proj, 1, CV_REDUCE_SUM, CV_64F);
+        for( int i = 0; i < l; i++ )
+        {
+            Mat bi = b.row(i);
+            scaleAdd(mean, -proj.at<double>(i), bi, bi);
+        }
+        if( iter == POWER_ITERS )
+            break;
+        orthonormalizeRows(b);
+    }
+
+    // the singular vectors of b are the principal components
+    componentsFromGram(b, ncomponents, n, ctype, eigenvalues, eigenvectors);
+}
+
 PCA& PCA::operator()(InputArray _data, InputArray __mean, int flags, int maxComponents)
 {
+    CV_TRACE_REGION("cv::PCA::operator()");
     Mat data = _data.getMat(), _mean = __mean.getMat();
     int covar_flags = CV_COVAR_SCALE;
     int i, len, in_count;
@@ -2846,14 +3164,31 @@ PCA& PCA::operator()(InputArray _data, InputArray __mean, int flags, int maxComp
     int ctype = std::max(CV_32F, data.depth());
     mean.create( mean_sz, ctype );
 
-    Mat covar( count, count, ctype );
-
     if( _mean.data )
     {
         CV_Assert( _mean.size() == mean_sz );
         _mean.convertTo(mean, ctype);
     }
 
+    // the randomized algorithm pays off when just a few components out of many are needed
+    if( (flags & CV_PCA_RANDOMIZED) && maxComponents > 0 && out_count + 10 < count )
+    {
+        Mat rows;
+        if( flags & CV_PCA_DATA_AS_COL )
+            transpose(data, rows);
+        else
+            rows = data;
+        if( rows.type() != ctype )
+            rows.convertTo(rows, ctype);
+        Mat rmean = mean.reshape(1, 1);
+        if( !_mean.data )
+            reduce(rows, rmean, 0, CV_REDUCE_AVG, ctype);
+        randomizedPCA(rows, rmean, out_count, eigenvalues, eigenvectors);
+        mean = rmean.reshape(1, mean_sz.height);
+        return *this;
+    }
+
+    Mat covar( count, count, ctype );
     calcCovarMatrix( data, covar, mean, covar_flags, ctype );
     eigen( covar, eigenvalues, eigenvectors );
 
@@ -2919,6 +3254,97 @@ void PCA::project(InputArray _data, OutputArray result) const
         gemm( eigenvectors, tmp_data, 1, Mat(), 0, result, 0 );
 }
 
+// incremental PCA (D. Ross, J. Lim, R.-S. Lin, M.-H. Yang, "Incremental Learning for Robust Visual Tracking", 2008):
+// the principal components of the previous samples, scaled by the singular values, the new centered samples
+// and the mean correction term make a small matrix with the same scatter as all the samples together
+IncrementalPCA::IncrementalPCA() : nsamples(0) {}
+
+IncrementalPCA::IncrementalPCA(const PCA& pca, int64 _nsamples) : PCA(pca), nsamples(_nsamples)
+{
+    CV_Assert( nsamples >= 0 );
+}
+
+IncrementalPCA& IncrementalPCA::operator()(InputArray _data, InputArray _mean, int flags, int maxComponents)
+{
+    Mat data = _data.getMat();
+    PCA::operator()(data, _mean, flags, maxComponents);
+    nsamples = (flags & CV_PCA_DATA_AS_COL) ? data.cols : data.rows;
+    return *this;
+}
+
+IncrementalPCA& IncrementalPCA::update(InputArray _data, int flags, int maxComponents)
+{
+    Mat data = _data.getMat();
+    CV_Assert( data.channels() == 1 );
+    bool dataAsCol = (flags & CV_PCA_DATA_AS_COL) != 0;
+    Mat x;
+    if( dataAsCol )
+        transpose(data, x);
+    else
+        x = data;
+    int m = x.rows, d = x.cols;
+    if( m == 0 )
+        return *this;
+
+    bool first = nsamples == 0 || !eigenvectors.data;
+
+    // the cost of the eigen decomposition grows as the cube of the batch size,
+    // so the large batches are added by blocks
+    const int UPDATE_BLOCK = 128;
+    if( m > UPDATE_BLOCK )
+    {
+        int k = maxComponents > 0 ? maxComponents : first ? d : eigenvectors.rows;
+        for( int i = 0; i < m; i += UPDATE_BLOCK )
+            update(x.rowRange(i, std::min(i + UPDATE_BLOCK, m)), CV_PCA_DATA_AS_ROW, k);
+        if( dataAsCol )
+            mean = mean.reshape(1, d);
+        return *this;
+    }
+    x.convertTo(x, CV_64F);
+    int ctype = first ? std::max(CV_32F, data.depth()) : mean.type();
+    int k0 = first ? 0 : eigenvectors.rows;
+    CV_Assert( first || (eigenvectors.cols == d && (int)mean.total() == d &&
+                         (int)eigenvalues.total() == k0) );
+
+    Mat bmean, mean0, newmean;
+    reduce(x, bmean, 0, CV_REDUCE_AVG);
+    double n0 = first ? 0. : (double)nsamples, n1 = n0 + m;
+
+    Mat b(k0 + m + (first ? 0 : 1), d, CV_64F);
+    if( !first )
+    {
+        Mat v, w;
+        eigenvectors.convertTo(v, CV_64F);
+        eigenvalues.reshape(1, k0).convertTo(w, CV_64F);
+        for( int i = 0; i < k0; i++ )
+        {
+            Mat bi = b.row(i);
+            v.row(i).convertTo(bi, CV_64F, std::sqrt(std::max(w.at<double>(i), 0.)*n0));
+        }
+        mean.reshape(1, 1).convertTo(mean0, CV_64F);
+        Mat bi = b.row(k0 + m);
+        subtract(mean0, bmean, bi);
+        bi *= std::sqrt(n0*m/n1);
+        addWeighted(mean0, n0/n1, bmean, m/n1, 0, newmean);
+    }
+    else
+        newmean = bmean;
+    for( int i = 0; i < m; i++ )
+    {
+        Mat bi = b.row(k0 + i);
+        subtract(x.row(i), bmean, bi);
+    }
+
+    int k = maxComponents > 0 ? maxComponents : first ? d : k0;
+    k = std::min(k, std::min(b.rows, d));
+    componentsFromGram(b, k, n1, ctype, eigenvalues, eigenvectors);
+    newmean.convertTo(mean, ctype);
+    if( dataAsCol )
+        mean = mean.reshape(1, d);
+    nsamples = (int64)n1;
+    return *this;
+}
+
 Mat PCA::project(InputArray data) const
 {
     Mat result;
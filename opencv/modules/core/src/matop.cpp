@@ -204,6 +204,125 @@ public:
 
 static MatOp_Initializer g_MatOp_Initializer;
 
+/*
+ Element-wise floating-point expressions that would otherwise be evaluated through temporary
+ arrays, e.g. A.mul(B) + C.mul(D) - E or abs(A - B) > t, are compiled into a small program
+ (MatExprProgram) and evaluated by MatOp_Fused in one pass over the operands, block by block,
+ so that the intermediate results stay in the cache.
+*/
+struct MatExprProgram
+{
+    enum { LEAF=0, CONST=1, ADDW=2, MUL=3, DIV=4, RECIP=5, ABS=6, ABSDIFF=7, MIN=8, MAX=9, CMP=10 };
+
+    struct Node
+    {
+        int op;
+        int arg[3]; // operand nodes, -1 if not used
+        int param;  // index of the array for LEAF, the comparison code for CMP
+        double alpha, beta;
+        Scalar s;   // the value for CONST
+    };
+
+    int addLeaf(const Mat& m);
+    int addConst(const Scalar& s);
+    int addNode(int op, int arg0, int arg1=-1, int arg2=-1, double alpha=1, double beta=0, int param=0);
+    bool isMask() const { return nodes.back().op == CMP; }
+    // the program is evaluated in the depth of leaves[0]; all the other leaves must match it
+    bool isUniform() const;
+
+    vector<Mat> leaves;
+    // operands always precede the nodes that use them; the last node is the result
+    vector<Node> nodes;
+};
+
+/*
+ MatExpr has no field for the program, so a fused expression keeps it in e.c: a 1x1 header
+ whose data is the program and whose allocator deletes the program with the last copy of
+ the header. The allocator is never used to create matrices.
+*/
+class MatExprProgramAllocator : public MatAllocator
+{
+public:
+    void allocate(int, const int*, int, int*&, uchar*&, uchar*&, size_t*)
+    {
+        CV_Error(CV_StsNotImplemented, "The allocator only holds the programs of fused expressions");
+    }
+    void deallocate(int* refcount, uchar* datastart, uchar*)
+    {
+        delete (MatExprProgram*)datastart;
+        delete refcount;
+    }
+};
+
+static MatExprProgramAllocator g_MatExprProgramAllocator;
+
+static inline const MatExprProgram& exprProgram(const MatExpr& e)
+{
+    return *(const MatExprProgram*)e.c.data;
+}
+
+int MatExprProgram::addLeaf(const Mat& m)
+{
+    // the same array used several times is read only once
+    int i, nleaves = (int)leaves.size();
+    for( i = 0; i < nleaves; i++ )
+        if( leaves[i].data == m.data && leaves[i].step[0] == m.step[0] &&
+            leaves[i].type() == m.type() && leaves[i].size == m.size )
+            break;
+    if( i == nleaves )
+        leaves.push_back(m);
+    for( size_t j = 0; j < nodes.size(); j++ )
+        if( nodes[j].op == LEAF && nodes[j].param == i )
+            return (int)j;
+    return addNode(LEAF, -1, -1, -1, 1, 0, i);
+}
+
+bool MatExprProgram::isUniform() const
+{
+    for( size_t i = 1; i < leaves.size(); i++ )
+        if( leaves[i].type() != leaves[0].type() || leaves[i].size != leaves[0].size )
+            return false;
+    return true;
+}
+
+int MatExprProgram::addConst(const Scalar& s)
+{
+    int idx = addNode(CONST, -1);
+    nodes[idx].s = s;
+    return idx;
+}
+
+int MatExprProgram::addNode(int op, int arg0, int arg1, int arg2, double alpha, double beta, int param)
+{
+    Node node;
+    node.op = op;
+    node.arg[0] = arg0; node.arg[1] = arg1; node.arg[2] = arg2;
+    node.param = param;
+    node.alpha = alpha; node.beta = beta;
+    nodes.push_back(node);
+    return (int)nodes.size() - 1;
+}
+
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const { return true; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+
+    void roi(const MatExpr& expr, const Range& rowRange, const Range& colRange, MatExpr& res) const;
+    void diag(const MatExpr& expr, int d, MatExpr& res) const;
+
+    Size size(const MatExpr& expr) const;
+    int type(const MatExpr& expr) const;
+
+    static void makeExpr(MatExpr& res, const MatExprProgram& program);
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
 static inline bool isIdentity(const MatExpr& e) { return e.op == &g_MatOp_Identity; }
 static inline bool isAddEx(const MatExpr& e) { return e.op == &g_MatOp_AddEx; }
 static inline bool isScaled(const MatExpr& e) { return isAddEx(e) && (!e.b.data || e.beta == 0) && e.s == Scalar(); }
@@ -216,6 +335,151 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == &g_MatOp_Initializer; }
+static inline bool isFused(const MatExpr& e) { return e.op == &g_MatOp_Fused; }
+// alpha*A + s, evaluated by the generic add/subtract code without a temporary array
+static inline bool isLinear(const MatExpr& e) { return isIdentity(e) || (isAddEx(e) && (!e.b.data || e.beta == 0)); }
+// alpha*A or alpha/A, evaluated by the generic multiply/divide code without a temporary array
+static inline bool isSimpleFactor(const MatExpr& e) { return isIdentity(e) || isScaled(e) || isReciprocal(e); }
+
+// returns the array that determines size and type of an expression MatOp_Fused can evaluate, 0 otherwise
+static const Mat* fusableArray(const MatExpr& e)
+{
+    const Mat* m = 0;
+    if( isIdentity(e) || isAddEx(e) )
+        m = &e.a;
+    else if( e.op == &g_MatOp_Bin && (e.flags == '*' || e.flags == '/' || e.flags == 'a' ||
+                                      e.flags == 'm' || e.flags == 'M') )
+        m = &e.a;
+    else if( isFused(e) && !exprProgram(e).isMask() )
+        m = &exprProgram(e).leaves[0];
+    // integer expressions are not fused, since their intermediate results are saturated
+    return m && m->data && (m->depth() == CV_32F || m->depth() == CV_64F) ? m : 0;
+}
+
+static bool canFuse(const MatExpr& e1, const MatExpr& e2)
+{
+    const Mat* m1 = fusableArray(e1);
+    const Mat* m2 = fusableArray(e2);
+    return m1 && m2 && m1->type() == m2->type() && m1->size == m2->size;
+}
+
+// appends the nodes computing expression e to the program, returns the index of the result node
+static int appendExpr(MatExprProgram& p, const MatExpr& e)
+{
+    if( isFused(e) )
+    {
+        const MatExprProgram& q = exprProgram(e);
+        vector<int> idx(q.nodes.size());
+
+        for( size_t i = 0; i < q.nodes.size(); i++ )
+        {
+            MatExprProgram::Node node = q.nodes[i];
+            if( node.op == MatExprProgram::LEAF )
+                idx[i] = p.addLeaf(q.leaves[node.param]);
+            else
+            {
+                for( int j = 0; j < 3; j++ )
+                    if( node.arg[j] >= 0 )
+                        node.arg[j] = idx[node.arg[j]];
+                p.nodes.push_back(node);
+                idx[i] = (int)p.nodes.size() - 1;
+            }
+        }
+        return idx.back();
+    }
+
+    if( isAddEx(e) )
+    {
+        int a = p.addLeaf(e.a);
+        int b = e.b.data && e.beta != 0 ? p.addLeaf(e.b) : -1;
+        int c = e.s != Scalar() ? p.addConst(e.s) : -1;
+        return p.addNode(MatExprProgram::ADDW, a, b, c, e.alpha, b >= 0 ? e.beta : 0);
+    }
+
+    if( e.op == &g_MatOp_Bin )
+    {
+        int a = p.addLeaf(e.a);
+        switch( e.flags )
+        {
+        case '*':
+            return p.addNode(MatExprProgram::MUL, a, p.addLeaf(e.b), -1, e.alpha);
+        case '/':
+            if( e.b.data )
+                return p.addNode(MatExprProgram::DIV, a, p.addLeaf(e.b), -1, e.alpha);
+            return p.addNode(MatExprProgram::RECIP, a, -1, -1, e.alpha);
+        case 'a':
+            if( e.b.data )
+                return p.addNode(MatExprProgram::ABSDIFF, a, p.addLeaf(e.b));
+            if( e.s == Scalar() )
+                return p.addNode(MatExprProgram::ABS, a);
+            return p.addNode(MatExprProgram::ABSDIFF, a, p.addConst(e.s));
+        case 'm':
+        case 'M':
+            return p.addNode(e.flags == 'm' ? MatExprProgram::MIN : MatExprProgram::MAX, a,
+                             e.b.data ? p.addLeaf(e.b) : p.addConst(Scalar::all(e.s[0])));
+        }
+    }
+
+    if( isIdentity(e) )
+        return p.addLeaf(e.a);
+
+    Mat m;
+    e.op->assign(e, m);
+    return p.addLeaf(m);
+}
+
+// builds the fused expression "e1 op e2", op is one of '+', '-', '*', '/'
+static bool fuseBinary(const MatExpr& e1, const MatExpr& e2, char op, double scale, MatExpr& res)
+{
+    if( !canFuse(e1, e2) )
+        return false;
+
+    MatExprProgram p;
+    int a = appendExpr(p, e1), b = appendExpr(p, e2);
+    if( op == '+' || op == '-' )
+        p.addNode(MatExprProgram::ADDW, a, b, -1, 1, op == '+' ? 1 : -1);
+    else
+        p.addNode(op == '*' ? MatExprProgram::MUL : MatExprProgram::DIV, a, b, -1, scale);
+    // mixed operands, e.g. A.mul(B) with B of another depth, are left to the step-by-step evaluation
+    if( !p.isUniform() )
+        return false;
+    MatOp_Fused::makeExpr(res, p);
+    return true;
+}
+
+// builds the fused expression "alpha*e + s" (ADDW), "alpha/e" (RECIP) or "abs(e)" (ABS)
+static bool fuseUnary(const MatExpr& e, int op, double alpha, const Scalar& s, MatExpr& res)
+{
+    if( isIdentity(e) || !fusableArray(e) )
+        return false;
+
+    MatExprProgram p;
+    int a = appendExpr(p, e);
+    int c = op == MatExprProgram::ADDW && s != Scalar() ? p.addConst(s) : -1;
+    p.addNode(op, a, -1, c, alpha);
+    if( !p.isUniform() )
+        return false;
+    MatOp_Fused::makeExpr(res, p);
+    return true;
+}
+
+// builds "e1 cmpop e2" if it can be evaluated in one pass; e2 may be empty when s is used
+static bool fuseCompare(int cmpop, const MatExpr& e1, const MatExpr* e2, double s, MatExpr& res)
+{
+    const Mat* m1 = fusableArray(e1);
+    if( !m1 || m1->channels() != 1 || (isIdentity(e1) && (!e2 || isIdentity(*e2))) ||
+        (e2 && !canFuse(e1, *e2)) )
+        return false;
+
+    MatExprProgram p;
+    int a = appendExpr(p, e1);
+    int b = e2 ? appendExpr(p, *e2) : p.addConst(Scalar::all(s));
+    p.addNode(MatExprProgram::CMP, a, b, -1, 1, 0, cmpop);
+    if( !p.isUniform() )
+        return false;
+    MatOp_Fused::makeExpr(res, p);
+    return true;
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -327,6 +591,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( (!isLinear(e1) || !isLinear(e2)) && fuseBinary(e1, e2, '+', 1, res) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -356,6 +623,8 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
+    if( fuseUnary(expr1, MatExprProgram::ADDW, 1, s, res) )
+        return;
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -366,6 +635,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( (!isLinear(e1) || !isLinear(e2)) && fuseBinary(e1, e2, '-', 1, res) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -395,6 +667,8 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
+    if( fuseUnary(expr, MatExprProgram::ADDW, -1, s, res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -405,6 +679,9 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 {
     if( this == e2.op )
     {
+        if( (!isSimpleFactor(e1) || !isSimpleFactor(e2)) && fuseBinary(e1, e2, '*', scale, res) )
+            return;
+
         Mat m1, m2;
 
         if( isReciprocal(e1) )
@@ -454,6 +731,8 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
 void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
+    if( fuseUnary(expr, MatExprProgram::ADDW, s, Scalar(), res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -464,6 +743,9 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 {
     if( this == e2.op )
     {
+        if( (!isSimpleFactor(e1) || !isSimpleFactor(e2)) && fuseBinary(e1, e2, '/', scale, res) )
+            return;
+
         if( isReciprocal(e1) && isReciprocal(e2) )
             MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
         else
@@ -502,6 +784,8 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 
 void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
+    if( fuseUnary(expr, MatExprProgram::RECIP, s, Scalar(), res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
@@ -510,6 +794,8 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 
 void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
+    if( fuseUnary(expr, MatExprProgram::ABS, 1, Scalar(), res) )
+        return;
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -1028,6 +1314,38 @@ MatExpr operator > (double s, const Mat& a)
     return e;
 }
 
+static MatExpr compareExpr(int cmpop, const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr e;
+    if( !fuseCompare(cmpop, e1, &e2, 0, e) )
+        MatOp_Cmp::makeExpr(e, cmpop, (Mat)e1, (Mat)e2);
+    return e;
+}
+
+static MatExpr compareExpr(int cmpop, const MatExpr& e1, double s)
+{
+    MatExpr e;
+    if( !fuseCompare(cmpop, e1, 0, s, e) )
+        MatOp_Cmp::makeExpr(e, cmpop, (Mat)e1, s);
+    return e;
+}
+
+#define CV_MATEXPR_CMP_OP(op, cmpop, rcmpop) \
+MatExpr operator op (const MatExpr& e1, const MatExpr& e2) { return compareExpr(cmpop, e1, e2); } \
+MatExpr operator op (const MatExpr& e, const Mat& m) { return compareExpr(cmpop, e, MatExpr(m)); } \
+MatExpr operator op (const Mat& m, const MatExpr& e) { return compareExpr(cmpop, MatExpr(m), e); } \
+MatExpr operator op (const MatExpr& e, double s) { return compareExpr(cmpop, e, s); } \
+MatExpr operator op (double s, const MatExpr& e) { return compareExpr(rcmpop, e, s); }
+
+CV_MATEXPR_CMP_OP(<, CV_CMP_LT, CV_CMP_GT)
+CV_MATEXPR_CMP_OP(<=, CV_CMP_LE, CV_CMP_GE)
+CV_MATEXPR_CMP_OP(==, CV_CMP_EQ, CV_CMP_EQ)
+CV_MATEXPR_CMP_OP(!=, CV_CMP_NE, CV_CMP_NE)
+CV_MATEXPR_CMP_OP(>=, CV_CMP_GE, CV_CMP_LE)
+CV_MATEXPR_CMP_OP(>, CV_CMP_GT, CV_CMP_LT)
+
+#undef CV_MATEXPR_CMP_OP
+
 MatExpr min(const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1407,6 +1725,345 @@ inline void MatOp_Cmp::makeExpr(MatExpr& res, int cmpop, const Mat& a, double al
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// the number of elements processed at once; the intermediate results of a block stay in L1
+enum { FUSED_BLOCK_SIZE = 512 };
+
+// the arithmetic nodes are computed in double precision and rounded once, like the scaled
+// CV_32F operations of arithm.cpp (addWeighted, divide); for the unscaled sums and products
+// this gives the same result as the single-precision operations
+template<typename T> static inline void
+runFusedNodeScalar( const MatExprProgram::Node& node, const T* a, const T* b, const T* c,
+                    T* dst, uchar* mask, int i, int len )
+{
+    double alpha = node.alpha, beta = node.beta;
+
+    switch( node.op )
+    {
+    case MatExprProgram::ADDW:
+        if( b && c )
+            for( ; i < len; i++ )
+                dst[i] = (T)(a[i]*alpha + b[i]*beta + c[i]);
+        else if( b )
+            for( ; i < len; i++ )
+                dst[i] = (T)(a[i]*alpha + b[i]*beta);
+        else if( c )
+            for( ; i < len; i++ )
+                dst[i] = (T)(a[i]*alpha + c[i]);
+        else
+            for( ; i < len; i++ )
+                dst[i] = (T)(a[i]*alpha);
+        break;
+    case MatExprProgram::MUL:
+        for( ; i < len; i++ )
+            dst[i] = (T)(a[i]*alpha*b[i]);
+        break;
+    case MatExprProgram::DIV:
+        for( ; i < len; i++ )
+            dst[i] = b[i] != 0 ? (T)(a[i]*alpha/b[i]) : 0;
+        break;
+    case MatExprProgram::RECIP:
+        for( ; i < len; i++ )
+            dst[i] = a[i] != 0 ? (T)(alpha/a[i]) : 0;
+        break;
+    case MatExprProgram::ABS:
+        for( ; i < len; i++ )
+            dst[i] = std::abs(a[i]);
+        break;
+    case MatExprProgram::ABSDIFF:
+        for( ; i < len; i++ )
+            dst[i] = std::abs(a[i] - b[i]);
+        break;
+    case MatExprProgram::MIN:
+        for( ; i < len; i++ )
+            dst[i] = std::min(a[i], b[i]);
+        break;
+    case MatExprProgram::MAX:
+        for( ; i < len; i++ )
+            dst[i] = std::max(a[i], b[i]);
+        break;
+    case MatExprProgram::CMP:
+        switch( node.param )
+        {
+        case CMP_EQ: for( ; i < len; i++ ) mask[i] = (uchar)-(a[i] == b[i]); break;
+        case CMP_NE: for( ; i < len; i++ ) mask[i] = (uchar)-(a[i] != b[i]); break;
+        case CMP_LT: for( ; i < len; i++ ) mask[i] = (uchar)-(a[i] < b[i]); break;
+        case CMP_LE: for( ; i < len; i++ ) mask[i] = (uchar)-(a[i] <= b[i]); break;
+        case CMP_GT: for( ; i < len; i++ ) mask[i] = (uchar)-(a[i] > b[i]); break;
+        case CMP_GE: for( ; i < len; i++ ) mask[i] = (uchar)-(a[i] >= b[i]); break;
+        }
+        break;
+    default:
+        CV_Error(CV_StsError, "Unknown operation");
+    }
+}
+
+#if CV_SIMD
+
+static inline v_float32 fusedSetAll(float v) { return v_setall_f32(v); }
+#if CV_SIMD_64F
+static inline v_float64 fusedSetAll(double v) { return v_setall_f64(v); }
+#endif
+
+static inline v_uint8 fusedPackMask(const v_float32& m0, const v_float32& m1,
+                                    const v_float32& m2, const v_float32& m3)
+{
+    return v_reinterpret_as_u8(v_pack(v_pack(v_reinterpret_as_s32(m0), v_reinterpret_as_s32(m1)),
+                                      v_pack(v_reinterpret_as_s32(m2), v_reinterpret_as_s32(m3))));
+}
+
+template<typename _Tpvec> static inline _Tpvec fusedCompare(int cmpop, const _Tpvec& a, const _Tpvec& b)
+{
+    switch( cmpop )
+    {
+    case CMP_EQ: return a == b;
+    case CMP_NE: return a != b;
+    case CMP_LT: return a < b;
+    case CMP_LE: return a <= b;
+    case CMP_GT: return a > b;
+    default: return a >= b;
+    }
+}
+
+// processes the vectorizable part of the block, returns the number of processed elements
+template<typename T, typename _Tpvec> static int
+runFusedNodeSIMD( const MatExprProgram::Node& node, const T* a, const T* b, const T* c,
+                  T* dst, uchar* mask, int len )
+{
+    const int n = _Tpvec::nlanes;
+    _Tpvec alpha = fusedSetAll((T)node.alpha), beta = fusedSetAll((T)node.beta), z = fusedSetAll((T)0);
+    int i = 0;
+
+    switch( node.op )
+    {
+    case MatExprProgram::ADDW:
+        if( b && c )
+            for( ; i <= len - n; i += n )
+                v_store(dst + i, v_muladd(v_load(a + i), alpha, v_muladd(v_load(b + i), beta, v_load(c + i))));
+        else if( b )
+            for( ; i <= len - n; i += n )
+                v_store(dst + i, v_muladd(v_load(a + i), alpha, v_load(b + i)*beta));
+        else if( c )
+            for( ; i <= len - n; i += n )
+                v_store(dst + i, v_muladd(v_load(a + i), alpha, v_load(c + i)));
+        else
+            for( ; i <= len - n; i += n )
+                v_store(dst + i, v_load(a + i)*alpha);
+        break;
+    case MatExprProgram::MUL:
+        for( ; i <= len - n; i += n )
+            v_store(dst + i, v_load(a + i)*alpha*v_load(b + i));
+        break;
+    case MatExprProgram::DIV:
+        for( ; i <= len - n; i += n )
+        {
+            _Tpvec vb = v_load(b + i);
+            v_store(dst + i, (vb != z) & (v_load(a + i)*alpha/vb));
+        }
+        break;
+    case MatExprProgram::RECIP:
+        for( ; i <= len - n; i += n )
+        {
+            _Tpvec va = v_load(a + i);
+            v_store(dst + i, (va != z) & (alpha/va));
+        }
+        break;
+    case MatExprProgram::ABS:
+        for( ; i <= len - n; i += n )
+            v_store(dst + i, v_abs(v_load(a + i)));
+        break;
+    case MatExprProgram::ABSDIFF:
+        for( ; i <= len - n; i += n )
+            v_store(dst + i, v_absdiff(v_load(a + i), v_load(b + i)));
+        break;
+    case MatExprProgram::MIN:
+        for( ; i <= len - n; i += n )
+            v_store(dst + i, v_min(v_load(a + i), v_load(b + i)));
+        break;
+    case MatExprProgram::MAX:
+        for( ; i <= len - n; i += n )
+            v_store(dst + i, v_max(v_load(a + i), v_load(b + i)));
+        break;
+    case MatExprProgram::CMP:
+        if( sizeof(T) == sizeof(float) )
+        {
+            const float *fa = (const float*)a, *fb = (const float*)b;
+            for( ; i <= len - n*4; i += n*4 )
+            {
+                v_float32 m0 = fusedCompare(node.param, v_load(fa + i), v_load(fb + i));
+                v_float32 m1 = fusedCompare(node.param, v_load(fa + i + n), v_load(fb + i + n));
+                v_float32 m2 = fusedCompare(node.param, v_load(fa + i + n*2), v_load(fb + i + n*2));
+                v_float32 m3 = fusedCompare(node.param, v_load(fa + i + n*3), v_load(fb + i + n*3));
+                v_store(mask + i, fusedPackMask(m0, m1, m2, m3));
+            }
+        }
+        break;
+    }
+    return i;
+}
+
+static inline int runFusedNodeVec( const MatExprProgram::Node& node, const float* a, const float* b,
+                                   const float* c, float* dst, uchar* mask, int len )
+{
+    return runFusedNodeSIMD<float, v_float32>(node, a, b, c, dst, mask, len);
+}
+
+static inline int runFusedNodeVec( const MatExprProgram::Node& node, const double* a, const double* b,
+                                   const double* c, double* dst, uchar* mask, int len )
+{
+#if CV_SIMD_64F
+    return runFusedNodeSIMD<double, v_float64>(node, a, b, c, dst, mask, len);
+#else
+    (void)node; (void)a; (void)b; (void)c; (void)dst; (void)mask; (void)len;
+    return 0;
+#endif
+}
+
+#endif
+
+// true if the single-precision vector code gives the same result as runFusedNodeScalar,
+// i.e. the node is an unscaled sum, difference or product, or is exact anyway
+static inline bool isSinglePrecisionExact( const MatExprProgram::Node& node )
+{
+    switch( node.op )
+    {
+    case MatExprProgram::ADDW:
+        return std::abs(node.alpha) == 1 && (node.arg[1] < 0 || node.arg[2] < 0) &&
+               (node.arg[1] < 0 || std::abs(node.beta) == 1);
+    case MatExprProgram::MUL:
+        return node.alpha == 1;
+    case MatExprProgram::DIV:
+    case MatExprProgram::RECIP:
+        return false;
+    }
+    return true;
+}
+
+template<typename T> static inline void
+runFusedNode( const MatExprProgram::Node& node, const T* a, const T* b, const T* c,
+              T* dst, uchar* mask, int len, bool useSIMD )
+{
+    int i = 0;
+#if CV_SIMD
+    if( useSIMD && (sizeof(T) == sizeof(double) || isSinglePrecisionExact(node)) )
+        i = runFusedNodeVec(node, a, b, c, dst, mask, len);
+#else
+    (void)useSIMD;
+#endif
+    runFusedNodeScalar(node, a, b, c, dst, mask, i, len);
+}
+
+template<typename T> static void
+runFusedProgram( const MatExprProgram& p, Mat& dst )
+{
+    typedef MatExprProgram::Node Node;
+    int nleaves = (int)p.leaves.size(), nnodes = (int)p.nodes.size();
+    int cn = p.leaves[0].channels();
+    int blockSize = (FUSED_BLOCK_SIZE/cn)*cn;
+    bool useSIMD = checkSIMDSupport();
+
+    vector<const Mat*> arrays(nleaves + 1);
+    vector<uchar*> ptrs(nleaves + 1);
+    for( int k = 0; k < nleaves; k++ )
+        arrays[k] = &p.leaves[k];
+    arrays[nleaves] = &dst;
+    NAryMatIterator it(&arrays[0], &ptrs[0], nleaves + 1);
+    int total = (int)it.size*cn;
+
+    // one block-sized buffer per node; the constants are expanded once
+    AutoBuffer<T> _buf(blockSize*nnodes + 1);
+    AutoBuffer<const T*> _src(nnodes);
+    T* buf = _buf;
+    const T** src = _src;
+
+    for( int k = 0; k < nnodes; k++ )
+        if( p.nodes[k].op == MatExprProgram::CONST )
+        {
+            T* cbuf = buf + blockSize*k;
+            for( int j = 0; j < blockSize; j++ )
+                cbuf[j] = saturate_cast<T>(p.nodes[k].s[j % cn]);
+            src[k] = cbuf;
+        }
+
+    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    {
+        for( int j = 0; j < total; j += blockSize )
+        {
+            int len = std::min(total - j, blockSize);
+
+            for( int k = 0; k < nnodes; k++ )
+            {
+                const Node& node = p.nodes[k];
+                if( node.op == MatExprProgram::LEAF )
+                {
+                    src[k] = (const T*)ptrs[node.param] + j;
+                    continue;
+                }
+                if( node.op == MatExprProgram::CONST )
+                    continue;
+
+                bool isRoot = k == nnodes - 1;
+                T* out = isRoot ? (T*)ptrs[nleaves] + j : buf + blockSize*k;
+                uchar* mask = isRoot ? ptrs[nleaves] + j : 0;
+                runFusedNode(node, src[node.arg[0]], node.arg[1] >= 0 ? src[node.arg[1]] : 0,
+                             node.arg[2] >= 0 ? src[node.arg[2]] : 0, out, mask, len, useSIMD);
+                src[k] = out;
+            }
+        }
+    }
+}
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    const MatExprProgram& p = exprProgram(e);
+    int rtype = type(e);
+    Mat temp, &dst = _type == -1 || _type == rtype ? m : temp;
+
+    // the operands are read before the results are written block by block,
+    // so the destination may be one of the operands
+    dst.create(p.leaves[0].dims, p.leaves[0].size, rtype);
+    if( p.leaves[0].depth() == CV_32F )
+        runFusedProgram<float>(p, dst);
+    else
+        runFusedProgram<double>(p, dst);
+
+    if( dst.data != m.data )
+        dst.convertTo(m, _type);
+}
+
+void MatOp_Fused::roi(const MatExpr& e, const Range& rowRange, const Range& colRange, MatExpr& res) const
+{
+    MatExprProgram p = exprProgram(e);
+    for( size_t i = 0; i < p.leaves.size(); i++ )
+        p.leaves[i] = p.leaves[i](rowRange, colRange);
+    makeExpr(res, p);
+}
+
+void MatOp_Fused::diag(const MatExpr& e, int d, MatExpr& res) const
+{
+    MatExprProgram p = exprProgram(e);
+    for( size_t i = 0; i < p.leaves.size(); i++ )
+        p.leaves[i] = p.leaves[i].diag(d);
+    makeExpr(res, p);
+}
+
+Size MatOp_Fused::size(const MatExpr& e) const
+{
+    return exprProgram(e).leaves[0].size();
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    return exprProgram(e).isMask() ? CV_8U : exprProgram(e).leaves[0].type();
+}
+
+inline void MatOp_Fused::makeExpr(MatExpr& res, const MatExprProgram& program)
+{
+    Mat holder(1, 1, CV_8U, new MatExprProgram(program));
+    holder.refcount = new int(1);
+    holder.allocator = &g_MatExprProgramAllocator;
+    res = MatExpr(&g_MatOp_Fused, 0, Mat(), Mat(), holder, 1, 0);
+}
+
 void MatOp_T::assign(const MatExpr& e, Mat& m, int _type) const
 {
     Mat temp, &dst = _type == -1 || _type == e.a.type() ? m : temp;
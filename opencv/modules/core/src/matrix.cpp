@@ -43,6 +43,8 @@
 #include "precomp.hpp"
 #include "opencv2/core/gpumat.hpp"
 #include "opencv2/core/opengl_interop.hpp"
+#include <list>
+#include <map>
 
 /****************************************************************************************\
 *                           [scaled] Identity matrix initialization                      *
@@ -208,6 +210,8 @@ void Mat::create(int d, const int* _sizes, int _type)
 #ifdef HAVE_TGPU
         if( !allocator || allocator == tegra::getAllocator() ) allocator = tegra::getAllocator(d, _sizes, _type);
 #endif
+        if( !allocator )
+            allocator = getDefaultAllocator();
         if( !allocator )
         {
             size_t totalsize = alignSize(step.p[0]*size.p[0], (int)sizeof(*refcount));
@@ -261,6 +265,203 @@ void Mat::deallocate()
     }
 }
 
+static MatAllocator* volatile defaultAllocator = 0;
+
+void Mat::setDefaultAllocator(MatAllocator* _allocator)
+{
+    defaultAllocator = _allocator;
+}
+
+MatAllocator* Mat::getDefaultAllocator()
+{
+    return defaultAllocator;
+}
+
+/****************************************************************************************\
+*                                 Frame pool allocator                                   *
+\****************************************************************************************/
+
+// the buffer header; it occupies the whole cache line to keep the data aligned
+struct FramePoolBufHdr
+{
+    size_t size;
+    int type;
+};
+
+enum { FRAME_POOL_HDR_SIZE = 64 };
+
+struct FramePoolAllocator::Impl
+{
+    struct Buffer
+    {
+        uchar* ptr;
+        size_t size;
+        int type;
+    };
+
+    typedef std::pair<size_t, int> Key;
+    typedef std::list<Buffer> BufferList;
+    typedef std::map<Key, std::vector<BufferList::iterator> > BufferIndex;
+
+    Impl(size_t _maxRetained) : retained(0), maxRetained(_maxRetained), hits(0), misses(0) {}
+
+    // removes the least recently released buffers until the retained size fits the limit;
+    // the buffers to free are returned in trash
+    void shrink(size_t limit, vector<uchar*>& trash)
+    {
+        while( retained > limit && !lru.empty() )
+        {
+            BufferList::iterator it = --lru.end();
+            BufferIndex::iterator idx = index.find(Key(it->size, it->type));
+            CV_Assert( idx != index.end() );
+            std::vector<BufferList::iterator>& v = idx->second;
+            std::swap(*std::find(v.begin(), v.end(), it), v.back());
+            v.pop_back();
+            if( v.empty() )
+                index.erase(idx);
+            retained -= it->size;
+            trash.push_back(it->ptr);
+            lru.erase(it);
+        }
+    }
+
+    mutable Mutex mutex;
+    BufferList lru; // the most recently released buffers go first
+    BufferIndex index;
+    size_t retained, maxRetained;
+    size_t hits, misses;
+};
+
+static void freeFramePoolBuffers(const vector<uchar*>& trash)
+{
+    for( size_t i = 0; i < trash.size(); i++ )
+        fastFree(trash[i]);
+}
+
+FramePoolAllocator::FramePoolAllocator(size_t maxRetainedBytes)
+{
+    impl = new Impl(maxRetainedBytes);
+}
+
+FramePoolAllocator::~FramePoolAllocator()
+{
+    release();
+    delete impl;
+}
+
+void FramePoolAllocator::allocate(int dims, const int* sizes, int type, int*& refcount,
+                                  uchar*& datastart, uchar*& data, size_t* step)
+{
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        step[i] = total;
+        total *= sizes[i];
+    }
+    total = alignSize(total, (int)sizeof(*refcount));
+    size_t size = total + sizeof(*refcount) + FRAME_POOL_HDR_SIZE;
+    uchar* ptr = 0;
+
+    {
+    AutoLock lock(impl->mutex);
+    Impl::BufferIndex::iterator idx = impl->index.find(Impl::Key(size, type));
+    if( idx != impl->index.end() )
+    {
+        std::vector<Impl::BufferList::iterator>& v = idx->second;
+        Impl::BufferList::iterator it = v.back();
+        ptr = it->ptr;
+        v.pop_back();
+        if( v.empty() )
+            impl->index.erase(idx);
+        impl->lru.erase(it);
+        impl->retained -= size;
+        impl->hits++;
+    }
+    else
+        impl->misses++;
+    }
+
+    if( !ptr )
+    {
+        ptr = (uchar*)fastMalloc(size);
+        FramePoolBufHdr* hdr = (FramePoolBufHdr*)ptr;
+        hdr->size = size;
+        hdr->type = type;
+    }
+
+    datastart = data = ptr + FRAME_POOL_HDR_SIZE;
+    refcount = (int*)(data + total);
+    *refcount = 1;
+}
+
+void FramePoolAllocator::deallocate(int*, uchar* datastart, uchar*)
+{
+    if( !datastart )
+        return;
+    uchar* ptr = datastart - FRAME_POOL_HDR_SIZE;
+    const FramePoolBufHdr* hdr = (const FramePoolBufHdr*)ptr;
+    vector<uchar*> trash;
+
+    {
+    AutoLock lock(impl->mutex);
+    Impl::Buffer buf;
+    buf.ptr = ptr;
+    buf.size = hdr->size;
+    buf.type = hdr->type;
+    impl->lru.push_front(buf);
+    impl->index[Impl::Key(buf.size, buf.type)].push_back(impl->lru.begin());
+    impl->retained += buf.size;
+    impl->shrink(impl->maxRetained, trash);
+    }
+
+    freeFramePoolBuffers(trash);
+}
+
+void FramePoolAllocator::release()
+{
+    vector<uchar*> trash;
+    {
+    AutoLock lock(impl->mutex);
+    impl->shrink(0, trash);
+    }
+    freeFramePoolBuffers(trash);
+}
+
+void FramePoolAllocator::setMaxRetainedBytes(size_t maxRetainedBytes)
+{
+    vector<uchar*> trash;
+    {
+    AutoLock lock(impl->mutex);
+    impl->maxRetained = maxRetainedBytes;
+    impl->shrink(maxRetainedBytes, trash);
+    }
+    freeFramePoolBuffers(trash);
+}
+
+size_t FramePoolAllocator::getMaxRetainedBytes() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->maxRetained;
+}
+
+size_t FramePoolAllocator::getRetainedBytes() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->retained;
+}
+
+size_t FramePoolAllocator::getHits() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->hits;
+}
+
+size_t FramePoolAllocator::getMisses() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->misses;
+}
+
 
 Mat::Mat(const Mat& m, const Range& _rowRange, const Range& _colRange) : size(&rows)
 {
@@ -1868,6 +2069,7 @@ static TransposeInplaceFunc transposeInplaceTab[] =
 
 void cv::transpose( InputArray _src, OutputArray _dst )
 {
+    CV_TRACE_REGION("cv::transpose");
     Mat src = _src.getMat();
     size_t esz = src.elemSize();
     CV_Assert( src.dims <= 2 && esz <= (size_t)32 );
@@ -1966,6 +2168,72 @@ cv::Mat cv::Mat::cross(InputArray _m) const
 namespace cv
 {
 
+// the vectorized part of buf[i] = op(buf[i], src[i]), returns the number of processed elements
+template<typename T, typename WT, class Op> static inline int
+vReduceR( const T*, WT*, int, const Op& ) { return 0; }
+
+#if CV_SIMD
+
+// v_min(src, buf) and v_max(src, buf) treat NaNs as std::min(buf, src) and std::max(buf, src) do
+struct VReduceAdd { template<typename V> V operator()(const V& a, const V& b) const { return a + b; }};
+struct VReduceMin { template<typename V> V operator()(const V& a, const V& b) const { return v_min(a, b); }};
+struct VReduceMax { template<typename V> V operator()(const V& a, const V& b) const { return v_max(a, b); }};
+
+template<typename V, class VOp> static inline int
+vReduceR_( const typename V::lane_type* src, typename V::lane_type* buf, int width, const VOp& vop )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int i = 0;
+    for( ; i <= width - V::nlanes; i += V::nlanes )
+        v_store(buf + i, vop(v_load(src + i), v_load(buf + i)));
+    return i;
+}
+
+#define CV_DEF_VREDUCE_R(T, V, Op, VOp) \
+static inline int vReduceR( const T* src, T* buf, int width, const Op<T>& ) \
+{ return vReduceR_<V>(src, buf, width, VOp()); }
+
+CV_DEF_VREDUCE_R(uchar, v_uint8, OpMax, VReduceMax)
+CV_DEF_VREDUCE_R(uchar, v_uint8, OpMin, VReduceMin)
+CV_DEF_VREDUCE_R(ushort, v_uint16, OpMax, VReduceMax)
+CV_DEF_VREDUCE_R(ushort, v_uint16, OpMin, VReduceMin)
+CV_DEF_VREDUCE_R(short, v_int16, OpMax, VReduceMax)
+CV_DEF_VREDUCE_R(short, v_int16, OpMin, VReduceMin)
+CV_DEF_VREDUCE_R(float, v_float32, OpAdd, VReduceAdd)
+CV_DEF_VREDUCE_R(float, v_float32, OpMax, VReduceMax)
+CV_DEF_VREDUCE_R(float, v_float32, OpMin, VReduceMin)
+#if CV_SIMD_64F
+CV_DEF_VREDUCE_R(double, v_float64, OpAdd, VReduceAdd)
+CV_DEF_VREDUCE_R(double, v_float64, OpMax, VReduceMax)
+CV_DEF_VREDUCE_R(double, v_float64, OpMin, VReduceMin)
+#endif
+
+#undef CV_DEF_VREDUCE_R
+
+static inline int vReduceR( const uchar* src, int* buf, int width, const OpAdd<int>& )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    const int n = v_int32::nlanes;
+    int i = 0;
+    for( ; i <= width - v_uint8::nlanes; i += v_uint8::nlanes )
+    {
+        v_uint16 a0, a1;
+        v_uint32 b0, b1, b2, b3;
+        v_expand(v_load(src + i), a0, a1);
+        v_expand(a0, b0, b1);
+        v_expand(a1, b2, b3);
+        v_store(buf + i, v_load(buf + i) + v_reinterpret_as_s32(b0));
+        v_store(buf + i + n, v_load(buf + i + n) + v_reinterpret_as_s32(b1));
+        v_store(buf + i + n*2, v_load(buf + i + n*2) + v_reinterpret_as_s32(b2));
+        v_store(buf + i + n*3, v_load(buf + i + n*3) + v_reinterpret_as_s32(b3));
+    }
+    return i;
+}
+
+#endif
+
 template<typename T, typename ST, class Op> static void
 reduceR_( const Mat& srcmat, Mat& dstmat )
 {
@@ -1986,7 +2254,7 @@ reduceR_( const Mat& srcmat, Mat& dstmat )
     for( ; --size.height; )
     {
         src += srcstep;
-        i = 0;
+        i = vReduceR(src, buf, size.width, op);
         #if CV_ENABLE_UNROLLED
         for(; i <= size.width - 4; i += 4 )
         {
@@ -2051,6 +2319,28 @@ reduceC_( const Mat& srcmat, Mat& dstmat )
 
 typedef void (*ReduceFunc)( const Mat& src, Mat& dst );
 
+// the columns (dim == 0) or the rows (dim == 1) are reduced independently of each other,
+// so splitting them between the threads does not change the result
+class ReduceInvoker : public ParallelLoopBody
+{
+public:
+    ReduceInvoker( ReduceFunc _func, const Mat& _src, Mat& _dst, int _dim )
+        : func(_func), src(&_src), dst(&_dst), dim(_dim) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        Range r(range.begin(), range.end());
+        Mat dstpart = dim == 0 ? dst->colRange(r) : dst->rowRange(r);
+        func( dim == 0 ? src->colRange(r) : src->rowRange(r), dstpart );
+    }
+
+private:
+    ReduceFunc func;
+    const Mat* src;
+    Mat* dst;
+    int dim;
+};
+
 }
 
 #define reduceSumR8u32s  reduceR_<uchar, int,   OpAdd<int> >
@@ -2101,6 +2391,7 @@ typedef void (*ReduceFunc)( const Mat& src, Mat& dst );
 
 void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
 {
+    CV_TRACE_REGION("cv::reduce");
     Mat src = _src.getMat();
     CV_Assert( src.dims <= 2 );
     int op0 = op;
@@ -2237,7 +2528,9 @@ void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
         CV_Error( CV_StsUnsupportedFormat,
                   "Unsupported combination of input and output array formats" );
 
-    func( src, temp );
+    int len = dim == 0 ? src.rows : src.cols, count = dim == 0 ? src.cols : src.rows;
+    parallel_for_(BlockedRange(0, count, std::max((1 << 16)/std::max(len*cn, 1), 16)),
+                  ReduceInvoker(func, src, temp, dim));
 
     if( op0 == CV_REDUCE_AVG )
         temp.convertTo(dst, dst.type(), 1./(dim == 0 ? src.rows : src.cols));
@@ -2249,9 +2542,172 @@ void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
 namespace cv
 {
 
+// maps the 8/16/32-bit values to unsigned keys of the same width that have the same order
+template<typename T> struct RadixKey {};
+template<> struct RadixKey<uchar>
+{ typedef uchar key_type; static key_type get(uchar x) { return x; } };
+template<> struct RadixKey<schar>
+{ typedef uchar key_type; static key_type get(schar x) { return (uchar)(x ^ 0x80); } };
+template<> struct RadixKey<ushort>
+{ typedef ushort key_type; static key_type get(ushort x) { return x; } };
+template<> struct RadixKey<short>
+{ typedef ushort key_type; static key_type get(short x) { return (ushort)(x ^ 0x8000); } };
+template<> struct RadixKey<int>
+{ typedef unsigned key_type; static key_type get(int x) { return (unsigned)x ^ 0x80000000u; } };
+template<> struct RadixKey<float>
+{
+    typedef unsigned key_type;
+    static key_type get(float x)
+    {
+        Cv32suf v; v.f = x;
+        // negative numbers are ordered backwards, so all their bits are flipped
+        return (unsigned)v.i ^ (unsigned)((v.i >> 31) | (int)0x80000000);
+    }
+};
+
+// the shorter rows/columns are sorted faster by std::sort,
+// the radix sort pays off starting from RADIX_SORT_MIN_LEN elements per key byte
+enum { RADIX_SORT_MIN_LEN = 16 };
+
+template<typename KT> static bool
+radixPassOffsets( int* hist, int pass, KT firstKey, int len )
+{
+    // the pass is skipped when all the keys have the same digit
+    if( hist[(firstKey >> pass*8) & 255] == len )
+        return false;
+    for( int k = 0, sum = 0; k < 256; k++ )
+    {
+        int t = hist[k];
+        hist[k] = sum;
+        sum += t;
+    }
+    return true;
+}
+
+// LSD radix sort with 8-bit digits, all the digit histograms are computed in a single pass
+template<typename T> static void
+radixSort_( T* ptr, T* tmp, int len )
+{
+    typedef RadixKey<T> Key;
+    typedef typename Key::key_type KT;
+    const int npasses = (int)sizeof(T);
+    int hist[sizeof(T)][256];
+    int i, pass;
+
+    memset(hist, 0, sizeof(hist));
+    for( i = 0; i < len; i++ )
+    {
+        KT k = Key::get(ptr[i]);
+        for( pass = 0; pass < npasses; pass++ )
+            hist[pass][(k >> pass*8) & 255]++;
+    }
+
+    T *src = ptr, *dst = tmp;
+    for( pass = 0; pass < npasses; pass++ )
+    {
+        int* h = hist[pass];
+        if( !radixPassOffsets(h, pass, Key::get(src[0]), len) )
+            continue;
+        for( i = 0; i < len; i++ )
+        {
+            T v = src[i];
+            dst[h[(Key::get(v) >> pass*8) & 255]++] = v;
+        }
+        std::swap(src, dst);
+    }
+    if( src != ptr )
+        memcpy(ptr, src, len*sizeof(T));
+}
+
+// the same for the indices; the sort is stable, so equal elements keep their original order
+template<typename T> static void
+radixSortIdx_( const T* ptr, int* iptr, int* itmp,
+               typename RadixKey<T>::key_type* keys,
+               typename RadixKey<T>::key_type* ktmp, int len )
+{
+    typedef RadixKey<T> Key;
+    typedef typename Key::key_type KT;
+    const int npasses = (int)sizeof(T);
+    int hist[sizeof(T)][256];
+    int i, pass;
+
+    memset(hist, 0, sizeof(hist));
+    for( i = 0; i < len; i++ )
+    {
+        KT k = keys[i] = Key::get(ptr[i]);
+        iptr[i] = i;
+        for( pass = 0; pass < npasses; pass++ )
+            hist[pass][(k >> pass*8) & 255]++;
+    }
+
+    KT *ksrc = keys, *kdst = ktmp;
+    int *isrc = iptr, *idst = itmp;
+    for( pass = 0; pass < npasses; pass++ )
+    {
+        int* h = hist[pass];
+        if( !radixPassOffsets(h, pass, ksrc[0], len) )
+            continue;
+        for( i = 0; i < len; i++ )
+        {
+            KT k = ksrc[i];
+            int j = h[(k >> pass*8) & 255]++;
+            kdst[j] = k;
+            idst[j] = isrc[i];
+        }
+        std::swap(ksrc, kdst);
+        std::swap(isrc, idst);
+    }
+    if( isrc != iptr )
+        memcpy(iptr, isrc, len*sizeof(int));
+}
+
+template<typename T> static inline void sortPlain_( T* ptr, T* tmp, int len )
+{
+    if( len >= RADIX_SORT_MIN_LEN*(int)sizeof(T) )
+        radixSort_(ptr, tmp, len);
+    else
+        std::sort( ptr, ptr + len, LessThan<T>() );
+}
+
+// there is no radix sort for 64-bit values
+template<> inline void sortPlain_( double* ptr, double*, int len )
+{
+    std::sort( ptr, ptr + len, LessThan<double>() );
+}
+
+template<typename T> struct SortIdxBuf
+{
+    typedef typename RadixKey<T>::key_type KT;
+    void allocate( int len ) { itmp.allocate(len); keys.allocate(len*2); }
+    void sort( const T* ptr, int* iptr, int len )
+    {
+        if( len >= RADIX_SORT_MIN_LEN*(int)sizeof(T) )
+            radixSortIdx_(ptr, iptr, (int*)itmp, (KT*)keys, (KT*)keys + len, len);
+        else
+        {
+            for( int j = 0; j < len; j++ )
+                iptr[j] = j;
+            std::sort( iptr, iptr + len, LessThanIdx<T>(ptr) );
+        }
+    }
+    AutoBuffer<int> itmp;
+    AutoBuffer<KT> keys;
+};
+
+template<> struct SortIdxBuf<double>
+{
+    void allocate( int ) {}
+    void sort( const double* ptr, int* iptr, int len )
+    {
+        for( int j = 0; j < len; j++ )
+            iptr[j] = j;
+        std::sort( iptr, iptr + len, LessThanIdx<double>(ptr) );
+    }
+};
+
 template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
 {
-    AutoBuffer<T> buf;
+    AutoBuffer<T> buf, tmp;
     T* bptr;
     int i, j, n, len;
     bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
@@ -2266,6 +2722,7 @@ template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
         buf.allocate(len);
     }
     bptr = (T*)buf;
+    tmp.allocate(len);
 
     for( i = 0; i < n; i++ )
     {
@@ -2286,7 +2743,7 @@ template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
             for( j = 0; j < len; j++ )
                 ptr[j] = ((const T*)(src.data + src.step*j))[i];
         }
-        std::sort( ptr, ptr + len, LessThan<T>() );
+        sortPlain_( ptr, (T*)tmp, len );
         if( sortDescending )
             for( j = 0; j < len/2; j++ )
                 std::swap(ptr[j], ptr[len-1-j]);
@@ -2301,6 +2758,7 @@ template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
 {
     AutoBuffer<T> buf;
     AutoBuffer<int> ibuf;
+    SortIdxBuf<T> sbuf;
     T* bptr;
     int* _iptr;
     int i, j, n, len;
@@ -2319,6 +2777,7 @@ template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
     }
     bptr = (T*)buf;
     _iptr = (int*)ibuf;
+    sbuf.allocate(len);
 
     for( i = 0; i < n; i++ )
     {
@@ -2335,9 +2794,7 @@ template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
             for( j = 0; j < len; j++ )
                 ptr[j] = ((const T*)(src.data + src.step*j))[i];
         }
-        for( j = 0; j < len; j++ )
-            iptr[j] = j;
-        std::sort( iptr, iptr + len, LessThanIdx<T>(ptr) );
+        sbuf.sort( ptr, iptr, len );
         if( sortDescending )
             for( j = 0; j < len/2; j++ )
                 std::swap(iptr[j], iptr[len-1-j]);
@@ -2349,10 +2806,41 @@ template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
 
 typedef void (*SortFunc)(const Mat& src, Mat& dst, int flags);
 
+// the rows (or the columns) are sorted independently of each other
+class SortInvoker : public ParallelLoopBody
+{
+public:
+    SortInvoker( SortFunc _func, const Mat& _src, Mat& _dst, int _flags )
+        : func(_func), src(&_src), dst(&_dst), flags(_flags) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        Range r(range.begin(), range.end());
+        bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
+        Mat dstpart = sortRows ? dst->rowRange(r) : dst->colRange(r);
+        func( sortRows ? src->rowRange(r) : src->colRange(r), dstpart, flags );
+    }
+
+private:
+    SortFunc func;
+    const Mat* src;
+    Mat* dst;
+    int flags;
+};
+
+static void parallelSort( SortFunc func, const Mat& src, Mat& dst, int flags )
+{
+    bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
+    int n = sortRows ? src.rows : src.cols, len = sortRows ? src.cols : src.rows;
+    parallel_for_(BlockedRange(0, n, std::max((1 << 16)/std::max(len, 1), 1)),
+                  SortInvoker(func, src, dst, flags));
+}
+
 }
 
 void cv::sort( InputArray _src, OutputArray _dst, int flags )
 {
+    CV_TRACE_REGION("cv::sort");
     static SortFunc tab[] =
     {
         sort_<uchar>, sort_<schar>, sort_<ushort>, sort_<short>,
@@ -2363,11 +2851,12 @@ void cv::sort( InputArray _src, OutputArray _dst, int flags )
     CV_Assert( src.dims <= 2 && src.channels() == 1 && func != 0 );
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
-    func( src, dst, flags );
+    parallelSort( func, src, dst, flags );
 }
 
 void cv::sortIdx( InputArray _src, OutputArray _dst, int flags )
 {
+    CV_TRACE_REGION("cv::sortIdx");
     static SortFunc tab[] =
     {
         sortIdx_<uchar>, sortIdx_<schar>, sortIdx_<ushort>, sortIdx_<short>,
@@ -2382,7 +2871,7 @@ void cv::sortIdx( InputArray _src, OutputArray _dst, int flags )
         _dst.release();
     _dst.create( src.size(), CV_32S );
     dst = _dst.getMat();
-    func( src, dst, flags );
+    parallelSort( func, src, dst, flags );
 }
 
 
@@ -2400,6 +2889,40 @@ static void generateRandomCenter(const vector<Vec2f>& box, float* center, RNG& r
 }
 
 
+/* Computes the distances from every sample to the candidate center ci,
+   clipped by the distances to the already chosen centers */
+class KMeansPPDistanceComputer : public ParallelLoopBody
+{
+public:
+    KMeansPPDistanceComputer( float* _tdist2, const float* _data, const float* _dist,
+                              int _dims, size_t _step, size_t _stepci )
+        : tdist2(_tdist2), data(_data), dist(_dist), dims(_dims), step(_step), stepci(_stepci) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        const float* ci = data + stepci;
+        if( dist )
+            for( int i = range.begin(); i < range.end(); i++ )
+                tdist2[i] = std::min(normL2Sqr_(data + step*i, ci, dims), dist[i]);
+        else
+            for( int i = range.begin(); i < range.end(); i++ )
+                tdist2[i] = normL2Sqr_(data + step*i, ci, dims);
+    }
+
+private:
+    float* tdist2;
+    const float* data;
+    const float* dist;
+    int dims;
+    size_t step, stepci;
+};
+
+// the number of samples per stripe, so that each stripe computes at least ~64K products
+static inline int kmeansGrainSize( int dims, int ncenters=1 )
+{
+    return std::max(65536/std::max(dims*ncenters, 1), 1);
+}
+
 /*
 k-means center initialization using the following algorithm:
 Arthur & Vassilvitskii (2007) k-means++: The Advantages of Careful Seeding
@@ -2415,14 +2938,14 @@ static void generateCentersPP(const Mat& _data, Mat& _out_centers,
     vector<float> _dist(N*3);
     float* dist = &_dist[0], *tdist = dist + N, *tdist2 = tdist + N;
     double sum0 = 0;
+    int grain = kmeansGrainSize(dims);
 
     centers[0] = (unsigned)rng % N;
 
+    parallel_for_(BlockedRange(0, N, grain),
+                  KMeansPPDistanceComputer(dist, data, 0, dims, step, step*centers[0]));
     for( i = 0; i < N; i++ )
-    {
-        dist[i] = normL2Sqr_(data + step*i, data + step*centers[0], dims);
         sum0 += dist[i];
-    }
 
     for( k = 1; k < K; k++ )
     {
@@ -2436,11 +2959,10 @@ static void generateCentersPP(const Mat& _data, Mat& _out_centers,
                 if( (p -= dist[i]) <= 0 )
                     break;
             int ci = i;
+            parallel_for_(BlockedRange(0, N, grain),
+                          KMeansPPDistanceComputer(tdist2, data, dist, dims, step, step*ci));
             for( i = 0; i < N; i++ )
-            {
-                tdist2[i] = std::min(normL2Sqr_(data + step*i, data + step*ci, dims), dist[i]);
                 s += tdist2[i];
-            }
 
             if( s < bestSum )
             {
@@ -2463,6 +2985,218 @@ static void generateCentersPP(const Mat& _data, Mat& _out_centers,
     }
 }
 
+/*
+ Assigns every sample to the nearest center and stores the squared distance to it.
+ When the Hamerly bounds are given (lower != 0), the sample keeps its previous label
+ if the distance to the assigned center is smaller than both the lower bound of the distances
+ to the other centers (decreased by the maximal shift of the other centers) and a half of
+ the distance from the assigned center to its nearest neighbor center. Otherwise all the centers are
+ scanned, exactly as in the plain Lloyd iteration, and the lower bound is re-initialized
+ with the distance to the second nearest center.
+*/
+class KMeansDistanceComputer : public ParallelLoopBody
+{
+public:
+    KMeansDistanceComputer( double* _distances, int* _labels, const Mat& _data, const Mat& _centers,
+                            double* _lower=0, const double* _halfMinDist=0, int _maxShiftIdx=-1,
+                            double _maxShift=0, double _maxShift2=0 )
+        : distances(_distances), labels(_labels), data(&_data), centers(&_centers),
+          lower(_lower), halfMinDist(_halfMinDist), maxShiftIdx(_maxShiftIdx),
+          maxShift(_maxShift), maxShift2(_maxShift2) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        // the bounds are computed in a different order than the distances;
+        // leave some room for the rounding errors (both in the bounds and in the accumulated
+        // center shifts), so that the pruned labels are always the exact ones
+        const double bound_scale = 1. - 1e-4;
+        int K = centers->rows, dims = centers->cols;
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            const float* sample = data->ptr<float>(i);
+
+            if( halfMinDist )
+            {
+                int k = labels[i];
+                double d = normL2Sqr_(sample, centers->ptr<float>(k), dims);
+                double l = lower[i]*bound_scale - (k == maxShiftIdx ? maxShift2 : maxShift)*(2. - bound_scale);
+                double u = std::sqrt(d);
+                lower[i] = l;
+                if( u < std::max(halfMinDist[k], l)*bound_scale )
+                {
+                    distances[i] = d;
+                    continue;
+                }
+            }
+
+            int k_best = 0;
+            double min_dist = DBL_MAX, min_dist2 = DBL_MAX;
+
+            for( int k = 0; k < K; k++ )
+            {
+                double dist = normL2Sqr_(sample, centers->ptr<float>(k), dims);
+
+                if( min_dist > dist )
+                {
+                    min_dist2 = min_dist;
+                    min_dist = dist;
+                    k_best = k;
+                }
+                else if( min_dist2 > dist )
+                    min_dist2 = dist;
+            }
+
+            distances[i] = min_dist;
+            labels[i] = k_best;
+            if( lower )
+                lower[i] = std::sqrt(min_dist2);
+        }
+    }
+
+private:
+    double* distances;
+    int* labels;
+    const Mat* data;
+    const Mat* centers;
+    double* lower;
+    const double* halfMinDist;
+    int maxShiftIdx;
+    double maxShift, maxShift2;
+};
+
+/* Computes a half of the distance from every center to the nearest other center */
+class KMeansCenterSeparationComputer : public ParallelLoopBody
+{
+public:
+    KMeansCenterSeparationComputer( double* _halfMinDist, const Mat& _centers )
+        : halfMinDist(_halfMinDist), centers(&_centers) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int K = centers->rows, dims = centers->cols;
+        for( int k = range.begin(); k < range.end(); k++ )
+        {
+            const float* center = centers->ptr<float>(k);
+            double min_dist = DBL_MAX;
+            for( int k1 = 0; k1 < K; k1++ )
+                if( k1 != k )
+                    min_dist = std::min(min_dist, (double)normL2Sqr_(center, centers->ptr<float>(k1), dims));
+            halfMinDist[k] = std::sqrt(min_dist)*0.5;
+        }
+    }
+
+private:
+    double* halfMinDist;
+    const Mat* centers;
+};
+
+/*
+ Accumulates the sums of the samples and the sample counts of the clusters.
+ The clusters, not the samples, are split between the threads, and every thread
+ scans all the samples in their original order, so the sums are bitwise identical
+ to the ones computed by the serial loop.
+*/
+class KMeansCentersComputer : public ParallelLoopBody
+{
+public:
+    KMeansCentersComputer( const Mat& _data, const int* _labels, Mat& _centers, int* _counters )
+        : data(&_data), labels(_labels), centers(&_centers), counters(_counters) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int k0 = range.begin(), k1 = range.end(), N = data->rows, dims = data->cols;
+
+        for( int k = k0; k < k1; k++ )
+        {
+            float* center = centers->ptr<float>(k);
+            for( int j = 0; j < dims; j++ )
+                center[j] = 0.f;
+            counters[k] = 0;
+        }
+
+        for( int i = 0; i < N; i++ )
+        {
+            int k = labels[i];
+            if( k < k0 || k >= k1 )
+                continue;
+            const float* sample = data->ptr<float>(i);
+            float* center = centers->ptr<float>(k);
+            int j = 0;
+            #if CV_ENABLE_UNROLLED
+            for(; j <= dims - 4; j += 4 )
+            {
+                float t0 = center[j] + sample[j];
+                float t1 = center[j+1] + sample[j+1];
+
+                center[j] = t0;
+                center[j+1] = t1;
+
+                t0 = center[j+2] + sample[j+2];
+                t1 = center[j+3] + sample[j+3];
+
+                center[j+2] = t0;
+                center[j+3] = t1;
+            }
+            #endif
+            for( ; j < dims; j++ )
+                center[j] += sample[j];
+            counters[k]++;
+        }
+    }
+
+private:
+    const Mat* data;
+    const int* labels;
+    Mat* centers;
+    int* counters;
+};
+
+/*
+ Mini-batch k-means (D. Sculley, Web-Scale K-Means Clustering, 2010): on every iteration a random
+ batch of samples is assigned to the nearest centers, and then each center is moved towards its
+ batch samples with the per-center learning rate 1/(number of samples assigned to it so far).
+*/
+static void kmeansMiniBatch( const Mat& data, Mat& centers, Mat& old_centers,
+                             const TermCriteria& criteria, RNG& rng )
+{
+    int N = data.rows, K = centers.rows, dims = centers.cols;
+    int batchSize = std::min(N, std::max(1024, K*4));
+    Mat batch(batchSize, dims, CV_32F);
+    vector<int> counts(K, 0), batchLabels(batchSize);
+    vector<double> batchDist(batchSize);
+
+    for( int iter = 0; iter < criteria.maxCount; iter++ )
+    {
+        for( int i = 0; i < batchSize; i++ )
+        {
+            const float* src = data.ptr<float>(rng.uniform(0, N));
+            std::copy(src, src + dims, batch.ptr<float>(i));
+        }
+
+        parallel_for_(BlockedRange(0, batchSize, kmeansGrainSize(dims, K)),
+                      KMeansDistanceComputer(&batchDist[0], &batchLabels[0], batch, centers));
+
+        centers.copyTo(old_centers);
+        for( int i = 0; i < batchSize; i++ )
+        {
+            int k = batchLabels[i];
+            float* center = centers.ptr<float>(k);
+            const float* sample = batch.ptr<float>(i);
+            float eta = 1.f/++counts[k];
+            for( int j = 0; j < dims; j++ )
+                center[j] += (sample[j] - center[j])*eta;
+        }
+
+        double max_center_shift = 0;
+        for( int k = 0; k < K; k++ )
+            max_center_shift = std::max(max_center_shift,
+                (double)normL2Sqr_(centers.ptr<float>(k), old_centers.ptr<float>(k), dims));
+        if( iter > 0 && max_center_shift <= criteria.epsilon )
+            break;
+    }
+}
+
 }
 
 double cv::kmeans( InputArray _data, int K,
@@ -2470,17 +3204,21 @@ double cv::kmeans( InputArray _data, int K,
                    TermCriteria criteria, int attempts,
                    int flags, OutputArray _centers )
 {
+    CV_TRACE_REGION("cv::kmeans");
     const int SPP_TRIALS = 3;
-    Mat data = _data.getMat();
-    bool isrow = data.rows == 1 && data.channels() > 1;
-    int N = !isrow ? data.rows : data.cols;
-    int dims = (!isrow ? data.cols : 1)*data.channels();
-    int type = data.depth();
+    Mat data0 = _data.getMat();
+    bool isrow = data0.rows == 1 && data0.channels() > 1;
+    int N = !isrow ? data0.rows : data0.cols;
+    int dims = (!isrow ? data0.cols : 1)*data0.channels();
+    int type = data0.depth();
 
     attempts = std::max(attempts, 1);
-    CV_Assert( data.dims <= 2 && type == CV_32F && K > 0 );
+    CV_Assert( data0.dims <= 2 && type == CV_32F && K > 0 );
     CV_Assert( N >= K );
 
+    // the samples as a N x dims matrix, one sample per row
+    Mat data(N, dims, CV_32F, data0.data, isrow ? dims*sizeof(float) : data0.step[0]);
+
     _bestLabels.create(N, 1, CV_32S, -1, true);
 
     Mat _labels, best_labels = _bestLabels.getMat();
@@ -2507,10 +3245,21 @@ double cv::kmeans( InputArray _data, int K,
     vector<int> counters(K);
     vector<Vec2f> _box(dims);
     Vec2f* box = &_box[0];
+    vector<double> distances(N);
+
+    bool use_bounds = (flags & KMEANS_HAMERLY) != 0 && K > 1;
+    vector<double> lower, halfMinDist, shifts;
+    if( use_bounds )
+    {
+        lower.resize(N);
+        halfMinDist.resize(K);
+        shifts.resize(K);
+    }
 
     double best_compactness = DBL_MAX, compactness = 0;
     RNG& rng = theRNG();
     int a, iter, i, j, k;
+    int grain = kmeansGrainSize(dims, K);
 
     if( criteria.type & TermCriteria::EPS )
         criteria.epsilon = std::max(criteria.epsilon, 0.);
@@ -2547,6 +3296,7 @@ double cv::kmeans( InputArray _data, int K,
     for( a = 0; a < attempts; a++ )
     {
         double max_center_shift = DBL_MAX;
+        bool bounds_valid = false;
         for( iter = 0;; )
         {
             swap(centers, old_centers);
@@ -2570,36 +3320,8 @@ double cv::kmeans( InputArray _data, int K,
                 }
 
                 // compute centers
-                centers = Scalar(0);
-                for( k = 0; k < K; k++ )
-                    counters[k] = 0;
-
-                for( i = 0; i < N; i++ )
-                {
-                    sample = data.ptr<float>(i);
-                    k = labels[i];
-                    float* center = centers.ptr<float>(k);
-                    j=0;
-                    #if CV_ENABLE_UNROLLED
-                    for(; j <= dims - 4; j += 4 )
-                    {
-                        float t0 = center[j] + sample[j];
-                        float t1 = center[j+1] + sample[j+1];
-
-                        center[j] = t0;
-                        center[j+1] = t1;
-
-                        t0 = center[j+2] + sample[j+2];
-                        t1 = center[j+3] + sample[j+3];
-
-                        center[j+2] = t0;
-                        center[j+3] = t1;
-                    }
-                    #endif
-                    for( ; j < dims; j++ )
-                        center[j] += sample[j];
-                    counters[k]++;
-                }
+                parallel_for_(BlockedRange(0, K),
+                              KMeansCentersComputer(data, labels, centers, &counters[0]));
 
                 if( iter > 0 )
                     max_center_shift = 0;
@@ -2646,6 +3368,8 @@ double cv::kmeans( InputArray _data, int K,
                     counters[max_k]--;
                     counters[k]++;
                     labels[farthest_i] = k;
+                    if( use_bounds )
+                        lower[farthest_i] = 0; // nothing is known about the other centers any more
                     sample = data.ptr<float>(farthest_i);
 
                     for( j = 0; j < dims; j++ )
@@ -2674,36 +3398,59 @@ double cv::kmeans( InputArray _data, int K,
                             dist += t*t;
                         }
                         max_center_shift = std::max(max_center_shift, dist);
+                        if( use_bounds )
+                            shifts[k] = std::sqrt(dist);
                     }
                 }
             }
 
-            if( ++iter == MAX(criteria.maxCount, 2) || max_center_shift <= criteria.epsilon )
+            if( flags & KMEANS_MINI_BATCH )
+            {
+                kmeansMiniBatch(data, centers, old_centers, criteria, rng);
+            }
+            else if( ++iter == MAX(criteria.maxCount, 2) || max_center_shift <= criteria.epsilon )
                 break;
 
             // assign labels
-            compactness = 0;
-            for( i = 0; i < N; i++ )
+            if( use_bounds && bounds_valid )
             {
-                sample = data.ptr<float>(i);
-                int k_best = 0;
-                double min_dist = DBL_MAX;
-
+                // the lower bounds are decreased by the largest shift of the centers
+                // other than the assigned one, hence the two largest shifts are needed
+                int maxShiftIdx = 0;
+                double maxShift = 0, maxShift2 = 0;
                 for( k = 0; k < K; k++ )
                 {
-                    const float* center = centers.ptr<float>(k);
-                    double dist = normL2Sqr_(sample, center, dims);
-
-                    if( min_dist > dist )
+                    if( shifts[k] > maxShift )
                     {
-                        min_dist = dist;
-                        k_best = k;
+                        maxShift2 = maxShift;
+                        maxShift = shifts[k];
+                        maxShiftIdx = k;
                     }
+                    else
+                        maxShift2 = std::max(maxShift2, shifts[k]);
                 }
 
-                compactness += min_dist;
-                labels[i] = k_best;
+                parallel_for_(BlockedRange(0, K, kmeansGrainSize(dims, K)),
+                              KMeansCenterSeparationComputer(&halfMinDist[0], centers));
+                parallel_for_(BlockedRange(0, N, grain),
+                              KMeansDistanceComputer(&distances[0], labels, data, centers, &lower[0],
+                                                     &halfMinDist[0], maxShiftIdx, maxShift, maxShift2));
+            }
+            else
+            {
+                parallel_for_(BlockedRange(0, N, grain),
+                              KMeansDistanceComputer(&distances[0], labels, data, centers,
+                                                     use_bounds ? &lower[0] : 0));
+                bounds_valid = use_bounds;
             }
+
+            // the compactness is summed up in the sample order to make it independent of the number of threads
+            compactness = 0;
+            for( i = 0; i < N; i++ )
+                compactness += distances[i];
+
+            if( flags & KMEANS_MINI_BATCH )
+                break;
         }
 
         if( compactness < best_compactness )
@@ -3354,6 +4101,26 @@ static ConvertScaleData getConvertScaleData(int fromType, int toType)
 
 enum { HASH_SIZE0 = 8 };
 
+// Hdr::hashtab is an open-addressing table with linear probing. An entry holds the offset
+// of the node in the pool, 0 if the entry is empty and HASH_DELETED if the node has been
+// erased; the offsets are multiples of nodeSize, and the node 0 is never used.
+// The erased entries are kept until the next rehashing, so erase() does not move any node
+// or entry and the iterators and the pointers to the other elements stay valid.
+static const size_t HASH_DELETED = 1;
+
+// the hash values are mixed before taking the lowest bits; otherwise the neighbour elements,
+// which have consecutive hash values, would form long runs of occupied entries
+static inline size_t hashEntryIdx(size_t hashval, size_t hmask)
+{
+    return (size_t)(((uint64)hashval*CV_BIG_UINT(0x9E3779B97F4A7C15)) >> 32) & hmask;
+}
+
+// the number of erased hash table entries is kept in the unused node 0
+static inline size_t& hashDeletedCount(SparseMat::Hdr& hdr)
+{
+    return ((SparseMat::Node*)&hdr.pool[0])->next;
+}
+
 static inline void copyElem(const uchar* from, uchar* to, size_t elemSize)
 {
     size_t i;
@@ -3486,15 +4253,11 @@ void SparseMat::copyTo( SparseMat& m ) const
         return;
     }
     m.create( hdr->dims, hdr->size, type() );
-    SparseMatConstIterator from = begin();
-    size_t i, N = nzcount(), esz = elemSize();
-
-    for( i = 0; i < N; i++, ++from )
-    {
-        const Node* n = from.node();
-        uchar* to = m.newNode(n->idx, n->hashval);
-        copyElem( from.ptr, to, esz );
-    }
+    // the node storage, including the free list, and the hash table are copied as they are
+    m.hdr->pool = hdr->pool;
+    m.hdr->hashtab = hdr->hashtab;
+    m.hdr->nodeCount = hdr->nodeCount;
+    m.hdr->freeList = hdr->freeList;
 }
 
 void SparseMat::copyTo( Mat& m ) const
@@ -3530,7 +4293,10 @@ void SparseMat::convertTo( SparseMat& m, int rtype, double alpha ) const
 
     CV_Assert(hdr != 0);
     if( hdr != m.hdr )
+    {
         m.create( hdr->dims, hdr->size, rtype );
+        m.reserve( nzcount() );
+    }
 
     SparseMatConstIterator from = begin();
     size_t i, N = nzcount();
@@ -3622,14 +4388,18 @@ uchar* SparseMat::ptr(int i0, bool createMissing, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 1 );
     size_t h = hashval ? *hashval : hash(i0);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h && elem->idx[0] == i0 )
+        if( elem->hashval != h )
+            continue;
+        if( elem->idx[0] == i0 )
             return &value<uchar>(elem);
-        nidx = elem->next;
     }
 
     if( createMissing )
@@ -3644,14 +4414,18 @@ uchar* SparseMat::ptr(int i0, int i1, bool createMissing, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 2 );
     size_t h = hashval ? *hashval : hash(i0, i1);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h && elem->idx[0] == i0 && elem->idx[1] == i1 )
+        if( elem->hashval != h )
+            continue;
+        if( elem->idx[0] == i0 && elem->idx[1] == i1 )
             return &value<uchar>(elem);
-        nidx = elem->next;
     }
 
     if( createMissing )
@@ -3666,15 +4440,18 @@ uchar* SparseMat::ptr(int i0, int i1, int i2, bool createMissing, size_t* hashva
 {
     CV_Assert( hdr && hdr->dims == 3 );
     size_t h = hashval ? *hashval : hash(i0, i1, i2);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h && elem->idx[0] == i0 &&
-            elem->idx[1] == i1 && elem->idx[2] == i2 )
+        if( elem->hashval != h )
+            continue;
+        if( elem->idx[0] == i0 && elem->idx[1] == i1 && elem->idx[2] == i2 )
             return &value<uchar>(elem);
-        nidx = elem->next;
     }
 
     if( createMissing )
@@ -3690,20 +4467,21 @@ uchar* SparseMat::ptr(const int* idx, bool createMissing, size_t* hashval)
     CV_Assert( hdr );
     int i, d = hdr->dims;
     size_t h = hashval ? *hashval : hash(idx);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h )
-        {
-            for( i = 0; i < d; i++ )
-                if( elem->idx[i] != idx[i] )
-                    break;
-            if( i == d )
-                return &value<uchar>(elem);
-        }
-        nidx = elem->next;
+        if( elem->hashval != h )
+            continue;
+        for( i = 0; i < d; i++ )
+            if( elem->idx[i] != idx[i] )
+                break;
+        if( i == d )
+            return &value<uchar>(elem);
     }
 
     return createMissing ? newNode(idx, h) : 0;
@@ -3713,39 +4491,44 @@ void SparseMat::erase(int i0, int i1, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 2 );
     size_t h = hashval ? *hashval : hash(i0, i1);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx], previdx=0;
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h && elem->idx[0] == i0 && elem->idx[1] == i1 )
-            break;
-        previdx = nidx;
-        nidx = elem->next;
+        if( elem->hashval != h )
+            continue;
+        if( elem->idx[0] == i0 && elem->idx[1] == i1 )
+        {
+            removeNode(hidx, nidx, 0);
+            return;
+        }
     }
-
-    if( nidx )
-        removeNode(hidx, nidx, previdx);
 }
 
 void SparseMat::erase(int i0, int i1, int i2, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 3 );
     size_t h = hashval ? *hashval : hash(i0, i1, i2);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx], previdx=0;
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h && elem->idx[0] == i0 &&
-            elem->idx[1] == i1 && elem->idx[2] == i2 )
-            break;
-        previdx = nidx;
-        nidx = elem->next;
+        if( elem->hashval != h )
+            continue;
+        if( elem->idx[0] == i0 && elem->idx[1] == i1 && elem->idx[2] == i2 )
+        {
+            removeNode(hidx, nidx, 0);
+            return;
+        }
     }
-
-    if( nidx )
-        removeNode(hidx, nidx, previdx);
 }
 
 void SparseMat::erase(const int* idx, size_t* hashval)
@@ -3753,88 +4536,118 @@ void SparseMat::erase(const int* idx, size_t* hashval)
     CV_Assert( hdr );
     int i, d = hdr->dims;
     size_t h = hashval ? *hashval : hash(idx);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx], previdx=0;
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashEntryIdx(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
+        if( nidx == HASH_DELETED )
+            continue;
         Node* elem = (Node*)(pool + nidx);
-        if( elem->hashval == h )
-        {
-            for( i = 0; i < d; i++ )
-                if( elem->idx[i] != idx[i] )
-                    break;
-            if( i == d )
+        if( elem->hashval != h )
+            continue;
+        for( i = 0; i < d; i++ )
+            if( elem->idx[i] != idx[i] )
                 break;
+        if( i == d )
+        {
+            removeNode(hidx, nidx, 0);
+            return;
         }
-        previdx = nidx;
-        nidx = elem->next;
     }
-
-    if( nidx )
-        removeNode(hidx, nidx, previdx);
 }
 
 void SparseMat::resizeHashTab(size_t newsize)
 {
-    newsize = std::max(newsize, (size_t)8);
+    newsize = std::max(newsize, (size_t)HASH_SIZE0);
     if((newsize & (newsize-1)) != 0)
         newsize = (size_t)1 << cvCeil(std::log((double)newsize)/CV_LOG2);
+    CV_Assert( newsize >= hdr->nodeCount*2 );
 
-    size_t i, hsize = hdr->hashtab.size();
-    vector<size_t> _newh(newsize);
+    // the erased entries are dropped
+    size_t i, hsize = hdr->hashtab.size(), hmask = newsize - 1;
+    vector<size_t> _newh(newsize, (size_t)0);
     size_t* newh = &_newh[0];
-    for( i = 0; i < newsize; i++ )
-        newh[i] = 0;
-    uchar* pool = &hdr->pool[0];
+    const size_t* htab = &hdr->hashtab[0];
+    const uchar* pool = &hdr->pool[0];
     for( i = 0; i < hsize; i++ )
     {
-        size_t nidx = hdr->hashtab[i];
-        while( nidx )
-        {
-            Node* elem = (Node*)(pool + nidx);
-            size_t next = elem->next;
-            size_t newhidx = elem->hashval & (newsize - 1);
-            elem->next = newh[newhidx];
-            newh[newhidx] = nidx;
-            nidx = next;
-        }
+        size_t nidx = htab[i];
+        if( nidx == 0 || nidx == HASH_DELETED )
+            continue;
+        size_t hidx = hashEntryIdx(((const Node*)(pool + nidx))->hashval, hmask);
+        while( newh[hidx] )
+            hidx = (hidx + 1) & hmask;
+        newh[hidx] = nidx;
     }
-    hdr->hashtab = _newh;
+    std::swap(hdr->hashtab, _newh);
+    hashDeletedCount(*hdr) = 0;
+}
+
+// appends the nodes [psize, newpsize) of the enlarged pool to the free list
+static void growNodePool(SparseMat::Hdr& hdr, size_t newpsize)
+{
+    size_t i, nsz = hdr.nodeSize, psize = hdr.pool.size();
+    hdr.pool.resize(newpsize);
+    uchar* pool = &hdr.pool[0];
+    for( i = psize; i < newpsize - nsz; i += nsz )
+        ((SparseMat::Node*)(pool + i))->next = i + nsz;
+    ((SparseMat::Node*)(pool + i))->next = hdr.freeList;
+    hdr.freeList = psize;
+}
+
+void SparseMat::reserve(size_t nz)
+{
+    CV_Assert( hdr );
+    if( nz*2 > hdr->hashtab.size() )
+        resizeHashTab(nz*2);
+    size_t nsz = hdr->nodeSize, psize = hdr->pool.size(), nfree = 0;
+    for( size_t nidx = hdr->freeList; nidx != 0; nidx = node(nidx)->next )
+        nfree++;
+    if( hdr->nodeCount + nfree < nz )
+        growNodePool(*hdr, psize + (nz - hdr->nodeCount - nfree)*nsz);
 }
 
 uchar* SparseMat::newNode(const int* idx, size_t hashval)
 {
-    const int HASH_MAX_FILL_FACTOR=3;
     assert(hdr);
-    size_t hsize = hdr->hashtab.size();
-    if( ++hdr->nodeCount > hsize*HASH_MAX_FILL_FACTOR )
+    size_t hsize = hdr->hashtab.size(), ndeleted = hashDeletedCount(*hdr);
+    // the table, including the erased entries, is kept at most half full, so the probe
+    // sequences are short. When most of the used entries are the erased ones, the table
+    // is just rebuilt
+    if( (hdr->nodeCount + ndeleted + 1)*2 > hsize )
     {
-        resizeHashTab(std::max(hsize*2, (size_t)8));
+        resizeHashTab((hdr->nodeCount + 1)*4 > hsize ? hsize*2 : hsize);
         hsize = hdr->hashtab.size();
     }
 
     if( !hdr->freeList )
     {
-        size_t i, nsz = hdr->nodeSize, psize = hdr->pool.size(),
-            newpsize = std::max(psize*2, 8*nsz);
-        hdr->pool.resize(newpsize);
-        uchar* pool = &hdr->pool[0];
-        hdr->freeList = std::max(psize, nsz);
-        for( i = hdr->freeList; i < newpsize - nsz; i += nsz )
-            ((Node*)(pool + i))->next = i + nsz;
-        ((Node*)(pool + i))->next = 0;
+        size_t psize = hdr->pool.size();
+        growNodePool(*hdr, std::max(psize*2, 8*hdr->nodeSize));
     }
     size_t nidx = hdr->freeList;
     Node* elem = (Node*)&hdr->pool[nidx];
     hdr->freeList = elem->next;
+    elem->next = 0;
     elem->hashval = hashval;
-    size_t hidx = hashval & (hsize - 1);
-    elem->next = hdr->hashtab[hidx];
-    hdr->hashtab[hidx] = nidx;
+    hdr->nodeCount++;
+
+    // ptr() has not found the element, so the first free or erased entry is taken
+    size_t hmask = hsize - 1, hidx = hashEntryIdx(hashval, hmask);
+    size_t* htab = &hdr->hashtab[0];
+    while( htab[hidx] > HASH_DELETED )
+        hidx = (hidx + 1) & hmask;
+    if( htab[hidx] == HASH_DELETED )
+        hashDeletedCount(*hdr)--;
+    htab[hidx] = nidx;
 
     int i, d = hdr->dims;
     for( i = 0; i < d; i++ )
         elem->idx[i] = idx[i];
+    // 1D matrices keep the zero second index, as the dense 1D matrices are 2D (Nx1)
+    if( d == 1 )
+        elem->idx[1] = 0;
     size_t esz = elemSize();
     uchar* p = &value<uchar>(elem);
     if( esz == sizeof(float) )
@@ -3848,22 +4661,79 @@ uchar* SparseMat::newNode(const int* idx, size_t hashval)
 }
 
 
-void SparseMat::removeNode(size_t hidx, size_t nidx, size_t previdx)
+// hidx is the hash table entry of the node nidx. previdx is not used
+// (it is left from the chained hash table)
+void SparseMat::removeNode(size_t hidx, size_t nidx, size_t)
 {
     Node* n = node(nidx);
-    if( previdx )
-    {
-        Node* prev = node(previdx);
-        prev->next = n->next;
-    }
-    else
-        hdr->hashtab[hidx] = n->next;
+    hdr->hashtab[hidx] = HASH_DELETED;
+    hashDeletedCount(*hdr)++;
     n->next = hdr->freeList;
     hdr->freeList = nidx;
     --hdr->nodeCount;
 }
 
 
+template<typename T> static void
+addElem_( const uchar* from, uchar* to, int cn )
+{
+    const T* src = (const T*)from;
+    T* dst = (T*)to;
+    for( int i = 0; i < cn; i++ )
+        dst[i] = saturate_cast<T>(dst[i] + src[i]);
+}
+
+typedef void (*AddElemFunc)(const uchar* from, uchar* to, int cn);
+
+void SparseMat::insert(InputArray _idx, InputArray _values, bool accumulate)
+{
+    CV_Assert( hdr );
+    Mat idx = _idx.getMat(), values = _values.getMat();
+    int d = hdr->dims, cn = channels();
+    int n = values.checkVector(cn, depth());
+    CV_Assert( n >= 0 && idx.depth() == CV_32S && idx.isContinuous() &&
+               idx.total()*idx.channels() == (size_t)n*d );
+
+    static AddElemFunc addTab[] =
+    {
+        addElem_<uchar>, addElem_<schar>, addElem_<ushort>, addElem_<short>,
+        addElem_<int>, addElem_<float>, addElem_<double>, 0
+    };
+    AddElemFunc addFunc = addTab[depth()];
+    const int* ip = (const int*)idx.data;
+    const uchar* vp = values.data;
+    size_t esz = elemSize();
+
+    for( int i = 0; i < n; i++, ip += d, vp += esz )
+    {
+        size_t h = d == 2 ? hash(ip[0], ip[1]) : hash(ip);
+        uchar* to = d == 2 ? ptr(ip[0], ip[1], true, &h) : ptr(ip, true, &h);
+        if( accumulate )
+            addFunc( vp, to, cn );
+        else
+            copyElem( vp, to, esz );
+    }
+}
+
+void SparseMat::getElems(OutputArray _idx, OutputArray _values) const
+{
+    CV_Assert( hdr );
+    int i, d = hdr->dims, N = (int)nzcount();
+    _idx.create(N, d, CV_32S);
+    _values.create(N, 1, type());
+    Mat idx = _idx.getMat(), values = _values.getMat();
+    size_t esz = elemSize();
+    SparseMatConstIterator it = begin();
+
+    for( i = 0; i < N; i++, ++it )
+    {
+        const Node* elem = it.node();
+        memcpy(idx.ptr<int>(i), elem->idx, d*sizeof(int));
+        copyElem(it.ptr, values.ptr(i), esz);
+    }
+}
+
+
 SparseMatConstIterator::SparseMatConstIterator(const SparseMat* _m)
 : m((SparseMat*)_m), hashidx(0), ptr(0)
 {
@@ -3875,7 +4745,7 @@ SparseMatConstIterator::SparseMatConstIterator(const SparseMat* _m)
     for( i = 0; i < hsize; i++ )
     {
         size_t nidx = htab[i];
-        if( nidx )
+        if( nidx > HASH_DELETED )
         {
             hashidx = i;
             ptr = &hdr.pool[nidx] + hdr.valueOffset;
@@ -3889,17 +4759,11 @@ SparseMatConstIterator& SparseMatConstIterator::operator ++()
     if( !ptr || !m || !m->hdr )
         return *this;
     SparseMat::Hdr& hdr = *m->hdr;
-    size_t next = ((const SparseMat::Node*)(ptr - hdr.valueOffset))->next;
-    if( next )
-    {
-        ptr = &hdr.pool[next] + hdr.valueOffset;
-        return *this;
-    }
     size_t i = hashidx + 1, sz = hdr.hashtab.size();
     for( ; i < sz; i++ )
     {
         size_t nidx = hdr.hashtab[i];
-        if( nidx )
+        if( nidx > HASH_DELETED )
         {
             hashidx = i;
             ptr = &hdr.pool[nidx] + hdr.valueOffset;
@@ -0,0 +1,516 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#ifdef _OPENMP
+#include "omp.h"
+#endif
+
+/*
+   The built-in parallel loop scheduler, used when OpenCV is built without TBB.
+
+   The pool consists of (getNumThreads()-1) worker threads plus the thread that called
+   cv::parallel_for. The range is split into stripes (at least range.grainsize() elements each,
+   no more than STRIPES_PER_THREAD per thread); every participating thread gets a contiguous
+   block of stripes in its own queue and takes them from the front. When its queue is empty,
+   the thread steals the stripes from the back of the other queues.
+*/
+
+namespace cv
+{
+
+// the value set by setNumThreads(); 0 means the default number of threads
+static volatile int numThreads = 0;
+
+static int defaultNumThreads()
+{
+#ifdef HAVE_TBB
+    return tbb::task_scheduler_init::default_num_threads();
+#elif defined _OPENMP
+    return omp_get_num_procs();
+#else
+    return getNumberOfCPUs();
+#endif
+}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+
+struct ThreadLocalInt
+{
+    ThreadLocalInt() { key = TlsAlloc(); CV_Assert(key != TLS_OUT_OF_INDEXES); }
+    ~ThreadLocalInt() { TlsFree(key); }
+    int get() const { return (int)(size_t)TlsGetValue(key); }
+    void set(int val) { TlsSetValue(key, (void*)(size_t)val); }
+
+    DWORD key;
+};
+
+#else
+
+struct ThreadLocalInt
+{
+    ThreadLocalInt() { int errcode = pthread_key_create(&key, 0); CV_Assert(errcode == 0); }
+    ~ThreadLocalInt() { pthread_key_delete(key); }
+    int get() const { return (int)(size_t)pthread_getspecific(key); }
+    void set(int val) { pthread_setspecific(key, (void*)(size_t)val); }
+
+    pthread_key_t key;
+};
+
+#endif
+
+// the per-thread limit, set by NumThreadsGuard; 0 means no limit
+static ThreadLocalInt& threadLimit()
+{
+    static ThreadLocalInt limit;
+    return limit;
+}
+
+// 0 outside of the parallel loops, (thread index + 1) inside
+static ThreadLocalInt& threadIndex()
+{
+    static ThreadLocalInt idx;
+    return idx;
+}
+
+void setNumThreads( int threads )
+{
+    numThreads = std::max(threads, 0);
+#ifdef HAVE_TBB
+    static tbb::task_scheduler_init tbbScheduler(tbb::task_scheduler_init::deferred);
+    if( tbbScheduler.is_active() )
+        tbbScheduler.terminate();
+    if( threads > 0 )
+        tbbScheduler.initialize(threads);
+#endif
+}
+
+int getNumThreads()
+{
+    int n = numThreads > 0 ? numThreads : defaultNumThreads();
+    int limit = threadLimit().get();
+    return limit > 0 ? std::min(n, limit) : n;
+}
+
+int getNumThreadsSetting()
+{
+    return numThreads;
+}
+
+int getThreadNum()
+{
+#ifdef _OPENMP
+    if( omp_in_parallel() )
+        return omp_get_thread_num();
+#endif
+#ifdef HAVE_TBB
+#if TBB_INTERFACE_VERSION >= 6100 && defined TBB_PREVIEW_TASK_ARENA && TBB_PREVIEW_TASK_ARENA
+    return std::max(tbb::task_arena::current_slot(), 0);
+#else
+    return 0;
+#endif
+#else
+    return std::max(threadIndex().get() - 1, 0);
+#endif
+}
+
+NumThreadsGuard::NumThreadsGuard(int nthreads)
+{
+    prevLimit = threadLimit().get();
+    int limit = std::max(nthreads, 1);
+    threadLimit().set(prevLimit > 0 ? std::min(prevLimit, limit) : limit);
+}
+
+NumThreadsGuard::~NumThreadsGuard()
+{
+    threadLimit().set(prevLimit);
+}
+
+#ifndef HAVE_TBB
+
+ParallelLoopBody::~ParallelLoopBody() {}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+
+int getParallelStripes( const BlockedRange& )
+{
+    return 1;
+}
+
+void parallel_for_( const BlockedRange& range, const ParallelLoopBody& body )
+{
+    CV_TRACE_REGION("cv::parallel_for_");
+    body(range);
+}
+
+#else
+
+enum { STRIPES_PER_THREAD = 4 };
+
+class ThreadPool
+{
+public:
+    ThreadPool();
+    ~ThreadPool();
+
+    static ThreadPool& instance();
+
+    int stripes(const BlockedRange& range) const;
+    void run(const BlockedRange& range, const ParallelLoopBody& body);
+
+protected:
+    struct StripeQueue
+    {
+        pthread_mutex_t mutex;
+        int begin, end;
+    };
+
+    struct WorkerArg
+    {
+        ThreadPool* pool;
+        int idx;
+        unsigned jobId;
+    };
+
+    void startWorkers(int n);
+    void stopWorkers();
+    static void* workerProc(void* arg);
+    void workerLoop(int idx, unsigned lastJobId);
+    void processStripes(int idx);
+    bool getStripe(int idx, int& stripe);
+    void stripeRange(int stripe, BlockedRange& r) const;
+
+    // the number of threads in the pool, including the caller thread
+    int nthreads;
+    std::vector<pthread_t> threads;
+    std::vector<WorkerArg> args;
+    std::vector<StripeQueue> queues;
+
+    // serializes the loops; the loops that can not acquire it are run serially
+    pthread_mutex_t jobMutex;
+
+    // protects the job state below
+    pthread_mutex_t mutex;
+    pthread_cond_t wakeCond, doneCond;
+    unsigned jobId;
+    bool stop;
+    int jobThreads, activeWorkers;
+
+    const ParallelLoopBody* body;
+    BlockedRange range;
+    int nstripes;
+
+    volatile bool failed;
+    Exception exc;
+};
+
+ThreadPool::ThreadPool()
+{
+    nthreads = 1;
+    pthread_mutex_init(&jobMutex, 0);
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&wakeCond, 0);
+    pthread_cond_init(&doneCond, 0);
+    jobId = 0;
+    stop = false;
+    jobThreads = activeWorkers = 0;
+    body = 0;
+    nstripes = 0;
+    failed = false;
+    // make sure the thread-local keys outlive the pool
+    threadIndex();
+    threadLimit();
+}
+
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+    pthread_cond_destroy(&doneCond);
+    pthread_cond_destroy(&wakeCond);
+    pthread_mutex_destroy(&mutex);
+    pthread_mutex_destroy(&jobMutex);
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::startWorkers(int n)
+{
+    nthreads = std::max(n, 1);
+    queues.resize(nthreads);
+    for( int i = 0; i < nthreads; i++ )
+    {
+        pthread_mutex_init(&queues[i].mutex, 0);
+        queues[i].begin = queues[i].end = 0;
+    }
+
+    // thread #0 is the caller thread
+    stop = false;
+    args.resize(nthreads);
+    threads.reserve(nthreads);
+    for( int i = 1; i < nthreads; i++ )
+    {
+        args[i].pool = this;
+        args[i].idx = i;
+        args[i].jobId = jobId;
+        pthread_t thread;
+        if( pthread_create(&thread, 0, workerProc, &args[i]) != 0 )
+        {
+            nthreads = i;
+            break;
+        }
+        threads.push_back(thread);
+    }
+}
+
+void ThreadPool::stopWorkers()
+{
+    pthread_mutex_lock(&mutex);
+    stop = true;
+    pthread_cond_broadcast(&wakeCond);
+    pthread_mutex_unlock(&mutex);
+
+    for( size_t i = 0; i < threads.size(); i++ )
+        pthread_join(threads[i], 0);
+    threads.clear();
+
+    for( size_t i = 0; i < queues.size(); i++ )
+        pthread_mutex_destroy(&queues[i].mutex);
+    queues.clear();
+    nthreads = 1;
+}
+
+int ThreadPool::stripes(const BlockedRange& r) const
+{
+    int len = r.end() - r.begin();
+    int nt = getNumThreads();
+    if( nt <= 1 || len <= 1 || threadIndex().get() > 0 )
+        return 1;
+    int grain = std::max(r.grainsize(), 1);
+    return std::max(std::min(len/grain, nt*STRIPES_PER_THREAD), 1);
+}
+
+void ThreadPool::stripeRange(int stripe, BlockedRange& r) const
+{
+    int len = range.end() - range.begin();
+    int b = range.begin() + (int)((int64)len*stripe/nstripes);
+    int e = range.begin() + (int)((int64)len*(stripe+1)/nstripes);
+    r = BlockedRange(b, e, range.grainsize());
+}
+
+void* ThreadPool::workerProc(void* arg)
+{
+    WorkerArg* warg = (WorkerArg*)arg;
+    threadIndex().set(warg->idx + 1);
+    warg->pool->workerLoop(warg->idx, warg->jobId);
+    return 0;
+}
+
+void ThreadPool::workerLoop(int idx, unsigned lastJobId)
+{
+    pthread_mutex_lock(&mutex);
+    for(;;)
+    {
+        while( !stop && jobId == lastJobId )
+            pthread_cond_wait(&wakeCond, &mutex);
+        if( stop )
+            break;
+        lastJobId = jobId;
+        if( idx >= jobThreads )
+            continue;
+        pthread_mutex_unlock(&mutex);
+
+        processStripes(idx);
+
+        pthread_mutex_lock(&mutex);
+        if( --activeWorkers == 0 )
+            pthread_cond_signal(&doneCond);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+bool ThreadPool::getStripe(int idx, int& stripe)
+{
+    // take the next stripe from the own queue ...
+    StripeQueue& q = queues[idx];
+    pthread_mutex_lock(&q.mutex);
+    bool ok = q.begin < q.end;
+    if( ok )
+        stripe = q.begin++;
+    pthread_mutex_unlock(&q.mutex);
+    if( ok )
+        return true;
+
+    // ... or steal the last one from the other threads
+    for( int k = 1; k < jobThreads; k++ )
+    {
+        StripeQueue& v = queues[(idx + k) % jobThreads];
+        pthread_mutex_lock(&v.mutex);
+        ok = v.begin < v.end;
+        if( ok )
+            stripe = --v.end;
+        pthread_mutex_unlock(&v.mutex);
+        if( ok )
+            return true;
+    }
+    return false;
+}
+
+void ThreadPool::processStripes(int idx)
+{
+    CV_TRACE_REGION("cv::parallel_for_ (stripes)");
+    int stripe = 0;
+    BlockedRange r;
+    while( !failed && getStripe(idx, stripe) )
+    {
+        stripeRange(stripe, r);
+        try
+        {
+            (*body)(r);
+        }
+        catch(const Exception& e)
+        {
+            pthread_mutex_lock(&mutex);
+            if( !failed )
+                exc = e;
+            failed = true;
+            pthread_mutex_unlock(&mutex);
+        }
+        catch(const std::exception& e)
+        {
+            pthread_mutex_lock(&mutex);
+            if( !failed )
+                exc = Exception(CV_StsError, e.what(), "cv::parallel_for", __FILE__, __LINE__);
+            failed = true;
+            pthread_mutex_unlock(&mutex);
+        }
+        catch(...)
+        {
+            pthread_mutex_lock(&mutex);
+            if( !failed )
+                exc = Exception(CV_StsError, "Unknown exception", "cv::parallel_for", __FILE__, __LINE__);
+            failed = true;
+            pthread_mutex_unlock(&mutex);
+        }
+    }
+}
+
+void ThreadPool::run(const BlockedRange& _range, const ParallelLoopBody& _body)
+{
+    int n = stripes(_range);
+    if( n <= 1 || pthread_mutex_trylock(&jobMutex) != 0 )
+    {
+        _body(_range);
+        return;
+    }
+
+    // apply the last setNumThreads() call; it is safe to do here, since the pool is idle
+    int nt = numThreads > 0 ? numThreads : defaultNumThreads();
+    if( nt != nthreads )
+    {
+        stopWorkers();
+        startWorkers(nt);
+    }
+
+    int i;
+    nt = std::min(std::min(nthreads, getNumThreads()), n);
+    for( i = 0; i < nt; i++ )
+    {
+        queues[i].begin = i*n/nt;
+        queues[i].end = (i+1)*n/nt;
+    }
+
+    pthread_mutex_lock(&mutex);
+    body = &_body;
+    range = _range;
+    nstripes = n;
+    failed = false;
+    jobThreads = nt;
+    activeWorkers = nt - 1;
+    jobId++;
+    pthread_cond_broadcast(&wakeCond);
+    pthread_mutex_unlock(&mutex);
+
+    threadIndex().set(1);
+    processStripes(0);
+    threadIndex().set(0);
+
+    pthread_mutex_lock(&mutex);
+    while( activeWorkers > 0 )
+        pthread_cond_wait(&doneCond, &mutex);
+    bool _failed = failed;
+    Exception _exc;
+    if( _failed )
+        _exc = exc;
+    body = 0;
+    pthread_mutex_unlock(&mutex);
+    pthread_mutex_unlock(&jobMutex);
+
+    if( _failed )
+        throw _exc;
+}
+
+int getParallelStripes( const BlockedRange& range )
+{
+    return ThreadPool::instance().stripes(range);
+}
+
+void parallel_for_( const BlockedRange& range, const ParallelLoopBody& body )
+{
+    CV_TRACE_REGION("cv::parallel_for_");
+    ThreadPool::instance().run(range, body);
+}
+
+#endif
+
+#endif
+
+}
+
+/* End of file. */
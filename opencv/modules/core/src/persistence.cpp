@@ -69,6 +69,14 @@
 #  include <zlib.h>
 #endif
 
+#if !defined WIN32 && !defined _WIN32 && !defined WINCE
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define CV_FS_USE_MMAP 1
+#endif
+
 /****************************************************************************************\
 *                            Common macros and type definitions                          *
 \****************************************************************************************/
@@ -270,6 +278,15 @@ typedef struct CvFileStorage
     std::deque<char>* outbuf;
 
     bool is_opened;
+
+    size_t bin_offset; // the number of bytes written to the binary storage
+    struct CvFileMapping* mapping; // the content of the binary storage opened for reading
+    int base64; // write the large raw arrays as base64 strings
+    int lazy; // the top-level values are parsed when they are accessed
+    cv::Mutex* lazy_mutex; // serializes the parsing of the lazy values and the deferred raw blocks by the concurrent lookups
+    int float16; // write the CV_32F raw arrays with half precision
+    int map_data; // the matrices read from the binary storage refer to the mapped data
+    int has_base64; // the storage being read is marked as containing the base64 strings
 }
 CvFileStorage;
 
@@ -356,6 +373,31 @@ static void icvRewind( CvFileStorage* fs )
     fs->strbufpos = 0;
 }
 
+static size_t icvTell( CvFileStorage* fs )
+{
+    if( fs->strbuf )
+        return fs->strbufpos;
+    if( fs->file )
+        return (size_t)ftell( fs->file );
+#if USE_ZLIB
+    if( fs->gzfile )
+        return (size_t)gztell( fs->gzfile );
+#endif
+    return 0;
+}
+
+static void icvSeek( CvFileStorage* fs, size_t pos )
+{
+    if( fs->strbuf )
+        fs->strbufpos = pos;
+    else if( fs->file )
+        fseek( fs->file, (long)pos, SEEK_SET );
+#if USE_ZLIB
+    else if( fs->gzfile )
+        gzseek( fs->gzfile, (z_off_t)pos, SEEK_SET );
+#endif
+}
+
 #define CV_YML_INDENT  3
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
@@ -465,6 +507,35 @@ icvFSCreateCollection( CvFileStorage* fs, int tag, CvFileNode* collection )
 }
 
 
+/* In the lazy mode (CV_STORAGE_LAZY) only the keys of the top-level maps are read when
+   the storage is opened. Each value is replaced with the placeholder node that refers to
+   its position in the file, and it is parsed when the node is looked up for the first time.
+   The placeholders are never returned by the C API: cvGetRootFileNode() parses the whole map.
+   The mode is implemented for YAML and binary files only, XML is always parsed at once */
+#define CV_FS_NODE_LAZY  (1 << 12)
+
+typedef struct CvFileLazyValue
+{
+    size_t pos; // the offset of the line (YAML) or of the value (binary)
+    int col; // the offset of the value within the line (YAML) or the record tag (binary)
+    int lineno;
+}
+CvFileLazyValue;
+
+static void
+icvFSSetLazy( CvFileStorage* fs, CvFileNode* node, size_t pos, int col )
+{
+    CvFileLazyValue* v = (CvFileLazyValue*)cvMemStorageAlloc( fs->memstorage, sizeof(*v) );
+    v->pos = pos;
+    v->col = col;
+    v->lineno = fs->lineno;
+
+    memset( node, 0, sizeof(*node) );
+    node->tag = CV_FS_NODE_LAZY | CV_NODE_NAMED;
+    node->data.str.ptr = (char*)v;
+}
+
+
 /*static void
 icvFSReleaseCollection( CvSeq* seq )
 {
@@ -544,6 +615,11 @@ icvFSFlush( CvFileStorage* fs )
     return ptr;
 }
 
+static void icvBinEndStream( CvFileStorage* fs );
+static void icvReleaseFileMapping( CvFileMapping* m );
+static void icvFSResolveLazy( CvFileStorage* fs, CvFileNode* node );
+static void icvFSResolveLazyMap( CvFileStorage* fs, const CvFileNode* node );
+static void icvFSExpandRawSeq( const CvFileNode* node );
 
 static void
 icvClose( CvFileStorage* fs, std::string* out )
@@ -563,7 +639,10 @@ icvClose( CvFileStorage* fs, std::string* out )
                 while( fs->write_stack->total > 0 )
                     cvEndWriteStruct(fs);
             }
-            icvFSFlush(fs);
+            if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                icvBinEndStream(fs);
+            else
+                icvFSFlush(fs);
             if( fs->fmt == CV_STORAGE_FORMAT_XML )
                 icvPuts( fs, "</opencv_storage>\n" );
         }
@@ -596,6 +675,8 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
         cvReleaseMemStorage( &fs->strstorage );
         cvFree( &fs->buffer_start );
         cvReleaseMemStorage( &fs->memstorage );
+        icvReleaseFileMapping( fs->mapping );
+        delete fs->lazy_mutex;
 
         if( fs->outbuf )
             delete fs->outbuf;
@@ -711,6 +792,8 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
                 if( !create_missing )
                 {
                     value = &another->value;
+                    icvFSResolveLazy( fs, value );
+                    icvFSExpandRawSeq( value );
                     return value;
                 }
                 CV_PARSE_ERROR( "Duplicated key" );
@@ -731,8 +814,9 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
 }
 
 
-CV_IMPL CvFileNode*
-cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+/* the lookup without the expansion of the deferred raw blocks, see readMappedMat() */
+static CvFileNode*
+icvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
 {
     CvFileNode* value = 0;
     int i, len, tab_size;
@@ -793,6 +877,7 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
                 memcmp( key->str.ptr, str, len ) == 0 )
             {
                 value = &another->value;
+                icvFSResolveLazy( (CvFileStorage*)fs, value );
                 return value;
             }
         }
@@ -803,7 +888,16 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
 
 
 CV_IMPL CvFileNode*
-cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
+cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+{
+    CvFileNode* value = icvGetFileNodeByName( fs, _map_node, str );
+    icvFSExpandRawSeq( value );
+    return value;
+}
+
+
+static CvFileNode*
+icvGetRootFileNode( const CvFileStorage* fs, int stream_index )
 {
     CV_CHECK_FILE_STORAGE(fs);
 
@@ -813,6 +907,16 @@ cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
     return (CvFileNode*)cvGetSeqElem( fs->roots, stream_index );
 }
 
+/* the C API may walk the map with cvStartReadSeq(), so the lazy values are parsed first */
+CV_IMPL CvFileNode*
+cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
+{
+    CvFileNode* node = icvGetRootFileNode( fs, stream_index );
+    if( node )
+        icvFSResolveLazyMap( (CvFileStorage*)fs, node );
+    return node;
+}
+
 
 /* returns the sequence element by its index */
 /*CV_IMPL CvFileNode*
@@ -889,8 +993,10 @@ icvDoubleToString( char* buf, double value )
 }
 
 
+/* digits is the number of digits after the decimal point; 8 is enough to represent
+   any float exactly, 4 is enough for the half-precision floats */
 static char*
-icvFloatToString( char* buf, float value )
+icvFloatToString( char* buf, float value, int digits=8 )
 {
     Cv32suf val;
     unsigned ieee754;
@@ -904,9 +1010,8 @@ icvFloatToString( char* buf, float value )
             sprintf( buf, "%d.", ivalue );
         else
         {
-            static const char* fmt = "%.8e";
             char* ptr = buf;
-            sprintf( buf, fmt, value );
+            sprintf( buf, "%.*e", digits, value );
             if( *ptr == '+' || *ptr == '-' )
                 ptr++;
             for( ; cv_isdigit(*ptr); ptr++ )
@@ -978,6 +1083,247 @@ static double icv_strtod( CvFileStorage* fs, char* ptr, char** endptr )
 }
 
 
+/****************************************************************************************\
+*                                  Base64-encoded raw data                               *
+\****************************************************************************************/
+
+/*
+ When the storage is opened with CV_STORAGE_BASE64, the large arrays written by cvWriteRawData
+ are stored as a series of strings "$base64$<t><data>", where <t> is the element type symbol
+ ('u', 'c', 'w', 's', 'i', 'f', 'd' or 'h') and <data> is the base64-encoded elements.
+ Such a storage is marked in its header: with the "%OPENCV:BASE64" directive in front of the YAML
+ stream and with the base64="1" attribute of the <opencv_storage> root element in XML. Only in
+ the marked streams the parsers replace the base64 strings with the decoded elements, so the
+ readers see the usual sequences of numbers; elsewhere such strings are read as is.
+*/
+
+static const char icvTypeSymbol[] = "ucwsifdr";
+
+/* the raw depth of the half-precision floats, which replace CV_32F elements in the base64 strings
+   and the raw blocks of the binary format when the storage is opened with CV_STORAGE_FLOAT16 */
+#define CV_FS_16F  8
+
+static inline int icvRawElemSize( int depth )
+{
+    return depth == CV_FS_16F ? (int)sizeof(ushort) : CV_ELEM_SIZE(depth);
+}
+
+#define CV_FS_BASE64_PREFIX      "$base64$"
+#define CV_FS_BASE64_DIRECTIVE   "%OPENCV:BASE64"
+#define CV_FS_BASE64_PREFIX_LEN  8
+#define CV_FS_BASE64_CHUNK       2304 // bytes per string, a multiple of 3 and of any element size
+#define CV_FS_BASE64_MIN_SIZE    64   // the smaller arrays are written as text
+
+static const char icvBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int
+icvBase64Encode( const uchar* src, int len, char* dst )
+{
+    int i = 0, j = 0;
+
+    for( ; i + 2 < len; i += 3, j += 4 )
+    {
+        unsigned v = (src[i] << 16) | (src[i+1] << 8) | src[i+2];
+        dst[j] = icvBase64Chars[v >> 18];
+        dst[j+1] = icvBase64Chars[(v >> 12) & 63];
+        dst[j+2] = icvBase64Chars[(v >> 6) & 63];
+        dst[j+3] = icvBase64Chars[v & 63];
+    }
+
+    if( i < len )
+    {
+        unsigned v = (src[i] << 16) | (i + 1 < len ? src[i+1] << 8 : 0);
+        dst[j] = icvBase64Chars[v >> 18];
+        dst[j+1] = icvBase64Chars[(v >> 12) & 63];
+        dst[j+2] = i + 1 < len ? icvBase64Chars[(v >> 6) & 63] : '=';
+        dst[j+3] = '=';
+        j += 4;
+    }
+
+    dst[j] = '\0';
+    return j;
+}
+
+/* the values of the base64 characters, 255 for the other ones */
+static const uchar icvBase64Values[] =
+{
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255, 255,  63,
+     52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,
+    255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+     15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255, 255,
+    255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+     41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+
+/* returns the number of decoded bytes or -1 if the string is not valid base64 */
+static int
+icvBase64Decode( const char* src, int len, uchar* dst )
+{
+    const uchar* tab = icvBase64Values;
+    int i, j = 0;
+
+    if( len % 4 != 0 )
+        return -1;
+
+    for( i = 0; i < len; i += 4 )
+    {
+        int c0 = tab[(uchar)src[i]], c1 = tab[(uchar)src[i+1]];
+        int c2 = tab[(uchar)src[i+2]], c3 = tab[(uchar)src[i+3]];
+        int pad = 0;
+
+        if( i + 4 == len )
+        {
+            pad = (src[i+3] == '=') + (src[i+2] == '=' && src[i+3] == '=');
+            if( pad > 0 )
+                c3 = 0;
+            if( pad > 1 )
+                c2 = 0;
+        }
+        if( (c0 | c1 | c2 | c3) > 63 )
+            return -1;
+
+        unsigned v = (c0 << 18) | (c1 << 12) | (c2 << 6) | c3;
+        dst[j++] = (uchar)(v >> 16);
+        if( pad < 2 )
+            dst[j++] = (uchar)(v >> 8);
+        if( pad < 1 )
+            dst[j++] = (uchar)v;
+    }
+
+    return j;
+}
+
+/* appends the numbers from the array of the specified depth to the sequence of file nodes */
+static void
+icvFSAppendRawNodes( CvSeq* seq, const uchar* data, int depth, int count )
+{
+    CvSeqWriter writer;
+    CvFileNode elem;
+    int i;
+
+    memset( &elem, 0, sizeof(elem) );
+    cvSetSeqBlockSize( seq, MIN(MAX(count, 8), 1 << 16) );
+    cvStartAppendToSeq( seq, &writer );
+
+    #define CV_FS_EXPAND_RAW( type, node_type, field )                      \
+        for( i = 0; i < count; i++, data += sizeof(type) )                  \
+        {                                                                   \
+            type val;                                                       \
+            memcpy( &val, data, sizeof(val) );                              \
+            elem.tag = node_type;                                           \
+            elem.data.field = val;                                          \
+            CV_WRITE_SEQ_ELEM( elem, writer );                              \
+        }
+
+    switch( depth )
+    {
+    case CV_FS_16F:
+        for( i = 0; i < count; i++, data += sizeof(ushort) )
+        {
+            ushort val;
+            memcpy( &val, data, sizeof(val) );
+            elem.tag = CV_NODE_REAL;
+            elem.data.f = cv::cvtHalfToFloat(val);
+            CV_WRITE_SEQ_ELEM( elem, writer );
+        }
+        break;
+    case CV_8U: CV_FS_EXPAND_RAW( uchar, CV_NODE_INT, i ); break;
+    case CV_8S: CV_FS_EXPAND_RAW( schar, CV_NODE_INT, i ); break;
+    case CV_16U: CV_FS_EXPAND_RAW( ushort, CV_NODE_INT, i ); break;
+    case CV_16S: CV_FS_EXPAND_RAW( short, CV_NODE_INT, i ); break;
+    case CV_32S: CV_FS_EXPAND_RAW( int, CV_NODE_INT, i ); break;
+    case CV_32F: CV_FS_EXPAND_RAW( float, CV_NODE_REAL, f ); break;
+    default: CV_FS_EXPAND_RAW( double, CV_NODE_REAL, f ); break;
+    }
+
+    #undef CV_FS_EXPAND_RAW
+
+    cvEndWriteSeq( &writer );
+    cvSetSeqBlockSize( seq, 8 );
+}
+
+/* writes the raw data as base64 strings; returns false if the data should be written as text */
+static bool
+icvFSWriteBase64( CvFileStorage* fs, const char* data, int count, int elem_type )
+{
+    if( elem_type == CV_USRTYPE1 )
+        return false;
+
+    bool half = elem_type == CV_32F && fs->float16;
+    int esz = half ? (int)sizeof(ushort) : CV_ELEM_SIZE(elem_type);
+    size_t i, size = (size_t)count*esz;
+    char buf[CV_FS_BASE64_PREFIX_LEN + 1 + CV_FS_BASE64_CHUNK/3*4 + 16];
+    ushort hbuf[CV_FS_BASE64_CHUNK/sizeof(ushort)];
+
+    if( size < CV_FS_BASE64_MIN_SIZE )
+        return false;
+
+    memcpy( buf, CV_FS_BASE64_PREFIX, CV_FS_BASE64_PREFIX_LEN );
+    buf[CV_FS_BASE64_PREFIX_LEN] = half ? 'h' : icvTypeSymbol[elem_type];
+
+    for( i = 0; i < size; i += CV_FS_BASE64_CHUNK )
+    {
+        int len = (int)MIN( size - i, (size_t)CV_FS_BASE64_CHUNK );
+        const uchar* chunk = (const uchar*)data + i;
+        if( half )
+        {
+            cv::Mat src( 1, len/esz, CV_32F, (void*)(data + i*2) ), dst( 1, len/esz, CV_16S, hbuf );
+            cv::convertFp16( src, dst );
+            chunk = (const uchar*)hbuf;
+        }
+        icvBase64Encode( chunk, len, buf + CV_FS_BASE64_PREFIX_LEN + 1 );
+        fs->write_string( fs, 0, buf, 0 );
+    }
+    return true;
+}
+
+/* if the just parsed element of the sequence (or the node itself, in the case of XML)
+   is the base64 string, replaces it with the decoded numbers */
+static void
+icvFSDecodeBase64( CvFileStorage* fs, CvFileNode* node, CvFileNode* elem )
+{
+    if( !fs->has_base64 || !CV_NODE_IS_STRING(elem->tag) || elem->data.str.len <= CV_FS_BASE64_PREFIX_LEN ||
+        memcmp( elem->data.str.ptr, CV_FS_BASE64_PREFIX, CV_FS_BASE64_PREFIX_LEN ) != 0 )
+        return;
+
+    const char* str = elem->data.str.ptr + CV_FS_BASE64_PREFIX_LEN;
+    int len = elem->data.str.len - CV_FS_BASE64_PREFIX_LEN - 1;
+    const char* sym = strchr( icvTypeSymbol, str[0] );
+    uchar buf[CV_FS_BASE64_CHUNK + 16];
+    int depth = str[0] == 'h' ? CV_FS_16F : sym && str[0] ? (int)(sym - icvTypeSymbol) : -1;
+
+    if( depth < 0 || depth == CV_USRTYPE1 || len > CV_FS_BASE64_CHUNK/3*4 )
+        CV_PARSE_ERROR( "Invalid base64 block header" );
+
+    int esz = icvRawElemSize(depth);
+    int size = icvBase64Decode( str + 1, len, buf );
+    if( size < 0 || size % esz != 0 )
+        CV_PARSE_ERROR( "Invalid base64 data" );
+
+    if( elem == node )
+    {
+        // XML: the first literal is stored in the node itself
+        node->tag = CV_NODE_NONE;
+        icvFSCreateCollection( fs, CV_NODE_SEQ, node );
+    }
+    else
+        cvSeqPop( node->data.seq, 0 );
+
+    icvFSAppendRawNodes( node->data.seq, buf, depth, size/esz );
+}
+
+
 /****************************************************************************************\
 *                                       YAML Parser                                      *
 \****************************************************************************************/
@@ -1279,6 +1625,8 @@ force_int:
             if( CV_NODE_IS_MAP(struct_flags) )
                 elem->tag |= CV_NODE_NAMED;
             is_simple &= !CV_NODE_IS_COLLECTION(elem->tag);
+            if( !CV_NODE_IS_MAP(struct_flags) )
+                icvFSDecodeBase64( fs, node, elem );
         }
         node->data.seq->flags |= is_simple ? CV_NODE_SEQ_SIMPLE : 0;
     }
@@ -1353,6 +1701,8 @@ force_string:
             if( CV_NODE_IS_MAP(struct_flags) )
                 elem->tag |= CV_NODE_NAMED;
             is_simple &= !CV_NODE_IS_COLLECTION(elem->tag);
+            if( !CV_NODE_IS_MAP(struct_flags) )
+                icvFSDecodeBase64( fs, node, elem );
 
             ptr = icvYMLSkipSpaces( fs, ptr, 0, INT_MAX );
             if( ptr - fs->buffer_start != indent )
@@ -1394,6 +1744,8 @@ icvYMLParse( CvFileStorage* fs )
                 if( memcmp( ptr, "%YAML:", 6 ) == 0 &&
                     memcmp( ptr, "%YAML:1.", 8 ) != 0 )
                     CV_PARSE_ERROR( "Unsupported YAML version (it must be 1.x)" );
+                if( memcmp( ptr, CV_FS_BASE64_DIRECTIVE, strlen(CV_FS_BASE64_DIRECTIVE) ) == 0 )
+                    fs->has_base64 = 1;
                 *ptr = '\0';
             }
             else if( *ptr == '-' )
@@ -1442,6 +1794,73 @@ icvYMLParse( CvFileStorage* fs )
 }
 
 
+/* the lazy mode: creates the top-level maps and the placeholders for their values;
+   returns false if the streams are not block-style maps, so the lazy mode can not be used */
+static bool
+icvYMLIndex( CvFileStorage* fs )
+{
+    int max_size = (int)(fs->buffer_end - fs->buffer_start);
+    CvFileNode* root_node = 0;
+
+    for(;;)
+    {
+        size_t pos = icvTell( fs );
+        char* ptr = icvGets( fs, fs->buffer_start, max_size );
+        if( !ptr )
+            break;
+
+        int l = (int)strlen(ptr);
+        if( l > 0 && ptr[l-1] != '\n' && ptr[l-1] != '\r' && !icvEof(fs) )
+            CV_PARSE_ERROR( "Too long string or a last string w/o newline" );
+        fs->lineno++;
+
+        if( memcmp( ptr, "---", 3 ) == 0 )
+        {
+            root_node = 0;
+            continue;
+        }
+        if( memcmp( ptr, CV_FS_BASE64_DIRECTIVE, strlen(CV_FS_BASE64_DIRECTIVE) ) == 0 )
+            fs->has_base64 = 1;
+        // the indented lines belong to the values of the top-level keys
+        if( ptr[0] == ' ' || ptr[0] == '#' || ptr[0] == '%' || !cv_isprint(ptr[0]) ||
+            memcmp( ptr, "...", 3 ) == 0 )
+            continue;
+        if( !cv_isalnum(ptr[0]) && ptr[0] != '_' )
+            return false;
+
+        if( !root_node )
+        {
+            root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+            memset( root_node, 0, sizeof(*root_node) );
+            icvFSCreateCollection( fs, CV_NODE_MAP, root_node );
+        }
+
+        CvFileNode* elem = 0;
+        ptr = icvYMLParseKey( fs, ptr, root_node, &elem );
+        icvFSSetLazy( fs, elem, pos, (int)(ptr - fs->buffer_start) );
+    }
+
+    return true;
+}
+
+
+static void
+icvYMLParseLazy( CvFileStorage* fs, const CvFileLazyValue* v, CvFileNode* node )
+{
+    int max_size = (int)(fs->buffer_end - fs->buffer_start);
+
+    icvSeek( fs, v->pos );
+    fs->lineno = v->lineno;
+    fs->dummy_eof = 0;
+    if( !icvGets( fs, fs->buffer_start, max_size ) )
+        CV_PARSE_ERROR( "Unexpected end of file" );
+
+    // the same as in the block map loop of icvYMLParseValue
+    char* ptr = icvYMLSkipSpaces( fs, fs->buffer_start + v->col, 1, INT_MAX );
+    icvYMLParseValue( fs, ptr, node, CV_NODE_MAP, 1 );
+}
+
+
 /****************************************************************************************\
 *                                       YAML Emitter                                     *
 \****************************************************************************************/
@@ -2067,6 +2486,7 @@ icvXMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
                         CV_PARSE_ERROR( "Too long string literal" );
                 }
                 elem->data.str = cvMemStorageAllocString( fs->memstorage, buf, i );
+                icvFSDecodeBase64( fs, node, elem );
             }
 
             if( !CV_NODE_IS_COLLECTION(value_type) && value_type != CV_NODE_NONE )
@@ -2284,6 +2704,8 @@ icvXMLParse( CvFileStorage* fs )
             if( tag_type != CV_XML_OPENING_TAG ||
                 strcmp(key->str.ptr,"opencv_storage") != 0 )
                 CV_PARSE_ERROR( "<opencv_storage> tag is missing" );
+            if( list && cvAttrValue( list, "base64" ) )
+                fs->has_base64 = 1;
 
             root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
             ptr = icvXMLParseValue( fs, ptr, root_node, CV_NODE_NONE );
@@ -2502,180 +2924,867 @@ icvXMLWriteScalar( CvFileStorage* fs, const char* key, const char* data, int len
         {
             ptr = icvXMLFlush(fs);
         }
-        else if( ptr > fs->buffer_start + fs->struct_indent && ptr[-1] != '>' )
-            *ptr++ = ' ';
-
-        memcpy( ptr, data, len );
-        fs->buffer = ptr + len;
+        else if( ptr > fs->buffer_start + fs->struct_indent && ptr[-1] != '>' )
+            *ptr++ = ' ';
+
+        memcpy( ptr, data, len );
+        fs->buffer = ptr + len;
+    }
+}
+
+
+static void
+icvXMLWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    char buf[128], *ptr = icv_itoa( value, buf, 10 );
+    int len = (int)strlen(ptr);
+    icvXMLWriteScalar( fs, key, ptr, len );
+}
+
+
+static void
+icvXMLWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    char buf[128];
+    int len = (int)strlen( icvDoubleToString( buf, value ));
+    icvXMLWriteScalar( fs, key, buf, len );
+}
+
+
+static void
+icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quote )
+{
+    char buf[CV_FS_MAX_LEN*6+16];
+    char* data = (char*)str;
+    int i, len;
+
+    if( !str )
+        CV_Error( CV_StsNullPtr, "Null string pointer" );
+
+    len = (int)strlen(str);
+    if( len > CV_FS_MAX_LEN )
+        CV_Error( CV_StsBadArg, "The written string is too long" );
+
+    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
+    {
+        int need_quote = quote || len == 0;
+        data = buf;
+        *data++ = '\"';
+        for( i = 0; i < len; i++ )
+        {
+            char c = str[i];
+
+            if( (uchar)c >= 128 || c == ' ' )
+            {
+                *data++ = c;
+                need_quote = 1;
+            }
+            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
+            {
+                *data++ = '&';
+                if( c == '<' )
+                {
+                    memcpy(data, "lt", 2);
+                    data += 2;
+                }
+                else if( c == '>' )
+                {
+                    memcpy(data, "gt", 2);
+                    data += 2;
+                }
+                else if( c == '&' )
+                {
+                    memcpy(data, "amp", 3);
+                    data += 3;
+                }
+                else if( c == '\'' )
+                {
+                    memcpy(data, "apos", 4);
+                    data += 4;
+                }
+                else if( c == '\"' )
+                {
+                    memcpy( data, "quot", 4);
+                    data += 4;
+                }
+                else
+                {
+                    sprintf( data, "#x%02x", (uchar)c );
+                    data += 4;
+                }
+                *data++ = ';';
+                need_quote = 1;
+            }
+            else
+                *data++ = c;
+        }
+        if( !need_quote && (cv_isdigit(str[0]) ||
+            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
+            need_quote = 1;
+
+        if( need_quote )
+            *data++ = '\"';
+        len = (int)(data - buf) - !need_quote;
+        *data++ = '\0';
+        data = buf + !need_quote;
+    }
+
+    icvXMLWriteScalar( fs, key, data, len );
+}
+
+
+static void
+icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+{
+    int len;
+    int multiline;
+    const char* eol;
+    char* ptr;
+
+    if( !comment )
+        CV_Error( CV_StsNullPtr, "Null comment" );
+
+    if( strstr(comment, "--") != 0 )
+        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
+
+    len = (int)strlen(comment);
+    eol = strchr(comment, '\n');
+    multiline = eol != 0;
+    ptr = fs->buffer;
+
+    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
+        ptr = icvXMLFlush( fs );
+    else if( ptr > fs->buffer_start + fs->struct_indent )
+        *ptr++ = ' ';
+
+    if( !multiline )
+    {
+        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
+        sprintf( ptr, "<!-- %s -->", comment );
+        len = (int)strlen(ptr);
+    }
+    else
+    {
+        strcpy( ptr, "<!--" );
+        len = 4;
+    }
+
+    fs->buffer = ptr + len;
+    ptr = icvXMLFlush(fs);
+
+    if( multiline )
+    {
+        while( comment )
+        {
+            if( eol )
+            {
+                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
+                memcpy( ptr, comment, eol - comment + 1 );
+                ptr += eol - comment;
+                comment = eol + 1;
+                eol = strchr( comment, '\n' );
+            }
+            else
+            {
+                len = (int)strlen(comment);
+                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
+                memcpy( ptr, comment, len );
+                ptr += len;
+                comment = 0;
+            }
+            fs->buffer = ptr;
+            ptr = icvXMLFlush( fs );
+        }
+        sprintf( ptr, "-->" );
+        fs->buffer = ptr + 3;
+        icvXMLFlush( fs );
+    }
+}
+
+
+/****************************************************************************************\
+*                                     Binary Format                                      *
+\****************************************************************************************/
+
+/*
+ The binary storage consists of the 16-byte header (the signature and the byte order mark)
+ and the streams, separated by CV_BIN_NEXT_STREAM. Each stream is the root collection record.
+ A record is the one-byte tag, the key (only for the elements of a map) and the value:
+
+   CV_NODE_INT             int32
+   CV_NODE_REAL            float64
+   CV_NODE_STRING          string
+   CV_NODE_SEQ/CV_NODE_MAP the type name (string), the elements, CV_BIN_END
+   CV_BIN_RAW              uint8 depth, int32 count, uint8 padding, the padding bytes, the data
+
+ The strings (as well as the keys) are stored as int32 length followed by the characters,
+ all the numbers have the native byte order. The data of the large raw blocks, written by
+ cvWriteRawData (e.g. the matrix elements), starts at a multiple of CV_BIN_ALIGN bytes
+ from the beginning of the file, so the matrices can be used directly in the mapped file.
+*/
+
+#define CV_BIN_SIGNATURE      "%OCVBIN:1.0\n"
+#define CV_BIN_SIGNATURE_LEN  12
+#define CV_BIN_HEADER_SIZE    16
+#define CV_BIN_BYTE_ORDER     0x01020304
+#define CV_BIN_ALIGN          64
+#define CV_BIN_MAX_DEPTH      256 // the nesting limit, so that a malformed file cannot exhaust the stack
+
+enum { CV_BIN_END = 32, CV_BIN_RAW = 33, CV_BIN_NEXT_STREAM = 34 };
+
+typedef struct CvFileMapping
+{
+    int refcount;
+    uchar* data;
+    size_t size;
+    bool mapped;
+}
+CvFileMapping;
+
+/* the header of the sequences, read from a binary storage */
+typedef struct CvFileRawSeq
+{
+    CvSeq seq;
+    const uchar* raw_data; // the raw block, if it is the first element of the sequence
+    int raw_depth;
+    int raw_count; // -1 if the sequence contains more than one raw block
+    int raw_pending; // the raw block has not been expanded into the file nodes yet
+    CvFileStorage* fs;
+}
+CvFileRawSeq;
+
+static CvFileMapping*
+icvMapFile( const char* filename )
+{
+    CvFileMapping* m = 0;
+#if CV_FS_USE_MMAP
+    int fd = open( filename, O_RDONLY );
+    struct stat st;
+    if( fd < 0 )
+        return 0;
+    if( fstat( fd, &st ) == 0 && st.st_size > 0 )
+    {
+        // the pages, modified via the matrices that refer to the mapping,
+        // are copied on write, so the file itself is never changed
+        void* addr = mmap( 0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        if( addr != MAP_FAILED )
+        {
+            m = new CvFileMapping;
+            m->refcount = 1;
+            m->data = (uchar*)addr;
+            m->size = (size_t)st.st_size;
+            m->mapped = true;
+        }
+    }
+    close( fd );
+    if( m )
+        return m;
+#endif
+    // no memory mapping: read the whole file
+    FILE* f = fopen( filename, "rb" );
+    if( !f )
+        return 0;
+    fseek( f, 0, SEEK_END );
+    long size = ftell( f );
+    fseek( f, 0, SEEK_SET );
+    if( size > 0 )
+    {
+        m = new CvFileMapping;
+        m->refcount = 1;
+        m->size = (size_t)size;
+        m->mapped = false;
+        m->data = (uchar*)cv::fastMalloc( m->size );
+        if( fread( m->data, 1, m->size, f ) != m->size )
+        {
+            cv::fastFree( m->data );
+            delete m;
+            m = 0;
+        }
+    }
+    fclose( f );
+    return m;
+}
+
+static void
+icvReleaseFileMapping( CvFileMapping* m )
+{
+    if( m && CV_XADD(&m->refcount, -1) == 1 )
+    {
+#if CV_FS_USE_MMAP
+        if( m->mapped )
+            munmap( m->data, m->size );
+        else
+#endif
+            cv::fastFree( m->data );
+        delete m;
+    }
+}
+
+/* returns the raw block that makes the whole sequence node, or 0 */
+static const CvFileRawSeq*
+icvGetRawSeq( const CvFileStorage* fs, const CvSeq* seq )
+{
+    if( !fs || fs->fmt != CV_STORAGE_FORMAT_BINARY || !seq ||
+        seq->header_size != (int)sizeof(CvFileRawSeq) )
+        return 0;
+    const CvFileRawSeq* rseq = (const CvFileRawSeq*)seq;
+    return rseq->raw_data && (rseq->raw_pending || rseq->raw_count == seq->total) ? rseq : 0;
+}
+
+static void
+icvFSExpandRawBlock( CvFileRawSeq* rseq )
+{
+    if( rseq->raw_pending )
+    {
+        icvFSAppendRawNodes( &rseq->seq, rseq->raw_data, rseq->raw_depth, rseq->raw_count );
+        rseq->raw_pending = 0;
+    }
+}
+
+/* creates the file nodes of the deferred raw block (see icvBinParseRaw), before the sequence
+   is accessed as a generic one; the nodes returned by the lookups are always expanded */
+static void
+icvFSExpandRawSeq( const CvFileNode* node )
+{
+    if( !node || !CV_NODE_IS_SEQ(node->tag) || !node->data.seq ||
+        node->data.seq->header_size != (int)sizeof(CvFileRawSeq) )
+        return;
+
+    CvFileRawSeq* rseq = (CvFileRawSeq*)node->data.seq;
+    if( !rseq->fs )
+        return;
+    cv::AutoLock lock(*rseq->fs->lazy_mutex);
+    icvFSExpandRawBlock( rseq );
+}
+
+template<typename _Tp> static inline _Tp icvBinLoad( const uchar* ptr )
+{
+    _Tp val;
+    memcpy( &val, ptr, sizeof(val) );
+    return val;
+}
+
+static void
+icvBinPut( CvFileStorage* fs, const void* data, size_t len )
+{
+    if( fs->outbuf )
+        std::copy( (const char*)data, (const char*)data + len, std::back_inserter(*fs->outbuf) );
+    else if( fs->file )
+    {
+        if( fwrite( data, 1, len, fs->file ) != len )
+            CV_Error( CV_StsError, "Can not write to the file storage" );
+    }
+    else
+        CV_Error( CV_StsError, "The storage is not opened" );
+    fs->bin_offset += len;
+}
+
+static void
+icvBinPutString( CvFileStorage* fs, const char* str, int len )
+{
+    icvBinPut( fs, &len, sizeof(len) );
+    if( len > 0 )
+        icvBinPut( fs, str, len );
+}
+
+/* writes the tag and the key of the next element; the root collection is started if needed */
+static void
+icvBinWriteHead( CvFileStorage* fs, int tag, const char* key )
+{
+    int struct_flags = fs->struct_flags;
+    uchar t;
+
+    if( key && key[0] == '\0' )
+        key = 0;
+
+    if( CV_NODE_IS_COLLECTION(struct_flags) )
+    {
+        if( (CV_NODE_IS_MAP(struct_flags) ^ (key != 0)) )
+            CV_Error( CV_StsBadArg, "An attempt to add element without a key to a map, "
+                                    "or add element with key to sequence" );
+    }
+    else
+    {
+        fs->is_first = 0;
+        fs->struct_flags = key ? CV_NODE_MAP : CV_NODE_SEQ;
+        t = (uchar)fs->struct_flags;
+        icvBinPut( fs, &t, 1 );
+        icvBinPutString( fs, 0, 0 );
+    }
+
+    t = (uchar)tag;
+    icvBinPut( fs, &t, 1 );
+
+    if( key )
+    {
+        int i, keylen = (int)strlen(key);
+        if( keylen > CV_FS_MAX_LEN )
+            CV_Error( CV_StsBadArg, "The key is too long" );
+        if( !cv_isalpha(key[0]) && key[0] != '_' )
+            CV_Error( CV_StsBadArg, "Key must start with a letter or _" );
+        for( i = 0; i < keylen; i++ )
+        {
+            char c = key[i];
+            if( !cv_isalnum(c) && c != '-' && c != '_' && c != ' ' )
+                CV_Error( CV_StsBadArg, "Key names may only contain alphanumeric characters [a-zA-Z0-9], '-', '_' and ' '" );
+        }
+        icvBinPutString( fs, key, keylen );
+    }
+}
+
+static void
+icvBinStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
+                        const char* type_name CV_DEFAULT(0))
+{
+    int parent_flags;
+
+    struct_flags &= CV_NODE_TYPE_MASK|CV_NODE_FLOW;
+    if( !CV_NODE_IS_COLLECTION(struct_flags))
+        CV_Error( CV_StsBadArg,
+        "Some collection type - CV_NODE_SEQ or CV_NODE_MAP, must be specified" );
+
+    icvBinWriteHead( fs, struct_flags, key );
+    icvBinPutString( fs, type_name, type_name ? (int)strlen(type_name) : 0 );
+
+    parent_flags = fs->struct_flags;
+    cvSeqPush( fs->write_stack, &parent_flags );
+    fs->struct_flags = struct_flags;
+}
+
+static void
+icvBinEndWriteStruct( CvFileStorage* fs )
+{
+    int parent_flags = 0;
+    uchar t = CV_BIN_END;
+
+    if( fs->write_stack->total == 0 )
+        CV_Error( CV_StsError, "EndWriteStruct w/o matching StartWriteStruct" );
+
+    cvSeqPop( fs->write_stack, &parent_flags );
+    icvBinPut( fs, &t, 1 );
+    fs->struct_flags = parent_flags;
+}
+
+/* closes all the structures and the root collection of the current stream */
+static void
+icvBinEndStream( CvFileStorage* fs )
+{
+    while( fs->write_stack->total > 0 )
+        icvBinEndWriteStruct(fs);
+
+    if( CV_NODE_IS_COLLECTION(fs->struct_flags) )
+    {
+        uchar t = CV_BIN_END;
+        icvBinPut( fs, &t, 1 );
+    }
+    fs->struct_flags = CV_NODE_EMPTY;
+}
+
+static void
+icvBinStartNextStream( CvFileStorage* fs )
+{
+    if( !fs->is_first )
+    {
+        uchar t = CV_BIN_NEXT_STREAM;
+        icvBinEndStream(fs);
+        icvBinPut( fs, &t, 1 );
+    }
+}
+
+static void
+icvBinWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    icvBinWriteHead( fs, CV_NODE_INT, key );
+    icvBinPut( fs, &value, sizeof(value) );
+}
+
+static void
+icvBinWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    icvBinWriteHead( fs, CV_NODE_REAL, key );
+    icvBinPut( fs, &value, sizeof(value) );
+}
+
+static void
+icvBinWriteString( CvFileStorage* fs, const char* key, const char* str, int /*quote*/ )
+{
+    icvBinWriteHead( fs, CV_NODE_STRING, key );
+    icvBinPutString( fs, str, str ? (int)strlen(str) : 0 );
+}
+
+static void
+icvBinWriteComment( CvFileStorage*, const char*, int )
+{
+    // the comments are not stored in the binary format
+}
+
+static void
+icvBinWriteRawBlock( CvFileStorage* fs, const void* data, int count, int depth )
+{
+    uchar buf[CV_BIN_ALIGN + 8];
+    size_t size = (size_t)count*icvRawElemSize(depth);
+    int pad = 0;
+
+    icvBinWriteHead( fs, CV_BIN_RAW, 0 );
+    // the small blocks are not aligned, it would only make the file larger
+    if( size >= CV_BIN_ALIGN )
+        pad = (int)((CV_BIN_ALIGN - (fs->bin_offset + 6) % CV_BIN_ALIGN) % CV_BIN_ALIGN);
+    buf[0] = (uchar)depth;
+    memcpy( buf + 1, &count, sizeof(count) );
+    buf[5] = (uchar)pad;
+    memset( buf + 6, 0, pad );
+    icvBinPut( fs, buf, 6 + pad );
+    icvBinPut( fs, data, size );
+}
+
+static void
+icvBinWriteRawData( CvFileStorage* fs, const char* data0, int len,
+                    const int* fmt_pairs, int fmt_pair_count )
+{
+    int k, offset = 0;
+
+    for(;len--;)
+    {
+        for( k = 0; k < fmt_pair_count; k++ )
+        {
+            int i, count = fmt_pairs[k*2];
+            int elem_type = fmt_pairs[k*2+1];
+            int elem_size = CV_ELEM_SIZE(elem_type);
+            const char* data;
+
+            offset = cvAlign( offset, elem_size );
+            data = data0 + offset;
+
+            if( elem_type == CV_USRTYPE1 ) /* reference */
+            {
+                for( i = 0; i < count; i++, data += sizeof(size_t) )
+                    icvBinWriteInt( fs, 0, (int)*(size_t*)data );
+            }
+            else if( elem_type == CV_32F && fs->float16 )
+            {
+                cv::AutoBuffer<ushort> hbuf(count);
+                cv::Mat src( 1, count, CV_32F, (void*)data ), dst( 1, count, CV_16S, (ushort*)hbuf );
+                cv::convertFp16( src, dst );
+                icvBinWriteRawBlock( fs, (ushort*)hbuf, count, CV_FS_16F );
+                data += count*elem_size;
+            }
+            else
+            {
+                icvBinWriteRawBlock( fs, data, count, elem_type );
+                data += count*elem_size;
+            }
+
+            offset = (int)(data - data0);
+        }
+    }
+}
+
+
+/* checks that len bytes starting from ptr are inside the storage; the remaining size is compared
+   with len before the pointer is advanced, so neither the pointer nor the size can wrap around */
+static const uchar*
+icvBinCheck( CvFileStorage* fs, const uchar* ptr, uint64 len )
+{
+    const uchar* start = fs->mapping->data;
+    const uchar* end = start + fs->mapping->size;
+    if( ptr < start || ptr > end || len > (uint64)(end - ptr) )
+        CV_PARSE_ERROR( "Unexpected end of the binary storage" );
+    return ptr;
+}
+
+/* skips the header of the raw block: depth, count, reserved byte and the alignment padding */
+static const uchar*
+icvBinRawHeader( CvFileStorage* fs, const uchar* ptr, int* depth, int* count )
+{
+    icvBinCheck( fs, ptr, 6 );
+    *depth = ptr[0];
+    *count = icvBinLoad<int>(ptr + 1);
+    if( (*depth > CV_64F && *depth != CV_FS_16F) || *count < 0 )
+        CV_PARSE_ERROR( "Invalid raw data block" );
+    icvBinCheck( fs, ptr, 6 + ptr[5] );
+    ptr += 6 + ptr[5];
+    icvBinCheck( fs, ptr, (uint64)*count*icvRawElemSize(*depth) );
+    return ptr;
+}
+
+static const uchar*
+icvBinGetString( CvFileStorage* fs, const uchar* ptr, const char** str, int* len )
+{
+    icvBinCheck( fs, ptr, sizeof(int) );
+    *len = icvBinLoad<int>(ptr);
+    ptr += sizeof(int);
+    if( *len < 0 )
+        CV_PARSE_ERROR( "Invalid string length" );
+    icvBinCheck( fs, ptr, *len );
+    *str = (const char*)ptr;
+    return ptr + *len;
+}
+
+/* appends the elements of the raw block to the sequence. With defer != 0 the block that starts
+   the sequence is not expanded into the file nodes, one per element: the matrix reader uses the
+   block directly, and icvFSExpandRawSeq() creates the nodes when they are needed */
+static const uchar*
+icvBinParseRaw( CvFileStorage* fs, const uchar* ptr, CvFileNode* seq_node, int defer )
+{
+    CvFileRawSeq* rseq = (CvFileRawSeq*)seq_node->data.seq;
+    int depth = 0, count = 0;
+
+    ptr = icvBinRawHeader( fs, ptr, &depth, &count );
+
+    if( rseq->seq.total == 0 && rseq->raw_count == 0 )
+    {
+        rseq->raw_data = ptr;
+        rseq->raw_depth = depth;
+        rseq->raw_count = count;
+        rseq->raw_pending = defer && count > 0;
+    }
+    else
+    {
+        icvFSExpandRawBlock( rseq );
+        rseq->raw_count = -1;
+    }
+
+    if( !rseq->raw_pending )
+        icvFSAppendRawNodes( &rseq->seq, ptr, depth, count );
+    return ptr + (size_t)count*icvRawElemSize(depth);
+}
+
+static const uchar*
+icvBinSkipValue( CvFileStorage* fs, const uchar* ptr, int tag, int depth )
+{
+    if( depth > CV_BIN_MAX_DEPTH )
+        CV_PARSE_ERROR( "Too deep nesting of the collections" );
+
+    switch( CV_NODE_TYPE(tag) )
+    {
+    case CV_NODE_INT:
+        return icvBinCheck( fs, ptr, sizeof(int) ) + sizeof(int);
+    case CV_NODE_REAL:
+        return icvBinCheck( fs, ptr, sizeof(double) ) + sizeof(double);
+    case CV_NODE_STRING:
+    case CV_NODE_SEQ:
+    case CV_NODE_MAP:
+        {
+        const char* str = 0;
+        int len = 0;
+        ptr = icvBinGetString( fs, ptr, &str, &len );
+        if( CV_NODE_TYPE(tag) == CV_NODE_STRING )
+            return ptr;
+
+        for(;;)
+        {
+            icvBinCheck( fs, ptr, 1 );
+            int elem_tag = *ptr++;
+            if( elem_tag == CV_BIN_END )
+                break;
+            if( elem_tag == CV_BIN_RAW )
+            {
+                int depth = 0, count = 0;
+                ptr = icvBinRawHeader( fs, ptr, &depth, &count );
+                ptr += (size_t)count*icvRawElemSize(depth);
+                continue;
+            }
+            if( CV_NODE_IS_MAP(tag) )
+                ptr = icvBinGetString( fs, ptr, &str, &len );
+            ptr = icvBinSkipValue( fs, ptr, elem_tag, depth + 1 );
+        }
+        }
+        return ptr;
+    default:
+        CV_PARSE_ERROR( "Invalid record in the binary storage" );
     }
+    return ptr;
 }
 
-
-static void
-icvXMLWriteInt( CvFileStorage* fs, const char* key, int value )
+/* parses the value of the given tag; depth is the nesting level of the value (0 for the streams),
+   lazy and defer_raw are passed to icvFSSetLazy() and icvBinParseRaw() respectively */
+static const uchar*
+icvBinParseValue( CvFileStorage* fs, const uchar* ptr, int tag, CvFileNode* node,
+                  int depth, int lazy CV_DEFAULT(0), int defer_raw CV_DEFAULT(0) )
 {
-    char buf[128], *ptr = icv_itoa( value, buf, 10 );
-    int len = (int)strlen(ptr);
-    icvXMLWriteScalar( fs, key, ptr, len );
-}
-
+    memset( node, 0, sizeof(*node) );
 
-static void
-icvXMLWriteReal( CvFileStorage* fs, const char* key, double value )
-{
-    char buf[128];
-    int len = (int)strlen( icvDoubleToString( buf, value ));
-    icvXMLWriteScalar( fs, key, buf, len );
-}
+    if( depth > CV_BIN_MAX_DEPTH )
+        CV_PARSE_ERROR( "Too deep nesting of the collections" );
 
+    if( (tag & ~(CV_NODE_TYPE_MASK|CV_NODE_FLOW)) != 0 )
+        CV_PARSE_ERROR( "Invalid record in the binary storage" );
 
-static void
-icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quote )
-{
-    char buf[CV_FS_MAX_LEN*6+16];
-    char* data = (char*)str;
-    int i, len;
+    switch( CV_NODE_TYPE(tag) )
+    {
+    case CV_NODE_INT:
+        icvBinCheck( fs, ptr, sizeof(int) );
+        node->tag = CV_NODE_INT;
+        node->data.i = icvBinLoad<int>(ptr);
+        ptr += sizeof(int);
+        break;
+    case CV_NODE_REAL:
+        icvBinCheck( fs, ptr, sizeof(double) );
+        node->tag = CV_NODE_REAL;
+        node->data.f = icvBinLoad<double>(ptr);
+        ptr += sizeof(double);
+        break;
+    case CV_NODE_STRING:
+        {
+        const char* str = 0;
+        int len = 0;
+        ptr = icvBinGetString( fs, ptr, &str, &len );
+        node->tag = CV_NODE_STRING;
+        node->data.str = cvMemStorageAllocString( fs->memstorage, str, len );
+        }
+        break;
+    case CV_NODE_SEQ:
+    case CV_NODE_MAP:
+        {
+        const char* type_name = 0;
+        int len = 0, is_map = CV_NODE_IS_MAP(tag), is_simple = 1, is_mat = 0;
 
-    if( !str )
-        CV_Error( CV_StsNullPtr, "Null string pointer" );
+        ptr = icvBinGetString( fs, ptr, &type_name, &len );
+        if( len > 0 )
+        {
+            char buf[CV_FS_MAX_LEN + 1];
+            if( len > CV_FS_MAX_LEN )
+                CV_PARSE_ERROR( "Too long type name" );
+            memcpy( buf, type_name, len );
+            buf[len] = '\0';
+            node->info = cvFindType( buf );
+            is_mat = is_map && (strcmp( buf, "opencv-matrix" ) == 0 || strcmp( buf, "opencv-nd-matrix" ) == 0);
+        }
 
-    len = (int)strlen(str);
-    if( len > CV_FS_MAX_LEN )
-        CV_Error( CV_StsBadArg, "The written string is too long" );
+        if( is_map )
+            icvFSCreateCollection( fs, CV_NODE_MAP + (node->info ? CV_NODE_USER : 0), node );
+        else
+        {
+            CvFileRawSeq* seq = (CvFileRawSeq*)cvCreateSeq( 0, sizeof(CvFileRawSeq),
+                                                sizeof(CvFileNode), fs->memstorage );
+            seq->fs = fs;
+            node->tag = CV_NODE_SEQ + (node->info ? CV_NODE_USER : 0);
+            node->data.seq = &seq->seq;
+            cvSetSeqBlockSize( node->data.seq, 8 );
+        }
 
-    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
-    {
-        int need_quote = quote || len == 0;
-        data = buf;
-        *data++ = '\"';
-        for( i = 0; i < len; i++ )
+        for(;;)
         {
-            char c = str[i];
+            CvFileNode* elem;
+            int elem_tag;
 
-            if( (uchar)c >= 128 || c == ' ' )
+            icvBinCheck( fs, ptr, 1 );
+            elem_tag = *ptr++;
+            if( elem_tag == CV_BIN_END )
+                break;
+
+            if( elem_tag == CV_BIN_RAW )
             {
-                *data++ = c;
-                need_quote = 1;
+                if( is_map )
+                    CV_PARSE_ERROR( "Raw data block inside a map" );
+                ptr = icvBinParseRaw( fs, ptr, node, defer_raw );
+                continue;
             }
-            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
+
+            int defer_elem = 0;
+            if( is_map )
             {
-                *data++ = '&';
-                if( c == '<' )
-                {
-                    memcpy(data, "lt", 2);
-                    data += 2;
-                }
-                else if( c == '>' )
-                {
-                    memcpy(data, "gt", 2);
-                    data += 2;
-                }
-                else if( c == '&' )
-                {
-                    memcpy(data, "amp", 3);
-                    data += 3;
-                }
-                else if( c == '\'' )
-                {
-                    memcpy(data, "apos", 4);
-                    data += 4;
-                }
-                else if( c == '\"' )
-                {
-                    memcpy( data, "quot", 4);
-                    data += 4;
-                }
-                else
+                const char* key = 0;
+                int keylen = 0;
+                ptr = icvBinGetString( fs, ptr, &key, &keylen );
+                if( keylen == 0 )
+                    CV_PARSE_ERROR( "An empty key" );
+                elem = cvGetFileNode( fs, node, cvGetHashedKey( fs, key, keylen, 1 ), 1 );
+                if( lazy )
                 {
-                    sprintf( data, "#x%02x", (uchar)c );
-                    data += 4;
+                    icvFSSetLazy( fs, elem, ptr - fs->mapping->data, elem_tag );
+                    ptr = icvBinSkipValue( fs, ptr, elem_tag, depth + 1 );
+                    continue;
                 }
-                *data++ = ';';
-                need_quote = 1;
+                // the matrix data is read by readMappedMat() from the raw block
+                defer_elem = is_mat && keylen == 4 && memcmp( key, "data", 4 ) == 0;
             }
             else
-                *data++ = c;
-        }
-        if( !need_quote && (cv_isdigit(str[0]) ||
-            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
-            need_quote = 1;
+            {
+                icvFSExpandRawBlock( (CvFileRawSeq*)node->data.seq );
+                elem = (CvFileNode*)cvSeqPush( node->data.seq, 0 );
+            }
 
-        if( need_quote )
-            *data++ = '\"';
-        len = (int)(data - buf) - !need_quote;
-        *data++ = '\0';
-        data = buf + !need_quote;
+            ptr = icvBinParseValue( fs, ptr, elem_tag, elem, depth + 1, 0, defer_elem );
+            if( is_map )
+                elem->tag |= CV_NODE_NAMED;
+            is_simple &= !CV_NODE_IS_COLLECTION(elem->tag);
+        }
+        node->data.seq->flags |= is_simple ? CV_NODE_SEQ_SIMPLE : 0;
+        }
+        break;
+    default:
+        CV_PARSE_ERROR( "Invalid record in the binary storage" );
     }
 
-    icvXMLWriteScalar( fs, key, data, len );
+    return ptr;
 }
 
-
 static void
-icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+icvBinParse( CvFileStorage* fs )
 {
-    int len;
-    int multiline;
-    const char* eol;
-    char* ptr;
+    const CvFileMapping* m = fs->mapping;
+    const uchar* ptr = m->data;
+    const uchar* end = m->data + m->size;
 
-    if( !comment )
-        CV_Error( CV_StsNullPtr, "Null comment" );
+    if( m->size < CV_BIN_HEADER_SIZE || memcmp( ptr, CV_BIN_SIGNATURE, CV_BIN_SIGNATURE_LEN ) != 0 )
+        CV_PARSE_ERROR( "Invalid binary storage header" );
+    if( icvBinLoad<int>(ptr + CV_BIN_SIGNATURE_LEN) != CV_BIN_BYTE_ORDER )
+        CV_PARSE_ERROR( "The binary storage has been written on a machine with different byte order" );
 
-    if( strstr(comment, "--") != 0 )
-        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
+    for( ptr += CV_BIN_HEADER_SIZE; ptr < end; )
+    {
+        int tag = *ptr++;
+        if( tag == CV_BIN_NEXT_STREAM )
+            continue;
+        if( !CV_NODE_IS_COLLECTION(tag) )
+            CV_PARSE_ERROR( "Only collections as the binary storage streams are supported" );
+        CvFileNode* root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+        ptr = icvBinParseValue( fs, ptr, tag, root_node, 0, fs->lazy );
+    }
+}
 
-    len = (int)strlen(comment);
-    eol = strchr(comment, '\n');
-    multiline = eol != 0;
-    ptr = fs->buffer;
 
-    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
-        ptr = icvXMLFlush( fs );
-    else if( ptr > fs->buffer_start + fs->struct_indent )
-        *ptr++ = ' ';
+static void
+icvFSResolveLazy( CvFileStorage* fs, CvFileNode* node )
+{
+    if( !node || !fs->lazy )
+        return;
 
-    if( !multiline )
-    {
-        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
-        sprintf( ptr, "<!-- %s -->", comment );
-        len = (int)strlen(ptr);
-    }
+    // the lookups are logically const and may come from several threads: the placeholder
+    // is checked and replaced under the lock, which also guards the file position and buffer
+    cv::AutoLock lock(*fs->lazy_mutex);
+    if( !(node->tag & CV_FS_NODE_LAZY) )
+        return;
+
+    CvFileLazyValue v = *(const CvFileLazyValue*)node->data.str.ptr;
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        icvBinParseValue( fs, fs->mapping->data + v.pos, v.col, node, 1 );
     else
-    {
-        strcpy( ptr, "<!--" );
-        len = 4;
-    }
+        icvYMLParseLazy( fs, &v, node );
+    node->tag |= CV_NODE_NAMED;
+}
 
-    fs->buffer = ptr + len;
-    ptr = icvXMLFlush(fs);
+/* resolves all the lazy elements of the map and expands the deferred raw blocks of its
+   elements, e.g. before iterating it */
+static void
+icvFSResolveLazyMap( CvFileStorage* fs, const CvFileNode* node )
+{
+    if( !fs || (!fs->lazy && fs->fmt != CV_STORAGE_FORMAT_BINARY) || !CV_NODE_IS_MAP(node->tag) )
+        return;
 
-    if( multiline )
+    CvSeqReader reader;
+    int i, total = node->data.map->total;
+    cvStartReadSeq( (CvSeq*)node->data.map, &reader, 0 );
+    for( i = 0; i < total; i++ )
     {
-        while( comment )
+        CvFileMapNode* elem = (CvFileMapNode*)reader.ptr;
+        if( CV_IS_SET_ELEM(elem) )
         {
-            if( eol )
-            {
-                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
-                memcpy( ptr, comment, eol - comment + 1 );
-                ptr += eol - comment;
-                comment = eol + 1;
-                eol = strchr( comment, '\n' );
-            }
-            else
-            {
-                len = (int)strlen(comment);
-                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
-                memcpy( ptr, comment, len );
-                ptr += len;
-                comment = 0;
-            }
-            fs->buffer = ptr;
-            ptr = icvXMLFlush( fs );
+            icvFSResolveLazy( fs, &elem->value );
+            icvFSExpandRawSeq( &elem->value );
         }
-        sprintf( ptr, "-->" );
-        fs->buffer = ptr + 3;
-        icvXMLFlush( fs );
+        CV_NEXT_SEQ_ELEM( reader.seq->elem_size, reader );
     }
 }
 
@@ -2694,6 +3803,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     bool mem = (flags & CV_STORAGE_MEMORY) != 0;
     bool write_mode = (flags & 3) != 0;
     bool isGZ = false;
+    bool isBinary = false;
     size_t fnamelen = 0;
 
     if( !filename || filename[0] == '\0' )
@@ -2708,6 +3818,9 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     if( mem && append )
         CV_Error( CV_StsBadFlag, "CV_STORAGE_APPEND and CV_STORAGE_MEMORY are not currently compatible" );
 
+    if( mem && write_mode && (flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_BINARY )
+        CV_Error( CV_StsNotImplemented, "Binary storages can not be written to memory" );
+
     fs = (CvFileStorage*)cvAlloc( sizeof(*fs) );
     memset( fs, 0, sizeof(*fs));
 
@@ -2716,6 +3829,8 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
     fs->flags = CV_FILE_STORAGE;
     fs->write_mode = write_mode;
+    fs->base64 = write_mode && (flags & CV_STORAGE_BASE64) != 0;
+    fs->float16 = write_mode && (flags & CV_STORAGE_FLOAT16) != 0;
 
     if( !mem )
     {
@@ -2736,9 +3851,19 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
                 dot_pos[3] = '\0', fnamelen--;
         }
 
+        if( write_mode )
+        {
+            int fmt = flags & CV_STORAGE_FORMAT_MASK;
+            isBinary = fmt == CV_STORAGE_FORMAT_BINARY || (fmt == CV_STORAGE_FORMAT_AUTO &&
+                    dot_pos && !isGZ && (strcmp( dot_pos, ".bin" ) == 0 || strcmp( dot_pos, ".BIN" ) == 0));
+            if( isBinary && (isGZ || append) )
+                CV_Error( CV_StsNotImplemented, "Binary storages can not be compressed or appended to" );
+        }
+
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : isBinary ? "wb" :
+                             !append ? "wt" : "a+t" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -2767,7 +3892,9 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         if( mem )
             fs->outbuf = new std::deque<char>;
 
-        if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
+        if( isBinary )
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+        else if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
         {
             const char* dot_pos = filename + fnamelen - (isGZ ? 7 : 4);
             fs->fmt = (dot_pos >= filename && (memcmp( dot_pos, ".xml", 4) == 0 ||
@@ -2811,7 +3938,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
                 }
                 else
                     icvPuts( fs, "<?xml version=\"1.0\"?>\n" );
-                icvPuts( fs, "<opencv_storage>\n" );
+                icvPuts( fs, fs->base64 ? "<opencv_storage base64=\"1\">\n" : "<opencv_storage>\n" );
             }
             else
             {
@@ -2843,10 +3970,12 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
                 icvCloseFile( fs );
                 fs->file = fopen( fs->filename, "r+t" );
                 fseek( fs->file, last_occurence, SEEK_SET );
-                // replace the last "</opencv_storage>" with " <!-- resumed -->", which has the same length
-                icvPuts( fs, " <!-- resumed -->" );
+                // replace the last "</opencv_storage>" with " <!-- resumed -->", which has the same length;
+                // the base64 data is appended as the new root element with the base64 mark
+                if( !fs->base64 )
+                    icvPuts( fs, " <!-- resumed -->" );
                 fseek( fs->file, 0, SEEK_END );
-                icvPuts( fs, "\n" );
+                icvPuts( fs, fs->base64 ? "\n<opencv_storage base64=\"1\">\n" : "\n" );
             }
             fs->start_write_struct = icvXMLStartWriteStruct;
             fs->end_write_struct = icvXMLEndWriteStruct;
@@ -2856,12 +3985,29 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
             fs->write_comment = icvXMLWriteComment;
             fs->start_next_stream = icvXMLStartNextStream;
         }
+        else if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        {
+            int byte_order = CV_BIN_BYTE_ORDER;
+            icvBinPut( fs, CV_BIN_SIGNATURE, CV_BIN_SIGNATURE_LEN );
+            icvBinPut( fs, &byte_order, sizeof(byte_order) );
+            fs->start_write_struct = icvBinStartWriteStruct;
+            fs->end_write_struct = icvBinEndWriteStruct;
+            fs->write_int = icvBinWriteInt;
+            fs->write_real = icvBinWriteReal;
+            fs->write_string = icvBinWriteString;
+            fs->write_comment = icvBinWriteComment;
+            fs->start_next_stream = icvBinStartNextStream;
+        }
         else
         {
             if( !append )
                 icvPuts( fs, "%YAML:1.0\n" );
             else
-                icvPuts( fs, "...\n---\n" );
+                icvPuts( fs, "...\n" );
+            if( fs->base64 )
+                icvPuts( fs, CV_FS_BASE64_DIRECTIVE "\n" );
+            if( append )
+                icvPuts( fs, "---\n" );
             fs->start_write_struct = icvYMLStartWriteStruct;
             fs->end_write_struct = icvYMLEndWriteStruct;
             fs->write_int = icvYMLWriteInt;
@@ -2884,7 +4030,31 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         char buf[16];
         icvGets( fs, buf, sizeof(buf)-2 );
         fs->fmt = strncmp( buf, yaml_signature, strlen(yaml_signature) ) == 0 ?
-            CV_STORAGE_FORMAT_YAML : CV_STORAGE_FORMAT_XML;
+            CV_STORAGE_FORMAT_YAML : strncmp( buf, CV_BIN_SIGNATURE, CV_BIN_SIGNATURE_LEN ) == 0 ?
+            CV_STORAGE_FORMAT_BINARY : CV_STORAGE_FORMAT_XML;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        {
+            if( mem || isGZ )
+                CV_Error( CV_StsNotImplemented, "Binary storages can only be read from uncompressed files" );
+
+            fs->str_hash = cvCreateMap( 0, sizeof(CvStringHash),
+                            sizeof(CvStringHashNode), fs->memstorage, 256 );
+            fs->roots = cvCreateSeq( 0, sizeof(CvSeq),
+                            sizeof(CvFileNode), fs->memstorage );
+
+            // the content is mapped (or read) at once; with CV_STORAGE_MAP_DATA the large
+            // raw blocks are referenced directly by the matrices, read from the storage
+            fs->mapping = icvMapFile( fs->filename );
+            if( !fs->mapping )
+                CV_Error( CV_StsError, "Can not read the binary storage" );
+            fs->lazy = (flags & CV_STORAGE_LAZY) != 0;
+            fs->lazy_mutex = new cv::Mutex;
+            fs->map_data = (flags & CV_STORAGE_MAP_DATA) != 0;
+            icvBinParse( fs );
+            fs->is_opened = true;
+            goto _exit_;
+        }
 
         if( !isGZ )
         {
@@ -2913,15 +4083,32 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         //mode = cvGetErrMode();
         //cvSetErrMode( CV_ErrModeSilent );
+        // the lazy mode is only supported for YAML files; the file is kept open
+        fs->lazy = (flags & CV_STORAGE_LAZY) != 0 && fs->fmt == CV_STORAGE_FORMAT_YAML && !mem;
+        if( fs->lazy && !icvYMLIndex( fs ) )
+        {
+            cvClearSeq( fs->roots );
+            icvRewind( fs );
+            fs->lazy = 0;
+            fs->lineno = 0;
+            fs->buffer[0] = '\n';
+            fs->buffer[1] = '\0';
+        }
+        if( fs->lazy )
+            fs->lazy_mutex = new cv::Mutex;
+
         if( fs->fmt == CV_STORAGE_FORMAT_XML )
             icvXMLParse( fs );
-        else
+        else if( !fs->lazy )
             icvYMLParse( fs );
         //cvSetErrMode( mode );
 
         // release resources that we do not need anymore
-        cvFree( &fs->buffer_start );
-        fs->buffer = fs->buffer_end = 0;
+        if( !fs->lazy )
+        {
+            cvFree( &fs->buffer_start );
+            fs->buffer = fs->buffer_end = 0;
+        }
     }
     fs->is_opened = true;
 
@@ -2932,7 +4119,7 @@ _exit_:
         {
             cvReleaseFileStorage( &fs );
         }
-        else if( !fs->write_mode )
+        else if( !fs->write_mode && !(fs->lazy && fs->fmt != CV_STORAGE_FORMAT_BINARY) )
         {
             icvCloseFile(fs);
             // we close the file since it's not needed anymore. But icvCloseFile() resets is_opened,
@@ -3003,7 +4190,6 @@ cvStartNextStream( CvFileStorage* fs )
 }
 
 
-static const char icvTypeSymbol[] = "ucwsifdr";
 #define CV_FS_MAX_FMT_PAIRS  128
 
 static char*
@@ -3137,6 +4323,16 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
         len = 1;
     }
 
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        icvBinWriteRawData( fs, data0, len, fmt_pairs, fmt_pair_count );
+        return;
+    }
+
+    if( fs->base64 && fmt_pair_count == 1 &&
+        icvFSWriteBase64( fs, data0, fmt_pairs[0], fmt_pairs[1] ) )
+        return;
+
     for(;len--;)
     {
         for( k = 0; k < fmt_pair_count; k++ )
@@ -3174,7 +4370,10 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
                     data += sizeof(int);
                     break;
                 case CV_32F:
-                    ptr = icvFloatToString( buf, *(float*)data );
+                    if( fs->float16 )
+                        ptr = icvFloatToString( buf, cv::cvtHalfToFloat(cv::cvtFloatToHalf(*(float*)data)), 4 );
+                    else
+                        ptr = icvFloatToString( buf, *(float*)data );
                     data += sizeof(float);
                     break;
                 case CV_64F:
@@ -3225,6 +4424,7 @@ cvStartReadRawData( const CvFileStorage* fs, const CvFileNode* src, CvSeqReader*
     }
     else if( node_type == CV_NODE_SEQ )
     {
+        icvFSExpandRawSeq( src );
         cvStartReadSeq( src->data.seq, reader, 0 );
     }
     else if( node_type == CV_NODE_NONE )
@@ -3254,6 +4454,33 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
 
     fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
 
+    const CvFileRawSeq* rseq = reader->seq ? icvGetRawSeq( fs, reader->seq ) : 0;
+    if( rseq && fmt_pair_count == 1 && fmt_pairs[1] != CV_USRTYPE1 && len % fmt_pairs[0] == 0 )
+    {
+        // the sequence is a single raw block of the binary storage: convert it at once
+        int pos = cvGetSeqReaderPos( reader );
+        if( pos + len <= rseq->seq.total )
+        {
+            int elem_type = fmt_pairs[1];
+            bool half = rseq->raw_depth == CV_FS_16F;
+            cv::Mat src( 1, len, half ? CV_16S : rseq->raw_depth,
+                         (void*)(rseq->raw_data + (size_t)pos*icvRawElemSize(rseq->raw_depth)) );
+            cv::Mat dst( 1, len, elem_type, data0 );
+            if( half && elem_type == CV_32F )
+                cv::convertFp16( src, dst );
+            else if( half )
+            {
+                cv::Mat temp;
+                cv::convertFp16( src, temp );
+                temp.convertTo( dst, elem_type );
+            }
+            else
+                src.convertTo( dst, elem_type );
+            cvSetSeqReaderPos( reader, len, 1 );
+            return;
+        }
+    }
+
     for(;;)
     {
         for( k = 0; k < fmt_pair_count; k++ )
@@ -3441,6 +4668,7 @@ icvWriteFileNode( CvFileStorage* fs, const char* name, const CvFileNode* node )
         break;
     case CV_NODE_SEQ:
     case CV_NODE_MAP:
+        icvFSExpandRawSeq( node );
         fs->start_write_struct( fs, name, CV_NODE_TYPE(node->tag) +
                 (CV_NODE_SEQ_IS_SIMPLE(node->data.seq) ? CV_NODE_FLOW : 0),
                 node->info ? node->info->type_name : 0 );
@@ -5209,7 +6437,8 @@ string FileStorage::releaseAndGetString()
     
 FileNode FileStorage::root(int streamidx) const
 {
-    return isOpened() ? FileNode(fs, cvGetRootFileNode(fs, streamidx)) : FileNode();
+    // FileNode resolves the lazy values itself, when they are looked up
+    return isOpened() ? FileNode(fs, icvGetRootFileNode(fs, streamidx)) : FileNode();
 }
 
 FileStorage& operator << (FileStorage& fs, const string& str)
@@ -5347,6 +6576,8 @@ FileNodeIterator::FileNodeIterator(const CvFileStorage* _fs,
         container = _node;
         if( !(_node->tag & FileNode::USER) && (node_type == FileNode::SEQ || node_type == FileNode::MAP) )
         {
+            icvFSResolveLazyMap( (CvFileStorage*)_fs, _node );
+            icvFSExpandRawSeq( _node );
             cvStartReadSeq( _node->data.seq, &reader );
             remaining = FileNode(_fs, _node).size();
         }
@@ -5515,6 +6746,106 @@ WriteStructContext::WriteStructContext(FileStorage& _fs, const string& name,
 WriteStructContext::~WriteStructContext() { cvEndWriteStruct(**fs); }
 
 
+/* the reference counter of the matrices that share data with a binary storage */
+struct MappedMatRef
+{
+    int refcount;
+    CvFileMapping* mapping;
+};
+
+class MappedStorageAllocator : public MatAllocator
+{
+public:
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            step[i] = total;
+            total *= sizes[i];
+        }
+        MappedMatRef* ref = new MappedMatRef;
+        ref->refcount = 1;
+        ref->mapping = 0;
+        datastart = data = (uchar*)fastMalloc(total);
+        refcount = &ref->refcount;
+    }
+
+    void deallocate(int* refcount, uchar* datastart, uchar*)
+    {
+        MappedMatRef* ref = (MappedMatRef*)refcount;
+        if( ref->mapping )
+            icvReleaseFileMapping(ref->mapping);
+        else
+            fastFree(datastart);
+        delete ref;
+    }
+};
+
+static MappedStorageAllocator mappedStorageAllocator;
+
+/* reads the matrix stored as a single raw block of the binary storage with one copy. If the
+   storage is opened with CV_STORAGE_MAP_DATA and the block is aligned, makes the matrix header
+   over the mapped data instead; the mapping is kept alive while the matrix is used */
+static bool readMappedMat( const FileNode& node, Mat& m )
+{
+    CvFileStorage* fs = (CvFileStorage*)node.fs;
+    const CvFileNode* cnode = *node;
+
+    if( !fs || !fs->mapping || !CV_NODE_IS_MAP(cnode->tag) || !cnode->info )
+        return false;
+
+    bool is_nd = strcmp(cnode->info->type_name, "opencv-nd-matrix") == 0;
+    if( !is_nd && strcmp(cnode->info->type_name, "opencv-matrix") != 0 )
+        return false;
+
+    FileNode data(fs, icvGetFileNodeByName(fs, cnode, "data")), dt = node["dt"];
+    const CvFileRawSeq* rseq = data.isSeq() ? icvGetRawSeq(fs, (*data)->data.seq) : 0;
+    if( !rseq || !dt.isString() )
+        return false;
+
+    int i, dims, sizes[CV_MAX_DIM], type = icvDecodeSimpleFormat(((std::string)dt).c_str());
+    if( is_nd )
+    {
+        FileNode sz = node["sizes"];
+        dims = (int)sz.size();
+        if( dims < 2 || dims > CV_MAX_DIM )
+            return false;
+        sz.readRaw("i", (uchar*)sizes, dims);
+    }
+    else
+    {
+        dims = 2;
+        sizes[0] = (int)node["rows"];
+        sizes[1] = (int)node["cols"];
+    }
+
+    size_t total = CV_MAT_CN(type);
+    for( i = 0; i < dims; i++ )
+        total *= sizes[i] > 0 ? sizes[i] : 0;
+
+    if( total == 0 || rseq->raw_depth != CV_MAT_DEPTH(type) || (size_t)rseq->raw_count != total )
+        return false;
+
+    if( !fs->map_data || (size_t)rseq->raw_data % CV_ELEM_SIZE1(type) != 0 )
+    {
+        Mat(dims, sizes, type, (void*)rseq->raw_data).copyTo(m);
+        return true;
+    }
+
+    MappedMatRef* ref = new MappedMatRef;
+    ref->refcount = 1;
+    ref->mapping = fs->mapping;
+    CV_XADD(&fs->mapping->refcount, 1);
+
+    Mat header(dims, sizes, type, (void*)rseq->raw_data);
+    header.refcount = &ref->refcount;
+    header.allocator = &mappedStorageAllocator;
+    m = header;
+    return true;
+}
+
 void read( const FileNode& node, Mat& mat, const Mat& default_mat )
 {
     if( node.empty() )
@@ -5522,6 +6853,8 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    if( readMappedMat(node, mat) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
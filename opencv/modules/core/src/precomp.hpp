@@ -50,6 +50,7 @@
 #include "opencv2/core/core.hpp"
 #include "opencv2/core/core_c.h"
 #include "opencv2/core/internal.hpp"
+#include "opencv2/core/simd.hpp"
 
 #include <assert.h>
 #include <ctype.h>
@@ -66,6 +67,14 @@
 #define GET_OPTIMIZED(func) (func)
 #endif
 
+#ifndef CV_TRY_AVX2
+#define CV_TRY_AVX2 0
+#endif
+
+#if CV_TRY_AVX2
+#include "simd_avx2.hpp"
+#endif
+
 namespace cv
 {
 
@@ -87,6 +96,7 @@ extern const uchar g_Saturate8u[];
 #if defined WIN32 || defined _WIN32
 void deleteThreadAllocData();
 void deleteThreadRNGData();
+void releaseThreadTraceBuffer();
 #endif
 
 template<typename T1, typename T2=T1, typename T3=T1> struct OpAdd
@@ -170,9 +180,58 @@ struct NoVec
 };
 
 extern volatile bool USE_SSE2;
+extern volatile bool USE_AVX2;
 
 enum { BLOCK_SIZE = 1024 };
 
+// IEEE 754 half-precision float conversions with round-to-nearest-even,
+// see F. Giesen, "Half to float done quic", 2012
+static inline ushort cvtFloatToHalf( float val )
+{
+    Cv32suf f;
+    f.f = val;
+    unsigned sign = f.u & 0x80000000u, h;
+    f.u ^= sign;
+    if( f.u >= (127u + 16) << 23 )
+        // the value is too big, Inf or NaN
+        h = f.u > 0x7f800000u ? 0x7e00 : 0x7c00;
+    else if( f.u < (127u - 14) << 23 )
+    {
+        // a subnormal half or zero; the float addition does the rounding
+        Cv32suf magic;
+        magic.u = (127u - 15 + 23 - 10 + 1) << 23;
+        f.f += magic.f;
+        h = f.u - magic.u;
+    }
+    else
+    {
+        unsigned odd = (f.u >> 13) & 1;
+        f.u += ((15u - 127) << 23) + 0xfff + odd;
+        h = f.u >> 13;
+    }
+    return (ushort)(h | (sign >> 16));
+}
+
+static inline float cvtHalfToFloat( ushort val )
+{
+    Cv32suf f;
+    f.u = (unsigned)(val & 0x7fff) << 13;
+    unsigned exp = f.u & (0x7c00u << 13);
+    f.u += (127u - 15) << 23;
+    if( exp == (0x7c00u << 13) )
+        f.u += (128u - 16) << 23; // Inf or NaN
+    else if( exp == 0 )
+    {
+        // a subnormal half or zero is renormalized
+        Cv32suf magic;
+        magic.u = (127u - 14) << 23;
+        f.u += 1 << 23;
+        f.f -= magic.f;
+    }
+    f.u |= (unsigned)(val & 0x8000) << 16;
+    return f.f;
+}
+
 #ifdef HAVE_IPP
 static inline IppiSize ippiSize(int width, int height) { IppiSize sz = { width, height}; return sz; }
 static inline IppiSize ippiSize(Size _sz)              { IppiSize sz = { _sz.width, _sz.height}; return sz; }
@@ -186,6 +245,12 @@ static inline IppiSize ippiSize(Size _sz)              { IppiSize sz = { _sz.wid
 #define IF_IPP(then_call, else_call) else_call
 #endif
 
+#if CV_TRY_AVX2
+#define CALL_AVX2(func, args) if( USE_AVX2 ) { avx2::func args; return; }
+#else
+#define CALL_AVX2(func, args)
+#endif
+
 inline bool checkScalar(const Mat& sc, int atype, int sckind, int akind)
 {
     if( sc.dims > 2 || (sc.cols != 1 && sc.rows != 1) || !sc.isContinuous() )
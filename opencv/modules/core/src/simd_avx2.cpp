@@ -0,0 +1,812 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/*
+   AVX2/FMA kernels, see simd_avx2.hpp. This file is compiled with -mavx2 -mfma
+   (/arch:AVX2 on MSVC) and must not include any OpenCV header except simd_avx2.hpp.
+
+   Every kernel processes the row tail by copying it to a temporary vector and
+   running the same vector code on it, so the results do not depend on the
+   position of an element inside the row.
+*/
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+#include <string.h>
+#include "simd_avx2.hpp"
+
+namespace cv { namespace avx2
+{
+
+typedef unsigned char uchar;
+typedef signed char schar;
+typedef unsigned short ushort;
+
+enum { VEC_BYTES = 32 };
+
+static inline __m256 combine(const __m128& lo, const __m128& hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+static inline __m256i combine(const __m128i& lo, const __m128i& hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+// the unmasked gather leaves its destination register formally uninitialized
+// (gcc reports -Wmaybe-uninitialized), so use the masked form with a zero source
+static inline __m256d gather_pd(const double* tab, const __m128i& idx)
+{
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), tab, idx,
+                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+}
+
+/****************************************************************************************\
+*                                 arithmetic and logical ops                             *
+\****************************************************************************************/
+
+template<typename T, class Op> static void
+binOp(const T* src1, size_t step1, const T* src2, size_t step2,
+      T* dst, size_t step, int width, int height)
+{
+    const int VEC = VEC_BYTES/sizeof(T);
+    Op op;
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2),
+                     dst = (T*)((uchar*)dst + step) )
+    {
+        int x = 0;
+        for( ; x <= width - VEC*2; x += VEC*2 )
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(src1 + x));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(src1 + x + VEC));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(src2 + x));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(src2 + x + VEC));
+            _mm256_storeu_si256((__m256i*)(dst + x), op(a0, b0));
+            _mm256_storeu_si256((__m256i*)(dst + x + VEC), op(a1, b1));
+        }
+        for( ; x <= width - VEC; x += VEC )
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(src1 + x));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(src2 + x));
+            _mm256_storeu_si256((__m256i*)(dst + x), op(a, b));
+        }
+        if( x < width )
+        {
+            size_t len = (width - x)*sizeof(T);
+            __m256i a = _mm256_setzero_si256(), b = a;
+            memcpy(&a, src1 + x, len);
+            memcpy(&b, src2 + x, len);
+            a = op(a, b);
+            memcpy(dst + x, &a, len);
+        }
+    }
+}
+
+#define CV_AVX2_DEF_VEC_OP(name, expr) \
+struct name \
+{ \
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return expr; } \
+}
+
+#define CV_AVX2_PS(v) _mm256_castsi256_ps(v)
+#define CV_AVX2_PD(v) _mm256_castsi256_pd(v)
+
+CV_AVX2_DEF_VEC_OP(VAdd8u, _mm256_adds_epu8(a, b));
+CV_AVX2_DEF_VEC_OP(VAdd8s, _mm256_adds_epi8(a, b));
+CV_AVX2_DEF_VEC_OP(VAdd16u, _mm256_adds_epu16(a, b));
+CV_AVX2_DEF_VEC_OP(VAdd16s, _mm256_adds_epi16(a, b));
+CV_AVX2_DEF_VEC_OP(VAdd32s, _mm256_add_epi32(a, b));
+CV_AVX2_DEF_VEC_OP(VAdd32f, _mm256_castps_si256(_mm256_add_ps(CV_AVX2_PS(a), CV_AVX2_PS(b))));
+CV_AVX2_DEF_VEC_OP(VAdd64f, _mm256_castpd_si256(_mm256_add_pd(CV_AVX2_PD(a), CV_AVX2_PD(b))));
+
+CV_AVX2_DEF_VEC_OP(VSub8u, _mm256_subs_epu8(a, b));
+CV_AVX2_DEF_VEC_OP(VSub8s, _mm256_subs_epi8(a, b));
+CV_AVX2_DEF_VEC_OP(VSub16u, _mm256_subs_epu16(a, b));
+CV_AVX2_DEF_VEC_OP(VSub16s, _mm256_subs_epi16(a, b));
+CV_AVX2_DEF_VEC_OP(VSub32s, _mm256_sub_epi32(a, b));
+CV_AVX2_DEF_VEC_OP(VSub32f, _mm256_castps_si256(_mm256_sub_ps(CV_AVX2_PS(a), CV_AVX2_PS(b))));
+CV_AVX2_DEF_VEC_OP(VSub64f, _mm256_castpd_si256(_mm256_sub_pd(CV_AVX2_PD(a), CV_AVX2_PD(b))));
+
+// |a - b| saturated to the type range, computed as max(a,b) - min(a,b)
+CV_AVX2_DEF_VEC_OP(VAbsDiff8u, _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)));
+CV_AVX2_DEF_VEC_OP(VAbsDiff8s, _mm256_subs_epi8(_mm256_max_epi8(a, b), _mm256_min_epi8(a, b)));
+CV_AVX2_DEF_VEC_OP(VAbsDiff16u, _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)));
+CV_AVX2_DEF_VEC_OP(VAbsDiff16s, _mm256_subs_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b)));
+CV_AVX2_DEF_VEC_OP(VAbsDiff32s, _mm256_abs_epi32(_mm256_sub_epi32(a, b)));
+CV_AVX2_DEF_VEC_OP(VAbsDiff32f, _mm256_and_si256(_mm256_castps_si256(_mm256_sub_ps(CV_AVX2_PS(a), CV_AVX2_PS(b))),
+                                                 _mm256_set1_epi32(0x7fffffff)));
+CV_AVX2_DEF_VEC_OP(VAbsDiff64f, _mm256_and_si256(_mm256_castpd_si256(_mm256_sub_pd(CV_AVX2_PD(a), CV_AVX2_PD(b))),
+                                                 _mm256_set1_epi64x(0x7fffffffffffffffLL)));
+
+CV_AVX2_DEF_VEC_OP(VAnd, _mm256_and_si256(a, b));
+CV_AVX2_DEF_VEC_OP(VOr, _mm256_or_si256(a, b));
+CV_AVX2_DEF_VEC_OP(VXor, _mm256_xor_si256(a, b));
+struct VNot
+{
+    __m256i operator()(const __m256i& a, const __m256i&) const
+    { return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); }
+};
+
+#define CV_AVX2_DEF_BINARY_OP(name, type, vop) \
+void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+          type* dst, size_t step, int width, int height) \
+{ \
+    binOp<type, vop>(src1, step1, src2, step2, dst, step, width, height); \
+}
+
+#define CV_AVX2_DEF_BINARY_OPS(name, vop) \
+CV_AVX2_DEF_BINARY_OP(name##8u, uchar, vop##8u) \
+CV_AVX2_DEF_BINARY_OP(name##8s, schar, vop##8s) \
+CV_AVX2_DEF_BINARY_OP(name##16u, ushort, vop##16u) \
+CV_AVX2_DEF_BINARY_OP(name##16s, short, vop##16s) \
+CV_AVX2_DEF_BINARY_OP(name##32s, int, vop##32s) \
+CV_AVX2_DEF_BINARY_OP(name##32f, float, vop##32f) \
+CV_AVX2_DEF_BINARY_OP(name##64f, double, vop##64f)
+
+CV_AVX2_DEF_BINARY_OPS(add, VAdd)
+CV_AVX2_DEF_BINARY_OPS(sub, VSub)
+CV_AVX2_DEF_BINARY_OPS(absdiff, VAbsDiff)
+
+CV_AVX2_DEF_BINARY_OP(and8u, uchar, VAnd)
+CV_AVX2_DEF_BINARY_OP(or8u, uchar, VOr)
+CV_AVX2_DEF_BINARY_OP(xor8u, uchar, VXor)
+
+void not8u(const uchar* src1, size_t step1, const uchar*, size_t,
+           uchar* dst, size_t step, int width, int height)
+{
+    binOp<uchar, VNot>(src1, step1, src1, step1, dst, step, width, height);
+}
+
+/****************************************************************************************\
+*                                        compare                                         *
+\****************************************************************************************/
+
+// same values as cv::CMP_EQ ... cv::CMP_NE
+enum { CMP_EQ=0, CMP_GT=1, CMP_GE=2, CMP_LT=3, CMP_LE=4, CMP_NE=5 };
+
+// gt() and eq() return all-ones lanes where the predicate holds;
+// the floating-point ones are false for NaNs, like the scalar operators
+struct VCmp8u
+{
+    static __m256i gt(const __m256i& a, const __m256i& b)
+    {
+        __m256i d = _mm256_set1_epi8((char)0x80);
+        return _mm256_cmpgt_epi8(_mm256_xor_si256(a, d), _mm256_xor_si256(b, d));
+    }
+    static __m256i eq(const __m256i& a, const __m256i& b) { return _mm256_cmpeq_epi8(a, b); }
+};
+
+struct VCmp8s
+{
+    static __m256i gt(const __m256i& a, const __m256i& b) { return _mm256_cmpgt_epi8(a, b); }
+    static __m256i eq(const __m256i& a, const __m256i& b) { return _mm256_cmpeq_epi8(a, b); }
+};
+
+struct VCmp16u
+{
+    static __m256i gt(const __m256i& a, const __m256i& b)
+    {
+        __m256i d = _mm256_set1_epi16((short)0x8000);
+        return _mm256_cmpgt_epi16(_mm256_xor_si256(a, d), _mm256_xor_si256(b, d));
+    }
+    static __m256i eq(const __m256i& a, const __m256i& b) { return _mm256_cmpeq_epi16(a, b); }
+};
+
+struct VCmp16s
+{
+    static __m256i gt(const __m256i& a, const __m256i& b) { return _mm256_cmpgt_epi16(a, b); }
+    static __m256i eq(const __m256i& a, const __m256i& b) { return _mm256_cmpeq_epi16(a, b); }
+};
+
+struct VCmp32s
+{
+    static __m256i gt(const __m256i& a, const __m256i& b) { return _mm256_cmpgt_epi32(a, b); }
+    static __m256i eq(const __m256i& a, const __m256i& b) { return _mm256_cmpeq_epi32(a, b); }
+};
+
+struct VCmp32f
+{
+    static __m256i gt(const __m256i& a, const __m256i& b)
+    { return _mm256_castps_si256(_mm256_cmp_ps(CV_AVX2_PS(a), CV_AVX2_PS(b), _CMP_GT_OQ)); }
+    static __m256i eq(const __m256i& a, const __m256i& b)
+    { return _mm256_castps_si256(_mm256_cmp_ps(CV_AVX2_PS(a), CV_AVX2_PS(b), _CMP_EQ_OQ)); }
+};
+
+struct VCmp64f
+{
+    static __m256i gt(const __m256i& a, const __m256i& b)
+    { return _mm256_castpd_si256(_mm256_cmp_pd(CV_AVX2_PD(a), CV_AVX2_PD(b), _CMP_GT_OQ)); }
+    static __m256i eq(const __m256i& a, const __m256i& b)
+    { return _mm256_castpd_si256(_mm256_cmp_pd(CV_AVX2_PD(a), CV_AVX2_PD(b), _CMP_EQ_OQ)); }
+};
+
+// packs 4 vectors of 32-bit masks into one vector of byte masks, preserving the order
+static inline __m256i packMasks32(const __m256i& r0, const __m256i& r1,
+                                  const __m256i& r2, const __m256i& r3)
+{
+    __m256i r = _mm256_packs_epi16(_mm256_packs_epi32(r0, r1), _mm256_packs_epi32(r2, r3));
+    return _mm256_permutevar8x32_epi32(r, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+// packs 2 vectors of 64-bit masks into one vector of 32-bit masks
+static inline __m256i packMasks64(const __m256i& r0, const __m256i& r1)
+{
+    __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    return _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(r0, idx),
+                                     _mm256_permutevar8x32_epi32(r1, idx), 0x20);
+}
+
+template<typename T, class Op> static inline __m256i
+cmpBlock(const T* a, const T* b, bool eq)
+{
+    const int esz = sizeof(T), VEC = VEC_BYTES/sizeof(T);
+    __m256i r[8];
+    for( int k = 0; k < esz; k++ )
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + k*VEC));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + k*VEC));
+        r[k] = eq ? Op::eq(va, vb) : Op::gt(va, vb);
+    }
+    if( esz == 1 )
+        return r[0];
+    if( esz == 2 )
+        return _mm256_permute4x64_epi64(_mm256_packs_epi16(r[0], r[1]), 0xD8);
+    if( esz == 8 )
+    {
+        r[0] = packMasks64(r[0], r[1]);
+        r[1] = packMasks64(r[2], r[3]);
+        r[2] = packMasks64(r[4], r[5]);
+        r[3] = packMasks64(r[6], r[7]);
+    }
+    return packMasks32(r[0], r[1], r[2], r[3]);
+}
+
+template<typename T, class Op> static void
+cmpOp(const T* src1, size_t step1, const T* src2, size_t step2,
+      uchar* dst, size_t step, int width, int height, int code)
+{
+    if( code == CMP_GE || code == CMP_LT )
+    {
+        const T* t = src1; src1 = src2; src2 = t;
+        size_t s = step1; step1 = step2; step2 = s;
+        code = code == CMP_GE ? CMP_LE : CMP_GT;
+    }
+
+    bool eq = code == CMP_EQ || code == CMP_NE;
+    __m256i m = _mm256_set1_epi8(code == CMP_GT || code == CMP_EQ ? 0 : -1);
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2), dst += step )
+    {
+        int x = 0;
+        for( ; x <= width - VEC_BYTES; x += VEC_BYTES )
+        {
+            __m256i r = cmpBlock<T, Op>(src1 + x, src2 + x, eq);
+            _mm256_storeu_si256((__m256i*)(dst + x), _mm256_xor_si256(r, m));
+        }
+        if( x < width )
+        {
+            T a[VEC_BYTES], b[VEC_BYTES];
+            size_t len = (width - x)*sizeof(T);
+            memset(a, 0, sizeof(a));
+            memset(b, 0, sizeof(b));
+            memcpy(a, src1 + x, len);
+            memcpy(b, src2 + x, len);
+            __m256i r = _mm256_xor_si256(cmpBlock<T, Op>(a, b, eq), m);
+            memcpy(dst + x, &r, width - x);
+        }
+    }
+}
+
+#define CV_AVX2_DEF_CMP_OP(name, type, vop) \
+void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+          uchar* dst, size_t step, int width, int height, int code) \
+{ \
+    cmpOp<type, vop>(src1, step1, src2, step2, dst, step, width, height, code); \
+}
+
+CV_AVX2_DEF_CMP_OP(cmp8u, uchar, VCmp8u)
+CV_AVX2_DEF_CMP_OP(cmp8s, schar, VCmp8s)
+CV_AVX2_DEF_CMP_OP(cmp16u, ushort, VCmp16u)
+CV_AVX2_DEF_CMP_OP(cmp16s, short, VCmp16s)
+CV_AVX2_DEF_CMP_OP(cmp32s, int, VCmp32s)
+CV_AVX2_DEF_CMP_OP(cmp32f, float, VCmp32f)
+CV_AVX2_DEF_CMP_OP(cmp64f, double, VCmp64f)
+
+/****************************************************************************************\
+*                                       conversion                                       *
+\****************************************************************************************/
+
+// loaders of 8 elements converted to float
+struct Load8u
+{
+    typedef uchar type;
+    static __m256 load(const uchar* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+};
+
+struct Load8s
+{
+    typedef schar type;
+    static __m256 load(const schar* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+};
+
+struct Load16u
+{
+    typedef ushort type;
+    static __m256 load(const ushort* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+};
+
+struct Load16s
+{
+    typedef short type;
+    static __m256 load(const short* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+};
+
+struct Load32s
+{
+    typedef int type;
+    static __m256 load(const int* p)
+    { return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p)); }
+};
+
+struct Load32f
+{
+    typedef float type;
+    static __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+};
+
+// storers of 8 floats rounded to the nearest and saturated like saturate_cast<>
+struct Store8u
+{
+    typedef uchar type;
+    static void store(uchar* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+        _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(w, w));
+    }
+};
+
+struct Store8s
+{
+    typedef schar type;
+    static void store(schar* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+        _mm_storel_epi64((__m128i*)p, _mm_packs_epi16(w, w));
+    }
+};
+
+struct Store16u
+{
+    typedef ushort type;
+    static void store(ushort* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        _mm_storeu_si128((__m128i*)p, _mm_packus_epi32(_mm256_castsi256_si128(i),
+                                                        _mm256_extracti128_si256(i, 1)));
+    }
+};
+
+struct Store16s
+{
+    typedef short type;
+    static void store(short* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(i),
+                                                       _mm256_extracti128_si256(i, 1)));
+    }
+};
+
+struct Store32s
+{
+    typedef int type;
+    static void store(int* p, const __m256& v)
+    { _mm256_storeu_si256((__m256i*)p, _mm256_cvtps_epi32(v)); }
+};
+
+struct Store32f
+{
+    typedef float type;
+    static void store(float* p, const __m256& v) { _mm256_storeu_ps(p, v); }
+};
+
+typedef void (*CvtScaleFunc)(const uchar* src, size_t sstep, uchar* dst, size_t dstep,
+                             int width, int height, float scale, float shift);
+
+template<class L, class S, bool absval> static void
+cvtScale_(const uchar* src, size_t sstep, uchar* dst, size_t dstep,
+          int width, int height, float scale, float shift)
+{
+    typedef typename L::type ST;
+    typedef typename S::type DT;
+    __m256 a = _mm256_set1_ps(scale), b = _mm256_set1_ps(shift);
+    __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+    for( ; height--; src += sstep, dst += dstep )
+    {
+        const ST* s = (const ST*)src;
+        DT* d = (DT*)dst;
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(L::load(s + x), a), b);
+            if( absval )
+                v = _mm256_and_ps(v, absmask);
+            S::store(d + x, v);
+        }
+        if( x < width )
+        {
+            ST sbuf[8];
+            DT dbuf[8];
+            memset(sbuf, 0, sizeof(sbuf));
+            memcpy(sbuf, s + x, (width - x)*sizeof(ST));
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(L::load(sbuf), a), b);
+            if( absval )
+                v = _mm256_and_ps(v, absmask);
+            S::store(dbuf, v);
+            memcpy(d + x, dbuf, (width - x)*sizeof(DT));
+        }
+    }
+}
+
+#define CV_AVX2_CVT_ROW(L) \
+{ \
+    cvtScale_<L, Store8u, false>, cvtScale_<L, Store8s, false>, \
+    cvtScale_<L, Store16u, false>, cvtScale_<L, Store16s, false>, \
+    cvtScale_<L, Store32s, false>, cvtScale_<L, Store32f, false> \
+}
+
+// indexed by [sdepth][ddepth], CV_8U ... CV_32F
+static const CvtScaleFunc cvtScaleTab[6][6] =
+{
+    CV_AVX2_CVT_ROW(Load8u), CV_AVX2_CVT_ROW(Load8s), CV_AVX2_CVT_ROW(Load16u),
+    CV_AVX2_CVT_ROW(Load16s), CV_AVX2_CVT_ROW(Load32s), CV_AVX2_CVT_ROW(Load32f)
+};
+
+static const CvtScaleFunc cvtScaleAbsTab[6] =
+{
+    cvtScale_<Load8u, Store8u, true>, cvtScale_<Load8s, Store8u, true>,
+    cvtScale_<Load16u, Store8u, true>, cvtScale_<Load16s, Store8u, true>,
+    cvtScale_<Load32s, Store8u, true>, cvtScale_<Load32f, Store8u, true>
+};
+
+enum { DEPTH_32S = 4, DEPTH_32F = 5 };
+
+bool cvtScale(const void* src, size_t sstep, int sdepth,
+              void* dst, size_t dstep, int ddepth,
+              int width, int height, double scale, double shift)
+{
+    if( sdepth < 0 || sdepth > DEPTH_32F || ddepth < 0 || ddepth > DEPTH_32F )
+        return false;
+    // int -> int and scaled int -> float are computed in double precision
+    if( sdepth == DEPTH_32S && (ddepth == DEPTH_32S || scale != 1 || shift != 0) &&
+        ddepth >= DEPTH_32S )
+        return false;
+    cvtScaleTab[sdepth][ddepth]((const uchar*)src, sstep, (uchar*)dst, dstep,
+                                width, height, (float)scale, (float)shift);
+    return true;
+}
+
+bool cvtScaleAbs(const void* src, size_t sstep, int sdepth,
+                 uchar* dst, size_t dstep,
+                 int width, int height, double scale, double shift)
+{
+    if( sdepth < 0 || sdepth > DEPTH_32F )
+        return false;
+    cvtScaleAbsTab[sdepth]((const uchar*)src, sstep, dst, dstep,
+                           width, height, (float)scale, (float)shift);
+    return true;
+}
+
+/****************************************************************************************\
+*                                     math functions                                     *
+\****************************************************************************************/
+
+// runs an 8-wide kernel over an array, padding the tail
+template<class Op> static void
+mathOp1(const float* src, float* dst, int len, const Op& op)
+{
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+        _mm256_storeu_ps(dst + i, op(_mm256_loadu_ps(src + i)));
+    if( i < len )
+    {
+        float buf[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+        memcpy(buf, src + i, (len - i)*sizeof(float));
+        _mm256_storeu_ps(buf, op(_mm256_loadu_ps(buf)));
+        memcpy(dst + i, buf, (len - i)*sizeof(float));
+    }
+}
+
+// the constants must be kept in sync with mathfuncs.cpp
+enum { EXPTAB_SCALE = 6, EXPTAB_MASK = (1 << EXPTAB_SCALE) - 1 };
+#define CV_AVX2_EXPPOLY_32F_A0 .9670371139572337719125840413672004409288e-2
+
+struct VExp32f
+{
+    VExp32f(const double* _tab) : tab(_tab)
+    {
+        const double prescale = 1.4426950408889634073599246810019 * (1 << EXPTAB_SCALE);
+        const double maxval = 3000.*(1 << EXPTAB_SCALE);
+        prescale4 = _mm256_set1_pd(prescale);
+        postscale8 = _mm256_set1_ps(1.f/(1 << EXPTAB_SCALE));
+        maxval8 = _mm256_set1_ps((float)(maxval/prescale));
+        minval8 = _mm256_set1_ps((float)(-maxval/prescale));
+        A1 = _mm256_set1_ps((float)(.5550339366753125211915322047004666939128e-1 / CV_AVX2_EXPPOLY_32F_A0));
+        A2 = _mm256_set1_ps((float)(.2402265109513301490103372422686535526573 / CV_AVX2_EXPPOLY_32F_A0));
+        A3 = _mm256_set1_ps((float)(.6931471805521448196800669615864773144641 / CV_AVX2_EXPPOLY_32F_A0));
+        A4 = _mm256_set1_ps((float)(1.000000000000002438532970795181890933776 / CV_AVX2_EXPPOLY_32F_A0));
+    }
+
+    __m256 operator()(__m256 x) const
+    {
+        x = _mm256_min_ps(_mm256_max_ps(x, minval8), maxval8);
+
+        __m256d xd0 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), prescale4);
+        __m256d xd1 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), prescale4);
+        __m128i xi0 = _mm256_cvtpd_epi32(xd0), xi1 = _mm256_cvtpd_epi32(xd1);
+        xd0 = _mm256_sub_pd(xd0, _mm256_cvtepi32_pd(xi0));
+        xd1 = _mm256_sub_pd(xd1, _mm256_cvtepi32_pd(xi1));
+        x = _mm256_mul_ps(combine(_mm256_cvtpd_ps(xd0), _mm256_cvtpd_ps(xd1)), postscale8);
+
+        __m256i xi = combine(xi0, xi1);
+        __m256i idx = _mm256_and_si256(xi, _mm256_set1_epi32(EXPTAB_MASK));
+        xi = _mm256_add_epi32(_mm256_srai_epi32(xi, EXPTAB_SCALE), _mm256_set1_epi32(127));
+        xi = _mm256_min_epi32(_mm256_max_epi32(xi, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+
+        __m256d t0 = gather_pd(tab, _mm256_castsi256_si128(idx));
+        __m256d t1 = gather_pd(tab, _mm256_extracti128_si256(idx, 1));
+        __m256 y = _mm256_mul_ps(combine(_mm256_cvtpd_ps(t0), _mm256_cvtpd_ps(t1)),
+                                 _mm256_castsi256_ps(_mm256_slli_epi32(xi, 23)));
+
+        __m256 z = _mm256_add_ps(x, A1);
+        z = _mm256_fmadd_ps(z, x, A2);
+        z = _mm256_fmadd_ps(z, x, A3);
+        z = _mm256_fmadd_ps(z, x, A4);
+        return _mm256_mul_ps(z, y);
+    }
+
+    const double* tab;
+    __m256d prescale4;
+    __m256 postscale8, maxval8, minval8, A1, A2, A3, A4;
+};
+
+void exp32f(const float* src, float* dst, int len, const double* expTab)
+{
+    mathOp1(src, dst, len, VExp32f(expTab));
+}
+
+enum { LOGTAB_SCALE = 8, LOGTAB_MASK = (1 << LOGTAB_SCALE) - 1,
+       LOGTAB_MASK2_32F = (1 << (23 - LOGTAB_SCALE)) - 1 };
+
+struct VLog32f
+{
+    VLog32f(const double* _tab) : tab(_tab)
+    {
+        ln2 = _mm256_set1_pd(0.69314718055994530941723212145818);
+        one = _mm256_set1_ps(1.f);
+        shift = _mm256_set1_ps(-1.f/512);
+        A0 = _mm256_set1_ps(0.3333333333333333333333333f);
+        A1 = _mm256_set1_ps(-0.5f);
+        A2 = _mm256_set1_ps(1.f);
+    }
+
+    __m256 operator()(__m256 x) const
+    {
+        __m256i h = _mm256_castps_si256(x);
+        __m256i yi = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(h, 23), _mm256_set1_epi32(255)),
+                                      _mm256_set1_epi32(127));
+        __m256d yd0 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(yi)), ln2);
+        __m256d yd1 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(yi, 1)), ln2);
+
+        __m256i xi = _mm256_or_si256(_mm256_and_si256(h, _mm256_set1_epi32(LOGTAB_MASK2_32F)),
+                                     _mm256_set1_epi32(127 << 23));
+
+        h = _mm256_and_si256(_mm256_srli_epi32(h, 23 - LOGTAB_SCALE - 1), _mm256_set1_epi32(LOGTAB_MASK*2));
+        __m128i h0 = _mm256_castsi256_si128(h), h1 = _mm256_extracti128_si256(h, 1);
+        __m256 corr = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(510))), shift);
+
+        yd0 = _mm256_add_pd(yd0, gather_pd(tab, h0));
+        yd1 = _mm256_add_pd(yd1, gather_pd(tab, h1));
+        __m256 r = combine(_mm256_cvtpd_ps(gather_pd(tab + 1, h0)),
+                           _mm256_cvtpd_ps(gather_pd(tab + 1, h1)));
+        __m256 y = combine(_mm256_cvtpd_ps(yd0), _mm256_cvtpd_ps(yd1));
+
+        x = _mm256_fmadd_ps(_mm256_sub_ps(_mm256_castsi256_ps(xi), one), r, corr);
+
+        __m256 z = _mm256_fmadd_ps(x, A0, A1);
+        z = _mm256_fmadd_ps(z, x, A2);
+        return _mm256_fmadd_ps(z, x, y);
+    }
+
+    const double* tab;
+    __m256d ln2;
+    __m256 one, shift, A0, A1, A2;
+};
+
+void log32f(const float* src, float* dst, int len, const double* logTab)
+{
+    mathOp1(src, dst, len, VLog32f(logTab));
+}
+
+void magnitude32f(const float* x, const float* y, float* mag, int len)
+{
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 x0 = _mm256_loadu_ps(x + i), y0 = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(mag + i, _mm256_sqrt_ps(_mm256_fmadd_ps(x0, x0, _mm256_mul_ps(y0, y0))));
+    }
+    if( i < len )
+    {
+        float bx[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }, by[8];
+        size_t n = (len - i)*sizeof(float);
+        memcpy(by, bx, sizeof(by));
+        memcpy(bx, x + i, n);
+        memcpy(by, y + i, n);
+        __m256 x0 = _mm256_loadu_ps(bx), y0 = _mm256_loadu_ps(by);
+        _mm256_storeu_ps(bx, _mm256_sqrt_ps(_mm256_fmadd_ps(x0, x0, _mm256_mul_ps(y0, y0))));
+        memcpy(mag + i, bx, n);
+    }
+}
+
+void magnitude64f(const double* x, const double* y, double* mag, int len)
+{
+    int i = 0;
+    for( ; i <= len - 4; i += 4 )
+    {
+        __m256d x0 = _mm256_loadu_pd(x + i), y0 = _mm256_loadu_pd(y + i);
+        _mm256_storeu_pd(mag + i, _mm256_sqrt_pd(_mm256_fmadd_pd(x0, x0, _mm256_mul_pd(y0, y0))));
+    }
+    if( i < len )
+    {
+        double bx[4] = { 0., 0., 0., 0. }, by[4];
+        size_t n = (len - i)*sizeof(double);
+        memcpy(by, bx, sizeof(by));
+        memcpy(bx, x + i, n);
+        memcpy(by, y + i, n);
+        __m256d x0 = _mm256_loadu_pd(bx), y0 = _mm256_loadu_pd(by);
+        _mm256_storeu_pd(bx, _mm256_sqrt_pd(_mm256_fmadd_pd(x0, x0, _mm256_mul_pd(y0, y0))));
+        memcpy(mag + i, bx, n);
+    }
+}
+
+static inline __m256 fastAtan2_8(const __m256& y, const __m256& x, const __m256& scale)
+{
+    const float pi = 3.1415926535897932384626433832795f;
+    const __m256 eps = _mm256_set1_ps((float)2.2204460492503131e-016), z = _mm256_setzero_ps();
+    const __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 p1 = _mm256_set1_ps(0.9997878412794807f*(180/pi));
+    const __m256 p3 = _mm256_set1_ps(-0.3258083974640975f*(180/pi));
+    const __m256 p5 = _mm256_set1_ps(0.1555786518463281f*(180/pi));
+    const __m256 p7 = _mm256_set1_ps(-0.04432655554792128f*(180/pi));
+
+    __m256 ax = _mm256_and_ps(x, absmask), ay = _mm256_and_ps(y, absmask);
+    __m256 c = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_add_ps(_mm256_max_ps(ax, ay), eps));
+    __m256 c2 = _mm256_mul_ps(c, c);
+    __m256 a = _mm256_fmadd_ps(c2, p7, p5);
+    a = _mm256_fmadd_ps(a, c2, p3);
+    a = _mm256_fmadd_ps(a, c2, p1);
+    a = _mm256_mul_ps(a, c);
+
+    a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(90.f), a), _mm256_cmp_ps(ax, ay, _CMP_LT_OQ));
+    a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(180.f), a), _mm256_cmp_ps(x, z, _CMP_LT_OQ));
+    a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(360.f), a), _mm256_cmp_ps(y, z, _CMP_LT_OQ));
+    return _mm256_mul_ps(a, scale);
+}
+
+void fastAtan2_32f(const float* y, const float* x, float* angle, int len, float scale)
+{
+    __m256 scale8 = _mm256_set1_ps(scale);
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+        _mm256_storeu_ps(angle + i, fastAtan2_8(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i), scale8));
+    if( i < len )
+    {
+        float bx[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }, by[8];
+        size_t n = (len - i)*sizeof(float);
+        memcpy(by, bx, sizeof(by));
+        memcpy(bx, x + i, n);
+        memcpy(by, y + i, n);
+        _mm256_storeu_ps(bx, fastAtan2_8(_mm256_loadu_ps(by), _mm256_loadu_ps(bx), scale8));
+        memcpy(angle + i, bx, n);
+    }
+}
+
+// F16C is present on all the AVX2 CPUs, but still it is checked separately by the callers
+void cvtFp32ToFp16(const float* src, unsigned short* dst, int len)
+{
+    int i = 0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m128i h0 = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        __m128i h1 = _mm256_cvtps_ph(_mm256_loadu_ps(src + i + 8), _MM_FROUND_TO_NEAREST_INT);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_inserti128_si256(_mm256_castsi128_si256(h0), h1, 1));
+    }
+    for( ; i < len; i += 8 )
+    {
+        float buf[8] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+        unsigned short hbuf[8];
+        int n = len - i < 8 ? len - i : 8;
+        memcpy(buf, src + i, n*sizeof(float));
+        _mm_storeu_si128((__m128i*)hbuf, _mm256_cvtps_ph(_mm256_loadu_ps(buf), _MM_FROUND_TO_NEAREST_INT));
+        memcpy(dst + i, hbuf, n*sizeof(unsigned short));
+    }
+}
+
+void cvtFp16ToFp32(const unsigned short* src, float* dst, int len)
+{
+    int i = 0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256i h = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm256_castsi256_si128(h)));
+        _mm256_storeu_ps(dst + i + 8, _mm256_cvtph_ps(_mm256_extracti128_si256(h, 1)));
+    }
+    for( ; i < len; i += 8 )
+    {
+        unsigned short hbuf[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        float buf[8];
+        int n = len - i < 8 ? len - i : 8;
+        memcpy(hbuf, src + i, n*sizeof(unsigned short));
+        _mm256_storeu_ps(buf, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)hbuf)));
+        memcpy(dst + i, buf, n*sizeof(float));
+    }
+}
+
+}}
+
+#endif
+
+/* End of file. */
@@ -0,0 +1,130 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef __OPENCV_CORE_SIMD_AVX2_HPP__
+#define __OPENCV_CORE_SIMD_AVX2_HPP__
+
+#include <stddef.h>
+
+/*
+   AVX2/FMA versions of the core element-wise kernels.
+
+   The functions are compiled in a separate translation unit (simd_avx2.cpp) with
+   the AVX2 code generation flags, so the rest of the library can still run on any
+   x86 CPU. Callers must check USE_AVX2 before invoking any of them. The interface
+   deliberately uses only built-in types: no OpenCV header is included into the AVX2
+   translation unit, so no inline function may get instantiated with AVX2 code there
+   and then be picked up by the linker for the generic code.
+*/
+
+namespace cv { namespace avx2
+{
+
+#define CV_AVX2_DECL_BINARY_OP(name, type) \
+void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+          type* dst, size_t step, int width, int height)
+
+#define CV_AVX2_DECL_BINARY_OPS(name) \
+CV_AVX2_DECL_BINARY_OP(name##8u, unsigned char); \
+CV_AVX2_DECL_BINARY_OP(name##8s, signed char); \
+CV_AVX2_DECL_BINARY_OP(name##16u, unsigned short); \
+CV_AVX2_DECL_BINARY_OP(name##16s, short); \
+CV_AVX2_DECL_BINARY_OP(name##32s, int); \
+CV_AVX2_DECL_BINARY_OP(name##32f, float); \
+CV_AVX2_DECL_BINARY_OP(name##64f, double)
+
+CV_AVX2_DECL_BINARY_OPS(add);
+CV_AVX2_DECL_BINARY_OPS(sub);
+CV_AVX2_DECL_BINARY_OPS(absdiff);
+
+// min() and max(), see arithm_avx2.cpp
+CV_AVX2_DECL_BINARY_OPS(min);
+CV_AVX2_DECL_BINARY_OPS(max);
+
+CV_AVX2_DECL_BINARY_OP(and8u, unsigned char);
+CV_AVX2_DECL_BINARY_OP(or8u, unsigned char);
+CV_AVX2_DECL_BINARY_OP(xor8u, unsigned char);
+CV_AVX2_DECL_BINARY_OP(not8u, unsigned char);
+
+#define CV_AVX2_DECL_CMP_OP(name, type) \
+void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+          unsigned char* dst, size_t step, int width, int height, int code)
+
+CV_AVX2_DECL_CMP_OP(cmp8u, unsigned char);
+CV_AVX2_DECL_CMP_OP(cmp8s, signed char);
+CV_AVX2_DECL_CMP_OP(cmp16u, unsigned short);
+CV_AVX2_DECL_CMP_OP(cmp16s, short);
+CV_AVX2_DECL_CMP_OP(cmp32s, int);
+CV_AVX2_DECL_CMP_OP(cmp32f, float);
+CV_AVX2_DECL_CMP_OP(cmp64f, double);
+
+// dst = saturate_cast<dtype>(src*scale + shift), computed in single precision.
+// Depths are the CV_8U ... CV_32F codes. Returns false (and does nothing)
+// for the depth combinations that need double precision or are not supported.
+bool cvtScale(const void* src, size_t sstep, int sdepth,
+              void* dst, size_t dstep, int ddepth,
+              int width, int height, double scale, double shift);
+
+// dst = saturate_cast<uchar>(|src*scale + shift|)
+bool cvtScaleAbs(const void* src, size_t sstep, int sdepth,
+                 unsigned char* dst, size_t dstep,
+                 int width, int height, double scale, double shift);
+
+// the table-based algorithms of mathfuncs.cpp, with the same tables passed in
+void exp32f(const float* src, float* dst, int len, const double* expTab);
+void log32f(const float* src, float* dst, int len, const double* logTab);
+
+void magnitude32f(const float* x, const float* y, float* mag, int len);
+void magnitude64f(const double* x, const double* y, double* mag, int len);
+void fastAtan2_32f(const float* y, const float* x, float* angle, int len, float scale);
+
+// the half-precision float conversions; they also need F16C (CV_CPU_F16C)
+void cvtFp32ToFp16(const float* src, unsigned short* dst, int len);
+void cvtFp16ToFp32(const unsigned short* src, float* dst, int len);
+
+#undef CV_AVX2_DECL_BINARY_OP
+#undef CV_AVX2_DECL_BINARY_OPS
+#undef CV_AVX2_DECL_CMP_OP
+
+}}
+
+#endif
@@ -56,6 +56,400 @@ template<typename T> static inline Scalar rawToScalar(const T& v)
     return s;
 }
 
+/****************************************************************************************\
+*                                 vectorized kernels                                     *
+\****************************************************************************************/
+
+/*
+ The vectorized parts of the unmasked reductions. Each function processes the longest prefix
+ it can, merges its result into the accumulator(s) and returns the number of processed
+ elements (pixels for the multi-channel functions); the callers finish the tail with the
+ scalar loops. The integer accumulations are exact, so the results do not change;
+ the floating-point kernels are limited to the operations that do not round (min, max, compare).
+*/
+
+template<typename T, typename ST> static inline int vSum( const T*, ST*, int, int ) { return 0; }
+template<typename T, typename ST, typename SQT> static inline int vSumSqr( const T*, ST*, SQT*, int, int ) { return 0; }
+template<typename T> static inline int vCountNonZero( const T*, int, int& ) { return 0; }
+template<typename T, typename WT> static inline int vMinMax( const T*, int, WT&, WT&, size_t&, size_t&, size_t ) { return 0; }
+template<typename T, typename ST> static inline int vNormInf( const T*, int, ST& ) { return 0; }
+template<typename T, typename ST> static inline int vNormL1( const T*, int, ST& ) { return 0; }
+template<typename T, typename ST> static inline int vNormL2( const T*, int, ST& ) { return 0; }
+template<typename T, typename ST> static inline int vNormDiffInf( const T*, const T*, int, ST& ) { return 0; }
+template<typename T, typename ST> static inline int vNormDiffL2( const T*, const T*, int, ST& ) { return 0; }
+
+#if CV_SIMD
+
+template<typename T> struct VStatType {};
+template<> struct VStatType<uchar>
+{ typedef v_uint8 vtype; static vtype setall(uchar v) { return v_setall_u8(v); } };
+template<> struct VStatType<schar>
+{ typedef v_int8 vtype; static vtype setall(schar v) { return v_setall_s8(v); } };
+template<> struct VStatType<ushort>
+{ typedef v_uint16 vtype; static vtype setall(ushort v) { return v_setall_u16(v); } };
+template<> struct VStatType<short>
+{ typedef v_int16 vtype; static vtype setall(short v) { return v_setall_s16(v); } };
+template<> struct VStatType<int>
+{ typedef v_int32 vtype; static vtype setall(int v) { return v_setall_s32(v); } };
+
+// widens the vector to 32 bits and adds the halves up: lane l of the result
+// is the sum of the source lanes l, l + v_int32::nlanes, ...
+static inline v_int32 v_expand_sum( const v_uint16& a )
+{
+    v_uint32 b0, b1;
+    v_expand(a, b0, b1);
+    return v_reinterpret_as_s32(b0 + b1);
+}
+
+static inline v_int32 v_expand_sum( const v_int16& a )
+{
+    v_int32 b0, b1;
+    v_expand(a, b0, b1);
+    return b0 + b1;
+}
+
+static inline v_int32 v_expand_sum( const v_uint8& a )
+{
+    v_uint16 b0, b1;
+    v_expand(a, b0, b1);
+    return v_expand_sum(b0) + v_expand_sum(b1);
+}
+
+static inline v_int32 v_expand_sum( const v_int8& a )
+{
+    v_int16 b0, b1;
+    v_expand(a, b0, b1);
+    return v_expand_sum(b0) + v_expand_sum(b1);
+}
+
+// adds the lanes of the accumulator to the per-channel sums; cn must divide v_int32::nlanes
+template<typename ST> static inline void v_add_channel_sums( const v_int32& a, ST* dst, int cn )
+{
+    int buf[v_int32::nlanes];
+    v_store(buf, a);
+    for( int l = 0; l < v_int32::nlanes; l++ )
+        dst[l % cn] += buf[l];
+}
+
+template<typename T> static int vSumInt( const T* src, int* dst, int len, int cn )
+{
+    typedef typename VStatType<T>::vtype vtype;
+    if( (cn != 1 && cn != 2 && cn != 4) || !checkSIMDSupport() )
+        return 0;
+
+    int x = 0, total = len*cn;
+    v_int32 s = v_setzero_s32();
+    for( ; x <= total - vtype::nlanes; x += vtype::nlanes )
+        s += v_expand_sum(v_load(src + x));
+    v_add_channel_sums(s, dst, cn);
+    return x/cn;
+}
+
+static int vSum( const uchar* src, int* dst, int len, int cn ) { return vSumInt(src, dst, len, cn); }
+static int vSum( const schar* src, int* dst, int len, int cn ) { return vSumInt(src, dst, len, cn); }
+static int vSum( const ushort* src, int* dst, int len, int cn ) { return vSumInt(src, dst, len, cn); }
+static int vSum( const short* src, int* dst, int len, int cn ) { return vSumInt(src, dst, len, cn); }
+
+// the squares of 8-bit values fit into 16 unsigned bits
+static inline v_int32 v_expand_sqr_sum( const v_uint8& a )
+{
+    v_uint16 b0, b1;
+    v_expand(a, b0, b1);
+    return v_expand_sum(v_mul_wrap(b0, b0)) + v_expand_sum(v_mul_wrap(b1, b1));
+}
+
+static inline v_int32 v_expand_sqr_sum( const v_int8& a )
+{
+    v_int16 b0, b1;
+    v_expand(a, b0, b1);
+    return v_expand_sum(v_reinterpret_as_u16(v_mul_wrap(b0, b0))) +
+           v_expand_sum(v_reinterpret_as_u16(v_mul_wrap(b1, b1)));
+}
+
+template<typename T> static int vSumSqr8( const T* src, int* sum, int* sqsum, int len, int cn )
+{
+    typedef typename VStatType<T>::vtype vtype;
+    if( (cn != 1 && cn != 2 && cn != 4) || !checkSIMDSupport() )
+        return 0;
+
+    int x = 0, total = len*cn;
+    v_int32 s = v_setzero_s32(), sq = v_setzero_s32();
+    for( ; x <= total - vtype::nlanes; x += vtype::nlanes )
+    {
+        vtype v = v_load(src + x);
+        s += v_expand_sum(v);
+        sq += v_expand_sqr_sum(v);
+    }
+    v_add_channel_sums(s, sum, cn);
+    v_add_channel_sums(sq, sqsum, cn);
+    return x/cn;
+}
+
+static int vSumSqr( const uchar* src, int* sum, int* sqsum, int len, int cn )
+{ return vSumSqr8(src, sum, sqsum, len, cn); }
+static int vSumSqr( const schar* src, int* sum, int* sqsum, int len, int cn )
+{ return vSumSqr8(src, sum, sqsum, len, cn); }
+
+// counts the zero lanes in the narrow accumulators, which are flushed before they may wrap around
+template<typename T> static int vCountZeros8_16( const T* src, int len, int& nz )
+{
+    typedef typename VStatType<T>::vtype vtype;
+    if( !checkSIMDSupport() )
+        return 0;
+
+    const int n = vtype::nlanes;
+    int x = 0;
+    vtype z = VStatType<T>::setall(0);
+    v_int32 zeros = v_setzero_s32();
+    while( x <= len - n )
+    {
+        vtype acc = z;
+        for( int j = 0; j < 255 && x <= len - n; j++, x += n )
+            acc = v_sub_wrap(acc, v_load(src + x) == z);
+        zeros += v_expand_sum(acc);
+    }
+    nz += x - v_reduce_sum(zeros);
+    return x;
+}
+
+static int vCountNonZero( const uchar* src, int len, int& nz ) { return vCountZeros8_16(src, len, nz); }
+static int vCountNonZero( const ushort* src, int len, int& nz ) { return vCountZeros8_16(src, len, nz); }
+
+static int vCountNonZero( const int* src, int len, int& nz )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_int32 z = v_setzero_s32(), zeros = z;
+    for( ; x <= len - v_int32::nlanes; x += v_int32::nlanes )
+        zeros -= v_load(src + x) == z;
+    nz += x - v_reduce_sum(zeros);
+    return x;
+}
+
+static int vCountNonZero( const float* src, int len, int& nz )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_float32 z = v_setzero_f32();
+    v_int32 zeros = v_setzero_s32();
+    for( ; x <= len - v_float32::nlanes; x += v_float32::nlanes )
+        zeros -= v_reinterpret_as_s32(v_load(src + x) == z);
+    nz += x - v_reduce_sum(zeros);
+    return x;
+}
+
+#if CV_SIMD_64F
+static int vCountNonZero( const double* src, int len, int& nz )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_float64 z = v_setzero_f64();
+    v_int32 zeros = v_setzero_s32();
+    // every 64-bit lane of the comparison result is counted twice as two 32-bit ones
+    for( ; x <= len - v_float64::nlanes; x += v_float64::nlanes )
+        zeros -= v_reinterpret_as_s32(v_load(src + x) == z);
+    nz += x - v_reduce_sum(zeros)/2;
+    return x;
+}
+#endif
+
+template<typename T> static int vMinMaxVal( const T* src, int len, T& minVal, T& maxVal )
+{
+    typedef typename VStatType<T>::vtype vtype;
+    const int n = vtype::nlanes;
+    if( len < n || !checkSIMDSupport() )
+        return 0;
+
+    vtype vmin = v_load(src), vmax = vmin;
+    int x = n;
+    for( ; x <= len - n; x += n )
+    {
+        vtype v = v_load(src + x);
+        vmin = v_min(vmin, v);
+        vmax = v_max(vmax, v);
+    }
+
+    T buf0[n], buf1[n];
+    v_store(buf0, vmin);
+    v_store(buf1, vmax);
+    minVal = buf0[0];
+    maxVal = buf1[0];
+    for( int l = 1; l < n; l++ )
+    {
+        minVal = std::min(minVal, buf0[l]);
+        maxVal = std::max(maxVal, buf1[l]);
+    }
+    return x;
+}
+
+// returns the index of the first occurence of val, which must be present in the array
+template<typename T> static int vFindFirst( const T* src, T val )
+{
+    typedef typename VStatType<T>::vtype vtype;
+    int x = 0;
+    vtype v = VStatType<T>::setall(val);
+    while( !v_check_any(v_reinterpret_as_u8(v_load(src + x) == v)) )
+        x += vtype::nlanes;
+    for( ; src[x] != val; x++ )
+        ;
+    return x;
+}
+
+// the minimum and the maximum are found first, and then their (first) positions
+template<typename T> static int vMinMaxInt( const T* src, int len, int& minVal, int& maxVal,
+                                            size_t& minIdx, size_t& maxIdx, size_t startIdx )
+{
+    T vmin, vmax;
+    int x = vMinMaxVal(src, len, vmin, vmax);
+    if( x == 0 )
+        return 0;
+    if( vmin < minVal )
+    {
+        minVal = vmin;
+        minIdx = startIdx + vFindFirst(src, vmin);
+    }
+    if( vmax > maxVal )
+    {
+        maxVal = vmax;
+        maxIdx = startIdx + vFindFirst(src, vmax);
+    }
+    return x;
+}
+
+static int vMinMax( const uchar* src, int len, int& minVal, int& maxVal, size_t& minIdx, size_t& maxIdx, size_t startIdx )
+{ return vMinMaxInt(src, len, minVal, maxVal, minIdx, maxIdx, startIdx); }
+static int vMinMax( const schar* src, int len, int& minVal, int& maxVal, size_t& minIdx, size_t& maxIdx, size_t startIdx )
+{ return vMinMaxInt(src, len, minVal, maxVal, minIdx, maxIdx, startIdx); }
+static int vMinMax( const ushort* src, int len, int& minVal, int& maxVal, size_t& minIdx, size_t& maxIdx, size_t startIdx )
+{ return vMinMaxInt(src, len, minVal, maxVal, minIdx, maxIdx, startIdx); }
+static int vMinMax( const short* src, int len, int& minVal, int& maxVal, size_t& minIdx, size_t& maxIdx, size_t startIdx )
+{ return vMinMaxInt(src, len, minVal, maxVal, minIdx, maxIdx, startIdx); }
+static int vMinMax( const int* src, int len, int& minVal, int& maxVal, size_t& minIdx, size_t& maxIdx, size_t startIdx )
+{ return vMinMaxInt(src, len, minVal, maxVal, minIdx, maxIdx, startIdx); }
+
+template<typename T> static int vNormInfInt( const T* src, int n, int& result )
+{
+    T vmin, vmax;
+    int x = vMinMaxVal(src, n, vmin, vmax);
+    if( x > 0 )
+        result = std::max(result, std::max(std::abs((int)vmin), std::abs((int)vmax)));
+    return x;
+}
+
+static int vNormInf( const uchar* src, int n, int& result ) { return vNormInfInt(src, n, result); }
+static int vNormInf( const schar* src, int n, int& result ) { return vNormInfInt(src, n, result); }
+static int vNormInf( const ushort* src, int n, int& result ) { return vNormInfInt(src, n, result); }
+static int vNormInf( const short* src, int n, int& result ) { return vNormInfInt(src, n, result); }
+
+// v_max(x, m) keeps m where x is NaN, exactly as std::max(m, x) does
+static int vNormInf( const float* src, int n, float& result )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_float32 m = v_setall_f32(result);
+    for( ; x <= n - v_float32::nlanes; x += v_float32::nlanes )
+        m = v_max(v_abs(v_load(src + x)), m);
+    result = v_reduce_max(m);
+    return x;
+}
+
+static int vNormL1( const uchar* src, int n, int& result ) { return vSumInt(src, &result, n, 1); }
+static int vNormL1( const ushort* src, int n, int& result ) { return vSumInt(src, &result, n, 1); }
+
+static int vNormL1( const schar* src, int n, int& result )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_int16 z = v_setzero_s16();
+    v_int32 s = v_setzero_s32();
+    for( ; x <= n - v_int8::nlanes; x += v_int8::nlanes )
+    {
+        v_int16 b0, b1;
+        v_expand(v_load(src + x), b0, b1);
+        s += v_expand_sum(v_max(b0, z - b0)) + v_expand_sum(v_max(b1, z - b1));
+    }
+    result += v_reduce_sum(s);
+    return x;
+}
+
+static int vNormL1( const short* src, int n, int& result )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_int32 z = v_setzero_s32(), s = z;
+    for( ; x <= n - v_int16::nlanes; x += v_int16::nlanes )
+    {
+        v_int32 b0, b1;
+        v_expand(v_load(src + x), b0, b1);
+        s += v_max(b0, z - b0) + v_max(b1, z - b1);
+    }
+    result += v_reduce_sum(s);
+    return x;
+}
+
+template<typename T> static int vNormL2Int8( const T* src, int n, int& result )
+{
+    typedef typename VStatType<T>::vtype vtype;
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_int32 sq = v_setzero_s32();
+    for( ; x <= n - vtype::nlanes; x += vtype::nlanes )
+        sq += v_expand_sqr_sum(v_load(src + x));
+    result += v_reduce_sum(sq);
+    return x;
+}
+
+static int vNormL2( const uchar* src, int n, int& result ) { return vNormL2Int8(src, n, result); }
+static int vNormL2( const schar* src, int n, int& result ) { return vNormL2Int8(src, n, result); }
+
+static int vNormDiffInf( const uchar* src1, const uchar* src2, int n, int& result )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_uint8 m = v_setzero_u8();
+    for( ; x <= n - v_uint8::nlanes; x += v_uint8::nlanes )
+        m = v_max(m, v_absdiff(v_load(src1 + x), v_load(src2 + x)));
+    uchar buf[v_uint8::nlanes];
+    v_store(buf, m);
+    for( int l = 0; l < v_uint8::nlanes; l++ )
+        result = std::max(result, (int)buf[l]);
+    return x;
+}
+
+static int vNormDiffInf( const float* src1, const float* src2, int n, float& result )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_float32 m = v_setall_f32(result);
+    for( ; x <= n - v_float32::nlanes; x += v_float32::nlanes )
+        m = v_max(v_absdiff(v_load(src1 + x), v_load(src2 + x)), m);
+    result = v_reduce_max(m);
+    return x;
+}
+
+static int vNormDiffL2( const uchar* src1, const uchar* src2, int n, int& result )
+{
+    if( !checkSIMDSupport() )
+        return 0;
+    int x = 0;
+    v_int32 sq = v_setzero_s32();
+    for( ; x <= n - v_uint8::nlanes; x += v_uint8::nlanes )
+        sq += v_expand_sqr_sum(v_absdiff(v_load(src1 + x), v_load(src2 + x)));
+    result += v_reduce_sum(sq);
+    return x;
+}
+
+#endif
+
 /****************************************************************************************\
 *                                        sum                                             *
 \****************************************************************************************/
@@ -66,7 +460,10 @@ static int sum_(const T* src0, const uchar* mask, ST* dst, int len, int cn )
     const T* src = src0;
     if( !mask )
     {
-        int i=0;
+        int i = vSum(src0, dst, len, cn), len0 = len;
+        src = src0 += i*cn;
+        len -= i;
+        i = 0;
         int k = cn % 4;
         if( k == 1 )
         {
@@ -119,7 +516,7 @@ static int sum_(const T* src0, const uchar* mask, ST* dst, int len, int cn )
             dst[k+2] = s2;
             dst[k+3] = s3;
         }
-        return len;
+        return len0;
     }
 
     int i, nzm = 0;
@@ -211,7 +608,7 @@ static SumFunc sumTab[] =
 template<typename T>
 static int countNonZero_(const T* src, int len )
 {
-    int i=0, nz = 0;
+    int nz = 0, i = vCountNonZero(src, len, nz);
     #if CV_ENABLE_UNROLLED
     for(; i <= len - 4; i += 4 )
         nz += (src[i] != 0) + (src[i+1] != 0) + (src[i+2] != 0) + (src[i+3] != 0);
@@ -254,7 +651,9 @@ static int sumsqr_(const T* src0, const uchar* mask, ST* sum, SQT* sqsum, int le
 
     if( !mask )
     {
-        int i;
+        int i = vSumSqr(src0, sum, sqsum, len, cn), len0 = len;
+        src = src0 += i*cn;
+        len -= i;
         int k = cn % 4;
 
         if( k == 1 )
@@ -317,7 +716,7 @@ static int sumsqr_(const T* src0, const uchar* mask, ST* sum, SQT* sqsum, int le
             sqsum[k] = sq0; sqsum[k+1] = sq1;
             sqsum[k+2] = sq2; sqsum[k+3] = sq3;
         }
-        return len;
+        return len0;
     }
 
     int i, nzm = 0;
@@ -400,203 +799,347 @@ static SumSqrFunc sumSqrTab[] =
     (SumSqrFunc)sqsum32s, (SumSqrFunc)GET_OPTIMIZED(sqsum32f), (SumSqrFunc)sqsum64f, 0
 };
 
-}
 
-cv::Scalar cv::sum( InputArray _src )
+/****************************************************************************************\
+*                                   parallel stripes                                     *
+\****************************************************************************************/
+
+/*
+ The reductions split the arrays into stripes of about REDUCE_STRIPE_SIZE elements, compute the
+ partial results of the stripes in parallel and combine them in the stripe order. The stripe layout
+ depends only on the array size, not on the number of threads, so the results do not depend on
+ setNumThreads(). For the integer types the partial results are exact, so they are also bitwise
+ identical to the ones computed in a single pass.
+*/
+enum { REDUCE_STRIPE_SIZE = 1 << 16 };
+
+class ReduceStripes
 {
-    Mat src = _src.getMat();
-    int k, cn = src.channels(), depth = src.depth();
-    SumFunc func = sumTab[depth];
+public:
+    // the arrays must be of the same size; the empty ones (e.g. the optional mask) are passed through
+    ReduceStripes( const Mat& a, const Mat& b=Mat(), const Mat& c=Mat() )
+    {
+        const Mat* src[] = { &a, &b, &c };
+        bool plain = a.total() <= (size_t)INT_MAX;
+        int j;
+
+        // the 2D arrays are split by rows (or by columns, when there is just one row);
+        // the continuous n-dimensional ones are viewed as a single row
+        for( j = 0; j < 3; j++ )
+            if( !src[j]->empty() && src[j]->dims > 2 && !src[j]->isContinuous() )
+                plain = false;
+        for( j = 0; j < 3; j++ )
+            arrays[j] = !plain || src[j]->empty() || src[j]->dims <= 2 ? *src[j] :
+                Mat(1, (int)src[j]->total(), src[j]->type(), src[j]->data);
+
+        for( j = 1; j < 3; j++ )
+            CV_Assert( src[j]->empty() || src[j]->size == a.size );
+
+        const Mat& m = arrays[0];
+        int cn = m.channels();
+        nstripes = 1;
+        byRows = m.rows > 1;
+        stripeSize = byRows ? m.rows : m.cols;
+        if( plain && !m.empty() )
+        {
+            stripeSize = byRows ? std::max(REDUCE_STRIPE_SIZE/(m.cols*cn), 1) :
+                                  std::max(REDUCE_STRIPE_SIZE/cn, 1);
+            nstripes = ((byRows ? m.rows : m.cols) + stripeSize - 1)/stripeSize;
+        }
+    }
 
-    CV_Assert( cn <= 4 && func != 0 );
+    int count() const { return nstripes; }
 
-    const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1];
-    NAryMatIterator it(arrays, ptrs);
-    Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    size_t esz = 0;
-    bool blockSum = depth < CV_32S;
+    // returns the i-th stripe of the j-th array
+    Mat get( int j, int i ) const
+    {
+        const Mat& m = arrays[j];
+        if( nstripes == 1 || m.empty() )
+            return m;
+        Range r(i*stripeSize, std::min((i+1)*stripeSize, byRows ? m.rows : m.cols));
+        return byRows ? m.rowRange(r) : m.colRange(r);
+    }
 
-    if( blockSum )
+    // returns the index of the first element of the i-th stripe in the array
+    size_t offset( int i ) const
     {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf;
+        return nstripes == 1 ? 0 : byRows ? (size_t)i*stripeSize*arrays[0].cols : (size_t)i*stripeSize;
+    }
 
-        for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
+protected:
+    Mat arrays[3];
+    bool byRows;
+    int stripeSize, nstripes;
+};
+
+/*
+ Computes Op::result_type for every stripe. Op implements
+ void operator()(const Mat& a, const Mat& b, const Mat& c, size_t offset, result_type& result) const.
+*/
+template<class Op> class ReduceStripesInvoker : public ParallelLoopBody
+{
+public:
+    typedef typename Op::result_type RT;
+
+    ReduceStripesInvoker( const ReduceStripes& _stripes, const Op& _op, RT* _results )
+        : stripes(&_stripes), op(&_op), results(_results) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+            (*op)(stripes->get(0, i), stripes->get(1, i), stripes->get(2, i), stripes->offset(i), results[i]);
     }
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
+private:
+    const ReduceStripes* stripes;
+    const Op* op;
+    RT* results;
+};
+
+template<class Op> static void
+reduceStripes( const ReduceStripes& stripes, const Op& op, vector<typename Op::result_type>& results )
+{
+    results.resize(stripes.count());
+    parallel_for_(BlockedRange(0, stripes.count()), ReduceStripesInvoker<Op>(stripes, op, &results[0]));
+}
+
+struct SumResult
+{
+    SumResult() : nz(0) {}
+    Scalar s;
+    size_t nz;
+};
+
+// the sum of the elements of the stripe (of the ones selected by the mask, if any)
+struct SumOp
+{
+    typedef SumResult result_type;
+
+    void operator()( const Mat& src, const Mat& mask, const Mat&, size_t, SumResult& r ) const
     {
-        for( j = 0; j < total; j += blockSize )
+        int k, cn = src.channels(), depth = src.depth();
+        SumFunc func = sumTab[depth];
+
+        const Mat* arrays[] = {&src, &mask, 0};
+        uchar* ptrs[2];
+        NAryMatIterator it(arrays, ptrs);
+        Scalar& s = r.s;
+        int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
+        int j, count = 0;
+        AutoBuffer<int> _buf;
+        int* buf = (int*)&s[0];
+        bool blockSum = depth <= CV_16S;
+        size_t esz = 0, nz0 = 0;
+
+        if( blockSum )
+        {
+            intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
+            blockSize = std::min(blockSize, intSumBlockSize);
+            _buf.allocate(cn);
+            buf = _buf;
+
+            for( k = 0; k < cn; k++ )
+                buf[k] = 0;
+            esz = src.elemSize();
+        }
+
+        for( size_t i = 0; i < it.nplanes; i++, ++it )
         {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], 0, (uchar*)buf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+            for( j = 0; j < total; j += blockSize )
             {
-                for( k = 0; k < cn; k++ )
+                int bsz = std::min(total - j, blockSize);
+                int nz = func( ptrs[0], ptrs[1], (uchar*)buf, bsz, cn );
+                count += nz;
+                nz0 += nz;
+                if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
                 {
-                    s[k] += buf[k];
-                    buf[k] = 0;
+                    for( k = 0; k < cn; k++ )
+                    {
+                        s[k] += buf[k];
+                        buf[k] = 0;
+                    }
+                    count = 0;
                 }
-                count = 0;
+                ptrs[0] += bsz*esz;
+                if( ptrs[1] )
+                    ptrs[1] += bsz;
             }
-            ptrs[0] += bsz*esz;
         }
+        r.nz = nz0;
     }
-    return s;
-}
+};
 
-int cv::countNonZero( InputArray _src )
+static SumResult sumStripes( const Mat& src, const Mat& mask )
 {
-    Mat src = _src.getMat();
-    CountNonZeroFunc func = countNonZeroTab[src.depth()];
-
-    CV_Assert( src.channels() == 1 && func != 0 );
+    ReduceStripes stripes(src, mask);
+    vector<SumResult> results;
+    reduceStripes(stripes, SumOp(), results);
 
-    const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1];
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, nz = 0;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        nz += func( ptrs[0], total );
-
-    return nz;
+    SumResult r;
+    for( size_t i = 0; i < results.size(); i++ )
+    {
+        r.s += results[i].s;
+        r.nz += results[i].nz;
+    }
+    return r;
 }
 
-cv::Scalar cv::mean( InputArray _src, InputArray _mask )
+struct CountNonZeroOp
 {
-    Mat src = _src.getMat(), mask = _mask.getMat();
-    CV_Assert( mask.empty() || mask.type() == CV_8U );
+    typedef int result_type;
 
-    int k, cn = src.channels(), depth = src.depth();
-    SumFunc func = sumTab[depth];
+    void operator()( const Mat& src, const Mat&, const Mat&, size_t, int& nz ) const
+    {
+        CountNonZeroFunc func = countNonZeroTab[src.depth()];
+        const Mat* arrays[] = {&src, 0};
+        uchar* ptrs[1];
+        NAryMatIterator it(arrays, ptrs);
+        int total = (int)it.size;
 
-    CV_Assert( cn <= 4 && func != 0 );
+        nz = 0;
+        for( size_t i = 0; i < it.nplanes; i++, ++it )
+            nz += func( ptrs[0], total );
+    }
+};
 
-    const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    bool blockSum = depth <= CV_16S;
-    size_t esz = 0, nz0 = 0;
+// the sums and the sums of squares of the channels, followed by the number of the processed pixels
+struct SumSqrOp
+{
+    typedef vector<double> result_type;
 
-    if( blockSum )
+    void operator()( const Mat& src, const Mat& mask, const Mat&, size_t, vector<double>& r ) const
     {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf;
+        int k, cn = src.channels(), depth = src.depth();
+        SumSqrFunc func = sumSqrTab[depth];
+
+        const Mat* arrays[] = {&src, &mask, 0};
+        uchar* ptrs[2];
+        NAryMatIterator it(arrays, ptrs);
+        int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
+        int j, count = 0;
+        size_t nz0 = 0;
+        AutoBuffer<double> _buf(cn*4);
+        double *s = (double*)_buf, *sq = s + cn;
+        int *sbuf = (int*)s, *sqbuf = (int*)sq;
+        bool blockSum = depth <= CV_16S, blockSqSum = depth <= CV_8S;
+        size_t esz = 0;
 
         for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
-    }
+            s[k] = sq[k] = 0;
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
+        if( blockSum )
+        {
+            intSumBlockSize = 1 << 15;
+            blockSize = std::min(blockSize, intSumBlockSize);
+            sbuf = (int*)(sq + cn);
+            if( blockSqSum )
+                sqbuf = sbuf + cn;
+            for( k = 0; k < cn; k++ )
+                sbuf[k] = sqbuf[k] = 0;
+            esz = src.elemSize();
+        }
+
+        for( size_t i = 0; i < it.nplanes; i++, ++it )
         {
-            int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)buf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+            for( j = 0; j < total; j += blockSize )
             {
-                for( k = 0; k < cn; k++ )
+                int bsz = std::min(total - j, blockSize);
+                int nz = func( ptrs[0], ptrs[1], (uchar*)sbuf, (uchar*)sqbuf, bsz, cn );
+                count += nz;
+                nz0 += nz;
+                if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
                 {
-                    s[k] += buf[k];
-                    buf[k] = 0;
+                    for( k = 0; k < cn; k++ )
+                    {
+                        s[k] += sbuf[k];
+                        sbuf[k] = 0;
+                    }
+                    if( blockSqSum )
+                    {
+                        for( k = 0; k < cn; k++ )
+                        {
+                            sq[k] += sqbuf[k];
+                            sqbuf[k] = 0;
+                        }
+                    }
+                    count = 0;
                 }
-                count = 0;
+                ptrs[0] += bsz*esz;
+                if( ptrs[1] )
+                    ptrs[1] += bsz;
             }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
         }
+
+        r.assign(s, s + cn*2);
+        r.push_back((double)nz0);
     }
-    return s*(nz0 ? 1./nz0 : 0);
+};
+
 }
 
+cv::Scalar cv::sum( InputArray _src )
+{
+    Mat src = _src.getMat();
+    int cn = src.channels(), depth = src.depth();
+
+    CV_Assert( cn <= 4 && sumTab[depth] != 0 );
 
-void cv::meanStdDev( InputArray _src, OutputArray _mean, OutputArray _sdv, InputArray _mask )
+    return sumStripes(src, Mat()).s;
+}
+
+int cv::countNonZero( InputArray _src )
+{
+    Mat src = _src.getMat();
+
+    CV_Assert( src.channels() == 1 && countNonZeroTab[src.depth()] != 0 );
+
+    ReduceStripes stripes(src);
+    vector<int> results;
+    reduceStripes(stripes, CountNonZeroOp(), results);
+
+    int nz = 0;
+    for( size_t i = 0; i < results.size(); i++ )
+        nz += results[i];
+    return nz;
+}
+
+cv::Scalar cv::mean( InputArray _src, InputArray _mask )
 {
     Mat src = _src.getMat(), mask = _mask.getMat();
     CV_Assert( mask.empty() || mask.type() == CV_8U );
 
-    int k, cn = src.channels(), depth = src.depth();
-    SumSqrFunc func = sumSqrTab[depth];
+    int cn = src.channels(), depth = src.depth();
 
-    CV_Assert( func != 0 );
+    CV_Assert( cn <= 4 && sumTab[depth] != 0 );
 
-    const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0, nz0 = 0;
-    AutoBuffer<double> _buf(cn*4);
-    double *s = (double*)_buf, *sq = s + cn;
-    int *sbuf = (int*)s, *sqbuf = (int*)sq;
-    bool blockSum = depth <= CV_16S, blockSqSum = depth <= CV_8S;
-    size_t esz = 0;
+    SumResult r = sumStripes(src, mask);
+    return r.s*(r.nz ? 1./r.nz : 0);
+}
 
-    for( k = 0; k < cn; k++ )
-        s[k] = sq[k] = 0;
 
-    if( blockSum )
-    {
-        intSumBlockSize = 1 << 15;
-        blockSize = std::min(blockSize, intSumBlockSize);
-        sbuf = (int*)(sq + cn);
-        if( blockSqSum )
-            sqbuf = sbuf + cn;
-        for( k = 0; k < cn; k++ )
-            sbuf[k] = sqbuf[k] = 0;
-        esz = src.elemSize();
-    }
+void cv::meanStdDev( InputArray _src, OutputArray _mean, OutputArray _sdv, InputArray _mask )
+{
+    Mat src = _src.getMat(), mask = _mask.getMat();
+    CV_Assert( mask.empty() || mask.type() == CV_8U );
+
+    int j, k, cn = src.channels(), depth = src.depth();
+
+    CV_Assert( sumSqrTab[depth] != 0 );
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    ReduceStripes stripes(src, mask);
+    vector<vector<double> > results;
+    reduceStripes(stripes, SumSqrOp(), results);
+
+    AutoBuffer<double> _buf(cn*2);
+    double *s = (double*)_buf, *sq = s + cn, nz0 = 0;
+
+    for( k = 0; k < cn*2; k++ )
+        s[k] = 0;
+    for( size_t i = 0; i < results.size(); i++ )
     {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)sbuf, (uchar*)sqbuf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    s[k] += sbuf[k];
-                    sbuf[k] = 0;
-                }
-                if( blockSqSum )
-                {
-                    for( k = 0; k < cn; k++ )
-                    {
-                        sq[k] += sqbuf[k];
-                        sqbuf[k] = 0;
-                    }
-                }
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
-        }
+        for( k = 0; k < cn*2; k++ )
+            s[k] += results[i][k];
+        nz0 += results[i][cn*2];
     }
 
     double scale = nz0 ? 1./nz0 : 0.;
@@ -643,7 +1186,7 @@ minMaxIdx_( const T* src, const uchar* mask, WT* _minVal, WT* _maxVal,
 
     if( !mask )
     {
-        for( int i = 0; i < len; i++ )
+        for( int i = vMinMax(src, len, minVal, maxVal, minIdx, maxIdx, startIdx); i < len; i++ )
         {
             T val = src[i];
             if( val < minVal )
@@ -741,6 +1284,54 @@ static void ofs2idx(const Mat& a, size_t ofs, int* idx)
     }
 }
 
+struct MinMaxResult
+{
+    double minVal, maxVal;
+    size_t minIdx, maxIdx;
+};
+
+// the extrema of the stripe and their 1-based indices in the whole array (0 if there are none)
+struct MinMaxOp
+{
+    typedef MinMaxResult result_type;
+
+    void operator()( const Mat& src, const Mat& mask, const Mat&, size_t offset, MinMaxResult& r ) const
+    {
+        int depth = src.depth(), cn = src.channels();
+        MinMaxIdxFunc func = minmaxTab[depth];
+
+        const Mat* arrays[] = {&src, &mask, 0};
+        uchar* ptrs[2];
+        NAryMatIterator it(arrays, ptrs);
+
+        size_t minidx = 0, maxidx = 0;
+        int iminval = INT_MAX, imaxval = INT_MIN;
+        float fminval = FLT_MAX, fmaxval = -FLT_MAX;
+        double dminval = DBL_MAX, dmaxval = -DBL_MAX;
+        size_t startidx = offset*cn + 1;
+        int *minval = &iminval, *maxval = &imaxval;
+        int planeSize = (int)it.size*cn;
+
+        if( depth == CV_32F )
+            minval = (int*)&fminval, maxval = (int*)&fmaxval;
+        else if( depth == CV_64F )
+            minval = (int*)&dminval, maxval = (int*)&dmaxval;
+
+        for( size_t i = 0; i < it.nplanes; i++, ++it, startidx += planeSize )
+            func( ptrs[0], ptrs[1], minval, maxval, &minidx, &maxidx, planeSize, startidx );
+
+        if( depth == CV_32F )
+            dminval = fminval, dmaxval = fmaxval;
+        else if( depth <= CV_32S )
+            dminval = iminval, dmaxval = imaxval;
+
+        r.minVal = dminval;
+        r.maxVal = dmaxval;
+        r.minIdx = minidx;
+        r.maxIdx = maxidx;
+    }
+};
+
 }
 
 void cv::minMaxIdx(InputArray _src, double* minVal,
@@ -752,35 +1343,26 @@ void cv::minMaxIdx(InputArray _src, double* minVal,
 
     CV_Assert( (cn == 1 && (mask.empty() || mask.type() == CV_8U)) ||
                (cn >= 1 && mask.empty() && !minIdx && !maxIdx) );
-    MinMaxIdxFunc func = minmaxTab[depth];
-    CV_Assert( func != 0 );
+    CV_Assert( minmaxTab[depth] != 0 );
 
-    const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
+    ReduceStripes stripes(src, mask);
+    vector<MinMaxResult> results;
+    reduceStripes(stripes, MinMaxOp(), results);
 
+    // the strict comparisons keep the first of the equal extrema, as in the single pass
     size_t minidx = 0, maxidx = 0;
-    int iminval = INT_MAX, imaxval = INT_MIN;
-    float fminval = FLT_MAX, fmaxval = -FLT_MAX;
-    double dminval = DBL_MAX, dmaxval = -DBL_MAX;
-    size_t startidx = 1;
-    int *minval = &iminval, *maxval = &imaxval;
-    int planeSize = (int)it.size*cn;
-
-    if( depth == CV_32F )
-        minval = (int*)&fminval, maxval = (int*)&fmaxval;
-    else if( depth == CV_64F )
-        minval = (int*)&dminval, maxval = (int*)&dmaxval;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it, startidx += planeSize )
-        func( ptrs[0], ptrs[1], minval, maxval, &minidx, &maxidx, planeSize, startidx );
+    double dminval = results[0].minVal, dmaxval = results[0].maxVal;
+    for( size_t i = 0; i < results.size(); i++ )
+    {
+        const MinMaxResult& r = results[i];
+        if( r.minIdx != 0 && (minidx == 0 || r.minVal < dminval) )
+            dminval = r.minVal, minidx = r.minIdx;
+        if( r.maxIdx != 0 && (maxidx == 0 || r.maxVal > dmaxval) )
+            dmaxval = r.maxVal, maxidx = r.maxIdx;
+    }
 
     if( minidx == 0 )
         dminval = dmaxval = 0;
-    else if( depth == CV_32F )
-        dminval = fminval, dmaxval = fmaxval;
-    else if( depth <= CV_32S )
-        dminval = iminval, dmaxval = imaxval;
 
     if( minVal )
         *minVal = dminval;
@@ -1070,7 +1652,8 @@ normInf_(const T* src, const uchar* mask, ST* _result, int len, int cn)
     ST result = *_result;
     if( !mask )
     {
-        result = std::max(result, normInf<T, ST>(src, len*cn));
+        int i = vNormInf(src, len*cn, result);
+        result = std::max(result, normInf<T, ST>(src + i, len*cn - i));
     }
     else
     {
@@ -1091,7 +1674,8 @@ normL1_(const T* src, const uchar* mask, ST* _result, int len, int cn)
     ST result = *_result;
     if( !mask )
     {
-        result += normL1<T, ST>(src, len*cn);
+        int i = vNormL1(src, len*cn, result);
+        result += normL1<T, ST>(src + i, len*cn - i);
     }
     else
     {
@@ -1112,7 +1696,8 @@ normL2_(const T* src, const uchar* mask, ST* _result, int len, int cn)
     ST result = *_result;
     if( !mask )
     {
-        result += normL2Sqr<T, ST>(src, len*cn);
+        int i = vNormL2(src, len*cn, result);
+        result += normL2Sqr<T, ST>(src + i, len*cn - i);
     }
     else
     {
@@ -1136,7 +1721,8 @@ normDiffInf_(const T* src1, const T* src2, const uchar* mask, ST* _result, int l
     ST result = *_result;
     if( !mask )
     {
-        result = std::max(result, normInf<T, ST>(src1, src2, len*cn));
+        int i = vNormDiffInf(src1, src2, len*cn, result);
+        result = std::max(result, normInf<T, ST>(src1 + i, src2 + i, len*cn - i));
     }
     else
     {
@@ -1178,7 +1764,8 @@ normDiffL2_(const T* src1, const T* src2, const uchar* mask, ST* _result, int le
     ST result = *_result;
     if( !mask )
     {
-        result += normL2Sqr<T, ST>(src1, src2, len*cn);
+        int i = vNormDiffL2(src1, src2, len*cn, result);
+        result += normL2Sqr<T, ST>(src1 + i, src2 + i, len*cn - i);
     }
     else
     {
@@ -1259,6 +1846,195 @@ static NormDiffFunc normDiffTab[3][8] =
     }
 };
 
+// the norm of the stripe: the maximum for NORM_INF, the sum (of squares for NORM_L2*) otherwise
+struct NormOp
+{
+    typedef double result_type;
+
+    NormOp( int _normType ) : normType(_normType) {}
+
+    void operator()( const Mat& src, const Mat& mask, const Mat&, size_t, double& r ) const
+    {
+        int depth = src.depth(), cn = src.channels();
+
+        if( normType == NORM_HAMMING || normType == NORM_HAMMING2 )
+        {
+            int cellSize = normType == NORM_HAMMING ? 1 : 2;
+
+            const Mat* arrays[] = {&src, 0};
+            uchar* ptrs[1];
+            NAryMatIterator it(arrays, ptrs);
+            int total = (int)it.size;
+            int result = 0;
+
+            for( size_t i = 0; i < it.nplanes; i++, ++it )
+                result += normHamming(ptrs[0], total, cellSize);
+
+            r = result;
+            return;
+        }
+
+        NormFunc func = normTab[normType >> 1][depth];
+
+        const Mat* arrays[] = {&src, &mask, 0};
+        uchar* ptrs[2];
+        union
+        {
+            double d;
+            int i;
+            float f;
+        }
+        result;
+        result.d = 0;
+        NAryMatIterator it(arrays, ptrs);
+        int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
+        bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
+                ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
+        int isum = 0;
+        int *ibuf = &result.i;
+        size_t esz = 0;
+
+        if( blockSum )
+        {
+            intSumBlockSize = (normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15))/cn;
+            blockSize = std::min(blockSize, intSumBlockSize);
+            ibuf = &isum;
+            esz = src.elemSize();
+        }
+
+        for( size_t i = 0; i < it.nplanes; i++, ++it )
+        {
+            for( j = 0; j < total; j += blockSize )
+            {
+                int bsz = std::min(total - j, blockSize);
+                func( ptrs[0], ptrs[1], (uchar*)ibuf, bsz, cn );
+                count += bsz;
+                if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+                {
+                    result.d += isum;
+                    isum = 0;
+                    count = 0;
+                }
+                ptrs[0] += bsz*esz;
+                if( ptrs[1] )
+                    ptrs[1] += bsz;
+            }
+        }
+
+        if( normType == NORM_INF )
+        {
+            if( depth == CV_64F )
+                ;
+            else if( depth == CV_32F )
+                result.d = result.f;
+            else
+                result.d = result.i;
+        }
+        r = result.d;
+    }
+
+    int normType;
+};
+
+struct NormDiffOp
+{
+    typedef double result_type;
+
+    NormDiffOp( int _normType ) : normType(_normType) {}
+
+    void operator()( const Mat& src1, const Mat& src2, const Mat& mask, size_t, double& r ) const
+    {
+        int depth = src1.depth(), cn = src1.channels();
+
+        if( normType == NORM_HAMMING || normType == NORM_HAMMING2 )
+        {
+            int cellSize = normType == NORM_HAMMING ? 1 : 2;
+
+            const Mat* arrays[] = {&src1, &src2, 0};
+            uchar* ptrs[2];
+            NAryMatIterator it(arrays, ptrs);
+            int total = (int)it.size;
+            int result = 0;
+
+            for( size_t i = 0; i < it.nplanes; i++, ++it )
+                result += normHamming(ptrs[0], ptrs[1], total, cellSize);
+
+            r = result;
+            return;
+        }
+
+        NormDiffFunc func = normDiffTab[normType >> 1][depth];
+
+        const Mat* arrays[] = {&src1, &src2, &mask, 0};
+        uchar* ptrs[3];
+        union
+        {
+            double d;
+            float f;
+            int i;
+            unsigned u;
+        }
+        result;
+        result.d = 0;
+        NAryMatIterator it(arrays, ptrs);
+        int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
+        bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
+                ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
+        unsigned isum = 0;
+        unsigned *ibuf = &result.u;
+        size_t esz = 0;
+
+        if( blockSum )
+        {
+            intSumBlockSize = normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15);
+            blockSize = std::min(blockSize, intSumBlockSize);
+            ibuf = &isum;
+            esz = src1.elemSize();
+        }
+
+        for( size_t i = 0; i < it.nplanes; i++, ++it )
+        {
+            for( j = 0; j < total; j += blockSize )
+            {
+                int bsz = std::min(total - j, blockSize);
+                func( ptrs[0], ptrs[1], ptrs[2], (uchar*)ibuf, bsz, cn );
+                count += bsz;
+                if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+                {
+                    result.d += isum;
+                    isum = 0;
+                    count = 0;
+                }
+                ptrs[0] += bsz*esz;
+                ptrs[1] += bsz*esz;
+                if( ptrs[2] )
+                    ptrs[2] += bsz;
+            }
+        }
+
+        if( normType == NORM_INF )
+        {
+            if( depth == CV_64F )
+                ;
+            else if( depth == CV_32F )
+                result.d = result.f;
+            else
+                result.d = result.u;
+        }
+        r = result.d;
+    }
+
+    int normType;
+};
+
+static double combineNorms( const vector<double>& results, int normType )
+{
+    double r = 0;
+    for( size_t i = 0; i < results.size(); i++ )
+        r = normType == NORM_INF ? std::max(r, results[i]) : r + results[i];
+    return normType == NORM_L2 ? std::sqrt(r) : r;
+}
+
 }
 
 double cv::norm( InputArray _src, int normType, InputArray _mask )
@@ -1273,7 +2049,7 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
     if( src.isContinuous() && mask.empty() )
     {
         size_t len = src.total()*cn;
-        if( len == (size_t)(int)len )
+        if( len <= (size_t)REDUCE_STRIPE_SIZE )
         {
             if( depth == CV_32F )
             {
@@ -1327,81 +2103,14 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
             bitwise_and(src, mask, temp);
             return norm(temp, normType);
         }
-        int cellSize = normType == NORM_HAMMING ? 1 : 2;
-
-        const Mat* arrays[] = {&src, 0};
-        uchar* ptrs[1];
-        NAryMatIterator it(arrays, ptrs);
-        int total = (int)it.size;
-        int result = 0;
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-            result += normHamming(ptrs[0], total, cellSize);
-
-        return result;
-    }
-
-    NormFunc func = normTab[normType >> 1][depth];
-    CV_Assert( func != 0 );
-
-    const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    union
-    {
-        double d;
-        int i;
-        float f;
-    }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
-    bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
-            ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
-    int isum = 0;
-    int *ibuf = &result.i;
-    size_t esz = 0;
-
-    if( blockSum )
-    {
-        intSumBlockSize = (normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15))/cn;
-        blockSize = std::min(blockSize, intSumBlockSize);
-        ibuf = &isum;
-        esz = src.elemSize();
-    }
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], ptrs[1], (uchar*)ibuf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                result.d += isum;
-                isum = 0;
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
-        }
     }
 
-    if( normType == NORM_INF )
-    {
-        if( depth == CV_64F )
-            ;
-        else if( depth == CV_32F )
-            result.d = result.f;
-        else
-            result.d = result.i;
-    }
-    else if( normType == NORM_L2 )
-        result.d = std::sqrt(result.d);
+    CV_Assert( normType == NORM_HAMMING || normType == NORM_HAMMING2 || normTab[normType >> 1][depth] != 0 );
 
-    return result.d;
+    ReduceStripes stripes(src, mask);
+    vector<double> results;
+    reduceStripes(stripes, NormOp(normType), results);
+    return combineNorms(results, normType);
 }
 
 
@@ -1411,7 +2120,7 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
         return norm(_src1, _src2, normType & ~CV_RELATIVE, _mask)/(norm(_src2, normType, _mask) + DBL_EPSILON);
 
     Mat src1 = _src1.getMat(), src2 = _src2.getMat(), mask = _mask.getMat();
-    int depth = src1.depth(), cn = src1.channels();
+    int depth = src1.depth();
 
     CV_Assert( src1.size == src2.size && src1.type() == src2.type() );
 
@@ -1422,7 +2131,7 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     if( src1.isContinuous() && src2.isContinuous() && mask.empty() )
     {
         size_t len = src1.total()*src1.channels();
-        if( len == (size_t)(int)len )
+        if( len <= (size_t)REDUCE_STRIPE_SIZE )
         {
             if( src1.depth() == CV_32F )
             {
@@ -1468,83 +2177,14 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
             bitwise_and(temp, mask, temp);
             return norm(temp, normType);
         }
-        int cellSize = normType == NORM_HAMMING ? 1 : 2;
-
-        const Mat* arrays[] = {&src1, &src2, 0};
-        uchar* ptrs[2];
-        NAryMatIterator it(arrays, ptrs);
-        int total = (int)it.size;
-        int result = 0;
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-            result += normHamming(ptrs[0], ptrs[1], total, cellSize);
-
-        return result;
-    }
-
-    NormDiffFunc func = normDiffTab[normType >> 1][depth];
-    CV_Assert( func != 0 );
-
-    const Mat* arrays[] = {&src1, &src2, &mask, 0};
-    uchar* ptrs[3];
-    union
-    {
-        double d;
-        float f;
-        int i;
-        unsigned u;
-    }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
-    bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
-            ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
-    unsigned isum = 0;
-    unsigned *ibuf = &result.u;
-    size_t esz = 0;
-
-    if( blockSum )
-    {
-        intSumBlockSize = normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        ibuf = &isum;
-        esz = src1.elemSize();
     }
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], ptrs[1], ptrs[2], (uchar*)ibuf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                result.d += isum;
-                isum = 0;
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            ptrs[1] += bsz*esz;
-            if( ptrs[2] )
-                ptrs[2] += bsz;
-        }
-    }
-
-    if( normType == NORM_INF )
-    {
-        if( depth == CV_64F )
-            ;
-        else if( depth == CV_32F )
-            result.d = result.f;
-        else
-            result.d = result.u;
-    }
-    else if( normType == NORM_L2 )
-        result.d = std::sqrt(result.d);
+    CV_Assert( normType == NORM_HAMMING || normType == NORM_HAMMING2 || normDiffTab[normType >> 1][depth] != 0 );
 
-    return result.d;
+    ReduceStripes stripes(src1, src2, mask);
+    vector<double> results;
+    reduceStripes(stripes, NormDiffOp(normType), results);
+    return combineNorms(results, normType);
 }
 
 
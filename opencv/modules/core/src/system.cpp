@@ -79,10 +79,6 @@
 
 #endif
 
-#ifdef _OPENMP
-#include "omp.h"
-#endif
-
 #include <stdarg.h>
 
 #if defined __linux__ || defined __APPLE__
@@ -174,12 +170,67 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_1] = (cpuid_data[2] & (1<<19)) != 0;
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
-            f.have[CV_CPU_AVX]    = (cpuid_data[2] & (1<<28)) != 0;
+            // AVX state must be enabled by OS (OSXSAVE bit and XCR0 bits 1 and 2)
+            bool avx_os = (cpuid_data[2] & (1<<27)) != 0 && (xgetbv0() & 6) == 6;
+            f.have[CV_CPU_AVX]    = (cpuid_data[2] & (1<<28)) != 0 && avx_os;
+            f.have[CV_CPU_FMA3]   = (cpuid_data[2] & (1<<12)) != 0 && avx_os;
+            f.have[CV_CPU_F16C]   = (cpuid_data[2] & (1<<29)) != 0 && avx_os;
+
+            int cpuid7[4] = { 0, 0, 0, 0 };
+            cpuid(cpuid7, 0);
+            if( cpuid7[0] >= 7 )
+            {
+                cpuid(cpuid7, 7);
+                f.have[CV_CPU_AVX2] = (cpuid7[1] & (1<<5)) != 0 && avx_os;
+            }
         }
 
         return f;
     }
 
+    // cpuid with the specified leaf (eax) and zero subleaf (ecx)
+    static void cpuid(int* cpuid_data, int leaf)
+    {
+    #if defined _MSC_VER && _MSC_VER >= 1600 && (defined _M_IX86 || defined _M_X64)
+        __cpuidex(cpuid_data, leaf, 0);
+    #elif defined __GNUC__ && defined __x86_64__
+        asm __volatile__
+        (
+         "cpuid\n\t"
+         : "=a"(cpuid_data[0]), "=b"(cpuid_data[1]), "=c"(cpuid_data[2]), "=d"(cpuid_data[3])
+         : "a"(leaf), "c"(0)
+         : "cc"
+        );
+    #elif defined __GNUC__ && defined __i386__
+        asm volatile
+        (
+         "movl %%ebx, %%esi\n\t"
+         "cpuid\n\t"
+         "xchgl %%ebx, %%esi\n\t"
+         : "=a"(cpuid_data[0]), "=S"(cpuid_data[1]), "=c"(cpuid_data[2]), "=d"(cpuid_data[3])
+         : "a"(leaf), "c"(0)
+         : "cc"
+        );
+    #else
+        (void)leaf;
+        cpuid_data[0] = cpuid_data[1] = cpuid_data[2] = cpuid_data[3] = 0;
+    #endif
+    }
+
+    // the lower 32 bits of XCR0; must only be called when OSXSAVE is set
+    static unsigned xgetbv0()
+    {
+    #if defined _MSC_VER && _MSC_VER >= 1600 && (defined _M_IX86 || defined _M_X64)
+        return (unsigned)_xgetbv(0);
+    #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+        unsigned eax, edx;
+        asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+        return eax;
+    #else
+        return 0;
+    #endif
+    }
+
     int x86_family;
     bool have[MAX_FEATURE+1];
 };
@@ -205,12 +256,14 @@ IPPInitializer ippInitializer;
 #endif
 
 volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
+volatile bool USE_AVX2 = featuresEnabled.have[CV_CPU_AVX2] && featuresEnabled.have[CV_CPU_FMA3];
 
 void setUseOptimized( bool flag )
 {
     useOptimizedFlag = flag;
     currentFeatures = flag ? &featuresEnabled : &featuresDisabled;
     USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    USE_AVX2 = currentFeatures->have[CV_CPU_AVX2] && currentFeatures->have[CV_CPU_FMA3];
 }
 
 bool useOptimized(void)
@@ -327,53 +380,6 @@ int64 getCPUTickCount(void)
 #endif
 
 
-static int numThreads = 0;
-static int numProcs   = 0;
-
-int getNumThreads(void)
-{
-    if( !numProcs )
-        setNumThreads(0);
-    return numThreads;
-}
-
-void setNumThreads( int
-#ifdef _OPENMP
-                             threads
-#endif
-                  )
-{
-    if( !numProcs )
-    {
-#ifdef _OPENMP
-        numProcs = omp_get_num_procs();
-#else
-        numProcs = 1;
-#endif
-    }
-
-#ifdef _OPENMP
-    if( threads <= 0 )
-        threads = numProcs;
-    else
-        threads = MIN( threads, numProcs );
-
-    numThreads = threads;
-#else
-    numThreads = 1;
-#endif
-}
-
-
-int getThreadNum(void)
-{
-#ifdef _OPENMP
-    return omp_get_thread_num();
-#else
-    return 0;
-#endif
-}
-
 #ifdef ANDROID
 static inline int getNumberOfCPUsImpl()
 {
@@ -454,6 +460,61 @@ int getNumberOfCPUs(void)
 #endif
 }
 
+struct Mutex::Impl
+{
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    Impl() { InitializeCriticalSection(&cs); refcount = 1; }
+    ~Impl() { DeleteCriticalSection(&cs); }
+
+    void lock() { EnterCriticalSection(&cs); }
+    bool trylock() { return TryEnterCriticalSection(&cs) != 0; }
+    void unlock() { LeaveCriticalSection(&cs); }
+
+    CRITICAL_SECTION cs;
+#else
+    Impl() { pthread_mutex_init(&mt, 0); refcount = 1; }
+    ~Impl() { pthread_mutex_destroy(&mt); }
+
+    void lock() { pthread_mutex_lock(&mt); }
+    bool trylock() { return pthread_mutex_trylock(&mt) == 0; }
+    void unlock() { pthread_mutex_unlock(&mt); }
+
+    pthread_mutex_t mt;
+#endif
+    int refcount;
+};
+
+Mutex::Mutex()
+{
+    impl = new Mutex::Impl;
+}
+
+Mutex::~Mutex()
+{
+    if( CV_XADD(&impl->refcount, -1) == 1 )
+        delete impl;
+    impl = 0;
+}
+
+Mutex::Mutex(const Mutex& m)
+{
+    impl = m.impl;
+    CV_XADD(&impl->refcount, 1);
+}
+
+Mutex& Mutex::operator = (const Mutex& m)
+{
+    CV_XADD(&m.impl->refcount, 1);
+    if( CV_XADD(&impl->refcount, -1) == 1 )
+        delete impl;
+    impl = m.impl;
+    return *this;
+}
+
+void Mutex::lock() { impl->lock(); }
+void Mutex::unlock() { impl->unlock(); }
+bool Mutex::trylock() { return impl->trylock(); }
+
 const std::string& getBuildInformation()
 {
     static std::string build_info =
@@ -916,6 +977,7 @@ BOOL WINAPI DllMain( HINSTANCE, DWORD  fdwReason, LPVOID )
     {
         cv::deleteThreadAllocData();
         cv::deleteThreadRNGData();
+        cv::releaseThreadTraceBuffer();
     }
     return TRUE;
 }
@@ -0,0 +1,347 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+
+namespace cv
+{
+
+// a closed trace region
+struct TraceEvent
+{
+    const char* name;
+    int64 start, end;
+    int tid;
+};
+
+struct TraceAccum
+{
+    TraceAccum() : count(0), total(0), minTime(0), maxTime(0) {}
+    int64 count, total, minTime, maxTime;
+};
+
+/*
+   The per-thread ring buffer. Only the owner thread writes into it and it never takes a lock: the
+   event is stored first and then published by the atomic increment of the sequence number. The
+   readers copy the events under the registry mutex and drop the ones the owner could overwrite
+   while they were copied. When the thread exits, the buffer is kept (with its events) and is reused
+   by the next new thread.
+*/
+struct TraceBuffer
+{
+    enum { CAPACITY = 1 << 15 };
+
+    TraceBuffer() : events(CAPACITY), seq(0), first(0), tid(0), busy(false) {}
+
+    void add(const char* name, int64 start, int64 end)
+    {
+        TraceEvent& e = events[(unsigned)seq % CAPACITY];
+        e.name = name;
+        e.start = start;
+        e.end = end;
+        e.tid = tid;
+        CV_XADD(&seq, 1);
+    }
+
+    // appends the recorded events to dst; called under the registry mutex
+    void copyTo(vector<TraceEvent>& dst)
+    {
+        unsigned last = (unsigned)CV_XADD(&seq, 0);
+        unsigned n = std::min(last - first, (unsigned)CAPACITY);
+        size_t ofs = dst.size();
+        for( unsigned i = last - n; i != last; i++ )
+            dst.push_back(events[i % CAPACITY]);
+
+        // the owner may have overwritten the oldest events in the meantime
+        unsigned last2 = (unsigned)CV_XADD(&seq, 0);
+        unsigned dropped = std::min(last2 - last, n);
+        dst.erase(dst.begin() + ofs, dst.begin() + ofs + dropped);
+    }
+
+    // forgets the recorded events; called under the registry mutex
+    void reset()
+    {
+        first = (unsigned)CV_XADD(&seq, 0);
+    }
+
+    vector<TraceEvent> events;
+    int seq; // the number of the added events, modulo 2^32
+    unsigned first; // the sequence number of the first event after the last reset
+    int tid;
+    bool busy;
+};
+
+struct TraceRegistry
+{
+    TraceRegistry() : nthreads(0)
+    {
+        const char* env = getenv("OPENCV_TRACE");
+        enabled = env && strcmp(env, "1") == 0;
+    }
+
+    TraceBuffer* acquire()
+    {
+        AutoLock lock(mutex);
+        size_t i = 0;
+        for( ; i < buffers.size(); i++ )
+            if( !buffers[i]->busy )
+                break;
+        if( i == buffers.size() )
+            buffers.push_back(new TraceBuffer);
+        TraceBuffer* buf = buffers[i];
+        buf->busy = true;
+        buf->tid = nthreads++;
+        return buf;
+    }
+
+    void release(TraceBuffer* buf)
+    {
+        AutoLock lock(mutex);
+        buf->busy = false;
+    }
+
+    volatile bool enabled;
+    Mutex mutex;
+    // the buffers are never deleted, so that the regions of the finished threads can be exported
+    vector<TraceBuffer*> buffers;
+    int nthreads;
+};
+
+static TraceRegistry& traceRegistry()
+{
+    static TraceRegistry* registry = new TraceRegistry;
+    return *registry;
+}
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+
+static DWORD tlsTraceKey = TLS_OUT_OF_INDEXES;
+
+void releaseThreadTraceBuffer()
+{
+    if( tlsTraceKey != TLS_OUT_OF_INDEXES )
+    {
+        TraceBuffer* buf = (TraceBuffer*)TlsGetValue( tlsTraceKey );
+        TlsSetValue( tlsTraceKey, 0 );
+        if( buf )
+            traceRegistry().release(buf);
+    }
+}
+
+static TraceBuffer* threadTraceBuffer()
+{
+    if( tlsTraceKey == TLS_OUT_OF_INDEXES )
+    {
+        tlsTraceKey = TlsAlloc();
+        CV_Assert(tlsTraceKey != TLS_OUT_OF_INDEXES);
+    }
+    TraceBuffer* buf = (TraceBuffer*)TlsGetValue( tlsTraceKey );
+    if( !buf )
+    {
+        buf = traceRegistry().acquire();
+        TlsSetValue( tlsTraceKey, buf );
+    }
+    return buf;
+}
+
+#else
+
+static pthread_key_t tlsTraceKey = 0;
+static pthread_once_t tlsTraceKeyOnce = PTHREAD_ONCE_INIT;
+
+static void releaseTraceBuffer(void* buf)
+{
+    traceRegistry().release((TraceBuffer*)buf);
+}
+
+static void makeTraceKey()
+{
+    int errcode = pthread_key_create(&tlsTraceKey, releaseTraceBuffer);
+    CV_Assert(errcode == 0);
+}
+
+static TraceBuffer* threadTraceBuffer()
+{
+    pthread_once(&tlsTraceKeyOnce, makeTraceKey);
+    TraceBuffer* buf = (TraceBuffer*)pthread_getspecific(tlsTraceKey);
+    if( !buf )
+    {
+        buf = traceRegistry().acquire();
+        pthread_setspecific(tlsTraceKey, buf);
+    }
+    return buf;
+}
+
+#endif
+
+TraceRegion::TraceRegion(const char* _name) : name(_name), start(0)
+{
+    if( traceRegistry().enabled )
+        start = getTickCount();
+}
+
+TraceRegion::~TraceRegion()
+{
+    // the regions opened before the tracing was turned on are not recorded
+    if( start != 0 && traceRegistry().enabled )
+        threadTraceBuffer()->add(name, start, getTickCount());
+}
+
+TraceStat::TraceStat() : count(0), totalTime(0), minTime(0), maxTime(0) {}
+
+void setTraceEnabled(bool enabled)
+{
+    traceRegistry().enabled = enabled;
+}
+
+bool isTraceEnabled()
+{
+    return traceRegistry().enabled;
+}
+
+void resetTrace()
+{
+    TraceRegistry& registry = traceRegistry();
+    AutoLock lock(registry.mutex);
+    for( size_t i = 0; i < registry.buffers.size(); i++ )
+        registry.buffers[i]->reset();
+}
+
+static bool cmpTraceStat(const TraceStat& a, const TraceStat& b)
+{
+    return a.totalTime > b.totalTime || (a.totalTime == b.totalTime && a.name < b.name);
+}
+
+static void copyTraceEvents(vector<TraceEvent>& events)
+{
+    TraceRegistry& registry = traceRegistry();
+    AutoLock lock(registry.mutex);
+    for( size_t i = 0; i < registry.buffers.size(); i++ )
+        registry.buffers[i]->copyTo(events);
+}
+
+void getTraceSummary(vector<TraceStat>& stats)
+{
+    vector<TraceEvent> events;
+    copyTraceEvents(events);
+
+    // the different pointers may refer to the same name (e.g. the literals from different modules)
+    std::map<string, TraceAccum> merged;
+    for( size_t i = 0; i < events.size(); i++ )
+    {
+        TraceAccum& a = merged[events[i].name];
+        int64 t = events[i].end - events[i].start;
+        a.minTime = a.count > 0 ? std::min(a.minTime, t) : t;
+        a.maxTime = std::max(a.maxTime, t);
+        a.total += t;
+        a.count++;
+    }
+
+    double scale = 1000./getTickFrequency();
+    stats.clear();
+    for( std::map<string, TraceAccum>::const_iterator it = merged.begin(); it != merged.end(); ++it )
+    {
+        TraceStat s;
+        s.name = it->first;
+        s.count = it->second.count;
+        s.totalTime = it->second.total*scale;
+        s.minTime = it->second.minTime*scale;
+        s.maxTime = it->second.maxTime*scale;
+        stats.push_back(s);
+    }
+    std::sort(stats.begin(), stats.end(), cmpTraceStat);
+}
+
+static void writeJSONString(FILE* f, const char* str)
+{
+    fputc('\"', f);
+    for( ; *str; str++ )
+    {
+        unsigned char c = (unsigned char)*str;
+        if( c == '\"' || c == '\\' )
+            fprintf(f, "\\%c", c);
+        else if( c < ' ' )
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('\"', f);
+}
+
+void writeTrace(const string& filename)
+{
+    vector<TraceEvent> events;
+    copyTraceEvents(events);
+
+    FILE* f = fopen(filename.c_str(), "wt");
+    if( !f )
+        CV_Error_(CV_StsError, ("Can not open the file %s for writing", filename.c_str()));
+
+    int64 base = 0;
+    for( size_t i = 0; i < events.size(); i++ )
+        base = i == 0 ? events[i].start : std::min(base, events[i].start);
+    double scale = 1e6/getTickFrequency();
+
+    fputs("{\"traceEvents\":[", f);
+    for( size_t i = 0; i < events.size(); i++ )
+    {
+        const TraceEvent& e = events[i];
+        fputs(i == 0 ? "\n{\"name\":" : ",\n{\"name\":", f);
+        writeJSONString(f, e.name);
+        fprintf(f, ",\"cat\":\"opencv\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                (e.start - base)*scale, (e.end - e.start)*scale, e.tid);
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+    fclose(f);
+}
+
+}
+
+/* End of file. */
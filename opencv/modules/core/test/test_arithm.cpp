@@ -1523,3 +1523,264 @@ protected:
 TEST(Core_ArithmMask, uninitialized) { CV_ArithmMaskTest test; test.safe_run(); }
 
 
+
+// the runtime-dispatched (AVX2) kernels must give the same results as the generic code
+TEST(Core_Arithm, optimized_paths_consistency)
+{
+    RNG& rng = theRNG();
+    Size sz(67, 5); // not a multiple of any vector width, processed row by row
+
+    struct Run
+    {
+        static void binary(int op, const Mat& a, const Mat& b, Mat& c)
+        {
+            if( op == 0 ) add(a, b, c);
+            else if( op == 1 ) subtract(a, b, c);
+            else if( op == 2 ) absdiff(a, b, c);
+            else if( op == 3 ) bitwise_and(a, b, c);
+            else if( op == 4 ) bitwise_or(a, b, c);
+            else if( op == 5 ) bitwise_xor(a, b, c);
+            else bitwise_not(a, c);
+        }
+    };
+
+    bool useOptimized0 = useOptimized();
+    for( int depth = CV_8U; depth <= CV_64F; depth++ )
+    {
+        Mat a0(sz.height, sz.width + 3, depth), b0(sz.height, sz.width + 3, depth);
+        rng.fill(a0, RNG::UNIFORM, -300, 300);
+        rng.fill(b0, RNG::UNIFORM, -300, 300);
+        if( depth >= CV_32F )
+        {
+            a0.at<float>(1, 2) = a0.at<float>(0, 3) = std::numeric_limits<float>::quiet_NaN();
+            if( depth == CV_64F )
+                a0.at<double>(2, 5) = std::numeric_limits<double>::quiet_NaN();
+        }
+        Mat a = a0.colRange(1, sz.width + 1), b = b0.colRange(2, sz.width + 2);
+        Mat c[2];
+
+        for( int op = 0; op < 7; op++ )
+        {
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                Run::binary(op, a, b, c[k]);
+            }
+            EXPECT_EQ(0, countNonZero((c[0] != c[1]) & (c[0] == c[0]))) << "op=" << op << ", depth=" << depth;
+        }
+
+        for( int cmpop = CMP_EQ; cmpop <= CMP_NE; cmpop++ )
+        {
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                compare(a, b, c[k], cmpop);
+            }
+            EXPECT_EQ(0, norm(c[0], c[1], NORM_INF)) << "cmpop=" << cmpop << ", depth=" << depth;
+        }
+
+        a.setTo(0, a != a);
+        for( int ddepth = CV_8U; ddepth <= CV_64F; ddepth++ )
+        {
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                a.convertTo(c[k], ddepth, 0.7, 3.3);
+            }
+            EXPECT_EQ(0, norm(c[0], c[1], NORM_INF)) << "depth=" << depth << ", ddepth=" << ddepth;
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                a.convertTo(c[k], ddepth);
+            }
+            EXPECT_EQ(0, norm(c[0], c[1], NORM_INF)) << "depth=" << depth << ", ddepth=" << ddepth;
+        }
+        for( int k = 0; k < 2; k++ )
+        {
+            setUseOptimized(k == 0);
+            convertScaleAbs(a, c[k], 1.3, -2.5);
+        }
+        EXPECT_EQ(0, norm(c[0], c[1], NORM_INF)) << "depth=" << depth;
+    }
+
+    Mat x(sz, CV_32F), y(sz, CV_32F), r[2], t[2];
+    rng.fill(x, RNG::UNIFORM, -10, 10);
+    rng.fill(y, RNG::UNIFORM, -10, 10);
+    for( int k = 0; k < 2; k++ )
+    {
+        setUseOptimized(k == 0);
+        exp(x, r[k]);
+        log(abs(y), t[k]);
+    }
+    EXPECT_LE(norm(r[0], r[1], NORM_RELATIVE + NORM_INF), 1e-6);
+    EXPECT_LE(norm(t[0], t[1], NORM_INF), 1e-5);
+    for( int k = 0; k < 2; k++ )
+    {
+        setUseOptimized(k == 0);
+        cartToPolar(x, y, r[k], t[k], true);
+    }
+    EXPECT_LE(norm(r[0], r[1], NORM_RELATIVE + NORM_INF), 1e-6);
+    EXPECT_LE(norm(t[0], t[1], NORM_INF), 1e-3);
+    x.convertTo(x, CV_64F);
+    y.convertTo(y, CV_64F);
+    for( int k = 0; k < 2; k++ )
+    {
+        setUseOptimized(k == 0);
+        magnitude(x, y, r[k]);
+    }
+    EXPECT_LE(norm(r[0], r[1], NORM_RELATIVE + NORM_INF), 1e-12);
+
+    setUseOptimized(useOptimized0);
+}
+
+TEST(Core_Reductions, stripes_consistency)
+{
+    // large enough to be split into several stripes, the results must not depend
+    // on the number of threads and on the vectorized kernels
+    RNG& rng = theRNG();
+    bool useOptimized0 = useOptimized();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC2, CV_32FC1, CV_32FC4 };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        int type = types[t];
+        Mat a0(301, 517, type), b(300, 515, type), mask(300, 515, CV_8U);
+        rng.fill(a0, RNG::UNIFORM, -200, 200);
+        rng.fill(b, RNG::UNIFORM, -200, 200);
+        rng.fill(mask, RNG::UNIFORM, 0, 2);
+        Mat a = a0(Rect(1, 1, 515, 300)), a1 = a.reshape(1);
+
+        Scalar s[2], m[2], sdmean[2], sdev[2];
+        double n[2][6], minv[2], maxv[2];
+        Point minp[2], maxp[2];
+        int nz[2];
+        Mat r[2][4];
+        for( int k = 0; k < 2; k++ )
+        {
+            NumThreadsGuard guard(k == 0 ? 1 : -1);
+            setUseOptimized(k != 0);
+            s[k] = sum(a);
+            m[k] = mean(a, mask);
+            meanStdDev(a, sdmean[k], sdev[k], mask);
+            n[k][0] = norm(a, NORM_INF);
+            n[k][1] = norm(a, NORM_L1, mask);
+            n[k][2] = norm(a, NORM_L2);
+            n[k][3] = norm(a, b, NORM_INF);
+            n[k][4] = norm(a, b, NORM_L1);
+            n[k][5] = norm(a, b, NORM_L2, mask);
+            nz[k] = countNonZero(a1);
+            minMaxLoc(a1, &minv[k], &maxv[k], &minp[k], &maxp[k]);
+            int sumDepth = a.depth() == CV_8U ? CV_32S : CV_64F;
+            reduce(a, r[k][0], 0, CV_REDUCE_SUM, sumDepth);
+            reduce(a, r[k][1], 1, CV_REDUCE_SUM, sumDepth);
+            reduce(a, r[k][2], 0, CV_REDUCE_MAX);
+            reduce(a, r[k][3], 1, CV_REDUCE_MIN);
+        }
+        setUseOptimized(useOptimized0);
+
+        EXPECT_EQ(s[0], s[1]) << "type=" << type;
+        EXPECT_EQ(m[0], m[1]) << "type=" << type;
+        EXPECT_EQ(sdmean[0], sdmean[1]) << "type=" << type;
+        EXPECT_EQ(sdev[0], sdev[1]) << "type=" << type;
+        for( int i = 0; i < 6; i++ )
+            EXPECT_EQ(n[0][i], n[1][i]) << "type=" << type << ", norm #" << i;
+        EXPECT_EQ(nz[0], nz[1]) << "type=" << type;
+        EXPECT_EQ(minv[0], minv[1]) << "type=" << type;
+        EXPECT_EQ(maxv[0], maxv[1]) << "type=" << type;
+        EXPECT_EQ(minp[0], minp[1]) << "type=" << type;
+        EXPECT_EQ(maxp[0], maxp[1]) << "type=" << type;
+        for( int i = 0; i < 4; i++ )
+            EXPECT_EQ(0, norm(r[0][i], r[1][i], NORM_INF)) << "type=" << type << ", reduce #" << i;
+
+        // the integer sums are exact
+        if( a.depth() != CV_32F )
+        {
+            Mat a64;
+            a.convertTo(a64, CV_64F);
+            double l1 = 0;
+            for( int i = 0; i < a64.rows; i++ )
+                for( int j = 0; j < a64.cols*a64.channels(); j++ )
+                    l1 += std::abs(a64.ptr<double>(i)[j]);
+            EXPECT_EQ(l1, norm(a, NORM_L1)) << "type=" << type;
+        }
+    }
+}
+
+TEST(Core_ConvertFp16, accuracy)
+{
+    bool useOptimized0 = useOptimized();
+    Mat h(1, 65536, CV_16S), f[2], h2[2];
+    for( int i = 0; i < h.cols; i++ )
+        h.at<short>(i) = (short)i;
+
+    for( int k = 0; k < 2; k++ )
+    {
+        setUseOptimized(k == 0);
+        convertFp16(h, f[k]);
+        convertFp16(f[k], h2[k]);
+    }
+    ASSERT_EQ(CV_32F, f[0].type());
+    ASSERT_EQ(CV_16S, h2[0].type());
+
+    // every half is exactly representable as float, so all the patterns but NaN come back unchanged
+    for( int i = 0; i < h.cols; i++ )
+    {
+        bool isnan = (i & 0x7c00) == 0x7c00 && (i & 0x3ff) != 0;
+        for( int k = 0; k < 2; k++ )
+        {
+            float v = f[k].at<float>(i);
+            ushort r = (ushort)h2[k].at<short>(i);
+            if( isnan )
+            {
+                ASSERT_TRUE(cvIsNaN(v)) << "i=" << i;
+                ASSERT_TRUE((r & 0x7c00) == 0x7c00 && (r & 0x3ff) != 0) << "i=" << i;
+            }
+            else
+            {
+                ASSERT_EQ(i, (int)r) << "i=" << i << ", k=" << k;
+                ASSERT_EQ(f[0].at<float>(i), v) << "i=" << i;
+            }
+        }
+    }
+    EXPECT_EQ(1.f, f[0].at<float>(0x3c00));
+    EXPECT_EQ(-2.f, f[0].at<float>(0xc000));
+    EXPECT_EQ(65504.f, f[0].at<float>(0x7bff));
+    EXPECT_EQ(1.f/(1 << 24), f[0].at<float>(0x0001));
+
+    // the rounding to the nearest half, including the subnormals and the overflow,
+    // on a non-continuous multi-channel array
+    RNG& rng = theRNG();
+    Mat src0(31, 103, CV_32FC3), src = src0(Rect(1, 1, 101, 30));
+    rng.fill(src0, RNG::UNIFORM, -1, 1);
+    for( int i = 0; i < src.rows; i++ )
+    {
+        float* row = src.ptr<float>(i);
+        for( int j = 0; j < src.cols*3; j++ )
+            row[j] *= (float)std::pow(2., (i*src.cols*3 + j) % 44 - 26);
+    }
+    Mat back[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        setUseOptimized(k == 0);
+        convertFp16(src, h2[k]);
+        convertFp16(h2[k], back[k]);
+    }
+    setUseOptimized(useOptimized0);
+
+    ASSERT_EQ(src.size(), h2[0].size());
+    ASSERT_EQ(CV_16SC3, h2[0].type());
+    EXPECT_EQ(0, norm(h2[0], h2[1], NORM_INF));
+    for( int i = 0; i < src.rows; i++ )
+    {
+        const float* x = src.ptr<float>(i);
+        const float* y = back[0].ptr<float>(i);
+        for( int j = 0; j < src.cols*3; j++ )
+        {
+            float ax = std::abs(x[j]);
+            if( ax >= 65520.f )
+                ASSERT_EQ(x[j] > 0 ? FLT_MAX*2 : -FLT_MAX*2, y[j]) << x[j];
+            else
+                ASSERT_LE(std::abs(x[j] - y[j]), std::max(ax/2048, 1.f/(1 << 25))) << x[j];
+        }
+    }
+}
@@ -828,3 +828,77 @@ TEST(Core_DFT, accuracy) { CxCore_DFTTest test; test.safe_run(); }
 TEST(Core_MulSpectrums, accuracy) { CxCore_MulSpectrumsTest test; test.safe_run(); }
 
 
+
+TEST(Core_DFT, large_parallel)
+{
+    RNG& rng = theRNG();
+
+    // complex 2D transforms, power-of-4 (vectorized radix-4 stages) and mixed-radix sizes
+    const Size sizes[] = { Size(256, 64), Size(200, 96) };
+    for( int k = 0; k < 2; k++ )
+    {
+        int depth = k == 0 ? CV_32F : CV_64F;
+        Mat src(sizes[k], CV_MAKETYPE(depth, 2)), dst, ref;
+        rng.fill(src, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+
+        cv::dft(src, dst);
+        cvtest::DFT_2D(src, ref, 0);
+        EXPECT_LE(cv::norm(dst, ref, NORM_INF | NORM_RELATIVE), depth == CV_32F ? 1e-4 : 1e-10);
+
+        cv::dft(src, dst, DFT_INVERSE | DFT_ROWS);
+        cvtest::DFT_2D(src, ref, DFT_INVERSE | DFT_ROWS);
+        EXPECT_LE(cv::norm(dst, ref, NORM_INF | NORM_RELATIVE), depth == CV_32F ? 1e-4 : 1e-10);
+    }
+
+    // the rows and the columns are split between the threads, which must not change the result
+    Mat src(240, 512, CV_32F);
+    rng.fill(src, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+    const int flags[] = { 0, DFT_ROWS, DFT_ROWS | DFT_COMPLEX_OUTPUT, DFT_SCALE };
+    for( int k = 0; k < 4; k++ )
+    {
+        Mat dst, dst0, inv, inv0;
+        cv::dft(src, dst, flags[k]);
+        cv::dft(dst, inv, DFT_INVERSE | DFT_REAL_OUTPUT | (flags[k] & DFT_ROWS));
+        {
+            NumThreadsGuard serial;
+            cv::dft(src, dst0, flags[k]);
+            cv::dft(dst0, inv0, DFT_INVERSE | DFT_REAL_OUTPUT | (flags[k] & DFT_ROWS));
+        }
+        // only the first len/2+1 elements of the complex output are computed
+        int ncols = flags[k] & DFT_COMPLEX_OUTPUT ? src.cols/2 + 1 : src.cols;
+        EXPECT_EQ(0, cv::norm(dst.colRange(0, ncols), dst0.colRange(0, ncols), NORM_INF)) << "flags = " << flags[k];
+        EXPECT_EQ(0, cv::norm(inv, inv0, NORM_INF)) << "flags = " << flags[k];
+        if( flags[k] == DFT_SCALE )
+        {
+            EXPECT_LE(cv::norm(inv, src, NORM_INF), 1e-4);
+        }
+    }
+
+    Mat dct, dct0, idct;
+    cv::dct(src, dct);
+    {
+        NumThreadsGuard serial;
+        cv::dct(src, dct0);
+    }
+    EXPECT_EQ(0, cv::norm(dct, dct0, NORM_INF));
+    cv::idct(dct, idct);
+    EXPECT_LE(cv::norm(idct, src, NORM_INF), 1e-4);
+}
+
+TEST(Core_DFT, plan_cache)
+{
+    // more lengths than the cache holds, each transformed twice
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 2; iter++ )
+        for( int len = 20; len < 60; len += 2 )
+        {
+            Mat src(4, len, CV_64F), dst, inv;
+            rng.fill(src, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+            cv::dft(src, dst);
+            cv::dft(dst, inv, DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
+            EXPECT_LE(cv::norm(inv, src, NORM_INF), 1e-10) << "len = " << len;
+            cv::dct(src, dst);
+            cv::idct(dst, inv);
+            EXPECT_LE(cv::norm(inv, src, NORM_INF), 1e-10) << "len = " << len;
+        }
+}
@@ -1,4 +1,5 @@
 #include "test_precomp.hpp"
+#include "opencv2/core/internal.hpp"
 
 using namespace cv;
 using namespace std;
@@ -91,7 +92,7 @@ protected:
             {-1000000, 1000000}, {-10, 10}, {-10, 10}};
         RNG& rng = ts->get_rng();
         RNG rng0;
-        test_case_count = 4;
+        test_case_count = 6;
         int progress = 0;
         MemStorage storage(cvCreateMemStorage(0));
 
@@ -102,8 +103,8 @@ protected:
 
             cvClearMemStorage(storage);
 
-            bool mem = (idx % 4) >= 2;
-            string filename = tempfile(idx % 2 ? ".yml" : ".xml");
+            bool mem = idx < 4 && (idx % 4) >= 2;
+            string filename = tempfile(idx >= 4 ? ".bin" : idx % 2 ? ".yml" : ".xml");
 
             FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0));
 
@@ -426,6 +427,352 @@ protected:
 
 TEST(Core_InputOutput, misc) { CV_MiscIOTest test; test.safe_run(); }
 
+TEST(Core_InputOutput, base64)
+{
+    const char* exts[] = { ".xml", ".yml" };
+    RNG& rng = theRNG();
+
+    for( int k = 0; k < 4; k++ )
+    {
+        bool mem = k >= 2;
+        string fname = cv::tempfile(exts[k % 2]);
+        vector<Mat> mats;
+        for( int depth = CV_8U; depth <= CV_64F; depth++ )
+        {
+            Mat m(rng.uniform(1, 100), rng.uniform(1, 1000), CV_MAKETYPE(depth, rng.uniform(1, 5)));
+            randu(m, -1000, 1000);
+            mats.push_back(m);
+        }
+        mats.push_back(Mat(1, 3, CV_32F, Scalar::all(1.5))); // too small, written as text
+        vector<float> vf(5000);
+        randu(vf, -1, 1);
+
+        FileStorage fs(fname, FileStorage::WRITE + FileStorage::BASE64 + (mem ? FileStorage::MEMORY : 0));
+        ASSERT_TRUE(fs.isOpened());
+        for( size_t i = 0; i < mats.size(); i++ )
+            fs << format("m%d", (int)i) << mats[i];
+        fs << "vf" << vf << "tail" << "[" << 1 << 2 << "]";
+        string content = fs.releaseAndGetString();
+        if( mem )
+        {
+            EXPECT_NE(string::npos, content.find("$base64$"));
+        }
+
+        ASSERT_TRUE(fs.open(mem ? content : fname, FileStorage::READ + (mem ? FileStorage::MEMORY : 0)));
+        for( size_t i = 0; i < mats.size(); i++ )
+        {
+            Mat m;
+            fs[format("m%d", (int)i)] >> m;
+            ASSERT_EQ(mats[i].type(), m.type());
+            ASSERT_EQ(mats[i].size(), m.size());
+            EXPECT_EQ(0, norm(mats[i], m, NORM_INF));
+        }
+        vector<float> vf2;
+        fs["vf"] >> vf2;
+        EXPECT_EQ(0, norm(Mat(vf), Mat(vf2), NORM_INF));
+        EXPECT_EQ(2, (int)fs["tail"].size());
+        fs.release();
+        if( !mem )
+            remove(fname.c_str());
+    }
+
+    // the strings that look like base64 data are decoded only in the storages written with BASE64
+    for( int k = 0; k < 2; k++ )
+    {
+        FileStorage fs(exts[k], FileStorage::WRITE + FileStorage::MEMORY);
+        fs << "s" << "[" << "$base64$iAAAAAA==" << "]";
+        string content = fs.releaseAndGetString();
+        ASSERT_TRUE(fs.open(content, FileStorage::READ + FileStorage::MEMORY));
+        ASSERT_EQ(1, (int)fs["s"].size());
+        EXPECT_EQ(string("$base64$iAAAAAA=="), (string)fs["s"][0]);
+    }
+}
+
+TEST(Core_InputOutput, float16)
+{
+    const char* exts[] = { ".yml", ".yml", ".xml", ".bin" };
+    const int flags[] = { 0, FileStorage::BASE64, FileStorage::BASE64, 0 };
+    Mat m(100, 60, CV_32FC2), md(10, 10, CV_64F), mi(10, 10, CV_32S), mh, mref;
+    randu(m, -100, 100);
+    randu(md, -1, 1);
+    randu(mi, -1000, 1000);
+    convertFp16(m, mh);
+    convertFp16(mh, mref);
+
+    for( int k = 0; k < 4; k++ )
+    {
+        string fname[2];
+        long size[2];
+        for( int f16 = 0; f16 < 2; f16++ )
+        {
+            fname[f16] = cv::tempfile(exts[k]);
+            FileStorage fs(fname[f16], FileStorage::WRITE + flags[k] + (f16 ? FileStorage::FLOAT16 : 0));
+            ASSERT_TRUE(fs.isOpened());
+            fs << "m" << m << "md" << md << "mi" << mi << "x" << 1.25f;
+            fs.release();
+            FILE* f = fopen(fname[f16].c_str(), "rb");
+            ASSERT_TRUE(f != 0);
+            fseek(f, 0, SEEK_END);
+            size[f16] = ftell(f);
+            fclose(f);
+        }
+        // the text numbers are only shorter, the binary and base64 data is about halved
+        EXPECT_LT(size[1], k == 0 ? size[0]*9/10 : size[0]*3/4) << "k=" << k;
+
+        FileStorage fs(fname[1], FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        Mat m2, md2, mi2, m3(m.size(), CV_64FC2), m4;
+        fs["m"] >> m2;
+        fs["md"] >> md2;
+        fs["mi"] >> mi2;
+        ASSERT_EQ(m.type(), m2.type());
+        ASSERT_EQ(m.size(), m2.size());
+        // the binary data keeps the halves exactly, the text ones are rounded to 5 digits
+        EXPECT_LE(norm(mref, m2, NORM_INF), flags[k] || k == 3 ? 0 : 1e-3) << "k=" << k;
+        EXPECT_LE(norm(m, m2, NORM_INF), 100./2048) << "k=" << k;
+        EXPECT_EQ(0, norm(md, md2, NORM_INF)) << "k=" << k;
+        EXPECT_EQ(0, norm(mi, mi2, NORM_INF)) << "k=" << k;
+        EXPECT_EQ(1.25f, (float)fs["x"]);
+        // the halves can be read into the other types as well
+        fs["m"]["data"].readRaw("d", m3.data, m.total()*2);
+        m2.convertTo(m4, CV_64F);
+        EXPECT_LE(norm(m4, m3, NORM_INF), k == 0 ? 1e-4 : 0) << "k=" << k;
+        fs.release();
+        remove(fname[0].c_str());
+        remove(fname[1].c_str());
+    }
+}
+
+TEST(Core_InputOutput, lazy)
+{
+    const char* exts[] = { ".yml", ".bin", ".xml", ".yml.gz" };
+    Mat m(30, 40, CV_32FC2), m2;
+    randu(m, -1, 1);
+
+    for( int k = 0; k < 4; k++ )
+    {
+        string fname = cv::tempfile(exts[k]);
+        {
+            FileStorage fs(fname, FileStorage::WRITE);
+            ASSERT_TRUE(fs.isOpened());
+            fs << "a" << 5 << "m" << m << "s" << "text";
+            fs << "nested" << "{" << "x" << 1.5 << "list" << "[" << 1 << 2 << 3 << "]" << "}";
+            fs << "z" << "[:" << 7 << 8 << "]";
+        }
+
+        FileStorage fs(fname, FileStorage::READ + FileStorage::LAZY);
+        ASSERT_TRUE(fs.isOpened());
+        // look up the nodes in the order different from the file
+        FileNode nested = fs["nested"];
+        EXPECT_EQ(1.5, (double)nested["x"]);
+        EXPECT_EQ(3, (int)nested["list"].size());
+        EXPECT_EQ(3, (int)nested["list"][2]);
+        fs["m"] >> m2;
+        EXPECT_EQ(0, norm(m, m2, NORM_INF));
+        EXPECT_EQ(5, (int)fs["a"]);
+        EXPECT_TRUE(fs["missing"].empty());
+
+        // iterating the top-level map parses the rest of the nodes
+        FileNode root = fs.root();
+        vector<string> names;
+        for( FileNodeIterator it = root.begin(); it != root.end(); ++it )
+        {
+            EXPECT_FALSE((*it).isNone());
+            names.push_back((*it).name());
+        }
+        EXPECT_EQ(5, (int)names.size());
+        EXPECT_EQ(string("text"), (string)fs["s"]);
+        EXPECT_EQ(8, (int)fs["z"][1]);
+        fs.release();
+        remove(fname.c_str());
+    }
+}
+
+namespace
+{
+
+// looks up all the top-level nodes of the lazy storage from each stripe
+struct LazyLookupInvoker
+{
+    LazyLookupInvoker(const FileStorage& _fs, const Mat& _m, int* _errors) : fs(&_fs), m(&_m), errors(_errors) {}
+    void operator()(const BlockedRange& range) const
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            Mat m2;
+            (*fs)["m"] >> m2;
+            bool ok = norm(*m, m2, NORM_INF) == 0 && (int)(*fs)["a"] == 5 &&
+                (double)(*fs)["nested"]["x"] == 1.5 && (int)(*fs)["z"][1] == 8 &&
+                (string)(*fs)["s"] == "text";
+            if( !ok )
+                CV_XADD(errors, 1);
+        }
+    }
+    const FileStorage* fs;
+    const Mat* m;
+    int* errors;
+};
+
+}
+
+// the lazy nodes are parsed once under the lock, and the C API sees only the parsed nodes
+TEST(Core_InputOutput, lazy_concurrent)
+{
+    const char* exts[] = { ".yml", ".bin" };
+    Mat m(30, 40, CV_32FC2);
+    randu(m, -1, 1);
+
+    for( int k = 0; k < 2; k++ )
+    {
+        string fname = cv::tempfile(exts[k]);
+        {
+            FileStorage fs(fname, FileStorage::WRITE);
+            ASSERT_TRUE(fs.isOpened());
+            fs << "a" << 5 << "m" << m << "s" << "text";
+            fs << "nested" << "{" << "x" << 1.5 << "}" << "z" << "[:" << 7 << 8 << "]";
+        }
+
+        for( int iter = 0; iter < 10; iter++ )
+        {
+            FileStorage fs(fname, FileStorage::READ + FileStorage::LAZY);
+            ASSERT_TRUE(fs.isOpened());
+            int errors = 0;
+            parallel_for(BlockedRange(0, 64), LazyLookupInvoker(fs, m, &errors));
+            EXPECT_EQ(0, errors);
+        }
+
+        FileStorage fs(fname, FileStorage::READ + FileStorage::LAZY);
+        CvFileNode* croot = cvGetRootFileNode(*fs, 0);
+        ASSERT_TRUE(croot != 0);
+        ASSERT_TRUE(CV_NODE_IS_MAP(croot->tag));
+        CvSeqReader reader;
+        cvStartReadSeq(croot->data.seq, &reader, 0);
+        int nnodes = 0;
+        for( int i = 0; i < croot->data.seq->total; i++ )
+        {
+            const CvFileNode* node = (const CvFileNode*)reader.ptr;
+            if( CV_IS_SET_ELEM(node) )
+            {
+                EXPECT_NE(CV_NODE_NONE, CV_NODE_TYPE(node->tag));
+                nnodes++;
+            }
+            CV_NEXT_SEQ_ELEM(reader.seq->elem_size, reader);
+        }
+        EXPECT_EQ(5, nnodes);
+        fs.release();
+        remove(fname.c_str());
+    }
+}
+
+TEST(Core_InputOutput, binary_mapped_mat)
+{
+    string fname = cv::tempfile(".bin");
+    Mat m(37, 101, CV_32FC3), m1(5, 3, CV_16S);
+    vector<int> vi(1000);
+    vector<Point2f> vp(77);
+    randu(m, -1, 1);
+    randu(m1, -100, 100);
+    for( size_t i = 0; i < vi.size(); i++ )
+        vi[i] = (int)(i*i);
+    for( size_t i = 0; i < vp.size(); i++ )
+        vp[i] = Point2f((float)i, -(float)i);
+
+    {
+        FileStorage fs(fname, FileStorage::WRITE);
+        ASSERT_TRUE(fs.isOpened());
+        fs << "m" << m << "m1" << m1 << "vi" << vi << "vp" << vp << "name" << "binary";
+    }
+
+    Mat m2, m3;
+    vector<int> vi2;
+    vector<Point2f> vp2;
+    {
+        FileStorage fs(fname, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        fs["m"] >> m2;
+        fs["m1"] >> m3;
+        fs["vi"] >> vi2;
+        fs["vp"] >> vp2;
+        EXPECT_EQ(string("binary"), (string)fs["name"]);
+
+        // the matrix data is read from the raw block, but it is still available as the nodes
+        FileNode data = fs["m1"]["data"];
+        ASSERT_EQ((size_t)m1.total(), data.size());
+        EXPECT_EQ((int)m1.at<short>(4, 2), (int)data[4*3 + 2]);
+        int nelems = 0;
+        for( FileNodeIterator it = data.begin(); it != data.end(); ++it )
+            nelems++;
+        EXPECT_EQ((int)m1.total(), nelems);
+    }
+
+    // with MAP_DATA the large matrix is not copied, its data is aligned in the file
+    Mat m4, m6;
+    {
+        FileStorage fs(fname, FileStorage::READ + FileStorage::MAP_DATA);
+        fs["m"] >> m4;
+        EXPECT_EQ(0, (int)((size_t)m4.data % 64));
+        FileStorage(fname, FileStorage::READ + FileStorage::MAP_DATA)["m"] >> m6;
+        EXPECT_NE(m4.data, m6.data);
+    }
+    EXPECT_EQ(0, norm(m, m4, NORM_INF));
+
+    // the data stays valid after the storage is closed
+    ASSERT_EQ(m.type(), m2.type());
+    EXPECT_EQ(0, norm(m, m2, NORM_INF));
+    EXPECT_EQ(0, norm(m1, m3, NORM_INF));
+    EXPECT_EQ(0, norm(Mat(vi), Mat(vi2), NORM_INF));
+    ASSERT_EQ(vp.size(), vp2.size());
+    EXPECT_EQ(0, norm(Mat(vp), Mat(vp2), NORM_INF));
+
+    // modifying the mapped matrix does not change the file
+    m4.setTo(Scalar::all(5));
+    Mat m5;
+    FileStorage(fname, FileStorage::READ)["m"] >> m5;
+    EXPECT_EQ(0, norm(m, m5, NORM_INF));
+    m4.release();
+    m5.release();
+    m6.release();
+
+    // binary storages are not read from or written to memory
+    FileStorage fs;
+    EXPECT_THROW(fs.open("", FileStorage::WRITE + FileStorage::MEMORY + FileStorage::FORMAT_BINARY), cv::Exception);
+
+    // a truncated storage is reported as a parse error, the data is never read past its end
+    vector<char> content;
+    {
+        FILE* f = fopen(fname.c_str(), "rb");
+        ASSERT_TRUE(f != 0);
+        fseek(f, 0, SEEK_END);
+        content.resize((size_t)ftell(f));
+        fseek(f, 0, SEEK_SET);
+        ASSERT_EQ(content.size(), fread(&content[0], 1, content.size(), f));
+        fclose(f);
+    }
+    for( size_t len = 17; len < content.size(); len += len < 200 ? 1 : 997 )
+    {
+        FILE* f = fopen(fname.c_str(), "wb");
+        ASSERT_TRUE(f != 0);
+        fwrite(&content[0], 1, len, f);
+        fclose(f);
+        EXPECT_THROW(fs.open(fname, FileStorage::READ), cv::Exception) << "length=" << len;
+    }
+
+    // so is the nesting that is too deep for the recursive parser
+    for( int k = 0; k < 2; k++ )
+    {
+        {
+            FileStorage fsw(fname, FileStorage::WRITE);
+            fsw << "seq";
+            for( int i = 0; i < 1000; i++ )
+                fsw << "[";
+            for( int i = 0; i < 1000; i++ )
+                fsw << "]";
+        }
+        EXPECT_THROW(fs.open(fname, FileStorage::READ + (k ? FileStorage::LAZY : 0)), cv::Exception);
+    }
+    remove(fname.c_str());
+}
+
 /*class CV_BigMatrixIOTest : public cvtest::BaseTest
 {
 public:
@@ -871,4 +871,165 @@ TEST(Core_Mat, reshape_1942)
         cn = M.channels();
     );
     ASSERT_EQ(1, cn);
-}
\ No newline at end of file
+}
+
+TEST(Core_Mat, frame_pool_allocator)
+{
+    FramePoolAllocator pool(1 << 20);
+    MatAllocator* prevAllocator = Mat::getDefaultAllocator();
+    Mat::setDefaultAllocator(&pool);
+
+    uchar* data0 = 0;
+    for( int iter = 0; iter < 5; iter++ )
+    {
+        Mat a(240, 320, CV_8UC3, Scalar::all(1)), b;
+        EXPECT_EQ(&pool, a.allocator);
+        EXPECT_EQ(0u, (size_t)a.data % 16);
+        if( iter == 0 )
+            data0 = a.data;
+        else
+            EXPECT_EQ(data0, a.data);
+
+        // the output and temporary matrices of the library functions use the pool too
+        b = a + a;
+        EXPECT_EQ(&pool, b.allocator);
+        EXPECT_EQ(240*320*3*2., norm(b, NORM_L1));
+    }
+    EXPECT_EQ(2u, pool.getMisses());
+    EXPECT_EQ(8u, pool.getHits());
+    EXPECT_GT(pool.getRetainedBytes(), 2u*240*320*3);
+
+    // the least recently released buffers are freed when the limit is exceeded
+    {
+        Mat c(512, 1024, CV_8UC1), d(480, 640, CV_8UC1);
+    }
+    EXPECT_LE(pool.getRetainedBytes(), (size_t)1 << 20);
+    Mat e(480, 640, CV_8UC1);
+    EXPECT_EQ(9u, pool.getHits());
+
+    pool.setMaxRetainedBytes(0);
+    EXPECT_EQ(0u, pool.getRetainedBytes());
+
+    Mat::setDefaultAllocator(prevAllocator);
+    Mat f(10, 10, CV_8U);
+    EXPECT_TRUE(f.allocator == prevAllocator);
+    e.release();
+    EXPECT_EQ(0u, pool.getRetainedBytes());
+
+    // the released matrix keeps its allocator and re-creates the buffer from the same pool
+    {
+        FramePoolAllocator pool2;
+        Mat::setDefaultAllocator(&pool2);
+        Mat g(10, 10, CV_8U);
+        Mat::setDefaultAllocator(prevAllocator);
+        g.release();
+        EXPECT_EQ(&pool2, g.allocator);
+        g.create(10, 10, CV_8U);
+        EXPECT_EQ(1u, pool2.getHits());
+    }
+}
+
+TEST(Core_Sort, accuracy)
+{
+    // short rows are sorted by std::sort, the longer ones by the radix sort
+    RNG& rng = theRNG();
+    const int lens[] = { 5, 300 };
+    for( int depth = CV_8U; depth <= CV_64F; depth++ )
+        for( int l = 0; l < 2; l++ )
+            for( int flags = 0; flags < 4; flags++ )
+            {
+                int sortFlags = (flags & 1 ? CV_SORT_EVERY_COLUMN : CV_SORT_EVERY_ROW) |
+                                (flags & 2 ? CV_SORT_DESCENDING : CV_SORT_ASCENDING);
+                bool byRows = (flags & 1) == 0;
+                int len = lens[l], n = 37;
+                Mat a(byRows ? n : len, byRows ? len : n, depth), sorted, idx;
+                rng.fill(a, RNG::UNIFORM, -1000, 1000);
+                if( depth == CV_32F )
+                    a.at<float>(0, 0) = -0.f;
+                cv::sort(a, sorted, sortFlags);
+                cv::sortIdx(a, idx, sortFlags);
+
+                Mat a64, sorted64;
+                a.convertTo(a64, CV_64F);
+                sorted.convertTo(sorted64, CV_64F);
+                for( int i = 0; i < n; i++ )
+                {
+                    Mat arow = byRows ? a64.row(i) : a64.col(i).t();
+                    Mat srow = byRows ? sorted64.row(i) : sorted64.col(i).t();
+                    Mat irow = byRows ? idx.row(i) : idx.col(i).t();
+                    std::vector<double> ref = arow, byIdx(len);
+                    std::sort(ref.begin(), ref.end());
+                    if( flags & 2 )
+                        std::reverse(ref.begin(), ref.end());
+                    std::vector<int> hits(len, 0);
+                    for( int j = 0; j < len; j++ )
+                    {
+                        int k = irow.at<int>(j);
+                        ASSERT_TRUE(0 <= k && k < len);
+                        hits[k]++;
+                        byIdx[j] = arow.at<double>(k);
+                    }
+                    EXPECT_EQ(len, countNonZero(Mat(hits)));
+                    EXPECT_EQ(0, norm(Mat(ref), srow.t(), NORM_INF)) << "depth=" << depth << ", flags=" << sortFlags;
+                    EXPECT_EQ(0, norm(Mat(ref), Mat(byIdx), NORM_INF)) << "depth=" << depth << ", flags=" << sortFlags;
+                }
+            }
+
+    // the rows are sorted by several threads
+    Mat big(200, 1000, CV_32F), s0, s1;
+    rng.fill(big, RNG::UNIFORM, -1, 1);
+    {
+        NumThreadsGuard serial;
+        cv::sortIdx(big, s0, CV_SORT_EVERY_ROW);
+    }
+    cv::sortIdx(big, s1, CV_SORT_EVERY_ROW);
+    EXPECT_EQ(0, norm(s0, s1, NORM_INF));
+}
+
+TEST(Core_PCA, randomized_incremental)
+{
+    // a few strong components plus noise
+    RNG& rng = theRNG();
+    const int n = 400, d = 300, rank = 5;
+    Mat coeffs(n, rank, CV_32F), basis(rank, d, CV_32F), noise(n, d, CV_32F), data;
+    rng.fill(coeffs, RNG::NORMAL, 0, 10);
+    rng.fill(basis, RNG::NORMAL, 0, 1);
+    rng.fill(noise, RNG::NORMAL, 0, 0.01);
+    data = coeffs*basis + noise + Scalar::all(3);
+
+    PCA exact(data, noArray(), CV_PCA_DATA_AS_ROW, rank);
+    PCA fast(data, noArray(), CV_PCA_DATA_AS_ROW | CV_PCA_RANDOMIZED, rank);
+    ASSERT_EQ(rank, fast.eigenvectors.rows);
+    EXPECT_LT(norm(exact.mean, fast.mean, NORM_INF), 1e-4);
+    EXPECT_LT(norm(exact.eigenvalues, fast.eigenvalues, NORM_RELATIVE | NORM_L2), 1e-4);
+    // the subspaces match when the projection of one basis onto the other keeps the norm
+    EXPECT_NEAR(rank, norm(fast.eigenvectors*exact.eigenvectors.t(), NORM_L2SQR), 1e-3);
+
+    PCA fastCols(data.t(), noArray(), CV_PCA_DATA_AS_COL | CV_PCA_RANDOMIZED, rank);
+    EXPECT_EQ(Size(1, d), fastCols.mean.size());
+    EXPECT_LT(norm(fast.eigenvalues, fastCols.eigenvalues, NORM_RELATIVE | NORM_L2), 1e-4);
+
+    // with all the components retained, the incremental PCA matches the batch one
+    Mat small = data.colRange(0, 20);
+    PCA full(small, noArray(), CV_PCA_DATA_AS_ROW);
+    IncrementalPCA inc;
+    for( int i = 0; i < n; i += 100 )
+        inc.update(small.rowRange(i, i + 100), CV_PCA_DATA_AS_ROW);
+    EXPECT_EQ(n, (int)inc.nsamples);
+    EXPECT_LT(norm(full.mean, inc.mean, NORM_INF), 1e-4);
+    EXPECT_LT(norm(full.eigenvalues, inc.eigenvalues, NORM_RELATIVE | NORM_L2), 1e-4);
+    Mat sample = small.row(7);
+    EXPECT_LT(norm(sample, inc.backProject(inc.project(sample)), NORM_RELATIVE | NORM_INF), 1e-4);
+
+    // the truncated incremental PCA keeps the dominant components
+    IncrementalPCA trunc;
+    for( int i = 0; i < n; i += 100 )
+        trunc.update(data.rowRange(i, i + 100), CV_PCA_DATA_AS_ROW, rank + 5);
+    EXPECT_LT(norm(exact.eigenvalues, trunc.eigenvalues.rowRange(0, rank), NORM_RELATIVE | NORM_L2), 1e-3);
+
+    // the update can start from PCA of the first samples
+    IncrementalPCA cont(PCA(small.rowRange(0, 200), noArray(), CV_PCA_DATA_AS_ROW), 200);
+    cont.update(small.rowRange(200, n), CV_PCA_DATA_AS_ROW);
+    EXPECT_EQ(n, (int)cont.nsamples);
+    EXPECT_LT(norm(full.eigenvalues, cont.eigenvalues, NORM_RELATIVE | NORM_L2), 1e-4);
+}
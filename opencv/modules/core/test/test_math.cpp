@@ -2460,6 +2460,92 @@ TEST(Core_CrossProduct, accuracy) { Core_CrossProductTest test; test.safe_run();
 TEST(Core_Determinant, accuracy) { Core_DetTest test; test.safe_run(); }
 TEST(Core_DotProduct, accuracy) { Core_DotProductTest test; test.safe_run(); }
 TEST(Core_GEMM, accuracy) { Core_GEMMTest test; test.safe_run(); }
+
+// the large products go through the packed-panel (or BLAS) code; check the border tiles,
+// all the transposition flags and the in-place operation against the straightforward product
+TEST(Core_GEMM, large_blocked)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_32F, CV_64F };
+
+    for( int iter = 0; iter < 16; iter++ )
+    {
+        int type = types[iter % 2], flags = (iter/2) % 8;
+        int m = rng.uniform(30, 300), n = rng.uniform(30, 300), k = rng.uniform(30, 600);
+        Mat A = flags & GEMM_1_T ? Mat(k, m, type) : Mat(m, k, type);
+        Mat B = flags & GEMM_2_T ? Mat(n, k, type) : Mat(k, n, type);
+        Mat C = flags & GEMM_3_T ? Mat(n, m, type) : Mat(m, n, type);
+        double alpha = rng.uniform(-2., 2.), beta = rng.uniform(-2., 2.);
+        rng.fill(A, RNG::UNIFORM, -1, 1);
+        rng.fill(B, RNG::UNIFORM, -1, 1);
+        rng.fill(C, RNG::UNIFORM, -1, 1);
+
+        Mat A64, B64, C64, ref, D;
+        A.convertTo(A64, CV_64F);
+        B.convertTo(B64, CV_64F);
+        C.convertTo(C64, CV_64F);
+        if( flags & GEMM_1_T ) A64 = A64.t();
+        if( flags & GEMM_2_T ) B64 = B64.t();
+        if( flags & GEMM_3_T ) C64 = C64.t();
+
+        ref.create(m, n, CV_64F);
+        for( int i = 0; i < m; i++ )
+            for( int j = 0; j < n; j++ )
+            {
+                double s = 0;
+                for( int l = 0; l < k; l++ )
+                    s += A64.at<double>(i, l)*B64.at<double>(l, j);
+                ref.at<double>(i, j) = s*alpha + C64.at<double>(i, j)*beta;
+            }
+
+        double eps = type == CV_32F ? 1e-4 : 1e-10;
+        gemm(A, B, alpha, C, beta, D, flags);
+        D.convertTo(D, CV_64F);
+        EXPECT_LE(norm(D, ref, NORM_INF), eps*k) << "flags=" << flags << ", size=" << m << "x" << n << "x" << k;
+
+        if( !(flags & GEMM_3_T) )
+        {
+            gemm(A, B, alpha, C, beta, C, flags);
+            C.convertTo(C, CV_64F);
+            EXPECT_LE(norm(C, ref, NORM_INF), eps*k) << "in-place, flags=" << flags;
+        }
+    }
+}
+
+// the single-precision products are accumulated in double precision, even when the inner dimension is large
+TEST(Core_GEMM, large_k_float)
+{
+    RNG& rng = theRNG();
+    Mat A(20, 50000, CV_32F), B(50000, 24, CV_32F), A64, B64, ref, D;
+    rng.fill(A, RNG::UNIFORM, 0, 1);
+    rng.fill(B, RNG::UNIFORM, 0, 1);
+    A.convertTo(A64, CV_64F);
+    B.convertTo(B64, CV_64F);
+
+    gemm(A64, B64, 1, noArray(), 0, ref);
+    gemm(A, B, 1, noArray(), 0, D);
+    D.convertTo(D, CV_64F);
+    EXPECT_LE(norm(D, ref, NORM_INF | NORM_RELATIVE), 1e-6);
+}
+
+// with a single thread all the stripes of D are processed by one call, which must not overflow the buffers
+TEST(Core_GEMM, single_thread)
+{
+    Mat A(200, 300, CV_32F), B(300, 40, CV_32F), A64, B64, ref, D;
+    theRNG().fill(A, RNG::UNIFORM, -1, 1);
+    theRNG().fill(B, RNG::UNIFORM, -1, 1);
+    A.convertTo(A64, CV_64F);
+    B.convertTo(B64, CV_64F);
+
+    gemm(A64, B64, 1, noArray(), 0, ref);
+    {
+        NumThreadsGuard serial;
+        gemm(A, B, 1, noArray(), 0, D);
+    }
+    D.convertTo(D, CV_64F);
+    EXPECT_LE(norm(D, ref, NORM_INF), 1e-4);
+}
+
 TEST(Core_Invert, accuracy) { Core_InvertTest test; test.safe_run(); }
 TEST(Core_Mahalanobis, accuracy) { Core_MahalanobisTest test; test.safe_run(); }
 TEST(Core_MulTransposed, accuracy) { Core_MulTransposedTest test; test.safe_run(); }
@@ -2532,6 +2618,65 @@ protected:
 
 TEST(Core_KMeans, singular) { CV_KMeansSingularTest test; test.safe_run(); }
 
+TEST(Core_KMeans, flags)
+{
+    // well separated gaussian blobs
+    const int N = 3000, K = 8, dims = 6;
+    RNG rng(0x12345);
+    Mat data(N, dims, CV_32F), blob_centers(K, dims, CV_32F);
+    rng.fill(blob_centers, RNG::UNIFORM, Scalar::all(-10), Scalar::all(10));
+    for( int i = 0; i < N; i++ )
+    {
+        Mat row = data.row(i);
+        rng.fill(row, RNG::NORMAL, Scalar::all(0), Scalar::all(1));
+        row += blob_centers.row(i % K);
+    }
+    TermCriteria criteria(TermCriteria::MAX_ITER+TermCriteria::EPS, 100, 0);
+
+    // the pruning and the threads must not change the result
+    Mat labels0, centers0;
+    theRNG() = RNG(1);
+    double compactness0;
+    {
+        NumThreadsGuard serial;
+        compactness0 = kmeans(data, K, labels0, criteria, 2, KMEANS_PP_CENTERS, centers0);
+    }
+    const int flags[] = { KMEANS_PP_CENTERS, KMEANS_PP_CENTERS | KMEANS_HAMERLY };
+    for( int k = 0; k < 2; k++ )
+    {
+        Mat labels, centers;
+        theRNG() = RNG(1);
+        double compactness = kmeans(data, K, labels, criteria, 2, flags[k], centers);
+        EXPECT_EQ(compactness0, compactness) << "flags = " << flags[k];
+        EXPECT_EQ(0, cv::norm(labels, labels0, NORM_INF)) << "flags = " << flags[k];
+        EXPECT_EQ(0, cv::norm(centers, centers0, NORM_INF)) << "flags = " << flags[k];
+    }
+
+    // the same starting labels
+    Mat labels1 = labels0.clone(), labels2 = labels0.clone();
+    for( int i = 0; i < N; i += 7 )
+        labels1.at<int>(i) = labels2.at<int>(i) = (i/7) % K;
+    double c1 = kmeans(data, K, labels1, criteria, 1, KMEANS_USE_INITIAL_LABELS);
+    double c2 = kmeans(data, K, labels2, criteria, 1, KMEANS_USE_INITIAL_LABELS | KMEANS_HAMERLY);
+    EXPECT_EQ(c1, c2);
+    EXPECT_EQ(0, cv::norm(labels1, labels2, NORM_INF));
+
+    // the samples stored as a single multi-channel row
+    Mat labels3;
+    theRNG() = RNG(1);
+    double c3 = kmeans(data.reshape(dims, 1), K, labels3, criteria, 2, KMEANS_PP_CENTERS | KMEANS_HAMERLY);
+    EXPECT_EQ(compactness0, c3);
+    EXPECT_EQ(0, cv::norm(labels3.reshape(1, N), labels0, NORM_INF));
+
+    // the mini-batch clustering is approximate, but close to the full one on such data
+    Mat labels4, centers4;
+    double c4 = kmeans(data, K, labels4, criteria, 2, KMEANS_PP_CENTERS | KMEANS_MINI_BATCH, centers4);
+    EXPECT_LE(c4, compactness0*1.05);
+    ASSERT_EQ(N, labels4.rows);
+    for( int i = 0; i < N; i++ )
+        ASSERT_TRUE(0 <= labels4.at<int>(i) && labels4.at<int>(i) < K);
+}
+
 TEST(CovariationMatrixVectorOfMat, accuracy)
 {
     unsigned int col_problem_size = 8, row_problem_size = 8, vector_size = 16;
@@ -39,4 +39,119 @@ TEST(Core_OutputArraySreate, _1997)
     Size submatSize = Size(256, 256);
 
     ASSERT_NO_THROW(local::create( mat(Rect(Point(), submatSize)), submatSize, mat.type() ));
-}
\ No newline at end of file
+}
+
+TEST(Core_FastMalloc, alignment_and_pool)
+{
+    bool prevMode = setUseFastMallocPool(false);
+    for( int k = 0; k < 2; k++ )
+    {
+        setUseFastMallocPool(k == 1);
+        EXPECT_EQ(k == 1, useFastMallocPool());
+
+        size_t sizes[] = { 0, 1, 15, 64, 65, 1000, 4097, 100000, (size_t)3 << 20 };
+        for( size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++ )
+        {
+            FastMallocStats s0 = getFastMallocStats();
+            uchar* p = (uchar*)fastMalloc(sizes[i]);
+            ASSERT_TRUE(p != 0);
+            EXPECT_EQ(0u, (size_t)p % 64);
+            memset(p, 1, sizes[i]);
+            FastMallocStats s1 = getFastMallocStats();
+            EXPECT_EQ(s0.allocCalls + 1, s1.allocCalls);
+            EXPECT_GE(s1.peakBytesInUse, s1.bytesInUse);
+            fastFree(p);
+
+            // the same-size buffer should be taken from the pool
+            p = (uchar*)fastMalloc(sizes[i]);
+            FastMallocStats s2 = getFastMallocStats();
+            if( k == 1 )
+                EXPECT_EQ(s1.poolHits + 1, s2.poolHits);
+            else
+                EXPECT_EQ(s0.poolHits, s2.poolHits);
+            fastFree(p);
+        }
+
+        // the matrices use fastMalloc too
+        Mat a(480, 640, CV_8UC3, Scalar::all(1)), b = a + a;
+        EXPECT_EQ(0u, (size_t)a.data % 64);
+        EXPECT_EQ(640*480*3*2., sum(b)[0] + sum(b)[1] + sum(b)[2]);
+    }
+    releaseFastMallocPool();
+    EXPECT_EQ(0u, getFastMallocStats().bytesCached);
+    setUseFastMallocPool(prevMode);
+}
+
+TEST(Core_ScratchArena, stack_and_frames)
+{
+    resetScratchArenas(true);
+    {
+        ScratchBuffer<int> a(1000), b(100000);
+        EXPECT_EQ(0u, (size_t)(int*)a % 64);
+        EXPECT_EQ(0u, (size_t)(int*)b % 64);
+        for( int i = 0; i < 1000; i++ )
+            a[i] = i;
+        memset(b, 0, 100000*sizeof(int));
+
+        // the released buffer is reused only after the buffers above it are released
+        uchar* c = (uchar*)scratchAlloc(5000);
+        uchar* d = (uchar*)scratchAlloc(5000);
+        scratchFree(c);
+        uchar* e = (uchar*)scratchAlloc(16);
+        EXPECT_TRUE(e > d);
+        scratchFree(e);
+        scratchFree(d);
+        uchar* f = (uchar*)scratchAlloc(5000);
+        EXPECT_EQ(c, f);
+        scratchFree(f);
+
+        EXPECT_EQ(999, a[999]);
+        EXPECT_EQ(0, b[99999]);
+    }
+    // the steady state: a single chunk, no new allocations
+    size_t size0 = 0;
+    for( int iter = 0; iter < 10; iter++ )
+    {
+        ScratchBuffer<int> a(1000), b(100000);
+        if( iter == 0 )
+            size0 = getScratchArenaSize();
+        EXPECT_EQ(size0, getScratchArenaSize());
+    }
+    EXPECT_GE(size0, 101000*sizeof(int));
+
+    // the growth results in a single bigger chunk
+    {
+        ScratchBuffer<uchar> a(size0), b(size0*2);
+    }
+    size_t size1 = 0;
+    for( int iter = 0; iter < 2; iter++ )
+    {
+        ScratchBuffer<uchar> a(size0), b(size0*2);
+        if( iter == 0 )
+            size1 = getScratchArenaSize();
+        EXPECT_EQ(size1, getScratchArenaSize());
+    }
+    EXPECT_GE(size1, size0*3);
+
+    // the frame with much smaller footprint trims the arena
+    resetScratchArenas();
+    {
+        ScratchBuffer<uchar> a(100);
+    }
+    resetScratchArenas();
+    EXPECT_LT(getScratchArenaSize(), size1);
+
+    resetScratchArenas(true);
+    EXPECT_EQ(0u, getScratchArenaSize());
+
+    // the big buffers are not kept by the idle arena
+    {
+        ScratchBuffer<uchar> a(16 << 20);
+        EXPECT_GE(getScratchArenaSize(), (size_t)(16 << 20));
+    }
+    EXPECT_EQ(0u, getScratchArenaSize());
+    {
+        ScratchBuffer<uchar> a(1 << 20);
+    }
+    EXPECT_GE(getScratchArenaSize(), (size_t)(1 << 20));
+}
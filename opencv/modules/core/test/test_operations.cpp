@@ -1130,3 +1130,170 @@ protected:
 };
 
 TEST(Core_SparseMat, iterations) { CV_SparseMatTest test; test.safe_run(); }
+
+TEST(Core_SparseMat, insert_erase)
+{
+    // the erased elements leave holes in the probe sequences and in the node storage,
+    // the dense matrix is the reference
+    RNG& rng = theRNG();
+    int sz[] = { 50, 70 };
+    SparseMat_<float> m(2, sz);
+    Mat_<float> dense(sz[0], sz[1], 0.f);
+    for( int iter = 0; iter < 30000; iter++ )
+    {
+        int i = rng.uniform(0, sz[0]), j = rng.uniform(0, sz[1]);
+        if( rng.uniform(0, 3) > 0 )
+        {
+            m.ref(i, j) += 1.f;
+            dense(i, j) += 1.f;
+        }
+        else
+        {
+            m.erase(i, j);
+            dense(i, j) = 0.f;
+        }
+    }
+    Mat m_dense;
+    m.copyTo(m_dense);
+    EXPECT_EQ(0, norm(m_dense, dense, NORM_INF));
+    ASSERT_EQ(countNonZero(dense), (int)m.nzcount());
+
+    size_t n = 0;
+    for( SparseMatConstIterator it = m.begin(); it != m.end(); ++it, n++ )
+    {
+        const SparseMat::Node* node = it.node();
+        EXPECT_EQ(dense(node->idx[0], node->idx[1]), it.value<float>());
+        EXPECT_EQ(m.hash(node->idx), node->hashval);
+    }
+    EXPECT_EQ(m.nzcount(), n);
+
+    // the bulk operations
+    Mat idx, values;
+    m.getElems(idx, values);
+    ASSERT_EQ((int)m.nzcount(), idx.rows);
+    SparseMat m2(2, sz, CV_32F);
+    m2.reserve(m.nzcount());
+    m2.insert(idx, values);
+    m2.insert(idx, values, true);
+    m2.copyTo(m_dense);
+    EXPECT_EQ(0, norm(m_dense, dense*2, NORM_INF));
+
+    SparseMat m3 = m.clone();
+    m3.copyTo(m_dense);
+    EXPECT_EQ(0, norm(m_dense, dense, NORM_INF));
+    for( int i = 0; i < idx.rows; i++ )
+        m3.erase(idx.ptr<int>(i));
+    EXPECT_EQ(0u, m3.nzcount());
+    EXPECT_EQ(0, m3.value<float>(idx.ptr<int>(0)));
+
+    // erase() does not move the other elements: the erasing loop over the iterator
+    // visits every element once, and the pointers to the remaining elements stay valid
+    SparseMat_<float> m4 = m.clone();
+    std::vector<const float*> ptrs;
+    for( int i = 0; i < idx.rows; i++ )
+        ptrs.push_back(&m4.ref(idx.at<int>(i, 0), idx.at<int>(i, 1)));
+    n = 0;
+    for( SparseMatConstIterator it = m4.begin(); it != m4.end(); ++it, n++ )
+    {
+        const SparseMat::Node* node = it.node();
+        if( node->idx[0] % 2 == 0 )
+            m4.erase(node->idx);
+    }
+    EXPECT_EQ(m.nzcount(), n);
+    for( int i = 0; i < idx.rows; i++ )
+    {
+        const int* ix = idx.ptr<int>(i);
+        if( ix[0] % 2 != 0 )
+            EXPECT_EQ(ptrs[i], m4.find<float>(ix[0], ix[1]));
+        else
+            EXPECT_TRUE(m4.find<float>(ix[0], ix[1]) == 0);
+    }
+}
+
+// the fused evaluation of floating-point expressions should match the step-by-step one
+TEST(Core_MatExpr, fused_elementwise)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_32FC1, CV_32FC3, CV_64FC1 };
+
+    for( int t = 0; t < 3; t++ )
+    {
+        int type = types[t];
+        double eps = CV_MAT_DEPTH(type) == CV_32F ? 1e-4 : 1e-10;
+        Size sz(rng.uniform(1, 300), rng.uniform(2, 100));
+        Mat a(sz, type), b(sz, type), c(sz, type), d(sz, type), e(sz, type);
+        rng.fill(a, RNG::UNIFORM, -10, 10);
+        rng.fill(b, RNG::UNIFORM, -10, 10);
+        rng.fill(c, RNG::UNIFORM, -10, 10);
+        rng.fill(d, RNG::UNIFORM, 1, 10);
+        rng.fill(e, RNG::UNIFORM, -10, 10);
+
+        Mat ab, cd, ref, res;
+        multiply(a, b, ab);
+        multiply(c, d, cd);
+        add(ab, cd, ref);
+        subtract(ref, e, ref);
+        res = a.mul(b) + c.mul(d) - e;
+        EXPECT_LE(norm(res, ref, NORM_INF), eps*100);
+
+        divide(a, d, ref, 2);
+        absdiff(ref, Scalar::all(1), ref);
+        ref = ref*3 + Scalar::all(5);
+        res = abs(a/d*2 - Scalar::all(1))*3 + Scalar::all(5);
+        EXPECT_LE(norm(res, ref, NORM_INF), eps*100);
+
+        // division by zero gives zero, as in cv::divide
+        b.row(0).setTo(Scalar::all(0));
+        divide(a, b, ref);
+        add(ref, c, ref);
+        res = a/b + c;
+        Range r(1, sz.height);
+        EXPECT_LE(norm(res.rowRange(r), ref.rowRange(r), NORM_INF | NORM_RELATIVE), eps);
+        EXPECT_LE(norm(res.row(0), c.row(0), NORM_INF), 0);
+
+        res = min(a, b).mul(e) - max(c, 1.0)/d;
+        ref = Mat(min(a, b)).mul(e) - Mat(Mat(max(c, 1.0))/d);
+        EXPECT_LE(norm(res, ref, NORM_INF), eps*100);
+
+        // the result can be written into one of the operands
+        ref = a.mul(b) + a;
+        a = a.mul(b) + a;
+        EXPECT_LE(norm(a, ref, NORM_INF), eps*100);
+
+        res = (a.mul(b) + c)(Range(0, sz.height/2 + 1), Range::all());
+        ref = Mat(a.mul(b) + c)(Range(0, sz.height/2 + 1), Range::all());
+        EXPECT_LE(norm(res, ref, NORM_INF), eps*100);
+
+        if( CV_MAT_CN(type) == 1 )
+        {
+            Mat diff, mask;
+            absdiff(a, c, diff);
+            compare(diff, 3, ref, CMP_GT);
+            mask = abs(a - c) > 3;
+            EXPECT_EQ(CV_8U, mask.type());
+            EXPECT_EQ(0, countNonZero(mask != ref));
+
+            compare(a.mul(b), c, ref, CMP_LE);
+            mask = c >= a.mul(b);
+            EXPECT_EQ(0, countNonZero(mask != ref));
+        }
+    }
+
+    // operands of different types or sizes are not fused, they are reported as by the step-by-step evaluation
+    Mat_<double> da(20, 30, 1.), dc(20, 30, 2.);
+    Mat_<float> fb(20, 30, 3.f), fd(20, 30, 4.f), fe(10, 30, 5.f);
+    EXPECT_THROW(Mat(da.mul(fb) + dc.mul(fd)), cv::Exception);
+    EXPECT_THROW(Mat(da.mul(dc) - fb), cv::Exception);
+    EXPECT_THROW(Mat(fb.mul(fe) + fd), cv::Exception);
+    EXPECT_THROW(Mat(abs(fd.mul(fe))), cv::Exception);
+    EXPECT_THROW(Mat(da.mul(dc) > fb), cv::Exception);
+
+    // integer expressions keep their saturating semantics
+    Mat_<uchar> u(1, 3), v(1, 3);
+    u << 200, 10, 100;
+    v << 2, 20, 3;
+    Mat_<uchar> r = u.mul(v) - v;
+    EXPECT_EQ(253, r(0, 0));
+    EXPECT_EQ(180, r(0, 1));
+    EXPECT_EQ(252, r(0, 2));
+}
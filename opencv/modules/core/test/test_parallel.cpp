@@ -0,0 +1,226 @@
+#include "test_precomp.hpp"
+#include "opencv2/core/internal.hpp"
+
+using namespace cv;
+using namespace std;
+
+namespace
+{
+
+struct MarkInvoker
+{
+    MarkInvoker(vector<int>& _marks) : marks(&_marks) {}
+    void operator()(const BlockedRange& range) const
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+            (*marks)[i]++;
+    }
+    vector<int>* marks;
+};
+
+struct SumInvoker
+{
+    SumInvoker(const vector<int>& _data) : data(&_data), sum(0), calls(0) {}
+    SumInvoker(SumInvoker& s, Split) : data(s.data), sum(0), calls(0) {}
+    void operator()(const BlockedRange& range)
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+            sum += (*data)[i];
+        calls++;
+    }
+    void join(SumInvoker& s) { sum += s.sum; calls += s.calls; }
+
+    const vector<int>* data;
+    int64 sum;
+    int calls;
+};
+
+struct ThrowInvoker
+{
+    void operator()(const BlockedRange& range) const
+    {
+        if( range.begin() <= 500 && 500 < range.end() )
+            CV_Error(CV_StsBadArg, "stripe 500");
+    }
+};
+
+struct SquareBody
+{
+    void operator()(int& x) const { x *= x; }
+};
+
+struct TraceInvoker
+{
+    TraceInvoker(int* _calls) : calls(_calls) {}
+    void operator()(const BlockedRange&) const
+    {
+        TraceRegion region("test::stripe");
+        CV_XADD(calls, 1);
+    }
+    int* calls;
+};
+
+}
+
+TEST(Core_Parallel, for_covers_range_once)
+{
+    int grains[] = { 1, 7, 100, 5000 };
+    for( size_t g = 0; g < sizeof(grains)/sizeof(grains[0]); g++ )
+    {
+        vector<int> marks(3001, 0);
+        parallel_for(BlockedRange(1, 3001, grains[g]), MarkInvoker(marks));
+        EXPECT_EQ(0, marks[0]);
+        EXPECT_EQ(3000, countNonZero(Mat(marks) == 1));
+    }
+}
+
+TEST(Core_Parallel, reduce)
+{
+    vector<int> data(100000);
+    RNG& rng = theRNG();
+    int64 sum0 = 0;
+    for( size_t i = 0; i < data.size(); i++ )
+    {
+        data[i] = rng.uniform(-1000, 1000);
+        sum0 += data[i];
+    }
+
+    SumInvoker body(data);
+    parallel_reduce(BlockedRange(0, (int)data.size(), 64), body);
+    EXPECT_EQ(sum0, body.sum);
+    EXPECT_GE(body.calls, 1);
+}
+
+TEST(Core_Parallel, do_processes_all_items)
+{
+    vector<int> items(100);
+    for( int i = 0; i < (int)items.size(); i++ )
+        items[i] = i;
+    parallel_do(items.begin(), items.end(), SquareBody());
+    for( int i = 0; i < (int)items.size(); i++ )
+        ASSERT_EQ(i*i, items[i]);
+}
+
+TEST(Core_Parallel, exception_is_propagated)
+{
+    EXPECT_ANY_THROW(parallel_for(BlockedRange(0, 1000), ThrowInvoker()));
+    // the pool must stay usable after the failed loop
+    vector<int> marks(1000, 0);
+    parallel_for(BlockedRange(0, 1000), MarkInvoker(marks));
+    EXPECT_EQ(1000, countNonZero(Mat(marks) == 1));
+}
+
+namespace
+{
+
+struct ThreadNumInvoker
+{
+    ThreadNumInvoker(vector<int>& _tnum) : tnum(&_tnum) {}
+    void operator()(const BlockedRange& range) const
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+            (*tnum)[i] = getThreadNum();
+    }
+    vector<int>* tnum;
+};
+
+}
+
+TEST(Core_Parallel, set_num_threads)
+{
+    setNumThreads(4);
+    EXPECT_EQ(4, getNumThreads());
+
+    vector<int> marks(10000, 0), tnum(10000, -1);
+    parallel_for(BlockedRange(0, 10000), MarkInvoker(marks));
+    parallel_for(BlockedRange(0, 10000, 16), ThreadNumInvoker(tnum));
+    EXPECT_EQ(10000, countNonZero(Mat(marks) == 1));
+    double minVal = 0, maxVal = 0;
+    minMaxLoc(Mat(tnum), &minVal, &maxVal);
+    EXPECT_GE(minVal, 0);
+    EXPECT_LT(maxVal, 4);
+
+    vector<int> data(10000, 1);
+    SumInvoker body(data);
+    parallel_reduce(BlockedRange(0, 10000), body);
+    EXPECT_EQ(10000, body.sum);
+
+    setNumThreads(1);
+    EXPECT_EQ(1, getNumThreads());
+    setNumThreads(0);
+    EXPECT_GE(getNumThreads(), 1);
+}
+
+TEST(Core_Parallel, num_threads_guard)
+{
+    setNumThreads(4);
+    {
+        NumThreadsGuard guard(2);
+        EXPECT_EQ(2, getNumThreads());
+        {
+            NumThreadsGuard serial;
+            EXPECT_EQ(1, getNumThreads());
+
+            vector<int> tnum(1000, -1);
+            parallel_for(BlockedRange(0, 1000), ThreadNumInvoker(tnum));
+            EXPECT_EQ(0, countNonZero(Mat(tnum)));
+        }
+        EXPECT_EQ(2, getNumThreads());
+    }
+    EXPECT_EQ(4, getNumThreads());
+    setNumThreads(0);
+}
+
+TEST(Core_Parallel, trace_regions)
+{
+    bool enabled = isTraceEnabled();
+    setTraceEnabled(true);
+    resetTrace();
+
+    int calls = 0;
+    {
+        TraceRegion region("test::loop");
+        parallel_for(BlockedRange(0, 1000, 10), TraceInvoker(&calls));
+    }
+    setTraceEnabled(false);
+    {
+        TraceRegion region("test::loop");
+    }
+
+    vector<TraceStat> stats;
+    getTraceSummary(stats);
+    const TraceStat *loop = 0, *stripe = 0;
+    for( size_t i = 0; i < stats.size(); i++ )
+    {
+        if( stats[i].name == "test::loop" )
+            loop = &stats[i];
+        else if( stats[i].name == "test::stripe" )
+            stripe = &stats[i];
+    }
+    ASSERT_TRUE(loop != 0 && stripe != 0);
+    EXPECT_EQ(1, loop->count);
+    EXPECT_EQ(calls, stripe->count);
+    EXPECT_LE(stripe->minTime, stripe->maxTime);
+    EXPECT_LE(stripe->maxTime, loop->totalTime);
+    EXPECT_GE(loop->totalTime, loop->minTime);
+
+    string filename = tempfile(".json");
+    writeTrace(filename);
+    FILE* f = fopen(filename.c_str(), "rt");
+    ASSERT_TRUE(f != 0);
+    string json;
+    char buf[1024];
+    size_t n;
+    while( (n = fread(buf, 1, sizeof(buf), f)) > 0 )
+        json.append(buf, n);
+    fclose(f);
+    remove(filename.c_str());
+    EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+    EXPECT_NE(string::npos, json.find("\"name\":\"test::loop\",\"cat\":\"opencv\",\"ph\":\"X\""));
+    EXPECT_NE(string::npos, json.find("\"name\":\"test::stripe\""));
+
+    resetTrace();
+    getTraceSummary(stats);
+    EXPECT_TRUE(stats.empty());
+    setTraceEnabled(enabled);
+}
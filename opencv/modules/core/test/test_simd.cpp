@@ -0,0 +1,156 @@
+#include "test_precomp.hpp"
+#include "opencv2/core/simd.hpp"
+
+using namespace cv;
+using namespace std;
+
+namespace
+{
+
+template<typename _Tpvec> void storeLanes(const _Tpvec& a, vector<typename _Tpvec::lane_type>& buf)
+{
+    buf.resize(_Tpvec::nlanes);
+    v_store(&buf[0], a);
+}
+
+template<typename _Tp> void fillRandom(RNG& rng, vector<_Tp>& buf, int n)
+{
+    buf.resize(n);
+    for( int i = 0; i < n; i++ )
+        buf[i] = saturate_cast<_Tp>(rng.uniform(-70000., 70000.));
+}
+
+// checks the wrapper arithmetic against saturate_cast, lane by lane
+template<typename _Tpvec> void checkArithm(RNG& rng)
+{
+    typedef typename _Tpvec::lane_type _Tp;
+    const int n = _Tpvec::nlanes;
+    vector<_Tp> a, b, r;
+    fillRandom(rng, a, n);
+    fillRandom(rng, b, n);
+    _Tpvec va = v_load(&a[0]), vb = v_load(&b[0]);
+
+    storeLanes(va + vb, r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(saturate_cast<_Tp>(a[i] + b[i]), r[i]);
+    storeLanes(va - vb, r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(saturate_cast<_Tp>(a[i] - b[i]), r[i]);
+    storeLanes(v_min(va, vb), r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(std::min(a[i], b[i]), r[i]);
+    storeLanes(v_max(va, vb), r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(std::max(a[i], b[i]), r[i]);
+    storeLanes(v_select(va > vb, va, vb), r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(a[i] > b[i] ? a[i] : b[i], r[i]);
+    storeLanes(v_select(va <= vb, va, vb), r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(a[i] <= b[i] ? a[i] : b[i], r[i]);
+    storeLanes(v_select(va == va, vb, va), r);
+    for( int i = 0; i < n; i++ )
+        EXPECT_EQ(b[i], r[i]);
+}
+
+}
+
+TEST(Core_SIMD, arithm)
+{
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        checkArithm<v_uint8>(rng);
+        checkArithm<v_int8>(rng);
+        checkArithm<v_uint16>(rng);
+        checkArithm<v_int16>(rng);
+        checkArithm<v_int32>(rng);
+        checkArithm<v_float32>(rng);
+    #if CV_SIMD_64F
+        checkArithm<v_float64>(rng);
+    #endif
+    }
+}
+
+TEST(Core_SIMD, pack_expand)
+{
+    RNG& rng = theRNG();
+    vector<int> a, b;
+    vector<short> s16, r16;
+    vector<ushort> r16u;
+    vector<uchar> r8;
+    vector<int> r32;
+    const int n = v_int32::nlanes;
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        fillRandom(rng, a, n);
+        fillRandom(rng, b, n);
+
+        storeLanes(v_pack(v_load(&a[0]), v_load(&b[0])), r16);
+        storeLanes(v_pack_u(v_load(&a[0]), v_load(&b[0])), r16u);
+        for( int i = 0; i < n; i++ )
+        {
+            EXPECT_EQ(saturate_cast<short>(a[i]), r16[i]);
+            EXPECT_EQ(saturate_cast<short>(b[i]), r16[i+n]);
+            EXPECT_EQ(saturate_cast<ushort>(a[i]), r16u[i]);
+            EXPECT_EQ(saturate_cast<ushort>(b[i]), r16u[i+n]);
+        }
+
+        fillRandom(rng, s16, v_int16::nlanes*2);
+        storeLanes(v_pack_u(v_load(&s16[0]), v_load(&s16[v_int16::nlanes])), r8);
+        for( int i = 0; i < v_int16::nlanes*2; i++ )
+            EXPECT_EQ(saturate_cast<uchar>(s16[i]), r8[i]);
+
+        v_int32 e0, e1;
+        v_expand(v_load(&s16[0]), e0, e1);
+        storeLanes(e0, r32);
+        for( int i = 0; i < n; i++ )
+            EXPECT_EQ((int)s16[i], r32[i]);
+        storeLanes(e1, r32);
+        for( int i = 0; i < n; i++ )
+            EXPECT_EQ((int)s16[i+n], r32[i]);
+        storeLanes(v_load_expand(&s16[0]), r32);
+        for( int i = 0; i < n; i++ )
+            EXPECT_EQ((int)s16[i], r32[i]);
+    }
+}
+
+TEST(Core_SIMD, float_ops)
+{
+    RNG& rng = theRNG();
+    const int n = v_float32::nlanes;
+    vector<float> a(n), r;
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        float sum = 0.f, mx = -FLT_MAX;
+        for( int i = 0; i < n; i++ )
+        {
+            a[i] = rng.uniform(-1000.f, 1000.f);
+            sum += a[i];
+            mx = std::max(mx, a[i]);
+        }
+        v_float32 va = v_load(&a[0]);
+
+        EXPECT_NEAR(sum, v_reduce_sum(va), 1e-2);
+        EXPECT_EQ(mx, v_reduce_max(va));
+
+        storeLanes(v_absdiff(va, v_setzero_f32()), r);
+        for( int i = 0; i < n; i++ )
+            EXPECT_EQ(std::abs(a[i]), r[i]);
+
+        storeLanes(v_cvt_f32(v_round(va)), r);
+        for( int i = 0; i < n; i++ )
+            EXPECT_EQ((float)cvRound(a[i]), r[i]);
+
+        storeLanes(v_sqrt(v_abs(va)), r);
+        for( int i = 0; i < n; i++ )
+            EXPECT_NEAR(std::sqrt(std::abs(a[i])), r[i], 1e-3);
+
+        int mask = v_signmask(va), refmask = 0;
+        for( int i = 0; i < n; i++ )
+            refmask |= (a[i] < 0) << i;
+        EXPECT_EQ(refmask, mask);
+    }
+}
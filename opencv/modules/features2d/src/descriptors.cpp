@@ -57,6 +57,7 @@ DescriptorExtractor::~DescriptorExtractor()
 
 void DescriptorExtractor::compute( const Mat& image, vector<KeyPoint>& keypoints, Mat& descriptors ) const
 {
+    CV_TRACE_REGION("cv::DescriptorExtractor::compute");
     if( image.empty() || keypoints.empty() )
     {
         descriptors.release();
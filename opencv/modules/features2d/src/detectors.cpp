@@ -55,6 +55,7 @@ FeatureDetector::~FeatureDetector()
 
 void FeatureDetector::detect( const Mat& image, vector<KeyPoint>& keypoints, const Mat& mask ) const
 {
+    CV_TRACE_REGION("cv::FeatureDetector::detect");
     keypoints.clear();
 
     if( image.empty() )
@@ -188,6 +188,7 @@ static int cornerScore(const uchar* ptr, const int pixel[], int threshold)
 
 void FAST(InputArray _img, std::vector<KeyPoint>& keypoints, int threshold, bool nonmax_suppression)
 {
+    CV_TRACE_REGION("cv::FAST");
     Mat img = _img.getMat();
     const int K = 8, N = 16 + K + 1;
     int i, j, k, pixel[N];
@@ -238,6 +238,7 @@ void DescriptorMatcher::radiusMatch( const Mat& queryDescriptors, const Mat& tra
 
 void DescriptorMatcher::match( const Mat& queryDescriptors, vector<DMatch>& matches, const vector<Mat>& masks )
 {
+    CV_TRACE_REGION("cv::DescriptorMatcher::match");
     vector<vector<DMatch> > knnMatches;
     knnMatch( queryDescriptors, knnMatches, 1, masks, true /*compactResult*/ );
     convertMatches( knnMatches, matches );
@@ -265,6 +266,7 @@ void DescriptorMatcher::checkMasks( const vector<Mat>& masks, int queryDescripto
 void DescriptorMatcher::knnMatch( const Mat& queryDescriptors, vector<vector<DMatch> >& matches, int knn,
                                   const vector<Mat>& masks, bool compactResult )
 {
+    CV_TRACE_REGION("cv::DescriptorMatcher::knnMatch");
     matches.clear();
     if( empty() || queryDescriptors.empty() )
         return;
@@ -280,6 +282,7 @@ void DescriptorMatcher::knnMatch( const Mat& queryDescriptors, vector<vector<DMa
 void DescriptorMatcher::radiusMatch( const Mat& queryDescriptors, vector<vector<DMatch> >& matches, float maxDistance,
                                      const vector<Mat>& masks, bool compactResult )
 {
+    CV_TRACE_REGION("cv::DescriptorMatcher::radiusMatch");
     matches.clear();
     if( empty() || queryDescriptors.empty() )
         return;
@@ -723,6 +723,7 @@ static void computeDescriptors(const Mat& image, vector<KeyPoint>& keypoints, Ma
 void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _keypoints,
                       OutputArray _descriptors, bool useProvidedKeypoints) const
 {
+    CV_TRACE_REGION("cv::ORB::operator()");
     bool do_keypoints = !useProvidedKeypoints;
     bool do_descriptors = _descriptors.needed();
 
@@ -181,7 +181,10 @@ enum
     IMWRITE_PNG_STRATEGY_HUFFMAN_ONLY =2,
     IMWRITE_PNG_STRATEGY_RLE =3,
     IMWRITE_PNG_STRATEGY_FIXED =4,
-    IMWRITE_PXM_BINARY =32
+    IMWRITE_PXM_BINARY =32,
+    IMWRITE_EXR_TYPE =48,
+    IMWRITE_EXR_TYPE_HALF =1,
+    IMWRITE_EXR_TYPE_FLOAT =2
 };
     
 CV_EXPORTS_W Mat imread( const string& filename, int flags=1 );
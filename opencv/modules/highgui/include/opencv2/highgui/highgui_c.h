@@ -222,7 +222,10 @@ enum
     CV_IMWRITE_PNG_STRATEGY_HUFFMAN_ONLY =2,
     CV_IMWRITE_PNG_STRATEGY_RLE =3,
     CV_IMWRITE_PNG_STRATEGY_FIXED =4,
-    CV_IMWRITE_PXM_BINARY =32
+    CV_IMWRITE_PXM_BINARY =32,
+    CV_IMWRITE_EXR_TYPE =48,
+    CV_IMWRITE_EXR_TYPE_HALF =1,
+    CV_IMWRITE_EXR_TYPE_FLOAT =2
 };
 
 /* save image to file */
@@ -577,7 +577,7 @@ bool  ExrEncoder::isFormatSupported( int depth ) const
 
 
 // TODO scale appropriately
-bool  ExrEncoder::write( const Mat& img, const vector<int>& )
+bool  ExrEncoder::write( const Mat& img, const vector<int>& params )
 {
     int width = img.cols, height = img.rows;
     int depth = img.depth(), channels = img.channels();
@@ -590,8 +590,15 @@ bool  ExrEncoder::write( const Mat& img, const vector<int>& )
 
     Header header( width, height );
     Imf::PixelType type;
+    bool halfstore = false;
 
-    if(depth == 8)
+    for( size_t i = 0; i + 1 < params.size(); i += 2 )
+    {
+        if( params[i] == CV_IMWRITE_EXR_TYPE )
+            halfstore = params[i+1] == CV_IMWRITE_EXR_TYPE_HALF;
+    }
+
+    if(depth == 8 || (isfloat && halfstore))
         type = HALF;
     else if(isfloat)
         type = FLOAT;
@@ -624,7 +631,7 @@ bool  ExrEncoder::write( const Mat& img, const vector<int>& )
         bufferstep = step;
         size = 4;
     }
-    else if( depth > 16 || type == UINT )
+    else if( type == UINT || (depth > 16 && type != HALF) )
     {
         buffer = (char *)new unsigned[width * channels];
         bufferstep = 0;
@@ -707,6 +714,13 @@ bool  ExrEncoder::write( const Mat& img, const vector<int>& )
                     for(int i = 0; i < width * channels; i++)
                         buf[i] = sd[i];
                 }
+                else if( depth == 32 )
+                {
+                    // half has the IEEE binary16 layout produced by convertFp16
+                    Mat src( 1, width * channels, CV_32F, data );
+                    Mat dst( 1, width * channels, CV_16S, buf );
+                    convertFp16( src, dst );
+                }
             }
             try
             {
@@ -389,15 +389,38 @@ CV_EXPORTS_W void copyMakeBorder( InputArray src, OutputArray dst,
 
 //! smooths the image using median filter.
 CV_EXPORTS_W void medianBlur( InputArray src, OutputArray dst, int ksize );
+//! the GaussianBlur algorithm
+enum
+{
+    GAUSSIAN_EXACT=0, //!< the convolution with the sampled kernel
+    GAUSSIAN_RECURSIVE=1 //!< the recursive (IIR) approximation, its cost does not depend on sigma
+};
+
 //! smooths the image using Gaussian filter.
 CV_EXPORTS_W void GaussianBlur( InputArray src,
                                                OutputArray dst, Size ksize,
                                                double sigmaX, double sigmaY=0,
                                                int borderType=BORDER_DEFAULT );
+//! smooths the image using Gaussian filter computed with the specified algorithm (GAUSSIAN_EXACT or GAUSSIAN_RECURSIVE)
+CV_EXPORTS_W void GaussianBlur( InputArray src, OutputArray dst, Size ksize,
+                                double sigmaX, double sigmaY, int borderType, int method );
+//! the bilateralFilter algorithm
+enum
+{
+    BILATERAL_EXACT=0, //!< the weighted sum over the neighborhood of diameter d
+    BILATERAL_GRID=1 //!< the bilateral grid approximation, its cost does not depend on sigmaSpace
+};
+
 //! smooths the image using bilateral filter
 CV_EXPORTS_W void bilateralFilter( InputArray src, OutputArray dst, int d,
                                    double sigmaColor, double sigmaSpace,
                                    int borderType=BORDER_DEFAULT );
+//! smooths the image using bilateral filter computed with the specified algorithm (BILATERAL_EXACT or BILATERAL_GRID).
+//! BILATERAL_GRID indexes a 3-channel image by the sum of the channels and averages all the channels with the same
+//! weights, so it misses the edges where the channels change in the opposite directions and keep the sum
+CV_EXPORTS_W void bilateralFilter( InputArray src, OutputArray dst, int d,
+                                   double sigmaColor, double sigmaSpace,
+                                   int borderType, int method );
 //! smooths the image using the box filter. Each pixel is processed in O(1) time
 CV_EXPORTS_W void boxFilter( InputArray src, OutputArray dst, int ddepth,
                              Size ksize, Point anchor=Point(-1,-1),
@@ -1019,6 +1042,67 @@ enum
 //! converts image from one color space to another
 CV_EXPORTS_W void cvtColor( InputArray src, OutputArray dst, int code, int dstCn=0 );
 
+class ImagePipelineStage;
+
+/*!
+ The chain of image processing operations computed by tiles.
+
+ The methods record the operations with the same parameters as the functions of the same names
+ (without the source and the destination). run() computes the whole chain by horizontal tiles
+ of the destination image in parallel: for each tile it finds the rows of every intermediate
+ image the tile depends on (including the filter kernel halos), and passes them from one
+ operation to the next in small per-thread buffers that stay in cache, so the intermediate
+ images are never stored in full. The result is the same as of the sequence of the function calls
+ with the border extrapolation done at the borders of each intermediate image.
+*/
+class CV_EXPORTS ImagePipeline
+{
+public:
+    ImagePipeline();
+    ImagePipeline(const ImagePipeline& p);
+    ImagePipeline& operator = (const ImagePipeline& p);
+    ~ImagePipeline();
+
+    //! adds cvtColor(); the Bayer and the YUV 4:2:0 conversions are not supported
+    ImagePipeline& cvtColor(int code, int dstCn=0);
+    //! adds resize(); INTER_AREA is not supported
+    ImagePipeline& resize(Size dsize, double fx=0, double fy=0, int interpolation=INTER_LINEAR);
+    //! adds GaussianBlur()
+    ImagePipeline& GaussianBlur(Size ksize, double sigma1, double sigma2=0,
+                                int borderType=BORDER_DEFAULT);
+    //! adds boxFilter()
+    ImagePipeline& boxFilter(int ddepth, Size ksize, Point anchor=Point(-1,-1),
+                             bool normalize=true, int borderType=BORDER_DEFAULT);
+    //! adds Sobel(); ksize=CV_SCHARR gives Scharr()
+    ImagePipeline& Sobel(int ddepth, int dx, int dy, int ksize=3, double scale=1,
+                         double delta=0, int borderType=BORDER_DEFAULT);
+    //! adds sepFilter2D()
+    ImagePipeline& sepFilter2D(int ddepth, InputArray kernelX, InputArray kernelY,
+                               Point anchor=Point(-1,-1), double delta=0,
+                               int borderType=BORDER_DEFAULT);
+    //! adds threshold(); THRESH_OTSU is not supported
+    ImagePipeline& threshold(double thresh, double maxval, int type);
+    //! adds Mat::convertTo()
+    ImagePipeline& convertTo(int rtype, double alpha=1, double beta=0);
+
+    //! computes the chain for the source image. src is processed as an isolated image
+    void run(InputArray src, OutputArray dst) const;
+
+    //! returns true if no operations have been added
+    bool empty() const;
+    //! removes all the operations
+    void clear();
+    //! sets the approximate size of the tile buffers of one thread in bytes; 0 means the default
+    void setTileBufSize(int size);
+    int getTileBufSize() const;
+
+protected:
+    ImagePipeline& add(ImagePipelineStage* stage);
+
+    vector<Ptr<ImagePipelineStage> > stages;
+    int tileBufSize;
+};
+
 //! raster image moments
 class CV_EXPORTS_W_MAP Moments
 {
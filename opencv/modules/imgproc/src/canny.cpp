@@ -45,6 +45,7 @@ void cv::Canny( InputArray _src, OutputArray _dst,
                 double low_thresh, double high_thresh,
                 int aperture_size, bool L2gradient )
 {
+    CV_TRACE_REGION("cv::Canny");
     Mat src = _src.getMat();
     CV_Assert( src.depth() == CV_8U );
     
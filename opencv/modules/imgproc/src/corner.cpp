@@ -319,6 +319,7 @@ void cv::cornerMinEigenVal( InputArray _src, OutputArray _dst, int blockSize, in
 
 void cv::cornerHarris( InputArray _src, OutputArray _dst, int blockSize, int ksize, double k, int borderType )
 {
+    CV_TRACE_REGION("cv::cornerHarris");
     Mat src = _src.getMat();
     _dst.create( src.size(), CV_32F );
     Mat dst = _dst.getMat();
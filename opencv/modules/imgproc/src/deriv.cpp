@@ -473,6 +473,7 @@ static bool IPPDeriv(const Mat& src, Mat& dst, int ddepth, int dx, int dy, int k
 void cv::Sobel( InputArray _src, OutputArray _dst, int ddepth, int dx, int dy,
                 int ksize, double scale, double delta, int borderType )
 {
+    CV_TRACE_REGION("cv::Sobel");
     Mat src = _src.getMat();
     if (ddepth < 0)
         ddepth = src.depth();
@@ -552,9 +553,74 @@ void cv::Scharr( InputArray _src, OutputArray _dst, int ddepth, int dx, int dy,
 }
 
 
+namespace cv
+{
+
+// computes d2x + d2y for a stripe of rows; the stripe is a ROI of the whole image,
+// so its borders are taken from the neighbour rows
+class LaplacianInvoker
+{
+public:
+    LaplacianInvoker( const Mat& _src, const Mat& _dst, int _nstripes, const Mat& _kd, const Mat& _ks,
+                      int _wtype, double _scale, double _delta, int _borderType ) :
+        src(_src), dst(_dst), nstripes(_nstripes), kd(_kd), ks(_ks),
+        wtype(_wtype), scale(_scale), delta(_delta), borderType(_borderType)
+    {
+    }
+
+    void operator () ( const BlockedRange& range ) const
+    {
+        const size_t STRIPE_SIZE = 1 << 14;
+
+        int row0 = (int)((int64)src.rows*range.begin()/nstripes);
+        int row1 = (int)((int64)src.rows*range.end()/nstripes);
+        if( row0 >= row1 )
+            return;
+        Mat srcStripe = src.rowRange(row0, row1), dstStripe = dst.rowRange(row0, row1);
+
+        int dy0 = std::min(std::max((int)(STRIPE_SIZE/(getElemSize(src.type())*src.cols)), 1), srcStripe.rows);
+        Ptr<FilterEngine> fx = createSeparableLinearFilter(src.type(),
+            wtype, kd, ks, Point(-1,-1), 0, borderType, borderType, Scalar() );
+        Ptr<FilterEngine> fy = createSeparableLinearFilter(src.type(),
+            wtype, ks, kd, Point(-1,-1), 0, borderType, borderType, Scalar() );
+
+        int y = fx->start(srcStripe), dsty = 0, dy = 0;
+        fy->start(srcStripe);
+        const uchar* sptr = srcStripe.data + y*srcStripe.step;
+
+        Mat d2x( dy0 + kd.rows - 1, src.cols, wtype );
+        Mat d2y( dy0 + kd.rows - 1, src.cols, wtype );
+
+        for( ; dsty < srcStripe.rows; sptr += dy0*srcStripe.step, dsty += dy )
+        {
+            fx->proceed( sptr, (int)srcStripe.step, dy0, d2x.data, (int)d2x.step );
+            dy = fy->proceed( sptr, (int)srcStripe.step, dy0, d2y.data, (int)d2y.step );
+            if( dy > 0 )
+            {
+                Mat dstripe = dstStripe.rowRange(dsty, dsty + dy);
+                d2x.rows = d2y.rows = dy; // modify the headers, which should work
+                d2x += d2y;
+                d2x.convertTo( dstripe, dst.type(), scale, delta );
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int nstripes;
+    Mat kd, ks;
+    int wtype;
+    double scale, delta;
+    int borderType;
+};
+
+}
+
 void cv::Laplacian( InputArray _src, OutputArray _dst, int ddepth, int ksize,
                     double scale, double delta, int borderType )
 {
+    CV_TRACE_REGION("cv::Laplacian");
     Mat src = _src.getMat();    
     if (ddepth < 0)
         ddepth = src.depth();
@@ -573,43 +639,17 @@ void cv::Laplacian( InputArray _src, OutputArray _dst, int ddepth, int ksize,
     }
     else
     {
-        const size_t STRIPE_SIZE = 1 << 14;
-
         int depth = src.depth();
         int ktype = std::max(CV_32F, std::max(ddepth, depth));
         int wdepth = depth == CV_8U && ksize <= 5 ? CV_16S : depth <= CV_32F ? CV_32F : CV_64F;
         int wtype = CV_MAKETYPE(wdepth, src.channels());
         Mat kd, ks;
         getSobelKernels( kd, ks, 2, 0, ksize, false, ktype );
-        if( ddepth < 0 )
-            ddepth = src.depth();
-        int dtype = CV_MAKETYPE(ddepth, src.channels());
-
-        int dy0 = std::min(std::max((int)(STRIPE_SIZE/(getElemSize(src.type())*src.cols)), 1), src.rows);
-        Ptr<FilterEngine> fx = createSeparableLinearFilter(src.type(),
-            wtype, kd, ks, Point(-1,-1), 0, borderType, borderType, Scalar() ); 
-        Ptr<FilterEngine> fy = createSeparableLinearFilter(src.type(),
-            wtype, ks, kd, Point(-1,-1), 0, borderType, borderType, Scalar() );
-
-        int y = fx->start(src), dsty = 0, dy = 0;
-        fy->start(src);
-        const uchar* sptr = src.data + y*src.step;
-
-        Mat d2x( dy0 + kd.rows - 1, src.cols, wtype );
-        Mat d2y( dy0 + kd.rows - 1, src.cols, wtype );
 
-        for( ; dsty < src.rows; sptr += dy0*src.step, dsty += dy )
-        {
-            fx->proceed( sptr, (int)src.step, dy0, d2x.data, (int)d2x.step );
-            dy = fy->proceed( sptr, (int)src.step, dy0, d2y.data, (int)d2y.step );
-            if( dy > 0 )
-            {
-                Mat dstripe = dst.rowRange(dsty, dsty + dy);
-                d2x.rows = d2y.rows = dy; // modify the headers, which should work
-                d2x += d2y;
-                d2x.convertTo( dstripe, dtype, scale, delta );
-            }
-        }
+        int nstripes = getFilterStripes(src, dst);
+        nstripes = std::max(std::min(nstripes, src.rows/std::max(ksize*4, 32)), 1);
+        parallel_for( BlockedRange(0, nstripes),
+                      LaplacianInvoker(src, dst, nstripes, kd, ks, wtype, scale, delta, borderType) );
     }
 }
 
@@ -57,6 +57,7 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
                               InputArray _mask, int blockSize,
                               bool useHarrisDetector, double harrisK )
 {
+    CV_TRACE_REGION("cv::goodFeaturesToTrack");
     Mat image = _image.getMat(), mask = _mask.getMat();
     
     CV_Assert( qualityLevel > 0 && minDistance >= 0 && maxCorners >= 0 );
@@ -451,6 +451,72 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
              dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
 }
 
+
+/*
+ Stripe-parallel filtering. The image is split into horizontal stripes, each one is filtered
+ by its own engine as a ROI of the whole image, so the rows above and below the stripe are
+ read from the image itself and the border is interpolated exactly as in the serial case.
+ Every stripe re-filters (ksize.height - 1) rows of its neighbours, so the stripes are
+ kept several times taller than the kernel.
+*/
+
+enum { FILTER_STRIPE_MIN_ROWS = 32, FILTER_PARALLEL_MIN_AREA = 1 << 16 };
+
+int getFilterStripes( const Mat& src, const Mat& dst )
+{
+#ifdef HAVE_PARALLEL_FRAMEWORK
+    int nt = getNumThreads();
+    // the in-place filtering is serial: a stripe would read the rows already filtered by its neighbour
+    if( nt > 1 && src.rows >= FILTER_STRIPE_MIN_ROWS*2 &&
+        (size_t)src.rows*src.cols*src.channels() >= (size_t)FILTER_PARALLEL_MIN_AREA &&
+        (dst.dataend <= src.datastart || src.dataend <= dst.datastart) )
+        return std::min(nt, src.rows/FILTER_STRIPE_MIN_ROWS);
+#else
+    (void)src; (void)dst;
+#endif
+    return 1;
+}
+
+class FilterStripeInvoker
+{
+public:
+    FilterStripeInvoker( Ptr<FilterEngine>* _engines, int _nstripes,
+                         const Mat& _src, const Mat& _dst, bool _isolated ) :
+        engines(_engines), nstripes(_nstripes), src(_src), dst(_dst), isolated(_isolated)
+    {
+    }
+
+    void operator () ( const BlockedRange& range ) const
+    {
+        int y0 = (int)((int64)src.rows*range.begin()/nstripes);
+        int y1 = (int)((int64)src.rows*range.end()/nstripes);
+        Mat _dst = dst;
+        if( y0 < y1 )
+            engines[range.begin()]->apply( src, _dst, Rect(0, y0, src.cols, y1 - y0),
+                                           Point(0, y0), isolated );
+    }
+
+private:
+    Ptr<FilterEngine>* engines;
+    int nstripes;
+    Mat src;
+    Mat dst;
+    bool isolated;
+};
+
+void applyFilterStripes( vector<Ptr<FilterEngine> >& engines, const Mat& src, Mat& dst, bool isolated )
+{
+    CV_Assert( !engines.empty() && src.size() == dst.size() );
+    int minRows = std::max(engines[0]->ksize.height*4, (int)FILTER_STRIPE_MIN_ROWS);
+    int nstripes = std::min((int)engines.size(), src.rows/minRows);
+
+    if( nstripes <= 1 )
+        engines[0]->apply( src, dst, Rect(0,0,-1,-1), Point(), isolated );
+    else
+        parallel_for( BlockedRange(0, nstripes),
+                      FilterStripeInvoker(&engines[0], nstripes, src, dst, isolated) );
+}
+
 }
 
 /****************************************************************************************\
@@ -3232,6 +3298,7 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
                    InputArray _kernel, Point anchor,
                    double delta, int borderType )
 {
+    CV_TRACE_REGION("cv::filter2D");
     Mat src = _src.getMat(), kernel = _kernel.getMat();
 
     if( ddepth < 0 )
@@ -3256,10 +3323,14 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
     if( kernel.cols*kernel.rows >= dft_filter_size )
     {
         Mat temp;
+        ScratchBuffer<uchar> tempBuf;
         if( src.data != dst.data )
             temp = dst;
         else
-            temp.create(dst.size(), dst.type());
+        {
+            tempBuf.allocate(dst.total()*dst.elemSize());
+            temp = Mat(dst.size(), dst.type(), (uchar*)tempBuf);
+        }
         crossCorr( src, kernel, temp, src.size(),
                    CV_MAKETYPE(ddepth, src.channels()),
                    anchor, delta, borderType );
@@ -3268,9 +3339,11 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
         return;
     }
 
-    Ptr<FilterEngine> f = createLinearFilter(src.type(), dst.type(), kernel,
-                                             anchor, delta, borderType & ~BORDER_ISOLATED );
-    f->apply(src, dst, Rect(0,0,-1,-1), Point(), (borderType & BORDER_ISOLATED) != 0 );
+    vector<Ptr<FilterEngine> > f(getFilterStripes(src, dst));
+    for( size_t i = 0; i < f.size(); i++ )
+        f[i] = createLinearFilter(src.type(), dst.type(), kernel,
+                                  anchor, delta, borderType & ~BORDER_ISOLATED );
+    applyFilterStripes(f, src, dst, (borderType & BORDER_ISOLATED) != 0 );
 }
 
 
@@ -3278,6 +3351,7 @@ void cv::sepFilter2D( InputArray _src, OutputArray _dst, int ddepth,
                       InputArray _kernelX, InputArray _kernelY, Point anchor,
                       double delta, int borderType )
 {
+    CV_TRACE_REGION("cv::sepFilter2D");
     Mat src = _src.getMat(), kernelX = _kernelX.getMat(), kernelY = _kernelY.getMat();
 
     if( ddepth < 0 )
@@ -3286,9 +3360,11 @@ void cv::sepFilter2D( InputArray _src, OutputArray _dst, int ddepth,
     _dst.create( src.size(), CV_MAKETYPE(ddepth, src.channels()) );
     Mat dst = _dst.getMat();
 
-    Ptr<FilterEngine> f = createSeparableLinearFilter(src.type(),
-        dst.type(), kernelX, kernelY, anchor, delta, borderType & ~BORDER_ISOLATED );
-    f->apply(src, dst, Rect(0,0,-1,-1), Point(), (borderType & BORDER_ISOLATED) != 0 );
+    vector<Ptr<FilterEngine> > f(getFilterStripes(src, dst));
+    for( size_t i = 0; i < f.size(); i++ )
+        f[i] = createSeparableLinearFilter(src.type(),
+            dst.type(), kernelX, kernelY, anchor, delta, borderType & ~BORDER_ISOLATED );
+    applyFilterStripes(f, src, dst, (borderType & BORDER_ISOLATED) != 0 );
 }
 
 
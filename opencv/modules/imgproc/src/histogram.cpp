@@ -597,6 +597,7 @@ void cv::calcHist( const Mat* images, int nimages, const int* channels,
                    InputArray _mask, OutputArray _hist, int dims, const int* histSize,
                    const float** ranges, bool uniform, bool accumulate )
 {
+    CV_TRACE_REGION("cv::calcHist");
     Mat mask = _mask.getMat();
 
     CV_Assert(dims > 0 && histSize);
@@ -2454,6 +2455,7 @@ CV_IMPL void cvEqualizeHist( const CvArr* srcarr, CvArr* dstarr )
 
 void cv::equalizeHist( InputArray _src, OutputArray _dst )
 {
+    CV_TRACE_REGION("cv::equalizeHist");
     Mat src = _src.getMat();
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
@@ -240,93 +240,110 @@ template<typename ST, typename DT, int bits> struct FixedPtCast
 *                                         Resize                                         *
 \****************************************************************************************/
 
-static void
-resizeNN( const Mat& src, Mat& dst, double fx, double fy )
-{
-    Size ssize = src.size(), dsize = dst.size();
-    AutoBuffer<int> _x_ofs(dsize.width);
-    int* x_ofs = _x_ofs;
-    int pix_size = (int)src.elemSize();
-    int pix_size4 = (int)(pix_size / sizeof(int));
-    double ifx = 1./fx, ify = 1./fy;
-    int x, y;
+// The resize and the warp loops are split into the horizontal stripes of at least
+// WARP_STRIPE_MIN_AREA destination elements, which are processed by parallel_for.
+enum { WARP_STRIPE_MIN_AREA = 1 << 15 };
+
+static inline BlockedRange warpStripes( int rows, int width )
+{
+    return BlockedRange(0, rows, std::max(1, (int)WARP_STRIPE_MIN_AREA/std::max(width, 1)));
+}
 
-    for( x = 0; x < dsize.width; x++ )
+class resizeNNInvoker
+{
+public:
+    resizeNNInvoker( const Mat& _src, int _srcY0, int _srcHeight, Mat& _dst, int _dstY0,
+                     const int* _x_ofs, double _ify ) :
+        src(_src), dst(_dst), srcY0(_srcY0), srcHeight(_srcHeight), dstY0(_dstY0),
+        x_ofs(_x_ofs), ify(_ify)
     {
-        int sx = cvFloor(x*ifx);
-        x_ofs[x] = std::min(sx, ssize.width-1)*pix_size;
     }
 
-    for( y = 0; y < dsize.height; y++ )
+    void operator()( const BlockedRange& range ) const
     {
-        uchar* D = dst.data + dst.step*y;
-        int sy = std::min(cvFloor(y*ify), ssize.height-1);
-        const uchar* S = src.data + src.step*sy;
+        Size dsize = dst.size();
+        int pix_size = (int)src.elemSize();
+        int pix_size4 = (int)(pix_size / sizeof(int));
+        int x, y;
 
-        switch( pix_size )
+        for( y = range.begin(); y < range.end(); y++ )
         {
-        case 1:
-            for( x = 0; x <= dsize.width - 2; x += 2 )
-            {
-                uchar t0 = S[x_ofs[x]];
-                uchar t1 = S[x_ofs[x+1]];
-                D[x] = t0;
-                D[x+1] = t1;
-            }
+            uchar* D = dst.data + dst.step*y;
+            int sy = std::min(cvFloor((y + dstY0)*ify), srcHeight-1) - srcY0;
+            const uchar* S = src.data + src.step*sy;
 
-            for( ; x < dsize.width; x++ )
-                D[x] = S[x_ofs[x]];
-            break;
-        case 2:
-            for( x = 0; x < dsize.width; x++ )
-                *(ushort*)(D + x*2) = *(ushort*)(S + x_ofs[x]);
-            break;
-        case 3:
-            for( x = 0; x < dsize.width; x++, D += 3 )
-            {
-                const uchar* _tS = S + x_ofs[x];
-                D[0] = _tS[0]; D[1] = _tS[1]; D[2] = _tS[2];
-            }
-            break;
-        case 4:
-            for( x = 0; x < dsize.width; x++ )
-                *(int*)(D + x*4) = *(int*)(S + x_ofs[x]);
-            break;
-        case 6:
-            for( x = 0; x < dsize.width; x++, D += 6 )
-            {
-                const ushort* _tS = (const ushort*)(S + x_ofs[x]);
-                ushort* _tD = (ushort*)D;
-                _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
-            }
-            break;
-        case 8:
-            for( x = 0; x < dsize.width; x++, D += 8 )
-            {
-                const int* _tS = (const int*)(S + x_ofs[x]);
-                int* _tD = (int*)D;
-                _tD[0] = _tS[0]; _tD[1] = _tS[1];
-            }
-            break;
-        case 12:
-            for( x = 0; x < dsize.width; x++, D += 12 )
+            switch( pix_size )
             {
-                const int* _tS = (const int*)(S + x_ofs[x]);
-                int* _tD = (int*)D;
-                _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
-            }
-            break;
-        default:
-            for( x = 0; x < dsize.width; x++, D += pix_size )
-            {
-                const int* _tS = (const int*)(S + x_ofs[x]);
-                int* _tD = (int*)D;
-                for( int k = 0; k < pix_size4; k++ )
-                    _tD[k] = _tS[k];
+            case 1:
+                for( x = 0; x <= dsize.width - 2; x += 2 )
+                {
+                    uchar t0 = S[x_ofs[x]];
+                    uchar t1 = S[x_ofs[x+1]];
+                    D[x] = t0;
+                    D[x+1] = t1;
+                }
+
+                for( ; x < dsize.width; x++ )
+                    D[x] = S[x_ofs[x]];
+                break;
+            case 2:
+                for( x = 0; x < dsize.width; x++ )
+                    *(ushort*)(D + x*2) = *(ushort*)(S + x_ofs[x]);
+                break;
+            case 3:
+                for( x = 0; x < dsize.width; x++, D += 3 )
+                {
+                    const uchar* _tS = S + x_ofs[x];
+                    D[0] = _tS[0]; D[1] = _tS[1]; D[2] = _tS[2];
+                }
+                break;
+            case 4:
+                for( x = 0; x < dsize.width; x++ )
+                    *(int*)(D + x*4) = *(int*)(S + x_ofs[x]);
+                break;
+            case 6:
+                for( x = 0; x < dsize.width; x++, D += 6 )
+                {
+                    const ushort* _tS = (const ushort*)(S + x_ofs[x]);
+                    ushort* _tD = (ushort*)D;
+                    _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
+                }
+                break;
+            case 8:
+                for( x = 0; x < dsize.width; x++, D += 8 )
+                {
+                    const int* _tS = (const int*)(S + x_ofs[x]);
+                    int* _tD = (int*)D;
+                    _tD[0] = _tS[0]; _tD[1] = _tS[1];
+                }
+                break;
+            case 12:
+                for( x = 0; x < dsize.width; x++, D += 12 )
+                {
+                    const int* _tS = (const int*)(S + x_ofs[x]);
+                    int* _tD = (int*)D;
+                    _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
+                }
+                break;
+            default:
+                for( x = 0; x < dsize.width; x++, D += pix_size )
+                {
+                    const int* _tS = (const int*)(S + x_ofs[x]);
+                    int* _tD = (int*)D;
+                    for( int k = 0; k < pix_size4; k++ )
+                        _tD[k] = _tS[k];
+                }
             }
         }
     }
-}
+
+private:
+    Mat src;
+    Mat dst;
+    int srcY0, srcHeight, dstY0;
+    const int* x_ofs;
+    double ify;
+};
 
 
 struct VResizeNoVec
@@ -356,6 +373,11 @@ struct VResizeLinearVec_32s8u
         __m128i b0 = _mm_set1_epi16(beta[0]), b1 = _mm_set1_epi16(beta[1]);
         __m128i delta = _mm_set1_epi16(2);
 
+    #if CV_TRY_AVX2
+        if( checkHardwareSupport(CV_CPU_AVX2) )
+            x = avx2::VResizeLinearVec_32s8u(_src, dst, _beta, width);
+    #endif
+
         if( (((size_t)S0|(size_t)S1)&15) == 0 )
             for( ; x <= width - 16; x += 16 )
             {
@@ -538,6 +560,11 @@ struct VResizeLinearVec_32f
 
         __m128 b0 = _mm_set1_ps(beta[0]), b1 = _mm_set1_ps(beta[1]);
 
+    #if CV_TRY_AVX2
+        if( checkHardwareSupport(CV_CPU_AVX2) )
+            x = avx2::VResizeLinearVec_32f(_src, _dst, _beta, width);
+    #endif
+
         if( (((size_t)S0|(size_t)S1)&15) == 0 )
             for( ; x <= width - 8; x += 8 )
             {
@@ -589,6 +616,11 @@ struct VResizeCubicVec_32s8u
         __m128 b0 = _mm_set1_ps(beta[0]*scale), b1 = _mm_set1_ps(beta[1]*scale),
             b2 = _mm_set1_ps(beta[2]*scale), b3 = _mm_set1_ps(beta[3]*scale);
 
+    #if CV_TRY_AVX2
+        if( checkHardwareSupport(CV_CPU_AVX2) )
+            x = avx2::VResizeCubicVec_32s8u(_src, dst, _beta, width);
+    #endif
+
         if( (((size_t)S0|(size_t)S1|(size_t)S2|(size_t)S3)&15) == 0 )
             for( ; x <= width - 8; x += 8 )
             {
@@ -745,6 +777,11 @@ struct VResizeCubicVec_32f
         __m128 b0 = _mm_set1_ps(beta[0]), b1 = _mm_set1_ps(beta[1]),
             b2 = _mm_set1_ps(beta[2]), b3 = _mm_set1_ps(beta[3]);
 
+    #if CV_TRY_AVX2
+        if( checkHardwareSupport(CV_CPU_AVX2) )
+            x = avx2::VResizeCubicVec_32f(_src, _dst, _beta, width);
+    #endif
+
         for( ; x <= width - 8; x += 8 )
         {
             __m128 x0, x1, y0, y1, s0, s1;
@@ -796,7 +833,25 @@ typedef VResizeNoVec VResizeCubicVec_32f;
 
 #endif
 
+#if CV_TRY_AVX2
+
+struct HResizeLinearVec_8u32s
+{
+    int operator()(const uchar** src, uchar** dst, int count, const int* xofs,
+                   const uchar* alpha, int swidth, int dwidth, int cn, int xmin, int xmax) const
+    {
+        if( !checkHardwareSupport(CV_CPU_AVX2) )
+            return 0;
+        return avx2::HResizeLinearVec_8u32s(src, dst, count, xofs, alpha,
+                                            swidth, dwidth, cn, xmin, xmax);
+    }
+};
+
+#else
+
 typedef HResizeNoVec HResizeLinearVec_8u32s;
+
+#endif
 typedef HResizeNoVec HResizeLinearVec_16u32f;
 typedef HResizeNoVec HResizeLinearVec_16s32f;
 typedef HResizeNoVec HResizeLinearVec_32f;
@@ -1093,133 +1148,185 @@ static inline int clip(int x, int a, int b)
 static const int MAX_ESIZE=16;
 
 template<class HResize, class VResize>
-static void resizeGeneric_( const Mat& src, Mat& dst,
-                            const int* xofs, const void* _alpha,
-                            const int* yofs, const void* _beta,
-                            int xmin, int xmax, int ksize )
+class resizeGenericInvoker
 {
+public:
     typedef typename HResize::value_type T;
     typedef typename HResize::buf_type WT;
     typedef typename HResize::alpha_type AT;
 
-    const AT* alpha = (const AT*)_alpha;
-    const AT* beta = (const AT*)_beta;
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    ssize.width *= cn;
-    dsize.width *= cn;
-    int bufstep = (int)alignSize(dsize.width, 16);
-    AutoBuffer<WT> _buffer(bufstep*ksize);
-    const T* srows[MAX_ESIZE]={0};
-    WT* rows[MAX_ESIZE]={0};
-    int prev_sy[MAX_ESIZE];
-    int dy;
-    xmin *= cn;
-    xmax *= cn;
-
-    HResize hresize;
-    VResize vresize;
-
-    for(int k = 0; k < ksize; k++ )
+    resizeGenericInvoker( const Mat& _src, Mat& _dst, const int* _xofs, const int* _yofs,
+                          const AT* _alpha, const AT* _beta, int _xmin, int _xmax, int _ksize ) :
+        src(_src), dst(_dst), xofs(_xofs), yofs(_yofs), alpha(_alpha), beta(_beta),
+        xmin(_xmin), xmax(_xmax), ksize(_ksize)
     {
-        prev_sy[k] = -1;
-        rows[k] = (WT*)_buffer + bufstep*k;
     }
 
-    // image resize is a separable operation. In case of not too strong
-    for( dy = 0; dy < dsize.height; dy++, beta += ksize )
+    void operator()( const BlockedRange& range ) const
     {
-        int sy0 = yofs[dy], k0=ksize, k1=0, ksize2 = ksize/2;
+        Size ssize = src.size(), dsize = dst.size();
+        int cn = src.channels();
+        ssize.width *= cn;
+        dsize.width *= cn;
+        int bufstep = (int)alignSize(dsize.width, 16);
+        ScratchBuffer<WT> _buffer(bufstep*ksize);
+        const T* srows[MAX_ESIZE]={0};
+        WT* rows[MAX_ESIZE]={0};
+        int prev_sy[MAX_ESIZE];
+        int dy, xmin1 = xmin*cn, xmax1 = xmax*cn;
+
+        HResize hresize;
+        VResize vresize;
 
         for(int k = 0; k < ksize; k++ )
         {
-            int sy = clip(sy0 - ksize2 + 1 + k, 0, ssize.height);
-            for( k1 = std::max(k1, k); k1 < ksize; k1++ )
+            prev_sy[k] = -1;
+            rows[k] = (WT*)_buffer + bufstep*k;
+        }
+
+        // every stripe keeps its own cache of the horizontally resized source rows
+        const AT* _beta = beta + range.begin()*ksize;
+        // image resize is a separable operation. In case of not too strong
+        for( dy = range.begin(); dy < range.end(); dy++, _beta += ksize )
+        {
+            int sy0 = yofs[dy], k0=ksize, k1=0, ksize2 = ksize/2;
+
+            for(int k = 0; k < ksize; k++ )
             {
-                if( sy == prev_sy[k1] ) // if the sy-th row has been computed already, reuse it.
+                int sy = clip(sy0 - ksize2 + 1 + k, 0, ssize.height);
+                for( k1 = std::max(k1, k); k1 < ksize; k1++ )
                 {
-                    if( k1 > k )
-                        memcpy( rows[k], rows[k1], bufstep*sizeof(rows[0][0]) );
-                    break;
+                    if( sy == prev_sy[k1] ) // if the sy-th row has been computed already, reuse it.
+                    {
+                        if( k1 > k )
+                            memcpy( rows[k], rows[k1], bufstep*sizeof(rows[0][0]) );
+                        break;
+                    }
                 }
+                if( k1 == ksize )
+                    k0 = std::min(k0, k); // remember the first row that needs to be computed
+                srows[k] = (const T*)(src.data + src.step*sy);
+                prev_sy[k] = sy;
             }
-            if( k1 == ksize )
-                k0 = std::min(k0, k); // remember the first row that needs to be computed
-            srows[k] = (const T*)(src.data + src.step*sy);
-            prev_sy[k] = sy;
-        }
 
-        if( k0 < ksize )
-            hresize( srows + k0, rows + k0, ksize - k0, xofs, alpha,
-                     ssize.width, dsize.width, cn, xmin, xmax );
-        vresize( (const WT**)rows, (T*)(dst.data + dst.step*dy), beta, dsize.width );
+            if( k0 < ksize )
+                hresize( srows + k0, rows + k0, ksize - k0, xofs, alpha,
+                         ssize.width, dsize.width, cn, xmin1, xmax1 );
+            vresize( (const WT**)rows, (T*)(dst.data + dst.step*dy), _beta, dsize.width );
+        }
     }
+
+private:
+    Mat src;
+    Mat dst;
+    const int* xofs, *yofs;
+    const AT* alpha, *beta;
+    int xmin, xmax, ksize;
+};
+
+template<class HResize, class VResize>
+static void resizeGeneric_( const Mat& src, Mat& dst,
+                            const int* xofs, const void* _alpha,
+                            const int* yofs, const void* _beta,
+                            int xmin, int xmax, int ksize )
+{
+    typedef typename HResize::alpha_type AT;
+
+    const AT* alpha = (const AT*)_alpha;
+    const AT* beta = (const AT*)_beta;
+
+    parallel_for( warpStripes(dst.rows, dst.cols*dst.channels()),
+                  resizeGenericInvoker<HResize, VResize>(src, dst, xofs, yofs, alpha, beta,
+                                                         xmin, xmax, ksize) );
 }
 
 
 template<typename T, typename WT>
-static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
-                             int scale_x, int scale_y )
+class resizeAreaFastInvoker
 {
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    int dy, dx, k = 0;
-    int area = scale_x*scale_y;
-    float scale = 1.f/(scale_x*scale_y);
-    int dwidth1 = (ssize.width/scale_x)*cn;
-    dsize.width *= cn;
-    ssize.width *= cn;
+public:
+    resizeAreaFastInvoker( const Mat& _src, Mat& _dst, const int* _ofs, const int* _xofs,
+                           int _scale_x, int _scale_y ) :
+        src(_src), dst(_dst), ofs(_ofs), xofs(_xofs), scale_x(_scale_x), scale_y(_scale_y)
+    {
+    }
 
-    for( dy = 0; dy < dsize.height; dy++ )
+    void operator()( const BlockedRange& range ) const
     {
-        T* D = (T*)(dst.data + dst.step*dy);
-        int sy0 = dy*scale_y, w = sy0 + scale_y <= ssize.height ? dwidth1 : 0;
-        if( sy0 >= ssize.height )
-        {
-            for( dx = 0; dx < dsize.width; dx++ )
-                D[dx] = 0;
-            continue;
-        }
+        Size ssize = src.size(), dsize = dst.size();
+        int cn = src.channels();
+        int dy, dx, k = 0;
+        int area = scale_x*scale_y;
+        float scale = 1.f/(scale_x*scale_y);
+        int dwidth1 = (ssize.width/scale_x)*cn;
+        dsize.width *= cn;
+        ssize.width *= cn;
 
-        for( dx = 0; dx < w; dx++ )
+        for( dy = range.begin(); dy < range.end(); dy++ )
         {
-            const T* S = (const T*)(src.data + src.step*sy0) + xofs[dx];
-            WT sum = 0;
-            k=0;
-            #if CV_ENABLE_UNROLLED
-            for( ; k <= area - 4; k += 4 )
-                sum += S[ofs[k]] + S[ofs[k+1]] + S[ofs[k+2]] + S[ofs[k+3]];
-            #endif
-            for( ; k < area; k++ )
-                sum += S[ofs[k]];
-
-            D[dx] = saturate_cast<T>(sum*scale);
-        }
+            T* D = (T*)(dst.data + dst.step*dy);
+            int sy0 = dy*scale_y, w = sy0 + scale_y <= ssize.height ? dwidth1 : 0;
+            if( sy0 >= ssize.height )
+            {
+                for( dx = 0; dx < dsize.width; dx++ )
+                    D[dx] = 0;
+                continue;
+            }
 
-        for( ; dx < dsize.width; dx++ )
-        {
-            WT sum = 0;
-            int count = 0, sx0 = xofs[dx];
-            if( sx0 >= ssize.width )
-                D[dx] = 0;
+            for( dx = 0; dx < w; dx++ )
+            {
+                const T* S = (const T*)(src.data + src.step*sy0) + xofs[dx];
+                WT sum = 0;
+                k=0;
+                #if CV_ENABLE_UNROLLED
+                for( ; k <= area - 4; k += 4 )
+                    sum += S[ofs[k]] + S[ofs[k+1]] + S[ofs[k+2]] + S[ofs[k+3]];
+                #endif
+                for( ; k < area; k++ )
+                    sum += S[ofs[k]];
+
+                D[dx] = saturate_cast<T>(sum*scale);
+            }
 
-            for( int sy = 0; sy < scale_y; sy++ )
+            for( ; dx < dsize.width; dx++ )
             {
-                if( sy0 + sy >= ssize.height )
-                    break;
-                const T* S = (const T*)(src.data + src.step*(sy0 + sy)) + sx0;
-                for( int sx = 0; sx < scale_x*cn; sx += cn )
+                WT sum = 0;
+                int count = 0, sx0 = xofs[dx];
+                if( sx0 >= ssize.width )
+                    D[dx] = 0;
+
+                for( int sy = 0; sy < scale_y; sy++ )
                 {
-                    if( sx0 + sx >= ssize.width )
+                    if( sy0 + sy >= ssize.height )
                         break;
-                    sum += S[sx];
-                    count++;
+                    const T* S = (const T*)(src.data + src.step*(sy0 + sy)) + sx0;
+                    for( int sx = 0; sx < scale_x*cn; sx += cn )
+                    {
+                        if( sx0 + sx >= ssize.width )
+                            break;
+                        sum += S[sx];
+                        count++;
+                    }
                 }
-            }
 
-            D[dx] = saturate_cast<T>((float)sum/count);
+                D[dx] = saturate_cast<T>((float)sum/count);
+            }
         }
     }
+
+private:
+    Mat src;
+    Mat dst;
+    const int* ofs, *xofs;
+    int scale_x, scale_y;
+};
+
+template<typename T, typename WT>
+static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
+                             int scale_x, int scale_y )
+{
+    parallel_for( warpStripes(dst.rows, dst.cols*dst.channels()),
+                  resizeAreaFastInvoker<T, WT>(src, dst, ofs, xofs, scale_x, scale_y) );
 }
 
 struct DecimateAlpha
@@ -1229,104 +1336,158 @@ struct DecimateAlpha
 };
 
 template<typename T, typename WT>
-static void resizeArea_( const Mat& src, Mat& dst, const DecimateAlpha* xofs, int xofs_count, double scale_y_)
+static void resizeAreaAccumRow( const T* S, const DecimateAlpha* xofs, int xofs_count, int cn, WT* buf )
 {
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    dsize.width *= cn;
-    AutoBuffer<WT> _buffer(dsize.width*2);
-    WT *buf = _buffer, *sum = buf + dsize.width;
-    int k, sy, dx, cur_dy = 0;
-    WT scale_y = (WT)scale_y_;
+    int k;
+    if( cn == 1 )
+        for( k = 0; k < xofs_count; k++ )
+        {
+            int dxn = xofs[k].di;
+            WT alpha = xofs[k].alpha;
+            buf[dxn] += S[xofs[k].si]*alpha;
+        }
+    else if( cn == 2 )
+        for( k = 0; k < xofs_count; k++ )
+        {
+            int sxn = xofs[k].si;
+            int dxn = xofs[k].di;
+            WT alpha = xofs[k].alpha;
+            WT t0 = buf[dxn] + S[sxn]*alpha;
+            WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
+            buf[dxn] = t0; buf[dxn+1] = t1;
+        }
+    else if( cn == 3 )
+        for( k = 0; k < xofs_count; k++ )
+        {
+            int sxn = xofs[k].si;
+            int dxn = xofs[k].di;
+            WT alpha = xofs[k].alpha;
+            WT t0 = buf[dxn] + S[sxn]*alpha;
+            WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
+            WT t2 = buf[dxn+2] + S[sxn+2]*alpha;
+            buf[dxn] = t0; buf[dxn+1] = t1; buf[dxn+2] = t2;
+        }
+    else
+        for( k = 0; k < xofs_count; k++ )
+        {
+            int sxn = xofs[k].si;
+            int dxn = xofs[k].di;
+            WT alpha = xofs[k].alpha;
+            WT t0 = buf[dxn] + S[sxn]*alpha;
+            WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
+            buf[dxn] = t0; buf[dxn+1] = t1;
+            t0 = buf[dxn+2] + S[sxn+2]*alpha;
+            t1 = buf[dxn+3] + S[sxn+3]*alpha;
+            buf[dxn+2] = t0; buf[dxn+3] = t1;
+        }
+}
 
-    CV_Assert( cn <= 4 );
-    for( dx = 0; dx < dsize.width; dx++ )
-        buf[dx] = sum[dx] = 0;
+template<typename T, typename WT>
+class resizeAreaInvoker
+{
+public:
+    resizeAreaInvoker( const Mat& _src, Mat& _dst, const DecimateAlpha* _xofs,
+                       int _xofs_count, double _scale_y ) :
+        src(_src), dst(_dst), xofs(_xofs), xofs_count(_xofs_count), scale_y_(_scale_y)
+    {
+    }
 
-    for( sy = 0; sy < ssize.height; sy++ )
+    void operator()( const BlockedRange& range ) const
     {
-        const T* S = (const T*)(src.data + src.step*sy);
-        if( cn == 1 )
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                buf[dxn] += S[xofs[k].si]*alpha;
-            }
-        else if( cn == 2 )
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int sxn = xofs[k].si;
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                WT t0 = buf[dxn] + S[sxn]*alpha;
-                WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
-                buf[dxn] = t0; buf[dxn+1] = t1;
-            }
-        else if( cn == 3 )
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int sxn = xofs[k].si;
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                WT t0 = buf[dxn] + S[sxn]*alpha;
-                WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
-                WT t2 = buf[dxn+2] + S[sxn+2]*alpha;
-                buf[dxn] = t0; buf[dxn+1] = t1; buf[dxn+2] = t2;
-            }
-        else
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int sxn = xofs[k].si;
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                WT t0 = buf[dxn] + S[sxn]*alpha;
-                WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
-                buf[dxn] = t0; buf[dxn+1] = t1;
-                t0 = buf[dxn+2] + S[sxn+2]*alpha;
-                t1 = buf[dxn+3] + S[sxn+3]*alpha;
-                buf[dxn+2] = t0; buf[dxn+3] = t1;
-            }
+        Size ssize = src.size(), dsize = dst.size();
+        int cn = src.channels();
+        dsize.width *= cn;
+        ScratchBuffer<WT> _buffer(dsize.width*2);
+        WT *buf = _buffer, *sum = buf + dsize.width;
+        int sy = 0, dx, cur_dy = 0, dy1 = range.end();
+        WT scale_y = (WT)scale_y_;
 
-        if( (cur_dy + 1)*scale_y <= sy + 1 || sy == ssize.height - 1 )
+        for( dx = 0; dx < dsize.width; dx++ )
+            buf[dx] = sum[dx] = 0;
+
+        // The destination rows are accumulated from the consecutive source rows, and the last
+        // source row of every destination row is partially carried over to the next one.
+        // Skip (without accumulating) to the source row that completes the row range.begin()-1
+        // and reproduce the carry, so that the stripes give exactly the serial result.
+        if( range.begin() > 0 )
         {
-            WT beta = std::max(sy + 1 - (cur_dy+1)*scale_y, (WT)0);
-            WT beta1 = 1 - beta;
-            T* D = (T*)(dst.data + dst.step*cur_dy);
-            if( fabs(beta) < 1e-3 )
-            {
-                if(cur_dy >= dsize.height) return;
+            for( ; sy < ssize.height; sy++ )
+                if( ((cur_dy + 1)*scale_y <= sy + 1 || sy == ssize.height - 1) &&
+                    ++cur_dy == range.begin() )
+                    break;
+            if( sy >= ssize.height )
+                return;
+
+            resizeAreaAccumRow( (const T*)(src.data + src.step*sy), xofs, xofs_count, cn, buf );
+            WT beta = std::max(sy + 1 - cur_dy*scale_y, (WT)0);
+            if( fabs(beta) >= 1e-3 )
                 for( dx = 0; dx < dsize.width; dx++ )
+                    sum[dx] = buf[dx]*beta;
+            for( dx = 0; dx < dsize.width; dx++ )
+                buf[dx] = 0;
+            sy++;
+        }
+
+        for( ; sy < ssize.height && cur_dy < dy1; sy++ )
+        {
+            resizeAreaAccumRow( (const T*)(src.data + src.step*sy), xofs, xofs_count, cn, buf );
+
+            if( (cur_dy + 1)*scale_y <= sy + 1 || sy == ssize.height - 1 )
+            {
+                WT beta = std::max(sy + 1 - (cur_dy+1)*scale_y, (WT)0);
+                WT beta1 = 1 - beta;
+                T* D = (T*)(dst.data + dst.step*cur_dy);
+                if( cur_dy >= dsize.height )
+                    return;
+                if( fabs(beta) < 1e-3 )
                 {
-                    D[dx] = saturate_cast<T>((sum[dx] + buf[dx]) / min(scale_y, src.rows - cur_dy * scale_y));
-                    sum[dx] = buf[dx] = 0;
+                    for( dx = 0; dx < dsize.width; dx++ )
+                    {
+                        D[dx] = saturate_cast<T>((sum[dx] + buf[dx]) / min(scale_y, src.rows - cur_dy * scale_y));
+                        sum[dx] = buf[dx] = 0;
+                    }
                 }
+                else
+                    for( dx = 0; dx < dsize.width; dx++ )
+                    {
+                        D[dx] = saturate_cast<T>((sum[dx] + buf[dx]* beta1)/ min(scale_y, src.rows - cur_dy*scale_y));
+                        sum[dx] = buf[dx]*beta;
+                        buf[dx] = 0;
+                    }
+                cur_dy++;
             }
             else
-                for( dx = 0; dx < dsize.width; dx++ )
+            {
+                for( dx = 0; dx <= dsize.width - 2; dx += 2 )
                 {
-                    D[dx] = saturate_cast<T>((sum[dx] + buf[dx]* beta1)/ min(scale_y, src.rows - cur_dy*scale_y));
-                    sum[dx] = buf[dx]*beta;
+                    WT t0 = sum[dx] + buf[dx];
+                    WT t1 = sum[dx+1] + buf[dx+1];
+                    sum[dx] = t0; sum[dx+1] = t1;
+                    buf[dx] = buf[dx+1] = 0;
+                }
+                for( ; dx < dsize.width; dx++ )
+                {
+                    sum[dx] += buf[dx];
                     buf[dx] = 0;
                 }
-            cur_dy++;
-        }
-        else
-        {
-            for( dx = 0; dx <= dsize.width - 2; dx += 2 )
-            {
-                WT t0 = sum[dx] + buf[dx];
-                WT t1 = sum[dx+1] + buf[dx+1];
-                sum[dx] = t0; sum[dx+1] = t1;
-                buf[dx] = buf[dx+1] = 0;
-            }
-            for( ; dx < dsize.width; dx++ )
-            {
-                sum[dx] += buf[dx];
-                buf[dx] = 0;
             }
         }
     }
+
+private:
+    Mat src;
+    Mat dst;
+    const DecimateAlpha* xofs;
+    int xofs_count;
+    double scale_y_;
+};
+
+template<typename T, typename WT>
+static void resizeArea_( const Mat& src, Mat& dst, const DecimateAlpha* xofs, int xofs_count, double scale_y_)
+{
+    CV_Assert( src.channels() <= 4 );
+    parallel_for( warpStripes(dst.rows, dst.cols*dst.channels()),
+                  resizeAreaInvoker<T, WT>(src, dst, xofs, xofs_count, scale_y_) );
 }
 
 
@@ -1346,84 +1507,190 @@ typedef void (*ResizeAreaFunc)( const Mat& src, Mat& dst,
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
-                 double inv_scale_x, double inv_scale_y, int interpolation )
+void cv::initResizeXTab( ResizeXTab& tab, int type, int swidth, int dwidth,
+                         double inv_scale_x, int interpolation )
 {
-    static ResizeFunc linear_tab[] =
-    {
-        resizeGeneric_<
-            HResizeLinear<uchar, int, short,
-                INTER_RESIZE_COEF_SCALE,
-                HResizeLinearVec_8u32s>,
-            VResizeLinear<uchar, int, short,
-                FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
-                VResizeLinearVec_32s8u> >,
-        0,
-        resizeGeneric_<
-            HResizeLinear<ushort, float, float, 1,
-                HResizeLinearVec_16u32f>,
-            VResizeLinear<ushort, float, float, Cast<float, ushort>,
-                VResizeLinearVec_32f16u> >,
-        resizeGeneric_<
-            HResizeLinear<short, float, float, 1,
-                HResizeLinearVec_16s32f>,
-            VResizeLinear<short, float, float, Cast<float, short>,
-                VResizeLinearVec_32f16s> >,
-        0,
-        resizeGeneric_<
-            HResizeLinear<float, float, float, 1,
-                HResizeLinearVec_32f>,
-            VResizeLinear<float, float, float, Cast<float, float>,
-                VResizeLinearVec_32f> >,
-        resizeGeneric_<
-            HResizeLinear<double, double, float, 1,
-                HResizeNoVec>,
-            VResizeLinear<double, double, float, Cast<double, double>,
-                VResizeNoVec> >,
-        0
-    };
+    int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    double scale_x = 1./inv_scale_x;
+    int k, sx, dx;
 
-    static ResizeFunc cubic_tab[] =
+    if( interpolation == INTER_NEAREST )
     {
-        resizeGeneric_<
-            HResizeCubic<uchar, int, short>,
-            VResizeCubic<uchar, int, short,
-                FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
-                VResizeCubicVec_32s8u> >,
-        0,
-        resizeGeneric_<
-            HResizeCubic<ushort, float, float>,
-            VResizeCubic<ushort, float, float, Cast<float, ushort>,
-            VResizeCubicVec_32f16u> >,
-        resizeGeneric_<
-            HResizeCubic<short, float, float>,
-            VResizeCubic<short, float, float, Cast<float, short>,
-            VResizeCubicVec_32f16s> >,
-        0,
-        resizeGeneric_<
-            HResizeCubic<float, float, float>,
-            VResizeCubic<float, float, float, Cast<float, float>,
-            VResizeCubicVec_32f> >,
-        resizeGeneric_<
-            HResizeCubic<double, double, float>,
-            VResizeCubic<double, double, float, Cast<double, double>,
-            VResizeNoVec> >,
-        0
-    };
+        int pix_size = (int)CV_ELEM_SIZE(type);
+        tab.xofs.resize(dwidth);
+        tab.ksize = 1;
+        for( dx = 0; dx < dwidth; dx++ )
+        {
+            sx = cvFloor(dx*scale_x);
+            tab.xofs[dx] = std::min(sx, swidth-1)*pix_size;
+        }
+        return;
+    }
 
-    static ResizeFunc lanczos4_tab[] =
-    {
-        resizeGeneric_<HResizeLanczos4<uchar, int, short>,
-            VResizeLanczos4<uchar, int, short,
-            FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
-            VResizeNoVec> >,
-        0,
-        resizeGeneric_<HResizeLanczos4<ushort, float, float>,
-            VResizeLanczos4<ushort, float, float, Cast<float, ushort>,
-            VResizeNoVec> >,
-        resizeGeneric_<HResizeLanczos4<short, float, float>,
-            VResizeLanczos4<short, float, float, Cast<float, short>,
-            VResizeNoVec> >,
+    int xmin = 0, xmax = dwidth, width = dwidth*cn;
+    bool area_mode = interpolation == INTER_AREA;
+    bool fixpt = depth == CV_8U;
+    float fx;
+    int ksize=0, ksize2;
+    if( interpolation == INTER_CUBIC )
+        ksize = 4;
+    else if( interpolation == INTER_LANCZOS4 )
+        ksize = 8;
+    else if( interpolation == INTER_LINEAR || interpolation == INTER_AREA )
+        ksize = 2;
+    else
+        CV_Error( CV_StsBadArg, "Unknown interpolation method" );
+    ksize2 = ksize/2;
+
+    tab.xofs.resize(width);
+    tab.alpha.resize(width*ksize);
+    int* xofs = &tab.xofs[0];
+    float* alpha = &tab.alpha[0];
+    short* ialpha = (short*)alpha;
+    float cbuf[MAX_ESIZE];
+
+    for( dx = 0; dx < dwidth; dx++ )
+    {
+        if( !area_mode )
+        {
+            fx = (float)((dx+0.5)*scale_x - 0.5);
+            sx = cvFloor(fx);
+            fx -= sx;
+        }
+        else
+        {
+            sx = cvFloor(dx*scale_x);
+            fx = (float)((dx+1) - (sx+1)*inv_scale_x);
+            fx = fx <= 0 ? 0.f : fx - cvFloor(fx);
+        }
+
+        if( sx < ksize2-1 )
+        {
+            xmin = dx+1;
+            if( sx < 0 )
+                fx = 0, sx = 0;
+        }
+
+        if( sx + ksize2 >= swidth )
+        {
+            xmax = std::min( xmax, dx );
+            if( sx >= swidth-1 )
+                fx = 0, sx = swidth-1;
+        }
+
+        for( k = 0, sx *= cn; k < cn; k++ )
+            xofs[dx*cn + k] = sx + k;
+
+        if( interpolation == INTER_CUBIC )
+            interpolateCubic( fx, cbuf );
+        else if( interpolation == INTER_LANCZOS4 )
+            interpolateLanczos4( fx, cbuf );
+        else
+        {
+            cbuf[0] = 1.f - fx;
+            cbuf[1] = fx;
+        }
+        if( fixpt )
+        {
+            for( k = 0; k < ksize; k++ )
+                ialpha[dx*cn*ksize + k] = saturate_cast<short>(cbuf[k]*INTER_RESIZE_COEF_SCALE);
+            for( ; k < cn*ksize; k++ )
+                ialpha[dx*cn*ksize + k] = ialpha[dx*cn*ksize + k - ksize];
+        }
+        else
+        {
+            for( k = 0; k < ksize; k++ )
+                alpha[dx*cn*ksize + k] = cbuf[k];
+            for( ; k < cn*ksize; k++ )
+                alpha[dx*cn*ksize + k] = alpha[dx*cn*ksize + k - ksize];
+        }
+    }
+
+    tab.xmin = xmin;
+    tab.xmax = xmax;
+    tab.ksize = ksize;
+}
+
+
+void cv::resizeRows( const Mat& src, int srcY0, int srcHeight, Mat& dst, int dstY0,
+                     double inv_scale_x, double inv_scale_y, int interpolation,
+                     const ResizeXTab* xtab )
+{
+    static ResizeFunc linear_tab[] =
+    {
+        resizeGeneric_<
+            HResizeLinear<uchar, int, short,
+                INTER_RESIZE_COEF_SCALE,
+                HResizeLinearVec_8u32s>,
+            VResizeLinear<uchar, int, short,
+                FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
+                VResizeLinearVec_32s8u> >,
+        0,
+        resizeGeneric_<
+            HResizeLinear<ushort, float, float, 1,
+                HResizeLinearVec_16u32f>,
+            VResizeLinear<ushort, float, float, Cast<float, ushort>,
+                VResizeLinearVec_32f16u> >,
+        resizeGeneric_<
+            HResizeLinear<short, float, float, 1,
+                HResizeLinearVec_16s32f>,
+            VResizeLinear<short, float, float, Cast<float, short>,
+                VResizeLinearVec_32f16s> >,
+        0,
+        resizeGeneric_<
+            HResizeLinear<float, float, float, 1,
+                HResizeLinearVec_32f>,
+            VResizeLinear<float, float, float, Cast<float, float>,
+                VResizeLinearVec_32f> >,
+        resizeGeneric_<
+            HResizeLinear<double, double, float, 1,
+                HResizeNoVec>,
+            VResizeLinear<double, double, float, Cast<double, double>,
+                VResizeNoVec> >,
+        0
+    };
+
+    static ResizeFunc cubic_tab[] =
+    {
+        resizeGeneric_<
+            HResizeCubic<uchar, int, short>,
+            VResizeCubic<uchar, int, short,
+                FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
+                VResizeCubicVec_32s8u> >,
+        0,
+        resizeGeneric_<
+            HResizeCubic<ushort, float, float>,
+            VResizeCubic<ushort, float, float, Cast<float, ushort>,
+            VResizeCubicVec_32f16u> >,
+        resizeGeneric_<
+            HResizeCubic<short, float, float>,
+            VResizeCubic<short, float, float, Cast<float, short>,
+            VResizeCubicVec_32f16s> >,
+        0,
+        resizeGeneric_<
+            HResizeCubic<float, float, float>,
+            VResizeCubic<float, float, float, Cast<float, float>,
+            VResizeCubicVec_32f> >,
+        resizeGeneric_<
+            HResizeCubic<double, double, float>,
+            VResizeCubic<double, double, float, Cast<double, double>,
+            VResizeNoVec> >,
+        0
+    };
+
+    static ResizeFunc lanczos4_tab[] =
+    {
+        resizeGeneric_<HResizeLanczos4<uchar, int, short>,
+            VResizeLanczos4<uchar, int, short,
+            FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
+            VResizeNoVec> >,
+        0,
+        resizeGeneric_<HResizeLanczos4<ushort, float, float>,
+            VResizeLanczos4<ushort, float, float, Cast<float, ushort>,
+            VResizeNoVec> >,
+        resizeGeneric_<HResizeLanczos4<short, float, float>,
+            VResizeLanczos4<short, float, float, Cast<float, short>,
+            VResizeNoVec> >,
         0,
         resizeGeneric_<HResizeLanczos4<float, float, float>,
             VResizeLanczos4<float, float, float, Cast<float, float>,
@@ -1434,6 +1701,115 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         0
     };
 
+
+    ResizeXTab tab0;
+    if( !xtab )
+    {
+        initResizeXTab( tab0, src.type(), src.cols, dst.cols, inv_scale_x, interpolation );
+        xtab = &tab0;
+    }
+
+    if( interpolation == INTER_NEAREST )
+    {
+        parallel_for( warpStripes(dst.rows, dst.cols*src.channels()),
+                      resizeNNInvoker(src, srcY0, srcHeight, dst, dstY0, &xtab->xofs[0], 1./inv_scale_y) );
+        return;
+    }
+
+    int depth = src.depth(), ksize = xtab->ksize, k, sy, dy;
+    bool area_mode = interpolation == INTER_AREA;
+    bool fixpt = depth == CV_8U;
+    double scale_y = 1./inv_scale_y;
+    float fy;
+    ResizeFunc func = ksize == 4 ? cubic_tab[depth] : ksize == 8 ? lanczos4_tab[depth] : linear_tab[depth];
+
+    CV_Assert( func != 0 );
+
+    ScratchBuffer<uchar> _buffer(dst.rows*(sizeof(int) + sizeof(float)*ksize));
+    int* yofs = (int*)(uchar*)_buffer;
+    float* beta = (float*)(yofs + dst.rows);
+    short* ibeta = (short*)beta;
+    float cbuf[MAX_ESIZE];
+
+    for( dy = 0; dy < dst.rows; dy++ )
+    {
+        int y = dy + dstY0;
+        if( !area_mode )
+        {
+            fy = (float)((y+0.5)*scale_y - 0.5);
+            sy = cvFloor(fy);
+            fy -= sy;
+        }
+        else
+        {
+            sy = cvFloor(y*scale_y);
+            fy = (float)((y+1) - (sy+1)*inv_scale_y);
+            fy = fy <= 0 ? 0.f : fy - cvFloor(fy);
+        }
+
+        yofs[dy] = sy - srcY0;
+        if( interpolation == INTER_CUBIC )
+            interpolateCubic( fy, cbuf );
+        else if( interpolation == INTER_LANCZOS4 )
+            interpolateLanczos4( fy, cbuf );
+        else
+        {
+            cbuf[0] = 1.f - fy;
+            cbuf[1] = fy;
+        }
+
+        if( fixpt )
+        {
+            for( k = 0; k < ksize; k++ )
+                ibeta[dy*ksize + k] = saturate_cast<short>(cbuf[k]*INTER_RESIZE_COEF_SCALE);
+        }
+        else
+        {
+            for( k = 0; k < ksize; k++ )
+                beta[dy*ksize + k] = cbuf[k];
+        }
+    }
+
+    func( src, dst, &xtab->xofs[0], &xtab->alpha[0], yofs,
+          fixpt ? (void*)ibeta : (void*)beta, xtab->xmin, xtab->xmax, ksize );
+}
+
+cv::Range cv::resizeSrcRows( Range dstRows, int srcHeight, double inv_scale_y, int interpolation )
+{
+    if( dstRows.empty() )
+        return Range(0, 0);
+
+    int y0 = dstRows.start, y1 = dstRows.end - 1, ksize2;
+    if( interpolation == INTER_NEAREST )
+    {
+        double ify = 1./inv_scale_y;
+        return Range(std::min(cvFloor(y0*ify), srcHeight-1),
+                     std::min(cvFloor(y1*ify), srcHeight-1) + 1);
+    }
+
+    double scale_y = 1./inv_scale_y;
+    int sy0, sy1;
+    if( interpolation == INTER_AREA )
+    {
+        // the bilinear emulation used when upscaling with INTER_AREA
+        ksize2 = 1;
+        sy0 = cvFloor(y0*scale_y);
+        sy1 = cvFloor(y1*scale_y);
+    }
+    else
+    {
+        ksize2 = interpolation == INTER_CUBIC ? 2 : interpolation == INTER_LANCZOS4 ? 4 : 1;
+        sy0 = cvFloor((float)((y0+0.5)*scale_y - 0.5));
+        sy1 = cvFloor((float)((y1+0.5)*scale_y - 0.5));
+    }
+    return Range(std::min(std::max(sy0 - ksize2 + 1, 0), srcHeight-1),
+                 std::min(std::max(sy1 + ksize2, 0), srcHeight-1) + 1);
+}
+
+void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
+                 double inv_scale_x, double inv_scale_y, int interpolation )
+{
+    CV_TRACE_REGION("cv::resize");
     static ResizeAreaFastFunc areafast_tab[] =
     {
         resizeAreaFast_<uchar, int>, 0,
@@ -1468,6 +1844,9 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
     }
     _dst.create(dsize, src.type());
     Mat dst = _dst.getMat();
+    // the destination stripes are computed in parallel, so the in-place resize needs a copy
+    if( dst.data == src.data )
+        src = src.clone();
 
 
 #ifdef HAVE_TEGRA_OPTIMIZATION
@@ -1477,11 +1856,11 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
 
     int depth = src.depth(), cn = src.channels();
     double scale_x = 1./inv_scale_x, scale_y = 1./inv_scale_y;
-    int k, sx, sy, dx, dy;
+    int k, sx, sy, dx;
 
     if( interpolation == INTER_NEAREST )
     {
-        resizeNN( src, dst, inv_scale_x, inv_scale_y );
+        resizeRows( src, 0, src.rows, dst, 0, inv_scale_x, inv_scale_y, interpolation );
         return;
     }
 
@@ -1497,7 +1876,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         {
             int area = iscale_x*iscale_y;
             size_t srcstep = src.step / src.elemSize1();
-            AutoBuffer<int> _ofs(area + dsize.width*cn);
+            ScratchBuffer<int> _ofs(area + dsize.width*cn);
             int* ofs = _ofs;
             int* xofs = ofs + area;
             ResizeAreaFastFunc func = areafast_tab[depth];
@@ -1521,7 +1900,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         ResizeAreaFunc func = area_tab[depth];
         CV_Assert( func != 0 && cn <= 4 );
 
-        AutoBuffer<DecimateAlpha> _xofs(ssize.width*2);
+        ScratchBuffer<DecimateAlpha> _xofs(ssize.width*2);
         DecimateAlpha* xofs = _xofs;
 
         for( dx = 0, k = 0; dx < dsize.width; dx++ )
@@ -1559,130 +1938,7 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
         return;
     }
 
-    int xmin = 0, xmax = dsize.width, width = dsize.width*cn;
-    bool area_mode = interpolation == INTER_AREA;
-    bool fixpt = depth == CV_8U;
-    float fx, fy;
-    ResizeFunc func=0;
-    int ksize=0, ksize2;
-    if( interpolation == INTER_CUBIC )
-        ksize = 4, func = cubic_tab[depth];
-    else if( interpolation == INTER_LANCZOS4 )
-        ksize = 8, func = lanczos4_tab[depth];
-    else if( interpolation == INTER_LINEAR || interpolation == INTER_AREA )
-        ksize = 2, func = linear_tab[depth];
-    else
-        CV_Error( CV_StsBadArg, "Unknown interpolation method" );
-    ksize2 = ksize/2;
-
-    CV_Assert( func != 0 );
-
-    AutoBuffer<uchar> _buffer((width + dsize.height)*(sizeof(int) + sizeof(float)*ksize));
-    int* xofs = (int*)(uchar*)_buffer;
-    int* yofs = xofs + width;
-    float* alpha = (float*)(yofs + dsize.height);
-    short* ialpha = (short*)alpha;
-    float* beta = alpha + width*ksize;
-    short* ibeta = ialpha + width*ksize;
-    float cbuf[MAX_ESIZE];
-
-    for( dx = 0; dx < dsize.width; dx++ )
-    {
-        if( !area_mode )
-        {
-            fx = (float)((dx+0.5)*scale_x - 0.5);
-            sx = cvFloor(fx);
-            fx -= sx;
-        }
-        else
-        {
-            sx = cvFloor(dx*scale_x);
-            fx = (float)((dx+1) - (sx+1)*inv_scale_x);
-            fx = fx <= 0 ? 0.f : fx - cvFloor(fx);
-        }
-
-        if( sx < ksize2-1 )
-        {
-            xmin = dx+1;
-            if( sx < 0 )
-                fx = 0, sx = 0;
-        }
-
-        if( sx + ksize2 >= ssize.width )
-        {
-            xmax = std::min( xmax, dx );
-            if( sx >= ssize.width-1 )
-                fx = 0, sx = ssize.width-1;
-        }
-
-        for( k = 0, sx *= cn; k < cn; k++ )
-            xofs[dx*cn + k] = sx + k;
-
-        if( interpolation == INTER_CUBIC )
-            interpolateCubic( fx, cbuf );
-        else if( interpolation == INTER_LANCZOS4 )
-            interpolateLanczos4( fx, cbuf );
-        else
-        {
-            cbuf[0] = 1.f - fx;
-            cbuf[1] = fx;
-        }
-        if( fixpt )
-        {
-            for( k = 0; k < ksize; k++ )
-                ialpha[dx*cn*ksize + k] = saturate_cast<short>(cbuf[k]*INTER_RESIZE_COEF_SCALE);
-            for( ; k < cn*ksize; k++ )
-                ialpha[dx*cn*ksize + k] = ialpha[dx*cn*ksize + k - ksize];
-        }
-        else
-        {
-            for( k = 0; k < ksize; k++ )
-                alpha[dx*cn*ksize + k] = cbuf[k];
-            for( ; k < cn*ksize; k++ )
-                alpha[dx*cn*ksize + k] = alpha[dx*cn*ksize + k - ksize];
-        }
-    }
-
-    for( dy = 0; dy < dsize.height; dy++ )
-    {
-        if( !area_mode )
-        {
-            fy = (float)((dy+0.5)*scale_y - 0.5);
-            sy = cvFloor(fy);
-            fy -= sy;
-        }
-        else
-        {
-            sy = cvFloor(dy*scale_y);
-            fy = (float)((dy+1) - (sy+1)*inv_scale_y);
-            fy = fy <= 0 ? 0.f : fy - cvFloor(fy);
-        }
-
-        yofs[dy] = sy;
-        if( interpolation == INTER_CUBIC )
-            interpolateCubic( fy, cbuf );
-        else if( interpolation == INTER_LANCZOS4 )
-            interpolateLanczos4( fy, cbuf );
-        else
-        {
-            cbuf[0] = 1.f - fy;
-            cbuf[1] = fy;
-        }
-
-        if( fixpt )
-        {
-            for( k = 0; k < ksize; k++ )
-                ibeta[dy*ksize + k] = saturate_cast<short>(cbuf[k]*INTER_RESIZE_COEF_SCALE);
-        }
-        else
-        {
-            for( k = 0; k < ksize; k++ )
-                beta[dy*ksize + k] = cbuf[k];
-        }
-    }
-
-    func( src, dst, xofs, fixpt ? (void*)ialpha : (void*)alpha, yofs,
-          fixpt ? (void*)ibeta : (void*)beta, xmin, xmax, ksize );
+    resizeRows( src, 0, src.rows, dst, 0, inv_scale_x, inv_scale_y, interpolation );
 }
 
 
@@ -1825,6 +2081,10 @@ struct RemapVec_8u
 
         if( cn == 1 )
         {
+        #if CV_TRY_AVX2
+            if( checkHardwareSupport(CV_CPU_AVX2) )
+                x = avx2::RemapVec_8u_C1(S0, sstep, _src.cols, _src.rows, D, XY, FXY, wtab, width);
+        #endif
             for( ; x <= width - 8; x += 8 )
             {
                 __m128i xy0 = _mm_loadu_si128( (const __m128i*)(XY + x*2));
@@ -2390,47 +2650,252 @@ static void remapLanczos4( const Mat& _src, Mat& _dst, const Mat& _xy,
                     y[i] = borderInterpolate(sy + i, ssize.height, borderType1);
                 }
 
-                for( k = 0; k < cn; k++, S0++, w -= 64 )
-                {
-                    WT cv = cval[k], sum = cv*ONE;
-                    for( i = 0; i < 8; i++, w += 8 )
+                for( k = 0; k < cn; k++, S0++, w -= 64 )
+                {
+                    WT cv = cval[k], sum = cv*ONE;
+                    for( i = 0; i < 8; i++, w += 8 )
+                    {
+                        int yi = y[i];
+                        const T* S1 = S0 + yi*sstep;
+                        if( yi < 0 )
+                            continue;
+                        if( x[0] >= 0 )
+                            sum += (S1[x[0]] - cv)*w[0];
+                        if( x[1] >= 0 )
+                            sum += (S1[x[1]] - cv)*w[1];
+                        if( x[2] >= 0 )
+                            sum += (S1[x[2]] - cv)*w[2];
+                        if( x[3] >= 0 )
+                            sum += (S1[x[3]] - cv)*w[3];
+                        if( x[4] >= 0 )
+                            sum += (S1[x[4]] - cv)*w[4];
+                        if( x[5] >= 0 )
+                            sum += (S1[x[5]] - cv)*w[5];
+                        if( x[6] >= 0 )
+                            sum += (S1[x[6]] - cv)*w[6];
+                        if( x[7] >= 0 )
+                            sum += (S1[x[7]] - cv)*w[7];
+                    }
+                    D[k] = castOp(sum);
+                }
+                S0 -= cn;
+            }
+        }
+    }
+}
+
+
+typedef void (*RemapNNFunc)(const Mat& _src, Mat& _dst, const Mat& _xy,
+                            int borderType, const Scalar& _borderValue );
+
+typedef void (*RemapFunc)(const Mat& _src, Mat& _dst, const Mat& _xy,
+                          const Mat& _fxy, const void* _wtab,
+                          int borderType, const Scalar& _borderValue);
+
+class RemapInvoker
+{
+public:
+    RemapInvoker( const Mat& _src, Mat& _dst, const Mat* _m1, const Mat* _m2,
+                  RemapNNFunc _nnfunc, RemapFunc _ifunc, const void* _ctab,
+                  bool _planar_input, bool _direct, int _borderType, const Scalar& _borderValue ) :
+        src(_src), dst(_dst), m1(_m1), m2(_m2), nnfunc(_nnfunc), ifunc(_ifunc), ctab(_ctab),
+        planar_input(_planar_input), direct(_direct), borderType(_borderType), borderValue(_borderValue)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        if( direct ) // the maps are already in the fixed-point format
+        {
+            Range rows(range.begin(), range.end());
+            Mat dpart0 = dst.rowRange(rows);
+            if( nnfunc )
+                nnfunc( src, dpart0, m1->rowRange(rows), borderType, borderValue );
+            else
+                ifunc( src, dpart0, m1->rowRange(rows), m2->rowRange(rows), ctab, borderType, borderValue );
+            return;
+        }
+
+        const Mat& map1 = *m1;
+        const Mat& map2 = *m2;
+        int map_depth = map1.depth();
+        int x, y, x1, y1;
+        const int buf_size = 1 << 14;
+        int brows0 = std::min(128, dst.rows);
+        int bcols0 = std::min(buf_size/brows0, dst.cols);
+        brows0 = std::min(buf_size/bcols0, dst.rows);
+    #if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+    #endif
+
+        ScratchBuffer<short> _buf(brows0*bcols0*(nnfunc ? 2 : 3));
+        Mat _bufxy(brows0, bcols0, CV_16SC2, (short*)_buf), _bufa;
+        if( !nnfunc )
+            _bufa = Mat(brows0, bcols0, CV_16UC1, (short*)_buf + brows0*bcols0*2);
+
+        for( y = range.begin(); y < range.end(); y += brows0 )
+        {
+            for( x = 0; x < dst.cols; x += bcols0 )
+            {
+                int brows = std::min(brows0, range.end() - y);
+                int bcols = std::min(bcols0, dst.cols - x);
+                Mat dpart(dst, Rect(x, y, bcols, brows));
+                Mat bufxy(_bufxy, Rect(0, 0, bcols, brows));
+
+                if( nnfunc )
+                {
+                    if( map_depth != CV_32F )
+                    {
+                        for( y1 = 0; y1 < brows; y1++ )
+                        {
+                            short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                            const short* sXY = (const short*)(m1->data + m1->step*(y+y1)) + x*2;
+                            const ushort* sA = (const ushort*)(m2->data + m2->step*(y+y1)) + x;
+
+                            for( x1 = 0; x1 < bcols; x1++ )
+                            {
+                                int a = sA[x1] & (INTER_TAB_SIZE2-1);
+                                XY[x1*2] = sXY[x1*2] + NNDeltaTab_i[a][0];
+                                XY[x1*2+1] = sXY[x1*2+1] + NNDeltaTab_i[a][1];
+                            }
+                        }
+                    }
+                    else if( !planar_input )
+                        map1(Rect(x,y,bcols,brows)).convertTo(bufxy, bufxy.depth());
+                    else
+                    {
+                        for( y1 = 0; y1 < brows; y1++ )
+                        {
+                            short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                            const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
+                            const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
+                            x1 = 0;
+
+                        #if CV_SSE2
+                            if( useSIMD )
+                            {
+                                for( ; x1 <= bcols - 8; x1 += 8 )
+                                {
+                                    __m128 fx0 = _mm_loadu_ps(sX + x1);
+                                    __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
+                                    __m128 fy0 = _mm_loadu_ps(sY + x1);
+                                    __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
+                                    __m128i ix0 = _mm_cvtps_epi32(fx0);
+                                    __m128i ix1 = _mm_cvtps_epi32(fx1);
+                                    __m128i iy0 = _mm_cvtps_epi32(fy0);
+                                    __m128i iy1 = _mm_cvtps_epi32(fy1);
+                                    ix0 = _mm_packs_epi32(ix0, ix1);
+                                    iy0 = _mm_packs_epi32(iy0, iy1);
+                                    ix1 = _mm_unpacklo_epi16(ix0, iy0);
+                                    iy1 = _mm_unpackhi_epi16(ix0, iy0);
+                                    _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
+                                    _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
+                                }
+                            }
+                        #endif
+
+                            for( ; x1 < bcols; x1++ )
+                            {
+                                XY[x1*2] = saturate_cast<short>(sX[x1]);
+                                XY[x1*2+1] = saturate_cast<short>(sY[x1]);
+                            }
+                        }
+                    }
+                    nnfunc( src, dpart, bufxy, borderType, borderValue );
+                    continue;
+                }
+
+                Mat bufa(_bufa, Rect(0,0,bcols, brows));
+                for( y1 = 0; y1 < brows; y1++ )
+                {
+                    short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                    ushort* A = (ushort*)(bufa.data + bufa.step*y1);
+
+                    if( planar_input )
+                    {
+                        const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
+                        const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
+
+                        x1 = 0;
+                    #if CV_SSE2
+                        if( useSIMD )
+                        {
+                            __m128 scale = _mm_set1_ps((float)INTER_TAB_SIZE);
+                            __m128i mask = _mm_set1_epi32(INTER_TAB_SIZE-1);
+                            for( ; x1 <= bcols - 8; x1 += 8 )
+                            {
+                                __m128 fx0 = _mm_loadu_ps(sX + x1);
+                                __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
+                                __m128 fy0 = _mm_loadu_ps(sY + x1);
+                                __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
+                                __m128i ix0 = _mm_cvtps_epi32(_mm_mul_ps(fx0, scale));
+                                __m128i ix1 = _mm_cvtps_epi32(_mm_mul_ps(fx1, scale));
+                                __m128i iy0 = _mm_cvtps_epi32(_mm_mul_ps(fy0, scale));
+                                __m128i iy1 = _mm_cvtps_epi32(_mm_mul_ps(fy1, scale));
+                                __m128i mx0 = _mm_and_si128(ix0, mask);
+                                __m128i mx1 = _mm_and_si128(ix1, mask);
+                                __m128i my0 = _mm_and_si128(iy0, mask);
+                                __m128i my1 = _mm_and_si128(iy1, mask);
+                                mx0 = _mm_packs_epi32(mx0, mx1);
+                                my0 = _mm_packs_epi32(my0, my1);
+                                my0 = _mm_slli_epi16(my0, INTER_BITS);
+                                mx0 = _mm_or_si128(mx0, my0);
+                                _mm_storeu_si128((__m128i*)(A + x1), mx0);
+                                ix0 = _mm_srai_epi32(ix0, INTER_BITS);
+                                ix1 = _mm_srai_epi32(ix1, INTER_BITS);
+                                iy0 = _mm_srai_epi32(iy0, INTER_BITS);
+                                iy1 = _mm_srai_epi32(iy1, INTER_BITS);
+                                ix0 = _mm_packs_epi32(ix0, ix1);
+                                iy0 = _mm_packs_epi32(iy0, iy1);
+                                ix1 = _mm_unpacklo_epi16(ix0, iy0);
+                                iy1 = _mm_unpackhi_epi16(ix0, iy0);
+                                _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
+                                _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
+                            }
+                        }
+                    #endif
+
+                        for( ; x1 < bcols; x1++ )
+                        {
+                            int sx = cvRound(sX[x1]*INTER_TAB_SIZE);
+                            int sy = cvRound(sY[x1]*INTER_TAB_SIZE);
+                            int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
+                            XY[x1*2] = (short)(sx >> INTER_BITS);
+                            XY[x1*2+1] = (short)(sy >> INTER_BITS);
+                            A[x1] = (ushort)v;
+                        }
+                    }
+                    else
                     {
-                        int yi = y[i];
-                        const T* S1 = S0 + yi*sstep;
-                        if( yi < 0 )
-                            continue;
-                        if( x[0] >= 0 )
-                            sum += (S1[x[0]] - cv)*w[0];
-                        if( x[1] >= 0 )
-                            sum += (S1[x[1]] - cv)*w[1];
-                        if( x[2] >= 0 )
-                            sum += (S1[x[2]] - cv)*w[2];
-                        if( x[3] >= 0 )
-                            sum += (S1[x[3]] - cv)*w[3];
-                        if( x[4] >= 0 )
-                            sum += (S1[x[4]] - cv)*w[4];
-                        if( x[5] >= 0 )
-                            sum += (S1[x[5]] - cv)*w[5];
-                        if( x[6] >= 0 )
-                            sum += (S1[x[6]] - cv)*w[6];
-                        if( x[7] >= 0 )
-                            sum += (S1[x[7]] - cv)*w[7];
+                        const float* sXY = (const float*)(map1.data + map1.step*(y+y1)) + x*2;
+
+                        for( x1 = 0; x1 < bcols; x1++ )
+                        {
+                            int sx = cvRound(sXY[x1*2]*INTER_TAB_SIZE);
+                            int sy = cvRound(sXY[x1*2+1]*INTER_TAB_SIZE);
+                            int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
+                            XY[x1*2] = (short)(sx >> INTER_BITS);
+                            XY[x1*2+1] = (short)(sy >> INTER_BITS);
+                            A[x1] = (ushort)v;
+                        }
                     }
-                    D[k] = castOp(sum);
                 }
-                S0 -= cn;
+                ifunc(src, dpart, bufxy, bufa, ctab, borderType, borderValue);
             }
         }
     }
-}
-
 
-typedef void (*RemapNNFunc)(const Mat& _src, Mat& _dst, const Mat& _xy,
-                            int borderType, const Scalar& _borderValue );
-
-typedef void (*RemapFunc)(const Mat& _src, Mat& _dst, const Mat& _xy,
-                          const Mat& _fxy, const void* _wtab,
-                          int borderType, const Scalar& _borderValue);
+private:
+    Mat src;
+    Mat dst;
+    const Mat *m1, *m2;
+    RemapNNFunc nnfunc;
+    RemapFunc ifunc;
+    const void* ctab;
+    bool planar_input, direct;
+    int borderType;
+    Scalar borderValue;
+};
 
 }
 
@@ -2438,6 +2903,7 @@ void cv::remap( InputArray _src, OutputArray _dst,
                 InputArray _map1, InputArray _map2,
                 int interpolation, int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_REGION("cv::remap");
     static RemapNNFunc nn_tab[] =
     {
         remapNearest<uchar>, remapNearest<schar>, remapNearest<ushort>, remapNearest<short>,
@@ -2480,23 +2946,20 @@ void cv::remap( InputArray _src, OutputArray _dst,
     if( dst.data == src.data )
         src = src.clone();
 
-    int depth = src.depth(), map_depth = map1.depth();
+    int depth = src.depth();
     RemapNNFunc nnfunc = 0;
     RemapFunc ifunc = 0;
     const void* ctab = 0;
     bool fixpt = depth == CV_8U;
-    bool planar_input = false;
+    bool planar_input = false, direct = false;
 
     if( interpolation == INTER_NEAREST )
     {
         nnfunc = nn_tab[depth];
         CV_Assert( nnfunc != 0 );
 
-        if( map1.type() == CV_16SC2 && !map2.data ) // the data is already in the right format
-        {
-            nnfunc( src, dst, map1, borderType, borderValue );
-            return;
-        }
+        // the data is already in the right format
+        direct = map1.type() == CV_16SC2 && !map2.data;
     }
     else
     {
@@ -2522,182 +2985,18 @@ void cv::remap( InputArray _src, OutputArray _dst,
     {
         if( map1.type() != CV_16SC2 )
             std::swap(m1, m2);
-        if( ifunc )
-        {
-            ifunc( src, dst, *m1, *m2, ctab, borderType, borderValue );
-            return;
-        }
+        direct = ifunc != 0;
     }
-    else
+    else if( !direct )
     {
         CV_Assert( (map1.type() == CV_32FC2 && !map2.data) ||
             (map1.type() == CV_32FC1 && map2.type() == CV_32FC1) );
         planar_input = map1.channels() == 1;
     }
 
-    int x, y, x1, y1;
-    const int buf_size = 1 << 14;
-    int brows0 = std::min(128, dst.rows);
-    int bcols0 = std::min(buf_size/brows0, dst.cols);
-    brows0 = std::min(buf_size/bcols0, dst.rows);
-#if CV_SSE2
-    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
-#endif
-
-    Mat _bufxy(brows0, bcols0, CV_16SC2), _bufa;
-    if( !nnfunc )
-        _bufa.create(brows0, bcols0, CV_16UC1);
-
-    for( y = 0; y < dst.rows; y += brows0 )
-    {
-        for( x = 0; x < dst.cols; x += bcols0 )
-        {
-            int brows = std::min(brows0, dst.rows - y);
-            int bcols = std::min(bcols0, dst.cols - x);
-            Mat dpart(dst, Rect(x, y, bcols, brows));
-            Mat bufxy(_bufxy, Rect(0, 0, bcols, brows));
-
-            if( nnfunc )
-            {
-                if( map_depth != CV_32F )
-                {
-                    for( y1 = 0; y1 < brows; y1++ )
-                    {
-                        short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                        const short* sXY = (const short*)(m1->data + m1->step*(y+y1)) + x*2;
-                        const ushort* sA = (const ushort*)(m2->data + m2->step*(y+y1)) + x;
-
-                        for( x1 = 0; x1 < bcols; x1++ )
-                        {
-                            int a = sA[x1] & (INTER_TAB_SIZE2-1);
-                            XY[x1*2] = sXY[x1*2] + NNDeltaTab_i[a][0];
-                            XY[x1*2+1] = sXY[x1*2+1] + NNDeltaTab_i[a][1];
-                        }
-                    }
-                }
-                else if( !planar_input )
-                    map1(Rect(0,0,bcols,brows)).convertTo(bufxy, bufxy.depth());
-                else
-                {
-                    for( y1 = 0; y1 < brows; y1++ )
-                    {
-                        short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                        const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
-                        const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
-                        x1 = 0;
-
-                    #if CV_SSE2
-                        if( useSIMD )
-                        {
-                            for( ; x1 <= bcols - 8; x1 += 8 )
-                            {
-                                __m128 fx0 = _mm_loadu_ps(sX + x1);
-                                __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
-                                __m128 fy0 = _mm_loadu_ps(sY + x1);
-                                __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
-                                __m128i ix0 = _mm_cvtps_epi32(fx0);
-                                __m128i ix1 = _mm_cvtps_epi32(fx1);
-                                __m128i iy0 = _mm_cvtps_epi32(fy0);
-                                __m128i iy1 = _mm_cvtps_epi32(fy1);
-                                ix0 = _mm_packs_epi32(ix0, ix1);
-                                iy0 = _mm_packs_epi32(iy0, iy1);
-                                ix1 = _mm_unpacklo_epi16(ix0, iy0);
-                                iy1 = _mm_unpackhi_epi16(ix0, iy0);
-                                _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
-                                _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
-                            }
-                        }
-                    #endif
-
-                        for( ; x1 < bcols; x1++ )
-                        {
-                            XY[x1*2] = saturate_cast<short>(sX[x1]);
-                            XY[x1*2+1] = saturate_cast<short>(sY[x1]);
-                        }
-                    }
-                }
-                nnfunc( src, dpart, bufxy, borderType, borderValue );
-                continue;
-            }
-
-            Mat bufa(_bufa, Rect(0,0,bcols, brows));
-            for( y1 = 0; y1 < brows; y1++ )
-            {
-                short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                ushort* A = (ushort*)(bufa.data + bufa.step*y1);
-
-                if( planar_input )
-                {
-                    const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
-                    const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
-
-                    x1 = 0;
-                #if CV_SSE2
-                    if( useSIMD )
-                    {
-                        __m128 scale = _mm_set1_ps((float)INTER_TAB_SIZE);
-                        __m128i mask = _mm_set1_epi32(INTER_TAB_SIZE-1);
-                        for( ; x1 <= bcols - 8; x1 += 8 )
-                        {
-                            __m128 fx0 = _mm_loadu_ps(sX + x1);
-                            __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
-                            __m128 fy0 = _mm_loadu_ps(sY + x1);
-                            __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
-                            __m128i ix0 = _mm_cvtps_epi32(_mm_mul_ps(fx0, scale));
-                            __m128i ix1 = _mm_cvtps_epi32(_mm_mul_ps(fx1, scale));
-                            __m128i iy0 = _mm_cvtps_epi32(_mm_mul_ps(fy0, scale));
-                            __m128i iy1 = _mm_cvtps_epi32(_mm_mul_ps(fy1, scale));
-                            __m128i mx0 = _mm_and_si128(ix0, mask);
-                            __m128i mx1 = _mm_and_si128(ix1, mask);
-                            __m128i my0 = _mm_and_si128(iy0, mask);
-                            __m128i my1 = _mm_and_si128(iy1, mask);
-                            mx0 = _mm_packs_epi32(mx0, mx1);
-                            my0 = _mm_packs_epi32(my0, my1);
-                            my0 = _mm_slli_epi16(my0, INTER_BITS);
-                            mx0 = _mm_or_si128(mx0, my0);
-                            _mm_storeu_si128((__m128i*)(A + x1), mx0);
-                            ix0 = _mm_srai_epi32(ix0, INTER_BITS);
-                            ix1 = _mm_srai_epi32(ix1, INTER_BITS);
-                            iy0 = _mm_srai_epi32(iy0, INTER_BITS);
-                            iy1 = _mm_srai_epi32(iy1, INTER_BITS);
-                            ix0 = _mm_packs_epi32(ix0, ix1);
-                            iy0 = _mm_packs_epi32(iy0, iy1);
-                            ix1 = _mm_unpacklo_epi16(ix0, iy0);
-                            iy1 = _mm_unpackhi_epi16(ix0, iy0);
-                            _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
-                            _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
-                        }
-                    }
-                #endif
-
-                    for( ; x1 < bcols; x1++ )
-                    {
-                        int sx = cvRound(sX[x1]*INTER_TAB_SIZE);
-                        int sy = cvRound(sY[x1]*INTER_TAB_SIZE);
-                        int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
-                        XY[x1*2] = (short)(sx >> INTER_BITS);
-                        XY[x1*2+1] = (short)(sy >> INTER_BITS);
-                        A[x1] = (ushort)v;
-                    }
-                }
-                else
-                {
-                    const float* sXY = (const float*)(map1.data + map1.step*(y+y1)) + x*2;
-
-                    for( x1 = 0; x1 < bcols; x1++ )
-                    {
-                        int sx = cvRound(sXY[x1*2]*INTER_TAB_SIZE);
-                        int sy = cvRound(sXY[x1*2+1]*INTER_TAB_SIZE);
-                        int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
-                        XY[x1*2] = (short)(sx >> INTER_BITS);
-                        XY[x1*2+1] = (short)(sy >> INTER_BITS);
-                        A[x1] = (ushort)v;
-                    }
-                }
-            }
-            ifunc(src, dpart, bufxy, bufa, ctab, borderType, borderValue);
-        }
-    }
+    parallel_for( warpStripes(dst.rows, dst.cols*dst.channels()),
+                  RemapInvoker(src, dst, m1, m2, nnfunc, ifunc, ctab, planar_input, direct,
+                               borderType, borderValue) );
 }
 
 
@@ -2840,10 +3139,226 @@ void cv::convertMaps( InputArray _map1, InputArray _map2,
 }
 
 
+namespace cv
+{
+
+class WarpAffineInvoker
+{
+public:
+    WarpAffineInvoker( const Mat& _src, Mat& _dst, int _interpolation, int _borderType,
+                       const Scalar& _borderValue, const int* _adelta, const int* _bdelta,
+                       const double* _M ) :
+        src(_src), dst(_dst), interpolation(_interpolation), borderType(_borderType),
+        borderValue(_borderValue), adelta(_adelta), bdelta(_bdelta), M(_M)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        const int BLOCK_SZ = 64;
+        short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+        const int AB_BITS = MAX(10, (int)INTER_BITS);
+        const int AB_SCALE = 1 << AB_BITS;
+        int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2;
+        int x, y, x1, y1, width = dst.cols, height = dst.rows;
+    #if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+    #endif
+
+        int bh0 = std::min(BLOCK_SZ/2, height);
+        int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
+        bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
+
+        for( y = range.begin(); y < range.end(); y += bh0 )
+        {
+            for( x = 0; x < width; x += bw0 )
+            {
+                int bw = std::min( bw0, width - x);
+                int bh = std::min( bh0, range.end() - y);
+
+                Mat _XY(bh, bw, CV_16SC2, XY), matA;
+                Mat dpart(dst, Rect(x, y, bw, bh));
+
+                for( y1 = 0; y1 < bh; y1++ )
+                {
+                    short* xy = XY + y1*bw*2;
+                    int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
+                    int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
+
+                    if( interpolation == INTER_NEAREST )
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            int X = (X0 + adelta[x+x1]) >> AB_BITS;
+                            int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
+                            xy[x1*2] = saturate_cast<short>(X);
+                            xy[x1*2+1] = saturate_cast<short>(Y);
+                        }
+                    else
+                    {
+                        short* alpha = A + y1*bw;
+                        x1 = 0;
+                    #if CV_SSE2
+                        if( useSIMD )
+                        {
+                            __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
+                            __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
+                            for( ; x1 <= bw - 8; x1 += 8 )
+                            {
+                                __m128i tx0, tx1, ty0, ty1;
+                                tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
+                                ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
+                                tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
+                                ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
+
+                                tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
+                                ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
+                                tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
+                                ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
+
+                                __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
+                                                              _mm_and_si128(tx1, fxy_mask));
+                                __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
+                                                              _mm_and_si128(ty1, fxy_mask));
+                                tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
+                                                              _mm_srai_epi32(tx1, INTER_BITS));
+                                ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
+                                                      _mm_srai_epi32(ty1, INTER_BITS));
+                                fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
+
+                                _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
+                                _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
+                                _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
+                            }
+                        }
+                    #endif
+                        for( ; x1 < bw; x1++ )
+                        {
+                            int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
+                            int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
+                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                    (X & (INTER_TAB_SIZE-1)));
+                        }
+                    }
+                }
+
+                if( interpolation == INTER_NEAREST )
+                    remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
+                else
+                {
+                    Mat _matA(bh, bw, CV_16U, A);
+                    remap( src, dpart, _XY, _matA, interpolation, borderType, borderValue );
+                }
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int interpolation, borderType;
+    Scalar borderValue;
+    const int *adelta, *bdelta;
+    const double *M;
+};
+
+class WarpPerspectiveInvoker
+{
+public:
+    WarpPerspectiveInvoker( const Mat& _src, Mat& _dst, int _interpolation, int _borderType,
+                            const Scalar& _borderValue, const double* _M ) :
+        src(_src), dst(_dst), interpolation(_interpolation), borderType(_borderType),
+        borderValue(_borderValue), M(_M)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        const int BLOCK_SZ = 32;
+        short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+        int x, y, x1, y1, width = dst.cols, height = dst.rows;
+
+        int bh0 = std::min(BLOCK_SZ/2, height);
+        int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
+        bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
+
+        for( y = range.begin(); y < range.end(); y += bh0 )
+        {
+            for( x = 0; x < width; x += bw0 )
+            {
+                int bw = std::min( bw0, width - x);
+                int bh = std::min( bh0, range.end() - y);
+
+                Mat _XY(bh, bw, CV_16SC2, XY), matA;
+                Mat dpart(dst, Rect(x, y, bw, bh));
+
+                for( y1 = 0; y1 < bh; y1++ )
+                {
+                    short* xy = XY + y1*bw*2;
+                    double X0 = M[0]*x + M[1]*(y + y1) + M[2];
+                    double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
+                    double W0 = M[6]*x + M[7]*(y + y1) + M[8];
+
+                    if( interpolation == INTER_NEAREST )
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            double W = W0 + M[6]*x1;
+                            W = W ? 1./W : 0;
+                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+                            int X = saturate_cast<int>(fX);
+                            int Y = saturate_cast<int>(fY);
+
+                            xy[x1*2] = saturate_cast<short>(X);
+                            xy[x1*2+1] = saturate_cast<short>(Y);
+                        }
+                    else
+                    {
+                        short* alpha = A + y1*bw;
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            double W = W0 + M[6]*x1;
+                            W = W ? INTER_TAB_SIZE/W : 0;
+                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+                            int X = saturate_cast<int>(fX);
+                            int Y = saturate_cast<int>(fY);
+
+                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                    (X & (INTER_TAB_SIZE-1)));
+                        }
+                    }
+                }
+
+                if( interpolation == INTER_NEAREST )
+                    remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
+                else
+                {
+                    Mat _matA(bh, bw, CV_16U, A);
+                    remap( src, dpart, _XY, _matA, interpolation, borderType, borderValue );
+                }
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int interpolation, borderType;
+    Scalar borderValue;
+    const double *M;
+};
+
+}
+
 void cv::warpAffine( InputArray _src, OutputArray _dst,
                      InputArray _M0, Size dsize,
                      int flags, int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_REGION("cv::warpAffine");
     Mat src = _src.getMat(), M0 = _M0.getMat();
     _dst.create( dsize.area() == 0 ? src.size() : dsize, src.type() );
     Mat dst = _dst.getMat();
@@ -2851,8 +3366,6 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
     if( dst.data == src.data )
         src = src.clone();
 
-    const int BLOCK_SZ = 64;
-    short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
     double M[6];
     Mat matM(2, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
@@ -2879,15 +3392,11 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
         M[2] = b1; M[5] = b2;
     }
 
-    int x, y, x1, y1, width = dst.cols, height = dst.rows;
-    AutoBuffer<int> _abdelta(width*2);
+    int x, width = dst.cols, height = dst.rows;
+    ScratchBuffer<int> _abdelta(width*2);
     int* adelta = &_abdelta[0], *bdelta = adelta + width;
     const int AB_BITS = MAX(10, (int)INTER_BITS);
     const int AB_SCALE = 1 << AB_BITS;
-    int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2;
-#if CV_SSE2
-    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
-#endif
 
     for( x = 0; x < width; x++ )
     {
@@ -2895,99 +3404,16 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
         bdelta[x] = saturate_cast<int>(M[3]*x*AB_SCALE);
     }
 
-    int bh0 = std::min(BLOCK_SZ/2, height);
-    int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
-    bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
-
-    for( y = 0; y < height; y += bh0 )
-    {
-        for( x = 0; x < width; x += bw0 )
-        {
-            int bw = std::min( bw0, width - x);
-            int bh = std::min( bh0, height - y);
-
-            Mat _XY(bh, bw, CV_16SC2, XY), matA;
-            Mat dpart(dst, Rect(x, y, bw, bh));
-
-            for( y1 = 0; y1 < bh; y1++ )
-            {
-                short* xy = XY + y1*bw*2;
-                int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
-                int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
-
-                if( interpolation == INTER_NEAREST )
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        int X = (X0 + adelta[x+x1]) >> AB_BITS;
-                        int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
-                        xy[x1*2] = saturate_cast<short>(X);
-                        xy[x1*2+1] = saturate_cast<short>(Y);
-                    }
-                else
-                {
-                    short* alpha = A + y1*bw;
-                    x1 = 0;
-                #if CV_SSE2
-                    if( useSIMD )
-                    {
-                        __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
-                        __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
-                        for( ; x1 <= bw - 8; x1 += 8 )
-                        {
-                            __m128i tx0, tx1, ty0, ty1;
-                            tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
-                            ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
-                            tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
-                            ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
-
-                            tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
-                            ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
-                            tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
-                            ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
-
-                            __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
-                                                          _mm_and_si128(tx1, fxy_mask));
-                            __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
-                                                          _mm_and_si128(ty1, fxy_mask));
-                            tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
-                                                          _mm_srai_epi32(tx1, INTER_BITS));
-                            ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
-                                                  _mm_srai_epi32(ty1, INTER_BITS));
-                            fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
-
-                            _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
-                            _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
-                            _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
-                        }
-                    }
-                #endif
-                    for( ; x1 < bw; x1++ )
-                    {
-                        int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                        int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                (X & (INTER_TAB_SIZE-1)));
-                    }
-                }
-            }
-
-            if( interpolation == INTER_NEAREST )
-                remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
-            else
-            {
-                Mat _matA(bh, bw, CV_16U, A);
-                remap( src, dpart, _XY, _matA, interpolation, borderType, borderValue );
-            }
-        }
-    }
+    parallel_for( warpStripes(height, width*dst.channels()),
+                  WarpAffineInvoker(src, dst, interpolation, borderType, borderValue,
+                                    adelta, bdelta, M) );
 }
 
 
 void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
                           Size dsize, int flags, int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_REGION("cv::warpPerspective");
     Mat src = _src.getMat(), M0 = _M0.getMat();
     _dst.create( dsize.area() == 0 ? src.size() : dsize, src.type() );
     Mat dst = _dst.getMat();
@@ -2996,8 +3422,6 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
     if( dst.data == src.data )
         src = src.clone();
 
-    const int BLOCK_SZ = 32;
-    short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
     double M[9];
     Mat matM(3, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
@@ -3015,71 +3439,8 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
     if( !(flags & WARP_INVERSE_MAP) )
          invert(matM, matM);
 
-    int x, y, x1, y1, width = dst.cols, height = dst.rows;
-
-    int bh0 = std::min(BLOCK_SZ/2, height);
-    int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
-    bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
-
-    for( y = 0; y < height; y += bh0 )
-    {
-        for( x = 0; x < width; x += bw0 )
-        {
-            int bw = std::min( bw0, width - x);
-            int bh = std::min( bh0, height - y);
-
-            Mat _XY(bh, bw, CV_16SC2, XY), matA;
-            Mat dpart(dst, Rect(x, y, bw, bh));
-
-            for( y1 = 0; y1 < bh; y1++ )
-            {
-                short* xy = XY + y1*bw*2;
-                double X0 = M[0]*x + M[1]*(y + y1) + M[2];
-                double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
-                double W0 = M[6]*x + M[7]*(y + y1) + M[8];
-
-                if( interpolation == INTER_NEAREST )
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        double W = W0 + M[6]*x1;
-                        W = W ? 1./W : 0;
-                        double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                        double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                        int X = saturate_cast<int>(fX);
-                        int Y = saturate_cast<int>(fY);
-
-                        xy[x1*2] = saturate_cast<short>(X);
-                        xy[x1*2+1] = saturate_cast<short>(Y);
-                    }
-                else
-                {
-                    short* alpha = A + y1*bw;
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        double W = W0 + M[6]*x1;
-                        W = W ? INTER_TAB_SIZE/W : 0;
-                        double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                        double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                        int X = saturate_cast<int>(fX);
-                        int Y = saturate_cast<int>(fY);
-
-                        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                (X & (INTER_TAB_SIZE-1)));
-                    }
-                }
-            }
-
-            if( interpolation == INTER_NEAREST )
-                remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
-            else
-            {
-                Mat _matA(bh, bw, CV_16U, A);
-                remap( src, dpart, _XY, _matA, interpolation, borderType, borderValue );
-            }
-        }
-    }
+    parallel_for( warpStripes(dst.rows, dst.cols*dst.channels()),
+                  WarpPerspectiveInvoker(src, dst, interpolation, borderType, borderValue, M) );
 }
 
 
@@ -0,0 +1,291 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+/*
+   AVX2 kernels of imgwarp.cpp, see imgwarp_avx2.hpp. This file is compiled with the
+   AVX2 flags and must not include any OpenCV header except imgwarp_avx2.hpp.
+   The floating-point kernels repeat the operation order of the SSE2 code, and the
+   file is built without the contraction into FMA, so the results are the same.
+*/
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+#include "imgwarp_avx2.hpp"
+
+namespace cv { namespace avx2
+{
+
+typedef unsigned char uchar;
+typedef unsigned short ushort;
+
+// the same values as in imgwarp.cpp
+enum { INTER_RESIZE_COEF_BITS = 11, INTER_RESIZE_COEF_SCALE = 1 << INTER_RESIZE_COEF_BITS,
+       INTER_REMAP_COEF_BITS = 15, INTER_REMAP_COEF_SCALE = 1 << INTER_REMAP_COEF_BITS };
+
+// packs 2x8 int32 into 16 int16 in the natural order (the AVX2 packs work per 128-bit lane)
+static inline __m256i packs_epi32(const __m256i& a, const __m256i& b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+}
+
+static inline __m256i packus_epi16(const __m256i& a, const __m256i& b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+}
+
+/****************************************************************************************\
+*                                         Resize                                         *
+\****************************************************************************************/
+
+int VResizeLinearVec_32s8u(const uchar** _src, uchar* dst, const uchar* _beta, int width)
+{
+    const int** src = (const int**)_src;
+    const short* beta = (const short*)_beta;
+    const int *S0 = src[0], *S1 = src[1];
+    int x = 0;
+    __m256i b0 = _mm256_set1_epi16(beta[0]), b1 = _mm256_set1_epi16(beta[1]);
+    __m256i delta = _mm256_set1_epi16(2);
+
+    for( ; x <= width - 32; x += 32 )
+    {
+        __m256i x0, x1, y0, y1;
+        x0 = packs_epi32(_mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S0 + x)), 4),
+                         _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S0 + x + 8)), 4));
+        y0 = packs_epi32(_mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S1 + x)), 4),
+                         _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S1 + x + 8)), 4));
+        x1 = packs_epi32(_mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S0 + x + 16)), 4),
+                         _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S0 + x + 24)), 4));
+        y1 = packs_epi32(_mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S1 + x + 16)), 4),
+                         _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S1 + x + 24)), 4));
+
+        x0 = _mm256_adds_epi16(_mm256_mulhi_epi16(x0, b0), _mm256_mulhi_epi16(y0, b1));
+        x1 = _mm256_adds_epi16(_mm256_mulhi_epi16(x1, b0), _mm256_mulhi_epi16(y1, b1));
+
+        x0 = _mm256_srai_epi16(_mm256_adds_epi16(x0, delta), 2);
+        x1 = _mm256_srai_epi16(_mm256_adds_epi16(x1, delta), 2);
+        _mm256_storeu_si256((__m256i*)(dst + x), packus_epi16(x0, x1));
+    }
+
+    return x;
+}
+
+int VResizeLinearVec_32f(const uchar** _src, uchar* _dst, const uchar* _beta, int width)
+{
+    const float** src = (const float**)_src;
+    const float* beta = (const float*)_beta;
+    const float *S0 = src[0], *S1 = src[1];
+    float* dst = (float*)_dst;
+    int x = 0;
+    __m256 b0 = _mm256_set1_ps(beta[0]), b1 = _mm256_set1_ps(beta[1]);
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        __m256 x0, x1, y0, y1;
+        x0 = _mm256_loadu_ps(S0 + x);
+        x1 = _mm256_loadu_ps(S0 + x + 8);
+        y0 = _mm256_loadu_ps(S1 + x);
+        y1 = _mm256_loadu_ps(S1 + x + 8);
+
+        x0 = _mm256_add_ps(_mm256_mul_ps(x0, b0), _mm256_mul_ps(y0, b1));
+        x1 = _mm256_add_ps(_mm256_mul_ps(x1, b0), _mm256_mul_ps(y1, b1));
+
+        _mm256_storeu_ps(dst + x, x0);
+        _mm256_storeu_ps(dst + x + 8, x1);
+    }
+
+    return x;
+}
+
+int VResizeCubicVec_32s8u(const uchar** _src, uchar* dst, const uchar* _beta, int width)
+{
+    const int** src = (const int**)_src;
+    const short* beta = (const short*)_beta;
+    const int *S0 = src[0], *S1 = src[1], *S2 = src[2], *S3 = src[3];
+    int x = 0;
+    float scale = 1.f/(INTER_RESIZE_COEF_SCALE*INTER_RESIZE_COEF_SCALE);
+    __m256 b0 = _mm256_set1_ps(beta[0]*scale), b1 = _mm256_set1_ps(beta[1]*scale),
+        b2 = _mm256_set1_ps(beta[2]*scale), b3 = _mm256_set1_ps(beta[3]*scale);
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        __m256 s0, s1;
+        s0 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S0 + x))), b0),
+                           _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S1 + x))), b1));
+        s1 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S0 + x + 8))), b0),
+                           _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S1 + x + 8))), b1));
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S2 + x))), b2));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S2 + x + 8))), b2));
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S3 + x))), b3));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(S3 + x + 8))), b3));
+
+        __m256i v = packs_epi32(_mm256_cvtps_epi32(s0), _mm256_cvtps_epi32(s1));
+        v = packus_epi16(v, v);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm256_castsi256_si128(v));
+    }
+
+    return x;
+}
+
+int VResizeCubicVec_32f(const uchar** _src, uchar* _dst, const uchar* _beta, int width)
+{
+    const float** src = (const float**)_src;
+    const float* beta = (const float*)_beta;
+    const float *S0 = src[0], *S1 = src[1], *S2 = src[2], *S3 = src[3];
+    float* dst = (float*)_dst;
+    int x = 0;
+    __m256 b0 = _mm256_set1_ps(beta[0]), b1 = _mm256_set1_ps(beta[1]),
+        b2 = _mm256_set1_ps(beta[2]), b3 = _mm256_set1_ps(beta[3]);
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        __m256 s0, s1;
+        s0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(S0 + x), b0),
+                           _mm256_mul_ps(_mm256_loadu_ps(S1 + x), b1));
+        s1 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(S0 + x + 8), b0),
+                           _mm256_mul_ps(_mm256_loadu_ps(S1 + x + 8), b1));
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(S2 + x), b2));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(S2 + x + 8), b2));
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(S3 + x), b3));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(S3 + x + 8), b3));
+
+        _mm256_storeu_ps(dst + x, s0);
+        _mm256_storeu_ps(dst + x + 8, s1);
+    }
+
+    return x;
+}
+
+/*
+   D[dx] = S[xofs[dx]]*alpha[dx*2] + S[xofs[dx] + cn]*alpha[dx*2+1] for 8 dx at once:
+   the two source bytes of every output are gathered as a 32-bit word, put into
+   the two 16-bit halves of the lane and multiplied by the (alpha0, alpha1) pair
+   with a single madd.
+*/
+int HResizeLinearVec_8u32s(const uchar** src, uchar** _dst, int count, const int* xofs,
+                           const uchar* _alpha, int swidth, int, int cn, int, int xmax)
+{
+    const short* alpha = (const short*)_alpha;
+    int** dst = (int**)_dst;
+    int dx = 0, len = 0;
+
+    if( cn > 4 )
+        return 0;
+
+    // the gathers read 4 (8 for cn == 4) bytes starting at xofs[dx], which may
+    // go beyond the row end for the rightmost pixels
+    for( ; len <= xmax - 8; len += 8 )
+        if( xofs[len + 7] + (cn == 4 ? 8 : 4) > swidth )
+            break;
+
+    __m128i shift = _mm_cvtsi32_si128(cn*8);
+    __m256i mask = _mm256_set1_epi32(0xFF);
+
+    for( int k = 0; k < count; k++ )
+    {
+        const int* S = (const int*)src[k];
+        int* D = dst[k];
+
+        for( dx = 0; dx < len; dx += 8 )
+        {
+            __m256i ofs = _mm256_loadu_si256((const __m256i*)(xofs + dx));
+            __m256i a = _mm256_loadu_si256((const __m256i*)(alpha + dx*2));
+            __m256i v0 = _mm256_i32gather_epi32(S, ofs, 1), v1;
+            if( cn == 4 )
+                v1 = _mm256_i32gather_epi32(S, _mm256_add_epi32(ofs, _mm256_set1_epi32(4)), 1);
+            else
+                v1 = _mm256_srl_epi32(v0, shift);
+            v0 = _mm256_or_si256(_mm256_and_si256(v0, mask),
+                                 _mm256_slli_epi32(_mm256_and_si256(v1, mask), 16));
+            _mm256_storeu_si256((__m256i*)(D + dx), _mm256_madd_epi16(v0, a));
+        }
+    }
+
+    return len;
+}
+
+/****************************************************************************************\
+*                                         Remap                                          *
+\****************************************************************************************/
+
+int RemapVec_8u_C1(const uchar* S0, int sstep, int swidth, int sheight, uchar* D,
+                   const short* XY, const ushort* FXY, const short* wtab, int width)
+{
+    if( sstep >= 32768 || sheight < 2 )
+        return 0;
+
+    int x = 0;
+    // the gathers read 4 bytes at ofs and ofs + sstep; the last safe offset:
+    int maxofs = (sheight - 2)*sstep + swidth - 4;
+    __m256i xy2ofs = _mm256_set1_epi32(1 + (sstep << 16));
+    __m256i vmaxofs = _mm256_set1_epi32(maxofs);
+    __m256i delta = _mm256_set1_epi32(INTER_REMAP_COEF_SCALE/2);
+    __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i one = _mm256_set1_epi32(1);
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m256i ofs = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)(XY + x*2)), xy2ofs);
+        if( !_mm256_testz_si256(_mm256_cmpgt_epi32(ofs, vmaxofs), _mm256_cmpgt_epi32(ofs, vmaxofs)) )
+            break;
+
+        __m256i widx = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(FXY + x))), 1);
+        __m256i w01 = _mm256_i32gather_epi32((const int*)wtab, widx, 4);
+        __m256i w23 = _mm256_i32gather_epi32((const int*)wtab, _mm256_add_epi32(widx, one), 4);
+
+        __m256i v0 = _mm256_i32gather_epi32((const int*)S0, ofs, 1);
+        __m256i v1 = _mm256_i32gather_epi32((const int*)(S0 + sstep), ofs, 1);
+        v0 = _mm256_or_si256(_mm256_and_si256(v0, mask), _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(v0, 8), mask), 16));
+        v1 = _mm256_or_si256(_mm256_and_si256(v1, mask), _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(v1, 8), mask), 16));
+
+        v0 = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(v0, w01), _mm256_madd_epi16(v1, w23)), delta);
+        v0 = _mm256_srai_epi32(v0, INTER_REMAP_COEF_BITS);
+        v0 = packs_epi32(v0, v0);
+        v0 = packus_epi16(v0, v0);
+        _mm_storel_epi64((__m128i*)(D + x), _mm256_castsi256_si128(v0));
+    }
+
+    return x;
+}
+
+}}
+
+#endif
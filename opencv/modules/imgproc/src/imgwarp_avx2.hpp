@@ -0,0 +1,75 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+#ifndef __OPENCV_IMGPROC_IMGWARP_AVX2_HPP__
+#define __OPENCV_IMGPROC_IMGWARP_AVX2_HPP__
+
+/*
+   AVX2 versions of the resize and remap row kernels of imgwarp.cpp.
+
+   They are compiled in imgwarp_avx2.cpp with the AVX2 code generation flags and are
+   called only when checkHardwareSupport(CV_CPU_AVX2) is true. Like the SSE2 kernels
+   they replace, every function processes a prefix of the row and returns its length;
+   the caller completes the row. The results are bit-exact with the SSE2/C++ code.
+   Only built-in types are used in the interface (see core/src/simd_avx2.hpp).
+*/
+
+namespace cv { namespace avx2
+{
+
+// the vertical passes of resize, same arguments as VResizeLinearVec_32s8u etc.
+int VResizeLinearVec_32s8u(const unsigned char** src, unsigned char* dst, const unsigned char* beta, int width);
+int VResizeLinearVec_32f(const unsigned char** src, unsigned char* dst, const unsigned char* beta, int width);
+int VResizeCubicVec_32s8u(const unsigned char** src, unsigned char* dst, const unsigned char* beta, int width);
+int VResizeCubicVec_32f(const unsigned char** src, unsigned char* dst, const unsigned char* beta, int width);
+
+// the horizontal pass of the 8u bilinear resize, same arguments as HResizeLinear's VecOp
+int HResizeLinearVec_8u32s(const unsigned char** src, unsigned char** dst, int count, const int* xofs,
+                           const unsigned char* alpha, int swidth, int dwidth, int cn, int xmin, int xmax);
+
+// bilinear remap of a single-channel 8u image; the size of the image is needed
+// to keep the 32-bit gathers within it
+int RemapVec_8u_C1(const unsigned char* src, int sstep, int swidth, int sheight, unsigned char* dst,
+                   const short* XY, const unsigned short* FXY, const short* wtab, int width);
+
+}}
+
+#endif
@@ -1173,11 +1173,11 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
     }
 
     int nStripes = 1;
-#if defined HAVE_TBB && defined HAVE_TEGRA_OPTIMIZATION
+#ifdef HAVE_PARALLEL_FRAMEWORK
     if (src.data != dst.data && iterations == 1 &&  //NOTE: threads are not used for inplace processing
         (borderType & BORDER_ISOLATED) == 0 && //TODO: check border types
-        src.rows >= 64 ) //NOTE: just heuristics
-        nStripes = 4;
+        src.rows >= 64 && getNumThreads() > 1 ) //NOTE: just heuristics
+        nStripes = std::min(std::max(getNumThreads(), 4), src.rows/16);
 #endif
 
     parallel_for(BlockedRange(0, nStripes),
@@ -1216,6 +1216,7 @@ void cv::morphologyEx( InputArray _src, OutputArray _dst, int op,
                        InputArray kernel, Point anchor, int iterations,
                        int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_REGION("cv::morphologyEx");
     Mat src = _src.getMat(), temp;
     _dst.create(src.size(), src.type());
     Mat dst = _dst.getMat();
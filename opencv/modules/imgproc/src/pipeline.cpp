@@ -0,0 +1,611 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/*
+   The tile-fused chain of the image processing operations (cv::ImagePipeline).
+
+   Every operation is a stage that, once the size and the type of its input are known,
+   can tell which input rows it needs to compute a given range of its output rows
+   (the filter kernel halo, the resize interpolation window) and compute just these output rows
+   from just these input rows. run() splits the destination into a stripe per thread and each
+   stripe into small tiles. For every tile it walks the stages backwards to find the row ranges
+   of the tile in every intermediate image and then computes the stages forwards in the
+   per-thread buffers, see PipelineInvoker.
+*/
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+class ImagePipelineStage
+{
+public:
+    ImagePipelineStage() : stype(-1), dtype(-1) {}
+    virtual ~ImagePipelineStage() {}
+    virtual ImagePipelineStage* clone() const = 0;
+
+    // sets ssize, stype and computes dsize, dtype of the output
+    virtual void init( Size _ssize, int _stype ) = 0;
+    // returns the input rows needed to compute the output rows
+    virtual Range srcRows( Range dstRows ) const { return dstRows; }
+    // the per-thread filter engine, if the stage needs one
+    virtual Ptr<FilterEngine> createEngine() const { return Ptr<FilterEngine>(); }
+    // computes the output rows [dstY0, dstY0 + dst.rows) from the input rows [srcY0, srcY0 + src.rows)
+    virtual void apply( const Mat& src, int srcY0, Mat& dst, int dstY0, FilterEngine* engine ) const = 0;
+
+    Size ssize, dsize;
+    int stype, dtype;
+};
+
+namespace
+{
+
+class ColorStage : public ImagePipelineStage
+{
+public:
+    ColorStage( int _code, int _dcn ) : code(_code), dcn(_dcn)
+    {
+        // the conversions of the Bayer patterns use the neighbour rows and
+        // the 4:2:0 ones change the number of rows
+        if( (CV_BayerBG2BGR <= code && code <= CV_BayerGR2BGR) ||
+            (CV_BayerBG2BGR_VNG <= code && code <= CV_BayerGR2BGR_VNG) ||
+            (CV_BayerBG2GRAY <= code && code <= CV_BayerGR2GRAY) ||
+            (CV_YUV2RGB_NV12 <= code && code <= CV_YUV2GRAY_420) )
+            CV_Error( CV_StsBadFlag, "The color conversion is not supported by ImagePipeline" );
+    }
+
+    ImagePipelineStage* clone() const { return new ColorStage(*this); }
+
+    void init( Size _ssize, int _stype )
+    {
+        ssize = dsize = _ssize;
+        stype = _stype;
+        Mat probe(2, 2, stype, Scalar::all(0)), result;
+        cv::cvtColor( probe, result, code, dcn );
+        CV_Assert( result.size() == probe.size() );
+        dtype = result.type();
+    }
+
+    void apply( const Mat& src, int, Mat& dst, int, FilterEngine* ) const
+    {
+        cv::cvtColor( src, dst, code, dcn );
+    }
+
+    int code, dcn;
+};
+
+
+class ThresholdStage : public ImagePipelineStage
+{
+public:
+    ThresholdStage( double _thresh, double _maxval, int _type ) :
+        thresh(_thresh), maxval(_maxval), type(_type)
+    {
+        CV_Assert( (type & THRESH_OTSU) == 0 );
+    }
+
+    ImagePipelineStage* clone() const { return new ThresholdStage(*this); }
+
+    void init( Size _ssize, int _stype )
+    {
+        ssize = dsize = _ssize;
+        stype = dtype = _stype;
+    }
+
+    void apply( const Mat& src, int, Mat& dst, int, FilterEngine* ) const
+    {
+        cv::threshold( src, dst, thresh, maxval, type );
+    }
+
+    double thresh, maxval;
+    int type;
+};
+
+
+class ConvertStage : public ImagePipelineStage
+{
+public:
+    ConvertStage( int _rtype, double _alpha, double _beta ) :
+        rtype(_rtype), alpha(_alpha), beta(_beta) {}
+
+    ImagePipelineStage* clone() const { return new ConvertStage(*this); }
+
+    void init( Size _ssize, int _stype )
+    {
+        ssize = dsize = _ssize;
+        stype = _stype;
+        dtype = rtype < 0 ? stype : CV_MAKETYPE(CV_MAT_DEPTH(rtype), CV_MAT_CN(stype));
+    }
+
+    void apply( const Mat& src, int, Mat& dst, int, FilterEngine* ) const
+    {
+        src.convertTo( dst, dtype, alpha, beta );
+    }
+
+    int rtype;
+    double alpha, beta;
+};
+
+
+class ResizeStage : public ImagePipelineStage
+{
+public:
+    ResizeStage( Size _dsize, double _fx, double _fy, int _interpolation ) :
+        dsize0(_dsize), fx(_fx), fy(_fy), interpolation(_interpolation)
+    {
+        CV_Assert( !(dsize0 == Size()) || (fx > 0 && fy > 0) );
+        if( interpolation != INTER_NEAREST && interpolation != INTER_LINEAR &&
+            interpolation != INTER_CUBIC && interpolation != INTER_LANCZOS4 )
+            CV_Error( CV_StsBadArg, "The interpolation method is not supported by ImagePipeline" );
+    }
+
+    ImagePipelineStage* clone() const { return new ResizeStage(*this); }
+
+    // the same as in cv::resize
+    void init( Size _ssize, int _stype )
+    {
+        ssize = _ssize;
+        stype = dtype = _stype;
+        CV_Assert( ssize.area() > 0 );
+        if( dsize0 == Size() )
+        {
+            dsize = Size(saturate_cast<int>(ssize.width*fx), saturate_cast<int>(ssize.height*fy));
+            inv_scale_x = fx;
+            inv_scale_y = fy;
+        }
+        else
+        {
+            dsize = dsize0;
+            inv_scale_x = (double)dsize.width/ssize.width;
+            inv_scale_y = (double)dsize.height/ssize.height;
+        }
+        initResizeXTab( xtab, stype, ssize.width, dsize.width, inv_scale_x, interpolation );
+    }
+
+    Range srcRows( Range dstRows ) const
+    {
+        return resizeSrcRows( dstRows, ssize.height, inv_scale_y, interpolation );
+    }
+
+    void apply( const Mat& src, int srcY0, Mat& dst, int dstY0, FilterEngine* ) const
+    {
+        resizeRows( src, srcY0, ssize.height, dst, dstY0, inv_scale_x, inv_scale_y,
+                    interpolation, &xtab );
+    }
+
+    Size dsize0;
+    double fx, fy, inv_scale_x, inv_scale_y;
+    int interpolation;
+    ResizeXTab xtab;
+};
+
+
+class FilterStage : public ImagePipelineStage
+{
+public:
+    FilterStage( int _ddepth, int _borderType ) :
+        ddepth(_ddepth), borderType(_borderType & ~BORDER_ISOLATED) {}
+
+    void init( Size _ssize, int _stype )
+    {
+        ssize = dsize = _ssize;
+        stype = _stype;
+        dtype = CV_MAKETYPE(ddepth < 0 ? CV_MAT_DEPTH(stype) : ddepth, CV_MAT_CN(stype));
+        initFilter();
+        Ptr<FilterEngine> f = createEngine();
+        ksize = f->ksize;
+        anchor = f->anchor;
+    }
+
+    Range srcRows( Range dstRows ) const
+    {
+        return Range(std::max(dstRows.start - anchor.y, 0),
+                     std::min(dstRows.end + ksize.height - anchor.y - 1, ssize.height));
+    }
+
+    void apply( const Mat& src, int srcY0, Mat& dst, int dstY0, FilterEngine* f ) const
+    {
+        int y = f->start( ssize, Rect(0, dstY0, ssize.width, dst.rows) );
+        CV_Assert( y >= srcY0 && f->endY <= srcY0 + src.rows );
+        f->proceed( src.data + (y - srcY0)*src.step, (int)src.step, f->endY - y,
+                    dst.data, (int)dst.step );
+    }
+
+    // adjusts the parameters to the input size and type
+    virtual void initFilter() {}
+
+    int ddepth, borderType;
+    Size ksize;
+    Point anchor;
+};
+
+
+class GaussianStage : public FilterStage
+{
+public:
+    GaussianStage( Size _ksize, double _sigma1, double _sigma2, int _borderType ) :
+        FilterStage(-1, _borderType), ksize0(_ksize), sigma1(_sigma1), sigma2(_sigma2) {}
+
+    ImagePipelineStage* clone() const { return new GaussianStage(*this); }
+
+    // the same as in cv::GaussianBlur
+    void initFilter()
+    {
+        gksize = ksize0;
+        if( borderType != BORDER_CONSTANT )
+        {
+            if( ssize.height == 1 )
+                gksize.height = 1;
+            if( ssize.width == 1 )
+                gksize.width = 1;
+        }
+    }
+
+    Ptr<FilterEngine> createEngine() const
+    {
+        return createGaussianFilter( stype, gksize, sigma1, sigma2, borderType );
+    }
+
+    Size ksize0, gksize;
+    double sigma1, sigma2;
+};
+
+
+class BoxStage : public FilterStage
+{
+public:
+    BoxStage( int _ddepth, Size _ksize, Point _anchor, bool _normalize, int _borderType ) :
+        FilterStage(_ddepth, _borderType), ksize0(_ksize), anchor0(_anchor), normalize(_normalize) {}
+
+    ImagePipelineStage* clone() const { return new BoxStage(*this); }
+
+    // the same as in cv::boxFilter
+    void initFilter()
+    {
+        bksize = ksize0;
+        if( borderType != BORDER_CONSTANT && normalize )
+        {
+            if( ssize.height == 1 )
+                bksize.height = 1;
+            if( ssize.width == 1 )
+                bksize.width = 1;
+        }
+    }
+
+    Ptr<FilterEngine> createEngine() const
+    {
+        return createBoxFilter( stype, dtype, bksize, anchor0, normalize, borderType );
+    }
+
+    Size ksize0, bksize;
+    Point anchor0;
+    bool normalize;
+};
+
+
+class SepFilterStage : public FilterStage
+{
+public:
+    SepFilterStage( int _ddepth, const Mat& _kx, const Mat& _ky, Point _anchor,
+                    double _delta, int _borderType ) :
+        FilterStage(_ddepth, _borderType), kx(_kx), ky(_ky), anchor0(_anchor), delta(_delta) {}
+
+    ImagePipelineStage* clone() const { return new SepFilterStage(*this); }
+
+    Ptr<FilterEngine> createEngine() const
+    {
+        return createSeparableLinearFilter( stype, dtype, kx, ky, anchor0, delta, borderType );
+    }
+
+    Mat kx, ky;
+    Point anchor0;
+    double delta;
+};
+
+
+class SobelStage : public SepFilterStage
+{
+public:
+    SobelStage( int _ddepth, int _dx, int _dy, int _ksize, double _scale,
+                double _delta, int _borderType ) :
+        SepFilterStage(_ddepth, Mat(), Mat(), Point(-1,-1), _delta, _borderType),
+        dx(_dx), dy(_dy), aperture(_ksize), scale(_scale) {}
+
+    ImagePipelineStage* clone() const { return new SobelStage(*this); }
+
+    // the same as in cv::Sobel
+    void initFilter()
+    {
+        int ktype = std::max(CV_32F, std::max(CV_MAT_DEPTH(dtype), CV_MAT_DEPTH(stype)));
+        getDerivKernels( kx, ky, dx, dy, aperture, false, ktype );
+        if( scale != 1 )
+        {
+            if( dx == 0 )
+                kx *= scale;
+            else
+                ky *= scale;
+        }
+    }
+
+    int dx, dy, aperture;
+    double scale;
+};
+
+
+/*
+   Computes the stripes [range.begin(), range.end()) of the destination tile by tile. Each
+   intermediate buffer keeps the rows computed for the previous tile of the stripe, so only
+   the rows below them are computed and the overlapping halo rows are just moved to the top
+   of the buffer. The halos are recomputed only at the stripe boundaries.
+*/
+class PipelineInvoker
+{
+public:
+    PipelineInvoker( const vector<Ptr<ImagePipelineStage> >& _stages, const Mat& _src,
+                     const Mat& _dst, int _tileRows, int _nstripes ) :
+        stages(&_stages[0]), nstages((int)_stages.size()), src(_src), dst(_dst),
+        tileRows(_tileRows), nstripes(_nstripes)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int i, n = nstages, ntiles = (dst.rows + tileRows - 1)/tileRows;
+        // need[i] are the input rows of the stage i, todo[i] are its output rows to compute
+        // and have[i] are the output rows in bufs[i]
+        vector<Range> need(n+1), todo(n), have(n);
+        vector<Mat> bufs(n);
+        vector<Ptr<FilterEngine> > engines(n);
+
+        for( i = 0; i < n; i++ )
+            engines[i] = stages[i]->createEngine();
+
+        for( int s = range.begin(); s < range.end(); s++ )
+        {
+            int y0 = (int)((int64)ntiles*s/nstripes)*tileRows;
+            int y1 = std::min((int)((int64)ntiles*(s+1)/nstripes)*tileRows, dst.rows);
+            for( i = 0; i < n; i++ )
+                have[i] = Range(0, 0);
+
+            for( int y = y0; y < y1; y += tileRows )
+            {
+                need[n] = Range(y, std::min(y + tileRows, y1));
+                for( i = n-1; i >= 0; i-- )
+                {
+                    todo[i] = need[i+1];
+                    if( i < n-1 )
+                        todo[i].start = std::min(std::max(todo[i].start, have[i].end), todo[i].end);
+                    need[i] = !todo[i].empty() ? stages[i]->srcRows(todo[i]) :
+                              i > 0 ? have[i-1] : Range(0, 0);
+                }
+
+                Mat in = src.rowRange(need[0]), out;
+                for( i = 0; i < n; i++ )
+                {
+                    const ImagePipelineStage& stage = *stages[i];
+                    if( i == n-1 )
+                    {
+                        out = dst.rowRange(todo[i]);
+                        stage.apply( in, need[i].start, out, todo[i].start, engines[i] );
+                        break;
+                    }
+
+                    Mat& buf = bufs[i];
+                    int nrows = need[i+1].size(), nkeep = todo[i].start - need[i+1].start;
+                    int skip = have[i].size() - nkeep;
+                    CV_DbgAssert( nkeep == 0 || have[i].start <= need[i+1].start );
+
+                    if( buf.rows < nrows )
+                    {
+                        Mat buf1(nrows, stage.dsize.width, stage.dtype);
+                        if( nkeep > 0 )
+                            buf.rowRange(skip, skip + nkeep).copyTo(buf1.rowRange(0, nkeep));
+                        buf = buf1;
+                    }
+                    else if( nkeep > 0 && skip > 0 )
+                        memmove( buf.data, buf.data + skip*buf.step, nkeep*buf.step );
+
+                    if( !todo[i].empty() )
+                    {
+                        out = buf.rowRange(nkeep, nrows);
+                        stage.apply( in, need[i].start, out, todo[i].start, engines[i] );
+                    }
+                    have[i] = need[i+1];
+                    in = buf.rowRange(0, nrows);
+                }
+            }
+        }
+    }
+
+private:
+    const Ptr<ImagePipelineStage>* stages;
+    int nstages;
+    Mat src;
+    Mat dst;
+    int tileRows, nstripes;
+};
+
+enum { PIPELINE_TILE_BUF_SIZE = 1 << 17, PIPELINE_MIN_TILE_ROWS = 8 };
+
+// the memory of the intermediate rows needed for a tile of tileRows rows in the middle of dst
+static size_t estimateTileBufSize( const vector<Ptr<ImagePipelineStage> >& stages,
+                                   int dstRows, int tileRows )
+{
+    int i, n = (int)stages.size();
+    int y0 = std::max((dstRows - tileRows)/2, 0);
+    Range r(y0, std::min(y0 + tileRows, dstRows));
+    size_t bufsize = 0;
+
+    for( i = n-1; i > 0; i-- )
+    {
+        const ImagePipelineStage& stage = *stages[i];
+        r = stage.srcRows(r);
+        bufsize += r.size()*stage.ssize.width*CV_ELEM_SIZE(stage.stype);
+    }
+    return bufsize;
+}
+
+}
+
+ImagePipeline::ImagePipeline() : tileBufSize(0) {}
+
+ImagePipeline::ImagePipeline( const ImagePipeline& p ) : stages(p.stages), tileBufSize(p.tileBufSize) {}
+
+ImagePipeline& ImagePipeline::operator = ( const ImagePipeline& p )
+{
+    stages = p.stages;
+    tileBufSize = p.tileBufSize;
+    return *this;
+}
+
+ImagePipeline::~ImagePipeline() {}
+
+bool ImagePipeline::empty() const { return stages.empty(); }
+
+void ImagePipeline::clear() { stages.clear(); }
+
+void ImagePipeline::setTileBufSize( int size )
+{
+    CV_Assert( size >= 0 );
+    tileBufSize = size;
+}
+
+int ImagePipeline::getTileBufSize() const
+{
+    return tileBufSize > 0 ? tileBufSize : (int)PIPELINE_TILE_BUF_SIZE;
+}
+
+ImagePipeline& ImagePipeline::add( ImagePipelineStage* stage )
+{
+    stages.push_back(Ptr<ImagePipelineStage>(stage));
+    return *this;
+}
+
+ImagePipeline& ImagePipeline::cvtColor( int code, int dstCn )
+{
+    return add(new ColorStage(code, dstCn));
+}
+
+ImagePipeline& ImagePipeline::resize( Size dsize, double fx, double fy, int interpolation )
+{
+    return add(new ResizeStage(dsize, fx, fy, interpolation));
+}
+
+ImagePipeline& ImagePipeline::GaussianBlur( Size ksize, double sigma1, double sigma2, int borderType )
+{
+    return add(new GaussianStage(ksize, sigma1, sigma2, borderType));
+}
+
+ImagePipeline& ImagePipeline::boxFilter( int ddepth, Size ksize, Point anchor,
+                                         bool normalize, int borderType )
+{
+    return add(new BoxStage(ddepth, ksize, anchor, normalize, borderType));
+}
+
+ImagePipeline& ImagePipeline::Sobel( int ddepth, int dx, int dy, int ksize, double scale,
+                                     double delta, int borderType )
+{
+    return add(new SobelStage(ddepth, dx, dy, ksize, scale, delta, borderType));
+}
+
+ImagePipeline& ImagePipeline::sepFilter2D( int ddepth, InputArray kernelX, InputArray kernelY,
+                                           Point anchor, double delta, int borderType )
+{
+    return add(new SepFilterStage(ddepth, kernelX.getMat().clone(), kernelY.getMat().clone(),
+                                  anchor, delta, borderType));
+}
+
+ImagePipeline& ImagePipeline::threshold( double thresh, double maxval, int type )
+{
+    return add(new ThresholdStage(thresh, maxval, type));
+}
+
+ImagePipeline& ImagePipeline::convertTo( int rtype, double alpha, double beta )
+{
+    return add(new ConvertStage(rtype, alpha, beta));
+}
+
+void ImagePipeline::run( InputArray _src, OutputArray _dst ) const
+{
+    CV_TRACE_REGION("cv::ImagePipeline::run");
+    Mat src = _src.getMat();
+    CV_Assert( src.dims <= 2 );
+
+    if( stages.empty() )
+    {
+        src.copyTo(_dst);
+        return;
+    }
+
+    // the stages keep the sizes of the current run, so the run initializes its own copies
+    int i, n = (int)stages.size();
+    vector<Ptr<ImagePipelineStage> > st(n);
+    Size size = src.size();
+    int type = src.type();
+    for( i = 0; i < n; i++ )
+    {
+        st[i] = stages[i]->clone();
+        st[i]->init(size, type);
+        size = st[i]->dsize;
+        type = st[i]->dtype;
+    }
+
+    _dst.create(size, type);
+    Mat dst = _dst.getMat();
+    if( dst.empty() )
+        return;
+    // the tiles are computed in parallel from the source, so the in-place run needs a copy
+    if( dst.dataend > src.datastart && src.dataend > dst.datastart )
+        src = src.clone();
+
+    size_t bufSize = getTileBufSize();
+    int tileRows = PIPELINE_MIN_TILE_ROWS;
+    while( tileRows < dst.rows && estimateTileBufSize(st, dst.rows, tileRows*2) <= bufSize )
+        tileRows *= 2;
+
+    int ntiles = (dst.rows + tileRows - 1)/tileRows;
+    int nstripes = std::min(getNumThreads(), ntiles);
+    parallel_for( BlockedRange(0, nstripes), PipelineInvoker(st, src, dst, tileRows, nstripes) );
+}
+
+}
@@ -50,6 +50,7 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/imgproc/imgproc_c.h"
 #include "opencv2/core/internal.hpp"
+#include "opencv2/core/simd.hpp"
 #include <math.h>
 #include <assert.h>
 #include <string.h>
@@ -64,6 +65,15 @@
 #define GET_OPTIMIZED(func) (func)
 #endif
 
+#ifndef CV_TRY_AVX2
+#define CV_TRY_AVX2 0
+#endif
+
+#if CV_TRY_AVX2
+#include "imgwarp_avx2.hpp"
+#include "thresh_avx2.hpp"
+#endif
+
 /* helper tables */
 extern const uchar icvSaturate8u_cv[];
 #define CV_FAST_CAST_8U(t)  (assert(-256 <= (t) || (t) <= 512), icvSaturate8u_cv[(t)+256])
@@ -92,6 +102,31 @@ static inline Point normalizeAnchor( Point anchor, Size ksize )
 }
 
 void preprocess2DKernel( const Mat& kernel, vector<Point>& coords, vector<uchar>& coeffs );
+
+// returns the number of the filter engines to create for applyFilterStripes (1 if the filtering should be serial)
+int getFilterStripes( const Mat& src, const Mat& dst );
+// filters src by the horizontal stripes in parallel; each stripe needs its own engine,
+// since the engines and some of the filters (e.g. the box filter column sums) keep a state
+void applyFilterStripes( vector<Ptr<FilterEngine> >& engines, const Mat& src, Mat& dst, bool isolated=false );
+// the horizontal offsets and coefficients of resizeRows; they depend only on the widths, the type and
+// the interpolation, so the callers that resize an image by parts compute them once
+struct ResizeXTab
+{
+    ResizeXTab() : xmin(0), xmax(0), ksize(0) {}
+    vector<int> xofs;
+    vector<float> alpha; // the short fixed-point coefficients for CV_8U
+    int xmin, xmax, ksize;
+};
+void initResizeXTab( ResizeXTab& tab, int type, int swidth, int dwidth,
+                     double inv_scale_x, int interpolation );
+// resizes the rows [dstY0, dstY0 + dst.rows) of the image with srcHeight rows using INTER_NEAREST or
+// a separable interpolation; src holds the source rows [srcY0, srcY0 + src.rows), which must include
+// resizeSrcRows() of the destination rows
+void resizeRows( const Mat& src, int srcY0, int srcHeight, Mat& dst, int dstY0,
+                 double inv_scale_x, double inv_scale_y, int interpolation,
+                 const ResizeXTab* xtab=0 );
+// returns the source rows that resizeRows needs for the given destination rows
+Range resizeSrcRows( Range dstRows, int srcHeight, double inv_scale_y, int interpolation );
 void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Size corrsize, int ctype,
                 Point anchor=Point(0,0), double delta=0,
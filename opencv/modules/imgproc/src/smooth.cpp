@@ -298,6 +298,7 @@ void cv::boxFilter( InputArray _src, OutputArray _dst, int ddepth,
                 Size ksize, Point anchor,
                 bool normalize, int borderType )
 {
+    CV_TRACE_REGION("cv::boxFilter");
     Mat src = _src.getMat();
     int sdepth = src.depth(), cn = src.channels();
     if( ddepth < 0 )
@@ -316,9 +317,11 @@ void cv::boxFilter( InputArray _src, OutputArray _dst, int ddepth,
         return;
 #endif
 
-    Ptr<FilterEngine> f = createBoxFilter( src.type(), dst.type(),
-                        ksize, anchor, normalize, borderType );
-    f->apply( src, dst );
+    vector<Ptr<FilterEngine> > f(getFilterStripes(src, dst));
+    for( size_t i = 0; i < f.size(); i++ )
+        f[i] = createBoxFilter( src.type(), dst.type(),
+                                ksize, anchor, normalize, borderType );
+    applyFilterStripes( f, src, dst );
 }
 
 void cv::blur( InputArray src, OutputArray dst,
@@ -415,14 +418,309 @@ cv::Ptr<cv::FilterEngine> cv::createGaussianFilter( int type, Size ksize,
 }
 
 
+namespace cv
+{
+
+/*
+   The recursive Gaussian filter of R. Deriche ("Recursively implementing the Gaussian and
+   its derivatives", INRIA RR-1893, 1993): the sum of a causal and an anti-causal 4th order
+   IIR filter, applied to the rows and then to the columns. The cost per pixel does not depend
+   on sigma. The recursion runs in double, since in float the poles close to 1 make the gain
+   drift for sigma above ~30. Each line is extended by the border mode by 4*sigma pixels
+   (exactly enough for BORDER_CONSTANT and BORDER_REPLICATE with 1 and 0 pixels) and
+   the filter starts from the steady state of the first (last) pixel of the extended line.
+
+   The lines are processed in interleaved groups (several rows of the horizontal pass or
+   a block of columns of the vertical one), so the inner loops run over independent lines.
+*/
+
+enum { RGAUSS_BLOCK = 16 };
+static const double GAUSSIAN_RECURSIVE_MIN_SIGMA = 1.;
+
+struct RecursiveGaussianCoeffs
+{
+    RecursiveGaussianCoeffs( double sigma )
+    {
+        const double a0 = 1.68, a1 = 3.735, b0 = 1.783, b1 = 1.723;
+        const double w0 = 0.6318, w1 = 1.997, c0 = -0.6803, c1 = -0.2598;
+        double cw0 = std::cos(w0/sigma), sw0 = std::sin(w0/sigma);
+        double cw1 = std::cos(w1/sigma), sw1 = std::sin(w1/sigma);
+        double eb0 = std::exp(-b0/sigma), eb1 = std::exp(-b1/sigma);
+
+        n[0] = a0 + c0;
+        n[1] = eb1*(c1*sw1 - (c0 + 2*a0)*cw1) + eb0*(a1*sw0 - (2*c0 + a0)*cw0);
+        n[2] = 2*eb0*eb1*((a0 + c0)*cw1*cw0 - a1*cw1*sw0 - c1*cw0*sw1) + c0*eb0*eb0 + a0*eb1*eb1;
+        n[3] = eb1*eb0*eb0*(c1*sw1 - c0*cw1) + eb0*eb1*eb1*(a1*sw0 - a0*cw0);
+        d[0] = -2*eb1*cw1 - 2*eb0*cw0;
+        d[1] = 4*cw1*cw0*eb0*eb1 + eb1*eb1 + eb0*eb0;
+        d[2] = -2*cw0*eb0*eb1*eb1 - 2*cw1*eb1*eb0*eb0;
+        d[3] = eb0*eb0*eb1*eb1;
+        m[0] = n[1] - d[0]*n[0];
+        m[1] = n[2] - d[1]*n[0];
+        m[2] = n[3] - d[2]*n[0];
+        m[3] = -d[3]*n[0];
+
+        // normalize the DC gain to 1
+        double dsum = 1 + d[0] + d[1] + d[2] + d[3];
+        double nsum = n[0] + n[1] + n[2] + n[3], msum = m[0] + m[1] + m[2] + m[3];
+        double scale = dsum/(nsum + msum);
+        for( int k = 0; k < 4; k++ )
+            n[k] *= scale, m[k] *= scale;
+        // the steady state outputs of the causal and the anti-causal parts for the unit input
+        nss = nsum*scale/dsum;
+        mss = msum*scale/dsum;
+    }
+
+    double n[4], m[4], d[4], nss, mss;
+};
+
+/*
+   Filters nl interleaved lines. ext holds len + 8 samples of each line: the extended line
+   with 4 copies of its first and last samples on the sides. The outputs for the samples
+   [ofs, ofs + count) of the extended line are stored to out (count*nl values); yp is
+   a buffer of the same size for the causal part.
+*/
+template<typename WT> static void
+recursiveGaussianLines( const WT* ext, int len, int nl, int ofs, int count,
+                        const RecursiveGaussianCoeffs& k, WT* yp, WT* out, double* state )
+{
+    const double n0 = k.n[0], n1 = k.n[1], n2 = k.n[2], n3 = k.n[3];
+    const double m0 = k.m[0], m1 = k.m[1], m2 = k.m[2], m3 = k.m[3];
+    const double d0 = k.d[0], d1 = k.d[1], d2 = k.d[2], d3 = k.d[3];
+    double *y1 = state, *y2 = y1 + nl, *y3 = y2 + nl, *y4 = y3 + nl;
+    int i, j;
+
+    for( j = 0; j < nl; j++ )
+        y1[j] = y2[j] = y3[j] = y4[j] = ext[j]*k.nss;
+
+    for( i = 0; i < ofs + count; i++ )
+    {
+        const WT* x = ext + (i + 4)*nl;
+        double* t = y4;
+        for( j = 0; j < nl; j++ )
+            t[j] = n0*x[j] + n1*x[j-nl] + n2*x[j-nl*2] + n3*x[j-nl*3] -
+                   d0*y1[j] - d1*y2[j] - d2*y3[j] - d3*y4[j];
+        y4 = y3; y3 = y2; y2 = y1; y1 = t;
+        if( i >= ofs )
+            for( j = 0; j < nl; j++ )
+                yp[(i - ofs)*nl + j] = (WT)t[j];
+    }
+
+    const WT* last = ext + (len + 7)*nl;
+    for( j = 0; j < nl; j++ )
+        y1[j] = y2[j] = y3[j] = y4[j] = last[j]*k.mss;
+
+    for( i = len - 1; i >= ofs; i-- )
+    {
+        const WT* x = ext + (i + 4)*nl;
+        double* t = y4;
+        for( j = 0; j < nl; j++ )
+            t[j] = m0*x[j+nl] + m1*x[j+nl*2] + m2*x[j+nl*3] + m3*x[j+nl*4] -
+                   d0*y1[j] - d1*y2[j] - d2*y3[j] - d3*y4[j];
+        y4 = y3; y3 = y2; y2 = y1; y1 = t;
+        if( i < ofs + count )
+            for( j = 0; j < nl; j++ )
+                out[(i - ofs)*nl + j] = (WT)(yp[(i - ofs)*nl + j] + t[j]);
+    }
+}
+
+// the length of the line extension for the border mode
+static int recursiveGaussianPad( double sigma, int borderType )
+{
+    return borderType == BORDER_REPLICATE ? 0 : borderType == BORDER_CONSTANT ? 1 : cvCeil(sigma*4);
+}
+
+// fills the 4 samples on each side of the extended line of nl interleaved values
+template<typename WT> static void
+recursiveGaussianEnds( WT* ext, int len, int nl )
+{
+    for( int i = 0; i < 4; i++ )
+        for( int j = 0; j < nl; j++ )
+        {
+            ext[i*nl + j] = ext[4*nl + j];
+            ext[(len + 4 + i)*nl + j] = ext[(len + 3)*nl + j];
+        }
+}
+
+template<typename T, typename WT> class RecursiveGaussianRowInvoker
+{
+public:
+    RecursiveGaussianRowInvoker( const Mat& _src, Mat& _dst, double sigma, int _borderType ) :
+        src(_src), dst(_dst), k(sigma), borderType(_borderType)
+    {
+        pad = recursiveGaussianPad(sigma, borderType);
+        int len = src.cols + pad*2;
+        xofs.resize(len);
+        for( int i = 0; i < len; i++ )
+            xofs[i] = borderInterpolate(i - pad, src.cols, borderType);
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int cn = src.channels(), width = src.cols, len = width + pad*2;
+        int nrows = std::max((int)RGAUSS_BLOCK/cn, 1), nl0 = nrows*cn;
+        AutoBuffer<WT> _buf((len + 8 + width*2)*nl0);
+        AutoBuffer<double> _state(nl0*4);
+        WT *ext = _buf, *yp = ext + (len + 8)*nl0, *out = yp + width*nl0;
+        const int* ofs = &xofs[0];
+
+        for( int y0 = range.begin(); y0 < range.end(); y0 += nrows )
+        {
+            int r, n = std::min(nrows, range.end() - y0), nl = n*cn, i, c;
+            for( r = 0; r < n; r++ )
+            {
+                const T* S = (const T*)src.ptr(y0 + r);
+                WT* E = ext + nl*4 + r*cn;
+                for( i = 0; i < len; i++, E += nl )
+                {
+                    if( ofs[i] < 0 )
+                        for( c = 0; c < cn; c++ )
+                            E[c] = 0;
+                    else
+                        for( c = 0; c < cn; c++ )
+                            E[c] = (WT)S[ofs[i]*cn + c];
+                }
+            }
+            recursiveGaussianEnds( ext, len, nl );
+            recursiveGaussianLines( ext, len, nl, pad, width, k, yp, out, (double*)_state );
+
+            for( r = 0; r < n; r++ )
+            {
+                WT* D = (WT*)dst.ptr(y0 + r);
+                for( i = 0; i < width; i++ )
+                    for( c = 0; c < cn; c++ )
+                        D[i*cn + c] = out[i*nl + r*cn + c];
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    RecursiveGaussianCoeffs k;
+    int borderType, pad;
+    vector<int> xofs;
+};
+
+template<typename T, typename WT> class RecursiveGaussianColumnInvoker
+{
+public:
+    RecursiveGaussianColumnInvoker( const Mat& _src, Mat& _dst, double sigma, int _borderType ) :
+        src(_src), dst(_dst), k(sigma), borderType(_borderType)
+    {
+        pad = recursiveGaussianPad(sigma, borderType);
+    }
+
+    // range is in the blocks of RGAUSS_BLOCK columns of the single-channel view
+    void operator()( const BlockedRange& range ) const
+    {
+        int height = src.rows, width = src.cols*src.channels(), len = height + pad*2;
+        int nl0 = RGAUSS_BLOCK;
+        AutoBuffer<WT> _buf((len + 8 + height*2)*nl0);
+        AutoBuffer<double> _state(nl0*4);
+        WT *ext = _buf, *yp = ext + (len + 8)*nl0, *out = yp + height*nl0;
+
+        for( int b = range.begin(); b < range.end(); b++ )
+        {
+            int x0 = b*nl0, nl = std::min(nl0, width - x0), i, j;
+            for( i = 0; i < len; i++ )
+            {
+                int y = borderInterpolate(i - pad, height, borderType);
+                WT* E = ext + (i + 4)*nl;
+                if( y < 0 )
+                    for( j = 0; j < nl; j++ )
+                        E[j] = 0;
+                else
+                {
+                    const WT* S = (const WT*)src.ptr(y) + x0;
+                    for( j = 0; j < nl; j++ )
+                        E[j] = S[j];
+                }
+            }
+            recursiveGaussianEnds( ext, len, nl );
+            recursiveGaussianLines( ext, len, nl, pad, height, k, yp, out, (double*)_state );
+
+            for( i = 0; i < height; i++ )
+            {
+                T* D = (T*)dst.ptr(i) + x0;
+                for( j = 0; j < nl; j++ )
+                    D[j] = saturate_cast<T>(out[i*nl + j]);
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    RecursiveGaussianCoeffs k;
+    int borderType, pad;
+};
+
+template<typename T, typename WT> static void
+recursiveGaussianBlur_( const Mat& src, Mat& dst, double sigma1, double sigma2, int borderType )
+{
+    Mat buf(src.size(), CV_MAKETYPE(DataType<WT>::depth, src.channels()));
+    int width = src.cols*src.channels();
+    parallel_for( BlockedRange(0, src.rows, std::max((int)RGAUSS_BLOCK/src.channels(), 1)),
+                  RecursiveGaussianRowInvoker<T, WT>(src, buf, sigma1, borderType) );
+    parallel_for( BlockedRange(0, (width + RGAUSS_BLOCK - 1)/RGAUSS_BLOCK),
+                  RecursiveGaussianColumnInvoker<T, WT>(buf, dst, sigma2, borderType) );
+}
+
+static void recursiveGaussianBlur( const Mat& src, Mat& dst, double sigma1, double sigma2,
+                                   int borderType )
+{
+    int depth = src.depth();
+    if( depth == CV_8U )
+        recursiveGaussianBlur_<uchar, float>(src, dst, sigma1, sigma2, borderType);
+    else if( depth == CV_16U )
+        recursiveGaussianBlur_<ushort, float>(src, dst, sigma1, sigma2, borderType);
+    else if( depth == CV_16S )
+        recursiveGaussianBlur_<short, float>(src, dst, sigma1, sigma2, borderType);
+    else if( depth == CV_32F )
+        recursiveGaussianBlur_<float, float>(src, dst, sigma1, sigma2, borderType);
+    else if( depth == CV_64F )
+        recursiveGaussianBlur_<double, double>(src, dst, sigma1, sigma2, borderType);
+    else
+        CV_Error( CV_StsUnsupportedFormat, "" );
+}
+
+}
+
 void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
                    double sigma1, double sigma2,
                    int borderType )
 {
+    GaussianBlur( _src, _dst, ksize, sigma1, sigma2, borderType, GAUSSIAN_EXACT );
+}
+
+void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
+                   double sigma1, double sigma2,
+                   int borderType, int method )
+{
+    CV_TRACE_REGION("cv::GaussianBlur");
     Mat src = _src.getMat();
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
 
+    CV_Assert( method == GAUSSIAN_EXACT || method == GAUSSIAN_RECURSIVE );
+    if( method == GAUSSIAN_RECURSIVE )
+    {
+        // the sigmas are computed from ksize as in getGaussianKernel
+        double s1 = sigma1, s2 = sigma2 > 0 ? sigma2 : sigma1;
+        if( s1 <= 0 && ksize.width > 0 )
+            s1 = 0.3*((ksize.width - 1)*0.5 - 1) + 0.8;
+        if( s2 <= 0 && ksize.height > 0 )
+            s2 = 0.3*((ksize.height - 1)*0.5 - 1) + 0.8;
+
+        // below this sigma the recursive filter is not accurate, while the kernel is short
+        if( std::min(s1, s2) >= GAUSSIAN_RECURSIVE_MIN_SIGMA )
+        {
+            recursiveGaussianBlur( src, dst, s1, s2, borderType & ~BORDER_ISOLATED );
+            return;
+        }
+    }
+
     if( borderType != BORDER_CONSTANT )
     {
         if( src.rows == 1 )
@@ -442,8 +740,10 @@ void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
         return;
 #endif
 
-    Ptr<FilterEngine> f = createGaussianFilter( src.type(), ksize, sigma1, sigma2, borderType );
-    f->apply( src, dst );
+    vector<Ptr<FilterEngine> > f(getFilterStripes(src, dst));
+    for( size_t i = 0; i < f.size(); i++ )
+        f[i] = createGaussianFilter( src.type(), ksize, sigma1, sigma2, borderType );
+    applyFilterStripes( f, src, dst );
 }
 
 
@@ -1222,6 +1522,7 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
 
 void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
 {
+    CV_TRACE_REGION("cv::medianBlur");
     Mat src0 = _src0.getMat();
     _dst.create( src0.size(), src0.type() );
     Mat dst = _dst.getMat();
@@ -1288,13 +1589,85 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
 namespace cv
 {
 
+class BilateralFilter_8u_Invoker
+{
+public:
+    BilateralFilter_8u_Invoker( const Mat& _temp, Mat& _dst, int _radius, int _maxk,
+                                const int* _space_ofs, const float* _space_weight,
+                                const float* _color_weight ) :
+        temp(_temp), dst(_dst), radius(_radius), maxk(_maxk), space_ofs(_space_ofs),
+        space_weight(_space_weight), color_weight(_color_weight)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int i, j, k, cn = dst.channels();
+        Size size = dst.size();
+
+        for( i = range.begin(); i < range.end(); i++ )
+        {
+            const uchar* sptr = temp.data + (i+radius)*temp.step + radius*cn;
+            uchar* dptr = dst.data + i*dst.step;
+
+            if( cn == 1 )
+            {
+                for( j = 0; j < size.width; j++ )
+                {
+                    float sum = 0, wsum = 0;
+                    int val0 = sptr[j];
+                    for( k = 0; k < maxk; k++ )
+                    {
+                        int val = sptr[j + space_ofs[k]];
+                        float w = space_weight[k]*color_weight[std::abs(val - val0)];
+                        sum += val*w;
+                        wsum += w;
+                    }
+                    // overflow is not possible here => there is no need to use CV_CAST_8U
+                    dptr[j] = (uchar)cvRound(sum/wsum);
+                }
+            }
+            else
+            {
+                assert( cn == 3 );
+                for( j = 0; j < size.width*3; j += 3 )
+                {
+                    float sum_b = 0, sum_g = 0, sum_r = 0, wsum = 0;
+                    int b0 = sptr[j], g0 = sptr[j+1], r0 = sptr[j+2];
+                    for( k = 0; k < maxk; k++ )
+                    {
+                        const uchar* sptr_k = sptr + j + space_ofs[k];
+                        int b = sptr_k[0], g = sptr_k[1], r = sptr_k[2];
+                        float w = space_weight[k]*color_weight[std::abs(b - b0) +
+                            std::abs(g - g0) + std::abs(r - r0)];
+                        sum_b += b*w; sum_g += g*w; sum_r += r*w;
+                        wsum += w;
+                    }
+                    wsum = 1.f/wsum;
+                    b0 = cvRound(sum_b*wsum);
+                    g0 = cvRound(sum_g*wsum);
+                    r0 = cvRound(sum_r*wsum);
+                    dptr[j] = (uchar)b0; dptr[j+1] = (uchar)g0; dptr[j+2] = (uchar)r0;
+                }
+            }
+        }
+    }
+
+private:
+    Mat temp;
+    Mat dst;
+    int radius, maxk;
+    const int* space_ofs;
+    const float *space_weight, *color_weight;
+};
+
 static void
 bilateralFilter_8u( const Mat& src, Mat& dst, int d,
                     double sigma_color, double sigma_space,
                     int borderType )
 {
     int cn = src.channels();
-    int i, j, k, maxk, radius;
+    int i, j, maxk, radius;
     Size size = src.size();
 
     CV_Assert( (src.type() == CV_8UC1 || src.type() == CV_8UC3) &&
@@ -1341,54 +1714,89 @@ bilateralFilter_8u( const Mat& src, Mat& dst, int d,
             space_ofs[maxk++] = (int)(i*temp.step + j*cn);
         }
 
-    for( i = 0; i < size.height; i++ )
+    parallel_for( BlockedRange(0, size.height),
+                  BilateralFilter_8u_Invoker(temp, dst, radius, maxk, space_ofs,
+                                             space_weight, color_weight) );
+}
+
+
+class BilateralFilter_32f_Invoker
+{
+public:
+    BilateralFilter_32f_Invoker( const Mat& _temp, Mat& _dst, int _radius, int _maxk,
+                                 const int* _space_ofs, const float* _space_weight,
+                                 const float* _expLUT, float _scale_index ) :
+        temp(_temp), dst(_dst), radius(_radius), maxk(_maxk), space_ofs(_space_ofs),
+        space_weight(_space_weight), expLUT(_expLUT), scale_index(_scale_index)
     {
-        const uchar* sptr = temp.data + (i+radius)*temp.step + radius*cn;
-        uchar* dptr = dst.data + i*dst.step;
+    }
 
-        if( cn == 1 )
+    void operator()( const BlockedRange& range ) const
+    {
+        int i, j, k, cn = dst.channels();
+        Size size = dst.size();
+
+        for( i = range.begin(); i < range.end(); i++ )
         {
-            for( j = 0; j < size.width; j++ )
+            const float* sptr = (const float*)(temp.data + (i+radius)*temp.step) + radius*cn;
+            float* dptr = (float*)(dst.data + i*dst.step);
+
+            if( cn == 1 )
             {
-                float sum = 0, wsum = 0;
-                int val0 = sptr[j];
-                for( k = 0; k < maxk; k++ )
+                for( j = 0; j < size.width; j++ )
                 {
-                    int val = sptr[j + space_ofs[k]];
-                    float w = space_weight[k]*color_weight[std::abs(val - val0)];
-                    sum += val*w;
-                    wsum += w;
+                    float sum = 0, wsum = 0;
+                    float val0 = sptr[j];
+                    for( k = 0; k < maxk; k++ )
+                    {
+                        float val = sptr[j + space_ofs[k]];
+                        float alpha = (float)(std::abs(val - val0)*scale_index);
+                        int idx = cvFloor(alpha);
+                        alpha -= idx;
+                        float w = space_weight[k]*(expLUT[idx] + alpha*(expLUT[idx+1] - expLUT[idx]));
+                        sum += val*w;
+                        wsum += w;
+                    }
+                    dptr[j] = (float)(sum/wsum);
                 }
-                // overflow is not possible here => there is no need to use CV_CAST_8U
-                dptr[j] = (uchar)cvRound(sum/wsum);
             }
-        }
-        else
-        {
-            assert( cn == 3 );
-            for( j = 0; j < size.width*3; j += 3 )
+            else
             {
-                float sum_b = 0, sum_g = 0, sum_r = 0, wsum = 0;
-                int b0 = sptr[j], g0 = sptr[j+1], r0 = sptr[j+2];
-                for( k = 0; k < maxk; k++ )
+                assert( cn == 3 );
+                for( j = 0; j < size.width*3; j += 3 )
                 {
-                    const uchar* sptr_k = sptr + j + space_ofs[k];
-                    int b = sptr_k[0], g = sptr_k[1], r = sptr_k[2];
-                    float w = space_weight[k]*color_weight[std::abs(b - b0) +
-                        std::abs(g - g0) + std::abs(r - r0)];
-                    sum_b += b*w; sum_g += g*w; sum_r += r*w;
-                    wsum += w;
+                    float sum_b = 0, sum_g = 0, sum_r = 0, wsum = 0;
+                    float b0 = sptr[j], g0 = sptr[j+1], r0 = sptr[j+2];
+                    for( k = 0; k < maxk; k++ )
+                    {
+                        const float* sptr_k = sptr + j + space_ofs[k];
+                        float b = sptr_k[0], g = sptr_k[1], r = sptr_k[2];
+                        float alpha = (float)((std::abs(b - b0) +
+                            std::abs(g - g0) + std::abs(r - r0))*scale_index);
+                        int idx = cvFloor(alpha);
+                        alpha -= idx;
+                        float w = space_weight[k]*(expLUT[idx] + alpha*(expLUT[idx+1] - expLUT[idx]));
+                        sum_b += b*w; sum_g += g*w; sum_r += r*w;
+                        wsum += w;
+                    }
+                    wsum = 1.f/wsum;
+                    b0 = sum_b*wsum;
+                    g0 = sum_g*wsum;
+                    r0 = sum_r*wsum;
+                    dptr[j] = b0; dptr[j+1] = g0; dptr[j+2] = r0;
                 }
-                wsum = 1.f/wsum;
-                b0 = cvRound(sum_b*wsum);
-                g0 = cvRound(sum_g*wsum);
-                r0 = cvRound(sum_r*wsum);
-                dptr[j] = (uchar)b0; dptr[j+1] = (uchar)g0; dptr[j+2] = (uchar)r0;
             }
         }
     }
-}
 
+private:
+    Mat temp;
+    Mat dst;
+    int radius, maxk;
+    const int* space_ofs;
+    const float *space_weight, *expLUT;
+    float scale_index;
+};
 
 static void
 bilateralFilter_32f( const Mat& src, Mat& dst, int d,
@@ -1396,7 +1804,7 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
                      int borderType )
 {
     int cn = src.channels();
-    int i, j, k, maxk, radius;
+    int i, j, maxk, radius;
     double minValSrc=-1, maxValSrc=1;
     const int kExpNumBinsPerChannel = 1 << 12;
     int kExpNumBins = 0;
@@ -1469,57 +1877,340 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
             space_ofs[maxk++] = (int)(i*(temp.step/sizeof(float)) + j*cn);
         }
 
-    for( i = 0; i < size.height; i++ )
+    parallel_for( BlockedRange(0, size.height),
+                  BilateralFilter_32f_Invoker(temp, dst, radius, maxk, space_ofs,
+                                              space_weight, expLUT, scale_index) );
+}
+
+/*
+   The bilateral grid (S. Paris, F. Durand, "A Fast Approximation of the Bilateral Filter
+   using a Signal Processing Approach", ECCV 2006; J. Chen, S. Paris, F. Durand, "Real-time
+   Edge-Aware Image Processing with the Bilateral Grid", SIGGRAPH 2007). The pixels are
+   accumulated as (values, weight) tuples into the 3D grid of (y, x, guide) with the steps of
+   sigmaSpace and sigmaColor. The guide is the pixel value of a single-channel image and the sum
+   of the channels of a 3-channel one, so all the channels are averaged with the same weights
+   (the joint, or cross, bilateral grid). The grid is smoothed by the separable Gaussian, and
+   the result is read back at each pixel by the trilinear interpolation and divided by the
+   interpolated weight. The cost per pixel does not depend on sigmaSpace.
+
+   The pixels are accumulated into the nearest spatial cell, so that the grid rows can be
+   filled in parallel, and linearly into the 2 nearest guide cells. The blur sigmas (in cells)
+   are reduced by the variance that the accumulation and the interpolation add, so that
+   the overall kernel is close to the Gaussian with the requested sigmas. The grid is stored
+   as a matrix with a row per grid row, and it has a margin of zero cells around it,
+   so the blur needs no border checks.
+*/
+
+enum { BILATERAL_GRID_MAX_CELLS = 2 };
+// below this sigmaSpace the exact filter is faster
+static const double BILATERAL_GRID_MIN_SIGMA = 4.;
+
+struct BilateralGrid
+{
+    BilateralGrid( Size imgsize, int cn, double _sspace, double _scolor, int nvalues )
     {
-        const float* sptr = (const float*)(temp.data + (i+radius)*temp.step) + radius*cn;
-        float* dptr = (float*)(dst.data + i*dst.step);
+        sspace = _sspace; scolor = _scolor;
+        // the spatial blur compensates for the nearest (1/12) accumulation and
+        // the linear (1/6) interpolation, the guide one - for the linear ones (1/6 + 1/6)
+        double bspace = std::sqrt(1. - 1./12 - 1./6), bcolor = std::sqrt(1. - 1./6 - 1./6);
+        radius = cvCeil(std::max(bspace, bcolor)*3);
+        border = radius + 1;
+        createKernel(kspace, bspace, radius);
+        createKernel(kcolor, bcolor, radius);
+        size[0] = cvRound((imgsize.height - 1)/sspace) + 2 + border*2;
+        size[1] = cvRound((imgsize.width - 1)/sspace) + 2 + border*2;
+        size[2] = nvalues + 2 + border*2;
+        nc = cn + 1;
+    }
 
-        if( cn == 1 )
+    static void createKernel( vector<float>& kernel, double sigma, int radius )
+    {
+        kernel.resize(radius*2 + 1);
+        double sum = 0;
+        for( int i = -radius; i <= radius; i++ )
+            sum += std::exp(-0.5*i*i/(sigma*sigma));
+        for( int i = -radius; i <= radius; i++ )
+            kernel[i + radius] = (float)(std::exp(-0.5*i*i/(sigma*sigma))/sum);
+    }
+
+    size_t total() const { return (size_t)size[0]*size[1]*size[2]; }
+
+    double sspace, scolor;
+    // nc is the number of floats per cell: the channel sums and the weight
+    int radius, border, size[3], nc;
+    vector<float> kspace, kcolor;
+};
+
+// computes the guide (the sum of the channels) of the src rows range
+template<typename T> class BilateralGridGuideInvoker
+{
+public:
+    BilateralGridGuideInvoker( const Mat& _src, Mat& _guide ) : src(_src), guide(_guide) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int cn = src.channels(), width = src.cols;
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            const T* S = src.ptr<T>(y);
+            float* G = (float*)guide.ptr(y);
+            if( cn == 1 )
+                for( int x = 0; x < width; x++ )
+                    G[x] = (float)S[x];
+            else
+                for( int x = 0; x < width; x++, S += 3 )
+                    G[x] = (float)S[0] + (float)S[1] + (float)S[2];
+        }
+    }
+
+private:
+    Mat src;
+    Mat guide;
+};
+
+// accumulates src into the grid rows range
+template<typename T> class BilateralGridSplatInvoker
+{
+public:
+    BilateralGridSplatInvoker( const Mat& _src, const Mat& _guide, float _minval,
+                               const BilateralGrid& _g, Mat& _grid ) :
+        src(_src), guide(_guide), minval(_minval), g(_g), grid(_grid)
+    {
+        xofs.resize(src.cols);
+        for( int x = 0; x < src.cols; x++ )
+            xofs[x] = ((cvRound(x/g.sspace) + g.border)*g.size[2] + g.border)*g.nc;
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int cn = src.channels(), nc = g.nc, width = src.cols, x, y, k;
+        float iscale = (float)(1./g.scolor);
+        const int* xtab = &xofs[0];
+
+        for( int gy = range.begin(); gy < range.end(); gy++ )
         {
-            for( j = 0; j < size.width; j++ )
+            // the source rows, which have gy as the nearest grid row
+            int y0 = std::max(cvFloor((gy - g.border - 0.5)*g.sspace), 0);
+            int y1 = std::min(cvCeil((gy - g.border + 0.5)*g.sspace) + 1, src.rows);
+            float* G = (float*)grid.ptr(gy);
+            for( y = y0; y < y1; y++ )
             {
-                float sum = 0, wsum = 0;
-                float val0 = sptr[j];
-                for( k = 0; k < maxk; k++ )
+                if( cvRound(y/g.sspace) + g.border != gy )
+                    continue;
+                const T* S = src.ptr<T>(y);
+                const float* Z = guide.ptr<float>(y);
+                for( x = 0; x < width; x++, S += cn )
                 {
-                    float val = sptr[j + space_ofs[k]];
-                    float alpha = (float)(std::abs(val - val0)*scale_index);
-                    int idx = cvFloor(alpha);
-                    alpha -= idx;
-                    float w = space_weight[k]*(expLUT[idx] + alpha*(expLUT[idx+1] - expLUT[idx]));
-                    sum += val*w;
-                    wsum += w;
+                    float z = (Z[x] - minval)*iscale;
+                    int iz = cvFloor(z);
+                    float w = z - iz;
+                    float* cell = G + xtab[x] + iz*nc;
+                    for( k = 0; k < cn; k++ )
+                    {
+                        float v = (float)S[k];
+                        cell[k] += v - v*w;
+                        cell[k + nc] += v*w;
+                    }
+                    cell[cn] += 1 - w;
+                    cell[cn + nc] += w;
                 }
-                dptr[j] = (float)(sum/wsum);
             }
         }
-        else
+    }
+
+private:
+    Mat src;
+    Mat guide;
+    float minval;
+    const BilateralGrid& g;
+    Mat grid;
+    vector<int> xofs;
+};
+
+/*
+   convolves the grid along the dimension dim (0 - rows, 1 - columns, 2 - guide values) and
+   stores the cells inside the margin of the grid rows range to dst
+*/
+class BilateralGridBlurInvoker
+{
+public:
+    BilateralGridBlurInvoker( const Mat& _src, Mat& _dst, int _dim, const BilateralGrid& _g ) :
+        src(_src), dst(_dst), dim(_dim), g(_g)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        const float* kx = dim == 2 ? &g.kcolor[0] : &g.kspace[0];
+        int r = g.radius, ksize = r*2 + 1, b = g.border, nc = g.nc, i, j, k, l;
+
+        for( int gy = range.begin(); gy < range.end(); gy++ )
         {
-            assert( cn == 3 );
-            for( j = 0; j < size.width*3; j += 3 )
+            float* D = (float*)dst.ptr(gy);
+            if( dim == 0 )
             {
-                float sum_b = 0, sum_g = 0, sum_r = 0, wsum = 0;
-                float b0 = sptr[j], g0 = sptr[j+1], r0 = sptr[j+2];
-                for( k = 0; k < maxk; k++ )
+                int rowlen = g.size[1]*g.size[2]*nc;
+                const float* S = src.ptr<float>(gy - r);
+                for( j = 0; j < rowlen; j++ )
+                    D[j] = kx[0]*S[j];
+                for( k = 1; k < ksize; k++ )
                 {
-                    const float* sptr_k = sptr + j + space_ofs[k];
-                    float b = sptr_k[0], g = sptr_k[1], r = sptr_k[2];
-                    float alpha = (float)((std::abs(b - b0) +
-                        std::abs(g - g0) + std::abs(r - r0))*scale_index);
-                    int idx = cvFloor(alpha);
-                    alpha -= idx;
-                    float w = space_weight[k]*(expLUT[idx] + alpha*(expLUT[idx+1] - expLUT[idx]));
-                    sum_b += b*w; sum_g += g*w; sum_r += r*w;
-                    wsum += w;
+                    S = src.ptr<float>(gy - r + k);
+                    for( j = 0; j < rowlen; j++ )
+                        D[j] += kx[k]*S[j];
                 }
-                wsum = 1.f/wsum;
-                b0 = sum_b*wsum;
-                g0 = sum_g*wsum;
-                r0 = sum_r*wsum;
-                dptr[j] = b0; dptr[j+1] = g0; dptr[j+2] = r0;
+                continue;
             }
+
+            // the lines along x (one per guide value) or along the guide values (one per x)
+            int step = dim == 1 ? g.size[2]*nc : nc, lstep = dim == 1 ? nc : g.size[2]*nc;
+            int len = g.size[dim], nlines = g.size[3 - dim];
+            for( i = b; i < nlines - b; i++ )
+            {
+                const float* S = src.ptr<float>(gy) + i*lstep;
+                float* Dl = D + i*lstep;
+                for( j = b; j < len - b; j++ )
+                {
+                    const float* Sj = S + (j - r)*step;
+                    float s[4] = { 0, 0, 0, 0 };
+                    for( k = 0; k < ksize; k++, Sj += step )
+                        for( l = 0; l < nc; l++ )
+                            s[l] += kx[k]*Sj[l];
+                    for( l = 0; l < nc; l++ )
+                        Dl[j*step + l] = s[l];
+                }
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int dim;
+    const BilateralGrid& g;
+};
+
+// interpolates the grid at the pixels and stores the result to dst
+template<typename T> class BilateralGridSliceInvoker
+{
+public:
+    BilateralGridSliceInvoker( const Mat& _src, const Mat& _guide, Mat& _dst, int _pad, float _minval,
+                               const BilateralGrid& _g, const Mat& _grid ) :
+        src(_src), guide(_guide), dst(_dst), pad(_pad), minval(_minval), g(_g), grid(_grid)
+    {
+        xofs.resize(dst.cols);
+        xalpha.resize(dst.cols);
+        for( int x = 0; x < dst.cols; x++ )
+        {
+            double fx = (x + pad)/g.sspace;
+            int ix = cvFloor(fx);
+            xofs[x] = ((ix + g.border)*g.size[2] + g.border)*g.nc;
+            xalpha[x] = (float)(fx - ix);
         }
     }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int cn = dst.channels(), nc = g.nc, width = dst.cols, xstep = g.size[2]*nc, x, k;
+        float iscale = (float)(1./g.scolor);
+        const int* xtab = &xofs[0];
+        const float* atab = &xalpha[0];
+
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            double fy = (y + pad)/g.sspace;
+            int iy = cvFloor(fy);
+            float ay = (float)(fy - iy);
+            const float* G0 = grid.ptr<float>(iy + g.border);
+            const float* G1 = grid.ptr<float>(iy + g.border + 1);
+            const T* S = src.ptr<T>(y + pad) + pad*cn;
+            const float* Z = guide.ptr<float>(y + pad) + pad;
+            T* D = (T*)dst.ptr(y);
+
+            for( x = 0; x < width; x++, S += cn, D += cn )
+            {
+                float z = (Z[x] - minval)*iscale;
+                int iz = cvFloor(z);
+                float az = z - iz, ax = atab[x];
+                int ofs = xtab[x] + iz*nc;
+                const float *c00 = G0 + ofs, *c01 = c00 + xstep;
+                const float *c10 = G1 + ofs, *c11 = c10 + xstep;
+                // the weights of the 8 cells around the pixel: the lower guide cell, then the upper one
+                float w00 = (1 - ay)*(1 - ax), w01 = (1 - ay)*ax, w10 = ay*(1 - ax), w11 = ay*ax;
+                float v[4];
+                for( k = 0; k <= cn; k++ )
+                {
+                    float v0 = w00*c00[k] + w01*c01[k] + w10*c10[k] + w11*c11[k];
+                    float v1 = w00*c00[k + nc] + w01*c01[k + nc] + w10*c10[k + nc] + w11*c11[k + nc];
+                    v[k] = v0 + az*(v1 - v0);
+                }
+                float n = v[cn];
+                if( n > FLT_EPSILON )
+                {
+                    float scale = 1.f/n;
+                    for( k = 0; k < cn; k++ )
+                        D[k] = saturate_cast<T>(v[k]*scale);
+                }
+                else
+                    for( k = 0; k < cn; k++ )
+                        D[k] = S[k];
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat guide;
+    Mat dst;
+    int pad;
+    float minval;
+    const BilateralGrid& g;
+    Mat grid;
+    vector<int> xofs;
+    vector<float> xalpha;
+};
+
+/*
+   filters src with the joint bilateral grid, splatted and sliced once for all the channels.
+   Returns false (and does nothing) if sigma_space is too small or the grid would have more
+   than BILATERAL_GRID_MAX_CELLS cells per pixel
+*/
+template<typename T> static bool
+bilateralGridFilter_( const Mat& src, Mat& dst, double sigma_color, double sigma_space,
+                      int borderType )
+{
+    if( sigma_space < BILATERAL_GRID_MIN_SIGMA )
+        return false;
+
+    int pad = cvCeil(sigma_space*3);
+    double minval = 0, maxval = 0;
+    Mat temp;
+
+    copyMakeBorder( src, temp, pad, pad, pad, pad, borderType );
+    if( src.depth() == CV_32F )
+        patchNaNs(temp);
+    // the exact filter takes the sum of the channel differences as the color distance,
+    // which the difference of the channel sums approximates, so sigma_color is kept as is
+    Mat guide(temp.size(), CV_32F);
+    parallel_for( BlockedRange(0, temp.rows), BilateralGridGuideInvoker<T>(temp, guide) );
+    minMaxLoc( guide, &minval, &maxval );
+    if( (maxval - minval)/sigma_color > (double)src.total()*BILATERAL_GRID_MAX_CELLS )
+        return false;
+
+    BilateralGrid g(temp.size(), src.channels(), sigma_space, sigma_color,
+                    cvCeil((maxval - minval)/sigma_color));
+    if( g.total() > src.total()*BILATERAL_GRID_MAX_CELLS )
+        return false;
+
+    Mat grid = Mat::zeros(g.size[0], g.size[1]*g.size[2]*g.nc, CV_32F), buf = Mat::zeros(grid.size(), CV_32F);
+    BlockedRange inner(g.border, g.size[0] - g.border);
+    parallel_for( inner, BilateralGridSplatInvoker<T>(temp, guide, (float)minval, g, grid) );
+    parallel_for( inner, BilateralGridBlurInvoker(grid, buf, 2, g) );
+    parallel_for( inner, BilateralGridBlurInvoker(buf, grid, 1, g) );
+    parallel_for( inner, BilateralGridBlurInvoker(grid, buf, 0, g) );
+    parallel_for( BlockedRange(0, src.rows),
+                  BilateralGridSliceInvoker<T>(temp, guide, dst, pad, (float)minval, g, buf) );
+    return true;
 }
 
 }
@@ -1528,10 +2219,30 @@ void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
                       double sigmaColor, double sigmaSpace,
                       int borderType )
 {
+    bilateralFilter( _src, _dst, d, sigmaColor, sigmaSpace, borderType, BILATERAL_EXACT );
+}
+
+void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
+                      double sigmaColor, double sigmaSpace,
+                      int borderType, int method )
+{
+    CV_TRACE_REGION("cv::bilateralFilter");
     Mat src = _src.getMat();
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
 
+    CV_Assert( method == BILATERAL_EXACT || method == BILATERAL_GRID );
+    if( method == BILATERAL_GRID )
+    {
+        CV_Assert( (src.type() == CV_8UC1 || src.type() == CV_8UC3 ||
+                    src.type() == CV_32FC1 || src.type() == CV_32FC3) && src.data != dst.data );
+        double sc = sigmaColor > 0 ? sigmaColor : 1, ss = sigmaSpace > 0 ? sigmaSpace : 1;
+        // for the small sigmas the grid is too large, and the exact filter is used
+        if( src.depth() == CV_8U ? bilateralGridFilter_<uchar>( src, dst, sc, ss, borderType ) :
+                                   bilateralGridFilter_<float>( src, dst, sc, ss, borderType ) )
+            return;
+    }
+
     if( src.depth() == CV_8U )
         bilateralFilter_8u( src, dst, d, sigmaColor, sigmaSpace, borderType );
     else if( src.depth() == CV_32F )
@@ -233,6 +233,7 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
 
 void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result, int method )
 {
+    CV_TRACE_REGION("cv::matchTemplate");
     CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
     
     int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
@@ -41,14 +41,49 @@
 //M*/
 
 #include "precomp.hpp"
+#include "thresh_simd.hpp"
 
 namespace cv
 {
 
+// the vectorized part of a threshold() row: the AVX2 kernel of thresh_avx2.cpp
+// when the CPU supports it, otherwise the thresh_simd.hpp one.
+// Returns the number of processed elements
+template<typename T> struct ThreshVec
+{
+    ThreshVec(T _thresh, T _maxval) : thresh(_thresh), maxval(_maxval)
+    {
+        useAVX2 = false;
+    #if CV_TRY_AVX2 && !CV_SIMD_AVX2
+        useAVX2 = checkHardwareSupport(CV_CPU_AVX2);
+    #endif
+        useSIMD = checkSIMDSupport();
+    }
+
+    int operator()(const T* src, T* dst, int width, int type) const
+    {
+        int j = 0;
+    #if CV_TRY_AVX2 && !CV_SIMD_AVX2
+        if( useAVX2 )
+            return avx2::threshRow(src, dst, width, type, thresh, maxval);
+    #endif
+    #if CV_SIMD
+        if( useSIMD )
+            j = threshRow_SIMD(src, dst, width, type, thresh, maxval);
+    #else
+        (void)src; (void)dst; (void)width; (void)type;
+    #endif
+        return j;
+    }
+
+    T thresh, maxval;
+    bool useAVX2, useSIMD;
+};
+
 static void
 thresh_8u( const Mat& _src, Mat& _dst, uchar thresh, uchar maxval, int type )
 {
-    int i, j, j_scalar = 0;
+    int i, j;
     uchar tab[256];
     Size roi = _src.size();
     roi.width *= _src.channels();
@@ -100,158 +135,32 @@ thresh_8u( const Mat& _src, Mat& _dst, uchar thresh, uchar maxval, int type )
         CV_Error( CV_StsBadArg, "Unknown threshold type" );
     }
 
-#if CV_SSE2
-    if( checkHardwareSupport(CV_CPU_SSE2) )
+    ThreshVec<uchar> vecOp(thresh, maxval);
+
+    for( i = 0; i < roi.height; i++ )
     {
-        __m128i _x80 = _mm_set1_epi8('\x80');
-        __m128i thresh_u = _mm_set1_epi8(thresh);
-        __m128i thresh_s = _mm_set1_epi8(thresh ^ 0x80);
-        __m128i maxval_ = _mm_set1_epi8(maxval);
-        j_scalar = roi.width & -8;
+        const uchar* src = (const uchar*)(_src.data + _src.step*i);
+        uchar* dst = (uchar*)(_dst.data + _dst.step*i);
+        j = vecOp(src, dst, roi.width, type);
 
-        for( i = 0; i < roi.height; i++ )
+#if CV_ENABLE_UNROLLED
+        for( ; j <= roi.width - 4; j += 4 )
         {
-            const uchar* src = (const uchar*)(_src.data + _src.step*i);
-            uchar* dst = (uchar*)(_dst.data + _dst.step*i);
-
-            switch( type )
-            {
-            case THRESH_BINARY:
-                for( j = 0; j <= roi.width - 32; j += 32 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 16) );
-                    v0 = _mm_cmpgt_epi8( _mm_xor_si128(v0, _x80), thresh_s );
-                    v1 = _mm_cmpgt_epi8( _mm_xor_si128(v1, _x80), thresh_s );
-                    v0 = _mm_and_si128( v0, maxval_ );
-                    v1 = _mm_and_si128( v1, maxval_ );
-                    _mm_storeu_si128( (__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128( (__m128i*)(dst + j + 16), v1 );
-                }
-
-                for( ; j <= roi.width - 8; j += 8 )
-                {
-                    __m128i v0 = _mm_loadl_epi64( (const __m128i*)(src + j) );
-                    v0 = _mm_cmpgt_epi8( _mm_xor_si128(v0, _x80), thresh_s );
-                    v0 = _mm_and_si128( v0, maxval_ );
-                    _mm_storel_epi64( (__m128i*)(dst + j), v0 );
-                }
-                break;
-
-            case THRESH_BINARY_INV:
-                for( j = 0; j <= roi.width - 32; j += 32 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 16) );
-                    v0 = _mm_cmpgt_epi8( _mm_xor_si128(v0, _x80), thresh_s );
-                    v1 = _mm_cmpgt_epi8( _mm_xor_si128(v1, _x80), thresh_s );
-                    v0 = _mm_andnot_si128( v0, maxval_ );
-                    v1 = _mm_andnot_si128( v1, maxval_ );
-                    _mm_storeu_si128( (__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128( (__m128i*)(dst + j + 16), v1 );
-                }
-
-                for( ; j <= roi.width - 8; j += 8 )
-                {
-                    __m128i v0 = _mm_loadl_epi64( (const __m128i*)(src + j) );
-                    v0 = _mm_cmpgt_epi8( _mm_xor_si128(v0, _x80), thresh_s );
-                    v0 = _mm_andnot_si128( v0, maxval_ );
-                    _mm_storel_epi64( (__m128i*)(dst + j), v0 );
-                }
-                break;
-
-            case THRESH_TRUNC:
-                for( j = 0; j <= roi.width - 32; j += 32 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 16) );
-                    v0 = _mm_subs_epu8( v0, _mm_subs_epu8( v0, thresh_u ));
-                    v1 = _mm_subs_epu8( v1, _mm_subs_epu8( v1, thresh_u ));
-                    _mm_storeu_si128( (__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128( (__m128i*)(dst + j + 16), v1 );
-                }
-
-                for( ; j <= roi.width - 8; j += 8 )
-                {
-                    __m128i v0 = _mm_loadl_epi64( (const __m128i*)(src + j) );
-                    v0 = _mm_subs_epu8( v0, _mm_subs_epu8( v0, thresh_u ));
-                    _mm_storel_epi64( (__m128i*)(dst + j), v0 );
-                }
-                break;
-
-            case THRESH_TOZERO:
-                for( j = 0; j <= roi.width - 32; j += 32 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 16) );
-                    v0 = _mm_and_si128( v0, _mm_cmpgt_epi8(_mm_xor_si128(v0, _x80), thresh_s ));
-                    v1 = _mm_and_si128( v1, _mm_cmpgt_epi8(_mm_xor_si128(v1, _x80), thresh_s ));
-                    _mm_storeu_si128( (__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128( (__m128i*)(dst + j + 16), v1 );
-                }
+            uchar t0 = tab[src[j]];
+            uchar t1 = tab[src[j+1]];
 
-                for( ; j <= roi.width - 8; j += 8 )
-                {
-                    __m128i v0 = _mm_loadl_epi64( (const __m128i*)(src + j) );
-                    v0 = _mm_and_si128( v0, _mm_cmpgt_epi8(_mm_xor_si128(v0, _x80), thresh_s ));
-                    _mm_storel_epi64( (__m128i*)(dst + j), v0 );
-                }
-                break;
+            dst[j] = t0;
+            dst[j+1] = t1;
 
-            case THRESH_TOZERO_INV:
-                for( j = 0; j <= roi.width - 32; j += 32 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 16) );
-                    v0 = _mm_andnot_si128( _mm_cmpgt_epi8(_mm_xor_si128(v0, _x80), thresh_s ), v0 );
-                    v1 = _mm_andnot_si128( _mm_cmpgt_epi8(_mm_xor_si128(v1, _x80), thresh_s ), v1 );
-                    _mm_storeu_si128( (__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128( (__m128i*)(dst + j + 16), v1 );
-                }
+            t0 = tab[src[j+2]];
+            t1 = tab[src[j+3]];
 
-                for( ; j <= roi.width - 8; j += 8 )
-                {
-                    __m128i v0 = _mm_loadl_epi64( (const __m128i*)(src + j) );
-                    v0 = _mm_andnot_si128( _mm_cmpgt_epi8(_mm_xor_si128(v0, _x80), thresh_s ), v0 );
-                    _mm_storel_epi64( (__m128i*)(dst + j), v0 );
-                }
-                break;
-            }
+            dst[j+2] = t0;
+            dst[j+3] = t1;
         }
-    }
-#endif
-
-    if( j_scalar < roi.width )
-    {
-        for( i = 0; i < roi.height; i++ )
-        {
-            const uchar* src = (const uchar*)(_src.data + _src.step*i);
-            uchar* dst = (uchar*)(_dst.data + _dst.step*i);
-            j = j_scalar;
-#if CV_ENABLE_UNROLLED
-            for( ; j <= roi.width - 4; j += 4 )
-            {
-                uchar t0 = tab[src[j]];
-                uchar t1 = tab[src[j+1]];
-
-                dst[j] = t0;
-                dst[j+1] = t1;
-
-                t0 = tab[src[j+2]];
-                t1 = tab[src[j+3]];
-
-                dst[j+2] = t0;
-                dst[j+3] = t1;
-            }
 #endif
-            for( ; j < roi.width; j++ )
-                dst[j] = tab[src[j]];
-        }
+        for( ; j < roi.width; j++ )
+            dst[j] = tab[src[j]];
     }
 }
 
@@ -267,9 +176,7 @@ thresh_16s( const Mat& _src, Mat& _dst, short thresh, short maxval, int type )
     size_t src_step = _src.step/sizeof(src[0]);
     size_t dst_step = _dst.step/sizeof(dst[0]);
 
-#if CV_SSE2
-    volatile bool useSIMD = checkHardwareSupport(CV_CPU_SSE);
-#endif
+    ThreshVec<short> vecOp(thresh, maxval);
 
     if( _src.isContinuous() && _dst.isContinuous() )
     {
@@ -287,25 +194,7 @@ thresh_16s( const Mat& _src, Mat& _dst, short thresh, short maxval, int type )
     case THRESH_BINARY:
         for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
         {
-            j = 0;
-        #if CV_SSE2
-            if( useSIMD )
-            {
-                __m128i thresh8 = _mm_set1_epi16(thresh), maxval8 = _mm_set1_epi16(maxval);
-                for( ; j <= roi.width - 16; j += 16 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 8) );
-                    v0 = _mm_cmpgt_epi16( v0, thresh8 );
-                    v1 = _mm_cmpgt_epi16( v1, thresh8 );
-                    v0 = _mm_and_si128( v0, maxval8 );
-                    v1 = _mm_and_si128( v1, maxval8 );
-                    _mm_storeu_si128((__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128((__m128i*)(dst + j + 8), v1 );
-                }
-            }
-        #endif
+            j = vecOp(src, dst, roi.width, THRESH_BINARY);
 
             for( ; j < roi.width; j++ )
                 dst[j] = src[j] > thresh ? maxval : 0;
@@ -315,25 +204,7 @@ thresh_16s( const Mat& _src, Mat& _dst, short thresh, short maxval, int type )
     case THRESH_BINARY_INV:
         for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
         {
-            j = 0;
-        #if CV_SSE2
-            if( useSIMD )
-            {
-                __m128i thresh8 = _mm_set1_epi16(thresh), maxval8 = _mm_set1_epi16(maxval);
-                for( ; j <= roi.width - 16; j += 16 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 8) );
-                    v0 = _mm_cmpgt_epi16( v0, thresh8 );
-                    v1 = _mm_cmpgt_epi16( v1, thresh8 );
-                    v0 = _mm_andnot_si128( v0, maxval8 );
-                    v1 = _mm_andnot_si128( v1, maxval8 );
-                    _mm_storeu_si128((__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128((__m128i*)(dst + j + 8), v1 );
-                }
-            }
-        #endif
+            j = vecOp(src, dst, roi.width, THRESH_BINARY_INV);
 
             for( ; j < roi.width; j++ )
                 dst[j] = src[j] <= thresh ? maxval : 0;
@@ -343,23 +214,7 @@ thresh_16s( const Mat& _src, Mat& _dst, short thresh, short maxval, int type )
     case THRESH_TRUNC:
         for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
         {
-            j = 0;
-        #if CV_SSE2
-            if( useSIMD )
-            {
-                __m128i thresh8 = _mm_set1_epi16(thresh);
-                for( ; j <= roi.width - 16; j += 16 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 8) );
-                    v0 = _mm_min_epi16( v0, thresh8 );
-                    v1 = _mm_min_epi16( v1, thresh8 );
-                    _mm_storeu_si128((__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128((__m128i*)(dst + j + 8), v1 );
-                }
-            }
-        #endif
+            j = vecOp(src, dst, roi.width, THRESH_TRUNC);
 
             for( ; j < roi.width; j++ )
                 dst[j] = std::min(src[j], thresh);
@@ -369,23 +224,7 @@ thresh_16s( const Mat& _src, Mat& _dst, short thresh, short maxval, int type )
     case THRESH_TOZERO:
         for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
         {
-            j = 0;
-        #if CV_SSE2
-            if( useSIMD )
-            {
-                __m128i thresh8 = _mm_set1_epi16(thresh);
-                for( ; j <= roi.width - 16; j += 16 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 8) );
-                    v0 = _mm_and_si128(v0, _mm_cmpgt_epi16(v0, thresh8));
-                    v1 = _mm_and_si128(v1, _mm_cmpgt_epi16(v1, thresh8));
-                    _mm_storeu_si128((__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128((__m128i*)(dst + j + 8), v1 );
-                }
-            }
-        #endif
+            j = vecOp(src, dst, roi.width, THRESH_TOZERO);
 
             for( ; j < roi.width; j++ )
             {
@@ -398,23 +237,7 @@ thresh_16s( const Mat& _src, Mat& _dst, short thresh, short maxval, int type )
     case THRESH_TOZERO_INV:
         for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
         {
-            j = 0;
-        #if CV_SSE2
-            if( useSIMD )
-            {
-                __m128i thresh8 = _mm_set1_epi16(thresh);
-                for( ; j <= roi.width - 16; j += 16 )
-                {
-                    __m128i v0, v1;
-                    v0 = _mm_loadu_si128( (const __m128i*)(src + j) );
-                    v1 = _mm_loadu_si128( (const __m128i*)(src + j + 8) );
-                    v0 = _mm_andnot_si128(_mm_cmpgt_epi16(v0, thresh8), v0);
-                    v1 = _mm_andnot_si128(_mm_cmpgt_epi16(v1, thresh8), v1);
-                    _mm_storeu_si128((__m128i*)(dst + j), v0 );
-                    _mm_storeu_si128((__m128i*)(dst + j + 8), v1 );
-                }
-            }
-        #endif
+            j = vecOp(src, dst, roi.width, THRESH_TOZERO_INV);
             for( ; j < roi.width; j++ )
             {
                 short v = src[j];
@@ -439,9 +262,7 @@ thresh_32f( const Mat& _src, Mat& _dst, float thresh, float maxval, int type )
     size_t src_step = _src.step/sizeof(src[0]);
     size_t dst_step = _dst.step/sizeof(dst[0]);
 
-#if CV_SSE2
-    volatile bool useSIMD = checkHardwareSupport(CV_CPU_SSE);
-#endif
+    ThreshVec<float> vecOp(thresh, maxval);
 
     if( _src.isContinuous() && _dst.isContinuous() )
     {
@@ -459,25 +280,7 @@ thresh_32f( const Mat& _src, Mat& _dst, float thresh, float maxval, int type )
         case THRESH_BINARY:
             for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
             {
-                j = 0;
-#if CV_SSE2
-                if( useSIMD )
-                {
-                    __m128 thresh4 = _mm_set1_ps(thresh), maxval4 = _mm_set1_ps(maxval);
-                    for( ; j <= roi.width - 8; j += 8 )
-                    {
-                        __m128 v0, v1;
-                        v0 = _mm_loadu_ps( src + j );
-                        v1 = _mm_loadu_ps( src + j + 4 );
-                        v0 = _mm_cmpgt_ps( v0, thresh4 );
-                        v1 = _mm_cmpgt_ps( v1, thresh4 );
-                        v0 = _mm_and_ps( v0, maxval4 );
-                        v1 = _mm_and_ps( v1, maxval4 );
-                        _mm_storeu_ps( dst + j, v0 );
-                        _mm_storeu_ps( dst + j + 4, v1 );
-                    }
-                }
-#endif
+                j = vecOp(src, dst, roi.width, THRESH_BINARY);
 
                 for( ; j < roi.width; j++ )
                     dst[j] = src[j] > thresh ? maxval : 0;
@@ -487,25 +290,7 @@ thresh_32f( const Mat& _src, Mat& _dst, float thresh, float maxval, int type )
         case THRESH_BINARY_INV:
             for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
             {
-                j = 0;
-#if CV_SSE2
-                if( useSIMD )
-                {
-                    __m128 thresh4 = _mm_set1_ps(thresh), maxval4 = _mm_set1_ps(maxval);
-                    for( ; j <= roi.width - 8; j += 8 )
-                    {
-                        __m128 v0, v1;
-                        v0 = _mm_loadu_ps( src + j );
-                        v1 = _mm_loadu_ps( src + j + 4 );
-                        v0 = _mm_cmple_ps( v0, thresh4 );
-                        v1 = _mm_cmple_ps( v1, thresh4 );
-                        v0 = _mm_and_ps( v0, maxval4 );
-                        v1 = _mm_and_ps( v1, maxval4 );
-                        _mm_storeu_ps( dst + j, v0 );
-                        _mm_storeu_ps( dst + j + 4, v1 );
-                    }
-                }
-#endif
+                j = vecOp(src, dst, roi.width, THRESH_BINARY_INV);
 
                 for( ; j < roi.width; j++ )
                     dst[j] = src[j] <= thresh ? maxval : 0;
@@ -515,23 +300,7 @@ thresh_32f( const Mat& _src, Mat& _dst, float thresh, float maxval, int type )
         case THRESH_TRUNC:
             for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
             {
-                j = 0;
-#if CV_SSE2
-                if( useSIMD )
-                {
-                    __m128 thresh4 = _mm_set1_ps(thresh);
-                    for( ; j <= roi.width - 8; j += 8 )
-                    {
-                        __m128 v0, v1;
-                        v0 = _mm_loadu_ps( src + j );
-                        v1 = _mm_loadu_ps( src + j + 4 );
-                        v0 = _mm_min_ps( v0, thresh4 );
-                        v1 = _mm_min_ps( v1, thresh4 );
-                        _mm_storeu_ps( dst + j, v0 );
-                        _mm_storeu_ps( dst + j + 4, v1 );
-                    }
-                }
-#endif
+                j = vecOp(src, dst, roi.width, THRESH_TRUNC);
 
                 for( ; j < roi.width; j++ )
                     dst[j] = std::min(src[j], thresh);
@@ -541,23 +310,7 @@ thresh_32f( const Mat& _src, Mat& _dst, float thresh, float maxval, int type )
         case THRESH_TOZERO:
             for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
             {
-                j = 0;
-#if CV_SSE2
-                if( useSIMD )
-                {
-                    __m128 thresh4 = _mm_set1_ps(thresh);
-                    for( ; j <= roi.width - 8; j += 8 )
-                    {
-                        __m128 v0, v1;
-                        v0 = _mm_loadu_ps( src + j );
-                        v1 = _mm_loadu_ps( src + j + 4 );
-                        v0 = _mm_and_ps(v0, _mm_cmpgt_ps(v0, thresh4));
-                        v1 = _mm_and_ps(v1, _mm_cmpgt_ps(v1, thresh4));
-                        _mm_storeu_ps( dst + j, v0 );
-                        _mm_storeu_ps( dst + j + 4, v1 );
-                    }
-                }
-#endif
+                j = vecOp(src, dst, roi.width, THRESH_TOZERO);
 
                 for( ; j < roi.width; j++ )
                 {
@@ -570,23 +323,7 @@ thresh_32f( const Mat& _src, Mat& _dst, float thresh, float maxval, int type )
         case THRESH_TOZERO_INV:
             for( i = 0; i < roi.height; i++, src += src_step, dst += dst_step )
             {
-                j = 0;
-#if CV_SSE2
-                if( useSIMD )
-                {
-                    __m128 thresh4 = _mm_set1_ps(thresh);
-                    for( ; j <= roi.width - 8; j += 8 )
-                    {
-                        __m128 v0, v1;
-                        v0 = _mm_loadu_ps( src + j );
-                        v1 = _mm_loadu_ps( src + j + 4 );
-                        v0 = _mm_and_ps(v0, _mm_cmple_ps(v0, thresh4));
-                        v1 = _mm_and_ps(v1, _mm_cmple_ps(v1, thresh4));
-                        _mm_storeu_ps( dst + j, v0 );
-                        _mm_storeu_ps( dst + j + 4, v1 );
-                    }
-                }
-#endif
+                j = vecOp(src, dst, roi.width, THRESH_TOZERO_INV);
                 for( ; j < roi.width; j++ )
                 {
                     float v = src[j];
@@ -716,6 +453,7 @@ private:
 
 double cv::threshold( InputArray _src, OutputArray _dst, double thresh, double maxval, int type )
 {
+    CV_TRACE_REGION("cv::threshold");
     Mat src = _src.getMat();
     bool use_otsu = (type & THRESH_OTSU) != 0;
     type &= THRESH_MASK;
@@ -730,8 +468,9 @@ double cv::threshold( InputArray _src, OutputArray _dst, double thresh, double m
     Mat dst = _dst.getMat();
 
     int nStripes = 1;
-#if defined HAVE_TBB && defined ANDROID
-    nStripes = 4;
+#ifdef HAVE_PARALLEL_FRAMEWORK
+    if( src.total() >= 320*240 && getNumThreads() > 1 ) //NOTE: just heuristics
+        nStripes = std::min(std::max(getNumThreads(), 4), src.rows);
 #endif
 
     if( src.depth() == CV_8U )
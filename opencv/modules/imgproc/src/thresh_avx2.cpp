@@ -0,0 +1,164 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/*
+   AVX2 version of the threshold() row kernel, see thresh_avx2.hpp. This file is compiled
+   with the AVX2 flags and must not include any OpenCV header except thresh_avx2.hpp.
+*/
+
+#if defined CV_TRY_AVX2 && CV_TRY_AVX2
+
+#include <immintrin.h>
+#include "thresh_avx2.hpp"
+
+namespace cv { namespace avx2
+{
+
+typedef unsigned char uchar;
+
+// the same values as cv::THRESH_BINARY ... cv::THRESH_TOZERO_INV
+enum { THRESH_BINARY=0, THRESH_BINARY_INV=1, THRESH_TRUNC=2, THRESH_TOZERO=3, THRESH_TOZERO_INV=4 };
+
+// gt() and le() return all-ones lanes where the predicate holds;
+// for the floats both are false for NaNs, like the scalar operators
+struct VThresh8u
+{
+    typedef uchar type;
+    static __m256i set1(uchar v) { return _mm256_set1_epi8((char)v); }
+    static __m256i le(const __m256i& a, const __m256i& b) { return _mm256_cmpeq_epi8(_mm256_min_epu8(a, b), a); }
+    static __m256i gt(const __m256i& a, const __m256i& b) { return _mm256_xor_si256(le(a, b), _mm256_set1_epi32(-1)); }
+    static __m256i min(const __m256i& a, const __m256i& b) { return _mm256_min_epu8(a, b); }
+};
+
+struct VThresh16s
+{
+    typedef short type;
+    static __m256i set1(short v) { return _mm256_set1_epi16(v); }
+    static __m256i gt(const __m256i& a, const __m256i& b) { return _mm256_cmpgt_epi16(a, b); }
+    static __m256i le(const __m256i& a, const __m256i& b) { return _mm256_xor_si256(gt(a, b), _mm256_set1_epi32(-1)); }
+    static __m256i min(const __m256i& a, const __m256i& b) { return _mm256_min_epi16(a, b); }
+};
+
+struct VThresh32f
+{
+    typedef float type;
+    static __m256i set1(float v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+    static __m256i gt(const __m256i& a, const __m256i& b)
+    { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_GT_OQ)); }
+    static __m256i le(const __m256i& a, const __m256i& b)
+    { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_LE_OQ)); }
+    static __m256i min(const __m256i& a, const __m256i& b)
+    { return _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); }
+};
+
+template<int ttype, class VT> static int
+threshRow_(const typename VT::type* src, typename VT::type* dst, int width,
+           const __m256i& thresh, const __m256i& maxval)
+{
+    const int VEC = 32/sizeof(typename VT::type);
+    int j = 0;
+
+    for( ; j <= width - VEC; j += VEC )
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + j));
+        switch( ttype )
+        {
+        case THRESH_BINARY:
+            v = _mm256_and_si256(VT::gt(v, thresh), maxval);
+            break;
+        case THRESH_BINARY_INV:
+            v = _mm256_and_si256(VT::le(v, thresh), maxval);
+            break;
+        case THRESH_TRUNC:
+            v = VT::min(v, thresh);
+            break;
+        case THRESH_TOZERO:
+            v = _mm256_and_si256(VT::gt(v, thresh), v);
+            break;
+        case THRESH_TOZERO_INV:
+            v = _mm256_and_si256(VT::le(v, thresh), v);
+            break;
+        }
+        _mm256_storeu_si256((__m256i*)(dst + j), v);
+    }
+    return j;
+}
+
+template<class VT> static int
+threshRow_(const typename VT::type* src, typename VT::type* dst, int width, int type,
+           typename VT::type thresh, typename VT::type maxval)
+{
+    __m256i t = VT::set1(thresh), m = VT::set1(maxval);
+    switch( type )
+    {
+    case THRESH_BINARY:
+        return threshRow_<THRESH_BINARY, VT>(src, dst, width, t, m);
+    case THRESH_BINARY_INV:
+        return threshRow_<THRESH_BINARY_INV, VT>(src, dst, width, t, m);
+    case THRESH_TRUNC:
+        return threshRow_<THRESH_TRUNC, VT>(src, dst, width, t, m);
+    case THRESH_TOZERO:
+        return threshRow_<THRESH_TOZERO, VT>(src, dst, width, t, m);
+    case THRESH_TOZERO_INV:
+        return threshRow_<THRESH_TOZERO_INV, VT>(src, dst, width, t, m);
+    }
+    return 0;
+}
+
+int threshRow(const uchar* src, uchar* dst, int width, int type, uchar thresh, uchar maxval)
+{
+    return threshRow_<VThresh8u>(src, dst, width, type, thresh, maxval);
+}
+
+int threshRow(const short* src, short* dst, int width, int type, short thresh, short maxval)
+{
+    return threshRow_<VThresh16s>(src, dst, width, type, thresh, maxval);
+}
+
+int threshRow(const float* src, float* dst, int width, int type, float thresh, float maxval)
+{
+    return threshRow_<VThresh32f>(src, dst, width, type, thresh, maxval);
+}
+
+}}
+
+#endif
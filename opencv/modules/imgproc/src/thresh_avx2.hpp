@@ -0,0 +1,62 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+#ifndef __OPENCV_IMGPROC_THRESH_AVX2_HPP__
+#define __OPENCV_IMGPROC_THRESH_AVX2_HPP__
+
+/*
+   The AVX2 version of the threshold() row kernel of thresh_simd.hpp, compiled in
+   thresh_avx2.cpp and called only when checkHardwareSupport(CV_CPU_AVX2) is true.
+   Every function processes a prefix of the row and returns its length; type is
+   one of THRESH_BINARY ... THRESH_TOZERO_INV.
+*/
+
+namespace cv { namespace avx2
+{
+
+int threshRow(const unsigned char* src, unsigned char* dst, int width, int type,
+              unsigned char thresh, unsigned char maxval);
+int threshRow(const short* src, short* dst, int width, int type, short thresh, short maxval);
+int threshRow(const float* src, float* dst, int width, int type, float thresh, float maxval);
+
+}}
+
+#endif
@@ -0,0 +1,128 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef __OPENCV_IMGPROC_THRESH_SIMD_HPP__
+#define __OPENCV_IMGPROC_THRESH_SIMD_HPP__
+
+/*
+   The vectorized row kernel of thresh.cpp, written with the opencv2/core/simd.hpp types.
+   It is built into thresh.cpp with the backend of the instruction set the library is
+   built for; the run-time AVX2 path uses the header-free kernel of thresh_avx2.cpp.
+*/
+
+namespace cv { namespace CV_SIMD_NAMESPACE
+{
+
+#if CV_SIMD
+// thresholds the vectorizable part of the row, returns the number of processed elements
+template<int ttype, class _Tpvec> inline int
+threshRow_SIMD( const typename _Tpvec::lane_type* src, typename _Tpvec::lane_type* dst,
+                int width, const _Tpvec& thresh, const _Tpvec& maxval )
+{
+    const int n = _Tpvec::nlanes;
+    int j = 0;
+
+    for( ; j <= width - n; j += n )
+    {
+        _Tpvec v = v_load(src + j);
+        switch( ttype )
+        {
+        case THRESH_BINARY:
+            v = (v > thresh) & maxval;
+            break;
+        case THRESH_BINARY_INV:
+            v = (v <= thresh) & maxval;
+            break;
+        case THRESH_TRUNC:
+            v = v_min(v, thresh);
+            break;
+        case THRESH_TOZERO:
+            v = (v > thresh) & v;
+            break;
+        case THRESH_TOZERO_INV:
+            v = (v <= thresh) & v;
+            break;
+        }
+        v_store(dst + j, v);
+    }
+    return j;
+}
+
+template<class _Tpvec> inline int
+threshRow_SIMD( const typename _Tpvec::lane_type* src, typename _Tpvec::lane_type* dst,
+                int width, int type, const _Tpvec& thresh, const _Tpvec& maxval )
+{
+    switch( type )
+    {
+    case THRESH_BINARY:
+        return threshRow_SIMD<THRESH_BINARY>(src, dst, width, thresh, maxval);
+    case THRESH_BINARY_INV:
+        return threshRow_SIMD<THRESH_BINARY_INV>(src, dst, width, thresh, maxval);
+    case THRESH_TRUNC:
+        return threshRow_SIMD<THRESH_TRUNC>(src, dst, width, thresh, maxval);
+    case THRESH_TOZERO:
+        return threshRow_SIMD<THRESH_TOZERO>(src, dst, width, thresh, maxval);
+    case THRESH_TOZERO_INV:
+        return threshRow_SIMD<THRESH_TOZERO_INV>(src, dst, width, thresh, maxval);
+    }
+    return 0;
+}
+
+inline int threshRow_SIMD( const uchar* src, uchar* dst, int width, int type, uchar thresh, uchar maxval )
+{
+    return threshRow_SIMD(src, dst, width, type, v_setall_u8(thresh), v_setall_u8(maxval));
+}
+
+inline int threshRow_SIMD( const short* src, short* dst, int width, int type, short thresh, short maxval )
+{
+    return threshRow_SIMD(src, dst, width, type, v_setall_s16(thresh), v_setall_s16(maxval));
+}
+
+inline int threshRow_SIMD( const float* src, float* dst, int width, int type, float thresh, float maxval )
+{
+    return threshRow_SIMD(src, dst, width, type, v_setall_f32(thresh), v_setall_f32(maxval));
+}
+#endif
+
+}}
+
+#endif
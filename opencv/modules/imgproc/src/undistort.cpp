@@ -59,10 +59,116 @@ cv::Mat cv::getDefaultNewCameraMatrix( InputArray _cameraMatrix, Size imgsize,
     return newCameraMatrix;
 }
 
+namespace cv
+{
+
+class initUndistortRectifyMapInvoker
+{
+public:
+    initUndistortRectifyMapInvoker( Mat& _map1, Mat& _map2, int _m1type, const double* _ir,
+                                    const double* _k, double _u0, double _v0, double _fx, double _fy ) :
+        map1(_map1), map2(_map2), m1type(_m1type), u0(_u0), v0(_v0), fx(_fx), fy(_fy)
+    {
+        std::copy(_ir, _ir + 9, ir);
+        std::copy(_k, _k + 8, k);
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        Size size = map1.size();
+        double k1 = k[0], k2 = k[1], p1 = k[2], p2 = k[3], k3 = k[4], k4 = k[5], k5 = k[6], k6 = k[7];
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            float* m1f = (float*)(map1.data + map1.step*i);
+            float* m2f = (float*)(map2.data + map2.step*i);
+            short* m1 = (short*)m1f;
+            ushort* m2 = (ushort*)m2f;
+            double _x = i*ir[1] + ir[2], _y = i*ir[4] + ir[5], _w = i*ir[7] + ir[8];
+
+            for( int j = 0; j < size.width; j++, _x += ir[0], _y += ir[3], _w += ir[6] )
+            {
+                double w = 1./_w, x = _x*w, y = _y*w;
+                double x2 = x*x, y2 = y*y;
+                double r2 = x2 + y2, _2xy = 2*x*y;
+                double kr = (1 + ((k3*r2 + k2)*r2 + k1)*r2)/(1 + ((k6*r2 + k5)*r2 + k4)*r2);
+                double u = fx*(x*kr + p1*_2xy + p2*(r2 + 2*x2)) + u0;
+                double v = fy*(y*kr + p1*(r2 + 2*y2) + p2*_2xy) + v0;
+                if( m1type == CV_16SC2 )
+                {
+                    int iu = saturate_cast<int>(u*INTER_TAB_SIZE);
+                    int iv = saturate_cast<int>(v*INTER_TAB_SIZE);
+                    m1[j*2] = (short)(iu >> INTER_BITS);
+                    m1[j*2+1] = (short)(iv >> INTER_BITS);
+                    m2[j] = (ushort)((iv & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (iu & (INTER_TAB_SIZE-1)));
+                }
+                else if( m1type == CV_32FC1 )
+                {
+                    m1f[j] = (float)u;
+                    m2f[j] = (float)v;
+                }
+                else
+                {
+                    m1f[j*2] = (float)u;
+                    m1f[j*2+1] = (float)v;
+                }
+            }
+        }
+    }
+
+private:
+    Mat map1, map2;
+    int m1type;
+    double ir[9], k[8];
+    double u0, v0, fx, fy;
+};
+
+class UndistortInvoker
+{
+public:
+    UndistortInvoker( const Mat& _src, Mat& _dst, const Mat_<double>& _A, const Mat& _distCoeffs,
+                      const Mat_<double>& _Ar, int _stripe_size0 ) :
+        src(_src), dst(_dst), A(_A), distCoeffs(_distCoeffs), Ar(_Ar), stripe_size0(_stripe_size0)
+    {
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        Mat map1(stripe_size0, src.cols, CV_16SC2), map2(stripe_size0, src.cols, CV_16UC1);
+        Mat_<double> Ar1 = Ar.clone(), I = Mat_<double>::eye(3,3);
+        double v0 = Ar(1, 2);
+
+        for( int s = range.begin(); s < range.end(); s++ )
+        {
+            int y = s*stripe_size0;
+            int stripe_size = std::min( stripe_size0, src.rows - y );
+            Ar1(1, 2) = v0 - y;
+            Mat map1_part = map1.rowRange(0, stripe_size),
+                map2_part = map2.rowRange(0, stripe_size),
+                dst_part = dst.rowRange(y, y + stripe_size);
+
+            initUndistortRectifyMap( A, distCoeffs, I, Ar1, Size(src.cols, stripe_size),
+                                     map1_part.type(), map1_part, map2_part );
+            remap( src, dst_part, map1_part, map2_part, INTER_LINEAR, BORDER_CONSTANT );
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    Mat_<double> A;
+    Mat distCoeffs;
+    Mat_<double> Ar;
+    int stripe_size0;
+};
+
+}
+
 void cv::initUndistortRectifyMap( InputArray _cameraMatrix, InputArray _distCoeffs,
                               InputArray _matR, InputArray _newCameraMatrix,
                               Size size, int m1type, OutputArray _map1, OutputArray _map2 )
 {
+    CV_TRACE_REGION("cv::initUndistortRectifyMap");
     Mat cameraMatrix = _cameraMatrix.getMat(), distCoeffs = _distCoeffs.getMat();
     Mat matR = _matR.getMat(), newCameraMatrix = _newCameraMatrix.getMat();
 
@@ -122,48 +228,16 @@ void cv::initUndistortRectifyMap( InputArray _cameraMatrix, InputArray _distCoef
     double k5 = distCoeffs.cols + distCoeffs.rows - 1 >= 8 ? ((double*)distCoeffs.data)[6] : 0.;
     double k6 = distCoeffs.cols + distCoeffs.rows - 1 >= 8 ? ((double*)distCoeffs.data)[7] : 0.;
 
-    for( int i = 0; i < size.height; i++ )
-    {
-        float* m1f = (float*)(map1.data + map1.step*i);
-        float* m2f = (float*)(map2.data + map2.step*i);
-        short* m1 = (short*)m1f;
-        ushort* m2 = (ushort*)m2f;
-        double _x = i*ir[1] + ir[2], _y = i*ir[4] + ir[5], _w = i*ir[7] + ir[8];
-
-        for( int j = 0; j < size.width; j++, _x += ir[0], _y += ir[3], _w += ir[6] )
-        {
-            double w = 1./_w, x = _x*w, y = _y*w;
-            double x2 = x*x, y2 = y*y;
-            double r2 = x2 + y2, _2xy = 2*x*y;
-            double kr = (1 + ((k3*r2 + k2)*r2 + k1)*r2)/(1 + ((k6*r2 + k5)*r2 + k4)*r2);
-            double u = fx*(x*kr + p1*_2xy + p2*(r2 + 2*x2)) + u0;
-            double v = fy*(y*kr + p1*(r2 + 2*y2) + p2*_2xy) + v0;
-            if( m1type == CV_16SC2 )
-            {
-                int iu = saturate_cast<int>(u*INTER_TAB_SIZE);
-                int iv = saturate_cast<int>(v*INTER_TAB_SIZE);
-                m1[j*2] = (short)(iu >> INTER_BITS);
-                m1[j*2+1] = (short)(iv >> INTER_BITS);
-                m2[j] = (ushort)((iv & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (iu & (INTER_TAB_SIZE-1)));
-            }
-            else if( m1type == CV_32FC1 )
-            {
-                m1f[j] = (float)u;
-                m2f[j] = (float)v;
-            }
-            else
-            {
-                m1f[j*2] = (float)u;
-                m1f[j*2+1] = (float)v;
-            }
-        }
-    }
+    double k[] = { k1, k2, p1, p2, k3, k4, k5, k6 };
+    parallel_for( BlockedRange(0, size.height, std::max(1, (1 << 15)/std::max(size.width, 1))),
+                  initUndistortRectifyMapInvoker(map1, map2, m1type, ir, k, u0, v0, fx, fy) );
 }
 
 
 void cv::undistort( InputArray _src, OutputArray _dst, InputArray _cameraMatrix,
                     InputArray _distCoeffs, InputArray _newCameraMatrix )
 {
+    CV_TRACE_REGION("cv::undistort");
     Mat src = _src.getMat(), cameraMatrix = _cameraMatrix.getMat();
     Mat distCoeffs = _distCoeffs.getMat(), newCameraMatrix = _newCameraMatrix.getMat();
 
@@ -173,9 +247,8 @@ void cv::undistort( InputArray _src, OutputArray _dst, InputArray _cameraMatrix,
     CV_Assert( dst.data != src.data );
 
     int stripe_size0 = std::min(std::max(1, (1 << 12) / std::max(src.cols, 1)), src.rows);
-    Mat map1(stripe_size0, src.cols, CV_16SC2), map2(stripe_size0, src.cols, CV_16UC1);
 
-    Mat_<double> A, Ar, I = Mat_<double>::eye(3,3);
+    Mat_<double> A, Ar;
 
     cameraMatrix.convertTo(A, CV_64F);
     if( distCoeffs.data )
@@ -191,19 +264,9 @@ void cv::undistort( InputArray _src, OutputArray _dst, InputArray _cameraMatrix,
     else
         A.copyTo(Ar);
 
-    double v0 = Ar(1, 2);
-    for( int y = 0; y < src.rows; y += stripe_size0 )
-    {
-        int stripe_size = std::min( stripe_size0, src.rows - y );
-        Ar(1, 2) = v0 - y;
-        Mat map1_part = map1.rowRange(0, stripe_size),
-            map2_part = map2.rowRange(0, stripe_size),
-            dst_part = dst.rowRange(y, y + stripe_size);
-
-        initUndistortRectifyMap( A, distCoeffs, I, Ar, Size(src.cols, stripe_size),
-                                 map1_part.type(), map1_part, map2_part );
-        remap( src, dst_part, map1_part, map2_part, INTER_LINEAR, BORDER_CONSTANT );
-    }
+    // the stripes are undistorted independently, each with its own map buffers
+    parallel_for( BlockedRange(0, (src.rows + stripe_size0 - 1)/stripe_size0, 8),
+                  UndistortInvoker(src, dst, A, distCoeffs, Ar, stripe_size0) );
 }
 
 
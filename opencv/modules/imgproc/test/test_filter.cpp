@@ -1879,3 +1879,163 @@ protected:
 
 TEST(Imgproc_Filtering, supportedFormats) { CV_FilterSupportedFormatsTest test; test.safe_run(); }
 
+
+// the stripe-parallel filtering must give exactly the same results as the serial one,
+// including the borders of the stripes and the pixels outside of the ROI
+TEST(Imgproc_Filtering, stripes_consistency)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC1, CV_32FC3 };
+    const int borders[] = { BORDER_REFLECT_101, BORDER_REPLICATE, BORDER_CONSTANT, BORDER_REFLECT_101 | BORDER_ISOLATED };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat img(413, 331, types[t]);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        Mat src = img(Rect(3, 5, 320, 400));
+        float k[] = { 1, 2, -1, 0, 3, 1, -2, 1, 1, 0, 2, 1, -1, 1, 0, 1, 1, 2, 0, 1, -1, 1, 1, 0, 1 };
+        Mat kernel(5, 5, CV_32F, k), kx = kernel.row(0), ky = kernel.row(1).t();
+
+        for( int b = 0; b < (int)(sizeof(borders)/sizeof(borders[0])); b++ )
+        {
+            int border = borders[b];
+            for( int op = 0; op < 10; op++ )
+            {
+                Mat dst[2];
+                for( int k = 0; k < 2; k++ )
+                {
+                    NumThreadsGuard guard(k == 0 ? 1 : 4);
+                    switch( op )
+                    {
+                    case 0: filter2D(src, dst[k], CV_32F, kernel, Point(-1,-1), 1, border); break;
+                    case 1: sepFilter2D(src, dst[k], CV_32F, kx, ky, Point(1, 3), 0, border); break;
+                    case 2: Sobel(src, dst[k], CV_32F, 1, 0, 3, 1, 0, border); break;
+                    case 3: Sobel(src, dst[k], CV_32F, 1, 2, 5, 1, 0, border); break;
+                    case 4: Scharr(src, dst[k], CV_32F, 0, 1, 1, 0, border); break;
+                    case 5: Laplacian(src, dst[k], CV_32F, 1, 1, 0, border); break;
+                    case 6: Laplacian(src, dst[k], CV_32F, 5, 1, 0, border); break;
+                    case 7: GaussianBlur(src, dst[k], Size(7, 9), 2., 3., border); break;
+                    case 8: boxFilter(src, dst[k], -1, Size(5, 7), Point(-1,-1), true, border); break;
+                    default: boxFilter(src, dst[k], CV_32F, Size(4, 3), Point(-1,-1), false, border); break;
+                    }
+                }
+                ASSERT_EQ(dst[0].type(), dst[1].type());
+                EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "type=" << types[t] << ", border=" << border << ", op=" << op;
+            }
+        }
+    }
+}
+
+TEST(Imgproc_GaussianBlur, recursive)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC2, CV_32FC1, CV_32FC3, CV_64FC1 };
+    const int borders[] = { BORDER_REFLECT_101, BORDER_REFLECT, BORDER_REPLICATE, BORDER_CONSTANT };
+    const double sigmas[][2] = { {3, 3}, {10, 4}, {25, 40} };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        int type = types[t], depth = CV_MAT_DEPTH(type);
+        Mat img(367, 411, type);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        for( int i = 0; i < 10; i++ )
+        {
+            Point pt(rng.uniform(0, img.cols), rng.uniform(0, img.rows));
+            rectangle(img, pt, pt + Point(rng.uniform(5, 200), rng.uniform(5, 200)),
+                      Scalar::all(rng.uniform(0, 256)), -1);
+        }
+
+        for( int b = 0; b < (int)(sizeof(borders)/sizeof(borders[0])); b++ )
+            for( int s = 0; s < (int)(sizeof(sigmas)/sizeof(sigmas[0])); s++ )
+            {
+                double sx = sigmas[s][0], sy = sigmas[s][1];
+                // the reference is the convolution with the kernel of +-6*sigma in double
+                Mat src64, ref64, ref, dst[2];
+                img.convertTo(src64, CV_64F);
+                GaussianBlur(src64, ref64, Size(cvCeil(sx*6)*2 + 1, cvCeil(sy*6)*2 + 1), sx, sy, borders[b]);
+                ref64.convertTo(ref, depth);
+
+                for( int k = 0; k < 2; k++ )
+                {
+                    NumThreadsGuard guard(k == 0 ? 1 : 4);
+                    GaussianBlur(img, dst[k], Size(), sx, sy, borders[b], GAUSSIAN_RECURSIVE);
+                }
+                ASSERT_EQ(img.type(), dst[0].type());
+                EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF));
+                // the documented tolerance: 0.1% of the range of the values (+1 for rounding)
+                double err = norm(dst[0], ref, NORM_INF);
+                EXPECT_LE(err, depth < CV_32F ? 1 : 255*1e-3) << "type=" << type << ", border=" << borders[b]
+                    << ", sigma=(" << sx << ", " << sy << ")";
+            }
+    }
+}
+
+TEST(Imgproc_BilateralFilter, parallel)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC3 };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int method = BILATERAL_EXACT; method <= BILATERAL_GRID; method++ )
+        {
+            Mat img(247, 311, types[t]), dst[2];
+            rng.fill(img, RNG::UNIFORM, 0, 256);
+            for( int k = 0; k < 2; k++ )
+            {
+                NumThreadsGuard guard(k == 0 ? 1 : 4);
+                bilateralFilter(img, dst[k], 9, 30, 5, BORDER_REFLECT_101, method);
+            }
+            ASSERT_EQ(img.type(), dst[0].type());
+            EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "type=" << types[t] << ", method=" << method;
+        }
+}
+
+TEST(Imgproc_BilateralFilter, grid)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC3 };
+    // the small sigmas would make the grid too large for the image and the exact filter would be used
+    const double sigmas[][2] = { {5, 60}, {10, 60} };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        int type = types[t], cn = CV_MAT_CN(type);
+        // the blocks of constant color with the noise; the channels of a block differ by a tint,
+        // so that the sum of the channels, which guides the grid of a 3-channel image, changes
+        // across the edges as the colors do
+        Mat img(240, 320, CV_32FC(cn), Scalar::all(128)), noise(img.size(), img.type());
+        for( int i = 0; i < 30; i++ )
+        {
+            Point pt(rng.uniform(0, img.cols), rng.uniform(0, img.rows));
+            int v = rng.uniform(32, 224);
+            rectangle(img, pt, pt + Point(64, 48), Scalar(v, v + rng.uniform(-32, 32),
+                      v + rng.uniform(-32, 32)), -1);
+        }
+        // the pixels where any channel of the blocks changes
+        Mat grad, edges0 = Mat::zeros(img.size(), CV_8U);
+        vector<Mat> planes;
+        morphologyEx(img, grad, MORPH_GRADIENT, Mat());
+        split(grad, planes);
+        for( int c = 0; c < cn; c++ )
+            edges0 |= planes[c] > 0;
+        rng.fill(noise, RNG::NORMAL, 0, 10);
+        img += noise;
+        img.convertTo(img, type);
+
+        for( int s = 0; s < (int)(sizeof(sigmas)/sizeof(sigmas[0])); s++ )
+        {
+            double ss = sigmas[s][0], sc = sigmas[s][1];
+            Mat ref, dst, edges;
+            // the reference uses the neighborhood of +-3*sigmaSpace
+            bilateralFilter(img, ref, cvCeil(ss*3)*2 + 1, sc, ss);
+            bilateralFilter(img, dst, 0, sc, ss, BORDER_DEFAULT, BILATERAL_GRID);
+            ASSERT_EQ(img.type(), dst.type());
+            double err = norm(dst, ref, NORM_L1)/img.total()/cn;
+            // the pixels within sigmaSpace from the edges
+            dilate(edges0, edges, Mat(), Point(-1, -1), cvRound(ss));
+            double eerr = norm(dst, ref, NORM_L1, edges)/countNonZero(edges)/cn;
+            EXPECT_LE(err, 1.5) << "type=" << type << ", sigmas=(" << ss << ", " << sc << ")";
+            EXPECT_LE(eerr, 2) << "type=" << type << ", sigmas=(" << ss << ", " << sc << ")";
+        }
+    }
+}
@@ -1505,6 +1505,114 @@ TEST(Imgproc_resize_area, regression)
 }
 
 
+static void runWarpOp( int op, const Mat& src, Mat& dst )
+{
+    Size dsize(src.cols*5/7, src.rows*6/5);
+    Mat mapxy(dsize, CV_32FC2), mapx(dsize, CV_32FC1), mapy(dsize, CV_32FC1);
+    for( int y = 0; y < dsize.height; y++ )
+        for( int x = 0; x < dsize.width; x++ )
+        {
+            float fx = (float)(x*1.3 + 7*sin(y*0.05) - 11), fy = (float)(y*0.8 + 5*cos(x*0.07) - 4);
+            mapxy.at<Vec2f>(y, x) = Vec2f(fx, fy);
+            mapx.at<float>(y, x) = fx;
+            mapy.at<float>(y, x) = fy;
+        }
+    Mat M = getRotationMatrix2D(Point2f(src.cols*0.4f, src.rows*0.6f), 17, 1.2);
+    Point2f q0[] = { Point2f(0, 0), Point2f(300, 10), Point2f(310, 390), Point2f(5, 380) };
+    Point2f q1[] = { Point2f(12, 3), Point2f(290, 30), Point2f(330, 370), Point2f(-20, 395) };
+    Mat P = getPerspectiveTransform(q0, q1);
+    Mat K = (Mat_<double>(3, 3) << 350, 0, src.cols*0.5, 0, 360, src.rows*0.5, 0, 0, 1);
+    Mat dist = (Mat_<double>(1, 5) << -0.28, 0.07, 0.001, -0.002, 0.01);
+    Mat m1, m2;
+
+    switch( op )
+    {
+    case 0: resize(src, dst, Size(), 1.7, 0.6, INTER_NEAREST); break;
+    case 1: resize(src, dst, Size(), 1.7, 1.3, INTER_LINEAR); break;
+    case 2: resize(src, dst, Size(), 0.6, 0.45, INTER_LINEAR); break;
+    case 3: resize(src, dst, Size(), 1.45, 0.8, INTER_CUBIC); break;
+    case 4: resize(src, dst, Size(), 0.9, 1.1, INTER_LANCZOS4); break;
+    case 5: resize(src, dst, Size(), 0.5, 0.25, INTER_AREA); break;
+    case 6: resize(src, dst, Size(), 0.37, 0.29, INTER_AREA); break;
+    case 7: remap(src, dst, mapxy, Mat(), INTER_LINEAR, BORDER_REFLECT_101); break;
+    case 8: remap(src, dst, mapx, mapy, INTER_CUBIC, BORDER_CONSTANT, Scalar::all(7)); break;
+    case 9: remap(src, dst, mapxy, Mat(), INTER_NEAREST, BORDER_REPLICATE); break;
+    case 10:
+        convertMaps(mapx, mapy, m1, m2, CV_16SC2);
+        remap(src, dst, m1, m2, INTER_LINEAR, BORDER_WRAP);
+        break;
+    case 11:
+        convertMaps(mapxy, Mat(), m1, m2, CV_16SC2, true);
+        remap(src, dst, m1, Mat(), INTER_NEAREST, BORDER_CONSTANT);
+        break;
+    case 12: warpAffine(src, dst, M, dsize, INTER_LINEAR, BORDER_REFLECT); break;
+    case 13: warpAffine(src, dst, M, dsize, INTER_NEAREST | WARP_INVERSE_MAP, BORDER_CONSTANT); break;
+    case 14: warpPerspective(src, dst, P, dsize, INTER_LINEAR, BORDER_REPLICATE); break;
+    case 15: warpPerspective(src, dst, P, dsize, INTER_CUBIC, BORDER_CONSTANT); break;
+    case 16: undistort(src, dst, K, dist); break;
+    default:
+        initUndistortRectifyMap(K, dist, Mat(), K, dsize, CV_32FC2, dst, m2);
+        break;
+    }
+}
+
+TEST(Imgproc_Warp, stripes_consistency)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_32FC1, CV_32FC3 };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat img(413, 331, types[t]);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        Mat src = img(Rect(3, 5, 317, 401));
+
+        for( int op = 0; op < 18; op++ )
+        {
+            Mat dst[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                NumThreadsGuard guard(k == 0 ? 1 : 4);
+                runWarpOp(op, src, dst[k]);
+            }
+            ASSERT_EQ(dst[0].type(), dst[1].type());
+            ASSERT_EQ(dst[0].size(), dst[1].size());
+            EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "type=" << types[t] << ", op=" << op;
+        }
+    }
+}
+
+// the SIMD (SSE2, AVX2 where available) kernels against the plain C++ code
+TEST(Imgproc_Warp, simd_consistency)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC2, CV_8UC3, CV_8UC4, CV_32FC1, CV_32FC3 };
+    bool useOptimized0 = useOptimized();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat img(413, 331, types[t]);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        Mat src = img(Rect(3, 5, 317, 401));
+
+        for( int op = 0; op < 18; op++ )
+        {
+            Mat dst[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                runWarpOp(op, src, dst[k]);
+            }
+            ASSERT_EQ(dst[0].type(), dst[1].type());
+            ASSERT_EQ(dst[0].size(), dst[1].size());
+            // the 8u bicubic code rounds the float sums in the SIMD branch
+            double err = src.depth() == CV_8U ? 1 : 1e-4*norm(dst[1], NORM_INF);
+            EXPECT_LE(norm(dst[0], dst[1], NORM_INF), err) << "type=" << types[t] << ", op=" << op;
+        }
+    }
+    setUseOptimized(useOptimized0);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 TEST(Imgproc_Resize, accuracy) { CV_ResizeTest test; test.safe_run(); }
@@ -0,0 +1,95 @@
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+// builds the chain number idx both as ImagePipeline and as the sequence of the function calls
+static void runChain( int idx, const Mat& src, ImagePipeline& p, Mat& ref )
+{
+    Mat a, b;
+    p.clear();
+    switch( idx )
+    {
+    case 0:
+        p.cvtColor(COLOR_BGR2GRAY).resize(Size(), 0.63, 0.58).GaussianBlur(Size(5, 5), 1.2)
+         .Sobel(CV_16S, 1, 0, 3).threshold(50, 255, THRESH_BINARY);
+        cvtColor(src, a, COLOR_BGR2GRAY);
+        resize(a, b, Size(), 0.63, 0.58);
+        GaussianBlur(b, a, Size(5, 5), 1.2);
+        Sobel(a, b, CV_16S, 1, 0, 3);
+        threshold(b, ref, 50, 255, THRESH_BINARY);
+        break;
+    case 1:
+        p.GaussianBlur(Size(0, 0), 2.5, 1.5, BORDER_REFLECT).resize(Size(501, 777), 0, 0, INTER_CUBIC)
+         .cvtColor(COLOR_BGR2HSV);
+        GaussianBlur(src, a, Size(0, 0), 2.5, 1.5, BORDER_REFLECT);
+        resize(a, b, Size(501, 777), 0, 0, INTER_CUBIC);
+        cvtColor(b, ref, COLOR_BGR2HSV);
+        break;
+    case 2:
+        p.convertTo(CV_32F, 1./255).cvtColor(COLOR_BGR2Lab).boxFilter(-1, Size(7, 3), Point(1, 2), true,
+         BORDER_CONSTANT).resize(Size(), 0.3, 0.3, INTER_NEAREST).Sobel(-1, 0, 1, CV_SCHARR, 0.5, 1);
+        src.convertTo(a, CV_32F, 1./255);
+        cvtColor(a, b, COLOR_BGR2Lab);
+        boxFilter(b, a, -1, Size(7, 3), Point(1, 2), true, BORDER_CONSTANT);
+        resize(a, b, Size(), 0.3, 0.3, INTER_NEAREST);
+        Sobel(b, ref, -1, 0, 1, CV_SCHARR, 0.5, 1);
+        break;
+    case 3:
+    {
+        Mat kx = (Mat_<float>(1, 5) << 0.1f, 0.2f, 0.4f, 0.2f, 0.1f);
+        Mat ky = (Mat_<float>(3, 1) << -1, 0, 1);
+        p.resize(Size(), 1.7, 0.45, INTER_LANCZOS4).sepFilter2D(CV_32F, kx, ky, Point(-1, -1), 3.)
+         .resize(Size(), 0.5, 2.2, INTER_LINEAR).convertTo(CV_8U, 2, 10);
+        resize(src, a, Size(), 1.7, 0.45, INTER_LANCZOS4);
+        sepFilter2D(a, b, CV_32F, kx, ky, Point(-1, -1), 3.);
+        resize(b, a, Size(), 0.5, 2.2, INTER_LINEAR);
+        a.convertTo(ref, CV_8U, 2, 10);
+        break;
+    }
+    default:
+        p.GaussianBlur(Size(31, 31), 0);
+        GaussianBlur(src, ref, Size(31, 31), 0);
+    }
+}
+
+TEST(Imgproc_Pipeline, accuracy)
+{
+    RNG& rng = theRNG();
+    Mat img(487, 653, CV_8UC3);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(3, 3), 0);
+
+    for( int idx = 0; idx < 5; idx++ )
+    {
+        ImagePipeline p;
+        Mat ref;
+        runChain(idx, img, p, ref);
+
+        for( int k = 0; k < 4; k++ )
+        {
+            Mat dst;
+            NumThreadsGuard guard(k % 2 == 0 ? 1 : 4);
+            // tiny buffers make the smallest tiles
+            p.setTileBufSize(k < 2 ? 0 : 1);
+            p.run(img, dst);
+            ASSERT_EQ(ref.type(), dst.type());
+            ASSERT_EQ(ref.size(), dst.size());
+            EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "chain=" << idx << ", k=" << k;
+        }
+    }
+}
+
+TEST(Imgproc_Pipeline, unsupported)
+{
+    ImagePipeline p;
+    EXPECT_THROW(p.cvtColor(COLOR_BayerBG2BGR), cv::Exception);
+    EXPECT_THROW(p.cvtColor(COLOR_YUV2BGR_NV12), cv::Exception);
+    EXPECT_THROW(p.resize(Size(10, 10), 0, 0, INTER_AREA), cv::Exception);
+    EXPECT_THROW(p.threshold(0, 255, THRESH_BINARY | THRESH_OTSU), cv::Exception);
+    EXPECT_TRUE(p.empty());
+
+    Mat src(10, 10, CV_8UC3, Scalar::all(7)), dst;
+    p.run(src, dst);
+    EXPECT_EQ(0, norm(src, dst, NORM_INF));
+}
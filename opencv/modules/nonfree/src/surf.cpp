@@ -257,9 +257,7 @@ interpolateKeypoint( float N9[3][9], int dx, int dy, int ds, KeyPoint& kpt )
     return ok;
 }
 
-#ifdef HAVE_TBB
-static tbb::mutex findMaximaInLayer_m;
-#endif
+static Mutex findMaximaInLayer_m;
 
 /*
  * Find the maxima in the determinant of the Hessian in a layer of the
@@ -356,9 +354,7 @@ findMaximaInLayer( const Mat& sum, const Mat& mask_sum,
                     if( interp_ok  )
                     {
                         /*printf( "KeyPoint %f %f %d\n", point.pt.x, point.pt.y, point.size );*/
-#ifdef HAVE_TBB
-                        tbb::mutex::scoped_lock lock(findMaximaInLayer_m);
-#endif
+                        AutoLock lock(findMaximaInLayer_m);
                         keypoints.push_back(kpt);
                     }
                 }
@@ -414,11 +410,6 @@ struct SURFFindInvoker
         keypoints = &_keypoints;
         nOctaveLayers = _nOctaveLayers;
         hessianThreshold = _hessianThreshold;
-
-#ifdef HAVE_TBB
-        //touch the mutex to ensure that it's initialization is finished
-        CV_Assert(&findMaximaInLayer_m > 0);
-#endif
     }
 
     void operator()(const BlockedRange& range) const
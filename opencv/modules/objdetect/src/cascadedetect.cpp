@@ -134,6 +134,7 @@ public:
 
 void groupRectangles(vector<Rect>& rectList, int groupThreshold, double eps, vector<int>* weights, vector<double>* levelWeights)
 {
+    CV_TRACE_REGION("cv::groupRectangles");
     if( groupThreshold <= 0 || rectList.empty() )
     {
         if( weights )
@@ -988,6 +989,7 @@ struct CascadeClassifierInvoker
                         result =  -(int)classifier->data.stages.size();
                     if( classifier->data.stages.size() + result < 4 )
                     {
+                        AutoLock lock(mtx);
                         rectangles->push_back(Rect(cvRound(x*scalingFactor), cvRound(y*scalingFactor), winSize.width, winSize.height));
                         rejectLevels->push_back(-result);
                         levelWeights->push_back(gypWeight);
@@ -1010,6 +1012,7 @@ struct CascadeClassifierInvoker
     vector<int> *rejectLevels;
     vector<double> *levelWeights;
     Mat mask;
+    mutable Mutex mtx;
 };
 
 struct getRect { Rect operator ()(const CvAvgComp& e) const { return e.rect; } };
@@ -1019,6 +1022,7 @@ bool CascadeClassifier::detectSingleScale( const Mat& image, int stripCount, Siz
                                            int stripSize, int yStep, double factor, vector<Rect>& candidates,
                                            vector<int>& levels, vector<double>& weights, bool outputRejectLevels )
 {
+    CV_TRACE_REGION("cv::CascadeClassifier::detectSingleScale");
     if( !featureEvaluator->setImage( image, data.origWinSize ) )
         return false;
 
@@ -1083,6 +1087,7 @@ void CascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& object
                                           int flags, Size minObjectSize, Size maxObjectSize,
                                           bool outputRejectLevels )
 {
+    CV_TRACE_REGION("cv::CascadeClassifier::detectMultiScale");
     const double GROUP_EPS = 0.2;
 
     CV_Assert( scaleFactor > 1 && image.depth() == CV_8U );
@@ -1154,7 +1159,7 @@ void CascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& object
 
         int stripCount, stripSize;
 
-    #ifdef HAVE_TBB
+    #ifdef HAVE_PARALLEL_FRAMEWORK
         const int PTS_PER_THREAD = 1000;
         stripCount = ((processingRectSize.width/yStep)*(processingRectSize.height + yStep-1)/yStep + PTS_PER_THREAD/2)/PTS_PER_THREAD;
         stripCount = std::min(std::max(stripCount, 1), 100);
@@ -795,6 +795,7 @@ void HOGDescriptor::compute(const Mat& img, vector<float>& descriptors,
                             Size winStride, Size padding,
                             const vector<Point>& locations) const
 {
+    CV_TRACE_REGION("cv::HOGDescriptor::compute");
     if( winStride == Size() )
         winStride = cellSize;
     Size cacheStride(gcd(winStride.width, blockStride.width),
@@ -857,6 +858,7 @@ void HOGDescriptor::detect(const Mat& img,
     vector<Point>& hits, vector<double>& weights, double hitThreshold, 
     Size winStride, Size padding, const vector<Point>& locations) const
 {
+    CV_TRACE_REGION("cv::HOGDescriptor::detect");
     hits.clear();
     if( svmDetector.empty() )
         return;
@@ -977,6 +979,8 @@ struct HOGInvoker
                 resize(img, smallerImg, sz);
             hog->detect(smallerImg, locations, hitsWeights, hitThreshold, winStride, padding);
             Size scaledWinSize = Size(cvRound(hog->winSize.width*scale), cvRound(hog->winSize.height*scale));
+            // keep the rectangles, scales and weights of the level together
+            AutoLock lock(mtx);
             for( size_t j = 0; j < locations.size(); j++ )
             {
                 vec->push_back(Rect(cvRound(locations[j].x*scale),
@@ -1006,6 +1010,7 @@ struct HOGInvoker
     ConcurrentRectVector* vec;
     ConcurrentDoubleVector* weights;
     ConcurrentDoubleVector* scales;
+    mutable Mutex mtx;
 };
 
 
@@ -1014,6 +1019,7 @@ void HOGDescriptor::detectMultiScale(
     double hitThreshold, Size winStride, Size padding,
     double scale0, double finalThreshold, bool useMeanshiftGrouping) const  
 {
+    CV_TRACE_REGION("cv::HOGDescriptor::detectMultiScale");
     double scale = 1.;
     int levels = 0;
 
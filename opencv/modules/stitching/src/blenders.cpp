@@ -202,6 +202,7 @@ MultiBandBlender::MultiBandBlender(int try_gpu, int num_bands, int weight_type)
 
 void MultiBandBlender::prepare(Rect dst_roi)
 {
+    CV_TRACE_REGION("cv::detail::MultiBandBlender::prepare");
     dst_roi_final_ = dst_roi;
 
     // Crop unnecessary bands
@@ -235,6 +236,7 @@ void MultiBandBlender::prepare(Rect dst_roi)
 
 void MultiBandBlender::feed(const Mat &img, const Mat &mask, Point tl)
 {
+    CV_TRACE_REGION("cv::detail::MultiBandBlender::feed");
     CV_Assert(img.type() == CV_16SC3 || img.type() == CV_8UC3);
     CV_Assert(mask.type() == CV_8U);
 
@@ -358,6 +360,7 @@ void MultiBandBlender::feed(const Mat &img, const Mat &mask, Point tl)
 
 void MultiBandBlender::blend(Mat &dst, Mat &dst_mask)
 {
+    CV_TRACE_REGION("cv::detail::MultiBandBlender::blend");
     for (int i = 0; i <= num_bands_; ++i)
         normalizeUsingWeightMap(dst_band_weights_[i], dst_pyr_laplace_[i]);
 
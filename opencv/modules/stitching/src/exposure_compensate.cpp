@@ -73,6 +73,7 @@ void ExposureCompensator::feed(const vector<Point> &corners, const vector<Mat> &
 void GainCompensator::feed(const vector<Point> &corners, const vector<Mat> &images,
                            const vector<pair<Mat,uchar> > &masks)
 {
+    CV_TRACE_REGION("cv::detail::GainCompensator::feed");
     LOGLN("Exposure compensation...");
     int64 t = getTickCount();
 
@@ -163,6 +164,7 @@ vector<double> GainCompensator::gains() const
 void BlocksGainCompensator::feed(const vector<Point> &corners, const vector<Mat> &images,
                                      const vector<pair<Mat,uchar> > &masks)
 {
+    CV_TRACE_REGION("cv::detail::BlocksGainCompensator::feed");
     CV_Assert(corners.size() == images.size() && images.size() == masks.size());
 
     const int num_images = static_cast<int>(images.size());
@@ -281,6 +281,7 @@ void FeaturesFinder::operator ()(const Mat &image, ImageFeatures &features)
 
 void FeaturesFinder::operator ()(const Mat &image, ImageFeatures &features, const vector<Rect> &rois)
 {
+    CV_TRACE_REGION("cv::detail::FeaturesFinder::operator()");
     vector<ImageFeatures> roi_features(rois.size());
     size_t total_kps_count = 0;
     int total_descriptors_height = 0;
@@ -502,6 +503,7 @@ const MatchesInfo& MatchesInfo::operator =(const MatchesInfo &other)
 void FeaturesMatcher::operator ()(const vector<ImageFeatures> &features, vector<MatchesInfo> &pairwise_matches,
                                   const Mat &mask)
 {
+    CV_TRACE_REGION("cv::detail::FeaturesMatcher::operator()");
     const int num_images = static_cast<int>(features.size());
 
     CV_Assert(mask.empty() || (mask.type() == CV_8U && mask.cols == num_images && mask.rows));
@@ -104,6 +104,7 @@ namespace detail {
 void HomographyBasedEstimator::estimate(const vector<ImageFeatures> &features, const vector<MatchesInfo> &pairwise_matches,
                                         vector<CameraParams> &cameras)
 {
+    CV_TRACE_REGION("cv::detail::HomographyBasedEstimator::estimate");
     LOGLN("Estimating rotations...");
     int64 t = getTickCount();
 
@@ -171,6 +172,7 @@ void BundleAdjusterBase::estimate(const vector<ImageFeatures> &features,
                                   const vector<MatchesInfo> &pairwise_matches,
                                   vector<CameraParams> &cameras)
 {
+    CV_TRACE_REGION("cv::detail::BundleAdjusterBase::estimate");
     LOG_CHAT("Bundle adjustment");
     int64 t = getTickCount();
 
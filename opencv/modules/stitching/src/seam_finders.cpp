@@ -48,6 +48,7 @@ namespace detail {
 void PairwiseSeamFinder::find(const vector<Mat> &src, const vector<Point> &corners,
                               vector<Mat> &masks)
 {
+    CV_TRACE_REGION("cv::detail::PairwiseSeamFinder::find");
     LOGLN("Finding seams...");
     if (src.size() == 0) 
         return;
@@ -417,6 +418,7 @@ GraphCutSeamFinder::~GraphCutSeamFinder() {}
 void GraphCutSeamFinder::find(const vector<Mat> &src, const vector<Point> &corners,
                               vector<Mat> &masks)
 {
+    CV_TRACE_REGION("cv::detail::GraphCutSeamFinder::find");
     impl_->find(src, corners, masks);
 }
 
@@ -96,6 +96,7 @@ Stitcher::Status Stitcher::estimateTransform(InputArray images)
 
 Stitcher::Status Stitcher::estimateTransform(InputArray images, const vector<vector<Rect> > &rois)
 {
+    CV_TRACE_REGION("cv::Stitcher::estimateTransform");
     images.getMatVector(imgs_);
     rois_ = rois;
 
@@ -119,6 +120,7 @@ Stitcher::Status Stitcher::composePanorama(OutputArray pano)
 
 Stitcher::Status Stitcher::composePanorama(InputArray images, OutputArray pano)
 {
+    CV_TRACE_REGION("cv::Stitcher::composePanorama");
     LOGLN("Warping images (auxiliary)... ");
 
     vector<Mat> imgs;
@@ -332,6 +334,7 @@ Stitcher::Status Stitcher::stitch(InputArray images, const vector<vector<Rect> >
 
 Stitcher::Status Stitcher::matchImages()
 {
+    CV_TRACE_REGION("cv::Stitcher::matchImages");
     if ((int)imgs_.size() < 2)
     {
         LOGLN("Need more images");
@@ -429,6 +432,7 @@ Stitcher::Status Stitcher::matchImages()
 
 void Stitcher::estimateCameraParams()
 {
+    CV_TRACE_REGION("cv::Stitcher::estimateCameraParams");
     detail::HomographyBasedEstimator estimator;
     estimator(features_, pairwise_matches_, cameras_);
 
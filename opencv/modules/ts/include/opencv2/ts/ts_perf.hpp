@@ -4,10 +4,6 @@
 #include "opencv2/core/core.hpp"
 #include "ts_gtest.h"
 
-#ifdef HAVE_TBB
-#include "tbb/task_scheduler_init.h"
-#endif
-
 #if !(defined(LOGD) || defined(LOGI) || defined(LOGW) || defined(LOGE))
 # if defined(ANDROID) && defined(USE_ANDROID_LOGGING)
 #  include <android/log.h>
@@ -320,11 +316,7 @@ private:
     };
     friend class _declareHelper;
 
-#ifdef HAVE_TBB
-    cv::Ptr<tbb::task_scheduler_init> p_tbb_initializer;
-#else
-    cv::Ptr<int> fixme;
-#endif
+    int nthreads0; // the setNumThreads() value before the test, restored in TearDown
 
 public:
     _declareHelper declare;
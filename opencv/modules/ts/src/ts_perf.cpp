@@ -16,7 +16,7 @@ const char *command_line_keys =
     "{   |perf_min_samples    |10       |minimal required numer of samples}"
     "{   |perf_force_samples  |100      |force set maximum number of samples for all tests}"
     "{   |perf_seed           |809564   |seed for random numbers generator}"
-    "{   |perf_tbb_nthreads   |-1       |if TBB is enabled, the number of TBB threads}"
+    "{   |perf_tbb_nthreads   |-1       |the number of threads used by the parallel loops}"
     "{   |perf_write_sanity   |false    |allow to create new records for sanity checks}"
     #ifdef ANDROID
     "{   |perf_time_limit     |6.0      |default time limit for a single test (in seconds)}"
@@ -588,7 +588,7 @@ int64 TestBase::_calibrate()
 # pragma warning(push)
 # pragma warning(disable:4355)  // 'this' : used in base member initializer list
 #endif
-TestBase::TestBase(): declare(this)
+TestBase::TestBase(): nthreads0(0), declare(this)
 {
 }
 #ifdef _MSC_VER
@@ -900,12 +900,9 @@ void TestBase::reportMetrics(bool toJUnitXML)
 
 void TestBase::SetUp()
 {
-#ifdef HAVE_TBB
-    if (param_tbb_nthreads > 0) {
-        p_tbb_initializer.release();
-        p_tbb_initializer=new tbb::task_scheduler_init(param_tbb_nthreads);
-    }
-#endif
+    nthreads0 = cv::getNumThreadsSetting();
+    if (param_tbb_nthreads > 0)
+        cv::setNumThreads(param_tbb_nthreads);
 #ifdef ANDROID
     if (param_affinity_mask)
         setCurrentThreadAffinityMask(param_affinity_mask);
@@ -934,9 +931,7 @@ void TestBase::TearDown()
         if (type_param)  printf("[ TYPE     ] \t%s\n", type_param), fflush(stdout);
         reportMetrics(true);
     }
-#ifdef HAVE_TBB
-    p_tbb_initializer.release();
-#endif
+    cv::setNumThreads(nthreads0);
 }
 
 std::string TestBase::getDataPath(const std::string& relativePath)
@@ -1025,12 +1020,7 @@ TestBase::_declareHelper& TestBase::_declareHelper::time(double timeLimitSecs)
 
 TestBase::_declareHelper& TestBase::_declareHelper::tbb_threads(int n)
 {
-#ifdef HAVE_TBB
-    test->p_tbb_initializer.release();
-    if (n > 0)
-        test->p_tbb_initializer=new tbb::task_scheduler_init(n);
-#endif
-    (void)n;
+    cv::setNumThreads(n);
     return *this;
 }
 